@@ -0,0 +1,46 @@
+#ifndef EMBED_MCP_BENCH_H
+#define EMBED_MCP_BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "embed_mcp.h"
+
+// Benchmark suite behind `make bench`. Every benchmark appends one result object to
+// the context; bench_main.c writes them out as JSON so runs can be diffed.
+
+typedef struct {
+    cJSON *results;             // Array of result objects
+    double scale;               // Iteration multiplier (--quick runs a tenth)
+    const char *filter;         // Only run benchmarks whose name contains this (NULL: all)
+} bench_context_t;
+
+uint64_t bench_now_ns(void);
+size_t bench_iterations(const bench_context_t *ctx, size_t base);
+bool bench_selected(const bench_context_t *ctx, const char *name);
+
+// A loop of iterations operations that took elapsed_ns
+void bench_report_ops(bench_context_t *ctx, const char *name, size_t iterations, uint64_t elapsed_ns);
+
+// A load run: one latency per completed request (sorted in place), the run's wall time,
+// the number of concurrent clients and the requests that failed
+void bench_report_load(bench_context_t *ctx, const char *name, uint64_t *latencies_ns, size_t count,
+                       uint64_t elapsed_ns, size_t clients, size_t errors);
+
+// Registers the add(a, b) tool the wrapper and end-to-end benchmarks call
+int bench_register_add(embed_mcp_server_t *server);
+
+// Known-answer checks (HMAC-SHA256, UART framing, CBOR), run before the benchmarks;
+// returns the number of failed checks
+size_t bench_run_checks(bench_context_t *ctx);
+
+// In-process benchmarks: JSON-RPC, tool registry, wrapper dispatch, sessions
+void bench_run_micro(bench_context_t *ctx);
+
+// End-to-end tools/call throughput and latency against a server child process
+void bench_run_load(bench_context_t *ctx);
+
+// Child process side of the load benchmarks ("stdio" or "http"); returns the exit code
+int bench_serve(const char *transport, int port);
+
+#endif // EMBED_MCP_BENCH_H
@@ -0,0 +1,625 @@
+#include "bench.h"
+#include "application/session_token.h"
+#include "protocol/cbor.h"
+#include "protocol/json_writer.h"
+#include "transport/uart_transport.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Known-answer checks run ahead of the benchmarks: timing code that computes the
+// wrong bytes is worse than useless. Each group reports one result object.
+
+typedef struct {
+    size_t checks;
+    size_t failures;
+} check_tally_t;
+
+static void check_expect(check_tally_t *tally, bool ok, const char *group, const char *what) {
+    tally->checks++;
+    if (!ok) {
+        tally->failures++;
+        printf("  FAIL %s: %s\n", group, what);
+    }
+}
+
+static void check_report(bench_context_t *ctx, const char *name, const check_tally_t *tally) {
+    cJSON *result = cJSON_CreateObject();
+    cJSON_AddStringToObject(result, "name", name);
+    cJSON_AddStringToObject(result, "kind", "check");
+    cJSON_AddNumberToObject(result, "checks", (double)tally->checks);
+    cJSON_AddNumberToObject(result, "failures", (double)tally->failures);
+    cJSON_AddItemToArray(ctx->results, result);
+
+    printf("%-36s %12zu checks %8zu failed\n", name, tally->checks, tally->failures);
+    fflush(stdout);
+}
+
+// Hex string to bytes, returns the byte count
+static size_t check_unhex(const char *hex, uint8_t *out, size_t capacity) {
+    size_t count = 0;
+    while (hex[0] && hex[1] && count < capacity) {
+        unsigned int byte;
+        if (sscanf(hex, "%2x", &byte) != 1) break;
+        out[count++] = (uint8_t)byte;
+        hex += 2;
+    }
+    return count;
+}
+
+// =============================================================================
+// HMAC-SHA256 (session tokens)
+// =============================================================================
+
+typedef struct {
+    const char *name;
+    uint8_t key_byte;               // Key of key_length bytes of key_byte...
+    const char *key_text;           // ...or this text
+    size_t key_length;
+    uint8_t data_byte;              // Data of data_length bytes of data_byte...
+    const char *data_text;          // ...or this text
+    size_t data_length;
+    const char *mac;                // Expected tag in hex, possibly truncated
+} hmac_vector_t;
+
+// RFC 4231 section 4
+static const hmac_vector_t k_hmac_vectors[] = {
+    { "RFC 4231 test case 1", 0x0b, NULL, 20, 0, "Hi There", 0,
+      "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7" },
+    { "RFC 4231 test case 2", 0, "Jefe", 4, 0, "what do ya want for nothing?", 0,
+      "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" },
+    { "RFC 4231 test case 3", 0xaa, NULL, 20, 0xdd, NULL, 50,
+      "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe" },
+    { "RFC 4231 test case 4", 0, NULL, 25, 0xcd, NULL, 50,
+      "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b" },
+    { "RFC 4231 test case 5", 0x0c, NULL, 20, 0, "Test With Truncation", 0,
+      "a3b6167473100ee06e0c796c2955552b" },
+    { "RFC 4231 test case 6", 0xaa, NULL, 131, 0, "Test Using Larger Than Block-Size Key - Hash Key First", 0,
+      "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54" },
+    { "RFC 4231 test case 7", 0xaa, NULL, 131, 0,
+      "This is a test using a larger than block-size key and a larger than block-size data. "
+      "The key needs to be hashed before being used by the HMAC algorithm.", 0,
+      "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2" },
+};
+
+static void check_hmac_sha256(bench_context_t *ctx) {
+    const char *name = "check.hmac_sha256";
+    if (!bench_selected(ctx, name)) return;
+    check_tally_t tally = { 0 };
+
+    // FIPS 180-2 appendix B: one block, and padding that spills into a second one
+    uint8_t digest[32], expected[32];
+    mcp_session_token_sha256("abc", 3, digest);
+    check_unhex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", expected, sizeof(expected));
+    check_expect(&tally, memcmp(digest, expected, 32) == 0, name, "SHA-256 of \"abc\"");
+    const char *two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    mcp_session_token_sha256(two_blocks, strlen(two_blocks), digest);
+    check_unhex("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", expected, sizeof(expected));
+    check_expect(&tally, memcmp(digest, expected, 32) == 0, name, "SHA-256 of the 448-bit message");
+
+    for (size_t v = 0; v < sizeof(k_hmac_vectors) / sizeof(k_hmac_vectors[0]); v++) {
+        const hmac_vector_t *vector = &k_hmac_vectors[v];
+
+        uint8_t long_key[131];
+        for (size_t i = 0; i < vector->key_length; i++) {
+            long_key[i] = vector->key_text ? (uint8_t)vector->key_text[i] :
+                          vector->key_byte ? vector->key_byte : (uint8_t)(i + 1);
+        }
+
+        // The token key is MCP_SESSION_TOKEN_KEY_SIZE bytes; see mcp_session_token_hmac()
+        uint8_t key[MCP_SESSION_TOKEN_KEY_SIZE] = { 0 };
+        if (vector->key_length > 64) {
+            mcp_session_token_sha256(long_key, vector->key_length, key);
+        } else {
+            memcpy(key, long_key, vector->key_length);
+        }
+
+        uint8_t data[64];
+        const void *message = vector->data_text;
+        size_t length = vector->data_text ? strlen(vector->data_text) : vector->data_length;
+        if (!vector->data_text) {
+            memset(data, vector->data_byte, length);
+            message = data;
+        }
+
+        uint8_t mac[32];
+        size_t expected_length = check_unhex(vector->mac, expected, sizeof(expected));
+        mcp_session_token_hmac(key, message, length, mac);
+        check_expect(&tally, memcmp(mac, expected, expected_length) == 0, name, vector->name);
+    }
+
+    // And through the token API: a token verifies, and fails with any byte changed
+    mcp_session_token_key_t token_key;
+    char token[MCP_SESSION_TOKEN_MAX_SIZE];
+    mcp_session_token_key_init(&token_key, "known-answer", 60);
+    size_t token_length = mcp_session_token_issue(&token_key, "2025-03-26", 0, 1000, token);
+    check_expect(&tally, token_length > 0 &&
+                 mcp_session_token_verify(&token_key, token, token_length, 1000, NULL) == MCP_SESSION_TOKEN_OK,
+                 name, "issued token verifies");
+    if (token_length > 0) {
+        token[token_length - 1] = token[token_length - 1] == '0' ? '1' : '0';
+        check_expect(&tally, mcp_session_token_verify(&token_key, token, token_length, 1000, NULL) ==
+                     MCP_SESSION_TOKEN_BAD_SIGNATURE, name, "altered token is refused");
+    }
+    mcp_session_token_key_clear(&token_key);
+
+    check_report(ctx, name, &tally);
+}
+
+// =============================================================================
+// UART framing: COBS and CRC-16 through the transport, over a loopback driver
+// =============================================================================
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool woken;
+
+    mcp_transport_t *transport;
+    mcp_connection_t *connection;
+
+    // RX ring the transport handed to start(); the check writes frames into it
+    uint8_t *rx_ring;
+    size_t rx_size;
+    size_t rx_position;
+
+    // Everything the transport transmitted
+    uint8_t tx[4096];
+    size_t tx_length;
+
+    // Last message delivered to on_message
+    uint8_t message[2048];
+    size_t message_length;
+    size_t messages;
+} loopback_t;
+
+static int loopback_start(void *ctx, mcp_transport_t *transport, uint8_t *ring, size_t size) {
+    loopback_t *loop = (loopback_t*)ctx;
+    loop->transport = transport;
+    loop->rx_ring = ring;
+    loop->rx_size = size;
+    return 0;
+}
+
+static size_t loopback_rx_position(void *ctx) {
+    loopback_t *loop = (loopback_t*)ctx;
+    return __atomic_load_n(&loop->rx_position, __ATOMIC_ACQUIRE);
+}
+
+// Called under the transport's tx_mutex; the transfer completes at once
+static int loopback_tx_start(void *ctx, const uint8_t *data, size_t length) {
+    loopback_t *loop = (loopback_t*)ctx;
+    pthread_mutex_lock(&loop->mutex);
+    if (loop->tx_length + length <= sizeof(loop->tx)) {
+        memcpy(loop->tx + loop->tx_length, data, length);
+        loop->tx_length += length;
+    }
+    pthread_mutex_unlock(&loop->mutex);
+    mcp_uart_transport_tx_complete(loop->transport);
+    return 0;
+}
+
+static void loopback_wait(void *ctx, uint32_t timeout_ms) {
+    loopback_t *loop = (loopback_t*)ctx;
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_nsec += (long)timeout_ms * 1000000L;
+    until.tv_sec += until.tv_nsec / 1000000000L;
+    until.tv_nsec %= 1000000000L;
+
+    pthread_mutex_lock(&loop->mutex);
+    while (!loop->woken && pthread_cond_timedwait(&loop->cond, &loop->mutex, &until) == 0) {
+    }
+    loop->woken = false;
+    pthread_mutex_unlock(&loop->mutex);
+}
+
+static void loopback_wake(void *ctx) {
+    loopback_t *loop = (loopback_t*)ctx;
+    pthread_mutex_lock(&loop->mutex);
+    loop->woken = true;
+    pthread_cond_broadcast(&loop->cond);
+    pthread_mutex_unlock(&loop->mutex);
+}
+
+static void loopback_stop(void *ctx) {
+    (void)ctx;
+}
+
+static void loopback_on_message(const char *message, size_t length, mcp_connection_t *connection,
+                                void *user_data) {
+    (void)connection;
+    loopback_t *loop = (loopback_t*)user_data;
+    pthread_mutex_lock(&loop->mutex);
+    if (length <= sizeof(loop->message)) {
+        memcpy(loop->message, message, length);
+        loop->message_length = length;
+    }
+    loop->messages++;
+    pthread_cond_broadcast(&loop->cond);
+    pthread_mutex_unlock(&loop->mutex);
+}
+
+static void loopback_on_opened(mcp_connection_t *connection, void *user_data) {
+    ((loopback_t*)user_data)->connection = connection;
+}
+
+static void loopback_on_error(mcp_transport_t *transport, int error_code, const char *message, void *user_data) {
+    (void)transport;
+    (void)error_code;
+    (void)message;
+    (void)user_data;
+}
+
+// Textbook COBS, the reference for what the transport streams into its TX ring: a
+// block of 254 data bytes is closed with code 0xFF and a new one opened, even at the end
+static size_t reference_cobs_encode(const uint8_t *in, size_t length, uint8_t *out) {
+    size_t code_at = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (in[i] == 0) {
+            out[code_at] = code;
+            code_at = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[code_at] = code;
+                code_at = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_at] = code;
+    return o;
+}
+
+// The whole frame for a payload: COBS(payload, CRC big-endian) and the delimiter
+static size_t reference_frame(const uint8_t *payload, size_t length, uint8_t *out) {
+    uint8_t plain[1100];
+    uint16_t crc = mcp_uart_crc16(payload, length);
+    memcpy(plain, payload, length);
+    plain[length] = (uint8_t)(crc >> 8);
+    plain[length + 1] = (uint8_t)(crc & 0xFF);
+    size_t encoded = reference_cobs_encode(plain, length + 2, out);
+    out[encoded] = 0;
+    return encoded + 1;
+}
+
+// Put bytes on the "wire" into the transport's RX ring and wait for the message count
+// to reach expected; false on timeout
+static bool loopback_receive(loopback_t *loop, const uint8_t *bytes, size_t length, size_t expected) {
+    size_t position = loop->rx_position;
+    for (size_t i = 0; i < length; i++) {
+        loop->rx_ring[position] = bytes[i];
+        position = (position + 1) % loop->rx_size;
+    }
+    __atomic_store_n(&loop->rx_position, position, __ATOMIC_RELEASE);
+    mcp_uart_transport_rx_event(loop->transport);
+
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += 2;
+    pthread_mutex_lock(&loop->mutex);
+    while (loop->messages < expected &&
+           pthread_cond_timedwait(&loop->cond, &loop->mutex, &until) == 0) {
+    }
+    bool delivered = loop->messages >= expected;
+    pthread_mutex_unlock(&loop->mutex);
+    return delivered;
+}
+
+// Send a payload, wait for its frame on the TX side; returns the frame length or 0
+static size_t loopback_transmit(loopback_t *loop, const uint8_t *payload, size_t length) {
+    pthread_mutex_lock(&loop->mutex);
+    loop->tx_length = 0;
+    pthread_mutex_unlock(&loop->mutex);
+
+    if (mcp_connection_send(loop->connection, (const char*)payload, length) != 0) return 0;
+
+    // A frame wrapping the TX ring leaves in two transfers, the second from the
+    // transport task
+    for (int waited = 0; waited < 2000; waited++) {
+        pthread_mutex_lock(&loop->mutex);
+        size_t sent = loop->tx_length;
+        bool complete = sent > 0 && loop->tx[sent - 1] == 0;
+        pthread_mutex_unlock(&loop->mutex);
+        if (complete) return sent;
+
+        struct timespec pause = { 0, 1000000 };
+        nanosleep(&pause, NULL);
+    }
+    return 0;
+}
+
+typedef struct {
+    const char *name;
+    size_t length;
+    int pattern;                    // 0: zeros, 1: 0x01.., 2: bytes 1..255 repeating, 3: text with zero runs
+} framing_case_t;
+
+static const framing_case_t k_framing_cases[] = {
+    { "single zero", 1, 0 },
+    { "zero run of 2", 2, 0 },
+    { "zero run of 254", 254, 0 },
+    { "zero run of 600", 600, 0 },
+    { "251 non-zero bytes", 251, 2 },
+    { "252 non-zero bytes (block boundary with CRC)", 252, 2 },
+    { "253 non-zero bytes", 253, 2 },
+    { "254 non-zero bytes", 254, 2 },
+    { "255 non-zero bytes", 255, 2 },
+    { "508 non-zero bytes", 508, 2 },
+    { "1000 bytes, every value", 1000, 1 },
+    { "zero runs between text", 700, 3 },
+};
+
+static void framing_fill(const framing_case_t *test, uint8_t *payload) {
+    for (size_t i = 0; i < test->length; i++) {
+        switch (test->pattern) {
+            case 0: payload[i] = 0; break;
+            case 1: payload[i] = (uint8_t)(i + 1); break;
+            case 2: payload[i] = (uint8_t)(i % 255 + 1); break;
+            default: payload[i] = (i % 97) < 90 ? (uint8_t)('a' + i % 26) : 0; break;
+        }
+    }
+}
+
+static void check_uart_framing(bench_context_t *ctx) {
+    const char *name = "check.uart_framing";
+    if (!bench_selected(ctx, name)) return;
+    check_tally_t tally = { 0 };
+
+    // CRC-16/CCITT-FALSE check value and the initial value for no data
+    check_expect(&tally, mcp_uart_crc16((const uint8_t*)"123456789", 9) == 0x29B1, name, "CRC of \"123456789\"");
+    check_expect(&tally, mcp_uart_crc16(NULL, 0) == 0xFFFF, name, "CRC of nothing");
+
+    // The reference encoder against the examples in Cheshire and Baker's paper
+    static const struct { const char *plain; const char *encoded; } cobs_examples[] = {
+        { "00", "0101" },
+        { "0000", "010101" },
+        { "11220033", "0311220233" },
+        { "11223344", "0511223344" },
+        { "11000000", "0211010101" },
+    };
+    for (size_t i = 0; i < sizeof(cobs_examples) / sizeof(cobs_examples[0]); i++) {
+        uint8_t plain[8], expected[8], encoded[16];
+        size_t plain_length = check_unhex(cobs_examples[i].plain, plain, sizeof(plain));
+        size_t expected_length = check_unhex(cobs_examples[i].encoded, expected, sizeof(expected));
+        size_t length = reference_cobs_encode(plain, plain_length, encoded);
+        check_expect(&tally, length == expected_length && memcmp(encoded, expected, length) == 0,
+                     name, cobs_examples[i].plain);
+    }
+
+    loopback_t loop;
+    memset(&loop, 0, sizeof(loop));
+    pthread_mutex_init(&loop.mutex, NULL);
+    pthread_cond_init(&loop.cond, NULL);
+
+    const mcp_uart_driver_t driver = {
+        .ctx = &loop,
+        .start = loopback_start,
+        .rx_position = loopback_rx_position,
+        .tx_start = loopback_tx_start,
+        .wait = loopback_wait,
+        .wake = loopback_wake,
+        .stop = loopback_stop
+    };
+
+    // The smallest TX ring, so long frames stream through it and wrap
+    mcp_transport_config_t *config = mcp_transport_config_create_uart(&driver);
+    mcp_transport_t *transport = NULL;
+    if (config) {
+        config->encoding = MCP_TRANSPORT_ENCODING_CBOR;     // Any first byte is accepted
+        config->config.uart.tx_ring_size = MCP_UART_MIN_TX_RING_SIZE;
+        transport = mcp_transport_create_with_config(config);
+        mcp_transport_config_destroy(config);
+    }
+    if (transport) {
+        mcp_transport_set_callbacks(transport, loopback_on_message, loopback_on_opened, NULL,
+                                    loopback_on_error, &loop);
+    }
+    if (!transport || mcp_transport_start(transport) != 0 || !loop.connection) {
+        check_expect(&tally, false, name, "loopback UART transport starts");
+        if (transport) mcp_transport_destroy(transport);
+        check_report(ctx, name, &tally);
+        return;
+    }
+
+    static uint8_t payload[1100], expected[1200], frame[1200];
+    for (size_t c = 0; c < sizeof(k_framing_cases) / sizeof(k_framing_cases[0]); c++) {
+        const framing_case_t *test = &k_framing_cases[c];
+        framing_fill(test, payload);
+
+        size_t expected_length = reference_frame(payload, test->length, expected);
+        size_t sent = loopback_transmit(&loop, payload, test->length);
+        pthread_mutex_lock(&loop.mutex);
+        memcpy(frame, loop.tx, sent);
+        pthread_mutex_unlock(&loop.mutex);
+
+        check_expect(&tally, sent == expected_length && memcmp(frame, expected, sent) == 0, name, test->name);
+        check_expect(&tally, sent > 0 && memchr(frame, 0, sent - 1) == NULL, name, "no zero inside a frame");
+
+        // Back in through the RX ring
+        size_t before = loop.messages;
+        bool delivered = sent > 0 && loopback_receive(&loop, frame, sent, before + 1);
+        pthread_mutex_lock(&loop.mutex);
+        delivered = delivered && loop.message_length == test->length &&
+                    memcmp(loop.message, payload, test->length) == 0;
+        pthread_mutex_unlock(&loop.mutex);
+        check_expect(&tally, delivered, name, "round trip");
+    }
+
+    // A run of exactly 254 bytes may also end the frame without the empty block
+    // (Cheshire and Baker's shortest form); the decoder accepts both. The first byte
+    // is picked so the CRC holds no zero and payload and CRC make one 254-byte run.
+    framing_fill(&k_framing_cases[5], payload);
+    for (int first = 1; first < 256; first++) {
+        payload[0] = (uint8_t)first;
+        uint16_t crc = mcp_uart_crc16(payload, 252);
+        if ((crc >> 8) != 0 && (crc & 0xFF) != 0) break;
+    }
+    size_t length = reference_frame(payload, 252, expected);
+    if (length == 257 && expected[0] == 0xFF && expected[255] == 0x01) {
+        expected[255] = 0;
+        size_t before = loop.messages;
+        bool delivered = loopback_receive(&loop, expected, 256, before + 1);
+        pthread_mutex_lock(&loop.mutex);
+        delivered = delivered && loop.message_length == 252 && memcmp(loop.message, payload, 252) == 0;
+        pthread_mutex_unlock(&loop.mutex);
+        check_expect(&tally, delivered, name, "254-byte block ending the frame without a trailing code byte");
+    } else {
+        check_expect(&tally, false, name, "254-byte block layout");
+    }
+
+    // A corrupted frame is dropped, the next good one still arrives
+    framing_fill(&k_framing_cases[10], payload);
+    length = reference_frame(payload, 100, expected);
+    memcpy(frame, expected, length);
+    memcpy(frame + length, expected, length);
+    frame[50] = frame[50] == 0x55 ? 0x56 : 0x55;
+    size_t before = loop.messages;
+    bool delivered = loopback_receive(&loop, frame, 2 * length, before + 1);
+    check_expect(&tally, delivered && loop.messages == before + 1, name, "bad CRC dropped, next frame kept");
+
+    mcp_uart_transport_stats_t stats;
+    transport->interface->get_stats(transport, &stats);
+    check_expect(&tally, stats.crc_errors == 1, name, "bad CRC counted");
+
+    mcp_transport_stop(transport);
+    mcp_transport_destroy(transport);
+    pthread_cond_destroy(&loop.cond);
+    pthread_mutex_destroy(&loop.mutex);
+
+    check_report(ctx, name, &tally);
+}
+
+// =============================================================================
+// CBOR (RFC 8949 appendix A)
+// =============================================================================
+
+typedef struct {
+    const char *cbor;               // Hex
+    const char *json;               // The JSON it stands for
+} cbor_vector_t;
+
+// Every example with a JSON equivalent. Byte strings decode to base64 and tags are
+// dropped, as mcp_cbor_decode() documents; undefined becomes null.
+static const cbor_vector_t k_cbor_decode[] = {
+    { "00", "0" }, { "01", "1" }, { "0a", "10" }, { "17", "23" }, { "1818", "24" },
+    { "1819", "25" }, { "1864", "100" }, { "1903e8", "1000" }, { "1a000f4240", "1000000" },
+    { "1b000000e8d4a51000", "1000000000000" }, { "1bffffffffffffffff", "18446744073709551615" },
+    { "20", "-1" }, { "29", "-10" }, { "3863", "-100" }, { "3903e7", "-1000" },
+    { "3bffffffffffffffff", "-18446744073709551616" },
+    { "f90000", "0.0" }, { "f98000", "-0.0" }, { "f93c00", "1.0" }, { "fb3ff199999999999a", "1.1" },
+    { "f93e00", "1.5" }, { "f97bff", "65504.0" }, { "fa47c35000", "100000.0" },
+    { "fa7f7fffff", "3.4028234663852886e+38" }, { "fb7e37e43c8800759c", "1.0e+300" },
+    { "f90001", "5.960464477539063e-8" }, { "f90400", "0.00006103515625" }, { "f9c400", "-4.0" },
+    { "fbc010666666666666", "-4.1" },
+    { "f4", "false" }, { "f5", "true" }, { "f6", "null" }, { "f7", "null" },
+    { "c074323031332d30332d32315432303a30343a30305a", "\"2013-03-21T20:04:00Z\"" },
+    { "c11a514b67b0", "1363896240" }, { "c1fb41d452d9ec200000", "1363896240.5" },
+    { "c249010000000000000000", "\"AQAAAAAAAAAA\"" },
+    { "d74401020304", "\"AQIDBA==\"" }, { "d818456449455446", "\"ZElFVEY=\"" },
+    { "d82076687474703a2f2f7777772e6578616d706c652e636f6d", "\"http://www.example.com\"" },
+    { "40", "\"\"" }, { "4401020304", "\"AQIDBA==\"" },
+    { "60", "\"\"" }, { "6161", "\"a\"" }, { "6449455446", "\"IETF\"" }, { "62225c", "\"\\\"\\\\\"" },
+    { "62c3bc", "\"\\u00fc\"" }, { "63e6b0b4", "\"\\u6c34\"" }, { "64f0908591", "\"\\ud800\\udd51\"" },
+    { "80", "[]" }, { "83010203", "[1,2,3]" }, { "8301820203820405", "[1,[2,3],[4,5]]" },
+    { "98190102030405060708090a0b0c0d0e0f101112131415161718181819",
+      "[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25]" },
+    { "a0", "{}" }, { "a26161016162820203", "{\"a\":1,\"b\":[2,3]}" },
+    { "826161a161626163", "[\"a\",{\"b\":\"c\"}]" },
+    { "a56161614161626142616361436164614461656145",
+      "{\"a\":\"A\",\"b\":\"B\",\"c\":\"C\",\"d\":\"D\",\"e\":\"E\"}" },
+    { "5f42010243030405ff", "\"AQIDBAU=\"" }, { "7f657374726561646d696e67ff", "\"streaming\"" },
+    { "9fff", "[]" }, { "9f018202039f0405ffff", "[1,[2,3],[4,5]]" },
+    { "9f01820203820405ff", "[1,[2,3],[4,5]]" }, { "83018202039f0405ff", "[1,[2,3],[4,5]]" },
+    { "83019f0203ff820405", "[1,[2,3],[4,5]]" },
+    { "9f0102030405060708090a0b0c0d0e0f101112131415161718181819ff",
+      "[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25]" },
+    { "bf61610161629f0203ffff", "{\"a\":1,\"b\":[2,3]}" },
+    { "826161bf61626163ff", "[\"a\",{\"b\":\"c\"}]" },
+    { "bf6346756ef563416d7421ff", "{\"Fun\":true,\"Amt\":-2}" },
+};
+
+// Examples whose encoding is the one mcp_cbor_from_json() writes: shortest integers,
+// single precision when exact (else double), indefinite-length containers
+static const cbor_vector_t k_cbor_encode[] = {
+    { "00", "0" }, { "01", "1" }, { "0a", "10" }, { "17", "23" }, { "1818", "24" },
+    { "1819", "25" }, { "1864", "100" }, { "1903e8", "1000" }, { "1a000f4240", "1000000" },
+    { "1b000000e8d4a51000", "1000000000000" },
+    { "20", "-1" }, { "29", "-10" }, { "3863", "-100" }, { "3903e7", "-1000" },
+    { "fb3ff199999999999a", "1.1" }, { "fa47c35000", "100000.0" },
+    { "fa7f7fffff", "3.4028234663852886e+38" }, { "fb7e37e43c8800759c", "1.0e+300" },
+    { "fbc010666666666666", "-4.1" },
+    { "f4", "false" }, { "f5", "true" }, { "f6", "null" },
+    { "60", "\"\"" }, { "6161", "\"a\"" }, { "6449455446", "\"IETF\"" }, { "62225c", "\"\\\"\\\\\"" },
+    { "62c3bc", "\"\\u00fc\"" }, { "62c3bc", "\"\xc3\xbc\"" }, { "63e6b0b4", "\"\\u6c34\"" },
+    { "64f0908591", "\"\\ud800\\udd51\"" },
+    { "9fff", "[]" }, { "bf61610161629f0203ffff", "{\"a\":1,\"b\":[2,3]}" },
+    { "bf6346756ef563416d7421ff", "{\"Fun\":true,\"Amt\":-2}" },
+};
+
+static void check_cbor(bench_context_t *ctx) {
+    const char *name = "check.cbor";
+    if (!bench_selected(ctx, name)) return;
+    check_tally_t tally = { 0 };
+    uint8_t bytes[128];
+
+    for (size_t v = 0; v < sizeof(k_cbor_decode) / sizeof(k_cbor_decode[0]); v++) {
+        const cbor_vector_t *vector = &k_cbor_decode[v];
+        size_t length = check_unhex(vector->cbor, bytes, sizeof(bytes));
+        cJSON *decoded = mcp_cbor_decode(bytes, length);
+        cJSON *expected = cJSON_Parse(vector->json);
+        check_expect(&tally, decoded && expected && cJSON_Compare(decoded, expected, true), name, vector->cbor);
+        cJSON_Delete(decoded);
+        cJSON_Delete(expected);
+    }
+
+    // Truncated and malformed input is refused
+    static const char *malformed[] = { "18", "1b0000", "62c3", "9f01", "a16161", "bf6161ff", "ff", "1c", "a10102" };
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        size_t length = check_unhex(malformed[i], bytes, sizeof(bytes));
+        cJSON *decoded = mcp_cbor_decode(bytes, length);
+        check_expect(&tally, decoded == NULL, name, malformed[i]);
+        cJSON_Delete(decoded);
+    }
+
+    mcp_json_buffer_t out;
+    mcp_json_buffer_init(&out);
+    for (size_t v = 0; v < sizeof(k_cbor_encode) / sizeof(k_cbor_encode[0]); v++) {
+        const cbor_vector_t *vector = &k_cbor_encode[v];
+        size_t length = check_unhex(vector->cbor, bytes, sizeof(bytes));
+        mcp_json_buffer_reset(&out);
+        int result = mcp_cbor_from_json(&out, vector->json, strlen(vector->json));
+        check_expect(&tally, result == 0 && out.length == length && memcmp(out.data, bytes, length) == 0,
+                     name, vector->json);
+
+        // And back again
+        cJSON *decoded = result == 0 ? mcp_cbor_decode((const uint8_t*)out.data, out.length) : NULL;
+        cJSON *expected = cJSON_Parse(vector->json);
+        check_expect(&tally, decoded && expected && cJSON_Compare(decoded, expected, true), name, "round trip");
+        cJSON_Delete(decoded);
+        cJSON_Delete(expected);
+    }
+    mcp_json_buffer_free(&out);
+
+    check_report(ctx, name, &tally);
+}
+
+size_t bench_run_checks(bench_context_t *ctx) {
+    size_t before = cJSON_GetArraySize(ctx->results);
+    check_hmac_sha256(ctx);
+    check_uart_framing(ctx);
+    check_cbor(ctx);
+
+    size_t failures = 0;
+    for (size_t i = before; i < (size_t)cJSON_GetArraySize(ctx->results); i++) {
+        cJSON *result = cJSON_GetArrayItem(ctx->results, (int)i);
+        failures += (size_t)cJSON_GetNumberValue(cJSON_GetObjectItem(result, "failures"));
+    }
+    return failures;
+}
@@ -0,0 +1,404 @@
+#include "bench.h"
+#include "utils/logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define BENCH_HTTP_CLIENTS 4
+#define BENCH_HTTP_WORKERS 4
+
+static const char *k_initialize =
+    "{\"jsonrpc\":\"2.0\",\"id\":0,\"method\":\"initialize\",\"params\":{\"protocolVersion\":\"2025-03-26\","
+    "\"capabilities\":{},\"clientInfo\":{\"name\":\"embedmcp-bench\",\"version\":\"1.0.0\"}}}";
+static const char *k_initialized = "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"}";
+
+// =============================================================================
+// Server child (mcp_bench --serve stdio|http), started through exec so it does not
+// inherit the parent's threads
+// =============================================================================
+
+int bench_serve(const char *transport, int port) {
+    bool http = strcmp(transport, "http") == 0;
+    embed_mcp_config_t config = {
+        .name = "bench",
+        .version = "1.0.0",
+        .host = "127.0.0.1",
+        .port = port,
+        .max_connections = 64,
+        .worker_threads = http ? BENCH_HTTP_WORKERS : 0,
+    };
+
+    embed_mcp_server_t *server = embed_mcp_create(&config);
+    if (!server) return 1;
+    // Info and warnings go to stdout, which is the STDIO transport's wire
+    mcp_log_set_level(MCP_LOG_LEVEL_ERROR);
+
+    bench_register_add(server);
+
+    int result = embed_mcp_run(server, http ? EMBED_MCP_TRANSPORT_HTTP : EMBED_MCP_TRANSPORT_STDIO);
+    embed_mcp_destroy(server);
+    return result == 0 ? 0 : 1;
+}
+
+static pid_t spawn_server(const char *transport, int port, int stdin_fd, int stdout_fd) {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    if (stdin_fd >= 0) dup2(stdin_fd, STDIN_FILENO);
+    if (stdout_fd >= 0) dup2(stdout_fd, STDOUT_FILENO);
+
+    char port_text[16];
+    snprintf(port_text, sizeof(port_text), "%d", port);
+    // The child runs with the same allocator as the parent
+    char *argv[] = { "mcp_bench", "--serve", (char*)transport, "--port", port_text,
+                     mcp_json_pool_installed() ? "--json-pool" : NULL, NULL };
+    execv("/proc/self/exe", argv);
+    _exit(127);
+}
+
+static int format_call(char *buffer, size_t size, size_t id) {
+    return snprintf(buffer, size,
+                    "{\"jsonrpc\":\"2.0\",\"id\":%zu,\"method\":\"tools/call\","
+                    "\"params\":{\"name\":\"add\",\"arguments\":{\"a\":%zu,\"b\":2.5}}}", id, id);
+}
+
+static int write_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+// Buffered reader over a pipe or socket
+typedef struct {
+    int fd;
+    char data[65536];
+    size_t start;
+    size_t end;
+} bench_reader_t;
+
+static int reader_fill(bench_reader_t *reader) {
+    if (reader->start > 0) {
+        memmove(reader->data, reader->data + reader->start, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+    }
+    if (reader->end == sizeof(reader->data)) return -1;
+
+    ssize_t count;
+    do {
+        count = read(reader->fd, reader->data + reader->end, sizeof(reader->data) - reader->end);
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) return -1;
+    reader->end += (size_t)count;
+    return 0;
+}
+
+// Next line without its terminator; NULL on EOF
+static const char *reader_line(bench_reader_t *reader, size_t *length) {
+    for (;;) {
+        char *line = reader->data + reader->start;
+        char *newline = memchr(line, '\n', reader->end - reader->start);
+        if (newline) {
+            *length = (size_t)(newline - line);
+            if (*length > 0 && line[*length - 1] == '\r') (*length)--;
+            reader->start = (size_t)(newline - reader->data) + 1;
+            return line;
+        }
+        if (reader_fill(reader) != 0) return NULL;
+    }
+}
+
+static bool reader_take(bench_reader_t *reader, size_t length) {
+    while (reader->end - reader->start < length) {
+        if (reader_fill(reader) != 0) return false;
+    }
+    reader->start += length;
+    return true;
+}
+
+// =============================================================================
+// STDIO: one client, strictly request/response
+// =============================================================================
+
+// Next JSON-RPC line from the server (anything else on stdout is skipped)
+static const char *stdio_read_message(bench_reader_t *reader, size_t *length) {
+    const char *line;
+    while ((line = reader_line(reader, length)) != NULL) {
+        if (*length > 0 && line[0] == '{') return line;
+    }
+    return NULL;
+}
+
+static void bench_load_stdio(bench_context_t *ctx) {
+    if (!bench_selected(ctx, "e2e.stdio.tools_call")) return;
+
+    // Close-on-exec so the child keeps only its own ends; otherwise closing
+    // to_server[1] here would never reach the server as EOF
+    int to_server[2], from_server[2];
+    if (pipe2(to_server, O_CLOEXEC) != 0) return;
+    if (pipe2(from_server, O_CLOEXEC) != 0) {
+        close(to_server[0]);
+        close(to_server[1]);
+        return;
+    }
+
+    pid_t pid = spawn_server("stdio", 0, to_server[0], from_server[1]);
+    close(to_server[0]);
+    close(from_server[1]);
+    if (pid < 0) {
+        close(to_server[1]);
+        close(from_server[0]);
+        return;
+    }
+
+    bench_reader_t *reader = calloc(1, sizeof(bench_reader_t));
+    size_t iterations = bench_iterations(ctx, 20000);
+    uint64_t *latencies = calloc(iterations, sizeof(uint64_t));
+    size_t completed = 0, errors = 0;
+    uint64_t elapsed = 0;
+    char request[256];
+    size_t length;
+
+    if (reader && latencies) {
+        reader->fd = from_server[0];
+        int n = snprintf(request, sizeof(request), "%s\n", k_initialize);
+        if (write_all(to_server[1], request, (size_t)n) == 0 && stdio_read_message(reader, &length)) {
+            n = snprintf(request, sizeof(request), "%s\n", k_initialized);
+            write_all(to_server[1], request, (size_t)n);
+
+            uint64_t run_start = bench_now_ns();
+            for (size_t i = 0; i < iterations; i++) {
+                n = format_call(request, sizeof(request) - 1, i + 1);
+                request[n++] = '\n';
+
+                uint64_t start = bench_now_ns();
+                if (write_all(to_server[1], request, (size_t)n) != 0) break;
+                const char *reply = stdio_read_message(reader, &length);
+                if (!reply) break;
+                latencies[completed++] = bench_now_ns() - start;
+                if (!memmem(reply, length, "\"result\"", 8)) errors++;
+            }
+            elapsed = bench_now_ns() - run_start;
+        }
+    }
+
+    // Closing stdin ends the STDIO server
+    close(to_server[1]);
+    waitpid(pid, NULL, 0);
+    close(from_server[0]);
+
+    if (completed > 0) {
+        bench_report_load(ctx, "e2e.stdio.tools_call", latencies, completed, elapsed, 1,
+                          errors + (iterations - completed));
+    } else {
+        fprintf(stderr, "e2e.stdio.tools_call: server did not answer\n");
+    }
+    free(latencies);
+    free(reader);
+}
+
+// =============================================================================
+// HTTP: several keep-alive clients against the worker pool
+// =============================================================================
+
+typedef struct {
+    int port;
+    size_t requests;
+    uint64_t *latencies;        // This client's slice
+    size_t completed;
+    size_t errors;
+} http_client_t;
+
+static int http_connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// POST body to /mcp and wait for the whole response; returns the status code or -1
+static int http_exchange(int fd, bench_reader_t *reader, int port, const char *body, size_t body_length,
+                         bool *has_result) {
+    char head[256];
+    int n = snprintf(head, sizeof(head),
+                     "POST /mcp HTTP/1.1\r\nHost: 127.0.0.1:%d\r\nContent-Type: application/json\r\n"
+                     "Accept: application/json, text/event-stream\r\nContent-Length: %zu\r\n\r\n",
+                     port, body_length);
+    if (write_all(fd, head, (size_t)n) != 0 || write_all(fd, body, body_length) != 0) return -1;
+
+    size_t length;
+    const char *line = reader_line(reader, &length);
+    if (!line || length < 12 || strncmp(line, "HTTP/1.", 7) != 0) return -1;
+    int status = atoi(line + 9);
+
+    size_t content_length = 0;
+    while ((line = reader_line(reader, &length)) != NULL && length > 0) {
+        if (length > 15 && strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_length = (size_t)strtoul(line + 15, NULL, 10);
+        }
+    }
+    if (!line || content_length > sizeof(reader->data)) return -1;
+
+    while (reader->end - reader->start < content_length) {
+        if (reader_fill(reader) != 0) return -1;
+    }
+    *has_result = memmem(reader->data + reader->start, content_length, "\"result\"", 8) != NULL;
+    reader_take(reader, content_length);
+    return status;
+}
+
+static void *http_client_thread(void *arg) {
+    http_client_t *client = (http_client_t*)arg;
+    bench_reader_t *reader = calloc(1, sizeof(bench_reader_t));
+    int fd = http_connect(client->port);
+    if (!reader || fd < 0) {
+        client->errors = client->requests;
+        free(reader);
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    reader->fd = fd;
+
+    char body[256];
+    for (size_t i = 0; i < client->requests; i++) {
+        int n = format_call(body, sizeof(body), i + 1);
+        bool has_result = false;
+
+        uint64_t start = bench_now_ns();
+        int status = http_exchange(fd, reader, client->port, body, (size_t)n, &has_result);
+        if (status < 0) {
+            // Connection lost: count the rest as failed
+            client->errors += client->requests - i;
+            break;
+        }
+        client->latencies[client->completed++] = bench_now_ns() - start;
+        if (status != 200 || !has_result) client->errors++;
+    }
+
+    close(fd);
+    free(reader);
+    return NULL;
+}
+
+// Free loopback port for the child (it may be taken again before the child binds)
+static int pick_port(void) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_length = sizeof(addr);
+    int port = -1;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0 &&
+        getsockname(fd, (struct sockaddr*)&addr, &addr_length) == 0) {
+        port = ntohs(addr.sin_port);
+    }
+    close(fd);
+    return port;
+}
+
+static void bench_load_http(bench_context_t *ctx) {
+    if (!bench_selected(ctx, "e2e.http.tools_call")) return;
+
+    int port = pick_port();
+    if (port < 0) return;
+    // The child's stdout only carries transport logging
+    int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    pid_t pid = spawn_server("http", port, -1, null_fd);
+    if (null_fd >= 0) close(null_fd);
+    if (pid < 0) return;
+
+    // Wait for the listener, then initialize once
+    bool ready = false;
+    bench_reader_t *reader = calloc(1, sizeof(bench_reader_t));
+    for (int attempt = 0; reader && attempt < 100 && !ready; attempt++) {
+        int fd = http_connect(port);
+        if (fd < 0) {
+            usleep(50000);
+            continue;
+        }
+        reader->fd = fd;
+        reader->start = reader->end = 0;
+        bool has_result = false;
+        ready = http_exchange(fd, reader, port, k_initialize, strlen(k_initialize), &has_result) == 200 &&
+                has_result;
+        close(fd);
+    }
+    free(reader);
+
+    size_t per_client = bench_iterations(ctx, 20000) / BENCH_HTTP_CLIENTS;
+    if (per_client == 0) per_client = 1;
+    uint64_t *latencies = calloc(per_client * BENCH_HTTP_CLIENTS, sizeof(uint64_t));
+    http_client_t clients[BENCH_HTTP_CLIENTS];
+    pthread_t threads[BENCH_HTTP_CLIENTS];
+    size_t started = 0;
+    uint64_t elapsed = 0;
+
+    if (ready && latencies) {
+        uint64_t run_start = bench_now_ns();
+        for (size_t i = 0; i < BENCH_HTTP_CLIENTS; i++) {
+            clients[i] = (http_client_t){ .port = port, .requests = per_client,
+                                          .latencies = latencies + i * per_client };
+            if (pthread_create(&threads[i], NULL, http_client_thread, &clients[i]) != 0) break;
+            started++;
+        }
+        for (size_t i = 0; i < started; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        elapsed = bench_now_ns() - run_start;
+    }
+
+    kill(pid, SIGINT);
+    waitpid(pid, NULL, 0);
+
+    // Pack the per-client slices into one array
+    size_t completed = 0, errors = 0;
+    for (size_t i = 0; i < started; i++) {
+        memmove(latencies + completed, clients[i].latencies, clients[i].completed * sizeof(uint64_t));
+        completed += clients[i].completed;
+        errors += clients[i].errors;
+    }
+
+    if (completed > 0) {
+        bench_report_load(ctx, "e2e.http.tools_call", latencies, completed, elapsed, started, errors);
+    } else {
+        fprintf(stderr, "e2e.http.tools_call: server did not answer on port %d\n", port);
+    }
+    free(latencies);
+}
+
+void bench_run_load(bench_context_t *ctx) {
+    bench_load_stdio(ctx);
+    bench_load_http(ctx);
+}
@@ -0,0 +1,197 @@
+#include "bench.h"
+#include "hal/platform_hal.h"
+#include "utils/compress.h"
+#include "utils/logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+size_t bench_iterations(const bench_context_t *ctx, size_t base) {
+    size_t iterations = (size_t)((double)base * ctx->scale);
+    return iterations > 0 ? iterations : 1;
+}
+
+bool bench_selected(const bench_context_t *ctx, const char *name) {
+    return !ctx->filter || strstr(name, ctx->filter) != NULL;
+}
+
+void bench_report_ops(bench_context_t *ctx, const char *name, size_t iterations, uint64_t elapsed_ns) {
+    double ns_per_op = iterations > 0 ? (double)elapsed_ns / (double)iterations : 0.0;
+    double ops_per_sec = elapsed_ns > 0 ? (double)iterations * 1e9 / (double)elapsed_ns : 0.0;
+
+    cJSON *result = cJSON_CreateObject();
+    cJSON_AddStringToObject(result, "name", name);
+    cJSON_AddStringToObject(result, "kind", "micro");
+    cJSON_AddNumberToObject(result, "iterations", (double)iterations);
+    cJSON_AddNumberToObject(result, "elapsed_ns", (double)elapsed_ns);
+    cJSON_AddNumberToObject(result, "ns_per_op", ns_per_op);
+    cJSON_AddNumberToObject(result, "ops_per_sec", ops_per_sec);
+    cJSON_AddItemToArray(ctx->results, result);
+
+    printf("%-36s %12zu ops %12.1f ns/op %14.0f ops/s\n", name, iterations, ns_per_op, ops_per_sec);
+    fflush(stdout);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Nearest-rank percentile of a sorted array, in microseconds
+static double percentile_us(const uint64_t *sorted, size_t count, double p) {
+    if (count == 0) return 0.0;
+    size_t rank = (size_t)(p * (double)count + 0.999999);
+    if (rank == 0) rank = 1;
+    if (rank > count) rank = count;
+    return (double)sorted[rank - 1] / 1000.0;
+}
+
+void bench_report_load(bench_context_t *ctx, const char *name, uint64_t *latencies_ns, size_t count,
+                       uint64_t elapsed_ns, size_t clients, size_t errors) {
+    qsort(latencies_ns, count, sizeof(uint64_t), compare_u64);
+
+    double throughput = elapsed_ns > 0 ? (double)count * 1e9 / (double)elapsed_ns : 0.0;
+    double p50 = percentile_us(latencies_ns, count, 0.50);
+    double p99 = percentile_us(latencies_ns, count, 0.99);
+    double max = count > 0 ? (double)latencies_ns[count - 1] / 1000.0 : 0.0;
+
+    cJSON *result = cJSON_CreateObject();
+    cJSON_AddStringToObject(result, "name", name);
+    cJSON_AddStringToObject(result, "kind", "load");
+    cJSON_AddNumberToObject(result, "requests", (double)count);
+    cJSON_AddNumberToObject(result, "clients", (double)clients);
+    cJSON_AddNumberToObject(result, "errors", (double)errors);
+    cJSON_AddNumberToObject(result, "elapsed_ns", (double)elapsed_ns);
+    cJSON_AddNumberToObject(result, "throughput_rps", throughput);
+    cJSON_AddNumberToObject(result, "p50_us", p50);
+    cJSON_AddNumberToObject(result, "p99_us", p99);
+    cJSON_AddNumberToObject(result, "max_us", max);
+    cJSON_AddItemToArray(ctx->results, result);
+
+    printf("%-36s %12zu req %12.0f req/s  p50 %8.1f us  p99 %8.1f us  errors %zu\n",
+           name, count, throughput, p50, p99, errors);
+    fflush(stdout);
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  -o, --output FILE    Write results as JSON [default: bench_results.json]\n");
+    printf("  -f, --filter NAME    Only run benchmarks whose name contains NAME\n");
+    printf("  -q, --quick          Run a tenth of the iterations\n");
+    printf("  -c, --check          Only run the known-answer checks\n");
+    printf("  -j, --json-pool      Allocate JSON values from the slab pool\n");
+    printf("  -h, --help           Show this help\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *output = "bench_results.json";
+    const char *serve = NULL;
+    int serve_port = 0;
+    bool json_pool = false;
+    bool check_only = false;
+    bench_context_t ctx = { .results = NULL, .scale = 1.0, .filter = NULL };
+
+    static struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"filter", required_argument, 0, 'f'},
+        {"quick", no_argument, 0, 'q'},
+        {"check", no_argument, 0, 'c'},
+        {"json-pool", no_argument, 0, 'j'},
+        {"help", no_argument, 0, 'h'},
+        {"serve", required_argument, 0, 's'},      // Internal: load benchmark child
+        {"port", required_argument, 0, 'p'},
+        {0, 0, 0, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "o:f:qcjh", long_options, NULL)) != -1) {
+        switch (c) {
+            case 'o': output = optarg; break;
+            case 'f': ctx.filter = optarg; break;
+            case 'q': ctx.scale = 0.1; break;
+            case 'c': check_only = true; break;
+            case 'j': json_pool = true; break;
+            case 's': serve = optarg; break;
+            case 'p': serve_port = atoi(optarg); break;
+            case 'h': print_usage(argv[0]); return 0;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    if (json_pool && mcp_json_pool_install(NULL) != 0) {
+        fprintf(stderr, "Failed to install the JSON pool\n");
+        return 1;
+    }
+
+    if (serve) {
+        return bench_serve(serve, serve_port);
+    }
+
+    if (mcp_platform_init() != 0) {
+        fprintf(stderr, "Platform initialization failed\n");
+        return 1;
+    }
+
+    // Synchronous and quiet: no flusher thread, and session churn would otherwise log every session
+    mcp_log_config_t *log_config = mcp_log_config_create_default();
+    if (log_config) {
+        log_config->min_level = MCP_LOG_LEVEL_ERROR;
+        log_config->async = false;
+        mcp_log_init(log_config);
+        mcp_log_config_destroy(log_config);
+    }
+
+    ctx.results = cJSON_CreateArray();
+
+    // Numbers from code that computes the wrong bytes mean nothing
+    size_t failures = bench_run_checks(&ctx);
+    if (failures > 0 || check_only) {
+        if (failures > 0) {
+            fprintf(stderr, "%zu known-answer checks failed\n", failures);
+        }
+        cJSON_Delete(ctx.results);
+        mcp_platform_cleanup();
+        return failures > 0 ? 1 : 0;
+    }
+
+    bench_run_micro(&ctx);
+    bench_run_load(&ctx);
+
+    char timestamp[32];
+    time_t now = time(NULL);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    cJSON *report = cJSON_CreateObject();
+    cJSON_AddStringToObject(report, "suite", "embedmcp");
+    cJSON_AddNumberToObject(report, "schema_version", 1);
+    cJSON_AddStringToObject(report, "timestamp", timestamp);
+    cJSON_AddBoolToObject(report, "compression", mcp_compress_available());
+    cJSON_AddBoolToObject(report, "json_pool", json_pool);
+    cJSON_AddNumberToObject(report, "scale", ctx.scale);
+    cJSON_AddItemToObject(report, "results", ctx.results);
+
+    int result = 0;
+    char *text = cJSON_Print(report);
+    FILE *file = text ? fopen(output, "w") : NULL;
+    if (file) {
+        fprintf(file, "%s\n", text);
+        fclose(file);
+        printf("Results written to %s\n", output);
+    } else {
+        fprintf(stderr, "Failed to write %s\n", output);
+        result = 1;
+    }
+
+    cJSON_free(text);
+    cJSON_Delete(report);
+    mcp_platform_cleanup();
+    return result;
+}
@@ -0,0 +1,293 @@
+#include "bench.h"
+#include "protocol/jsonrpc.h"
+#include "protocol/message.h"
+#include "tools/tool_registry.h"
+#include "application/session_manager.h"
+#include "utils/arena.h"
+#include "utils/logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char *k_tools_call =
+    "{\"jsonrpc\":\"2.0\",\"id\":42,\"method\":\"tools/call\","
+    "\"params\":{\"name\":\"add\",\"arguments\":{\"a\":1.5,\"b\":2.5}}}";
+
+// =============================================================================
+// JSON-RPC
+// =============================================================================
+
+static void bench_jsonrpc(bench_context_t *ctx) {
+    jsonrpc_parser_t *parser = jsonrpc_parser_create(NULL);
+    if (!parser) return;
+
+    if (bench_selected(ctx, "jsonrpc.parse_serialize")) {
+        size_t iterations = bench_iterations(ctx, 200000);
+        uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < iterations; i++) {
+            mcp_message_t *message = jsonrpc_parse_message(parser, k_tools_call);
+            char *text = jsonrpc_serialize_message(message);
+            free(text);
+            mcp_message_destroy(message);
+        }
+        bench_report_ops(ctx, "jsonrpc.parse_serialize", iterations, bench_now_ns() - start);
+    }
+
+    // The path the protocol takes: parse into a request arena, rewind after each message
+    if (bench_selected(ctx, "jsonrpc.parse_in_arena")) {
+        mcp_arena_t arena;
+        mcp_arena_init(&arena, MCP_ARENA_DEFAULT_CHUNK_SIZE);
+        mcp_arena_mark_t mark = mcp_arena_mark(&arena);
+
+        size_t iterations = bench_iterations(ctx, 200000);
+        uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < iterations; i++) {
+            mcp_message_t *message = jsonrpc_parse_message_in_arena(parser, &arena, k_tools_call);
+            mcp_message_release(message);
+            mcp_arena_rewind(&arena, mark);
+        }
+        bench_report_ops(ctx, "jsonrpc.parse_in_arena", iterations, bench_now_ns() - start);
+        mcp_arena_destroy(&arena);
+    }
+
+    // Tree churn the cJSON allocator sees per request (run with --json-pool to compare)
+    if (bench_selected(ctx, "json.parse_print_delete")) {
+        size_t iterations = bench_iterations(ctx, 200000);
+        uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < iterations; i++) {
+            cJSON *json = cJSON_Parse(k_tools_call);
+            char *text = cJSON_PrintUnformatted(json);
+            cJSON_free(text);
+            cJSON_Delete(json);
+        }
+        bench_report_ops(ctx, "json.parse_print_delete", iterations, bench_now_ns() - start);
+    }
+
+    jsonrpc_parser_destroy(parser);
+}
+
+// =============================================================================
+// Tool registry
+// =============================================================================
+
+static cJSON *registry_tool_execute(const cJSON *parameters, void *user_data) {
+    (void)parameters;
+    (void)user_data;
+    return cJSON_CreateNumber(1);
+}
+
+static void bench_registry(bench_context_t *ctx, size_t tool_count) {
+    char name[48];
+    snprintf(name, sizeof(name), "registry.call_tool/%zu", tool_count);
+    if (!bench_selected(ctx, name)) return;
+
+    mcp_tool_registry_config_t config = {0};
+    config.max_tools = tool_count;
+    config.enable_tool_stats = true;
+    config.strict_validation = true;
+    config.tool_timeout = 30;
+
+    mcp_tool_registry_t *registry = mcp_tool_registry_create(&config);
+    char (*names)[16] = calloc(tool_count, sizeof(*names));
+    cJSON *schema = cJSON_CreateObject();
+    cJSON_AddStringToObject(schema, "type", "object");
+    if (!registry || !names || !schema) {
+        mcp_tool_registry_destroy(registry);
+        free(names);
+        cJSON_Delete(schema);
+        return;
+    }
+
+    for (size_t i = 0; i < tool_count; i++) {
+        snprintf(names[i], sizeof(names[i]), "tool_%04zu", i);
+        mcp_tool_t *tool = mcp_tool_create(names[i], NULL, "Benchmark tool", schema,
+                                           registry_tool_execute, NULL);
+        if (!tool || mcp_tool_registry_register_tool(registry, tool) != 0) {
+            mcp_tool_destroy(tool);
+        }
+    }
+
+    cJSON *arguments = cJSON_CreateObject();
+
+    // Walk every registered name so the lookup is not served from one hot bucket
+    size_t iterations = bench_iterations(ctx, 200000);
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        cJSON *result = mcp_tool_registry_call_tool(registry, names[i % tool_count], arguments);
+        cJSON_Delete(result);
+    }
+    bench_report_ops(ctx, name, iterations, bench_now_ns() - start);
+
+    cJSON_Delete(arguments);
+    cJSON_Delete(schema);
+    free(names);
+    mcp_tool_registry_destroy(registry);
+}
+
+// =============================================================================
+// EMBED_MCP_WRAPPER dispatch (schema, parameter accessor, result conversion)
+// =============================================================================
+
+static double bench_add(double a, double b) {
+    return a + b;
+}
+
+EMBED_MCP_WRAPPER(bench_add_wrapper, bench_add, DOUBLE, DOUBLE, a, DOUBLE, b)
+
+int bench_register_add(embed_mcp_server_t *server) {
+    const char *names[] = {"a", "b"};
+    const char *descriptions[] = {"First number", "Second number"};
+    mcp_param_type_t types[] = {MCP_PARAM_DOUBLE, MCP_PARAM_DOUBLE};
+    return embed_mcp_add_tool(server, "add", "Add two numbers", names, descriptions, types, 2,
+                              MCP_RETURN_DOUBLE, bench_add_wrapper, NULL);
+}
+
+static void bench_wrapper(bench_context_t *ctx) {
+    if (!bench_selected(ctx, "wrapper.dispatch")) return;
+
+    embed_mcp_config_t config = { .name = "bench", .version = "1.0.0" };
+    embed_mcp_server_t *server = embed_mcp_create(&config);
+    if (!server) return;
+    mcp_log_set_level(MCP_LOG_LEVEL_ERROR);
+
+    if (bench_register_add(server) == 0) {
+        cJSON *arguments = cJSON_CreateObject();
+        cJSON_AddNumberToObject(arguments, "a", 1.5);
+        cJSON_AddNumberToObject(arguments, "b", 2.5);
+
+        size_t iterations = bench_iterations(ctx, 200000);
+        uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < iterations; i++) {
+            cJSON_Delete(embed_mcp_call_tool(server, "add", arguments));
+        }
+        bench_report_ops(ctx, "wrapper.dispatch", iterations, bench_now_ns() - start);
+        cJSON_Delete(arguments);
+    }
+
+    embed_mcp_destroy(server);
+}
+
+// =============================================================================
+// Startup: registering many tools one by one versus from a descriptor table
+// =============================================================================
+
+#define BENCH_STARTUP_TOOLS 256
+
+static const char *const k_startup_params[] = { "a", "b", NULL };
+
+static void bench_startup(bench_context_t *ctx, bool table) {
+    const char *name = table ? "startup.add_tool_table" : "startup.add_tool";
+    if (!bench_selected(ctx, name)) return;
+
+    static char tool_names[BENCH_STARTUP_TOOLS][16];
+    static embed_mcp_tool_desc_t descriptors[BENCH_STARTUP_TOOLS];
+    for (size_t i = 0; i < BENCH_STARTUP_TOOLS; i++) {
+        snprintf(tool_names[i], sizeof(tool_names[i]), "add_%zu", i);
+        descriptors[i] = (embed_mcp_tool_desc_t){
+            tool_names[i], "Add two numbers", EMBED_MCP_SCHEMA(DOUBLE, a, DOUBLE, b),
+            k_startup_params, 2, MCP_RETURN_DOUBLE, bench_add_wrapper, NULL
+        };
+    }
+
+    const char *names[] = {"a", "b"};
+    const char *descriptions[] = {"First number", "Second number"};
+    mcp_param_type_t types[] = {MCP_PARAM_DOUBLE, MCP_PARAM_DOUBLE};
+
+    size_t rounds = bench_iterations(ctx, 20);
+    uint64_t elapsed = 0;
+    for (size_t round = 0; round < rounds; round++) {
+        embed_mcp_config_t config = { .name = "bench", .version = "1.0.0", .max_tools = BENCH_STARTUP_TOOLS };
+        embed_mcp_server_t *server = embed_mcp_create(&config);
+        if (!server) return;
+        mcp_log_set_level(MCP_LOG_LEVEL_ERROR);
+
+        uint64_t start = bench_now_ns();
+        if (table) {
+            embed_mcp_add_tool_table(server, descriptors, BENCH_STARTUP_TOOLS);
+        } else {
+            for (size_t i = 0; i < BENCH_STARTUP_TOOLS; i++) {
+                embed_mcp_add_tool(server, tool_names[i], "Add two numbers", names, descriptions, types, 2,
+                                   MCP_RETURN_DOUBLE, bench_add_wrapper, NULL);
+            }
+        }
+        elapsed += bench_now_ns() - start;
+
+        embed_mcp_destroy(server);
+    }
+    bench_report_ops(ctx, name, rounds * BENCH_STARTUP_TOOLS, elapsed);
+}
+
+// =============================================================================
+// Sessions
+// =============================================================================
+
+static void bench_sessions(bench_context_t *ctx) {
+    if (!bench_selected(ctx, "session.")) return;
+
+    size_t count = bench_iterations(ctx, 20000);
+    mcp_session_manager_config_t *config = mcp_session_manager_config_create_default();
+    if (!config) return;
+    config->max_sessions = count;
+    config->default_session_timeout = 1;
+    config->auto_cleanup = false;   // Expiry is driven below, not by the timer thread
+    mcp_session_manager_t *manager = mcp_session_manager_create(config);
+    mcp_session_manager_config_destroy(config);
+
+    char **ids = calloc(count, sizeof(char*));
+    if (!manager || !ids) {
+        mcp_session_manager_destroy(manager);
+        free(ids);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        ids[i] = mcp_session_generate_id();
+    }
+
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < count; i++) {
+        mcp_session_manager_create_session(manager, ids[i]);
+    }
+    bench_report_ops(ctx, "session.create", count, bench_now_ns() - start);
+    time_t last_created = time(NULL);
+
+    start = bench_now_ns();
+    for (size_t i = 0; i < count; i++) {
+        mcp_session_unref(mcp_session_manager_find_session(manager, ids[i]));
+    }
+    bench_report_ops(ctx, "session.find", count, bench_now_ns() - start);
+
+    // Sessions are reclaimed on the first timer tick after they expire
+    while (time(NULL) < last_created + 2) {
+        usleep(50000);
+    }
+    start = bench_now_ns();
+    int expired = mcp_session_manager_cleanup_expired_sessions(manager);
+    bench_report_ops(ctx, "session.expire", expired > 0 ? (size_t)expired : 0, bench_now_ns() - start);
+
+    // Short-lived sessions: create and terminate
+    start = bench_now_ns();
+    for (size_t i = 0; i < count; i++) {
+        mcp_session_manager_create_session(manager, ids[i]);
+        mcp_session_manager_remove_session(manager, ids[i]);
+    }
+    bench_report_ops(ctx, "session.churn", count, bench_now_ns() - start);
+
+    for (size_t i = 0; i < count; i++) {
+        free(ids[i]);
+    }
+    free(ids);
+    mcp_session_manager_destroy(manager);
+}
+
+void bench_run_micro(bench_context_t *ctx) {
+    bench_jsonrpc(ctx);
+    bench_registry(ctx, 10);
+    bench_registry(ctx, 100);
+    bench_registry(ctx, 1000);
+    bench_wrapper(ctx);
+    bench_startup(ctx, false);
+    bench_startup(ctx, true);
+    bench_sessions(ctx);
+}
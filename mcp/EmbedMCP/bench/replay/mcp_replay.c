@@ -0,0 +1,868 @@
+// mcp_replay: feed traffic captures (embed_mcp_enable_capture) back into a server
+// and compare its latencies with the captured ones.
+//
+// Each capture file is one session and is replayed on its own thread, so sessions
+// overlap the way they did when captured (reconnect storms stay storms). Inbound
+// frames are sent at their captured offsets divided by --speed; --speed 0 sends
+// them back to back. Over STDIO every session gets its own server process and
+// requests are pipelined; over HTTP a session is one keep-alive connection, so a
+// request that comes due while the previous one is outstanding is sent late (and
+// counted as such).
+//
+// Captured latencies are server-side (request frame in to response frame out),
+// replayed ones are client round trips, so deltas include the transport.
+
+#include "utils/capture.h"
+#include "cjson/cJSON.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define REPLAY_NO_LATENCY UINT64_MAX
+#define REPLAY_LATE_US 1000             // Sends more than this behind schedule count as late
+#define REPLAY_READ_BUFFER 65536
+
+typedef struct {
+    char *data;                 // Inbound frame as captured
+    size_t length;
+    char *method;               // "batch" for batches
+    char *key;                  // Serialized id, NULL for notifications
+    uint64_t due_us;            // Offset from the replay start, already scaled by speed
+    uint64_t captured_us;       // Captured response latency
+    bool captured_error;
+
+    // Filled during the replay
+    uint64_t sent_at;
+    uint64_t replay_us;
+    bool replay_error;
+} replay_request_t;
+
+typedef struct {
+    const char *path;
+    uint64_t start_us;          // Wall-clock time from the capture header
+    replay_request_t *requests;
+    size_t count;
+    size_t capacity;
+    size_t expected;            // Requests that get a response
+
+    // Replay state, the mutex guards the request results
+    pthread_mutex_t mutex;
+    pthread_cond_t answered_cond;
+    size_t answered;
+    size_t late;
+    uint64_t max_late_us;
+    size_t failed;
+} replay_session_t;
+
+typedef struct {
+    const char *stdio_command;
+    char *http_host;
+    char http_port[8];
+    char *http_path;
+    double speed;
+    uint64_t timeout_us;        // Wait for outstanding responses after the last send
+    uint64_t run_start;
+} replay_options_t;
+
+static replay_options_t g_options;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+static void sleep_until(uint64_t deadline) {
+    for (;;) {
+        uint64_t now = now_us();
+        if (now >= deadline) return;
+        uint64_t wait = deadline - now;
+        struct timespec ts = { (time_t)(wait / 1000000ull), (long)(wait % 1000000ull) * 1000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static int write_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+// =============================================================================
+// Loading captures
+// =============================================================================
+
+// Request or response id used to pair frames; a batch is keyed by its first id
+static char *frame_key(const cJSON *json) {
+    if (cJSON_IsArray(json)) {
+        const cJSON *entry;
+        cJSON_ArrayForEach(entry, json) {
+            char *key = frame_key(entry);
+            if (key) return key;
+        }
+        return NULL;
+    }
+    const cJSON *id = cJSON_GetObjectItemCaseSensitive(json, "id");
+    return id && !cJSON_IsNull(id) ? cJSON_PrintUnformatted(id) : NULL;
+}
+
+static bool frame_is_response(const cJSON *json) {
+    const cJSON *first = cJSON_IsArray(json) ? json->child : json;
+    return first && !cJSON_GetObjectItemCaseSensitive(first, "method") &&
+           cJSON_GetObjectItemCaseSensitive(first, "id");
+}
+
+static bool frame_has_error(const cJSON *json) {
+    if (cJSON_IsArray(json)) {
+        const cJSON *entry;
+        cJSON_ArrayForEach(entry, json) {
+            if (cJSON_GetObjectItemCaseSensitive(entry, "error")) return true;
+        }
+        return false;
+    }
+    return cJSON_GetObjectItemCaseSensitive(json, "error") != NULL;
+}
+
+static int add_request(replay_session_t *session, const mcp_capture_frame_t *frame, const cJSON *json) {
+    if (session->count == session->capacity) {
+        size_t capacity = session->capacity ? session->capacity * 2 : 64;
+        replay_request_t *requests = realloc(session->requests, capacity * sizeof(replay_request_t));
+        if (!requests) return -1;
+        session->requests = requests;
+        session->capacity = capacity;
+    }
+
+    replay_request_t *request = &session->requests[session->count];
+    memset(request, 0, sizeof(*request));
+    request->data = malloc(frame->length + 1);
+    if (!request->data) return -1;
+    memcpy(request->data, frame->data, frame->length + 1);
+    request->length = frame->length;
+
+    const cJSON *method = cJSON_IsArray(json) ? NULL : cJSON_GetObjectItemCaseSensitive(json, "method");
+    request->method = strdup(cJSON_IsArray(json) ? "batch" : cJSON_IsString(method) ? method->valuestring : "?");
+    request->key = frame_key(json);
+    request->due_us = frame->time_us;       // Scaled once every session is loaded
+    request->captured_us = REPLAY_NO_LATENCY;
+    request->replay_us = REPLAY_NO_LATENCY;
+    if (request->key) session->expected++;
+    session->count++;
+    return 0;
+}
+
+// Pair a captured response with the latest earlier request carrying its id
+static void match_captured(replay_session_t *session, const mcp_capture_frame_t *frame, const cJSON *json) {
+    char *key = frame_key(json);
+    if (!key) return;
+
+    for (size_t i = session->count; i-- > 0;) {
+        replay_request_t *request = &session->requests[i];
+        if (request->key && request->captured_us == REPLAY_NO_LATENCY && strcmp(request->key, key) == 0) {
+            request->captured_us = frame->time_us - request->due_us;
+            request->captured_error = frame_has_error(json);
+            break;
+        }
+    }
+    cJSON_free(key);
+}
+
+static int load_session(replay_session_t *session, const char *path) {
+    memset(session, 0, sizeof(*session));
+    session->path = path;
+
+    mcp_capture_reader_t reader;
+    if (mcp_capture_reader_open(&reader, path) != 0) {
+        fprintf(stderr, "%s: not a capture file\n", path);
+        return -1;
+    }
+    session->start_us = reader.start_us;
+
+    mcp_capture_frame_t frame;
+    int status;
+    while ((status = mcp_capture_reader_next(&reader, &frame)) > 0) {
+        cJSON *json = cJSON_ParseWithLength(frame.data, frame.length);
+        if (!json) continue;
+
+        if (frame.direction == MCP_CAPTURE_INBOUND) {
+            if (add_request(session, &frame, json) != 0) status = -1;
+        } else if (frame_is_response(json)) {
+            match_captured(session, &frame, json);
+        }
+        cJSON_Delete(json);
+        if (status < 0) break;
+    }
+    if (status < 0) {
+        fprintf(stderr, "%s: truncated capture, replaying the first %zu requests\n", path, session->count);
+    }
+    mcp_capture_reader_close(&reader);
+
+    pthread_mutex_init(&session->mutex, NULL);
+    pthread_cond_init(&session->answered_cond, NULL);
+    return 0;
+}
+
+static void free_session(replay_session_t *session) {
+    for (size_t i = 0; i < session->count; i++) {
+        free(session->requests[i].data);
+        free(session->requests[i].method);
+        cJSON_free(session->requests[i].key);
+    }
+    free(session->requests);
+    pthread_mutex_destroy(&session->mutex);
+    pthread_cond_destroy(&session->answered_cond);
+}
+
+// =============================================================================
+// Replay bookkeeping shared by both transports
+// =============================================================================
+
+static void wait_due(replay_session_t *session, replay_request_t *request) {
+    uint64_t due = g_options.run_start + request->due_us;
+    sleep_until(due);
+
+    uint64_t now = now_us();
+    request->sent_at = now;
+    if (g_options.speed > 0 && now - due > REPLAY_LATE_US) {
+        pthread_mutex_lock(&session->mutex);
+        session->late++;
+        if (now - due > session->max_late_us) session->max_late_us = now - due;
+        pthread_mutex_unlock(&session->mutex);
+    }
+}
+
+// Record a response; returns false if no sent request is waiting for it
+static bool record_response(replay_session_t *session, const char *data, size_t length) {
+    cJSON *json = cJSON_ParseWithLength(data, length);
+    if (!json) return false;
+    if (!frame_is_response(json)) {
+        cJSON_Delete(json);
+        return false;
+    }
+    char *key = frame_key(json);
+    bool error = frame_has_error(json);
+    cJSON_Delete(json);
+    if (!key) return false;
+
+    uint64_t now = now_us();
+    bool matched = false;
+    pthread_mutex_lock(&session->mutex);
+    for (size_t i = 0; i < session->count; i++) {
+        replay_request_t *request = &session->requests[i];
+        if (request->key && request->sent_at && request->replay_us == REPLAY_NO_LATENCY &&
+            strcmp(request->key, key) == 0) {
+            request->replay_us = now - request->sent_at;
+            request->replay_error = error;
+            session->answered++;
+            pthread_cond_broadcast(&session->answered_cond);
+            matched = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&session->mutex);
+    cJSON_free(key);
+    return matched;
+}
+
+// =============================================================================
+// STDIO: a server process per session, pipelined requests
+// =============================================================================
+
+typedef struct {
+    replay_session_t *session;
+    int fd;
+} stdio_reader_arg_t;
+
+static void *stdio_reader_thread(void *arg) {
+    stdio_reader_arg_t *reader = (stdio_reader_arg_t*)arg;
+    size_t capacity = REPLAY_READ_BUFFER, start = 0, end = 0;
+    char *buffer = malloc(capacity);
+
+    while (buffer) {
+        char *newline = memchr(buffer + start, '\n', end - start);
+        if (newline) {
+            size_t length = (size_t)(newline - (buffer + start));
+            // Anything that is not JSON-RPC (banners, logging) is skipped
+            if (length > 0 && (buffer[start] == '{' || buffer[start] == '[')) {
+                record_response(reader->session, buffer + start, length);
+            }
+            start += length + 1;
+            continue;
+        }
+
+        if (start > 0) {
+            memmove(buffer, buffer + start, end - start);
+            end -= start;
+            start = 0;
+        }
+        if (end == capacity) {
+            char *grown = realloc(buffer, capacity * 2);
+            if (!grown) break;
+            buffer = grown;
+            capacity *= 2;
+        }
+        ssize_t count = read(reader->fd, buffer + end, capacity - end);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        end += (size_t)count;
+    }
+
+    free(buffer);
+    return NULL;
+}
+
+static pid_t spawn_stdio_server(int *to_server, int *from_server) {
+    int in_pipe[2], out_pipe[2];
+    if (pipe2(in_pipe, O_CLOEXEC) != 0) return -1;
+    if (pipe2(out_pipe, O_CLOEXEC) != 0) {
+        close(in_pipe[0]);
+        close(in_pipe[1]);
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(in_pipe[0], STDIN_FILENO);
+        dup2(out_pipe[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", g_options.stdio_command, (char*)NULL);
+        _exit(127);
+    }
+
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+    if (pid < 0) {
+        close(in_pipe[1]);
+        close(out_pipe[0]);
+        return -1;
+    }
+    *to_server = in_pipe[1];
+    *from_server = out_pipe[0];
+    return pid;
+}
+
+// Reap the server once its stdin is closed, killing it if it does not exit
+static void stop_stdio_server(pid_t pid) {
+    for (int attempt = 0; attempt < 200; attempt++) {
+        if (waitpid(pid, NULL, WNOHANG) == pid) return;
+        usleep(10000);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+static void wait_answered(replay_session_t *session) {
+    uint64_t deadline = now_us() + g_options.timeout_us;
+    pthread_mutex_lock(&session->mutex);
+    while (session->answered < session->expected && now_us() < deadline) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 10000000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&session->answered_cond, &session->mutex, &ts);
+    }
+    pthread_mutex_unlock(&session->mutex);
+}
+
+static void replay_stdio(replay_session_t *session) {
+    int to_server, from_server;
+    pid_t pid = spawn_stdio_server(&to_server, &from_server);
+    if (pid < 0) {
+        fprintf(stderr, "%s: failed to start server\n", session->path);
+        session->failed = session->expected;
+        return;
+    }
+
+    stdio_reader_arg_t reader = { .session = session, .fd = from_server };
+    pthread_t reader_thread;
+    bool reading = pthread_create(&reader_thread, NULL, stdio_reader_thread, &reader) == 0;
+
+    for (size_t i = 0; i < session->count && reading; i++) {
+        replay_request_t *request = &session->requests[i];
+        wait_due(session, request);
+        if (write_all(to_server, request->data, request->length) != 0 || write_all(to_server, "\n", 1) != 0) {
+            break;
+        }
+    }
+
+    if (reading) wait_answered(session);
+    close(to_server);
+    stop_stdio_server(pid);
+    if (reading) pthread_join(reader_thread, NULL);
+    close(from_server);
+}
+
+// =============================================================================
+// HTTP: one keep-alive connection per session
+// =============================================================================
+
+typedef struct {
+    int fd;
+    char *data;
+    size_t start;
+    size_t end;
+} http_reader_t;
+
+static int http_connect(void) {
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *addresses = NULL;
+    if (getaddrinfo(g_options.http_host, g_options.http_port, &hints, &addresses) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo *address = addresses; address && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+static int http_fill(http_reader_t *reader) {
+    if (reader->start > 0) {
+        memmove(reader->data, reader->data + reader->start, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+    }
+    if (reader->end == REPLAY_READ_BUFFER) return -1;
+
+    ssize_t count;
+    do {
+        count = read(reader->fd, reader->data + reader->end, REPLAY_READ_BUFFER - reader->end);
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) return -1;
+    reader->end += (size_t)count;
+    return 0;
+}
+
+static const char *http_line(http_reader_t *reader, size_t *length) {
+    for (;;) {
+        char *line = reader->data + reader->start;
+        char *newline = memchr(line, '\n', reader->end - reader->start);
+        if (newline) {
+            *length = (size_t)(newline - line);
+            if (*length > 0 && line[*length - 1] == '\r') (*length)--;
+            reader->start = (size_t)(newline - reader->data) + 1;
+            return line;
+        }
+        if (http_fill(reader) != 0) return NULL;
+    }
+}
+
+// POST one frame and read the whole response; returns the status code or -1
+static int http_exchange(http_reader_t *reader, replay_session_t *session, const replay_request_t *request) {
+    char head[512];
+    int n = snprintf(head, sizeof(head),
+                     "POST %s HTTP/1.1\r\nHost: %s:%s\r\nContent-Type: application/json\r\n"
+                     "Accept: application/json\r\nContent-Length: %zu\r\n\r\n",
+                     g_options.http_path, g_options.http_host, g_options.http_port, request->length);
+    if (n < 0 || (size_t)n >= sizeof(head) || write_all(reader->fd, head, (size_t)n) != 0 ||
+        write_all(reader->fd, request->data, request->length) != 0) {
+        return -1;
+    }
+
+    size_t length;
+    const char *line = http_line(reader, &length);
+    if (!line || length < 12 || strncmp(line, "HTTP/1.", 7) != 0) return -1;
+    int status = atoi(line + 9);
+
+    size_t content_length = 0;
+    while ((line = http_line(reader, &length)) != NULL && length > 0) {
+        if (length > 15 && strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_length = (size_t)strtoul(line + 15, NULL, 10);
+        }
+    }
+    if (!line || content_length > REPLAY_READ_BUFFER) return -1;
+
+    while (reader->end - reader->start < content_length) {
+        if (http_fill(reader) != 0) return -1;
+    }
+    if (content_length > 0) {
+        record_response(session, reader->data + reader->start, content_length);
+    }
+    reader->start += content_length;
+    return status;
+}
+
+static void replay_http(replay_session_t *session) {
+    http_reader_t reader = { .fd = -1, .data = malloc(REPLAY_READ_BUFFER) };
+    if (!reader.data) {
+        session->failed = session->expected;
+        return;
+    }
+
+    for (size_t i = 0; i < session->count; i++) {
+        replay_request_t *request = &session->requests[i];
+        wait_due(session, request);
+
+        // One reconnect per request: the server may have closed an idle connection
+        int status = -1;
+        for (int attempt = 0; attempt < 2 && status < 0; attempt++) {
+            if (reader.fd < 0) {
+                reader.fd = http_connect();
+                reader.start = reader.end = 0;
+                if (reader.fd < 0) break;
+                request->sent_at = now_us();
+            }
+            status = http_exchange(&reader, session, request);
+            if (status < 0) {
+                close(reader.fd);
+                reader.fd = -1;
+            }
+        }
+        if (status < 0 || status >= 300) {
+            pthread_mutex_lock(&session->mutex);
+            session->failed++;
+            pthread_mutex_unlock(&session->mutex);
+        }
+    }
+
+    if (reader.fd >= 0) close(reader.fd);
+    free(reader.data);
+}
+
+static void *session_thread(void *arg) {
+    replay_session_t *session = (replay_session_t*)arg;
+    if (g_options.stdio_command) {
+        replay_stdio(session);
+    } else {
+        replay_http(session);
+    }
+    return NULL;
+}
+
+// =============================================================================
+// Report
+// =============================================================================
+
+typedef struct {
+    const char *method;
+    uint64_t *captured;         // Sorted latencies (us)
+    uint64_t *replayed;
+    int64_t *deltas;            // Replayed minus captured, for requests with both
+    size_t captured_count;
+    size_t replayed_count;
+    size_t delta_count;
+    size_t requests;
+    size_t unanswered;
+    size_t new_errors;          // Errors in the replay where the capture had none
+} replay_summary_t;
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static int compare_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Nearest-rank percentile of a sorted array
+static double percentile_u64(const uint64_t *sorted, size_t count, double p) {
+    if (count == 0) return 0.0;
+    size_t rank = (size_t)(p * (double)count + 0.999999);
+    if (rank == 0) rank = 1;
+    if (rank > count) rank = count;
+    return (double)sorted[rank - 1];
+}
+
+static double percentile_i64(const int64_t *sorted, size_t count, double p) {
+    if (count == 0) return 0.0;
+    size_t rank = (size_t)(p * (double)count + 0.999999);
+    if (rank == 0) rank = 1;
+    if (rank > count) rank = count;
+    return (double)sorted[rank - 1];
+}
+
+static void summarize(replay_summary_t *summary, const char *method, replay_session_t *sessions,
+                      size_t session_count) {
+    size_t total = 0;
+    for (size_t s = 0; s < session_count; s++) total += sessions[s].count;
+
+    memset(summary, 0, sizeof(*summary));
+    summary->method = method;
+    summary->captured = calloc(total + 1, sizeof(uint64_t));
+    summary->replayed = calloc(total + 1, sizeof(uint64_t));
+    summary->deltas = calloc(total + 1, sizeof(int64_t));
+    if (!summary->captured || !summary->replayed || !summary->deltas) return;
+
+    for (size_t s = 0; s < session_count; s++) {
+        for (size_t i = 0; i < sessions[s].count; i++) {
+            const replay_request_t *request = &sessions[s].requests[i];
+            if (!request->key || (method && strcmp(request->method, method) != 0)) continue;
+
+            summary->requests++;
+            bool captured = request->captured_us != REPLAY_NO_LATENCY;
+            bool replayed = request->replay_us != REPLAY_NO_LATENCY;
+            if (captured) summary->captured[summary->captured_count++] = request->captured_us;
+            if (replayed) summary->replayed[summary->replayed_count++] = request->replay_us;
+            else summary->unanswered++;
+            if (captured && replayed) {
+                summary->deltas[summary->delta_count++] =
+                    (int64_t)request->replay_us - (int64_t)request->captured_us;
+            }
+            if (replayed && request->replay_error && !request->captured_error) summary->new_errors++;
+        }
+    }
+
+    qsort(summary->captured, summary->captured_count, sizeof(uint64_t), compare_u64);
+    qsort(summary->replayed, summary->replayed_count, sizeof(uint64_t), compare_u64);
+    qsort(summary->deltas, summary->delta_count, sizeof(int64_t), compare_i64);
+}
+
+static void free_summary(replay_summary_t *summary) {
+    free(summary->captured);
+    free(summary->replayed);
+    free(summary->deltas);
+}
+
+static cJSON *report_summary(const replay_summary_t *summary) {
+    double captured_p50 = percentile_u64(summary->captured, summary->captured_count, 0.50);
+    double captured_p99 = percentile_u64(summary->captured, summary->captured_count, 0.99);
+    double replay_p50 = percentile_u64(summary->replayed, summary->replayed_count, 0.50);
+    double replay_p99 = percentile_u64(summary->replayed, summary->replayed_count, 0.99);
+    double delta_p50 = percentile_i64(summary->deltas, summary->delta_count, 0.50);
+    double delta_p99 = percentile_i64(summary->deltas, summary->delta_count, 0.99);
+
+    printf("%-28s %8zu  captured p50 %9.0f p99 %9.0f  replay p50 %9.0f p99 %9.0f  "
+           "delta p50 %+9.0f p99 %+9.0f  unanswered %zu  new errors %zu\n",
+           summary->method ? summary->method : "all", summary->requests,
+           captured_p50, captured_p99, replay_p50, replay_p99, delta_p50, delta_p99,
+           summary->unanswered, summary->new_errors);
+
+    cJSON *result = cJSON_CreateObject();
+    cJSON_AddStringToObject(result, "method", summary->method ? summary->method : "all");
+    cJSON_AddNumberToObject(result, "requests", (double)summary->requests);
+    cJSON_AddNumberToObject(result, "unanswered", (double)summary->unanswered);
+    cJSON_AddNumberToObject(result, "new_errors", (double)summary->new_errors);
+    cJSON_AddNumberToObject(result, "captured_p50_us", captured_p50);
+    cJSON_AddNumberToObject(result, "captured_p99_us", captured_p99);
+    cJSON_AddNumberToObject(result, "replay_p50_us", replay_p50);
+    cJSON_AddNumberToObject(result, "replay_p99_us", replay_p99);
+    cJSON_AddNumberToObject(result, "delta_p50_us", delta_p50);
+    cJSON_AddNumberToObject(result, "delta_p99_us", delta_p99);
+    return result;
+}
+
+static cJSON *report(replay_session_t *sessions, size_t session_count, uint64_t elapsed_us) {
+    size_t late = 0, failed = 0, requests = 0;
+    uint64_t max_late = 0;
+    for (size_t s = 0; s < session_count; s++) {
+        late += sessions[s].late;
+        failed += sessions[s].failed;
+        requests += sessions[s].count;
+        if (sessions[s].max_late_us > max_late) max_late = sessions[s].max_late_us;
+    }
+
+    printf("Replayed %zu frames from %zu sessions in %.3f s (speed %s%g), %zu sent late (max %.1f ms), "
+           "%zu failed\n", requests, session_count, (double)elapsed_us / 1e6,
+           g_options.speed > 0 ? "x" : "max ", g_options.speed, late, (double)max_late / 1000.0, failed);
+    printf("Latencies in microseconds\n");
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "transport", g_options.stdio_command ? "stdio" : "http");
+    cJSON_AddNumberToObject(root, "speed", g_options.speed);
+    cJSON_AddNumberToObject(root, "sessions", (double)session_count);
+    cJSON_AddNumberToObject(root, "frames", (double)requests);
+    cJSON_AddNumberToObject(root, "elapsed_us", (double)elapsed_us);
+    cJSON_AddNumberToObject(root, "late_sends", (double)late);
+    cJSON_AddNumberToObject(root, "max_late_us", (double)max_late);
+    cJSON_AddNumberToObject(root, "failed", (double)failed);
+
+    replay_summary_t summary;
+    summarize(&summary, NULL, sessions, session_count);
+    cJSON_AddItemToObject(root, "overall", report_summary(&summary));
+    free_summary(&summary);
+
+    // One line per method, in order of first appearance
+    cJSON *methods = cJSON_AddArrayToObject(root, "methods");
+    for (size_t s = 0; s < session_count; s++) {
+        for (size_t i = 0; i < sessions[s].count; i++) {
+            const replay_request_t *request = &sessions[s].requests[i];
+            if (!request->key) continue;
+
+            bool seen = false;
+            for (size_t t = 0; t <= s && !seen; t++) {
+                size_t limit = t == s ? i : sessions[t].count;
+                for (size_t j = 0; j < limit && !seen; j++) {
+                    const replay_request_t *earlier = &sessions[t].requests[j];
+                    seen = earlier->key && strcmp(earlier->method, request->method) == 0;
+                }
+            }
+            if (seen) continue;
+
+            summarize(&summary, request->method, sessions, session_count);
+            cJSON_AddItemToArray(methods, report_summary(&summary));
+            free_summary(&summary);
+        }
+    }
+    return root;
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+static int parse_http_url(const char *url) {
+    if (strncmp(url, "http://", 7) != 0) return -1;
+    const char *host = url + 7;
+    const char *path = strchr(host, '/');
+    size_t host_length = path ? (size_t)(path - host) : strlen(host);
+
+    g_options.http_host = strndup(host, host_length);
+    g_options.http_path = strdup(path ? path : "/mcp");
+    if (!g_options.http_host || !g_options.http_path) return -1;
+
+    char *colon = strrchr(g_options.http_host, ':');
+    if (colon && !strchr(colon, ']')) {
+        *colon = '\0';
+        snprintf(g_options.http_port, sizeof(g_options.http_port), "%s", colon + 1);
+    } else {
+        snprintf(g_options.http_port, sizeof(g_options.http_port), "80");
+    }
+    return g_options.http_host[0] ? 0 : -1;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s (--stdio COMMAND | --http URL) [options] CAPTURE...\n", program);
+    printf("  -s, --stdio COMMAND   Start COMMAND (through /bin/sh) for every session\n");
+    printf("  -u, --http URL        Send to a running server, e.g. http://127.0.0.1:9943/mcp\n");
+    printf("  -x, --speed N         1 = captured timing, N = N times faster, 0 = max speed [default: 1]\n");
+    printf("  -t, --timeout SEC     Wait for outstanding responses after the last send [default: 10]\n");
+    printf("  -o, --output FILE     Also write the report as JSON\n");
+    printf("  -h, --help            Show this help\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *output = NULL;
+    const char *http_url = NULL;
+    g_options.speed = 1.0;
+    g_options.timeout_us = 10 * 1000000ull;
+
+    static struct option long_options[] = {
+        {"stdio", required_argument, 0, 's'},
+        {"http", required_argument, 0, 'u'},
+        {"speed", required_argument, 0, 'x'},
+        {"timeout", required_argument, 0, 't'},
+        {"output", required_argument, 0, 'o'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "s:u:x:t:o:h", long_options, NULL)) != -1) {
+        switch (c) {
+            case 's': g_options.stdio_command = optarg; break;
+            case 'u': http_url = optarg; break;
+            case 'x': g_options.speed = atof(optarg); break;
+            case 't': g_options.timeout_us = (uint64_t)(atof(optarg) * 1e6); break;
+            case 'o': output = optarg; break;
+            case 'h': print_usage(argv[0]); return 0;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    if (!g_options.stdio_command == !http_url || optind >= argc || g_options.speed < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (http_url && parse_http_url(http_url) != 0) {
+        fprintf(stderr, "Invalid URL: %s\n", http_url);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    size_t session_count = (size_t)(argc - optind);
+    replay_session_t *sessions = calloc(session_count, sizeof(replay_session_t));
+    if (!sessions) return 1;
+
+    size_t loaded = 0;
+    for (int i = optind; i < argc; i++) {
+        if (load_session(&sessions[loaded], argv[i]) == 0) loaded++;
+    }
+    if (loaded == 0) {
+        free(sessions);
+        return 1;
+    }
+
+    // Sessions keep their captured offsets to each other
+    uint64_t first_start = UINT64_MAX;
+    for (size_t s = 0; s < loaded; s++) {
+        if (sessions[s].start_us < first_start) first_start = sessions[s].start_us;
+    }
+    for (size_t s = 0; s < loaded; s++) {
+        uint64_t offset = sessions[s].start_us - first_start;
+        for (size_t i = 0; i < sessions[s].count; i++) {
+            replay_request_t *request = &sessions[s].requests[i];
+            request->due_us = g_options.speed > 0 ?
+                (uint64_t)((double)(offset + request->due_us) / g_options.speed) : 0;
+        }
+    }
+
+    pthread_t *threads = calloc(loaded, sizeof(pthread_t));
+    bool *started = calloc(loaded, sizeof(bool));
+    g_options.run_start = now_us();
+    for (size_t s = 0; threads && started && s < loaded; s++) {
+        started[s] = pthread_create(&threads[s], NULL, session_thread, &sessions[s]) == 0;
+    }
+    for (size_t s = 0; threads && started && s < loaded; s++) {
+        if (started[s]) pthread_join(threads[s], NULL);
+    }
+    uint64_t elapsed = now_us() - g_options.run_start;
+
+    int result = 0;
+    cJSON *root = report(sessions, loaded, elapsed);
+    if (output) {
+        char *text = cJSON_Print(root);
+        FILE *file = text ? fopen(output, "w") : NULL;
+        if (file) {
+            fprintf(file, "%s\n", text);
+            fclose(file);
+        } else {
+            fprintf(stderr, "Failed to write %s\n", output);
+            result = 1;
+        }
+        cJSON_free(text);
+    }
+    cJSON_Delete(root);
+
+    for (size_t s = 0; s < loaded; s++) free_session(&sessions[s]);
+    free(sessions);
+    free(threads);
+    free(started);
+    free(g_options.http_host);
+    free(g_options.http_path);
+    return result;
+}
@@ -0,0 +1,387 @@
+#include "application/list_notifier.h"
+#include "transport/http_transport.h"
+#include "utils/logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+static const char *const g_list_methods[MCP_LIST_COUNT] = {
+    "notifications/tools/list_changed",
+    "notifications/resources/list_changed"
+};
+
+static uint64_t notifier_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+static bool subscriber_matches(const mcp_list_subscriber_t *subscriber, const mcp_connection_t *connection) {
+    return subscriber->connection.transport == connection->transport &&
+           subscriber->connection.private_data == connection->private_data;
+}
+
+// Copies only borrow the connection
+static void subscriber_copy(mcp_list_subscriber_t *target, const mcp_list_subscriber_t *source) {
+    *target = *source;
+    if (source->connection.session_id) {
+        target->connection.session_id = target->session_id;
+    }
+    target->session = NULL;
+    target->resources = NULL;
+    target->next = NULL;
+}
+
+static void subscriber_free(mcp_list_subscriber_t *subscriber) {
+    mcp_session_unref(subscriber->session);
+    mcp_subscription_set_destroy(subscriber->resources);
+    free(subscriber);
+}
+
+// Resource subscriptions that apply to the subscriber, NULL if none
+static mcp_subscription_set_t *subscriber_resources(const mcp_list_subscriber_t *subscriber) {
+    if (subscriber->session) {
+        return mcp_session_get_subscriptions(subscriber->session, false);
+    }
+    return subscriber->resources;
+}
+
+static int subscriber_send(mcp_list_subscriber_t *subscriber, const char *message, size_t length) {
+    mcp_connection_t *connection = &subscriber->connection;
+    int result = subscriber->event_stream
+        ? mcp_http_transport_stream_event(connection, message, length)
+        : mcp_connection_send(connection, message, length);
+    if (result < 0) {
+        mcp_log_debug("Notification not delivered to %s",
+                      connection->session_id ? connection->session_id : "client");
+    }
+    return result;
+}
+
+// Copy the subscribers, so they can be written to without the lock. Caller holds mutex.
+static mcp_list_subscriber_t *notifier_snapshot(mcp_list_notifier_t *notifier, size_t *count) {
+    *count = 0;
+    if (notifier->subscriber_count == 0) return NULL;
+
+    mcp_list_subscriber_t *copies = malloc(notifier->subscriber_count * sizeof(mcp_list_subscriber_t));
+    if (!copies) return NULL;
+
+    for (mcp_list_subscriber_t *subscriber = notifier->subscribers; subscriber; subscriber = subscriber->next) {
+        subscriber_copy(&copies[(*count)++], subscriber);
+    }
+    return copies;
+}
+
+static void notifier_send(mcp_list_notifier_t *notifier, mcp_list_subscriber_t *subscribers, size_t count,
+                          unsigned int lists, const uint64_t *versions, uint64_t last_change_ms) {
+    for (int list = 0; list < MCP_LIST_COUNT; list++) {
+        if (!(lists & (1u << list))) continue;
+
+        char message[160];
+        int length = snprintf(message, sizeof(message),
+                              "{\"jsonrpc\":\"2.0\",\"method\":\"%s\",\"params\":{\"version\":%llu}}",
+                              g_list_methods[list], (unsigned long long)versions[list]);
+        if (length < 0 || (size_t)length >= sizeof(message)) continue;
+
+        for (size_t i = 0; i < count; i++) {
+            // Subscribed after the changes, e.g. during the initialize handshake
+            if (subscribers[i].since_ms > last_change_ms) continue;
+
+            if (subscriber_send(&subscribers[i], message, (size_t)length) < 0) continue;
+            __atomic_add_fetch(&notifier->notifications_sent, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Sends pending changes once their deadline has passed
+static void *notifier_thread(void *arg) {
+    mcp_list_notifier_t *notifier = (mcp_list_notifier_t*)arg;
+
+    pthread_mutex_lock(&notifier->mutex);
+    while (notifier->running) {
+        if (!notifier->pending) {
+            pthread_cond_wait(&notifier->cond, &notifier->mutex);
+            continue;
+        }
+
+        uint64_t now = notifier_now_ms();
+        if (now < notifier->deadline_ms) {
+            struct timespec until = {
+                .tv_sec = (time_t)(notifier->deadline_ms / 1000u),
+                .tv_nsec = (long)(notifier->deadline_ms % 1000u) * 1000000L
+            };
+            pthread_cond_timedwait(&notifier->cond, &notifier->mutex, &until);
+            continue;
+        }
+
+        unsigned int lists = notifier->pending;
+        uint64_t versions[MCP_LIST_COUNT];
+        memcpy(versions, notifier->versions, sizeof(versions));
+        uint64_t last_change_ms = notifier->last_change_ms;
+        notifier->pending = 0;
+
+        size_t count = 0;
+        mcp_list_subscriber_t *subscribers = notifier_snapshot(notifier, &count);
+        notifier->sending++;
+        pthread_mutex_unlock(&notifier->mutex);
+
+        notifier_send(notifier, subscribers, count, lists, versions, last_change_ms);
+        free(subscribers);
+
+        pthread_mutex_lock(&notifier->mutex);
+        notifier->sending--;
+        pthread_cond_broadcast(&notifier->cond);
+    }
+    pthread_mutex_unlock(&notifier->mutex);
+
+    return NULL;
+}
+
+mcp_list_notifier_t *mcp_list_notifier_create(uint32_t debounce_ms) {
+    mcp_list_notifier_t *notifier = calloc(1, sizeof(mcp_list_notifier_t));
+    if (!notifier) return NULL;
+
+    notifier->debounce_ms = debounce_ms > 0 ? debounce_ms : MCP_LIST_NOTIFIER_DEFAULT_DEBOUNCE_MS;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (pthread_mutex_init(&notifier->mutex, NULL) != 0) {
+        pthread_condattr_destroy(&attr);
+        free(notifier);
+        return NULL;
+    }
+    if (pthread_cond_init(&notifier->cond, &attr) != 0) {
+        pthread_condattr_destroy(&attr);
+        pthread_mutex_destroy(&notifier->mutex);
+        free(notifier);
+        return NULL;
+    }
+    pthread_condattr_destroy(&attr);
+
+    notifier->running = true;
+    if (pthread_create(&notifier->thread, NULL, notifier_thread, notifier) != 0) {
+        pthread_cond_destroy(&notifier->cond);
+        pthread_mutex_destroy(&notifier->mutex);
+        free(notifier);
+        return NULL;
+    }
+
+    return notifier;
+}
+
+void mcp_list_notifier_destroy(mcp_list_notifier_t *notifier) {
+    if (!notifier) return;
+
+    pthread_mutex_lock(&notifier->mutex);
+    notifier->running = false;
+    pthread_cond_broadcast(&notifier->cond);
+    pthread_mutex_unlock(&notifier->mutex);
+    pthread_join(notifier->thread, NULL);
+
+    mcp_list_subscriber_t *subscriber = notifier->subscribers;
+    while (subscriber) {
+        mcp_list_subscriber_t *next = subscriber->next;
+        subscriber_free(subscriber);
+        subscriber = next;
+    }
+
+    pthread_cond_destroy(&notifier->cond);
+    pthread_mutex_destroy(&notifier->mutex);
+    free(notifier);
+}
+
+void mcp_list_notifier_changed(mcp_list_notifier_t *notifier, mcp_list_kind_t list, uint64_t version) {
+    if (!notifier || list >= MCP_LIST_COUNT) return;
+
+    pthread_mutex_lock(&notifier->mutex);
+    if (notifier->versions[list] == version) {
+        pthread_mutex_unlock(&notifier->mutex);
+        return;
+    }
+    notifier->versions[list] = version;
+
+    // Each change pushes the deadline out again, up to the maximum delay
+    uint64_t now = notifier_now_ms();
+    if (notifier->pending) {
+        __atomic_add_fetch(&notifier->changes_coalesced, 1, __ATOMIC_RELAXED);
+    } else {
+        notifier->first_change_ms = now;
+    }
+    notifier->last_change_ms = now;
+    uint64_t latest = notifier->first_change_ms +
+                      (uint64_t)notifier->debounce_ms * MCP_LIST_NOTIFIER_MAX_DELAY_FACTOR;
+    uint64_t deadline = now + notifier->debounce_ms;
+    notifier->deadline_ms = deadline < latest ? deadline : latest;
+    notifier->pending |= 1u << list;
+
+    pthread_cond_broadcast(&notifier->cond);
+    pthread_mutex_unlock(&notifier->mutex);
+}
+
+int mcp_list_notifier_subscribe(mcp_list_notifier_t *notifier, const mcp_connection_t *connection,
+                                bool event_stream, mcp_session_t *session) {
+    if (!notifier || !connection || !connection->transport) return -1;
+
+    mcp_list_subscriber_t *subscriber = calloc(1, sizeof(mcp_list_subscriber_t));
+    if (!subscriber) return -1;
+
+    subscriber->connection = *connection;
+    subscriber->connection.session_id = NULL;
+    if (connection->session_id) {
+        size_t length = strlen(connection->session_id);
+        if (length < sizeof(subscriber->session_id)) {
+            memcpy(subscriber->session_id, connection->session_id, length + 1);
+            subscriber->connection.session_id = subscriber->session_id;
+        }
+    }
+    subscriber->event_stream = event_stream;
+    subscriber->since_ms = notifier_now_ms();
+    subscriber->session = mcp_session_ref(session);
+
+    pthread_mutex_lock(&notifier->mutex);
+    mcp_list_subscriber_t **link = &notifier->subscribers;
+    while (*link && !subscriber_matches(*link, connection)) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        // Same connection again, e.g. after a second initialize: it starts afresh
+        mcp_list_subscriber_t *previous = *link;
+        subscriber->next = previous->next;
+        *link = subscriber;
+        subscriber_free(previous);
+    } else {
+        subscriber->next = notifier->subscribers;
+        notifier->subscribers = subscriber;
+        notifier->subscriber_count++;
+    }
+    pthread_mutex_unlock(&notifier->mutex);
+
+    return 0;
+}
+
+void mcp_list_notifier_unsubscribe(mcp_list_notifier_t *notifier, const mcp_connection_t *connection) {
+    if (!notifier || !connection) return;
+
+    pthread_mutex_lock(&notifier->mutex);
+    for (mcp_list_subscriber_t **link = &notifier->subscribers; *link; link = &(*link)->next) {
+        if (subscriber_matches(*link, connection)) {
+            mcp_list_subscriber_t *subscriber = *link;
+            *link = subscriber->next;
+            notifier->subscriber_count--;
+            subscriber_free(subscriber);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&notifier->mutex);
+}
+
+void mcp_list_notifier_close_all(mcp_list_notifier_t *notifier) {
+    if (!notifier) return;
+
+    pthread_mutex_lock(&notifier->mutex);
+    mcp_list_subscriber_t *subscribers = notifier->subscribers;
+    notifier->subscribers = NULL;
+    notifier->subscriber_count = 0;
+    notifier->pending = 0;
+    while (notifier->sending) {
+        pthread_cond_wait(&notifier->cond, &notifier->mutex);
+    }
+    pthread_mutex_unlock(&notifier->mutex);
+
+    while (subscribers) {
+        mcp_list_subscriber_t *next = subscribers->next;
+        if (subscribers->event_stream) {
+            mcp_http_transport_stream_end(&subscribers->connection, NULL, 0);
+        }
+        subscriber_free(subscribers);
+        subscribers = next;
+    }
+}
+
+size_t mcp_list_notifier_subscriber_count(mcp_list_notifier_t *notifier) {
+    if (!notifier) return 0;
+
+    pthread_mutex_lock(&notifier->mutex);
+    size_t count = notifier->subscriber_count;
+    pthread_mutex_unlock(&notifier->mutex);
+    return count;
+}
+
+int mcp_list_notifier_subscribe_resource(mcp_list_notifier_t *notifier, const mcp_connection_t *connection,
+                                         const char *uri, bool subscribe) {
+    if (!notifier || !connection || !uri) return -1;
+
+    pthread_mutex_lock(&notifier->mutex);
+    mcp_list_subscriber_t *subscriber = notifier->subscribers;
+    while (subscriber && !subscriber_matches(subscriber, connection)) {
+        subscriber = subscriber->next;
+    }
+
+    int result = -1;
+    if (subscriber && !subscriber->session) {
+        if (!subscribe) {
+            result = mcp_subscription_set_remove(subscriber->resources, uri);
+        } else {
+            if (!subscriber->resources) {
+                subscriber->resources = mcp_subscription_set_create();
+            }
+            result = mcp_subscription_set_add(subscriber->resources, uri);
+        }
+    }
+    pthread_mutex_unlock(&notifier->mutex);
+    return result;
+}
+
+bool mcp_list_notifier_wants_resource(mcp_list_notifier_t *notifier, const char *uri) {
+    if (!notifier || !uri) return false;
+
+    bool wanted = false;
+    pthread_mutex_lock(&notifier->mutex);
+    for (mcp_list_subscriber_t *subscriber = notifier->subscribers; subscriber && !wanted;
+         subscriber = subscriber->next) {
+        wanted = mcp_subscription_set_contains(subscriber_resources(subscriber), uri);
+    }
+    pthread_mutex_unlock(&notifier->mutex);
+    return wanted;
+}
+
+size_t mcp_list_notifier_resource_updated(mcp_list_notifier_t *notifier, const char *uri,
+                                          const char *message, size_t length) {
+    if (!notifier || !uri || !message) return 0;
+
+    pthread_mutex_lock(&notifier->mutex);
+    mcp_list_subscriber_t *recipients = NULL;
+    size_t count = 0;
+    if (notifier->subscriber_count > 0) {
+        recipients = malloc(notifier->subscriber_count * sizeof(mcp_list_subscriber_t));
+    }
+    for (mcp_list_subscriber_t *subscriber = notifier->subscribers; subscriber && recipients;
+         subscriber = subscriber->next) {
+        if (mcp_subscription_set_contains(subscriber_resources(subscriber), uri)) {
+            subscriber_copy(&recipients[count++], subscriber);
+        }
+    }
+    if (count == 0) {
+        pthread_mutex_unlock(&notifier->mutex);
+        free(recipients);
+        return 0;
+    }
+    notifier->sending++;
+    pthread_mutex_unlock(&notifier->mutex);
+
+    size_t sent = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (subscriber_send(&recipients[i], message, length) >= 0) sent++;
+    }
+    free(recipients);
+    __atomic_add_fetch(&notifier->resource_updates_sent, sent, __ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&notifier->mutex);
+    notifier->sending--;
+    pthread_cond_broadcast(&notifier->cond);
+    pthread_mutex_unlock(&notifier->mutex);
+
+    return sent;
+}
@@ -0,0 +1,132 @@
+#ifndef MCP_LIST_NOTIFIER_H
+#define MCP_LIST_NOTIFIER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "transport/transport_interface.h"
+#include "application/session_manager.h"
+#include "application/subscription_set.h"
+
+// Pushes notifications/tools/list_changed and notifications/resources/list_changed to
+// the clients listening for them, so they can stop polling the list methods. Changes
+// are debounced: a burst of registrations becomes one notification per list, sent once
+// the registry has been quiet for the debounce interval (or at the latest after
+// MCP_LIST_NOTIFIER_MAX_DELAY_FACTOR intervals). Each notification carries the
+// registry version, params.version, which only grows.
+//
+// The same clients receive notifications/resources/updated for the resources they
+// subscribed to: a session's subscriptions go to its event streams, a STDIO or UART
+// client's to its connection.
+
+typedef struct mcp_list_notifier mcp_list_notifier_t;
+
+// Lists a client can be told about
+typedef enum {
+    MCP_LIST_TOOLS = 0,
+    MCP_LIST_RESOURCES,
+    MCP_LIST_COUNT
+} mcp_list_kind_t;
+
+#ifndef MCP_LIST_NOTIFIER_DEFAULT_DEBOUNCE_MS
+#define MCP_LIST_NOTIFIER_DEFAULT_DEBOUNCE_MS 100
+#endif
+
+// A steady stream of changes is still reported every few intervals
+#define MCP_LIST_NOTIFIER_MAX_DELAY_FACTOR 5
+
+// Session ids kept with a subscriber (longer ones are dropped from the copy)
+#define MCP_LIST_NOTIFIER_SESSION_ID_MAX 160
+
+// Client listening for changes (internal)
+typedef struct mcp_list_subscriber {
+    mcp_connection_t connection;    // Copy; session_id points at session_id below
+    char session_id[MCP_LIST_NOTIFIER_SESSION_ID_MAX];
+    bool event_stream;              // HTTP GET stream rather than the connection itself
+    uint64_t since_ms;              // Changes before this are already in what it listed
+    mcp_session_t *session;         // Session of an event stream (referenced), holds its subscriptions
+    mcp_subscription_set_t *resources;  // Subscriptions of a client without a session
+    struct mcp_list_subscriber *next;
+} mcp_list_subscriber_t;
+
+struct mcp_list_notifier {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;            // Monotonic clock
+    pthread_t thread;
+    bool running;
+    int sending;                    // Threads writing to a snapshot of the subscribers
+
+    uint32_t debounce_ms;
+    unsigned int pending;           // Bit per mcp_list_kind_t
+    uint64_t versions[MCP_LIST_COUNT];
+    uint64_t first_change_ms;       // Oldest change not yet sent
+    uint64_t last_change_ms;        // Newest
+    uint64_t deadline_ms;           // When the pending lists are sent
+
+    mcp_list_subscriber_t *subscribers;
+    size_t subscriber_count;
+
+    // Statistics (atomic)
+    uint64_t notifications_sent;    // Per subscriber and list
+    uint64_t changes_coalesced;     // Changes folded into a notification already pending
+    uint64_t resource_updates_sent; // resources/updated, per subscriber
+};
+
+/**
+ * Create a notifier and start its thread
+ * @param debounce_ms Quiet time before pending changes are sent (0: default)
+ * @return Notifier, or NULL on error
+ */
+mcp_list_notifier_t *mcp_list_notifier_create(uint32_t debounce_ms);
+
+// Stop the thread and drop all subscribers without notifying them
+void mcp_list_notifier_destroy(mcp_list_notifier_t *notifier);
+
+/**
+ * Record a registry version. A version different from the last one recorded for
+ * the list schedules a notification; the same version again is ignored.
+ */
+void mcp_list_notifier_changed(mcp_list_notifier_t *notifier, mcp_list_kind_t list, uint64_t version);
+
+/**
+ * Add a client. The connection is copied; one subscriber is kept per transport
+ * connection (transport and private_data), a second call replaces the first.
+ * @param event_stream The connection is an open HTTP event stream (GET <endpoint>)
+ * @param session Session the stream belongs to (referenced while subscribed), or NULL
+ * @return 0 on success, -1 on error
+ */
+int mcp_list_notifier_subscribe(mcp_list_notifier_t *notifier, const mcp_connection_t *connection,
+                                bool event_stream, mcp_session_t *session);
+
+// Remove the client on this connection, if any (e.g. once it has closed)
+void mcp_list_notifier_unsubscribe(mcp_list_notifier_t *notifier, const mcp_connection_t *connection);
+
+// Remove every client, ending their event streams; pending changes are dropped. Returns
+// once no notification is being written, so the transports may then be stopped.
+void mcp_list_notifier_close_all(mcp_list_notifier_t *notifier);
+
+// Number of clients listening
+size_t mcp_list_notifier_subscriber_count(mcp_list_notifier_t *notifier);
+
+/**
+ * resources/subscribe or resources/unsubscribe for a client without a session, which
+ * must be listening already (after notifications/initialized)
+ * @return 1 if the subscriptions changed, 0 if not, -1 when the client is not
+ *         listening or has too many subscriptions
+ */
+int mcp_list_notifier_subscribe_resource(mcp_list_notifier_t *notifier, const mcp_connection_t *connection,
+                                         const char *uri, bool subscribe);
+
+// Whether a listening client is subscribed to uri
+bool mcp_list_notifier_wants_resource(mcp_list_notifier_t *notifier, const char *uri);
+
+/**
+ * Send a notifications/resources/updated message, on the calling thread, to every
+ * listening client subscribed to uri
+ * @return Number of clients it was sent to
+ */
+size_t mcp_list_notifier_resource_updated(mcp_list_notifier_t *notifier, const char *uri,
+                                          const char *message, size_t length);
+
+#endif // MCP_LIST_NOTIFIER_H
@@ -1,4 +1,6 @@
 #include "session_manager.h"
+#include "session_store.h"
+#include "subscription_set.h"
 #include "hal/platform_hal.h"
 #include "utils/logging.h"
 #include <stdlib.h>
@@ -10,10 +12,7 @@
 
 // 生成会话ID - 使用UUID4
 char *mcp_session_generate_id(void) {
-    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
-    if (!hal) return NULL;
-
-    char *session_id = hal->memory.alloc(UUID4_STR_BUFFER_SIZE); // UUID字符串 + null terminator
+    char *session_id = malloc(UUID4_STR_BUFFER_SIZE); // UUID字符串 + null terminator，调用者用free()释放
     if (!session_id) return NULL;
 
     // 使用UUID4库生成标准UUID
@@ -29,7 +28,7 @@ char *mcp_session_generate_id(void) {
     uuid4_gen(&state, &uuid);
 
     if (!uuid4_to_s(uuid, session_id, UUID4_STR_BUFFER_SIZE)) {
-        hal->memory.free(session_id);
+        free(session_id);
         return NULL;
     }
 
@@ -63,6 +62,265 @@ bool mcp_session_validate_id(const char *session_id) {
     return true;
 }
 
+// 会话ID哈希 (FNV-1a)
+static uint32_t session_id_hash(const char *session_id) {
+    uint32_t hash = 2166136261u;
+    while (*session_id) {
+        hash ^= (unsigned char)*session_id++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static mcp_session_shard_t *session_shard_for(mcp_session_manager_t *manager, uint32_t hash) {
+    return &manager->shards[(hash >> 16) % MCP_SESSION_SHARD_COUNT];
+}
+
+static mcp_session_page_t *session_slot_page(const mcp_session_shard_t *shard, uint32_t slot) {
+    return shard->pages[slot >> MCP_SESSION_PAGE_SHIFT];
+}
+
+#define SLOT_INDEX(slot) ((slot) & (MCP_SESSION_PAGE_SLOTS - 1))
+#define SESSION_NEVER_EXPIRES ((time_t)(((uint64_t)1 << (sizeof(time_t) * 8 - 1)) - 1))
+
+// 在分片中查找会话，调用者需持有分片锁；只在哈希相同时才访问会话对象
+static mcp_session_t *session_shard_lookup(mcp_session_shard_t *shard, uint32_t hash,
+                                           const char *session_id) {
+    uint32_t slot = shard->buckets[hash & (shard->bucket_count - 1)];
+    while (slot != MCP_SESSION_SLOT_NONE) {
+        mcp_session_page_t *page = session_slot_page(shard, slot);
+        uint32_t index = SLOT_INDEX(slot);
+        if (page->hash[index] == hash && strcmp(page->sessions[index]->session_id, session_id) == 0) {
+            return page->sessions[index];
+        }
+        slot = page->next[index];
+    }
+    return NULL;
+}
+
+// 新增一页空闲槽位，调用者需持有分片写锁
+static int session_shard_grow(mcp_session_shard_t *shard) {
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+
+    mcp_session_page_t **pages = hal->memory.alloc((shard->page_count + 1) * sizeof(mcp_session_page_t*));
+    if (!pages) return -1;
+    mcp_session_page_t *page = hal->memory.alloc(sizeof(mcp_session_page_t));
+    if (!page) {
+        hal->memory.free(pages);
+        return -1;
+    }
+    memset(page, 0, sizeof(mcp_session_page_t));
+
+    uint32_t base = (uint32_t)shard->page_count << MCP_SESSION_PAGE_SHIFT;
+    for (uint32_t i = 0; i < MCP_SESSION_PAGE_SLOTS; i++) {
+        page->expires_at[i] = SESSION_NEVER_EXPIRES;
+        page->state[i] = MCP_SESSION_STATE_TERMINATED;
+        page->next[i] = i + 1 < MCP_SESSION_PAGE_SLOTS ? base + i + 1 : shard->free_slot;
+    }
+
+    if (shard->page_count > 0) {
+        memcpy(pages, shard->pages, shard->page_count * sizeof(mcp_session_page_t*));
+    }
+    hal->memory.free(shard->pages);
+    pages[shard->page_count++] = page;
+    shard->pages = pages;
+    shard->free_slot = base;
+    return 0;
+}
+
+// 为会话分配槽位并挂入哈希链，调用者需持有分片写锁
+static int session_shard_link(mcp_session_shard_t *shard, mcp_session_t *session, time_t expires_at) {
+    if (shard->free_slot == MCP_SESSION_SLOT_NONE && session_shard_grow(shard) != 0) {
+        return -1;
+    }
+
+    uint32_t slot = shard->free_slot;
+    mcp_session_page_t *page = session_slot_page(shard, slot);
+    uint32_t index = SLOT_INDEX(slot);
+    shard->free_slot = page->next[index];
+
+    uint32_t *bucket = &shard->buckets[session->hash & (shard->bucket_count - 1)];
+    page->hash[index] = session->hash;
+    page->state[index] = (uint8_t)session->state;
+    page->expires_at[index] = expires_at;
+    page->last_activity[index] = session->last_activity;
+    page->dirty[index] = 0;
+    page->sessions[index] = session;
+    page->next[index] = *bucket;
+    *bucket = slot;
+
+    session->slot = slot;
+    __atomic_store_n(&session->page, page, __ATOMIC_RELEASE);
+    shard->count++;
+    return 0;
+}
+
+// 从分片中摘除会话并归还槽位，热字段留在会话对象里；调用者需持有分片写锁
+static void session_shard_unlink(mcp_session_shard_t *shard, mcp_session_t *session) {
+    if (!session->page) return;
+
+    uint32_t slot = session->slot;
+    mcp_session_page_t *page = session->page;
+    uint32_t index = SLOT_INDEX(slot);
+
+    uint32_t *link = &shard->buckets[session->hash & (shard->bucket_count - 1)];
+    while (*link != slot) {
+        link = &session_slot_page(shard, *link)->next[SLOT_INDEX(*link)];
+    }
+    *link = page->next[index];
+
+    session->state = (mcp_session_state_t)page->state[index];
+    session->last_activity = __atomic_load_n(&page->last_activity[index], __ATOMIC_RELAXED);
+    __atomic_store_n(&session->page, NULL, __ATOMIC_RELEASE);
+    session->manager = NULL;
+    session->slot = MCP_SESSION_SLOT_NONE;
+
+    page->expires_at[index] = SESSION_NEVER_EXPIRES;
+    page->state[index] = MCP_SESSION_STATE_TERMINATED;
+    page->sessions[index] = NULL;
+    page->next[index] = shard->free_slot;
+    shard->free_slot = slot;
+    shard->count--;
+}
+
+// 会话仍在表中时锁住它的分片并返回槽位页；已离开表时返回NULL且不持锁
+static mcp_session_page_t *session_lock(const mcp_session_t *session, bool write,
+                                        mcp_session_shard_t **shard_out) {
+    mcp_session_manager_t *manager = __atomic_load_n(&session->manager, __ATOMIC_ACQUIRE);
+    if (!manager) return NULL;
+
+    mcp_session_shard_t *shard = session_shard_for(manager, session->hash);
+    if (write) {
+        pthread_rwlock_wrlock(&shard->lock);
+    } else {
+        pthread_rwlock_rdlock(&shard->lock);
+    }
+    if (!session->page) {
+        pthread_rwlock_unlock(&shard->lock);
+        return NULL;
+    }
+
+    *shard_out = shard;
+    return session->page;
+}
+
+// 客户端信息记录：同一客户端版本的所有会话共享一份，按引用计数释放
+#define SESSION_CLIENT_BUCKETS 64
+
+struct mcp_session_client {
+    struct mcp_session_client *next;
+    uint32_t hash;
+    size_t ref_count;               // Protected by g_clients_lock
+    mcp_capabilities_t capabilities;
+    const char *name;               // These point into strings, NULL when absent
+    const char *version;
+    const char *protocol_version;
+    char strings[];
+};
+
+static pthread_mutex_t g_clients_lock = PTHREAD_MUTEX_INITIALIZER;
+static mcp_session_client_t *g_clients[SESSION_CLIENT_BUCKETS];
+static size_t g_client_count = 0;
+
+static uint32_t session_client_hash(const char *name, const char *version, const char *protocol_version,
+                                    const mcp_capabilities_t *capabilities) {
+    const char *fields[3] = { name, version, protocol_version };
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 3; i++) {
+        // NULL and "" hash differently: the field separator is only added for present fields
+        if (fields[i]) {
+            hash = (hash ^ 0xffu) * 16777619u;
+            hash ^= session_id_hash(fields[i]);
+        }
+        hash *= 16777619u;
+    }
+    hash ^= (uint32_t)capabilities->client.roots | ((uint32_t)capabilities->client.sampling << 1);
+    return hash * 16777619u;
+}
+
+static bool session_field_equal(const char *a, const char *b) {
+    if (!a || !b) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+static const mcp_session_client_t *session_client_intern(const char *name, const char *version,
+                                                         const char *protocol_version,
+                                                         const mcp_capabilities_t *capabilities) {
+    uint32_t hash = session_client_hash(name, version, protocol_version, capabilities);
+    mcp_session_client_t **bucket = &g_clients[hash % SESSION_CLIENT_BUCKETS];
+
+    pthread_mutex_lock(&g_clients_lock);
+    for (mcp_session_client_t *client = *bucket; client; client = client->next) {
+        if (client->hash == hash &&
+            session_field_equal(client->name, name) &&
+            session_field_equal(client->version, version) &&
+            session_field_equal(client->protocol_version, protocol_version) &&
+            memcmp(&client->capabilities.client, &capabilities->client, sizeof(capabilities->client)) == 0) {
+            client->ref_count++;
+            pthread_mutex_unlock(&g_clients_lock);
+            return client;
+        }
+    }
+
+    // 三个字符串与记录放在同一块内存里
+    size_t name_size = name ? strlen(name) + 1 : 0;
+    size_t version_size = version ? strlen(version) + 1 : 0;
+    size_t protocol_size = protocol_version ? strlen(protocol_version) + 1 : 0;
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    mcp_session_client_t *client = hal->memory.alloc(sizeof(mcp_session_client_t) + name_size +
+                                                     version_size + protocol_size);
+    if (!client) {
+        pthread_mutex_unlock(&g_clients_lock);
+        return NULL;
+    }
+
+    char *cursor = client->strings;
+    client->name = name ? memcpy(cursor, name, name_size) : NULL;
+    cursor += name_size;
+    client->version = version ? memcpy(cursor, version, version_size) : NULL;
+    cursor += version_size;
+    client->protocol_version = protocol_version ? memcpy(cursor, protocol_version, protocol_size) : NULL;
+
+    memset(&client->capabilities, 0, sizeof(client->capabilities));
+    client->capabilities.client = capabilities->client;
+    client->hash = hash;
+    client->ref_count = 1;
+    client->next = *bucket;
+    *bucket = client;
+    g_client_count++;
+    pthread_mutex_unlock(&g_clients_lock);
+
+    return client;
+}
+
+static void session_client_release(const mcp_session_client_t *record) {
+    if (!record) return;
+
+    mcp_session_client_t *client = (mcp_session_client_t*)record;
+    pthread_mutex_lock(&g_clients_lock);
+    if (--client->ref_count > 0) {
+        pthread_mutex_unlock(&g_clients_lock);
+        return;
+    }
+
+    mcp_session_client_t **link = &g_clients[client->hash % SESSION_CLIENT_BUCKETS];
+    while (*link != client) {
+        link = &(*link)->next;
+    }
+    *link = client->next;
+    g_client_count--;
+    pthread_mutex_unlock(&g_clients_lock);
+
+    mcp_platform_get_hal()->memory.free(client);
+}
+
+size_t mcp_session_client_count(void) {
+    pthread_mutex_lock(&g_clients_lock);
+    size_t count = g_client_count;
+    pthread_mutex_unlock(&g_clients_lock);
+    return count;
+}
+
 // 创建默认配置
 mcp_session_manager_config_t *mcp_session_manager_config_create_default(void) {
     mcp_session_manager_config_t *config = malloc(sizeof(mcp_session_manager_config_t));
@@ -70,7 +328,7 @@ mcp_session_manager_config_t *mcp_session_manager_config_create_default(void) {
     
     config->max_sessions = 10;
     config->default_session_timeout = 3600; // 1小时
-    config->cleanup_interval = 300; // 5分钟
+    config->cleanup_interval = 1; // 每秒扫描一次过期时间
     config->auto_cleanup = true;
     config->strict_session_validation = true;
     
@@ -81,6 +339,19 @@ void mcp_session_manager_config_destroy(mcp_session_manager_config_t *config) {
     free(config);
 }
 
+static void session_manager_destroy_shards(mcp_session_manager_t *manager, size_t initialized) {
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    for (size_t i = 0; i < initialized; i++) {
+        mcp_session_shard_t *shard = &manager->shards[i];
+        pthread_rwlock_destroy(&shard->lock);
+        for (size_t p = 0; p < shard->page_count; p++) {
+            hal->memory.free(shard->pages[p]);
+        }
+        hal->memory.free(shard->pages);
+        hal->memory.free(shard->buckets);
+    }
+}
+
 // 创建会话管理器
 mcp_session_manager_t *mcp_session_manager_create(const mcp_session_manager_config_t *config) {
     if (!config) return NULL;
@@ -94,36 +365,56 @@ mcp_session_manager_t *mcp_session_manager_create(const mcp_session_manager_conf
 
     // 复制配置
     manager->config = *config;
+    if (manager->config.cleanup_interval <= 0) {
+        manager->config.cleanup_interval = 1;
+    }
 
-    // 初始化会话存储
-    manager->sessions = hal->memory.alloc(config->max_sessions * sizeof(mcp_session_t*));
-    if (!manager->sessions) {
-        hal->memory.free(manager);
-        return NULL;
+    // 初始化分片哈希表，每个分片的桶数按最大会话数均分并取2的幂；槽位页按需分配
+    size_t per_shard = (config->max_sessions + MCP_SESSION_SHARD_COUNT - 1) / MCP_SESSION_SHARD_COUNT;
+    size_t bucket_count = 4;
+    while (bucket_count < per_shard) {
+        bucket_count <<= 1;
+    }
+
+    for (size_t i = 0; i < MCP_SESSION_SHARD_COUNT; i++) {
+        mcp_session_shard_t *shard = &manager->shards[i];
+        shard->buckets = hal->memory.alloc(bucket_count * sizeof(uint32_t));
+        if (!shard->buckets || pthread_rwlock_init(&shard->lock, NULL) != 0) {
+            hal->memory.free(shard->buckets);
+            session_manager_destroy_shards(manager, i);
+            hal->memory.free(manager);
+            return NULL;
+        }
+        for (size_t b = 0; b < bucket_count; b++) {
+            shard->buckets[b] = MCP_SESSION_SLOT_NONE;
+        }
+        shard->bucket_count = bucket_count;
+        shard->free_slot = MCP_SESSION_SLOT_NONE;
     }
-    memset(manager->sessions, 0, config->max_sessions * sizeof(mcp_session_t*));
     
     manager->session_count = 0;
     manager->session_capacity = config->max_sessions;
     
     // 初始化线程安全
-    if (pthread_rwlock_init(&manager->sessions_lock, NULL) != 0) {
-        free(manager->sessions);
-        free(manager);
+    if (pthread_mutex_init(&manager->manager_mutex, NULL) != 0) {
+        session_manager_destroy_shards(manager, MCP_SESSION_SHARD_COUNT);
+        hal->memory.free(manager);
         return NULL;
     }
-    
-    if (pthread_mutex_init(&manager->manager_mutex, NULL) != 0) {
-        pthread_rwlock_destroy(&manager->sessions_lock);
-        free(manager->sessions);
-        free(manager);
+
+    if (pthread_cond_init(&manager->cleanup_cond, NULL) != 0) {
+        pthread_mutex_destroy(&manager->manager_mutex);
+        session_manager_destroy_shards(manager, MCP_SESSION_SHARD_COUNT);
+        hal->memory.free(manager);
         return NULL;
     }
     
     // 初始化统计信息
-    manager->total_sessions_created = 0;
-    manager->sessions_expired = 0;
-    manager->sessions_terminated = 0;
+    mcp_counter_reset(&manager->total_sessions_created);
+    mcp_counter_reset(&manager->sessions_expired);
+    mcp_counter_reset(&manager->sessions_terminated);
+    mcp_counter_reset(&manager->sessions_loaded);
+    mcp_counter_reset(&manager->store_errors);
     manager->cleanup_running = false;
     
     mcp_log_info("Session manager created with max_sessions=%zu", config->max_sessions);
@@ -140,23 +431,35 @@ void mcp_session_manager_destroy(mcp_session_manager_t *manager) {
         mcp_session_manager_stop(manager);
     }
     
-    // 清理所有会话
-    pthread_rwlock_wrlock(&manager->sessions_lock);
-    for (size_t i = 0; i < manager->session_capacity; i++) {
-        if (manager->sessions[i]) {
-            mcp_session_terminate(manager->sessions[i]);
-            mcp_session_unref(manager->sessions[i]);
+    // 清理所有会话；存储里的会话保留，由其他节点接着服务
+    mcp_session_manager_flush_activity(manager);
+    for (size_t i = 0; i < MCP_SESSION_SHARD_COUNT; i++) {
+        mcp_session_shard_t *shard = &manager->shards[i];
+        pthread_rwlock_wrlock(&shard->lock);
+        for (size_t p = 0; p < shard->page_count; p++) {
+            mcp_session_page_t *page = shard->pages[p];
+            for (uint32_t index = 0; index < MCP_SESSION_PAGE_SLOTS; index++) {
+                mcp_session_t *session = page->sessions[index];
+                if (!session) continue;
+
+                session_shard_unlink(shard, session);
+                mcp_session_terminate(session);
+                mcp_session_unref(session);
+            }
         }
+        pthread_rwlock_unlock(&shard->lock);
     }
-    pthread_rwlock_unlock(&manager->sessions_lock);
     
+    mcp_session_store_destroy(manager->store);
+
     // 销毁同步原语
-    pthread_rwlock_destroy(&manager->sessions_lock);
+    session_manager_destroy_shards(manager, MCP_SESSION_SHARD_COUNT);
+    pthread_cond_destroy(&manager->cleanup_cond);
     pthread_mutex_destroy(&manager->manager_mutex);
     
     // 释放内存
-    free(manager->sessions);
-    free(manager);
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    hal->memory.free(manager);
     
     mcp_log_info("Session manager destroyed");
 }
@@ -167,13 +470,22 @@ static void *session_cleanup_thread(void *arg) {
     
     mcp_log_info("Session cleanup thread started");
     
+    pthread_mutex_lock(&manager->manager_mutex);
     while (manager->cleanup_running) {
-        sleep(manager->config.cleanup_interval);
+        // 按清理间隔等待，停止时被条件变量立即唤醒
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += manager->config.cleanup_interval;
+        pthread_cond_timedwait(&manager->cleanup_cond, &manager->manager_mutex, &deadline);
         
         if (!manager->cleanup_running) break;
         
+        pthread_mutex_unlock(&manager->manager_mutex);
+        mcp_session_manager_flush_activity(manager);
         mcp_session_manager_cleanup_expired_sessions(manager);
+        pthread_mutex_lock(&manager->manager_mutex);
     }
+    pthread_mutex_unlock(&manager->manager_mutex);
     
     mcp_log_info("Session cleanup thread stopped");
     return NULL;
@@ -201,11 +513,8 @@ int mcp_session_manager_start(mcp_session_manager_t *manager) {
             return -1;
         }
 
-        void *thread_handle;
-        int thread_result = hal->thread.create(&thread_handle, session_cleanup_thread, manager, 0);
-        if (thread_result == 0) {
-            manager->cleanup_thread = *(pthread_t*)&thread_handle;
-        } else {
+        int thread_result = hal->thread.create(&manager->cleanup_thread, session_cleanup_thread, manager, 0);
+        if (thread_result != 0) {
             manager->cleanup_running = false;
             pthread_mutex_unlock(&manager->manager_mutex);
             mcp_log_error("Failed to create session cleanup thread");
@@ -231,217 +540,387 @@ int mcp_session_manager_stop(mcp_session_manager_t *manager) {
     }
     
     manager->cleanup_running = false;
+    pthread_cond_signal(&manager->cleanup_cond);
     pthread_mutex_unlock(&manager->manager_mutex);
     
     // 等待清理线程结束
-    if (pthread_join(manager->cleanup_thread, NULL) != 0) {
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    if (!hal || hal->thread.join(manager->cleanup_thread) != 0) {
         mcp_log_warn("Failed to join session cleanup thread");
     }
+    manager->cleanup_thread = NULL;
     
     mcp_log_info("Session manager stopped");
     return 0;
 }
 
+// 预占容量并挂入表中，检查重复与插入在同一把分片锁内完成。
+// 返回0已插入；同ID会话已在表中时返回1，existing非空则取得它的引用；出错返回-1
+static int session_manager_insert(mcp_session_manager_t *manager, mcp_session_t *session,
+                                  time_t expires_at, mcp_session_t **existing) {
+    size_t count = __atomic_add_fetch(&manager->session_count, 1, __ATOMIC_ACQ_REL);
+    if (count > manager->session_capacity) {
+        __atomic_sub_fetch(&manager->session_count, 1, __ATOMIC_ACQ_REL);
+        mcp_log_error("Session manager is full, cannot create new session");
+        return -1;
+    }
+
+    session->ref_count = 1;
+    session->hash = session_id_hash(session->session_id);
+    session->slot = MCP_SESSION_SLOT_NONE;
+    session->manager = manager;
+
+    mcp_session_shard_t *shard = session_shard_for(manager, session->hash);
+    pthread_rwlock_wrlock(&shard->lock);
+
+    mcp_session_t *found = session_shard_lookup(shard, session->hash, session->session_id);
+    if (found) {
+        if (existing) *existing = mcp_session_ref(found);
+        pthread_rwlock_unlock(&shard->lock);
+        __atomic_sub_fetch(&manager->session_count, 1, __ATOMIC_ACQ_REL);
+        return 1;
+    }
+
+    if (session_shard_link(shard, session, expires_at) != 0) {
+        pthread_rwlock_unlock(&shard->lock);
+        __atomic_sub_fetch(&manager->session_count, 1, __ATOMIC_ACQ_REL);
+        return -1;
+    }
+
+    pthread_rwlock_unlock(&shard->lock);
+    return 0;
+}
+
+// 会话写入存储的记录，客户端字符串借用会话的客户端记录；调用者需持有分片锁
+static void session_record_fill(const mcp_session_t *session, const mcp_session_page_t *page,
+                                mcp_session_record_t *record) {
+    uint32_t index = SLOT_INDEX(session->slot);
+    const mcp_session_client_t *client = __atomic_load_n(&session->client, __ATOMIC_ACQUIRE);
+
+    memcpy(record->session_id, session->session_id, MCP_SESSION_ID_SIZE);
+    record->state = (mcp_session_state_t)page->state[index];
+    record->created_time = session->created_time;
+    record->last_activity = __atomic_load_n(&page->last_activity[index], __ATOMIC_RELAXED);
+    record->expires_at = page->expires_at[index];
+    record->client_name = client ? (char*)client->name : NULL;
+    record->client_version = client ? (char*)client->version : NULL;
+    record->protocol_version = client ? (char*)client->protocol_version : NULL;
+    record->roots = client && client->capabilities.client.roots;
+    record->sampling = client && client->capabilities.client.sampling;
+}
+
+static void session_store_failed(mcp_session_manager_t *manager, const char *operation,
+                                 const char *session_id) {
+    mcp_counter_inc(&manager->store_errors);
+    mcp_log_warn("Session store %s failed for %s", operation, session_id);
+}
+
+// 会话仍在表中时把它整个写入存储；写入包含最近活动时间，所以清掉待刷新标记
+static void session_store_put(mcp_session_t *session) {
+    mcp_session_manager_t *manager = __atomic_load_n(&session->manager, __ATOMIC_ACQUIRE);
+    if (!manager || !manager->store) return;
+
+    mcp_session_record_t record;
+    mcp_session_shard_t *shard;
+    mcp_session_page_t *page = session_lock(session, false, &shard);
+    if (!page) return;
+
+    __atomic_store_n(&page->dirty[SLOT_INDEX(session->slot)], 0, __ATOMIC_RELAXED);
+    session_record_fill(session, page, &record);
+    // 客户端记录随会话存活，持有引用即可在锁外使用
+    mcp_session_ref(session);
+    pthread_rwlock_unlock(&shard->lock);
+
+    if (manager->store->ops->put(manager->store, &record) != 0) {
+        session_store_failed(manager, "put", session->session_id);
+    }
+    mcp_session_unref(session);
+}
+
 // 创建会话
 mcp_session_t *mcp_session_manager_create_session(mcp_session_manager_t *manager,
                                                  const char *session_id) {
     if (!manager) return NULL;
     
-    // 生成会话ID（如果未提供）
-    char *id = NULL;
+    // 创建新会话，ID直接存放在会话对象里
+    mcp_session_t *session = malloc(sizeof(mcp_session_t));
+    if (!session) return NULL;
+    memset(session, 0, sizeof(mcp_session_t));
+
     if (session_id) {
         if (!mcp_session_validate_id(session_id)) {
             mcp_log_error("Invalid session ID format: %s", session_id);
+            free(session);
             return NULL;
         }
-        id = strdup(session_id);
+        memcpy(session->session_id, session_id, MCP_SESSION_ID_SIZE);
     } else {
-        id = mcp_session_generate_id();
-    }
-    
-    if (!id) return NULL;
-    
-    // 检查会话是否已存在
-    pthread_rwlock_rdlock(&manager->sessions_lock);
-    for (size_t i = 0; i < manager->session_capacity; i++) {
-        if (manager->sessions[i] && 
-            strcmp(manager->sessions[i]->session_id, id) == 0) {
-            pthread_rwlock_unlock(&manager->sessions_lock);
-            free(id);
-            mcp_log_warn("Session already exists: %s", id);
+        char *id = mcp_session_generate_id();
+        if (!id) {
+            free(session);
             return NULL;
         }
-    }
-    pthread_rwlock_unlock(&manager->sessions_lock);
-    
-    // 创建新会话
-    mcp_session_t *session = malloc(sizeof(mcp_session_t));
-    if (!session) {
+        memcpy(session->session_id, id, MCP_SESSION_ID_SIZE);
         free(id);
-        return NULL;
     }
     
-    memset(session, 0, sizeof(mcp_session_t));
-    
-    session->session_id = id;
     session->state = MCP_SESSION_STATE_CREATED;
     session->created_time = time(NULL);
     session->last_activity = session->created_time;
-    session->expires_at = session->created_time + manager->config.default_session_timeout;
-    session->ref_count = 1;
     
-    // 初始化互斥锁
-    if (pthread_mutex_init(&session->mutex, NULL) != 0) {
-        free(session->session_id);
+    int inserted = session_manager_insert(manager, session,
+                                          session->created_time + manager->config.default_session_timeout,
+                                          NULL);
+    if (inserted != 0) {
+        if (inserted > 0) {
+            mcp_log_warn("Session already exists: %s", session->session_id);
+        }
         free(session);
         return NULL;
     }
     
-    // 添加到管理器
-    pthread_rwlock_wrlock(&manager->sessions_lock);
+    mcp_counter_inc(&manager->total_sessions_created);
+    session_store_put(session);
     
-    // 查找空位
-    bool added = false;
-    for (size_t i = 0; i < manager->session_capacity; i++) {
-        if (!manager->sessions[i]) {
-            manager->sessions[i] = session;
-            manager->session_count++;
-            manager->total_sessions_created++;
-            added = true;
-            break;
+    mcp_log_info("Session created: %s", session->session_id);
+    return session;
+}
+
+// 按存储的记录建立会话并挂入表中，返回带引用的会话；
+// 其他线程可能同时读入了同一个会话，以表中已有的为准
+static mcp_session_t *session_from_record(mcp_session_manager_t *manager,
+                                          const mcp_session_record_t *record) {
+    mcp_session_t *session = malloc(sizeof(mcp_session_t));
+    if (!session) return NULL;
+    memset(session, 0, sizeof(mcp_session_t));
+    memcpy(session->session_id, record->session_id, MCP_SESSION_ID_SIZE);
+    session->session_id[MCP_SESSION_ID_SIZE - 1] = '\0';
+    session->state = record->state;
+    session->created_time = record->created_time;
+    session->last_activity = record->last_activity;
+
+    // 只有初始化过的会话才有客户端信息
+    if (record->client_name || record->client_version || record->protocol_version) {
+        mcp_capabilities_t capabilities;
+        memset(&capabilities, 0, sizeof(capabilities));
+        capabilities.client.roots = record->roots;
+        capabilities.client.sampling = record->sampling;
+        session->client = session_client_intern(record->client_name, record->client_version,
+                                                record->protocol_version, &capabilities);
+        if (!session->client) {
+            free(session);
+            return NULL;
         }
     }
-    
-    pthread_rwlock_unlock(&manager->sessions_lock);
-    
-    if (!added) {
-        pthread_mutex_destroy(&session->mutex);
-        free(session->session_id);
+
+    mcp_session_t *existing = NULL;
+    if (session_manager_insert(manager, session, record->expires_at, &existing) != 0) {
+        session_client_release(session->client);
         free(session);
-        mcp_log_error("Session manager is full, cannot create new session");
+        return existing;
+    }
+
+    mcp_counter_inc(&manager->sessions_loaded);
+    mcp_log_info("Session loaded from store: %s", session->session_id);
+    return mcp_session_ref(session);
+}
+
+// 表中没有的会话从存储读入，挂入表中作为本地缓存
+static mcp_session_t *session_load(mcp_session_manager_t *manager, const char *session_id) {
+    // 格式不对的ID不必去存储查询
+    if (!mcp_session_validate_id(session_id)) return NULL;
+
+    mcp_session_record_t record;
+    memset(&record, 0, sizeof(record));
+    int found = manager->store->ops->get(manager->store, session_id, &record);
+    if (found != 0) {
+        if (found < 0) session_store_failed(manager, "get", session_id);
         return NULL;
     }
-    
-    mcp_log_info("Session created: %s", session->session_id);
+
+    mcp_session_t *session = session_from_record(manager, &record);
+    mcp_session_record_clear(&record);
     return session;
 }
 
-// 查找会话
+// 查找会话，有存储时表中没有的再去存储查
 mcp_session_t *mcp_session_manager_find_session(mcp_session_manager_t *manager,
                                                const char *session_id) {
     if (!manager || !session_id) return NULL;
 
-    pthread_rwlock_rdlock(&manager->sessions_lock);
+    uint32_t hash = session_id_hash(session_id);
+    mcp_session_shard_t *shard = session_shard_for(manager, hash);
 
-    for (size_t i = 0; i < manager->session_capacity; i++) {
-        if (manager->sessions[i] &&
-            strcmp(manager->sessions[i]->session_id, session_id) == 0) {
-            mcp_session_t *session = mcp_session_ref(manager->sessions[i]);
-            pthread_rwlock_unlock(&manager->sessions_lock);
-            return session;
-        }
-    }
+    pthread_rwlock_rdlock(&shard->lock);
+    mcp_session_t *session = mcp_session_ref(session_shard_lookup(shard, hash, session_id));
+    pthread_rwlock_unlock(&shard->lock);
 
-    pthread_rwlock_unlock(&manager->sessions_lock);
-    return NULL;
+    if (session || !manager->store) return session;
+    return session_load(manager, session_id);
 }
 
-// 移除会话
+// 移除会话，有存储时同时从存储删除
 int mcp_session_manager_remove_session(mcp_session_manager_t *manager,
                                       const char *session_id) {
     if (!manager || !session_id) return -1;
 
-    pthread_rwlock_wrlock(&manager->sessions_lock);
+    uint32_t hash = session_id_hash(session_id);
+    mcp_session_shard_t *shard = session_shard_for(manager, hash);
 
-    for (size_t i = 0; i < manager->session_capacity; i++) {
-        if (manager->sessions[i] &&
-            strcmp(manager->sessions[i]->session_id, session_id) == 0) {
-            mcp_session_t *session = manager->sessions[i];
-            manager->sessions[i] = NULL;
-            manager->session_count--;
+    pthread_rwlock_wrlock(&shard->lock);
 
-            pthread_rwlock_unlock(&manager->sessions_lock);
+    mcp_session_t *session = session_shard_lookup(shard, hash, session_id);
+    if (!session) {
+        pthread_rwlock_unlock(&shard->lock);
+        // 会话可能只在存储里（由其他节点创建），读入后照常移除
+        if (!manager->store) return -1;
+        mcp_session_t *loaded = session_load(manager, session_id);
+        if (!loaded) return -1;
+        mcp_session_unref(loaded);
+        return mcp_session_manager_remove_session(manager, session_id);
+    }
 
-            mcp_session_terminate(session);
-            mcp_session_unref(session);
+    session_shard_unlink(shard, session);
+    pthread_rwlock_unlock(&shard->lock);
 
-            mcp_log_info("Session removed: %s", session_id);
-            return 0;
-        }
+    __atomic_sub_fetch(&manager->session_count, 1, __ATOMIC_ACQ_REL);
+    mcp_counter_inc(&manager->sessions_terminated);
+    if (manager->store && manager->store->ops->expire(manager->store, session_id) != 0) {
+        session_store_failed(manager, "expire", session_id);
     }
 
-    pthread_rwlock_unlock(&manager->sessions_lock);
-    return -1;
+    mcp_log_info("Session removed: %s", session_id);
+
+    mcp_session_terminate(session);
+    mcp_session_unref(session);
+    return 0;
 }
 
 // 会话引用计数
 mcp_session_t *mcp_session_ref(mcp_session_t *session) {
     if (!session) return NULL;
 
-    pthread_mutex_lock(&session->mutex);
-    session->ref_count++;
-    pthread_mutex_unlock(&session->mutex);
-
+    __atomic_add_fetch(&session->ref_count, 1, __ATOMIC_RELAXED);
     return session;
 }
 
 void mcp_session_unref(mcp_session_t *session) {
     if (!session) return;
 
-    pthread_mutex_lock(&session->mutex);
-    session->ref_count--;
-    bool should_destroy = (session->ref_count == 0);
-    pthread_mutex_unlock(&session->mutex);
+    if (__atomic_sub_fetch(&session->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
+        session_client_release(session->client);
+        mcp_subscription_set_destroy(session->subscriptions);
+        free(session);
+    }
+}
+
+// 资源订阅集合 - 首次订阅时创建，并发创建时只保留一个
+mcp_subscription_set_t *mcp_session_get_subscriptions(mcp_session_t *session, bool create) {
+    if (!session) return NULL;
 
-    if (should_destroy) {
-        // 清理会话资源
-        if (session->protocol_state) {
-            // Protocol state cleanup is handled by the protocol module
-            session->protocol_state = NULL;
-        }
+    mcp_subscription_set_t *set = __atomic_load_n(&session->subscriptions, __ATOMIC_ACQUIRE);
+    if (set || !create) return set;
 
-        pthread_mutex_destroy(&session->mutex);
-        free(session->session_id);
-        free(session->client_name);
-        free(session->client_version);
-        free(session->protocol_version);
-        free(session);
+    mcp_subscription_set_t *created = mcp_subscription_set_create();
+    if (!created) return NULL;
+    if (!__atomic_compare_exchange_n(&session->subscriptions, &set, created, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        mcp_subscription_set_destroy(created);
+        return set;
+    }
+    return created;
+}
+
+// 设置会话状态：仍在表中时写槽位并同步到存储，否则写会话对象
+static void session_set_state(mcp_session_t *session, mcp_session_state_t state) {
+    mcp_session_shard_t *shard;
+    mcp_session_page_t *page = session_lock(session, true, &shard);
+    if (page) {
+        page->state[SLOT_INDEX(session->slot)] = (uint8_t)state;
+        pthread_rwlock_unlock(&shard->lock);
+        session_store_put(session);
+    } else {
+        __atomic_store_n(&session->state, state, __ATOMIC_RELAXED);
     }
 }
 
 // 会话状态管理
 mcp_session_state_t mcp_session_get_state(const mcp_session_t *session) {
     if (!session) return MCP_SESSION_STATE_TERMINATED;
-    return session->state;
+
+    mcp_session_shard_t *shard;
+    mcp_session_page_t *page = session_lock(session, false, &shard);
+    if (!page) return __atomic_load_n(&session->state, __ATOMIC_RELAXED);
+
+    mcp_session_state_t state = (mcp_session_state_t)page->state[SLOT_INDEX(session->slot)];
+    pthread_rwlock_unlock(&shard->lock);
+    return state;
 }
 
 bool mcp_session_is_active(const mcp_session_t *session) {
-    if (!session) return false;
-    return session->state == MCP_SESSION_STATE_ACTIVE;
+    return mcp_session_get_state(session) == MCP_SESSION_STATE_ACTIVE;
 }
 
 bool mcp_session_is_expired(const mcp_session_t *session) {
     if (!session) return true;
-    return time(NULL) > session->expires_at;
+
+    mcp_session_shard_t *shard;
+    mcp_session_page_t *page = session_lock(session, false, &shard);
+    if (!page) return true;
+
+    bool expired = time(NULL) > page->expires_at[SLOT_INDEX(session->slot)];
+    pthread_rwlock_unlock(&shard->lock);
+    return expired;
+}
+
+// 每个请求都会调用，不加锁：槽位页在管理器销毁前不会释放，会话刚离开表时
+// 写入的时间戳最多落在空闲槽位或新会话上，都是当前时间，无害。
+// 有存储时不在这里写存储，只打上待刷新标记，由清理线程批量写出
+static void session_touch(mcp_session_t *session) {
+    time_t now = time(NULL);
+    mcp_session_page_t *page = __atomic_load_n(&session->page, __ATOMIC_ACQUIRE);
+    if (page) {
+        uint32_t index = SLOT_INDEX(session->slot);
+        __atomic_store_n(&page->last_activity[index], now, __ATOMIC_RELAXED);
+        __atomic_store_n(&page->dirty[index], 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_store_n(&session->last_activity, now, __ATOMIC_RELAXED);
+    }
 }
 
 int mcp_session_update_activity(mcp_session_t *session) {
     if (!session) return -1;
 
-    pthread_mutex_lock(&session->mutex);
-    session->last_activity = time(NULL);
-    pthread_mutex_unlock(&session->mutex);
-
+    session_touch(session);
     return 0;
 }
 
+void mcp_session_record_request(mcp_session_t *session, bool failed) {
+    if (!session) return;
+
+    __atomic_add_fetch(&session->requests_handled, 1, __ATOMIC_RELAXED);
+    if (failed) {
+        __atomic_add_fetch(&session->errors_encountered, 1, __ATOMIC_RELAXED);
+    }
+    session_touch(session);
+}
+
+void mcp_session_record_notification(mcp_session_t *session) {
+    if (!session) return;
+    __atomic_add_fetch(&session->notifications_sent, 1, __ATOMIC_RELAXED);
+}
+
 int mcp_session_extend_expiry(mcp_session_t *session, time_t additional_time) {
     if (!session) return -1;
 
-    pthread_mutex_lock(&session->mutex);
-    session->expires_at += additional_time;
-    pthread_mutex_unlock(&session->mutex);
+    mcp_session_shard_t *shard;
+    mcp_session_page_t *page = session_lock(session, true, &shard);
+    if (!page) return -1;
 
+    uint32_t index = SLOT_INDEX(session->slot);
+    page->expires_at[index] += additional_time;
+    __atomic_store_n(&page->dirty[index], 1, __ATOMIC_RELAXED);
+    pthread_rwlock_unlock(&shard->lock);
     return 0;
 }
 
@@ -450,12 +929,28 @@ const char *mcp_session_get_id(const mcp_session_t *session) {
     return session ? session->session_id : NULL;
 }
 
+static const mcp_session_client_t *session_client(const mcp_session_t *session) {
+    return session ? __atomic_load_n(&session->client, __ATOMIC_ACQUIRE) : NULL;
+}
+
 const char *mcp_session_get_client_name(const mcp_session_t *session) {
-    return session ? session->client_name : NULL;
+    const mcp_session_client_t *client = session_client(session);
+    return client ? client->name : NULL;
+}
+
+const char *mcp_session_get_client_version(const mcp_session_t *session) {
+    const mcp_session_client_t *client = session_client(session);
+    return client ? client->version : NULL;
 }
 
 const char *mcp_session_get_protocol_version(const mcp_session_t *session) {
-    return session ? session->protocol_version : NULL;
+    const mcp_session_client_t *client = session_client(session);
+    return client ? client->protocol_version : NULL;
+}
+
+const mcp_capabilities_t *mcp_session_get_capabilities(const mcp_session_t *session) {
+    const mcp_session_client_t *client = session_client(session);
+    return client ? &client->capabilities : NULL;
 }
 
 time_t mcp_session_get_created_time(const mcp_session_t *session) {
@@ -463,48 +958,252 @@ time_t mcp_session_get_created_time(const mcp_session_t *session) {
 }
 
 time_t mcp_session_get_last_activity(const mcp_session_t *session) {
-    return session ? session->last_activity : 0;
+    if (!session) return 0;
+
+    mcp_session_page_t *page = __atomic_load_n(&session->page, __ATOMIC_ACQUIRE);
+    if (page) {
+        return __atomic_load_n(&page->last_activity[SLOT_INDEX(session->slot)], __ATOMIC_RELAXED);
+    }
+    return __atomic_load_n(&session->last_activity, __ATOMIC_RELAXED);
+}
+
+// 清理过期会话：逐个分片扫描连续的expires_at数组，只有过期的槽位才访问会话对象
+#define SESSION_REAP_BATCH 64
+
+// 有存储时，本地过期的会话可能已在其他节点上延期：先在锁外问存储，延期了就更新
+// 本地过期时间，否则摘除。sessions持有扫描时加的引用，返回真正过期的个数，
+// 它们被移到数组前部并换成会话表的引用
+static size_t session_store_recheck(mcp_session_manager_t *manager, mcp_session_shard_t *shard,
+                                    mcp_session_t **sessions, size_t count, time_t now) {
+    time_t expires_at[SESSION_REAP_BATCH];
+    for (size_t e = 0; e < count; e++) {
+        mcp_session_record_t record;
+        memset(&record, 0, sizeof(record));
+        int found = manager->store->ops->get(manager->store, sessions[e]->session_id, &record);
+        if (found < 0) session_store_failed(manager, "get", sessions[e]->session_id);
+        expires_at[e] = found == 0 ? record.expires_at : 0;
+        mcp_session_record_clear(&record);
+    }
+
+    size_t expired = 0;
+    pthread_rwlock_wrlock(&shard->lock);
+    for (size_t e = 0; e < count; e++) {
+        mcp_session_t *session = sessions[e];
+        mcp_session_page_t *page = session->page;
+        uint32_t index = SLOT_INDEX(session->slot);
+        if (page && now > page->expires_at[index]) {
+            if (expires_at[e] > now) {
+                page->expires_at[index] = expires_at[e];
+            } else {
+                page->state[index] = MCP_SESSION_STATE_EXPIRED;
+                session_shard_unlink(shard, session);
+                sessions[expired++] = session;
+                // 会话表的引用还在，扫描时的引用可以在锁内放掉
+                __atomic_sub_fetch(&session->ref_count, 1, __ATOMIC_ACQ_REL);
+                continue;
+            }
+        }
+        mcp_session_unref(session);
+    }
+    pthread_rwlock_unlock(&shard->lock);
+    return expired;
 }
 
-// 清理过期会话
 int mcp_session_manager_cleanup_expired_sessions(mcp_session_manager_t *manager) {
     if (!manager) return -1;
 
     time_t now = time(NULL);
     int cleaned = 0;
 
-    pthread_rwlock_wrlock(&manager->sessions_lock);
+    for (size_t i = 0; i < MCP_SESSION_SHARD_COUNT; i++) {
+        mcp_session_shard_t *shard = &manager->shards[i];
+        mcp_session_t *expired[SESSION_REAP_BATCH];
+        size_t scanned;
+
+        // 回调与终止在锁外进行，一批满了就先处理再接着扫描
+        do {
+            scanned = 0;
+            pthread_rwlock_wrlock(&shard->lock);
+            for (size_t p = 0; p < shard->page_count && scanned < SESSION_REAP_BATCH; p++) {
+                mcp_session_page_t *page = shard->pages[p];
+                for (uint32_t index = 0; index < MCP_SESSION_PAGE_SLOTS; index++) {
+                    if (now <= page->expires_at[index]) continue;
+
+                    expired[scanned] = page->sessions[index];
+                    if (manager->store) {
+                        // 先不摘除，等问过存储；下一批扫描前这一批都已处理完
+                        mcp_session_ref(expired[scanned]);
+                    } else {
+                        page->state[index] = MCP_SESSION_STATE_EXPIRED;
+                        session_shard_unlink(shard, expired[scanned]);
+                    }
+                    if (++scanned == SESSION_REAP_BATCH) break;
+                }
+            }
+            pthread_rwlock_unlock(&shard->lock);
+
+            size_t count = scanned;
+            if (manager->store && scanned > 0) {
+                count = session_store_recheck(manager, shard, expired, scanned, now);
+            }
+
+            for (size_t e = 0; e < count; e++) {
+                mcp_session_t *session = expired[e];
+
+                __atomic_sub_fetch(&manager->session_count, 1, __ATOMIC_ACQ_REL);
+                mcp_counter_inc(&manager->sessions_expired);
+                cleaned++;
+
+                mcp_log_info("Session expired and cleaned: %s", session->session_id);
+
+                if (manager->expired_callback) {
+                    manager->expired_callback(session, manager->expired_callback_data);
+                }
+
+                mcp_session_terminate(session);
+                mcp_session_unref(session); // 会话表持有的引用
+            }
+        } while (scanned == SESSION_REAP_BATCH);
+    }
 
-    for (size_t i = 0; i < manager->session_capacity; i++) {
-        if (manager->sessions[i] && now > manager->sessions[i]->expires_at) {
-            mcp_session_t *session = manager->sessions[i];
-            manager->sessions[i] = NULL;
-            manager->session_count--;
-            manager->sessions_expired++;
-            cleaned++;
+    if (cleaned > 0) {
+        mcp_log_info("Cleaned %d expired sessions", cleaned);
+    }
 
-            mcp_log_info("Session expired and cleaned: %s", session->session_id);
+    return cleaned;
+}
 
-            // 在锁外清理
-            pthread_rwlock_unlock(&manager->sessions_lock);
-            mcp_session_terminate(session);
-            mcp_session_unref(session);
-            pthread_rwlock_wrlock(&manager->sessions_lock);
+// 一批活动时间写入存储，失败的重新打上待刷新标记下次再试；放掉收集时加的引用
+static int session_flush_batch(mcp_session_manager_t *manager, mcp_session_t **sessions,
+                               const mcp_session_record_t *records, size_t count) {
+    bool failed = manager->store->ops->touch(manager->store, records, count) != 0;
+    for (size_t e = 0; e < count; e++) {
+        if (failed) {
+            mcp_session_page_t *page = __atomic_load_n(&sessions[e]->page, __ATOMIC_ACQUIRE);
+            if (page) {
+                __atomic_store_n(&page->dirty[SLOT_INDEX(sessions[e]->slot)], 1, __ATOMIC_RELAXED);
+            }
         }
+        mcp_session_unref(sessions[e]);
+    }
+    if (failed) {
+        mcp_counter_inc(&manager->store_errors);
+        mcp_log_warn("Session store touch failed for %zu sessions", count);
+        return -1;
     }
+    return 0;
+}
 
-    pthread_rwlock_unlock(&manager->sessions_lock);
+// 把待刷新的活动时间写入存储，跨分片凑满一批才调用一次touch
+int mcp_session_manager_flush_activity(mcp_session_manager_t *manager) {
+    if (!manager) return -1;
+    if (!manager->store) return 0;
+
+    mcp_session_t *sessions[SESSION_REAP_BATCH];
+    mcp_session_record_t records[SESSION_REAP_BATCH];
+    size_t count = 0;
+    int flushed = 0;
+
+    for (size_t i = 0; i < MCP_SESSION_SHARD_COUNT; i++) {
+        mcp_session_shard_t *shard = &manager->shards[i];
+        size_t p = 0;
+        uint32_t index = 0;
+
+        // 批满时放锁写出，再从原处接着扫描
+        while (true) {
+            pthread_rwlock_rdlock(&shard->lock);
+            for (; p < shard->page_count && count < SESSION_REAP_BATCH; p++, index = 0) {
+                mcp_session_page_t *page = shard->pages[p];
+                for (; index < MCP_SESSION_PAGE_SLOTS && count < SESSION_REAP_BATCH; index++) {
+                    if (!__atomic_load_n(&page->dirty[index], __ATOMIC_RELAXED) || !page->sessions[index]) {
+                        continue;
+                    }
+
+                    __atomic_store_n(&page->dirty[index], 0, __ATOMIC_RELAXED);
+                    // 记录借用客户端字符串，持有会话引用直到写完
+                    sessions[count] = mcp_session_ref(page->sessions[index]);
+                    session_record_fill(sessions[count], page, &records[count]);
+                    count++;
+                }
+                if (count == SESSION_REAP_BATCH) break;
+            }
+            pthread_rwlock_unlock(&shard->lock);
+            if (count < SESSION_REAP_BATCH) break;
+
+            if (session_flush_batch(manager, sessions, records, count) != 0) return -1;
+            flushed += (int)count;
+            count = 0;
+        }
+    }
 
-    if (cleaned > 0) {
-        mcp_log_info("Cleaned %d expired sessions", cleaned);
+    if (count > 0) {
+        if (session_flush_batch(manager, sessions, records, count) != 0) return -1;
+        flushed += (int)count;
     }
+    return flushed;
+}
 
-    return cleaned;
+// 从存储预先读入会话，直到表满
+static int session_load_record(const mcp_session_record_t *record, void *user_data) {
+    mcp_session_manager_t *manager = (mcp_session_manager_t*)user_data;
+    if (mcp_session_manager_get_session_count(manager) >= manager->session_capacity) return 1;
+
+    if (mcp_session_validate_id(record->session_id)) {
+        mcp_session_unref(session_from_record(manager, record));
+    }
+    return 0;
+}
+
+int mcp_session_manager_load_store(mcp_session_manager_t *manager) {
+    if (!manager || !manager->store) return -1;
+
+    uint64_t before = mcp_counter_read(&manager->sessions_loaded);
+    if (manager->store->ops->scan(manager->store, session_load_record, manager) != 0) {
+        mcp_counter_inc(&manager->store_errors);
+        mcp_log_warn("Session store scan failed");
+        return -1;
+    }
+    return (int)(mcp_counter_read(&manager->sessions_loaded) - before);
+}
+
+int mcp_session_manager_set_store(mcp_session_manager_t *manager, mcp_session_store_t *store) {
+    if (!manager || !store || manager->store) return -1;
+
+    manager->store = store;
+    return 0;
+}
+
+void mcp_session_store_destroy(mcp_session_store_t *store) {
+    if (store && store->ops->destroy) {
+        store->ops->destroy(store);
+    }
+}
+
+void mcp_session_record_clear(mcp_session_record_t *record) {
+    if (!record) return;
+
+    free(record->client_name);
+    free(record->client_version);
+    free(record->protocol_version);
+    record->client_name = NULL;
+    record->client_version = NULL;
+    record->protocol_version = NULL;
+}
+
+void mcp_session_manager_set_expired_callback(mcp_session_manager_t *manager,
+                                             mcp_session_expired_callback_t callback,
+                                             void *user_data) {
+    if (!manager) return;
+
+    pthread_mutex_lock(&manager->manager_mutex);
+    manager->expired_callback = callback;
+    manager->expired_callback_data = user_data;
+    pthread_mutex_unlock(&manager->manager_mutex);
 }
 
 // 获取会话统计
 size_t mcp_session_manager_get_session_count(const mcp_session_manager_t *manager) {
-    return manager ? manager->session_count : 0;
+    return manager ? __atomic_load_n(&manager->session_count, __ATOMIC_ACQUIRE) : 0;
 }
 
 size_t mcp_session_manager_get_active_session_count(const mcp_session_manager_t *manager) {
@@ -514,58 +1213,90 @@ size_t mcp_session_manager_get_active_session_count(const mcp_session_manager_t
 
     // Cast away const for pthread functions
     mcp_session_manager_t *non_const_manager = (mcp_session_manager_t*)manager;
-    pthread_rwlock_rdlock(&non_const_manager->sessions_lock);
-    for (size_t i = 0; i < manager->session_capacity; i++) {
-        if (manager->sessions[i] && mcp_session_is_active(manager->sessions[i])) {
-            active_count++;
+    for (size_t i = 0; i < MCP_SESSION_SHARD_COUNT; i++) {
+        mcp_session_shard_t *shard = &non_const_manager->shards[i];
+        pthread_rwlock_rdlock(&shard->lock);
+        for (size_t p = 0; p < shard->page_count; p++) {
+            const uint8_t *state = shard->pages[p]->state;
+            for (uint32_t index = 0; index < MCP_SESSION_PAGE_SLOTS; index++) {
+                active_count += state[index] == MCP_SESSION_STATE_ACTIVE;
+            }
         }
+        pthread_rwlock_unlock(&shard->lock);
     }
-    pthread_rwlock_unlock(&non_const_manager->sessions_lock);
 
     return active_count;
 }
 
+cJSON *mcp_session_manager_get_stats(const mcp_session_manager_t *manager) {
+    if (!manager) return NULL;
+
+    cJSON *stats = cJSON_CreateObject();
+    if (!stats) return NULL;
+
+    cJSON_AddNumberToObject(stats, "sessionCount",
+                            (double)__atomic_load_n(&manager->session_count, __ATOMIC_ACQUIRE));
+    cJSON_AddNumberToObject(stats, "activeSessionCount",
+                            (double)mcp_session_manager_get_active_session_count(manager));
+    cJSON_AddNumberToObject(stats, "maxSessions", (double)manager->session_capacity);
+    cJSON_AddNumberToObject(stats, "totalSessionsCreated",
+                            (double)mcp_counter_read(&manager->total_sessions_created));
+    cJSON_AddNumberToObject(stats, "sessionsExpired", (double)mcp_counter_read(&manager->sessions_expired));
+    cJSON_AddNumberToObject(stats, "sessionsTerminated", (double)mcp_counter_read(&manager->sessions_terminated));
+    cJSON_AddNumberToObject(stats, "clientRecords", (double)mcp_session_client_count());
+    if (manager->store) {
+        cJSON_AddNumberToObject(stats, "sessionsLoaded", (double)mcp_counter_read(&manager->sessions_loaded));
+        cJSON_AddNumberToObject(stats, "storeErrors", (double)mcp_counter_read(&manager->store_errors));
+    }
+    cJSON_AddBoolToObject(stats, "cleanupRunning", manager->cleanup_running);
+
+    return stats;
+}
+
 // 会话生命周期管理
 int mcp_session_initialize(mcp_session_t *session,
                           const char *protocol_version,
                           const cJSON *client_capabilities,
                           const cJSON *client_info) {
-    (void)client_capabilities; // Client capabilities processing is handled by protocol layer
     if (!session) return -1;
 
-    pthread_mutex_lock(&session->mutex);
-
-    if (session->state != MCP_SESSION_STATE_CREATED) {
-        pthread_mutex_unlock(&session->mutex);
-        return -1;
+    // 先在锁外取得共享的客户端记录
+    const cJSON *name = client_info ? cJSON_GetObjectItem(client_info, "name") : NULL;
+    const cJSON *version = client_info ? cJSON_GetObjectItem(client_info, "version") : NULL;
+    mcp_capabilities_t capabilities;
+    memset(&capabilities, 0, sizeof(capabilities));
+    if (cJSON_IsObject(client_capabilities)) {
+        capabilities.client.roots = cJSON_GetObjectItem(client_capabilities, "roots") != NULL;
+        capabilities.client.sampling = cJSON_GetObjectItem(client_capabilities, "sampling") != NULL;
     }
-
-    session->state = MCP_SESSION_STATE_INITIALIZING;
-
-    if (protocol_version) {
-        free(session->protocol_version);
-        session->protocol_version = strdup(protocol_version);
+    const mcp_session_client_t *client =
+        session_client_intern(cJSON_IsString(name) ? name->valuestring : NULL,
+                              cJSON_IsString(version) ? version->valuestring : NULL,
+                              protocol_version, &capabilities);
+    if (!client) return -1;
+
+    mcp_session_shard_t *shard;
+    mcp_session_page_t *page = session_lock(session, true, &shard);
+    if (!page) {
+        session_client_release(client);
+        return -1;
     }
 
-    // 处理客户端信息
-    if (client_info) {
-        const cJSON *name = cJSON_GetObjectItem(client_info, "name");
-        if (cJSON_IsString(name)) {
-            free(session->client_name);
-            session->client_name = strdup(name->valuestring);
-        }
-
-        const cJSON *version = cJSON_GetObjectItem(client_info, "version");
-        if (cJSON_IsString(version)) {
-            free(session->client_version);
-            session->client_version = strdup(version->valuestring);
-        }
+    uint32_t index = SLOT_INDEX(session->slot);
+    if (page->state[index] != MCP_SESSION_STATE_CREATED) {
+        pthread_rwlock_unlock(&shard->lock);
+        session_client_release(client);
+        return -1;
     }
 
-    session->state = MCP_SESSION_STATE_ACTIVE;
-    session->last_activity = time(NULL);
+    const mcp_session_client_t *previous = session->client;
+    __atomic_store_n(&session->client, client, __ATOMIC_RELEASE);
+    page->state[index] = MCP_SESSION_STATE_ACTIVE;
+    __atomic_store_n(&page->last_activity[index], time(NULL), __ATOMIC_RELAXED);
 
-    pthread_mutex_unlock(&session->mutex);
+    pthread_rwlock_unlock(&shard->lock);
+    session_client_release(previous);
+    session_store_put(session);
 
     mcp_log_info("Session initialized: %s", session->session_id);
     return 0;
@@ -574,30 +1305,22 @@ int mcp_session_initialize(mcp_session_t *session,
 int mcp_session_activate(mcp_session_t *session) {
     if (!session) return -1;
 
-    pthread_mutex_lock(&session->mutex);
-    session->state = MCP_SESSION_STATE_ACTIVE;
-    session->last_activity = time(NULL);
-    pthread_mutex_unlock(&session->mutex);
-
+    session_set_state(session, MCP_SESSION_STATE_ACTIVE);
+    session_touch(session);
     return 0;
 }
 
 int mcp_session_deactivate(mcp_session_t *session) {
     if (!session) return -1;
 
-    pthread_mutex_lock(&session->mutex);
-    session->state = MCP_SESSION_STATE_INACTIVE;
-    pthread_mutex_unlock(&session->mutex);
-
+    session_set_state(session, MCP_SESSION_STATE_INACTIVE);
     return 0;
 }
 
 int mcp_session_terminate(mcp_session_t *session) {
     if (!session) return -1;
 
-    pthread_mutex_lock(&session->mutex);
-    session->state = MCP_SESSION_STATE_TERMINATED;
-    pthread_mutex_unlock(&session->mutex);
+    session_set_state(session, MCP_SESSION_STATE_TERMINATED);
 
     mcp_log_info("Session terminated: %s", session->session_id);
     return 0;
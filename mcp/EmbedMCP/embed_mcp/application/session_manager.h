@@ -3,13 +3,18 @@
 
 #include "protocol/protocol_state.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include <pthread.h>
 #include "cjson/cJSON.h"
+#include "utils/counter.h"
+#include "utils/mem_budget.h"
 
 // Forward declarations
 typedef struct mcp_session_manager mcp_session_manager_t;
 typedef struct mcp_session mcp_session_t;
+typedef struct mcp_session_store mcp_session_store_t;      // application/session_store.h
+typedef struct mcp_subscription_set mcp_subscription_set_t; // application/subscription_set.h
 
 // Session states
 typedef enum {
@@ -21,71 +26,120 @@ typedef enum {
     MCP_SESSION_STATE_TERMINATED
 } mcp_session_state_t;
 
-// Session structure
+// Session IDs are UUID4 strings: 36 characters plus the terminator
+#define MCP_SESSION_ID_SIZE 37
+
+// Client name, version, protocol version and capabilities, interned process-wide and
+// shared by every session the same client build opens
+typedef struct mcp_session_client mcp_session_client_t;
+
+// Session structure - the fields the expiry scan and lookups touch (ID hash, state,
+// expiry, last activity) live in the shard's slot pages while the session is in the table
 struct mcp_session {
-    char *session_id;
+    char session_id[MCP_SESSION_ID_SIZE];
+    uint32_t hash;
+    int ref_count;                  // Atomic
+
+    // Table linkage (protected by the owning shard lock)
+    mcp_session_manager_t *manager; // NULL once the session has left the table
+    struct mcp_session_page *page;  // Slot page, NULL once the session has left the table
+    uint32_t slot;                  // Slot index in the shard
+
+    // Hot fields as they were when the session left the table
     mcp_session_state_t state;
-    
-    // Protocol state
-    mcp_protocol_state_machine_t *protocol_state;
-    
-    // Session information
-    time_t created_time;
     time_t last_activity;
-    time_t expires_at;
-    
-    // Client information
-    char *client_name;
-    char *client_version;
-    char *protocol_version;
-    
-    // Capabilities
-    mcp_capabilities_t *negotiated_capabilities;
-    
-    // Statistics
+
+    time_t created_time;
+    const mcp_session_client_t *client;     // Set by mcp_session_initialize()
+
+    // Statistics (atomic, updated without locking)
     size_t requests_handled;
     size_t notifications_sent;
     size_t errors_encountered;
-    
+
+    // Memory reserved by the session's requests in flight (see utils/mem_budget.h)
+    mcp_mem_account_t memory;
+    size_t requests_in_flight;      // Atomic, queued or running (admission control)
+
+    // resources/subscribe URIs, created on first use (atomic pointer). Kept only on
+    // this node, not in the session store.
+    mcp_subscription_set_t *subscriptions;
+
     // User data
     void *user_data;
-    
-    // Internal
-    pthread_mutex_t mutex;
-    int ref_count;
 };
 
 // Session manager configuration
 typedef struct {
     size_t max_sessions;
     time_t default_session_timeout;
-    time_t cleanup_interval;
+    time_t cleanup_interval;        // Seconds between expiry scans
     bool auto_cleanup;
     bool strict_session_validation;
 } mcp_session_manager_config_t;
 
+// Session table sharding - a session lives in shard (hash >> 16) % MCP_SESSION_SHARD_COUNT
+#define MCP_SESSION_SHARD_COUNT 16
+
+// Hot session fields as a struct of arrays, MCP_SESSION_PAGE_SLOTS sessions per page.
+// Pages stay put until the manager is destroyed, so a session can update its last
+// activity without the shard lock; everything else is written under it.
+#define MCP_SESSION_PAGE_SHIFT 6
+#define MCP_SESSION_PAGE_SLOTS (1u << MCP_SESSION_PAGE_SHIFT)
+#define MCP_SESSION_SLOT_NONE UINT32_MAX
+
+typedef struct mcp_session_page {
+    time_t expires_at[MCP_SESSION_PAGE_SLOTS];      // Free slots: never expire
+    time_t last_activity[MCP_SESSION_PAGE_SLOTS];
+    uint32_t hash[MCP_SESSION_PAGE_SLOTS];
+    uint32_t next[MCP_SESSION_PAGE_SLOTS];          // Bucket chain, or free list for free slots
+    uint8_t state[MCP_SESSION_PAGE_SLOTS];
+    uint8_t dirty[MCP_SESSION_PAGE_SLOTS];          // Activity not yet flushed to the store
+    mcp_session_t *sessions[MCP_SESSION_PAGE_SLOTS];
+} mcp_session_page_t;
+
+typedef struct {
+    pthread_rwlock_t lock;
+    uint32_t *buckets;              // First slot of each chain, bucket_count is a power of two
+    size_t bucket_count;
+    size_t count;
+    mcp_session_page_t **pages;
+    size_t page_count;
+    uint32_t free_slot;             // Head of the free slot list
+} mcp_session_shard_t;
+
+// Session manager callbacks
+typedef void (*mcp_session_expired_callback_t)(mcp_session_t *session, void *user_data);
+
 // Session manager structure
 struct mcp_session_manager {
     // Configuration
     mcp_session_manager_config_t config;
     
     // Session storage
-    mcp_session_t **sessions;
+    mcp_session_shard_t shards[MCP_SESSION_SHARD_COUNT];
     size_t session_count;
     size_t session_capacity;
+    mcp_session_store_t *store;     // Shared store behind the table, NULL: the table is all there is
+    
+    // Expiry
+    mcp_session_expired_callback_t expired_callback;
+    void *expired_callback_data;
     
     // Thread safety
-    pthread_rwlock_t sessions_lock;
     pthread_mutex_t manager_mutex;
     
     // Cleanup thread
-    pthread_t cleanup_thread;
+    void *cleanup_thread;           // HAL thread handle
+    pthread_cond_t cleanup_cond;    // Signalled on stop so the thread exits immediately
     bool cleanup_running;
     
-    // Statistics
-    size_t total_sessions_created;
-    size_t sessions_expired;
-    size_t sessions_terminated;
+    // Statistics (sharded, see utils/counter.h)
+    mcp_counter_t total_sessions_created;
+    mcp_counter_t sessions_expired;
+    mcp_counter_t sessions_terminated;
+    mcp_counter_t sessions_loaded;  // Read through from the store
+    mcp_counter_t store_errors;
 };
 
 // Session manager lifecycle
@@ -116,14 +170,19 @@ int mcp_session_terminate(mcp_session_t *session);
 mcp_session_state_t mcp_session_get_state(const mcp_session_t *session);
 bool mcp_session_is_active(const mcp_session_t *session);
 bool mcp_session_is_expired(const mcp_session_t *session);
-int mcp_session_update_activity(mcp_session_t *session);
+int mcp_session_update_activity(mcp_session_t *session);     // Lock-free
+void mcp_session_record_request(mcp_session_t *session, bool failed);
+void mcp_session_record_notification(mcp_session_t *session);
 int mcp_session_extend_expiry(mcp_session_t *session, time_t additional_time);
 
 // Session information
 const char *mcp_session_get_id(const mcp_session_t *session);
 const char *mcp_session_get_client_name(const mcp_session_t *session);
+const char *mcp_session_get_client_version(const mcp_session_t *session);
 const char *mcp_session_get_protocol_version(const mcp_session_t *session);
 const mcp_capabilities_t *mcp_session_get_capabilities(const mcp_session_t *session);
+// Resource subscriptions; NULL when there are none yet and create is false, or on error
+mcp_subscription_set_t *mcp_session_get_subscriptions(mcp_session_t *session, bool create);
 time_t mcp_session_get_created_time(const mcp_session_t *session);
 time_t mcp_session_get_last_activity(const mcp_session_t *session);
 
@@ -139,6 +198,8 @@ cJSON *mcp_session_to_json(const mcp_session_t *session);
 // Session manager utilities
 size_t mcp_session_manager_get_session_count(const mcp_session_manager_t *manager);
 size_t mcp_session_manager_get_active_session_count(const mcp_session_manager_t *manager);
+// Interned client records alive in the process
+size_t mcp_session_client_count(void);
 int mcp_session_manager_cleanup_expired_sessions(mcp_session_manager_t *manager);
 cJSON *mcp_session_manager_get_stats(const mcp_session_manager_t *manager);
 
@@ -151,7 +212,6 @@ typedef void (*mcp_session_state_change_callback_t)(mcp_session_t *session,
                                                    mcp_session_state_t old_state,
                                                    mcp_session_state_t new_state,
                                                    void *user_data);
-typedef void (*mcp_session_expired_callback_t)(mcp_session_t *session, void *user_data);
 
 void mcp_session_set_state_change_callback(mcp_session_t *session,
                                           mcp_session_state_change_callback_t callback,
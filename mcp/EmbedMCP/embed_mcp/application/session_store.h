@@ -0,0 +1,91 @@
+#ifndef MCP_SESSION_STORE_H
+#define MCP_SESSION_STORE_H
+
+#include "application/session_manager.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+// Where sessions live beyond one process.
+//
+// Without a store the session manager's table is the only copy of a session - the
+// default. With one, the table becomes a read-through cache in front of it: sessions
+// are written to the store when created, initialized or ended, a lookup that misses
+// the table asks the store, and activity is flushed in batches by the cleanup thread
+// rather than on every request. Nodes sharing a store serve each other's sessions, so
+// a client that fails over to another node keeps its session.
+
+// A session as the store keeps it
+typedef struct {
+    char session_id[MCP_SESSION_ID_SIZE];
+    mcp_session_state_t state;
+    time_t created_time;
+    time_t last_activity;
+    time_t expires_at;
+
+    // From initialize, NULL when absent. Borrowed in put() and touch(); get() allocates
+    // them and the caller frees them with mcp_session_record_clear()
+    char *client_name;
+    char *client_version;
+    char *protocol_version;
+    bool roots;
+    bool sampling;
+} mcp_session_record_t;
+
+typedef int (*mcp_session_store_scan_fn)(const mcp_session_record_t *record, void *user_data);
+
+typedef struct {
+    /**
+     * Look up a session
+     * @return 0 if found (record filled in), 1 if unknown or expired, -1 on error
+     */
+    int (*get)(mcp_session_store_t *store, const char *session_id, mcp_session_record_t *record);
+
+    // Create or replace a session, 0 on success
+    int (*put)(mcp_session_store_t *store, const mcp_session_record_t *record);
+
+    // Update last activity and expiry of several sessions in one go, 0 on success.
+    // Sessions the store no longer has must stay gone.
+    int (*touch)(mcp_session_store_t *store, const mcp_session_record_t *records, size_t count);
+
+    // Drop a session, 0 on success (also when it was unknown)
+    int (*expire)(mcp_session_store_t *store, const char *session_id);
+
+    // Call fn for every live session until it returns non-zero, 0 on success. The
+    // record's strings only live for the call.
+    int (*scan)(mcp_session_store_t *store, mcp_session_store_scan_fn fn, void *user_data);
+
+    void (*destroy)(mcp_session_store_t *store);
+} mcp_session_store_ops_t;
+
+struct mcp_session_store {
+    const mcp_session_store_ops_t *ops;
+    void *impl;
+};
+
+// Free the strings get() allocated
+void mcp_session_record_clear(mcp_session_record_t *record);
+
+void mcp_session_store_destroy(mcp_session_store_t *store);
+
+/**
+ * Put a store behind the manager's table (before mcp_session_manager_start). The
+ * manager owns the store from then on and destroys it with itself.
+ * @return 0 on success, -1 if the manager already has one
+ */
+int mcp_session_manager_set_store(mcp_session_manager_t *manager, mcp_session_store_t *store);
+
+/**
+ * Write the last activity recorded since the previous flush to the store, one touch()
+ * call per batch of up to 64 sessions. The cleanup thread does this every interval.
+ * @return Sessions flushed, -1 on error
+ */
+int mcp_session_manager_flush_activity(mcp_session_manager_t *manager);
+
+/**
+ * Fill the table from the store until it is full, e.g. on a standby taking over
+ * @return Sessions loaded, -1 on error
+ */
+int mcp_session_manager_load_store(mcp_session_manager_t *manager);
+
+#endif // MCP_SESSION_STORE_H
@@ -0,0 +1,244 @@
+#include "session_store_kv.h"
+#include "hal/platform_hal.h"
+#include "utils/logging.h"
+#include "cjson/cJSON.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define KV_PREFIX_DEFAULT "mcp:session:"
+#define KV_PREFIX_MAX 64
+#define KV_KEY_SIZE (KV_PREFIX_MAX + MCP_SESSION_ID_SIZE)
+
+typedef struct {
+    mcp_session_store_t base;
+    mcp_kv_client_t client;
+    size_t prefix_length;
+    char prefix[KV_PREFIX_MAX + 1];
+} kv_store_t;
+
+static void kv_key(const kv_store_t *store, const char *session_id, char *key) {
+    memcpy(key, store->prefix, store->prefix_length);
+    strncpy(key + store->prefix_length, session_id, MCP_SESSION_ID_SIZE - 1);
+    key[store->prefix_length + MCP_SESSION_ID_SIZE - 1] = '\0';
+}
+
+// Value text of a record, free with cJSON_free()
+static char *kv_record_encode(const mcp_session_record_t *record) {
+    cJSON *value = cJSON_CreateObject();
+    if (!value) return NULL;
+
+    cJSON_AddNumberToObject(value, "state", record->state);
+    cJSON_AddNumberToObject(value, "created", (double)record->created_time);
+    cJSON_AddNumberToObject(value, "lastActivity", (double)record->last_activity);
+    cJSON_AddNumberToObject(value, "expires", (double)record->expires_at);
+    if (record->client_name) cJSON_AddStringToObject(value, "clientName", record->client_name);
+    if (record->client_version) cJSON_AddStringToObject(value, "clientVersion", record->client_version);
+    if (record->protocol_version) cJSON_AddStringToObject(value, "protocolVersion", record->protocol_version);
+    if (record->roots) cJSON_AddTrueToObject(value, "roots");
+    if (record->sampling) cJSON_AddTrueToObject(value, "sampling");
+
+    char *text = cJSON_PrintUnformatted(value);
+    cJSON_Delete(value);
+    return text;
+}
+
+static const char *kv_string(const cJSON *value, const char *name) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(value, name);
+    return cJSON_IsString(item) ? item->valuestring : NULL;
+}
+
+static time_t kv_time(const cJSON *value, const char *name) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(value, name);
+    return cJSON_IsNumber(item) ? (time_t)item->valuedouble : 0;
+}
+
+// Parse a value; the record's strings point into the returned tree (cJSON_Delete it)
+static cJSON *kv_record_decode(const char *session_id, const char *text, size_t length,
+                               mcp_session_record_t *record) {
+    cJSON *value = cJSON_ParseWithLength(text, length);
+    if (!cJSON_IsObject(value)) {
+        cJSON_Delete(value);
+        return NULL;
+    }
+
+    memset(record, 0, sizeof(*record));
+    strncpy(record->session_id, session_id, MCP_SESSION_ID_SIZE - 1);
+    const cJSON *state = cJSON_GetObjectItemCaseSensitive(value, "state");
+    record->state = cJSON_IsNumber(state) ? (mcp_session_state_t)state->valueint : MCP_SESSION_STATE_CREATED;
+    record->created_time = kv_time(value, "created");
+    record->last_activity = kv_time(value, "lastActivity");
+    record->expires_at = kv_time(value, "expires");
+    record->client_name = (char*)kv_string(value, "clientName");
+    record->client_version = (char*)kv_string(value, "clientVersion");
+    record->protocol_version = (char*)kv_string(value, "protocolVersion");
+    record->roots = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(value, "roots"));
+    record->sampling = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(value, "sampling"));
+    return value;
+}
+
+static char *kv_strdup(const char *text) {
+    if (!text) return NULL;
+
+    size_t size = strlen(text) + 1;
+    char *copy = malloc(size);
+    return copy ? memcpy(copy, text, size) : NULL;
+}
+
+static int kv_store_get(mcp_session_store_t *base, const char *session_id, mcp_session_record_t *record) {
+    kv_store_t *store = (kv_store_t*)base;
+    char key[KV_KEY_SIZE];
+    kv_key(store, session_id, key);
+
+    char *text = NULL;
+    size_t length = 0;
+    int found = store->client.get(store->client.ctx, key, &text, &length);
+    if (found != 0) return found < 0 ? -1 : 1;
+
+    mcp_session_record_t decoded;
+    cJSON *value = kv_record_decode(session_id, text, length, &decoded);
+    free(text);
+    if (!value) {
+        mcp_log_warn("Session store value for %s is not a session record", session_id);
+        return -1;
+    }
+
+    // The service may not have evicted it yet
+    int result = 1;
+    if (decoded.expires_at >= time(NULL) && decoded.state != MCP_SESSION_STATE_TERMINATED) {
+        *record = decoded;
+        record->client_name = kv_strdup(decoded.client_name);
+        record->client_version = kv_strdup(decoded.client_version);
+        record->protocol_version = kv_strdup(decoded.protocol_version);
+        result = 0;
+        if ((decoded.client_name && !record->client_name) ||
+            (decoded.client_version && !record->client_version) ||
+            (decoded.protocol_version && !record->protocol_version)) {
+            mcp_session_record_clear(record);
+            result = -1;
+        }
+    }
+    cJSON_Delete(value);
+    return result;
+}
+
+// Write records with one set_many call
+static int kv_store_write(kv_store_t *store, const mcp_session_record_t *records, size_t count,
+                          bool if_exists) {
+    mcp_kv_entry_t *entries = calloc(count, sizeof(mcp_kv_entry_t) + KV_KEY_SIZE);
+    if (!entries) return -1;
+    char *keys = (char*)(entries + count);
+
+    int result = 0;
+    size_t encoded = 0;
+    for (; encoded < count; encoded++) {
+        char *key = keys + encoded * KV_KEY_SIZE;
+        kv_key(store, records[encoded].session_id, key);
+        entries[encoded].key = key;
+        entries[encoded].value = kv_record_encode(&records[encoded]);
+        if (!entries[encoded].value) {
+            result = -1;
+            break;
+        }
+        entries[encoded].length = strlen(entries[encoded].value);
+        entries[encoded].expires_at = records[encoded].expires_at;
+        entries[encoded].if_exists = if_exists;
+    }
+
+    if (result == 0) {
+        result = store->client.set_many(store->client.ctx, entries, count) == 0 ? 0 : -1;
+    }
+
+    for (size_t i = 0; i < encoded; i++) {
+        cJSON_free((void*)entries[i].value);
+    }
+    free(entries);
+    return result;
+}
+
+static int kv_store_put(mcp_session_store_t *base, const mcp_session_record_t *record) {
+    return kv_store_write((kv_store_t*)base, record, 1, false);
+}
+
+// Activity only refreshes sessions that are still there, a session ended on another
+// node is not brought back
+static int kv_store_touch(mcp_session_store_t *base, const mcp_session_record_t *records, size_t count) {
+    if (count == 0) return 0;
+    return kv_store_write((kv_store_t*)base, records, count, true);
+}
+
+static int kv_store_expire(mcp_session_store_t *base, const char *session_id) {
+    kv_store_t *store = (kv_store_t*)base;
+    char key[KV_KEY_SIZE];
+    kv_key(store, session_id, key);
+    return store->client.del(store->client.ctx, key) == 0 ? 0 : -1;
+}
+
+typedef struct {
+    kv_store_t *store;
+    mcp_session_store_scan_fn fn;
+    void *user_data;
+    time_t now;
+} kv_scan_t;
+
+static int kv_scan_entry(const char *key, const char *text, size_t length, void *user_data) {
+    kv_scan_t *scan = (kv_scan_t*)user_data;
+    if (strlen(key) != scan->store->prefix_length + MCP_SESSION_ID_SIZE - 1) return 0;
+
+    mcp_session_record_t record;
+    cJSON *value = kv_record_decode(key + scan->store->prefix_length, text, length, &record);
+    if (!value) return 0;
+
+    int result = 0;
+    if (record.expires_at >= scan->now && record.state != MCP_SESSION_STATE_TERMINATED) {
+        result = scan->fn(&record, scan->user_data);
+    }
+    cJSON_Delete(value);
+    return result;
+}
+
+static int kv_store_scan(mcp_session_store_t *base, mcp_session_store_scan_fn fn, void *user_data) {
+    kv_store_t *store = (kv_store_t*)base;
+    if (!store->client.scan) return -1;
+
+    kv_scan_t scan = { store, fn, user_data, time(NULL) };
+    return store->client.scan(store->client.ctx, store->prefix, kv_scan_entry, &scan) == 0 ? 0 : -1;
+}
+
+static void kv_store_destroy(mcp_session_store_t *base) {
+    kv_store_t *store = (kv_store_t*)base;
+    if (store->client.destroy) {
+        store->client.destroy(store->client.ctx);
+    }
+    mcp_platform_get_hal()->memory.free(store);
+}
+
+static const mcp_session_store_ops_t kv_store_ops = {
+    kv_store_get,
+    kv_store_put,
+    kv_store_touch,
+    kv_store_expire,
+    kv_store_scan,
+    kv_store_destroy
+};
+
+mcp_session_store_t *mcp_session_store_kv_create(const mcp_kv_client_t *client, const char *prefix) {
+    if (!client || !client->get || !client->set_many || !client->del) return NULL;
+
+    if (!prefix) prefix = KV_PREFIX_DEFAULT;
+    size_t prefix_length = strlen(prefix);
+    if (prefix_length > KV_PREFIX_MAX) {
+        mcp_log_error("Session store key prefix longer than %d bytes", KV_PREFIX_MAX);
+        return NULL;
+    }
+
+    kv_store_t *store = mcp_platform_get_hal()->memory.alloc(sizeof(kv_store_t));
+    if (!store) return NULL;
+    memset(store, 0, sizeof(kv_store_t));
+
+    store->base.ops = &kv_store_ops;
+    store->base.impl = store;
+    store->client = *client;
+    store->prefix_length = prefix_length;
+    memcpy(store->prefix, prefix, prefix_length + 1);
+    return &store->base;
+}
@@ -0,0 +1,57 @@
+#ifndef MCP_SESSION_STORE_KV_H
+#define MCP_SESSION_STORE_KV_H
+
+#include "application/session_store.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+// Session store on a shared key-value service (Redis, etcd, memcached, ...).
+//
+// The application supplies the client. Each session is one JSON value under
+// <prefix><session id>, and the service's own expiry is set to the session's, so
+// sessions nobody touches disappear without a sweeper. touch() goes out as a single
+// set_many() when the client has it, one round trip per batch.
+
+typedef struct {
+    const char *key;
+    const char *value;
+    size_t length;
+    time_t expires_at;              // Absolute, seconds since the epoch
+    bool if_exists;                 // Only overwrite a key that is still there (SET ... XX)
+} mcp_kv_entry_t;
+
+typedef int (*mcp_kv_scan_fn)(const char *key, const char *value, size_t length, void *user_data);
+
+typedef struct {
+    /**
+     * Read a key
+     * @param value Set to a malloc'ed copy of the value (the store frees it)
+     * @return 0 if found, 1 if missing, -1 on error
+     */
+    int (*get)(void *ctx, const char *key, char **value, size_t *length);
+
+    // Write entries; with one entry this is a plain SET. 0 on success
+    int (*set_many)(void *ctx, const mcp_kv_entry_t *entries, size_t count);
+
+    // Delete a key, 0 on success (also when it was missing)
+    int (*del)(void *ctx, const char *key);
+
+    // Call fn for every key starting with prefix until it returns non-zero, 0 on success
+    int (*scan)(void *ctx, const char *prefix, mcp_kv_scan_fn fn, void *user_data);
+
+    // Called when the store is destroyed, may be NULL
+    void (*destroy)(void *ctx);
+
+    void *ctx;
+} mcp_kv_client_t;
+
+/**
+ * Create a session store on a key-value client
+ * @param client Copied; the store calls client->destroy when it is destroyed
+ * @param prefix Key prefix, e.g. "mcp:session:" (NULL for that default)
+ * @return Store for mcp_session_manager_set_store(), NULL on error
+ */
+mcp_session_store_t *mcp_session_store_kv_create(const mcp_kv_client_t *client, const char *prefix);
+
+#endif // MCP_SESSION_STORE_KV_H
@@ -0,0 +1,324 @@
+#include "session_token.h"
+#include "utils/logging.h"
+#include "utils/uuid4.h"
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define SESSION_TOKEN_HAVE_URANDOM 1
+#endif
+
+#define TOKEN_FORMAT_VERSION 1
+#define TOKEN_HEADER_SIZE 19        // Version, expiry, nonce, capabilities, protocol length
+#define TOKEN_PAYLOAD_MAX (TOKEN_HEADER_SIZE + MCP_SESSION_TOKEN_PROTOCOL_MAX)
+
+// SHA-256 (FIPS 180-4)
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[64];
+    size_t used;
+} sha256_ctx_t;
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_compress(uint32_t state[8], const uint8_t block[64]) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | (uint32_t)block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROTR32(w[i - 15], 7) ^ ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTR32(w[i - 2], 17) ^ ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) + ((e & f) ^ (~e & g)) +
+                      sha256_k[i] + w[i];
+        uint32_t t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+static void sha256_init(sha256_ctx_t *ctx) {
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(ctx->state, initial, sizeof(initial));
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+static void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, size_t length) {
+    ctx->length += length;
+    while (length > 0) {
+        size_t take = 64 - ctx->used < length ? 64 - ctx->used : length;
+        memcpy(ctx->block + ctx->used, data, take);
+        ctx->used += take;
+        data += take;
+        length -= take;
+        if (ctx->used == 64) {
+            sha256_compress(ctx->state, ctx->block);
+            ctx->used = 0;
+        }
+    }
+}
+
+static void sha256_final(sha256_ctx_t *ctx, uint8_t digest[32]) {
+    uint64_t bits = ctx->length * 8;
+    static const uint8_t pad = 0x80;
+    static const uint8_t zero = 0;
+    sha256_update(ctx, &pad, 1);
+    while (ctx->used != 56) {
+        sha256_update(ctx, &zero, 1);
+    }
+    uint8_t length_be[8];
+    for (int i = 0; i < 8; i++) {
+        length_be[i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    sha256_update(ctx, length_be, 8);
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (uint8_t)(ctx->state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(ctx->state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(ctx->state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)ctx->state[i];
+    }
+}
+
+void mcp_session_token_sha256(const void *data, size_t length, uint8_t digest[32]) {
+    sha256_ctx_t ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, (const uint8_t*)data, length);
+    sha256_final(&ctx, digest);
+}
+
+// HMAC-SHA256 (RFC 2104) with a key of MCP_SESSION_TOKEN_KEY_SIZE bytes
+void mcp_session_token_hmac(const uint8_t key[MCP_SESSION_TOKEN_KEY_SIZE], const void *data, size_t length,
+                            uint8_t mac[32]) {
+    uint8_t pad[64];
+    sha256_ctx_t ctx;
+
+    memset(pad, 0x36, sizeof(pad));
+    for (size_t i = 0; i < MCP_SESSION_TOKEN_KEY_SIZE; i++) pad[i] ^= key[i];
+    sha256_init(&ctx);
+    sha256_update(&ctx, pad, sizeof(pad));
+    sha256_update(&ctx, (const uint8_t*)data, length);
+    sha256_final(&ctx, mac);
+
+    memset(pad, 0x5c, sizeof(pad));
+    for (size_t i = 0; i < MCP_SESSION_TOKEN_KEY_SIZE; i++) pad[i] ^= key[i];
+    sha256_init(&ctx);
+    sha256_update(&ctx, pad, sizeof(pad));
+    sha256_update(&ctx, mac, 32);
+    sha256_final(&ctx, mac);
+}
+
+static int random_bytes(uint8_t *out, size_t length) {
+#ifdef SESSION_TOKEN_HAVE_URANDOM
+    int fd = open("/dev/urandom", O_RDONLY);
+    if (fd >= 0) {
+        size_t filled = 0;
+        while (filled < length) {
+            ssize_t got = read(fd, out + filled, length - filled);
+            if (got <= 0) break;
+            filled += (size_t)got;
+        }
+        close(fd);
+        if (filled == length) return 0;
+    }
+#endif
+    (void)out;
+    (void)length;
+    return -1;
+}
+
+static uint64_t token_nonce(void) {
+#if defined(__GNUC__)
+    static __thread UUID4_STATE_T state = 0;
+#else
+    static UUID4_STATE_T state = 0;
+#endif
+    if (state == 0) {
+        uuid4_seed(&state);
+    }
+    UUID4_T uuid;
+    uuid4_gen(&state, &uuid);
+    return uuid.qwords[0];
+}
+
+int mcp_session_token_key_init(mcp_session_token_key_t *key, const char *secret, time_t lifetime) {
+    if (!key) return -1;
+
+    memset(key, 0, sizeof(*key));
+    key->lifetime = lifetime > 0 ? lifetime : 3600;
+
+    if (secret) {
+        // Any length of secret becomes a full-size key
+        mcp_session_token_sha256(secret, strlen(secret), key->key);
+        return 0;
+    }
+
+    if (random_bytes(key->key, sizeof(key->key)) != 0) {
+        mcp_log_error("No random source for the session token key, configure a secret");
+        return -1;
+    }
+    mcp_log_warn("Session tokens signed with a random key: other servers will not accept them");
+    return 0;
+}
+
+void mcp_session_token_key_clear(mcp_session_token_key_t *key) {
+    if (!key) return;
+
+    volatile uint8_t *bytes = key->key;
+    for (size_t i = 0; i < sizeof(key->key); i++) bytes[i] = 0;
+}
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static void hex_encode(const uint8_t *data, size_t length, char *out) {
+    for (size_t i = 0; i < length; i++) {
+        out[i * 2] = hex_digits[data[i] >> 4];
+        out[i * 2 + 1] = hex_digits[data[i] & 0x0f];
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static bool hex_decode(const char *text, size_t length, uint8_t *out) {
+    for (size_t i = 0; i < length / 2; i++) {
+        int high = hex_value(text[i * 2]);
+        int low = hex_value(text[i * 2 + 1]);
+        if (high < 0 || low < 0) return false;
+        out[i] = (uint8_t)(high << 4 | low);
+    }
+    return true;
+}
+
+size_t mcp_session_token_issue(mcp_session_token_key_t *key, const char *protocol_version,
+                               unsigned int capabilities, time_t now, char *out) {
+    if (!key || !protocol_version || !out) return 0;
+
+    size_t version_len = strlen(protocol_version);
+    if (version_len > MCP_SESSION_TOKEN_PROTOCOL_MAX) return 0;
+    for (size_t i = 0; i < version_len; i++) {
+        if (protocol_version[i] < 0x21 || protocol_version[i] > 0x7e) return 0;
+    }
+
+    uint8_t payload[TOKEN_PAYLOAD_MAX];
+    uint64_t expires_at = (uint64_t)(now + key->lifetime);
+    uint64_t nonce = token_nonce();
+    payload[0] = TOKEN_FORMAT_VERSION;
+    for (int i = 0; i < 8; i++) {
+        payload[1 + i] = (uint8_t)(expires_at >> (56 - 8 * i));
+        payload[9 + i] = (uint8_t)(nonce >> (56 - 8 * i));
+    }
+    payload[17] = (uint8_t)capabilities;
+    payload[18] = (uint8_t)version_len;
+    memcpy(payload + TOKEN_HEADER_SIZE, protocol_version, version_len);
+    size_t payload_len = TOKEN_HEADER_SIZE + version_len;
+
+    uint8_t mac[32];
+    mcp_session_token_hmac(key->key, payload, payload_len, mac);
+
+    hex_encode(payload, payload_len, out);
+    hex_encode(mac, MCP_SESSION_TOKEN_TAG_SIZE, out + payload_len * 2);
+    size_t length = (payload_len + MCP_SESSION_TOKEN_TAG_SIZE) * 2;
+    out[length] = '\0';
+
+    __atomic_add_fetch(&key->issued, 1, __ATOMIC_RELAXED);
+    return length;
+}
+
+static mcp_session_token_result_t token_reject(mcp_session_token_key_t *key,
+                                               mcp_session_token_result_t result) {
+    __atomic_add_fetch(&key->rejected, 1, __ATOMIC_RELAXED);
+    return result;
+}
+
+mcp_session_token_result_t mcp_session_token_verify(mcp_session_token_key_t *key,
+                                                    const char *token, size_t length, time_t now,
+                                                    mcp_session_token_claims_t *claims) {
+    if (!key) return MCP_SESSION_TOKEN_MALFORMED;
+
+    // Shape first: the length pins down the protocol version length in the payload
+    size_t tag_hex = MCP_SESSION_TOKEN_TAG_SIZE * 2;
+    if (!token || length % 2 != 0 || length < TOKEN_HEADER_SIZE * 2 + tag_hex ||
+        length > TOKEN_PAYLOAD_MAX * 2 + tag_hex) {
+        return token_reject(key, MCP_SESSION_TOKEN_MALFORMED);
+    }
+
+    size_t payload_len = (length - tag_hex) / 2;
+    uint8_t payload[TOKEN_PAYLOAD_MAX];
+    uint8_t tag[MCP_SESSION_TOKEN_TAG_SIZE];
+    if (!hex_decode(token, payload_len * 2, payload) ||
+        !hex_decode(token + payload_len * 2, tag_hex, tag) ||
+        payload[0] != TOKEN_FORMAT_VERSION ||
+        payload[18] != payload_len - TOKEN_HEADER_SIZE) {
+        return token_reject(key, MCP_SESSION_TOKEN_MALFORMED);
+    }
+
+    uint8_t mac[32];
+    mcp_session_token_hmac(key->key, payload, payload_len, mac);
+    uint8_t difference = 0;
+    for (size_t i = 0; i < MCP_SESSION_TOKEN_TAG_SIZE; i++) {
+        difference |= (uint8_t)(mac[i] ^ tag[i]);
+    }
+    if (difference != 0) {
+        return token_reject(key, MCP_SESSION_TOKEN_BAD_SIGNATURE);
+    }
+
+    uint64_t expires_at = 0;
+    uint64_t nonce = 0;
+    for (int i = 0; i < 8; i++) {
+        expires_at = expires_at << 8 | payload[1 + i];
+        nonce = nonce << 8 | payload[9 + i];
+    }
+    if ((uint64_t)now > expires_at) {
+        return token_reject(key, MCP_SESSION_TOKEN_EXPIRED);
+    }
+
+    if (claims) {
+        size_t version_len = payload_len - TOKEN_HEADER_SIZE;
+        memcpy(claims->protocol_version, payload + TOKEN_HEADER_SIZE, version_len);
+        claims->protocol_version[version_len] = '\0';
+        claims->capabilities = payload[17];
+        claims->expires_at = (time_t)expires_at;
+        claims->nonce = nonce;
+    }
+    return MCP_SESSION_TOKEN_OK;
+}
+
+const char *mcp_session_token_result_string(mcp_session_token_result_t result) {
+    switch (result) {
+        case MCP_SESSION_TOKEN_OK: return "ok";
+        case MCP_SESSION_TOKEN_MALFORMED: return "malformed session token";
+        case MCP_SESSION_TOKEN_BAD_SIGNATURE: return "session token signature mismatch";
+        case MCP_SESSION_TOKEN_EXPIRED: return "session token expired";
+    }
+    return "unknown";
+}
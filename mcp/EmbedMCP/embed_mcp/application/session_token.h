@@ -0,0 +1,89 @@
+#ifndef MCP_SESSION_TOKEN_H
+#define MCP_SESSION_TOKEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// Self-validating session IDs for stateless HTTP serving.
+//
+// Instead of a table entry, the Mcp-Session-Id handed out by initialize carries
+// what the session negotiated - protocol version, client capabilities, expiry - and
+// an HMAC-SHA256 tag over it. Any server holding the same secret verifies the token
+// on its own, so requests can land on any node and nothing is stored per client.
+// Tokens cannot be revoked before they expire.
+//
+// Token text: hex of the payload followed by hex of the truncated tag, visible
+// ASCII only as the MCP transport requires.
+
+#define MCP_SESSION_TOKEN_KEY_SIZE 32
+#define MCP_SESSION_TOKEN_TAG_SIZE 16
+#define MCP_SESSION_TOKEN_PROTOCOL_MAX 32
+
+// Longest token text plus the terminator
+#define MCP_SESSION_TOKEN_MAX_SIZE \
+    (2 * (19 + MCP_SESSION_TOKEN_PROTOCOL_MAX + MCP_SESSION_TOKEN_TAG_SIZE) + 1)
+
+// Client capabilities recorded in a token
+#define MCP_SESSION_TOKEN_CAP_ROOTS    (1u << 0)
+#define MCP_SESSION_TOKEN_CAP_SAMPLING (1u << 1)
+
+typedef struct {
+    uint8_t key[MCP_SESSION_TOKEN_KEY_SIZE];
+    time_t lifetime;                // Seconds a new token stays valid
+
+    // Statistics (atomic)
+    uint64_t issued;
+    uint64_t rejected;
+} mcp_session_token_key_t;
+
+typedef struct {
+    char protocol_version[MCP_SESSION_TOKEN_PROTOCOL_MAX + 1];
+    unsigned int capabilities;      // MCP_SESSION_TOKEN_CAP_*
+    time_t expires_at;
+    uint64_t nonce;                 // Random, tells apart tokens issued in the same second
+} mcp_session_token_claims_t;
+
+typedef enum {
+    MCP_SESSION_TOKEN_OK = 0,
+    MCP_SESSION_TOKEN_MALFORMED,
+    MCP_SESSION_TOKEN_BAD_SIGNATURE,
+    MCP_SESSION_TOKEN_EXPIRED
+} mcp_session_token_result_t;
+
+/**
+ * Set up a signing key
+ * @param secret Shared by every node that should accept the tokens; NULL draws a
+ *               random key, so only this process will accept them
+ * @return 0 on success, -1 if no random key could be drawn
+ */
+int mcp_session_token_key_init(mcp_session_token_key_t *key, const char *secret, time_t lifetime);
+void mcp_session_token_key_clear(mcp_session_token_key_t *key);
+
+/**
+ * Issue a token for a session that negotiated protocol_version
+ * @param out Buffer of at least MCP_SESSION_TOKEN_MAX_SIZE bytes
+ * @return Token length, or 0 if protocol_version is too long or not printable
+ */
+size_t mcp_session_token_issue(mcp_session_token_key_t *key, const char *protocol_version,
+                               unsigned int capabilities, time_t now, char *out);
+
+/**
+ * Check a token's tag (compared in constant time) and expiry
+ * @param claims Filled in when the result is MCP_SESSION_TOKEN_OK, may be NULL
+ */
+mcp_session_token_result_t mcp_session_token_verify(mcp_session_token_key_t *key,
+                                                    const char *token, size_t length, time_t now,
+                                                    mcp_session_token_claims_t *claims);
+
+const char *mcp_session_token_result_string(mcp_session_token_result_t result);
+
+// The primitives behind the tokens, for known-answer checks. A shorter HMAC key is the
+// same key zero-padded to MCP_SESSION_TOKEN_KEY_SIZE bytes; a key longer than the
+// 64-byte block is its SHA-256 digest (RFC 2104).
+void mcp_session_token_sha256(const void *data, size_t length, uint8_t digest[32]);
+void mcp_session_token_hmac(const uint8_t key[MCP_SESSION_TOKEN_KEY_SIZE], const void *data, size_t length,
+                            uint8_t mac[32]);
+
+#endif // MCP_SESSION_TOKEN_H
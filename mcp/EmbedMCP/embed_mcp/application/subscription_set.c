@@ -0,0 +1,109 @@
+#include "application/subscription_set.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Index of uri in the set, or -1. Caller holds mutex.
+static long subscription_find(const mcp_subscription_set_t *set, const char *uri) {
+    for (size_t i = 0; i < set->count; i++) {
+        if (strcmp(set->uris[i], uri) == 0) return (long)i;
+    }
+    return -1;
+}
+
+mcp_subscription_set_t *mcp_subscription_set_create(void) {
+    mcp_subscription_set_t *set = calloc(1, sizeof(mcp_subscription_set_t));
+    if (!set) return NULL;
+
+    if (pthread_mutex_init(&set->mutex, NULL) != 0) {
+        free(set);
+        return NULL;
+    }
+    return set;
+}
+
+void mcp_subscription_set_destroy(mcp_subscription_set_t *set) {
+    if (!set) return;
+
+    for (size_t i = 0; i < set->count; i++) {
+        free(set->uris[i]);
+    }
+    free(set->uris);
+    pthread_mutex_destroy(&set->mutex);
+    free(set);
+}
+
+int mcp_subscription_set_add(mcp_subscription_set_t *set, const char *uri) {
+    if (!set || !uri) return -1;
+
+    pthread_mutex_lock(&set->mutex);
+    if (subscription_find(set, uri) >= 0) {
+        pthread_mutex_unlock(&set->mutex);
+        return 0;
+    }
+    if (set->count >= MCP_SUBSCRIPTION_SET_MAX) {
+        pthread_mutex_unlock(&set->mutex);
+        return -1;
+    }
+
+    if (set->count == set->capacity) {
+        size_t capacity = set->capacity ? set->capacity * 2 : 4;
+        char **uris = realloc(set->uris, capacity * sizeof(char*));
+        if (!uris) {
+            pthread_mutex_unlock(&set->mutex);
+            return -1;
+        }
+        set->uris = uris;
+        set->capacity = capacity;
+    }
+
+    char *copy = strdup(uri);
+    if (!copy) {
+        pthread_mutex_unlock(&set->mutex);
+        return -1;
+    }
+    set->uris[set->count++] = copy;
+    pthread_mutex_unlock(&set->mutex);
+    return 1;
+}
+
+int mcp_subscription_set_remove(mcp_subscription_set_t *set, const char *uri) {
+    if (!set || !uri) return 0;
+
+    pthread_mutex_lock(&set->mutex);
+    long index = subscription_find(set, uri);
+    if (index >= 0) {
+        free(set->uris[index]);
+        set->uris[index] = set->uris[--set->count];
+    }
+    pthread_mutex_unlock(&set->mutex);
+    return index >= 0 ? 1 : 0;
+}
+
+bool mcp_subscription_set_contains(mcp_subscription_set_t *set, const char *uri) {
+    if (!set || !uri) return false;
+
+    pthread_mutex_lock(&set->mutex);
+    bool found = subscription_find(set, uri) >= 0;
+    pthread_mutex_unlock(&set->mutex);
+    return found;
+}
+
+size_t mcp_subscription_set_count(mcp_subscription_set_t *set) {
+    if (!set) return 0;
+
+    pthread_mutex_lock(&set->mutex);
+    size_t count = set->count;
+    pthread_mutex_unlock(&set->mutex);
+    return count;
+}
+
+void mcp_subscription_set_for_each(mcp_subscription_set_t *set, mcp_subscription_visit_t visit,
+                                   void *user_data) {
+    if (!set || !visit) return;
+
+    pthread_mutex_lock(&set->mutex);
+    for (size_t i = 0; i < set->count; i++) {
+        visit(set->uris[i], user_data);
+    }
+    pthread_mutex_unlock(&set->mutex);
+}
@@ -0,0 +1,47 @@
+#ifndef MCP_SUBSCRIPTION_SET_H
+#define MCP_SUBSCRIPTION_SET_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// Resource URIs one client subscribed to with resources/subscribe. A session keeps
+// its set on mcp_session_t; STDIO and UART connections keep theirs in the list
+// notifier. Sets are small, so they are plain arrays searched in order.
+
+// Most URIs one client may subscribe to
+#ifndef MCP_SUBSCRIPTION_SET_MAX
+#define MCP_SUBSCRIPTION_SET_MAX 64
+#endif
+
+typedef struct mcp_subscription_set {
+    pthread_mutex_t mutex;
+    char **uris;
+    size_t count;
+    size_t capacity;
+} mcp_subscription_set_t;
+
+// Callback for mcp_subscription_set_for_each(), called with the set locked
+typedef void (*mcp_subscription_visit_t)(const char *uri, void *user_data);
+
+mcp_subscription_set_t *mcp_subscription_set_create(void);
+void mcp_subscription_set_destroy(mcp_subscription_set_t *set);
+
+/**
+ * Add a URI
+ * @return 1 if added, 0 if already present, -1 when full or on allocation failure
+ */
+int mcp_subscription_set_add(mcp_subscription_set_t *set, const char *uri);
+
+/**
+ * Remove a URI
+ * @return 1 if removed, 0 if it was not present
+ */
+int mcp_subscription_set_remove(mcp_subscription_set_t *set, const char *uri);
+
+bool mcp_subscription_set_contains(mcp_subscription_set_t *set, const char *uri);
+size_t mcp_subscription_set_count(mcp_subscription_set_t *set);
+void mcp_subscription_set_for_each(mcp_subscription_set_t *set, mcp_subscription_visit_t visit,
+                                   void *user_data);
+
+#endif // MCP_SUBSCRIPTION_SET_H
@@ -0,0 +1,363 @@
+#include "application/worker_pool.h"
+#include "hal/platform_hal.h"
+#include "utils/logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t worker_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+// Next job by priority, caller holds queue_mutex. Higher classes always go first: they
+// are short and few, so the work class is not starved in practice.
+static mcp_worker_job_t *worker_queue_pop(mcp_worker_pool_t *pool) {
+    for (int i = 0; i < MCP_WORKER_PRIORITY_COUNT; i++) {
+        mcp_worker_queue_t *queue = &pool->queues[i];
+        mcp_worker_job_t *job = queue->head;
+        if (!job) continue;
+
+        queue->head = job->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+        __atomic_store_n(&queue->head_queued_ms, queue->head ? queue->head->queued_ms : 0,
+                         __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&queue->length, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&pool->queue_length, 1, __ATOMIC_RELAXED);
+        return job;
+    }
+    return NULL;
+}
+
+// Worker thread main loop - runs queued jobs until the pool shuts down
+static void *worker_thread_main(void *arg) {
+    mcp_worker_pool_t *pool = (mcp_worker_pool_t*)arg;
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+
+    for (;;) {
+        pthread_mutex_lock(&pool->queue_mutex);
+
+        while (pool->queue_length == 0 && !pool->shutting_down) {
+            pthread_cond_wait(&pool->queue_cond, &pool->queue_mutex);
+        }
+
+        // Queued jobs are still drained during shutdown so no request is dropped
+        mcp_worker_job_t *job = worker_queue_pop(pool);
+        if (!job) {
+            pthread_mutex_unlock(&pool->queue_mutex);
+            break;
+        }
+
+        pthread_mutex_unlock(&pool->queue_mutex);
+
+        job->func(job->arg);
+        hal->memory.free(job);
+
+        __atomic_add_fetch(&pool->jobs_completed, 1, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+// Worker pool lifecycle
+mcp_worker_pool_t *mcp_worker_pool_create(size_t thread_count, size_t queue_capacity) {
+    if (thread_count == 0) return NULL;
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    if (!hal) return NULL;
+
+    mcp_worker_pool_t *pool = hal->memory.alloc(sizeof(mcp_worker_pool_t));
+    if (!pool) return NULL;
+    memset(pool, 0, sizeof(mcp_worker_pool_t));
+
+    pool->queue_capacity = queue_capacity;
+
+    pool->threads = hal->memory.alloc(thread_count * sizeof(pthread_t));
+    if (!pool->threads) {
+        hal->memory.free(pool);
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&pool->queue_mutex, NULL) != 0) {
+        hal->memory.free(pool->threads);
+        hal->memory.free(pool);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&pool->queue_cond, NULL) != 0) {
+        pthread_mutex_destroy(&pool->queue_mutex);
+        hal->memory.free(pool->threads);
+        hal->memory.free(pool);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < thread_count; i++) {
+        if (pthread_create(&pool->threads[i], NULL, worker_thread_main, pool) != 0) {
+            mcp_log_error("Failed to create worker thread %zu", i);
+            break;
+        }
+        pool->thread_count++;
+    }
+
+    if (pool->thread_count == 0) {
+        mcp_worker_pool_destroy(pool);
+        return NULL;
+    }
+
+    mcp_log_info("Worker pool started with %zu threads", pool->thread_count);
+    return pool;
+}
+
+void mcp_worker_pool_destroy(mcp_worker_pool_t *pool) {
+    if (!pool) return;
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+
+    pthread_mutex_lock(&pool->queue_mutex);
+    pool->shutting_down = true;
+    pthread_cond_broadcast(&pool->queue_cond);
+    pthread_mutex_unlock(&pool->queue_mutex);
+
+    for (size_t i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    // Only reachable if no worker thread could be started
+    mcp_worker_job_t *job;
+    while ((job = worker_queue_pop(pool)) != NULL) {
+        hal->memory.free(job);
+    }
+
+    pthread_cond_destroy(&pool->queue_cond);
+    pthread_mutex_destroy(&pool->queue_mutex);
+
+    hal->memory.free(pool->threads);
+    hal->memory.free(pool);
+}
+
+// Job submission
+mcp_worker_submit_result_t mcp_worker_pool_submit_priority(mcp_worker_pool_t *pool,
+                                                           mcp_worker_job_func_t func, void *arg,
+                                                           mcp_worker_priority_t priority) {
+    if (!pool || !func || (unsigned)priority >= MCP_WORKER_PRIORITY_COUNT) {
+        return MCP_WORKER_SUBMIT_ERROR;
+    }
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+
+    mcp_worker_job_t *job = hal->memory.alloc(sizeof(mcp_worker_job_t));
+    if (!job) return MCP_WORKER_SUBMIT_ERROR;
+
+    job->func = func;
+    job->arg = arg;
+    job->queued_ms = worker_now_ms();
+    job->next = NULL;
+
+    mcp_worker_queue_t *queue = &pool->queues[priority];
+    mcp_worker_submit_result_t result = MCP_WORKER_SUBMIT_OK;
+
+    pthread_mutex_lock(&pool->queue_mutex);
+
+    // Shed early: a full class, or one whose head has waited too long, would only
+    // hand the job to a worker after the client gave up
+    if (pool->shutting_down) {
+        result = MCP_WORKER_SUBMIT_ERROR;
+    } else if ((pool->queue_capacity > 0 && pool->queue_length >= pool->queue_capacity) ||
+               (queue->limits.max_depth > 0 && queue->length >= queue->limits.max_depth)) {
+        result = MCP_WORKER_SUBMIT_QUEUE_FULL;
+        __atomic_add_fetch(&queue->shed_full, 1, __ATOMIC_RELAXED);
+    } else if (queue->limits.max_wait_ms > 0 && queue->head &&
+               job->queued_ms - queue->head->queued_ms > queue->limits.max_wait_ms) {
+        result = MCP_WORKER_SUBMIT_QUEUE_SLOW;
+        __atomic_add_fetch(&queue->shed_slow, 1, __ATOMIC_RELAXED);
+    }
+
+    if (result != MCP_WORKER_SUBMIT_OK) {
+        __atomic_add_fetch(&pool->jobs_rejected, 1, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&pool->queue_mutex);
+        hal->memory.free(job);
+        return result;
+    }
+
+    if (queue->tail) {
+        queue->tail->next = job;
+    } else {
+        queue->head = job;
+        __atomic_store_n(&queue->head_queued_ms, job->queued_ms, __ATOMIC_RELAXED);
+    }
+    queue->tail = job;
+    __atomic_add_fetch(&queue->length, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool->queue_length, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool->jobs_submitted, 1, __ATOMIC_RELAXED);
+
+    pthread_cond_signal(&pool->queue_cond);
+    pthread_mutex_unlock(&pool->queue_mutex);
+
+    return MCP_WORKER_SUBMIT_OK;
+}
+
+int mcp_worker_pool_submit(mcp_worker_pool_t *pool, mcp_worker_job_func_t func, void *arg) {
+    return mcp_worker_pool_submit_priority(pool, func, arg, MCP_WORKER_PRIORITY_WORK) ==
+           MCP_WORKER_SUBMIT_OK ? 0 : -1;
+}
+
+void mcp_worker_pool_set_limits(mcp_worker_pool_t *pool, mcp_worker_priority_t priority,
+                                const mcp_worker_class_limits_t *limits) {
+    if (!pool || !limits || (unsigned)priority >= MCP_WORKER_PRIORITY_COUNT) return;
+
+    pthread_mutex_lock(&pool->queue_mutex);
+    pool->queues[priority].limits = *limits;
+    pthread_mutex_unlock(&pool->queue_mutex);
+}
+
+const char *mcp_worker_priority_name(mcp_worker_priority_t priority) {
+    switch (priority) {
+        case MCP_WORKER_PRIORITY_CONTROL: return "control";
+        case MCP_WORKER_PRIORITY_QUERY: return "query";
+        case MCP_WORKER_PRIORITY_WORK: return "work";
+        default: return "unknown";
+    }
+}
+
+// Parallel loop shared by the caller and the helper jobs it queued.
+// Helpers may start after the loop is done, so the context is reference counted.
+typedef struct {
+    mcp_worker_parallel_func_t func;
+    void *arg;
+    size_t count;
+    size_t next_index;
+    size_t completed;
+    int ref_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t done_cond;
+} parallel_context_t;
+
+static void parallel_context_release(parallel_context_t *ctx) {
+    pthread_mutex_lock(&ctx->mutex);
+    bool last = (--ctx->ref_count == 0);
+    pthread_mutex_unlock(&ctx->mutex);
+
+    if (last) {
+        pthread_cond_destroy(&ctx->done_cond);
+        pthread_mutex_destroy(&ctx->mutex);
+        mcp_platform_get_hal()->memory.free(ctx);
+    }
+}
+
+static void parallel_run_tasks(parallel_context_t *ctx) {
+    for (;;) {
+        size_t index = __atomic_fetch_add(&ctx->next_index, 1, __ATOMIC_ACQ_REL);
+        if (index >= ctx->count) break;
+
+        ctx->func(ctx->arg, index);
+
+        pthread_mutex_lock(&ctx->mutex);
+        if (++ctx->completed == ctx->count) {
+            pthread_cond_signal(&ctx->done_cond);
+        }
+        pthread_mutex_unlock(&ctx->mutex);
+    }
+}
+
+static void parallel_helper_job(void *arg) {
+    parallel_context_t *ctx = (parallel_context_t*)arg;
+    parallel_run_tasks(ctx);
+    parallel_context_release(ctx);
+}
+
+int mcp_worker_pool_parallel_for(mcp_worker_pool_t *pool, mcp_worker_parallel_func_t func,
+                                 void *arg, size_t count) {
+    if (!func) return -1;
+
+    // Nothing to share - run inline
+    if (!pool || count <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            func(arg, i);
+        }
+        return 0;
+    }
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    parallel_context_t *ctx = hal->memory.alloc(sizeof(parallel_context_t));
+    if (!ctx) return -1;
+    memset(ctx, 0, sizeof(parallel_context_t));
+
+    ctx->func = func;
+    ctx->arg = arg;
+    ctx->count = count;
+    ctx->ref_count = 1;
+
+    if (pthread_mutex_init(&ctx->mutex, NULL) != 0) {
+        hal->memory.free(ctx);
+        return -1;
+    }
+    if (pthread_cond_init(&ctx->done_cond, NULL) != 0) {
+        pthread_mutex_destroy(&ctx->mutex);
+        hal->memory.free(ctx);
+        return -1;
+    }
+
+    size_t helpers = count - 1;
+    if (helpers > pool->thread_count) {
+        helpers = pool->thread_count;
+    }
+
+    for (size_t i = 0; i < helpers; i++) {
+        pthread_mutex_lock(&ctx->mutex);
+        ctx->ref_count++;
+        pthread_mutex_unlock(&ctx->mutex);
+
+        if (mcp_worker_pool_submit(pool, parallel_helper_job, ctx) != 0) {
+            // Queue full - the caller simply does more of the work itself
+            parallel_context_release(ctx);
+            break;
+        }
+    }
+
+    parallel_run_tasks(ctx);
+
+    pthread_mutex_lock(&ctx->mutex);
+    while (ctx->completed < ctx->count) {
+        pthread_cond_wait(&ctx->done_cond, &ctx->mutex);
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+
+    parallel_context_release(ctx);
+    return 0;
+}
+
+// Pool information
+size_t mcp_worker_pool_get_thread_count(const mcp_worker_pool_t *pool) {
+    return pool ? pool->thread_count : 0;
+}
+
+void mcp_worker_pool_get_stats(const mcp_worker_pool_t *pool, mcp_worker_pool_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!pool) return;
+
+    stats->thread_count = pool->thread_count;
+    stats->queue_capacity = pool->queue_capacity;
+    stats->queue_length = __atomic_load_n(&pool->queue_length, __ATOMIC_RELAXED);
+    stats->jobs_submitted = __atomic_load_n(&pool->jobs_submitted, __ATOMIC_RELAXED);
+    stats->jobs_completed = __atomic_load_n(&pool->jobs_completed, __ATOMIC_RELAXED);
+    stats->jobs_rejected = __atomic_load_n(&pool->jobs_rejected, __ATOMIC_RELAXED);
+
+    // Scrapes never contend with submitters and workers for queue_mutex
+    uint64_t now = worker_now_ms();
+    for (int i = 0; i < MCP_WORKER_PRIORITY_COUNT; i++) {
+        const mcp_worker_queue_t *queue = &pool->queues[i];
+        uint64_t head_queued_ms = __atomic_load_n(&queue->head_queued_ms, __ATOMIC_RELAXED);
+        stats->class_queue_length[i] = __atomic_load_n(&queue->length, __ATOMIC_RELAXED);
+        stats->class_oldest_wait_ms[i] = head_queued_ms && now > head_queued_ms ? now - head_queued_ms : 0;
+        stats->class_shed_full[i] = __atomic_load_n(&queue->shed_full, __ATOMIC_RELAXED);
+        stats->class_shed_slow[i] = __atomic_load_n(&queue->shed_slow, __ATOMIC_RELAXED);
+    }
+}
+
+size_t mcp_worker_pool_get_queue_length(mcp_worker_pool_t *pool) {
+    return pool ? __atomic_load_n(&pool->queue_length, __ATOMIC_RELAXED) : 0;
+}
@@ -0,0 +1,131 @@
+#ifndef MCP_WORKER_POOL_H
+#define MCP_WORKER_POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+// Forward declarations
+typedef struct mcp_worker_pool mcp_worker_pool_t;
+typedef struct mcp_worker_job mcp_worker_job_t;
+
+// Job function executed on a worker thread
+typedef void (*mcp_worker_job_func_t)(void *arg);
+
+// Priority classes, served in this order. Each class has its own FIFO queue, so a
+// flood of tool calls cannot hold back initialize or ping from a new client.
+typedef enum {
+    MCP_WORKER_PRIORITY_CONTROL = 0,    // Session setup and liveness: initialize, ping, notifications
+    MCP_WORKER_PRIORITY_QUERY,          // Listings: tools/list, resources/list, ...
+    MCP_WORKER_PRIORITY_WORK,           // Everything else: tool calls, resource reads, batches
+    MCP_WORKER_PRIORITY_COUNT
+} mcp_worker_priority_t;
+
+// Why a job was not queued
+typedef enum {
+    MCP_WORKER_SUBMIT_OK = 0,
+    MCP_WORKER_SUBMIT_ERROR = -1,       // Out of memory or the pool is stopping
+    MCP_WORKER_SUBMIT_QUEUE_FULL = -2,  // The class queue (or the whole pool) is at its depth limit
+    MCP_WORKER_SUBMIT_QUEUE_SLOW = -3   // The class's oldest job has waited longer than allowed
+} mcp_worker_submit_result_t;
+
+// Admission limits of a class, 0 = no limit
+typedef struct {
+    size_t max_depth;               // Jobs waiting in the class
+    uint32_t max_wait_ms;           // Refuse new jobs while the oldest waiting one is older
+} mcp_worker_class_limits_t;
+
+// Queued job (internal)
+struct mcp_worker_job {
+    mcp_worker_job_func_t func;
+    void *arg;
+    uint64_t queued_ms;             // Monotonic time it was queued
+    mcp_worker_job_t *next;
+};
+
+// One priority class (internal)
+typedef struct {
+    mcp_worker_job_t *head;
+    mcp_worker_job_t *tail;
+    size_t length;                  // Atomic, written under queue_mutex
+    uint64_t head_queued_ms;        // Atomic, written under queue_mutex; 0 when empty
+    mcp_worker_class_limits_t limits;
+
+    // Statistics (atomic)
+    size_t shed_full;
+    size_t shed_slow;
+} mcp_worker_queue_t;
+
+// Worker pool structure
+struct mcp_worker_pool {
+    // Worker threads
+    pthread_t *threads;
+    size_t thread_count;
+
+    // Job queues by priority
+    mcp_worker_queue_t queues[MCP_WORKER_PRIORITY_COUNT];
+    size_t queue_length;            // All classes
+    size_t queue_capacity;
+
+    // Thread safety
+    pthread_mutex_t queue_mutex;
+    pthread_cond_t queue_cond;
+    bool shutting_down;
+
+    // Statistics (atomic, readable without queue_mutex)
+    size_t jobs_submitted;
+    size_t jobs_completed;
+    size_t jobs_rejected;
+};
+
+// Worker pool lifecycle
+// queue_capacity == 0 means the queue is unbounded
+mcp_worker_pool_t *mcp_worker_pool_create(size_t thread_count, size_t queue_capacity);
+void mcp_worker_pool_destroy(mcp_worker_pool_t *pool);
+
+// Job submission - returns 0 on success, -1 if the pool is stopping or the queue is full.
+// Jobs go into the work class.
+int mcp_worker_pool_submit(mcp_worker_pool_t *pool, mcp_worker_job_func_t func, void *arg);
+
+// Queue a job in a priority class, subject to the class's limits
+mcp_worker_submit_result_t mcp_worker_pool_submit_priority(mcp_worker_pool_t *pool,
+                                                           mcp_worker_job_func_t func, void *arg,
+                                                           mcp_worker_priority_t priority);
+
+// Set a class's admission limits (any time; jobs already queued stay)
+void mcp_worker_pool_set_limits(mcp_worker_pool_t *pool, mcp_worker_priority_t priority,
+                                const mcp_worker_class_limits_t *limits);
+
+const char *mcp_worker_priority_name(mcp_worker_priority_t priority);
+
+// Run func(arg, i) for i in [0, count) on the pool and wait for all of them.
+// The calling thread takes part, so this is safe to call from a worker thread
+// and still completes if the queue is full.
+typedef void (*mcp_worker_parallel_func_t)(void *arg, size_t index);
+int mcp_worker_pool_parallel_for(mcp_worker_pool_t *pool, mcp_worker_parallel_func_t func,
+                                 void *arg, size_t count);
+
+// Pool information
+typedef struct {
+    size_t thread_count;
+    size_t queue_length;
+    size_t queue_capacity;
+    size_t jobs_submitted;
+    size_t jobs_completed;
+    size_t jobs_rejected;           // Refused for any reason, sheds included
+
+    // By priority class
+    size_t class_queue_length[MCP_WORKER_PRIORITY_COUNT];
+    size_t class_shed_full[MCP_WORKER_PRIORITY_COUNT];
+    size_t class_shed_slow[MCP_WORKER_PRIORITY_COUNT];
+    uint64_t class_oldest_wait_ms[MCP_WORKER_PRIORITY_COUNT];  // Age of the oldest waiting job
+} mcp_worker_pool_stats_t;
+
+// Snapshot without taking queue_mutex; the counters are read one by one, not as a
+// consistent set
+void mcp_worker_pool_get_stats(const mcp_worker_pool_t *pool, mcp_worker_pool_stats_t *stats);
+size_t mcp_worker_pool_get_thread_count(const mcp_worker_pool_t *pool);
+size_t mcp_worker_pool_get_queue_length(mcp_worker_pool_t *pool);
+
+#endif // MCP_WORKER_POOL_H
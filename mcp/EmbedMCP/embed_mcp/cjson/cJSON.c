@@ -49,6 +49,22 @@
 #include <locale.h>
 #endif
 
+/* EMBED_MCP_CJSON_SIMD: scan strings and whitespace in blocks and parse common
+ * numbers without strtod. The parse result is the same as the scalar path. */
+#ifdef EMBED_MCP_CJSON_SIMD
+#define CJSON_SIMD_SCAN
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CJSON_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define CJSON_SIMD_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CJSON_SIMD_NEON
+#endif
+#endif
+
 #if defined(_MSC_VER)
 #pragma warning (pop)
 #endif
@@ -303,6 +319,268 @@ typedef struct
 /* get a pointer to the buffer at the position */
 #define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
 
+#ifdef CJSON_SIMD_SCAN
+#if defined(CJSON_SIMD_AVX2) || defined(CJSON_SIMD_SSE2)
+static size_t first_set_bit(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctz(mask);
+#else
+    size_t index = 0;
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+#endif
+
+/* index of the first '\"' or '\\' in [input, input + length), length if there is none */
+static size_t scan_quote_or_backslash(const unsigned char * const input, const size_t length)
+{
+    size_t i = 0;
+#if defined(CJSON_SIMD_AVX2)
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    for (; (i + 32) <= length; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(const void*)(input + i));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)));
+        if (mask != 0)
+        {
+            return i + first_set_bit(mask);
+        }
+    }
+#elif defined(CJSON_SIMD_SSE2)
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; (i + 16) <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(const void*)(input + i));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)));
+        if (mask != 0)
+        {
+            return i + first_set_bit(mask);
+        }
+    }
+#elif defined(CJSON_SIMD_NEON)
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    for (; (i + 16) <= length; i += 16)
+    {
+        uint8x16_t block = vld1q_u8(input + i);
+        if (vmaxvq_u8(vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, backslash))) != 0)
+        {
+            break; /* the scalar loop finds it within this block */
+        }
+    }
+#endif
+    for (; i < length; i++)
+    {
+        if ((input[i] == '\"') || (input[i] == '\\'))
+        {
+            return i;
+        }
+    }
+    return length;
+}
+
+/* index of the first byte above 32 (see buffer_skip_whitespace), length if there is none */
+static size_t scan_non_whitespace(const unsigned char * const input, const size_t length)
+{
+    size_t i = 0;
+#if defined(CJSON_SIMD_AVX2)
+    const __m256i space = _mm256_set1_epi8(32);
+    for (; (i + 32) <= length; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(const void*)(input + i));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(block, space), block));
+        if (mask != 0)
+        {
+            return i + first_set_bit(mask);
+        }
+    }
+#elif defined(CJSON_SIMD_SSE2)
+    const __m128i space = _mm_set1_epi8(32);
+    for (; (i + 16) <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(const void*)(input + i));
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_min_epu8(block, space), block)) & 0xFFFFu;
+        if (mask != 0)
+        {
+            return i + first_set_bit(mask);
+        }
+    }
+#elif defined(CJSON_SIMD_NEON)
+    const uint8x16_t space = vdupq_n_u8(32);
+    for (; (i + 16) <= length; i += 16)
+    {
+        if (vmaxvq_u8(vcgtq_u8(vld1q_u8(input + i), space)) != 0)
+        {
+            break;
+        }
+    }
+#endif
+    for (; i < length; i++)
+    {
+        if (input[i] > 32)
+        {
+            return i;
+        }
+    }
+    return length;
+}
+
+/* Powers of ten that are exact doubles */
+static const double exact_powers_of_ten[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* Numbers of the form -?digits(.digits)?([eE][+-]?digits)? whose digits fit in 53 bits
+ * and whose decimal exponent is within +-22: both operands of the one multiply or divide
+ * are exact, so the result is the correctly rounded value strtod returns. Anything else
+ * (more digits, '+' or '.' first, input strtod would stop early in) returns false and
+ * goes through strtod. */
+static cJSON_bool parse_number_fast(cJSON * const item, parse_buffer * const input_buffer)
+{
+    const unsigned char *input = buffer_at_offset(input_buffer);
+    const size_t length = input_buffer->length - input_buffer->offset;
+    size_t i = 0;
+    size_t digits = 0;
+    unsigned long long mantissa = 0;
+    long exponent = 0;
+    cJSON_bool negative = false;
+    double number = 0;
+
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD != 0)
+    /* extended precision intermediates would round twice */
+    return false;
+#endif
+
+    if ((i < length) && (input[i] == '-'))
+    {
+        negative = true;
+        i++;
+    }
+    if ((i >= length) || (input[i] < '0') || (input[i] > '9'))
+    {
+        return false;
+    }
+    for (; (i < length) && (input[i] >= '0') && (input[i] <= '9'); i++)
+    {
+        mantissa = (mantissa * 10) + (unsigned long long)(input[i] - '0');
+        if (++digits > 19)
+        {
+            return false;
+        }
+    }
+    if ((i < length) && (input[i] == '.'))
+    {
+        size_t fraction_start = ++i;
+        for (; (i < length) && (input[i] >= '0') && (input[i] <= '9'); i++)
+        {
+            mantissa = (mantissa * 10) + (unsigned long long)(input[i] - '0');
+            if (++digits > 19)
+            {
+                return false;
+            }
+        }
+        if (i == fraction_start)
+        {
+            return false;
+        }
+        exponent = -(long)(i - fraction_start);
+    }
+    if ((i < length) && ((input[i] == 'e') || (input[i] == 'E')))
+    {
+        cJSON_bool negative_exponent = false;
+        long exponent_value = 0;
+        size_t exponent_start;
+
+        i++;
+        if ((i < length) && ((input[i] == '+') || (input[i] == '-')))
+        {
+            negative_exponent = (input[i] == '-');
+            i++;
+        }
+        exponent_start = i;
+        for (; (i < length) && (input[i] >= '0') && (input[i] <= '9'); i++)
+        {
+            if (exponent_value > 10000)
+            {
+                return false;
+            }
+            exponent_value = (exponent_value * 10) + (long)(input[i] - '0');
+        }
+        if (i == exponent_start)
+        {
+            return false;
+        }
+        exponent += negative_exponent ? -exponent_value : exponent_value;
+    }
+
+    /* the scalar path hands strtod every following [0-9+-eE.] character */
+    if (i < length)
+    {
+        switch (input[i])
+        {
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9':
+            case '+': case '-': case 'e': case 'E': case '.':
+                return false;
+            default:
+                break;
+        }
+    }
+
+    if ((mantissa > (1ULL << 53)) || (exponent < -22) || (exponent > 22))
+    {
+        return false;
+    }
+    number = (double)mantissa;
+    if (exponent < 0)
+    {
+        number /= exact_powers_of_ten[-exponent];
+    }
+    else
+    {
+        number *= exact_powers_of_ten[exponent];
+    }
+    if (negative)
+    {
+        number = -number;
+    }
+
+    item->valuedouble = number;
+
+    /* use saturation in case of overflow */
+    if (number >= INT_MAX)
+    {
+        item->valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        item->valueint = INT_MIN;
+    }
+    else
+    {
+        item->valueint = (int)number;
+    }
+
+    item->type = cJSON_Number;
+    input_buffer->offset += i;
+    return true;
+}
+#endif /* CJSON_SIMD_SCAN */
+
 /* Parse the input text to generate a number, and populate the result into item. */
 static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
 {
@@ -319,6 +597,13 @@ static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_bu
         return false;
     }
 
+#ifdef CJSON_SIMD_SCAN
+    if ((decimal_point == '.') && parse_number_fast(item, input_buffer))
+    {
+        return true;
+    }
+#endif
+
     /* copy the number into a temporary buffer and replace '.' with the decimal point
      * of the current locale (for strtod)
      * This also takes care of '\0' not necessarily being available for marking the end of the input */
@@ -833,6 +1118,30 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
         /* calculate approximate size of the output (overestimate) */
         size_t allocation_length = 0;
         size_t skipped_bytes = 0;
+#ifdef CJSON_SIMD_SCAN
+        for (;;)
+        {
+            size_t position = (size_t)(input_end - input_buffer->content);
+            if (position >= input_buffer->length)
+            {
+                break;
+            }
+            input_end += scan_quote_or_backslash(input_end, input_buffer->length - position);
+            position = (size_t)(input_end - input_buffer->content);
+            if ((position >= input_buffer->length) || (*input_end == '\"'))
+            {
+                break;
+            }
+            /* is escape sequence */
+            if ((position + 1) >= input_buffer->length)
+            {
+                /* prevent buffer overflow when last input character is a backslash */
+                goto fail;
+            }
+            skipped_bytes++;
+            input_end += 2;
+        }
+#else
         while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
         {
             /* is escape sequence */
@@ -848,6 +1157,7 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
             }
             input_end++;
         }
+#endif
         if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
         {
             goto fail; /* string ended unexpectedly */
@@ -868,7 +1178,16 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
     {
         if (*input_pointer != '\\')
         {
+#ifdef CJSON_SIMD_SCAN
+            /* copy up to the next escape sequence in one go */
+            const unsigned char *escape = (const unsigned char*)memchr(input_pointer, '\\', (size_t)(input_end - input_pointer));
+            size_t run = escape ? (size_t)(escape - input_pointer) : (size_t)(input_end - input_pointer);
+            memcpy(output_pointer, input_pointer, run);
+            output_pointer += run;
+            input_pointer += run;
+#else
             *output_pointer++ = *input_pointer++;
+#endif
         }
         /* escape sequence */
         else
@@ -1094,10 +1413,18 @@ static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
         return buffer;
     }
 
+#ifdef CJSON_SIMD_SCAN
+    /* compact JSON has no whitespace between tokens, so only runs take the block scan */
+    if (buffer_at_offset(buffer)[0] <= 32)
+    {
+        buffer->offset += scan_non_whitespace(buffer_at_offset(buffer), buffer->length - buffer->offset);
+    }
+#else
     while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
     {
        buffer->offset++;
     }
+#endif
 
     if (buffer->offset == buffer->length)
     {
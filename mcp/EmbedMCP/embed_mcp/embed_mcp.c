@@ -1,25 +1,87 @@
 #include "embed_mcp.h"
 #include "protocol/mcp_protocol.h"
+#include "protocol/json_writer.h"
+#include "protocol/jsonrpc.h"
 #include "transport/transport_interface.h"
+#include "transport/http_transport.h"
 #include "tools/tool_registry.h"
 #include "tools/tool_interface.h"
+#include "tools/tool_executor.h"
 #include "tools/resource_registry.h"
+#include "tools/resource_watcher.h"
+#include "tools/builtin_tools.h"
 #include "application/session_manager.h"
+#include "application/session_token.h"
+#include "application/worker_pool.h"
+#include "application/list_notifier.h"
+#include "application/subscription_set.h"
 #include "hal/platform_hal.h"
 #include "hal/hal_common.h"
 #include "utils/logging.h"
 #include "utils/error_codes.h"
+#include "utils/arena.h"
+#include "utils/base64.h"
+#include "utils/array_convert.h"
+#include "utils/metrics.h"
+#include "utils/capture.h"
+#include "utils/epoch.h"
+#include "utils/json_pool.h"
+#include "utils/trace.h"
+#include "utils/mem_budget.h"
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+// How long a stopping server waits for tool calls that are still running
+#define EMBED_MCP_SHUTDOWN_DRAIN_MS 5000
+
+// Result cache size when a tool TTL is set before embed_mcp_enable_tool_cache()
+#define EMBED_MCP_TOOL_CACHE_BYTES (256 * 1024)
 
 // Global error message
 static char g_error_message[512] = {0};
 static volatile int g_running = 1;
 
+// Self-pipe the STDIO main loop blocks on; HTTP mode blocks in the network poller instead
+static int g_wakeup_pipe[2] = {-1, -1};
+
+// Connection of the request currently being handled on this thread. Requests can be
+// in flight on several worker threads at once, so this cannot live on the server.
+#if defined(__GNUC__)
+static __thread mcp_connection_t *t_current_connection = NULL;
+static __thread bool t_reply_sent = false;
+static __thread bool t_reply_deferred = false;
+static __thread uint64_t t_capture_stream = 0;
+static __thread mcp_session_t *t_current_session = NULL;   // Referenced by the request's budget
+static __thread char t_new_session_id[MCP_SESSION_TOKEN_MAX_SIZE];
+#else
+static mcp_connection_t *t_current_connection = NULL;
+static bool t_reply_sent = false;
+static bool t_reply_deferred = false;
+static mcp_session_t *t_current_session = NULL;
+static uint64_t t_capture_stream = 0;
+static char t_new_session_id[MCP_SESSION_TOKEN_MAX_SIZE];
+#endif
+
 // HAL helper functions are now in hal_common.h/c
 
+// Method added by the application; the protocol's table points at this wrapper
+typedef struct embed_mcp_custom_method {
+    embed_mcp_method_handler_t handler;
+    void *user_data;
+    struct embed_mcp_custom_method *next;
+} embed_mcp_custom_method_t;
+
+// Admission control for HTTP requests on the worker pool (see embed_mcp_config_t)
+typedef struct {
+    size_t queue_depth;             // Waiting requests per priority class
+    uint32_t queue_wait_ms;         // 0 = no queueing latency limit
+    size_t session_max_in_flight;   // 0 = unlimited
+} embed_mcp_admission_t;
+
 // Server structure
 struct embed_mcp_server {
     char *name;
@@ -35,21 +97,114 @@ struct embed_mcp_server {
     int enable_sessions;
     int auto_cleanup;
 
+    // Request execution
+    int worker_threads;
+    mcp_worker_pool_t *worker_pool;
+    embed_mcp_admission_t admission;    // The router's while routed
+    uint64_t requests_shed_session;     // Atomic, refused by session_max_in_flight
+    int event_loops;
+
+    // HTTP response compression
+    int compression_threshold;
+    int compression_level;
+
+    // UART transport
+    mcp_transport_config_t uart;
+
     mcp_protocol_t *protocol;
     mcp_transport_t *transport;
     mcp_tool_registry_t *tool_registry;
+    mcp_tool_executor_t *tool_executor;
     mcp_resource_registry_t *resource_registry;
     mcp_session_manager_t *session_manager;
-    mcp_connection_t *current_connection;  // For backward compatibility
+    mcp_session_token_key_t *session_tokens;    // Stateless sessions, used instead of session_manager
+    mcp_list_notifier_t *list_notifier;         // list_changed and resources/updated notifications
+    mcp_resource_watcher_t *resource_watcher;   // Subscribed resources
+    embed_mcp_custom_method_t *custom_methods;
+    struct embed_mcp_tool_table *tool_tables;   // From embed_mcp_add_tool_table()
+    embed_mcp_router_t *router;     // Set while the server is routed by a router
+    mcp_capture_t *capture;         // Traffic capture, NULL when disabled
+
+    int running;
+};
+
+// Several servers behind one HTTP listener; the servers borrow its session manager (or
+// token key) and, while it runs, its worker pool
+struct embed_mcp_router {
+    char *host;
+    int port;
+    int debug;
+
+    int max_connections;
+    int worker_threads;
+    int event_loops;
+    int compression_threshold;
+    int compression_level;
+    embed_mcp_admission_t admission;
+
+    mcp_transport_t *transport;
+    mcp_worker_pool_t *worker_pool;
+    mcp_session_manager_t *session_manager;
+    mcp_session_token_key_t *session_tokens;
+    embed_mcp_server_t **servers;
+    size_t server_count;
+    size_t server_capacity;
 
     int running;
 };
 
+// Universal function wrapper data
+typedef struct {
+    mcp_universal_func_t wrapper_func;
+    const char** param_names;
+    mcp_param_type_t* param_types;
+    uint32_t* param_hashes;             // Hashes of param_names, for slot binding
+    size_t param_count;
+    mcp_return_type_t return_type;
+    void* user_data;
+    const char* const* bound_names;     // Wrapper name table known to match param_names
+    int bound_order;                    // Schema properties follow param_names: 1 yes, -1 no, 0 unknown
+} universal_func_data_t;
+
+// Tools registered by embed_mcp_add_tool_table(), with their wrapper data and name
+// hashes in the same allocation
+typedef struct embed_mcp_tool_table {
+    struct embed_mcp_tool_table *next;
+    size_t count;
+    mcp_tool_t *tools;
+    universal_func_data_t *funcs;
+} embed_mcp_tool_table_t;
+
+// Slots kept on the stack for wrappers with up to this many parameters
+#define PARAM_INLINE_SLOTS 16
+
 // Parameter accessor implementation
 typedef struct {
     const cJSON* args;  // JSON arguments from MCP call
+    universal_func_data_t* func;
+
+    // Filled by param_bind(); items keeps the bound JSON values for array views
+    mcp_param_value_t* slots;
+    const cJSON** items;
+    size_t slot_count;
+    mcp_param_value_t inline_slots[PARAM_INLINE_SLOTS];
+    const cJSON* inline_items[PARAM_INLINE_SLOTS];
+
+    // Written by the wrapper through result_slot()
+    mcp_param_value_t result;
+    int result_borrowed;
 } param_accessor_data_t;
 
+// FNV-1a hash of a parameter name
+static uint32_t param_name_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
 // Parameter accessor function implementations
 static int64_t param_get_int(mcp_param_accessor_t* self, const char* name) {
     param_accessor_data_t* data = (param_accessor_data_t*)self->data;
@@ -108,8 +263,8 @@ static double* param_get_double_array(mcp_param_accessor_t* self, const char* na
     }
 
     *count = array_size;
-    for (int i = 0; i < array_size; i++) {
-        const cJSON* element = cJSON_GetArrayItem(item, i);
+    const cJSON* element = item->child;
+    for (int i = 0; i < array_size; i++, element = element->next) {
         if (cJSON_IsNumber(element)) {
             result[i] = cJSON_GetNumberValue(element);
         } else {
@@ -141,8 +296,8 @@ static char** param_get_string_array(mcp_param_accessor_t* self, const char* nam
     }
 
     *count = array_size;
-    for (int i = 0; i < array_size; i++) {
-        const cJSON* element = cJSON_GetArrayItem(item, i);
+    const cJSON* element = item->child;
+    for (int i = 0; i < array_size; i++, element = element->next) {
         if (cJSON_IsString(element)) {
             result[i] = strdup(cJSON_GetStringValue(element));
         } else {
@@ -174,8 +329,8 @@ static int64_t* param_get_int_array(mcp_param_accessor_t* self, const char* name
     }
 
     *count = array_size;
-    for (int i = 0; i < array_size; i++) {
-        const cJSON* element = cJSON_GetArrayItem(item, i);
+    const cJSON* element = item->child;
+    for (int i = 0; i < array_size; i++, element = element->next) {
         if (cJSON_IsNumber(element)) {
             result[i] = (int64_t)cJSON_GetNumberValue(element);
         } else {
@@ -204,10 +359,264 @@ static const cJSON* param_get_json(mcp_param_accessor_t* self, const char* name)
     return cJSON_GetObjectItem(data->args, name);
 }
 
+// Slot binding
+static void param_store_slot(mcp_param_value_t* slot, const cJSON* item) {
+    if (cJSON_IsNumber(item)) {
+        slot->type = MCP_PARAM_DOUBLE;
+        slot->double_val = item->valuedouble;
+    } else if (cJSON_IsString(item)) {
+        slot->type = MCP_PARAM_STRING;
+        slot->string_val = item->valuestring;
+    } else if (cJSON_IsBool(item)) {
+        slot->type = MCP_PARAM_BOOL;
+        slot->bool_val = cJSON_IsTrue(item) ? 1 : 0;
+    }
+    // Other values leave the zeroed slot in place, which reads as the defaults
+}
+
+// One pass over the argument object; each key is hashed once and compared against
+// the parameter hashes, so binding N parameters costs O(arguments + N) string compares
+static void param_bind_pass(param_accessor_data_t* data, const char* const* names,
+                            const uint32_t* hashes, size_t count) {
+    if (!cJSON_IsObject(data->args)) return;
+
+    for (const cJSON* item = data->args->child; item; item = item->next) {
+        if (!item->string) continue;
+
+        uint32_t hash = param_name_hash(item->string);
+        for (size_t i = 0; i < count; i++) {
+            if (hashes[i] == hash && strcmp(names[i], item->string) == 0) {
+                param_store_slot(&data->slots[i], item);
+                data->items[i] = item;
+                break;
+            }
+        }
+    }
+}
+
+// Whether the members the schema check bound line up with param_names. A schema built
+// by embed_mcp_add_tool() does by construction; the schema text of a table tool is
+// checked against the names until one call has bound every parameter.
+static bool param_bound_in_order(universal_func_data_t* func, const cJSON* const* bound, size_t count) {
+    int order = __atomic_load_n(&func->bound_order, __ATOMIC_RELAXED);
+    if (order != 0) return order > 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!bound[i]) return false;
+        if (strcmp(bound[i]->string, func->param_names[i]) != 0) {
+            __atomic_store_n(&func->bound_order, -1, __ATOMIC_RELAXED);
+            return false;
+        }
+    }
+    __atomic_store_n(&func->bound_order, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static const mcp_param_value_t* param_bind(mcp_param_accessor_t* self, const char* const* names, size_t count) {
+    param_accessor_data_t* data = (param_accessor_data_t*)self->data;
+    universal_func_data_t* func = data->func;
+
+    data->slots = data->inline_slots;
+    data->items = data->inline_items;
+    if (count > PARAM_INLINE_SLOTS) {
+        // Slots and items share one allocation
+        data->slots = malloc(count * (sizeof(mcp_param_value_t) + sizeof(const cJSON*)));
+        if (!data->slots) {
+            data->slot_count = 0;
+            return NULL;
+        }
+        data->items = (const cJSON**)(data->slots + count);
+    }
+    memset(data->slots, 0, count * sizeof(mcp_param_value_t));
+    memset(data->items, 0, count * sizeof(const cJSON*));
+    data->slot_count = count;
+
+    // A wrapper declaring the registered parameters in order reuses the precomputed
+    // hashes; the check runs once per name table and is then cached
+    bool registered_order = func && func->param_hashes && __atomic_load_n(&func->bound_names, __ATOMIC_ACQUIRE) == names;
+    if (func && func->param_hashes && !registered_order && count == func->param_count) {
+        registered_order = true;
+        for (size_t i = 0; i < count && registered_order; i++) {
+            registered_order = strcmp(names[i], func->param_names[i]) == 0;
+        }
+        if (registered_order) {
+            __atomic_store_n(&func->bound_names, names, __ATOMIC_RELEASE);
+        }
+    }
+
+    // The schema check of a registered tool has already matched the arguments to its
+    // properties, which are the registered parameters in order
+    size_t bound_count = 0;
+    const cJSON* const* bound = registered_order ? mcp_tool_get_bound_arguments(data->args, &bound_count) : NULL;
+
+    if (bound && bound_count == count && param_bound_in_order(func, bound, count)) {
+        for (size_t i = 0; i < count; i++) {
+            if (bound[i]) {
+                param_store_slot(&data->slots[i], bound[i]);
+                data->items[i] = bound[i];
+            }
+        }
+    } else if (registered_order) {
+        param_bind_pass(data, names, func->param_hashes, count);
+    } else {
+        uint32_t inline_hashes[PARAM_INLINE_SLOTS];
+        uint32_t* hashes = count > PARAM_INLINE_SLOTS ? malloc(count * sizeof(uint32_t)) : inline_hashes;
+        if (hashes) {
+            for (size_t i = 0; i < count; i++) {
+                hashes[i] = param_name_hash(names[i]);
+            }
+            param_bind_pass(data, names, hashes, count);
+            if (hashes != inline_hashes) free(hashes);
+        }
+    }
+
+    return data->slots;
+}
+
+static const mcp_param_value_t* param_slot(mcp_param_accessor_t* self, size_t slot) {
+    param_accessor_data_t* data = (param_accessor_data_t*)self->data;
+    return slot < data->slot_count ? &data->slots[slot] : NULL;
+}
+
+static int64_t param_get_int_at(mcp_param_accessor_t* self, size_t slot) {
+    const mcp_param_value_t* value = param_slot(self, slot);
+    return (value && value->type == MCP_PARAM_DOUBLE) ? (int64_t)value->double_val : 0;
+}
+
+static double param_get_double_at(mcp_param_accessor_t* self, size_t slot) {
+    const mcp_param_value_t* value = param_slot(self, slot);
+    return (value && value->type == MCP_PARAM_DOUBLE) ? value->double_val : 0.0;
+}
+
+static const char* param_get_string_at(mcp_param_accessor_t* self, size_t slot) {
+    const mcp_param_value_t* value = param_slot(self, slot);
+    return (value && value->type == MCP_PARAM_STRING && value->string_val) ? value->string_val : "";
+}
+
+static int param_get_bool_at(mcp_param_accessor_t* self, size_t slot) {
+    const mcp_param_value_t* value = param_slot(self, slot);
+    return (value && value->type == MCP_PARAM_BOOL) ? value->bool_val : 0;
+}
+
+// Array views: elements are converted into the thread arena, which is rewound
+// once the wrapper's result has been converted - nothing for the caller to free
+
+// Numeric arrays may also arrive as a base64 string of little-endian float64s
+static double* param_decode_packed(mcp_arena_t* arena, const char* text, size_t* count) {
+    size_t length = strlen(text);
+    size_t decoded = base64_decoded_size(text, length);
+    if (length % 4 != 0 || decoded == 0 || decoded % sizeof(double) != 0) {
+        return NULL;
+    }
+
+    double* values = mcp_arena_alloc(arena, decoded);
+    if (!values || base64_decode(text, length, (unsigned char*)values, decoded) != decoded) {
+        return NULL;
+    }
+
+    *count = decoded / sizeof(double);
+    mcp_convert_f64_from_le(values, *count);
+    return values;
+}
+
+// One walk over the elements; non-numeric elements read as 0, non-string as ""
+static const void* param_view_item(const cJSON* item, mcp_param_type_t element_type, size_t* count) {
+    *count = 0;
+    if (!item) return NULL;
+
+    mcp_arena_t* arena = mcp_arena_thread();
+    if (!arena) return NULL;
+
+    size_t n = 0;
+    double* numbers = NULL;
+
+    if (cJSON_IsString(item) && element_type != MCP_PARAM_STRING) {
+        numbers = param_decode_packed(arena, item->valuestring, &n);
+        if (!numbers) return NULL;
+    } else if (cJSON_IsArray(item)) {
+        int array_size = cJSON_GetArraySize(item);
+        if (array_size <= 0) return NULL;
+        n = (size_t)array_size;
+
+        if (element_type == MCP_PARAM_STRING) {
+            const char** strings = mcp_arena_alloc(arena, n * sizeof(const char*));
+            if (!strings) return NULL;
+            size_t i = 0;
+            for (const cJSON* element = item->child; element; element = element->next) {
+                strings[i++] = cJSON_IsString(element) ? element->valuestring : "";
+            }
+            *count = n;
+            return strings;
+        }
+
+        numbers = mcp_arena_alloc(arena, n * sizeof(double));
+        if (!numbers) return NULL;
+        size_t i = 0;
+        for (const cJSON* element = item->child; element; element = element->next) {
+            if (cJSON_IsNumber(element)) {
+                numbers[i++] = element->valuedouble;
+            } else {
+                numbers[i++] = cJSON_IsTrue(element) ? 1.0 : 0.0;
+            }
+        }
+    } else {
+        return NULL;
+    }
+
+    const void* view = numbers;
+    if (element_type == MCP_PARAM_INT) {
+        int* ints = mcp_arena_alloc(arena, n * sizeof(int));
+        if (!ints) return NULL;
+        mcp_convert_f64_to_int(numbers, ints, n);
+        view = ints;
+    } else if (element_type == MCP_PARAM_BOOL) {
+        bool* flags = mcp_arena_alloc(arena, n * sizeof(bool));
+        if (!flags) return NULL;
+        mcp_convert_f64_to_bool(numbers, flags, n);
+        view = flags;
+    }
+
+    *count = n;
+    return view;
+}
+
+static const void* param_view_array(mcp_param_accessor_t* self, const char* name,
+                                    mcp_param_type_t element_type, size_t* count) {
+    param_accessor_data_t* data = (param_accessor_data_t*)self->data;
+    return param_view_item(cJSON_GetObjectItem(data->args, name), element_type, count);
+}
+
+static const void* param_view_array_at(mcp_param_accessor_t* self, size_t slot,
+                                       mcp_param_type_t element_type, size_t* count) {
+    param_accessor_data_t* data = (param_accessor_data_t*)self->data;
+    return param_view_item(slot < data->slot_count ? data->items[slot] : NULL, element_type, count);
+}
+
+static mcp_param_value_t* param_result_slot(mcp_param_accessor_t* self, int borrowed) {
+    param_accessor_data_t* data = (param_accessor_data_t*)self->data;
+    data->result_borrowed = borrowed;
+    return &data->result;
+}
+
+// Wake the main loop wherever it is blocked (async-signal-safe)
+static void wakeup_main_loop(void) {
+    if (g_wakeup_pipe[1] >= 0) {
+        char byte = 1;
+        ssize_t written = write(g_wakeup_pipe[1], &byte, 1);
+        (void)written;  // A full pipe already has a wakeup pending
+    }
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    if (hal && hal->network.network_wakeup) {
+        hal->network.network_wakeup();
+    }
+}
+
 // Signal handler for graceful shutdown
 static void signal_handler(int sig) {
     (void)sig;
     g_running = 0;
+    wakeup_main_loop();
 }
 
 // Set error message
@@ -219,12 +628,16 @@ static void set_error(const char *message) {
 // Protocol send callback
 static int protocol_send_callback(const char *data, size_t length, void *user_data) {
     embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
-    
-    if (!server || !server->current_connection) {
+
+    if (!t_current_connection) {
         return -1;
     }
-    
-    return mcp_connection_send(server->current_connection, data, length);
+
+    if (server->capture) {
+        mcp_capture_record(server->capture, t_capture_stream, MCP_CAPTURE_OUTBOUND, data, length);
+    }
+    t_reply_sent = true;
+    return mcp_connection_send(t_current_connection, data, length);
 }
 
 // Update dynamic capabilities based on registered features
@@ -247,195 +660,1043 @@ static void update_dynamic_capabilities(embed_mcp_server_t *server) {
         capabilities->server.resources = (resource_count > 0);
     }
 
+    capabilities->server.resources_subscribe = server->resource_watcher != NULL;
+
     // Prompts capability - not implemented yet
     capabilities->server.prompts = false;
 
     // Logging is always available
     capabilities->server.logging = true;
+
+    // Clients listening for changes hear about them once registrations settle
+    mcp_list_notifier_changed(server->list_notifier, MCP_LIST_TOOLS,
+                              mcp_tool_registry_get_version(server->tool_registry));
+    mcp_list_notifier_changed(server->list_notifier, MCP_LIST_RESOURCES,
+                              mcp_resource_registry_get_version(server->resource_registry));
 }
 
-// Protocol request handler
-static cJSON *protocol_request_handler(const mcp_request_t *request, void *user_data) {
+// Request method handlers, registered in the protocol's method table
+static cJSON *method_tools_list(const mcp_request_t *request, void *user_data) {
     embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    (void)request;
 
-    if (!server || !request || !request->method) {
-        printf("[DEBUG] Invalid request parameters\n");
-        fflush(stdout);
-        return NULL;
+    cJSON *tools = mcp_tool_registry_list_tools_raw(server->tool_registry);
+    if (!tools) return NULL;
+    
+    cJSON *result = cJSON_CreateObject();
+    cJSON_AddItemToObject(result, "tools", tools);
+    return result;
+}
+
+// Where a deferred tools/call reply goes; copied into the executor's call
+typedef struct {
+    mcp_connection_t connection;  // Copy - the transport's object only lives for the callback
+    bool stream;                  // HTTP client accepts an event stream: progress opens one
+    bool streaming;               // The stream is open, the result will be its last event
+    uint64_t capture_stream;      // Capture stream of the request's session
+} tool_reply_ctx_t;
+
+// The executor never overlaps sends for one call, so the stream state needs no lock
+static int tool_call_send(void *reply_ctx, mcp_tool_call_send_kind_t kind,
+                          const char *data, size_t length, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    tool_reply_ctx_t *reply = (tool_reply_ctx_t*)reply_ctx;
+    mcp_connection_t *connection = &reply->connection;
+    bool http = connection->transport && connection->transport->type == MCP_TRANSPORT_HTTP;
+
+    if (server->capture && data) {
+        mcp_capture_record(server->capture, reply->capture_stream, MCP_CAPTURE_OUTBOUND, data, length);
+    }
+
+    switch (kind) {
+        case MCP_TOOL_CALL_SEND_RESULT:
+            if (reply->streaming) {
+                return mcp_http_transport_stream_end(connection, data, length);
+            }
+            return mcp_connection_send(connection, data, length);
+        case MCP_TOOL_CALL_SEND_NOTIFICATION:
+            if (!http) {
+                return mcp_connection_send(connection, data, length);
+            }
+            // A plain HTTP request carries exactly one response, the tool result
+            if (!reply->stream) {
+                return 0;
+            }
+            if (!reply->streaming) {
+                if (mcp_http_transport_stream_begin(connection) < 0) {
+                    reply->stream = false;
+                    return -1;
+                }
+                reply->streaming = true;
+            }
+            return mcp_http_transport_stream_event(connection, data, length);
+        case MCP_TOOL_CALL_SEND_CANCELLED:
+            // No response for a cancelled request, but the HTTP exchange still has to end
+            if (reply->streaming) {
+                return mcp_http_transport_stream_end(connection, NULL, 0);
+            }
+            return http ? mcp_http_transport_send_accepted(connection) : 0;
     }
+    return -1;
+}
+
+static void tool_call_completed(const mcp_tool_t *tool, const cJSON *result,
+                                double execution_time, void *context, void *user_data) {
+    (void)tool;
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    mcp_tool_registry_record_entry_call(server->tool_registry, (mcp_tool_entry_t*)context,
+                                        result, execution_time);
+}
 
-    printf("[DEBUG] Handling request: %s\n", request->method);
-    fflush(stdout);
+// The call holds its bulkhead slot until the executor frees it, which for an async
+// tool is when the tool has really finished, not when a deadline answered for it
+static void tool_call_release_entry(void *context) {
+    mcp_tool_registry_finish_call((mcp_tool_entry_t*)context);
+    mcp_tool_registry_release_entry((mcp_tool_entry_t*)context);
+}
+
+static cJSON *method_tools_call(const mcp_request_t *request, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    if (!request->params) return NULL;
+    
+    cJSON *name = cJSON_GetObjectItem(request->params, "name");
+    cJSON *arguments = cJSON_GetObjectItem(request->params, "arguments");
     
-    // Handle tools/list
-    if (strcmp(request->method, "tools/list") == 0) {
-        cJSON *tools = mcp_tool_registry_list_tools(server->tool_registry);
-        if (!tools) return NULL;
-        
-        cJSON *result = cJSON_CreateObject();
-        cJSON_AddItemToObject(result, "tools", tools);
+    if (!name || !cJSON_IsString(name)) return NULL;
+    
+    cJSON *meta = cJSON_GetObjectItem(request->params, "_meta");
+    cJSON *progress_token = meta ? cJSON_GetObjectItem(meta, "progressToken") : NULL;
+    
+    // Tools without a deadline, progress or async handler run straight from the registry
+    // on the entry pinned here; otherwise the pin rides along with the executor call so
+    // its statistics are recorded without another lookup
+    uint64_t span = mcp_trace_begin();
+    mcp_tool_entry_t *entry = mcp_tool_registry_acquire_entry(server->tool_registry, name->valuestring);
+    mcp_trace_end(MCP_TRACE_DISPATCH, span, name->valuestring);
+    mcp_tool_t *tool = entry ? entry->tool : NULL;
+    if (!tool) {
+        return mcp_tool_registry_create_tool_not_found_error(name->valuestring);
+    }
+    if (!server->tool_executor ||
+        (!tool->execute_async && tool->max_execution_time_ms == 0 && !progress_token)) {
+        cJSON *result = mcp_tool_registry_call_entry(server->tool_registry, entry, arguments);
+        mcp_tool_registry_release_entry(entry);
         return result;
     }
     
-    // Handle tools/call
-    if (strcmp(request->method, "tools/call") == 0) {
-        if (!request->params) return NULL;
-        
-        cJSON *name = cJSON_GetObjectItem(request->params, "name");
-        cJSON *arguments = cJSON_GetObjectItem(request->params, "arguments");
-        
-        if (!name || !cJSON_IsString(name)) return NULL;
-        
-        return mcp_tool_registry_call_tool(server->tool_registry, name->valuestring, arguments);
-    }
-
-    // Handle resources/list
-    if (strcmp(request->method, "resources/list") == 0) {
-        printf("[DEBUG] Handling resources/list request\n");
-        fflush(stdout);
-
-        cJSON *resources = mcp_resource_registry_list_resources(server->resource_registry);
-        if (!resources) {
-            printf("[DEBUG] mcp_resource_registry_list_resources returned NULL\n");
-            fflush(stdout);
-            return NULL;
-        }
-
-        printf("[DEBUG] Creating result object for resources/list\n");
-        fflush(stdout);
+    // Cacheable tools answer from the result cache without going near the executor
+    mcp_tool_cache_key_t cache_key;
+    cJSON *cached = mcp_tool_registry_cache_lookup(server->tool_registry, entry, arguments, &cache_key);
+    if (cached) {
+        mcp_tool_cache_key_free(&cache_key);
+        mcp_tool_registry_release_entry(entry);
+        return cached;
+    }
+    if (mcp_tool_registry_admit_call(entry) != 0) {
+        mcp_tool_cache_key_free(&cache_key);
+        mcp_tool_registry_release_entry(entry);
+        return mcp_tool_registry_create_busy_error(name->valuestring);
+    }
+    
+    tool_reply_ctx_t reply = { .connection = { 0 }, .capture_stream = t_capture_stream };
+    if (t_current_connection) {
+        reply.connection = *t_current_connection;
+        reply.connection.connection_id = NULL;
+        reply.connection.session_id = NULL;
+    }
+    
+    // Over HTTP, progress for a client that accepts text/event-stream is streamed ahead
+    // of the result, so the result has to take the same path even for sync tools
+    bool can_defer = t_current_connection && mcp_protocol_can_defer_response();
+    reply.stream = can_defer && progress_token &&
+                   (reply.connection.flags & MCP_CONNECTION_FLAG_EVENT_STREAM) != 0;
+    
+    mcp_tool_call_request_t call = {
+        .id = request->id,
+        .progress_token = progress_token,
+        .can_defer = can_defer,
+        .send_result = reply.stream,
+        .reply_ctx = &reply,
+        .reply_ctx_size = sizeof(reply),
+        .context = entry,
+        .release_context = tool_call_release_entry
+    };
+    
+    cJSON *result = NULL;
+    int status = mcp_tool_executor_call(server->tool_executor, tool, arguments, &call, &result);
+    
+    if (status == 0) {
+        t_reply_deferred = true;
+        mcp_protocol_defer_response();
+    } else if (status < 0) {
+        mcp_protocol_set_request_error(JSONRPC_INTERNAL_ERROR, "Tool call did not complete");
+    } else {
+        // Only results handed back here are cached, not deferred or streamed ones
+        result = mcp_tool_registry_cache_store(server->tool_registry, &cache_key, result);
+    }
+    mcp_tool_cache_key_free(&cache_key);
+    return result;
+}
 
-        cJSON *result = cJSON_CreateObject();
-        cJSON_AddItemToObject(result, "resources", resources);
-        return result;
+static cJSON *notification_cancelled(const mcp_request_t *notification, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    cJSON *request_id = notification->params ? cJSON_GetObjectItem(notification->params, "requestId") : NULL;
+    
+    if (request_id && mcp_tool_executor_cancel(server->tool_executor, request_id) != 0) {
+        mcp_log_debug("Cancellation for a request that is not in flight");
     }
+    return NULL;
+}
 
-    // Handle resources/read
-    if (strcmp(request->method, "resources/read") == 0) {
-        if (!request->params) return NULL;
+// STDIO and UART clients hear about list changes once initialized; HTTP clients open
+// a GET stream for them (open_event_stream)
+static cJSON *notification_initialized(const mcp_request_t *notification, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    (void)notification;
 
-        cJSON *uri_json = cJSON_GetObjectItem(request->params, "uri");
-        if (!uri_json || !cJSON_IsString(uri_json)) return NULL;
+    mcp_connection_t *connection = t_current_connection;
+    if (connection && connection->transport && connection->transport->type != MCP_TRANSPORT_HTTP) {
+        mcp_list_notifier_subscribe(server->list_notifier, connection, false, NULL);
+    }
+    return NULL;
+}
 
-        const char *uri = uri_json->valuestring;
-        mcp_resource_content_t content;
+static cJSON *method_resources_list(const mcp_request_t *request, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
 
-        // Try static resources first
-        int read_result = mcp_resource_registry_read_resource(server->resource_registry, uri, &content);
+    cJSON *cursor = request->params ? cJSON_GetObjectItem(request->params, "cursor") : NULL;
+    if (cursor && !cJSON_IsString(cursor) && !cJSON_IsNull(cursor)) {
+        mcp_protocol_set_request_error(JSONRPC_INVALID_PARAMS, "cursor must be a string");
+        return NULL;
+    }
 
-        // If static resource not found, try resource templates
-        if (read_result != 0) {
-            read_result = mcp_resource_registry_read_template(server->resource_registry, uri, &content);
+    cJSON *result = NULL;
+    if (mcp_resource_registry_list_page(server->resource_registry,
+                                        cJSON_IsString(cursor) ? cursor->valuestring : NULL,
+                                        &result) != 0) {
+        if (cJSON_IsString(cursor)) {
+            mcp_protocol_set_request_error(JSONRPC_INVALID_PARAMS, "Invalid cursor");
         }
+        return NULL;
+    }
 
-        if (read_result != 0) {
-            return NULL;
-        }
+    return result;
+}
 
-        // Create response
-        cJSON *result = cJSON_CreateObject();
-        cJSON *contents_array = cJSON_CreateArray();
-        cJSON *content_obj = cJSON_CreateObject();
+static cJSON *method_resources_read(const mcp_request_t *request, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    if (!request->params) return NULL;
 
-        cJSON_AddStringToObject(content_obj, "uri", uri);
-        cJSON_AddStringToObject(content_obj, "mimeType", content.mime_type);
+    cJSON *uri_json = cJSON_GetObjectItem(request->params, "uri");
+    if (!uri_json || !cJSON_IsString(uri_json)) return NULL;
 
-        if (content.is_binary) {
-            // For binary data, we need to base64 encode it
-            // For now, just return an error for binary resources
-            cJSON_AddStringToObject(content_obj, "text", "[Binary content not supported yet]");
-        } else {
-            cJSON_AddStringToObject(content_obj, "text", (const char*)content.data);
-        }
+    cJSON *content_obj = mcp_resource_registry_read_contents(server->resource_registry,
+                                                             uri_json->valuestring);
+    if (!content_obj) {
+        return NULL;
+    }
+
+    cJSON *result = cJSON_CreateObject();
+    cJSON *contents_array = cJSON_CreateArray();
+    cJSON_AddItemToArray(contents_array, content_obj);
+    cJSON_AddItemToObject(result, "contents", contents_array);
+
+    return result;
+}
 
-        cJSON_AddItemToArray(contents_array, content_obj);
-        cJSON_AddItemToObject(result, "contents", contents_array);
+// File the watcher can watch for uri: a file resource's path, or the file a template
+// served by mcp_file_resource_handler reads. NULL when changes have to be reported.
+// Call inside an epoch; the path is valid until it is left.
+static const char *resource_file_path(embed_mcp_server_t *server, const char *uri) {
+    mcp_resource_desc_t *resource = mcp_resource_registry_find(server->resource_registry, uri);
+    if (resource) {
+        return resource->type == MCP_RESOURCE_FILE ? resource->data.file.path : NULL;
+    }
+    mcp_resource_template_t *template = mcp_resource_registry_find_template(server->resource_registry, uri);
+    if (template && template->handler == mcp_file_resource_handler) {
+        return mcp_file_resource_path(uri);
+    }
+    return NULL;
+}
 
-        // Cleanup
-        mcp_resource_content_cleanup(&content);
+static void watch_resource(const char *uri, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
 
-        return result;
+    // The path belongs to the resource, which may be removed concurrently
+    mcp_epoch_enter();
+    int result = mcp_resource_watcher_watch(server->resource_watcher, uri, resource_file_path(server, uri));
+    mcp_epoch_exit();
+    if (result != 0) {
+        mcp_log_warn("Cannot watch %s, its subscribers will not be told about changes", uri);
+    }
+}
+
+// resources/subscribe and resources/unsubscribe. An HTTP client's subscriptions belong
+// to its session and are delivered on the session's event streams; a STDIO or UART
+// client's belong to its connection.
+static cJSON *resource_subscription(embed_mcp_server_t *server, const mcp_request_t *request, bool subscribe) {
+    cJSON *uri = request->params ? cJSON_GetObjectItem(request->params, "uri") : NULL;
+    if (!cJSON_IsString(uri)) {
+        mcp_protocol_set_request_error(JSONRPC_INVALID_PARAMS, "uri must be a string");
+        return NULL;
+    }
+    if (subscribe && !mcp_resource_registry_find(server->resource_registry, uri->valuestring) &&
+        !mcp_resource_registry_find_template(server->resource_registry, uri->valuestring)) {
+        mcp_protocol_set_request_error(JSONRPC_INVALID_PARAMS, "Resource not found");
+        return NULL;
     }
 
-    // Handle resources/templates/list
-    if (strcmp(request->method, "resources/templates/list") == 0) {
-        printf("[DEBUG] Handling resources/templates/list request\n");
-        fflush(stdout);
+    mcp_connection_t *connection = t_current_connection;
+    if (!connection || !connection->transport) {
+        mcp_protocol_set_request_error(JSONRPC_INVALID_REQUEST, "No connection to send updates on");
+        return NULL;
+    }
 
-        cJSON *templates = mcp_resource_registry_list_templates(server->resource_registry);
-        if (!templates) {
-            printf("[DEBUG] mcp_resource_registry_list_templates returned NULL\n");
-            fflush(stdout);
+    int result;
+    if (connection->transport->type == MCP_TRANSPORT_HTTP) {
+        // Workers get a copy of the connection without the session ID, but the session
+        // itself rides along with the request
+        if (!t_current_session || server->router) {
+            mcp_protocol_set_request_error(JSONRPC_INVALID_REQUEST,
+                                           "resources/subscribe needs a session with an event stream");
             return NULL;
         }
+        mcp_subscription_set_t *set = mcp_session_get_subscriptions(t_current_session, subscribe);
+        result = subscribe ? mcp_subscription_set_add(set, uri->valuestring)
+                           : mcp_subscription_set_remove(set, uri->valuestring);
+    } else {
+        result = mcp_list_notifier_subscribe_resource(server->list_notifier, connection,
+                                                      uri->valuestring, subscribe);
+    }
+    if (result < 0) {
+        mcp_protocol_set_request_error(JSONRPC_INVALID_REQUEST,
+                                       subscribe ? "Cannot subscribe: too many subscriptions or not initialized"
+                                                 : "Not initialized");
+        return NULL;
+    }
 
-        printf("[DEBUG] Creating result object for resources/templates/list\n");
-        fflush(stdout);
-
-        cJSON *result = cJSON_CreateObject();
-        cJSON_AddItemToObject(result, "resourceTemplates", templates);
-        return result;
+    if (subscribe) {
+        watch_resource(uri->valuestring, server);
     }
+    return cJSON_CreateObject();
+}
 
-    return NULL;
+static cJSON *method_resources_subscribe(const mcp_request_t *request, void *user_data) {
+    return resource_subscription((embed_mcp_server_t*)user_data, request, true);
 }
 
-// Transport callbacks
-static void on_message_received(const char *message, size_t length,
-                               mcp_connection_t *connection, void *user_data) {
-    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
-    
-    if (server->debug) {
-        mcp_log_debug("Received message (%zu bytes): %.*s", length, (int)length, message);
-    }
-    
-    server->current_connection = connection;
-    int result = mcp_protocol_handle_message(server->protocol, message);
-    // Keep connection available until after message handling is complete
-    // Don't set to NULL immediately as response sending might be synchronous
-    if (result < 0) {
-        mcp_log_error("Protocol message handling failed: %d", result);
-    } else if (result > 0) {
-        mcp_log_debug("Protocol message handled successfully, sent %d bytes", result);
-    }
-    server->current_connection = NULL;
+static cJSON *method_resources_unsubscribe(const mcp_request_t *request, void *user_data) {
+    return resource_subscription((embed_mcp_server_t*)user_data, request, false);
 }
 
-static void on_connection_opened(mcp_connection_t *connection, void *user_data) {
+// Resource watcher callbacks, on its thread
+static void resource_updated(const char *uri, const mcp_resource_append_t *appended, void *user_data) {
     embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
-    
+
+    mcp_json_buffer_t *buffer = mcp_json_thread_buffer();
+    if (!buffer) return;
+    int status = mcp_json_write_literal(buffer, "{\"jsonrpc\":\"2.0\",\"method\":\""
+                                                MCP_METHOD_RESOURCE_UPDATED "\",\"params\":{\"uri\":") |
+                 mcp_json_write_string(buffer, uri);
+    if (appended) {
+        // The file only grew: the client may read just the new bytes
+        status |= mcp_json_write_literal(buffer, ",\"_meta\":{\"appendedRange\":{\"offset\":") |
+                  mcp_json_write_int(buffer, (long long)appended->offset) |
+                  mcp_json_write_literal(buffer, ",\"length\":") |
+                  mcp_json_write_int(buffer, (long long)appended->length) |
+                  mcp_json_write_literal(buffer, "}}");
+    }
+    status |= mcp_json_write_literal(buffer, "}}");
+    if (status != 0) return;
+
+    size_t sent = mcp_list_notifier_resource_updated(server->list_notifier, uri, buffer->data, buffer->length);
     if (server->debug) {
-        mcp_log_info("Connection opened: %s", mcp_connection_get_id(connection));
+        mcp_log_debug("Resource %s changed, %zu subscriber(s) notified", uri, sent);
     }
 }
 
-static void on_connection_closed(mcp_connection_t *connection, void *user_data) {
+static bool resource_wanted(const char *uri, void *user_data) {
     embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
-    
-    if (server->debug) {
-        mcp_log_info("Connection closed: %s", mcp_connection_get_id(connection));
-    }
+    return mcp_list_notifier_wants_resource(server->list_notifier, uri);
 }
 
-static void on_transport_error(mcp_transport_t *transport, int error_code,
-                              const char *error_message, void *user_data) {
-    (void)transport;
-    (void)user_data;
-    mcp_log_error("Transport error %d: %s", error_code, error_message);
+// From mcp_resource_registry_notify_changed()
+static void resource_changed(const char *uri, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    mcp_resource_watcher_changed(server->resource_watcher, uri);
 }
 
-// =============================================================================
-// API Implementation
-// =============================================================================
+static cJSON *method_resources_templates_list(const mcp_request_t *request, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    (void)request;
 
-embed_mcp_server_t *embed_mcp_create(const embed_mcp_config_t *config) {
-    if (!config || !config->name || !config->version) {
-        set_error("Invalid configuration");
+    cJSON *templates = mcp_resource_registry_list_templates(server->resource_registry);
+    if (!templates) {
+        mcp_log_debug("mcp_resource_registry_list_templates returned NULL");
         return NULL;
     }
 
-    // Initialize platform HAL
-    if (mcp_platform_init() != 0) {
-        set_error("Platform initialization failed");
+    cJSON *result = cJSON_CreateObject();
+    cJSON_AddItemToObject(result, "resourceTemplates", templates);
+    return result;
+}
+
+// Stateful sessions: a new session in the table (and its store), its ID goes out as
+// the Mcp-Session-Id
+static void initialize_session(embed_mcp_server_t *server, const mcp_request_t *request,
+                               const cJSON *result, mcp_connection_t *connection) {
+    mcp_session_t *session = mcp_session_manager_create_session(server->session_manager, NULL);
+    if (!session) {
+        mcp_log_warn("No session for the new client, serving it without one");
+        return;
+    }
+
+    cJSON *version = cJSON_GetObjectItem(result, "protocolVersion");
+    mcp_session_initialize(session, cJSON_IsString(version) ? version->valuestring : NULL,
+                           cJSON_GetObjectItem(request->params, "capabilities"),
+                           cJSON_GetObjectItem(request->params, "clientInfo"));
+    memcpy(t_new_session_id, session->session_id, MCP_SESSION_ID_SIZE);
+    connection->session_id = t_new_session_id;
+    connection->flags |= MCP_CONNECTION_FLAG_NEW_SESSION;
+}
+
+// Offer CBOR to a client listing it in capabilities.experimental.encodings, on a
+// transport configured to carry it. Either side may then send each message in either
+// encoding; replies follow the encoding of the request.
+static void negotiate_encoding(const mcp_request_t *request, cJSON *result,
+                               const mcp_connection_t *connection) {
+    const mcp_transport_config_t *config = connection->transport->config;
+    if (!config || config->encoding != MCP_TRANSPORT_ENCODING_CBOR) return;
+
+    cJSON *client = cJSON_GetObjectItem(request->params, "capabilities");
+    cJSON *experimental = cJSON_IsObject(client) ? cJSON_GetObjectItem(client, "experimental") : NULL;
+    cJSON *encodings = cJSON_IsObject(experimental) ? cJSON_GetObjectItem(experimental, "encodings") : NULL;
+    if (!cJSON_IsArray(encodings)) return;
+
+    bool offered = false;
+    cJSON *encoding = NULL;
+    cJSON_ArrayForEach(encoding, encodings) {
+        if (cJSON_IsString(encoding) && strcmp(encoding->valuestring, "cbor") == 0) offered = true;
+    }
+    if (!offered) return;
+
+    cJSON *capabilities = cJSON_GetObjectItem(result, "capabilities");
+    if (!cJSON_IsObject(capabilities)) return;
+    cJSON *server_experimental = cJSON_GetObjectItem(capabilities, "experimental");
+    if (!cJSON_IsObject(server_experimental)) {
+        cJSON_DeleteItemFromObject(capabilities, "experimental");
+        server_experimental = cJSON_AddObjectToObject(capabilities, "experimental");
+    }
+    if (server_experimental) {
+        cJSON_AddStringToObject(server_experimental, "encoding", "cbor");
+    }
+}
+
+// HTTP clients can only subscribe with a session of their own, and only when the
+// server offers event streams
+static void limit_resource_subscriptions(embed_mcp_server_t *server, cJSON *result,
+                                         const mcp_connection_t *connection) {
+    if (connection->transport->type != MCP_TRANSPORT_HTTP ||
+        (server->session_manager && !server->router)) {
+        return;
+    }
+
+    cJSON *capabilities = cJSON_GetObjectItem(result, "capabilities");
+    cJSON *resources = cJSON_IsObject(capabilities) ? cJSON_GetObjectItem(capabilities, "resources") : NULL;
+    if (cJSON_IsObject(resources) && cJSON_GetObjectItem(resources, "subscribe")) {
+        cJSON_ReplaceItemInObject(resources, "subscribe", cJSON_CreateFalse());
+    }
+}
+
+// The initialize reply over HTTP carries the new session's Mcp-Session-Id: a table
+// entry's ID, or with stateless sessions a signed token (handle_message restores the
+// connection afterwards)
+static cJSON *method_initialize(const mcp_request_t *request, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+
+    cJSON *result = mcp_protocol_handle_initialize(server->protocol, request);
+    mcp_connection_t *connection = t_current_connection;
+    if (result && connection && connection->transport) {
+        negotiate_encoding(request, result, connection);
+        limit_resource_subscriptions(server, result, connection);
+    }
+    if (!result || !connection || !connection->transport ||
+        connection->transport->type != MCP_TRANSPORT_HTTP) {
+        return result;
+    }
+    if (server->session_manager) {
+        initialize_session(server, request, result, connection);
+        return result;
+    }
+    if (!server->session_tokens) {
+        return result;
+    }
+
+    unsigned int capabilities = 0;
+    cJSON *client = cJSON_GetObjectItem(request->params, "capabilities");
+    if (cJSON_IsObject(client)) {
+        if (cJSON_GetObjectItem(client, "roots")) capabilities |= MCP_SESSION_TOKEN_CAP_ROOTS;
+        if (cJSON_GetObjectItem(client, "sampling")) capabilities |= MCP_SESSION_TOKEN_CAP_SAMPLING;
+    }
+
+    cJSON *version = cJSON_GetObjectItem(result, "protocolVersion");
+    if (cJSON_IsString(version) &&
+        mcp_session_token_issue(server->session_tokens, version->valuestring, capabilities,
+                                time(NULL), t_new_session_id) > 0) {
+        connection->session_id = t_new_session_id;
+        connection->flags |= MCP_CONNECTION_FLAG_NEW_SESSION;
+    }
+    return result;
+}
+
+// Application methods added with embed_mcp_add_method()
+static cJSON *method_custom(const mcp_request_t *request, void *user_data) {
+    embed_mcp_custom_method_t *method = (embed_mcp_custom_method_t*)user_data;
+    return method->handler(request->params, method->user_data);
+}
+
+static int register_builtin_methods(embed_mcp_server_t *server) {
+    static const struct {
+        const char *name;
+        mcp_method_handler_t handler;
+    } methods[] = {
+        { MCP_METHOD_INITIALIZE, method_initialize },
+        { MCP_METHOD_LIST_TOOLS, method_tools_list },
+        { MCP_METHOD_CALL_TOOL, method_tools_call },
+        { MCP_METHOD_LIST_RESOURCES, method_resources_list },
+        { MCP_METHOD_READ_RESOURCE, method_resources_read },
+        { "resources/templates/list", method_resources_templates_list },
+        { MCP_METHOD_SUBSCRIBE_RESOURCE, method_resources_subscribe },
+        { MCP_METHOD_UNSUBSCRIBE_RESOURCE, method_resources_unsubscribe },
+    };
+
+    for (size_t i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+        if (mcp_protocol_register_method(server->protocol, methods[i].name,
+                                         methods[i].handler, server) != 0) {
+            return -1;
+        }
+    }
+
+    if (mcp_protocol_register_notification(server->protocol, MCP_METHOD_INITIALIZED,
+                                           notification_initialized, server) != 0) {
+        return -1;
+    }
+    return mcp_protocol_register_notification(server->protocol, MCP_METHOD_CANCELLED,
+                                              notification_cancelled, server);
+}
+
+// Handle one message on the calling thread
+static void handle_message(embed_mcp_server_t *server, const char *message, size_t length,
+                           mcp_connection_t *connection, mcp_session_t *session,
+                           uint64_t capture_stream) {
+    char *session_id = connection ? connection->session_id : NULL;
+    unsigned int flags = connection ? connection->flags : 0;
+    t_current_connection = connection;
+    t_current_session = session;
+    t_reply_sent = false;
+    t_reply_deferred = false;
+    t_capture_stream = capture_stream;
+    // Only a transport that negotiated CBOR flags it; everything else is JSON text
+    int result = (flags & MCP_CONNECTION_FLAG_CBOR)
+        ? mcp_protocol_handle_cbor_message(server->protocol, (const uint8_t*)message, length)
+        : mcp_protocol_handle_message_len(server->protocol, message, length);
+    if (result < 0) {
+        mcp_log_error("Protocol message handling failed: %d", result);
+    } else if (result > 0) {
+        mcp_log_debug("Protocol message handled successfully, sent %d bytes", result);
+    }
+
+    // Notifications (or batches of them) produce no reply, but every HTTP request still
+    // needs an answer
+    if (!t_reply_sent && !t_reply_deferred && connection && connection->transport &&
+        connection->transport->type == MCP_TRANSPORT_HTTP) {
+        mcp_http_transport_send_accepted(connection);
+    }
+    if (connection) {
+        connection->session_id = session_id;
+        connection->flags = flags;
+    }
+    t_current_connection = NULL;
+    t_current_session = NULL;
+    t_capture_stream = 0;
+}
+
+// Memory a message holds in the budget (utils/mem_budget.h) until it has been handled,
+// and its place among its session's requests in flight
+typedef struct {
+    mcp_session_t *session;       // Session charged, referenced; NULL if the message has none
+    size_t bytes;
+    bool in_flight;               // Counted in session->requests_in_flight
+} message_budget_t;
+
+static void message_budget_release(message_budget_t *budget) {
+    mcp_mem_budget_release(budget->session ? &budget->session->memory : NULL, budget->bytes);
+    if (budget->in_flight) {
+        __atomic_sub_fetch(&budget->session->requests_in_flight, 1, __ATOMIC_RELEASE);
+    }
+    mcp_session_unref(budget->session);
+    budget->session = NULL;
+    budget->bytes = 0;
+    budget->in_flight = false;
+}
+
+// Takes over the caller's reference to session (may be NULL) and its in-flight count
+static mcp_mem_budget_result_t message_budget_reserve(mcp_session_t *session, bool in_flight,
+                                                      size_t length, message_budget_t *budget) {
+    budget->session = session;
+    budget->bytes = mcp_mem_budget_request_cost(length);
+    budget->in_flight = in_flight;
+
+    mcp_mem_budget_result_t result =
+        mcp_mem_budget_reserve(budget->session ? &budget->session->memory : NULL, budget->bytes);
+    if (result != MCP_MEM_BUDGET_OK) {
+        budget->bytes = 0;
+        message_budget_release(budget);
+    }
+    return result;
+}
+
+// Answer a message refused without parsing it. The error carries the request's id when
+// one can be found; STDIO messages without one may be notifications and get no reply,
+// HTTP requests are always answered - with http_status when it is not 0.
+static void refuse_message(embed_mcp_server_t *server, const char *message, size_t length,
+                           mcp_connection_t *connection, uint64_t capture_stream,
+                           int http_status, int code, const char *reason, bool retryable) {
+    mcp_log_warn("Message of %zu bytes refused: %s", length, reason);
+    if (!connection) return;
+
+    char id_text[64];
+    size_t id_length = 0;
+    const char *id_start = jsonrpc_peek_id(message, length, &id_length);
+    bool http = connection->transport && connection->transport->type == MCP_TRANSPORT_HTTP;
+    if ((!id_start || id_length >= sizeof(id_text)) && !http) return;
+
+    cJSON *id = NULL;
+    if (id_start && id_length < sizeof(id_text)) {
+        memcpy(id_text, id_start, id_length);
+        id_text[id_length] = '\0';
+        id = cJSON_CreateRaw(id_text);
+    }
+
+    cJSON *data = cJSON_CreateObject();
+    cJSON_AddBoolToObject(data, "retryable", retryable);
+
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    if (jsonrpc_write_error(&buffer, id, code, reason, data) == 0) {
+        if (server->capture) {
+            mcp_capture_record(server->capture, capture_stream, MCP_CAPTURE_OUTBOUND,
+                               buffer.data, buffer.length);
+        }
+        if (http_status && http) {
+            mcp_http_transport_send_status(connection, http_status, buffer.data, buffer.length);
+        } else {
+            mcp_connection_send(connection, buffer.data, buffer.length);
+        }
+    }
+    mcp_json_buffer_free(&buffer);
+    cJSON_Delete(data);
+    cJSON_Delete(id);
+}
+
+// Per MCP a request naming an unknown session gets 404, and the client starts over
+// with initialize
+static void reject_unknown_session(mcp_connection_t *connection) {
+    static const char body[] = "{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32001,"
+                               "\"message\":\"Session not found\"}}";
+    mcp_http_transport_send_status(connection, 404, body, sizeof(body) - 1);
+}
+
+// Stateless sessions: a request naming a session must carry a token signed with this
+// server's key. Requests without one are served as before (initialize among them).
+static bool check_session_token(embed_mcp_server_t *server, mcp_connection_t *connection) {
+    mcp_session_token_result_t result =
+        mcp_session_token_verify(server->session_tokens, connection->session_id,
+                                 strlen(connection->session_id), time(NULL), NULL);
+    if (result == MCP_SESSION_TOKEN_OK) return true;
+
+    mcp_log_debug("Request refused: %s", mcp_session_token_result_string(result));
+    reject_unknown_session(connection);
+    return false;
+}
+
+// Request handed off to the worker pool
+typedef struct {
+    embed_mcp_server_t *server;
+    mcp_connection_t connection;  // Copy - the transport's object only lives for the callback
+    uint64_t capture_stream;
+    message_budget_t budget;
+    size_t length;
+    char *message;                // Copy of the body, parsed once on the worker
+} message_job_t;
+
+static void message_job_run(void *arg) {
+    message_job_t *job = (message_job_t*)arg;
+
+    handle_message(job->server, job->message, job->length, &job->connection, job->budget.session,
+                   job->capture_stream);
+    message_budget_release(&job->budget);
+
+    free(job->message);
+    free(job);
+}
+
+// Run the entries of a JSON-RPC batch in parallel on the worker pool
+static void batch_executor(mcp_protocol_task_t task, void *arg, size_t count, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+
+    if (mcp_worker_pool_parallel_for(server->worker_pool, task, arg, count) != 0) {
+        for (size_t i = 0; i < count; i++) {
+            task(arg, i);
+        }
+    }
+}
+
+static void admission_configure(embed_mcp_admission_t *admission, int max_connections,
+                                int queue_depth, int queue_wait_ms, int session_max_in_flight) {
+    admission->queue_depth = (size_t)(queue_depth > 0 ? queue_depth : max_connections * 4);
+    admission->queue_wait_ms = queue_wait_ms > 0 ? (uint32_t)queue_wait_ms : 0;
+    admission->session_max_in_flight = session_max_in_flight > 0 ? (size_t)session_max_in_flight : 0;
+}
+
+// Worker pool bounded per class rather than as a whole
+static mcp_worker_pool_t *admission_pool_create(size_t threads, const embed_mcp_admission_t *admission) {
+    mcp_worker_pool_t *pool = mcp_worker_pool_create(threads, 0);
+    if (!pool) return NULL;
+
+    mcp_worker_class_limits_t limits = { admission->queue_depth, admission->queue_wait_ms };
+    for (int priority = 0; priority < MCP_WORKER_PRIORITY_COUNT; priority++) {
+        mcp_worker_pool_set_limits(pool, (mcp_worker_priority_t)priority, &limits);
+    }
+    return pool;
+}
+
+// Worker pool class of a message, from its method alone. Handshakes, pings,
+// notifications and responses to our own requests are cheap and keep a session alive, so
+// they go first; listings next; tool calls, reads and batches last.
+static mcp_worker_priority_t message_priority(const char *message, size_t length) {
+    size_t i = 0;
+    while (i < length && (message[i] == ' ' || message[i] == '\t' ||
+                          message[i] == '\r' || message[i] == '\n')) {
+        i++;
+    }
+    if (i < length && message[i] == '[') return MCP_WORKER_PRIORITY_WORK;
+
+    size_t method_length = 0;
+    const char *method = jsonrpc_peek_method(message, length, &method_length);
+    if (!method) return MCP_WORKER_PRIORITY_CONTROL;
+
+    static const char *const control[] = { "initialize", "ping" };
+    static const char *const query[] = {
+        "tools/list", "resources/list", "resources/templates/list", "prompts/list"
+    };
+    if (method_length > 14 && memcmp(method, "notifications/", 14) == 0) {
+        return MCP_WORKER_PRIORITY_CONTROL;
+    }
+    for (size_t c = 0; c < sizeof(control) / sizeof(control[0]); c++) {
+        if (strlen(control[c]) == method_length && memcmp(method, control[c], method_length) == 0) {
+            return MCP_WORKER_PRIORITY_CONTROL;
+        }
+    }
+    for (size_t q = 0; q < sizeof(query) / sizeof(query[0]); q++) {
+        if (strlen(query[q]) == method_length && memcmp(method, query[q], method_length) == 0) {
+            return MCP_WORKER_PRIORITY_QUERY;
+        }
+    }
+    return MCP_WORKER_PRIORITY_WORK;
+}
+
+// Queue a message on the worker pool in its class. MCP_WORKER_SUBMIT_ERROR means it has
+// to run inline, QUEUE_FULL and QUEUE_SLOW that admission control shed it.
+static mcp_worker_submit_result_t dispatch_to_worker(embed_mcp_server_t *server,
+                                                     const char *message, size_t length,
+                                                     const mcp_connection_t *connection,
+                                                     uint64_t capture_stream,
+                                                     const message_budget_t *budget) {
+    message_job_t *job = malloc(sizeof(message_job_t));
+    if (!job) return MCP_WORKER_SUBMIT_ERROR;
+
+    job->message = malloc(length + 1);
+    if (!job->message) {
+        free(job);
+        return MCP_WORKER_SUBMIT_ERROR;
+    }
+    memcpy(job->message, message, length);
+    job->message[length] = '\0';
+    job->length = length;
+
+    job->server = server;
+    job->connection = *connection;
+    job->connection.connection_id = NULL;
+    job->connection.session_id = NULL;
+    job->capture_stream = capture_stream;
+    job->budget = *budget;
+
+    mcp_worker_submit_result_t result =
+        mcp_worker_pool_submit_priority(server->worker_pool, message_job_run, job,
+                                        message_priority(message, length));
+    if (result != MCP_WORKER_SUBMIT_OK) {
+        free(job->message);
+        free(job);
+    }
+    return result;
+}
+
+// Capture file label: the MCP session when the connection has one, else the transport
+static const char *capture_label(const mcp_connection_t *connection) {
+    if (connection->session_id) return connection->session_id;
+    if (connection->transport && connection->transport->type == MCP_TRANSPORT_HTTP) return "http";
+    if (connection->transport && connection->transport->type == MCP_TRANSPORT_UART) return "uart";
+    return "stdio";
+}
+
+// Transport callbacks
+static void on_message_received(const char *message, size_t length,
+                               mcp_connection_t *connection, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    
+    if (server->debug) {
+        if (connection && (connection->flags & MCP_CONNECTION_FLAG_CBOR)) {
+            mcp_log_debug("Received CBOR message (%zu bytes)", length);
+        } else {
+            mcp_log_debug("Received message (%zu bytes): %.*s", length, (int)length, message);
+        }
+    }
+
+    // Workers only see a copy of the connection, so the session's stream is resolved here
+    uint64_t capture_stream = 0;
+    if (server->capture && connection) {
+        capture_stream = mcp_capture_stream(server->capture, connection, capture_label(connection));
+        mcp_capture_record(server->capture, capture_stream, MCP_CAPTURE_INBOUND, message, length);
+    }
+
+    bool http = connection && connection->transport && connection->transport->type == MCP_TRANSPORT_HTTP;
+    if (server->session_tokens && http && connection->session_id &&
+        !check_session_token(server, connection)) {
+        return;
+    }
+
+    // The session the request names, read through from the session store when this
+    // node has not seen it yet
+    mcp_session_t *session = NULL;
+    if (server->session_manager && connection && connection->session_id) {
+        session = mcp_session_manager_find_session(server->session_manager, connection->session_id);
+        if (!session && http) {
+            reject_unknown_session(connection);
+            return;
+        }
+        mcp_session_record_request(session, false);
+    }
+
+    // One session may only keep so many HTTP requests in flight (429 beyond that), so a
+    // single busy client cannot fill the queues for everybody else
+    bool in_flight = false;
+    if (session && http && server->admission.session_max_in_flight) {
+        size_t count = __atomic_add_fetch(&session->requests_in_flight, 1, __ATOMIC_ACQ_REL);
+        if (count > server->admission.session_max_in_flight) {
+            __atomic_sub_fetch(&session->requests_in_flight, 1, __ATOMIC_RELEASE);
+            __atomic_add_fetch(&server->requests_shed_session, 1, __ATOMIC_RELAXED);
+            mcp_session_unref(session);
+            refuse_message(server, message, length, connection, capture_stream, 429,
+                           MCP_ERROR_OVERLOADED, "Too many requests in flight for this session", true);
+            return;
+        }
+        in_flight = true;
+    }
+
+    // Refused before parsing when its working set would not fit the memory budget
+    message_budget_t budget;
+    mcp_mem_budget_result_t admitted = message_budget_reserve(session, in_flight, length, &budget);
+    if (admitted != MCP_MEM_BUDGET_OK) {
+        refuse_message(server, message, length, connection, capture_stream, 0,
+                       MCP_ERROR_RESOURCE_LIMIT, mcp_mem_budget_result_string(admitted),
+                       mcp_mem_budget_retryable(admitted));
+        return;
+    }
+
+    // HTTP replies can be sent from any thread, so HTTP requests run on the pool and the
+    // event loop stays free. STDIO keeps strict in-order handling on the reader thread.
+    if (server->worker_pool && http) {
+        mcp_worker_submit_result_t queued =
+            dispatch_to_worker(server, message, length, connection, capture_stream, &budget);
+        if (queued == MCP_WORKER_SUBMIT_OK) return;
+        if (queued != MCP_WORKER_SUBMIT_ERROR) {
+            // Shed rather than queued behind work that would outlast the client's patience
+            message_budget_release(&budget);
+            refuse_message(server, message, length, connection, capture_stream, 503,
+                           MCP_ERROR_OVERLOADED,
+                           queued == MCP_WORKER_SUBMIT_QUEUE_FULL ? "Server busy: queue full"
+                                                                  : "Server busy: queue too slow",
+                           true);
+            return;
+        }
+        mcp_log_warn("Worker pool unavailable, handling request on the event loop");
+    }
+
+    handle_message(server, message, length, connection, budget.session, capture_stream);
+    message_budget_release(&budget);
+}
+
+// GET <endpoint>: an event stream for messages the server sends on its own, the
+// list_changed and resources/updated notifications. With sessions enabled it must name
+// a live session.
+static void open_event_stream(mcp_connection_t *connection, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+
+    mcp_session_t *session = NULL;
+    if (server->session_manager || server->session_tokens) {
+        if (!connection->session_id) {
+            static const char body[] = "{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32600,"
+                                       "\"message\":\"Mcp-Session-Id required\"}}";
+            mcp_http_transport_send_status(connection, 400, body, sizeof(body) - 1);
+            return;
+        }
+        if (server->session_tokens) {
+            if (!check_session_token(server, connection)) return;
+        } else {
+            session = mcp_session_manager_find_session(server->session_manager, connection->session_id);
+            if (!session) {
+                reject_unknown_session(connection);
+                return;
+            }
+        }
+    }
+
+    if (mcp_http_transport_stream_begin(connection) < 0 ||
+        mcp_list_notifier_subscribe(server->list_notifier, connection, true, session) != 0) {
+        mcp_http_transport_stream_end(connection, NULL, 0);
+        mcp_session_unref(session);
+        return;
+    }
+
+    // Watches nobody was listening for were dropped; a reconnecting client gets them back
+    mcp_subscription_set_for_each(mcp_session_get_subscriptions(session, false), watch_resource, server);
+    mcp_session_unref(session);
+    if (server->debug) {
+        mcp_log_info("Event stream opened%s%s", connection->session_id ? " for session " : "",
+                     connection->session_id ? connection->session_id : "");
+    }
+}
+
+static void on_connection_opened(mcp_connection_t *connection, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    
+    if (server->debug) {
+        mcp_log_info("Connection opened: %s", mcp_connection_get_id(connection));
+    }
+}
+
+static void on_connection_closed(mcp_connection_t *connection, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
+    
+    if (server->debug) {
+        mcp_log_info("Connection closed: %s", mcp_connection_get_id(connection));
+    }
+    mcp_capture_close(server->capture, connection);
+    mcp_list_notifier_unsubscribe(server->list_notifier, connection);
+
+    // STDIO has a single connection - once the client closes stdin there is nothing left to serve
+    if (connection && connection->transport && connection->transport->type == MCP_TRANSPORT_STDIO) {
+        server->running = 0;
+        wakeup_main_loop();
+    }
+}
+
+static void on_transport_error(mcp_transport_t *transport, int error_code,
+                              const char *error_message, void *user_data) {
+    (void)transport;
+    (void)user_data;
+    mcp_log_error("Transport error %d: %s", error_code, error_message);
+}
+
+// Session manager as configured for a server or router
+static mcp_session_manager_t *create_session_manager(int max_sessions, int timeout, int auto_cleanup) {
+    mcp_session_manager_config_t *session_config = mcp_session_manager_config_create_default();
+    if (!session_config) return NULL;
+
+    session_config->max_sessions = max_sessions;
+    session_config->default_session_timeout = timeout;
+    session_config->auto_cleanup = auto_cleanup;
+
+    mcp_session_manager_t *manager = mcp_session_manager_create(session_config);
+    mcp_session_manager_config_destroy(session_config);
+    return manager;
+}
+
+// Token key for stateless sessions; tokens live as long as a session would
+static mcp_session_token_key_t *create_session_tokens(const char *secret, int timeout) {
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    mcp_session_token_key_t *key = hal->memory.alloc(sizeof(mcp_session_token_key_t));
+    if (!key) return NULL;
+
+    if (mcp_session_token_key_init(key, secret, timeout) != 0) {
+        hal->memory.free(key);
+        return NULL;
+    }
+    return key;
+}
+
+static void destroy_session_tokens(mcp_session_token_key_t *key) {
+    if (!key) return;
+
+    mcp_session_token_key_clear(key);
+    mcp_platform_get_hal()->memory.free(key);
+}
+
+// HTTP transport with the compression and event loop settings of a server or router
+static mcp_transport_t *create_http_transport(const char *host, int port, const char *path,
+                                              int compression_threshold, int compression_level,
+                                              int event_loops) {
+    mcp_transport_config_t *http_config = mcp_transport_config_create_http(port, host);
+    if (!http_config) return NULL;
+
+    if (path) {
+        char *endpoint_path = strdup(path);
+        if (!endpoint_path) {
+            mcp_transport_config_destroy(http_config);
+            return NULL;
+        }
+        free(http_config->config.http.endpoint_path);
+        http_config->config.http.endpoint_path = endpoint_path;
+    }
+    http_config->config.http.compression_threshold =
+        compression_threshold > 0 ? (size_t)compression_threshold : 0;
+    http_config->config.http.compression_level = compression_level;
+    http_config->config.http.event_loops = event_loops;
+
+    mcp_transport_t *transport = mcp_transport_create_with_config(http_config);
+    mcp_transport_config_destroy(http_config);
+    return transport;
+}
+
+// Log lines (including the debug copies of every message) go to output
+static void init_logging(const embed_mcp_server_t *server, FILE *output) {
+    mcp_log_config_t *log_config = mcp_log_config_create_default();
+    if (log_config) {
+        if (server->debug) {
+            log_config->min_level = MCP_LOG_LEVEL_DEBUG;
+        } else {
+            log_config->min_level = MCP_LOG_LEVEL_INFO;
+        }
+        log_config->output_stream = output;
+        mcp_log_init(log_config);
+        mcp_log_config_destroy(log_config);
+    }
+}
+
+// =============================================================================
+// API Implementation
+// =============================================================================
+
+embed_mcp_server_t *embed_mcp_create(const embed_mcp_config_t *config) {
+    if (!config || !config->name || !config->version) {
+        set_error("Invalid configuration");
+        return NULL;
+    }
+
+    // Initialize platform HAL
+    if (mcp_platform_init() != 0) {
+        set_error("Platform initialization failed");
         return NULL;
     }
 
@@ -476,12 +1737,42 @@ embed_mcp_server_t *embed_mcp_create(const embed_mcp_config_t *config) {
     server->port = config->port > 0 ? config->port : 8080;
     server->debug = config->debug;
 
+    // Process-wide, like the HAL allocator they account for
+    if (config->memory_budget || config->session_memory_limit || config->request_memory_limit) {
+        mcp_mem_budget_config_t budget = {
+            .global_limit = config->memory_budget,
+            .session_limit = config->session_memory_limit,
+            .request_limit = config->request_memory_limit
+        };
+        mcp_mem_budget_configure(&budget);
+    }
+
     // Multi-session configuration
     server->max_connections = config->max_connections > 0 ? config->max_connections : 10;
     server->session_timeout = config->session_timeout > 0 ? config->session_timeout : 3600;
     server->enable_sessions = config->enable_sessions != 0 ? config->enable_sessions : 1;
     server->auto_cleanup = config->auto_cleanup != 0 ? config->auto_cleanup : 1;
 
+    // Request execution (0 = run requests on the event loop thread)
+    server->worker_threads = config->worker_threads > 0 ? config->worker_threads : 0;
+    server->event_loops = config->event_loops > 0 ? config->event_loops : 1;
+    admission_configure(&server->admission, server->max_connections, config->queue_depth,
+                        config->queue_wait_ms, config->session_max_in_flight);
+
+    // Response compression (negative threshold = off)
+    server->compression_threshold = config->compression_threshold != 0 ? config->compression_threshold
+                                                                       : MCP_HTTP_COMPRESSION_THRESHOLD;
+    server->compression_level = config->compression_level > 0 && config->compression_level <= 9
+                                    ? config->compression_level : MCP_HTTP_COMPRESSION_LEVEL;
+
+    server->uart.type = MCP_TRANSPORT_UART;
+    server->uart.max_connections = 1;
+    server->uart.max_message_size = config->uart_max_message_size;
+    server->uart.config.uart.driver = config->uart_driver;
+    server->uart.config.uart.rx_ring_size = config->uart_rx_ring_size;
+    server->uart.config.uart.tx_ring_size = config->uart_tx_ring_size;
+    server->uart.encoding = config->uart_cbor ? MCP_TRANSPORT_ENCODING_CBOR : MCP_TRANSPORT_ENCODING_JSON;
+
     // This check was moved earlier in the function
     
     // Create tool registry
@@ -499,6 +1790,22 @@ embed_mcp_server_t *embed_mcp_create(const embed_mcp_config_t *config) {
         return NULL;
     }
 
+    // Async tools, deadlines, cancellation and progress for tools/call
+    server->tool_executor = mcp_tool_executor_create(tool_call_send, tool_call_completed, server);
+    if (!server->tool_executor) {
+        embed_mcp_destroy(server);
+        set_error("Failed to create tool executor");
+        return NULL;
+    }
+
+    server->list_notifier = mcp_list_notifier_create(config->list_changed_debounce_ms > 0 ?
+                                                     (uint32_t)config->list_changed_debounce_ms : 0);
+    if (!server->list_notifier) {
+        embed_mcp_destroy(server);
+        set_error("Failed to create list_changed notifier");
+        return NULL;
+    }
+
     // Create resource registry
     server->resource_registry = mcp_resource_registry_create();
     if (!server->resource_registry) {
@@ -512,6 +1819,15 @@ embed_mcp_server_t *embed_mcp_create(const embed_mcp_config_t *config) {
         mcp_resource_registry_set_logging(server->resource_registry, 1);
     }
 
+    server->resource_watcher = mcp_resource_watcher_create(server->resource_registry, resource_updated,
+                                                           resource_wanted, server);
+    if (!server->resource_watcher) {
+        embed_mcp_destroy(server);
+        set_error("Failed to create resource watcher");
+        return NULL;
+    }
+    mcp_resource_registry_set_changed_callback(server->resource_registry, resource_changed, server);
+
     // Create protocol config with user settings
     mcp_protocol_config_t *protocol_config = mcp_protocol_config_create_default();
     if (protocol_config) {
@@ -540,41 +1856,35 @@ embed_mcp_server_t *embed_mcp_create(const embed_mcp_config_t *config) {
     
     // Set protocol callbacks
     mcp_protocol_set_send_callback(server->protocol, protocol_send_callback, server);
-    mcp_protocol_set_request_handler(server->protocol, protocol_request_handler, server);
+    if (register_builtin_methods(server) != 0) {
+        embed_mcp_destroy(server);
+        set_error("Failed to register protocol methods");
+        return NULL;
+    }
 
     // Update capabilities based on registered features
     update_dynamic_capabilities(server);
 
-    // Create session manager if enabled
-    if (server->enable_sessions) {
-        mcp_session_manager_config_t *session_config = mcp_session_manager_config_create_default();
-        if (session_config) {
-            session_config->max_sessions = server->max_connections;
-            session_config->default_session_timeout = server->session_timeout;
-            session_config->auto_cleanup = server->auto_cleanup;
-
-            server->session_manager = mcp_session_manager_create(session_config);
-            mcp_session_manager_config_destroy(session_config);
-
-            if (!server->session_manager) {
-                embed_mcp_destroy(server);
-                set_error("Failed to create session manager");
-                return NULL;
-            }
+    // Stateless sessions replace the session manager
+    if (server->enable_sessions && config->stateless_sessions) {
+        server->session_tokens = create_session_tokens(config->session_secret, server->session_timeout);
+        if (!server->session_tokens) {
+            embed_mcp_destroy(server);
+            set_error("Failed to create session token key");
+            return NULL;
+        }
+    } else if (server->enable_sessions) {
+        server->session_manager = create_session_manager(server->max_connections, server->session_timeout,
+                                                         server->auto_cleanup);
+        if (!server->session_manager) {
+            embed_mcp_destroy(server);
+            set_error("Failed to create session manager");
+            return NULL;
         }
     }
 
     // Initialize logging system
-    mcp_log_config_t *log_config = mcp_log_config_create_default();
-    if (log_config) {
-        if (server->debug) {
-            log_config->min_level = MCP_LOG_LEVEL_DEBUG;
-        } else {
-            log_config->min_level = MCP_LOG_LEVEL_INFO;
-        }
-        mcp_log_init(log_config);
-        mcp_log_config_destroy(log_config);
-    }
+    init_logging(server, stdout);
 
     return server;
 }
@@ -585,6 +1895,24 @@ void embed_mcp_destroy(embed_mcp_server_t *server) {
     // Get HAL for memory deallocation
     const mcp_platform_hal_t *hal = mcp_platform_get_hal();
 
+    // Drops the route and hands the shared session manager back
+    if (server->router) {
+        embed_mcp_router_remove(server->router, server);
+    }
+
+    // Release workers waiting on tool calls before joining them
+    mcp_tool_executor_shutdown(server->tool_executor);
+
+    if (server->worker_pool) {
+        mcp_worker_pool_destroy(server->worker_pool);
+    }
+
+    mcp_tool_executor_destroy(server->tool_executor);
+
+    // Their threads may be writing to the transport, the watcher's through the notifier
+    mcp_resource_watcher_destroy(server->resource_watcher);
+    mcp_list_notifier_destroy(server->list_notifier);
+
     if (server->transport) {
         mcp_transport_destroy(server->transport);
     }
@@ -593,56 +1921,419 @@ void embed_mcp_destroy(embed_mcp_server_t *server) {
         mcp_protocol_destroy(server->protocol);
     }
 
-    if (server->tool_registry) {
-        mcp_tool_registry_destroy(server->tool_registry);
-    }
+    if (server->tool_registry) {
+        mcp_tool_registry_destroy(server->tool_registry);
+    }
+
+    if (server->resource_registry) {
+        mcp_resource_registry_destroy(server->resource_registry);
+    }
+
+    if (server->session_manager) {
+        mcp_session_manager_destroy(server->session_manager);
+    }
+    destroy_session_tokens(server->session_tokens);
+
+    mcp_capture_destroy(server->capture);
+
+    // The registry has released the table tools
+    while (server->tool_tables) {
+        embed_mcp_tool_table_t *next = server->tool_tables->next;
+        hal_free(hal, server->tool_tables);
+        server->tool_tables = next;
+    }
+
+    while (server->custom_methods) {
+        embed_mcp_custom_method_t *next = server->custom_methods->next;
+        hal_free(hal, server->custom_methods);
+        server->custom_methods = next;
+    }
+
+    // Use HAL memory deallocation
+    hal_free(hal, server->name);
+    hal_free(hal, server->version);
+    hal_free(hal, server->host);
+    hal_free(hal, server->path);
+    hal_free(hal, server);
+
+    // Shutdown messages are still queued for the log flusher
+    mcp_log_flush();
+
+    // Cleanup platform HAL
+    mcp_platform_cleanup();
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+int embed_mcp_add_method(embed_mcp_server_t *server, const char *method,
+                         embed_mcp_method_handler_t handler, void *user_data) {
+    if (!server || !method || !handler) {
+        set_error("Invalid parameters");
+        return -1;
+    }
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    embed_mcp_custom_method_t *entry = hal ? hal->memory.alloc(sizeof(embed_mcp_custom_method_t)) : NULL;
+    if (!entry) {
+        set_error("Memory allocation failed");
+        return -1;
+    }
+
+    entry->handler = handler;
+    entry->user_data = user_data;
 
-    if (server->resource_registry) {
-        mcp_resource_registry_destroy(server->resource_registry);
+    if (mcp_protocol_register_method(server->protocol, method, method_custom, entry) != 0) {
+        hal->memory.free(entry);
+        set_error("Failed to register method");
+        return -1;
     }
 
-    if (server->session_manager) {
-        mcp_session_manager_destroy(server->session_manager);
-    }
+    entry->next = server->custom_methods;
+    server->custom_methods = entry;
+    return 0;
+}
 
-    // Use HAL memory deallocation
-    hal_free(hal, server->name);
-    hal_free(hal, server->version);
-    hal_free(hal, server->host);
-    hal_free(hal, server->path);
-    hal_free(hal, server);
+// =============================================================================
+// Metrics (GET /metrics on the HTTP transport)
+// =============================================================================
 
-    // Cleanup platform HAL
-    mcp_platform_cleanup();
+static int write_counter_family(mcp_json_buffer_t *out, const char *name, const char *help, uint64_t value) {
+    if (mcp_metrics_write_family(out, name, MCP_METRICS_COUNTER, help) != 0) return -1;
+    return mcp_metrics_write_counter(out, name, NULL, NULL, value);
+}
+
+static int write_gauge_family(mcp_json_buffer_t *out, const char *name, const char *help, double value) {
+    if (mcp_metrics_write_family(out, name, MCP_METRICS_GAUGE, help) != 0) return -1;
+    return mcp_metrics_write_gauge(out, name, NULL, NULL, value);
+}
+
+static int write_tool_metrics(mcp_json_buffer_t *out, embed_mcp_server_t *server) {
+    size_t count = 0;
+    mcp_tool_stats_t *tools = mcp_tool_registry_snapshot_stats(server->tool_registry, &count);
+    int result = 0;
+
+    if (mcp_metrics_write_family(out, "embedmcp_tool_calls", MCP_METRICS_COUNTER, "Tool calls") != 0) result = -1;
+    for (size_t i = 0; i < count && result == 0; i++) {
+        result = mcp_metrics_write_counter(out, "embedmcp_tool_calls", "tool", tools[i].name, tools[i].calls_made);
+    }
+    if (result == 0 &&
+        mcp_metrics_write_family(out, "embedmcp_tool_call_failures", MCP_METRICS_COUNTER,
+                                 "Tool calls that returned an error") != 0) result = -1;
+    for (size_t i = 0; i < count && result == 0; i++) {
+        result = mcp_metrics_write_counter(out, "embedmcp_tool_call_failures", "tool", tools[i].name,
+                                           tools[i].calls_failed);
+    }
+    if (result == 0 &&
+        mcp_metrics_write_family(out, "embedmcp_tool_call_duration_seconds", MCP_METRICS_HISTOGRAM,
+                                 "Wall-clock tool call latency") != 0) result = -1;
+    for (size_t i = 0; i < count && result == 0; i++) {
+        result = mcp_metrics_write_histogram(out, "embedmcp_tool_call_duration_seconds", "tool", tools[i].name,
+                                             &tools[i].latency, MCP_METRICS_UNIT_SECONDS);
+    }
+
+    if (result == 0 &&
+        mcp_metrics_write_family(out, "embedmcp_tool_calls_active", MCP_METRICS_GAUGE,
+                                 "Tool calls running, against max_concurrent_calls") != 0) result = -1;
+    for (size_t i = 0; i < count && result == 0; i++) {
+        result = mcp_metrics_write_gauge(out, "embedmcp_tool_calls_active", "tool", tools[i].name,
+                                         (double)tools[i].calls_active);
+    }
+    if (result == 0 &&
+        mcp_metrics_write_family(out, "embedmcp_tool_cache_hits", MCP_METRICS_COUNTER,
+                                 "Tool calls answered without running the tool") != 0) result = -1;
+    for (size_t i = 0; i < count && result == 0; i++) {
+        result = mcp_metrics_write_counter(out, "embedmcp_tool_cache_hits", "tool", tools[i].name,
+                                           tools[i].cache_hits);
+    }
+    if (result == 0 &&
+        mcp_metrics_write_family(out, "embedmcp_tool_cache_misses", MCP_METRICS_COUNTER,
+                                 "Calls of cacheable tools that ran the tool") != 0) result = -1;
+    for (size_t i = 0; i < count && result == 0; i++) {
+        result = mcp_metrics_write_counter(out, "embedmcp_tool_cache_misses", "tool", tools[i].name,
+                                           tools[i].cache_misses);
+    }
+    if (result == 0 &&
+        mcp_metrics_write_family(out, "embedmcp_tool_calls_rejected", MCP_METRICS_COUNTER,
+                                 "Tool calls refused by the tool's concurrency limit") != 0) result = -1;
+    for (size_t i = 0; i < count && result == 0; i++) {
+        result = mcp_metrics_write_counter(out, "embedmcp_tool_calls_rejected", "tool", tools[i].name,
+                                           tools[i].calls_rejected);
+    }
+
+    free(tools);
+    if (result != 0) return -1;
+
+    mcp_tool_cache_stats_t cache;
+    mcp_tool_registry_get_result_cache_stats(server->tool_registry, &cache);
+    if (write_counter_family(out, "embedmcp_tool_calls_coalesced",
+                             "Tool calls that shared the result of a concurrent identical call",
+                             cache.coalesced) != 0) {
+        return -1;
+    }
+
+    return write_gauge_family(out, "embedmcp_tool_calls_in_flight", "Tool calls held by the executor",
+                              (double)mcp_tool_executor_in_flight(server->tool_executor));
 }
 
+// Families owned by one server (a router serves them at <path>/metrics)
+static int write_server_metrics(mcp_json_buffer_t *out, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
 
+    if (write_tool_metrics(out, server) != 0) return -1;
+
+    mcp_resource_cache_stats_t cache;
+    mcp_resource_registry_get_cache_stats(server->resource_registry, &cache);
+    if (write_counter_family(out, "embedmcp_resource_cache_hits", "Resource reads served from the cache",
+                             (uint64_t)cache.hits) != 0 ||
+        write_counter_family(out, "embedmcp_resource_cache_misses", "Resource reads that missed the cache",
+                             (uint64_t)cache.misses) != 0 ||
+        write_counter_family(out, "embedmcp_resource_cache_evictions", "Entries evicted from the resource cache",
+                             (uint64_t)cache.evictions) != 0 ||
+        write_gauge_family(out, "embedmcp_resource_cache_bytes", "Bytes held by the resource cache",
+                           (double)cache.bytes) != 0 ||
+        write_counter_family(out, "embedmcp_resource_reads_coalesced",
+                             "Resource reads that shared the content of a concurrent identical read",
+                             cache.coalesced) != 0 ||
+        write_counter_family(out, "embedmcp_requests_shed_session",
+                             "Requests refused for exceeding session_max_in_flight",
+                             __atomic_load_n(&server->requests_shed_session, __ATOMIC_RELAXED)) != 0 ||
+        write_gauge_family(out, "embedmcp_list_changed_subscribers",
+                           "Clients listening for list_changed notifications",
+                           (double)mcp_list_notifier_subscriber_count(server->list_notifier)) != 0 ||
+        write_counter_family(out, "embedmcp_list_changed_notifications",
+                             "list_changed notifications sent, per client and list",
+                             __atomic_load_n(&server->list_notifier->notifications_sent, __ATOMIC_RELAXED)) != 0 ||
+        write_counter_family(out, "embedmcp_list_changed_coalesced",
+                             "Registry changes folded into a notification already pending",
+                             __atomic_load_n(&server->list_notifier->changes_coalesced, __ATOMIC_RELAXED)) != 0 ||
+        write_gauge_family(out, "embedmcp_resources_watched", "Subscribed resources being watched for changes",
+                           (double)mcp_resource_watcher_count(server->resource_watcher)) != 0 ||
+        write_counter_family(out, "embedmcp_resource_watch_reads",
+                             "Subscribed resources read again after a change event",
+                             __atomic_load_n(&server->resource_watcher->reads, __ATOMIC_RELAXED)) != 0 ||
+        write_counter_family(out, "embedmcp_resource_updates",
+                             "resources/updated notifications sent, per client",
+                             __atomic_load_n(&server->list_notifier->resource_updates_sent, __ATOMIC_RELAXED)) != 0) {
+        return -1;
+    }
 
+    return 0;
+}
 
+// Worker pool figures labelled with their priority class
+static int write_class_metrics(mcp_json_buffer_t *out, const mcp_worker_pool_stats_t *pool) {
+    int result = 0;
+    if (mcp_metrics_write_family(out, "embedmcp_worker_class_queue_depth", MCP_METRICS_GAUGE,
+                                 "Requests waiting for a worker by priority class") != 0) result = -1;
+    for (int c = 0; result == 0 && c < MCP_WORKER_PRIORITY_COUNT; c++) {
+        result = mcp_metrics_write_gauge(out, "embedmcp_worker_class_queue_depth", "class",
+                                         mcp_worker_priority_name((mcp_worker_priority_t)c),
+                                         (double)pool->class_queue_length[c]);
+    }
+    if (result == 0 &&
+        mcp_metrics_write_family(out, "embedmcp_worker_class_oldest_wait_seconds", MCP_METRICS_GAUGE,
+                                 "Time the oldest waiting request of a class has queued") != 0) result = -1;
+    for (int c = 0; result == 0 && c < MCP_WORKER_PRIORITY_COUNT; c++) {
+        result = mcp_metrics_write_gauge(out, "embedmcp_worker_class_oldest_wait_seconds", "class",
+                                         mcp_worker_priority_name((mcp_worker_priority_t)c),
+                                         pool->class_oldest_wait_ms[c] / 1000.0);
+    }
+    if (result == 0 &&
+        mcp_metrics_write_family(out, "embedmcp_requests_shed_queue_full", MCP_METRICS_COUNTER,
+                                 "Requests shed because their class queue was full") != 0) result = -1;
+    for (int c = 0; result == 0 && c < MCP_WORKER_PRIORITY_COUNT; c++) {
+        result = mcp_metrics_write_counter(out, "embedmcp_requests_shed_queue_full", "class",
+                                           mcp_worker_priority_name((mcp_worker_priority_t)c),
+                                           pool->class_shed_full[c]);
+    }
+    if (result == 0 &&
+        mcp_metrics_write_family(out, "embedmcp_requests_shed_queue_slow", MCP_METRICS_COUNTER,
+                                 "Requests shed because their class had waited too long") != 0) result = -1;
+    for (int c = 0; result == 0 && c < MCP_WORKER_PRIORITY_COUNT; c++) {
+        result = mcp_metrics_write_counter(out, "embedmcp_requests_shed_queue_slow", "class",
+                                           mcp_worker_priority_name((mcp_worker_priority_t)c),
+                                           pool->class_shed_slow[c]);
+    }
+    return result;
+}
 
+// Request phase timings, once tracing has been enabled (process-wide)
+static int write_trace_metrics(mcp_json_buffer_t *out) {
+    mcp_trace_stats_t trace;
+    mcp_trace_get_stats(&trace);
+    if (!trace.enabled && trace.spans == 0) return 0;
+
+    if (write_counter_family(out, "embedmcp_trace_spans", "Request trace spans recorded", trace.spans) != 0 ||
+        write_counter_family(out, "embedmcp_trace_spans_overwritten",
+                             "Trace spans overwritten before they were exported", trace.overwritten) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_trace_phase_duration_seconds", MCP_METRICS_HISTOGRAM,
+                                 "Time spent in each phase of handling a request") != 0) {
+        return -1;
+    }
+    mcp_histogram_t phase;
+    for (int i = 0; i < MCP_TRACE_PHASE_COUNT; i++) {
+        mcp_trace_get_phase((mcp_trace_phase_t)i, &phase);
+        if (mcp_metrics_write_histogram(out, "embedmcp_trace_phase_duration_seconds", "phase",
+                                        mcp_trace_phase_name((mcp_trace_phase_t)i), &phase,
+                                        MCP_METRICS_UNIT_SECONDS) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
 
+// Families of the parts a router shares between its servers
+static int write_shared_metrics(mcp_json_buffer_t *out, mcp_worker_pool_t *worker_pool,
+                                mcp_session_manager_t *sessions, mcp_session_token_key_t *tokens) {
+    if (worker_pool) {
+        mcp_worker_pool_stats_t pool;
+        mcp_worker_pool_get_stats(worker_pool, &pool);
+        if (write_gauge_family(out, "embedmcp_worker_threads", "Request worker threads",
+                               (double)pool.thread_count) != 0 ||
+            write_gauge_family(out, "embedmcp_worker_queue_depth", "Requests waiting for a worker",
+                               (double)pool.queue_length) != 0 ||
+            write_gauge_family(out, "embedmcp_worker_queue_capacity", "Worker queue limit (0: unbounded)",
+                               (double)pool.queue_capacity) != 0 ||
+            write_counter_family(out, "embedmcp_worker_jobs_submitted", "Requests queued for a worker",
+                                 pool.jobs_submitted) != 0 ||
+            write_counter_family(out, "embedmcp_worker_jobs_completed", "Requests finished by a worker",
+                                 pool.jobs_completed) != 0 ||
+            write_counter_family(out, "embedmcp_worker_jobs_rejected", "Requests refused by a full queue",
+                                 pool.jobs_rejected) != 0 ||
+            write_class_metrics(out, &pool) != 0) {
+            return -1;
+        }
+    }
 
+    if (sessions) {
+        if (write_gauge_family(out, "embedmcp_sessions", "Sessions currently held",
+                               (double)__atomic_load_n(&sessions->session_count, __ATOMIC_RELAXED)) != 0 ||
+            write_counter_family(out, "embedmcp_sessions_created", "Sessions created",
+                                 mcp_counter_read(&sessions->total_sessions_created)) != 0 ||
+            write_counter_family(out, "embedmcp_sessions_expired", "Sessions removed after their timeout",
+                                 mcp_counter_read(&sessions->sessions_expired)) != 0 ||
+            write_counter_family(out, "embedmcp_sessions_terminated", "Sessions ended by the client",
+                                 mcp_counter_read(&sessions->sessions_terminated)) != 0) {
+            return -1;
+        }
+        if (sessions->store &&
+            (write_counter_family(out, "embedmcp_sessions_loaded", "Sessions read through from the session store",
+                                  mcp_counter_read(&sessions->sessions_loaded)) != 0 ||
+             write_counter_family(out, "embedmcp_session_store_errors", "Failed session store operations",
+                                  mcp_counter_read(&sessions->store_errors)) != 0)) {
+            return -1;
+        }
+    }
 
+    if (tokens) {
+        if (write_counter_family(out, "embedmcp_session_tokens_issued", "Stateless session tokens issued",
+                                 __atomic_load_n(&tokens->issued, __ATOMIC_RELAXED)) != 0 ||
+            write_counter_family(out, "embedmcp_session_tokens_rejected",
+                                 "Requests refused for a bad or expired session token",
+                                 __atomic_load_n(&tokens->rejected, __ATOMIC_RELAXED)) != 0) {
+            return -1;
+        }
+    }
 
+    if (write_counter_family(out, "embedmcp_log_lines_dropped", "Log lines dropped by a full log buffer",
+                             mcp_log_get_dropped()) != 0) {
+        return -1;
+    }
 
+    mcp_mem_budget_stats_t memory;
+    mcp_mem_budget_get_stats(&memory);
+    if (write_gauge_family(out, "embedmcp_memory_heap_bytes", "HAL heap in use",
+                           (double)memory.heap_in_use) != 0 ||
+        write_gauge_family(out, "embedmcp_memory_reserved_bytes", "Memory reserved by requests and buffers",
+                           (double)memory.reserved) != 0 ||
+        write_gauge_family(out, "embedmcp_memory_high_water_bytes", "Most heap plus reservations seen",
+                           (double)memory.high_water) != 0 ||
+        write_gauge_family(out, "embedmcp_memory_budget_bytes", "Memory budget (0: no limit)",
+                           (double)memory.config.global_limit) != 0 ||
+        write_counter_family(out, "embedmcp_memory_rejected_request",
+                             "Requests refused by the per-request memory limit", memory.rejected_request) != 0 ||
+        write_counter_family(out, "embedmcp_memory_rejected_session",
+                             "Requests refused by a session's memory limit", memory.rejected_session) != 0 ||
+        write_counter_family(out, "embedmcp_memory_rejected_global",
+                             "Requests refused by the memory budget", memory.rejected_global) != 0) {
+        return -1;
+    }
 
+    mcp_json_pool_stats_t json_pool;
+    mcp_json_pool_get_stats(&json_pool);
+    if (json_pool.installed &&
+        (write_gauge_family(out, "embedmcp_json_pool_bytes", "Memory reserved by the JSON slab pool",
+                            (double)json_pool.bytes_reserved) != 0 ||
+         write_gauge_family(out, "embedmcp_json_pool_pages_used", "JSON pool pages given to a size class",
+                            (double)json_pool.pages_used) != 0 ||
+         write_gauge_family(out, "embedmcp_json_pool_pages", "JSON pool pages reserved",
+                            (double)json_pool.pages_total) != 0 ||
+         write_counter_family(out, "embedmcp_json_pool_heap_allocs",
+                              "JSON allocations served by the heap (too large or pool full)",
+                              json_pool.heap_allocs) != 0 ||
+         write_counter_family(out, "embedmcp_json_pool_failures", "JSON allocations refused by a full pool",
+                              json_pool.failures) != 0)) {
+        return -1;
+    }
 
+    return write_trace_metrics(out);
+}
 
+static int write_metrics(mcp_json_buffer_t *out, void *user_data) {
+    embed_mcp_server_t *server = (embed_mcp_server_t*)user_data;
 
+    if (write_server_metrics(out, server) != 0) return -1;
+    return write_shared_metrics(out, server->worker_pool, server->session_manager, server->session_tokens);
+}
 
+static int write_router_metrics(mcp_json_buffer_t *out, void *user_data) {
+    embed_mcp_router_t *router = (embed_mcp_router_t*)user_data;
 
+    if (write_gauge_family(out, "embedmcp_router_servers", "Servers routed on this listener",
+                           (double)router->server_count) != 0) {
+        return -1;
+    }
+    return write_shared_metrics(out, router->worker_pool, router->session_manager, router->session_tokens);
+}
 
 int embed_mcp_run(embed_mcp_server_t *server, embed_mcp_transport_t transport) {
     if (!server) {
         set_error("Invalid server");
         return -1;
     }
+    if (server->router) {
+        set_error("Server is attached to a router");
+        return -1;
+    }
 
     // Create transport
     if (transport == EMBED_MCP_TRANSPORT_STDIO) {
+        init_logging(server, stderr);   // stdout carries the protocol
         server->transport = mcp_transport_create_stdio();
+    } else if (transport == EMBED_MCP_TRANSPORT_UART) {
+        if (!server->uart.config.uart.driver) {
+            set_error("UART transport needs config.uart_driver");
+            return -1;
+        }
+        server->transport = mcp_transport_create_with_config(&server->uart);
     } else {
-        server->transport = mcp_transport_create_http(server->port, server->host);
+        server->transport = create_http_transport(server->host, server->port, server->path,
+                                                  server->compression_threshold, server->compression_level,
+                                                  server->event_loops);
     }
 
     if (!server->transport) {
@@ -650,6 +2341,11 @@ int embed_mcp_run(embed_mcp_server_t *server, embed_mcp_transport_t transport) {
         return -1;
     }
 
+    if (transport == EMBED_MCP_TRANSPORT_HTTP) {
+        mcp_http_transport_set_metrics_handler(server->transport, write_metrics, server);
+        mcp_http_transport_set_stream_handler(server->transport, open_event_stream, server);
+    }
+
     // Set transport callbacks
     mcp_transport_set_callbacks(server->transport,
                                on_message_received,
@@ -668,8 +2364,30 @@ int embed_mcp_run(embed_mcp_server_t *server, embed_mcp_transport_t transport) {
         }
     }
 
+    // Start worker pool for HTTP request execution
+    if (transport == EMBED_MCP_TRANSPORT_HTTP && server->worker_threads > 0) {
+        server->worker_pool = admission_pool_create((size_t)server->worker_threads, &server->admission);
+        if (!server->worker_pool) {
+            mcp_log_warn("Failed to create worker pool, requests will run on the event loop");
+        } else {
+            mcp_protocol_set_batch_executor(server->protocol, batch_executor, server);
+        }
+    }
+
+    // Create the main loop wakeup pipe before anything can try to stop us
+    if (pipe(g_wakeup_pipe) != 0) {
+        set_error("Failed to create wakeup pipe");
+        return -1;
+    }
+    fcntl(g_wakeup_pipe[1], F_SETFL, fcntl(g_wakeup_pipe[1], F_GETFL) | O_NONBLOCK);
+
+    server->running = 1;
+
     // Start transport
     if (mcp_transport_start(server->transport) != 0) {
+        close(g_wakeup_pipe[0]);
+        close(g_wakeup_pipe[1]);
+        g_wakeup_pipe[0] = g_wakeup_pipe[1] = -1;
         set_error("Failed to start transport");
         return -1;
     }
@@ -678,10 +2396,8 @@ int embed_mcp_run(embed_mcp_server_t *server, embed_mcp_transport_t transport) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
-    server->running = 1;
-
     if (server->debug) {
-        const char *transport_name = (transport == EMBED_MCP_TRANSPORT_STDIO) ? "STDIO" : "HTTP";
+        const char *transport_name = mcp_transport_type_to_string(server->transport->type);
         if (transport == EMBED_MCP_TRANSPORT_HTTP) {
             mcp_log_info("%s Server '%s' v%s started on %s:%d",
                         transport_name, server->name, server->version, server->host, server->port);
@@ -691,15 +2407,38 @@ int embed_mcp_run(embed_mcp_server_t *server, embed_mcp_transport_t transport) {
         }
     }
 
-    // Main loop
+    // Main loop - sleeps until there is work or someone asks us to stop
     while (g_running && server->running) {
-        // Poll transport for HTTP requests
-        if (server->transport && transport == EMBED_MCP_TRANSPORT_HTTP) {
-            extern int mcp_http_transport_poll(mcp_transport_t *transport);
-            mcp_http_transport_poll(server->transport);
+        if (transport == EMBED_MCP_TRANSPORT_HTTP) {
+            // Blocks until network activity, a worker reply or a wakeup
+            mcp_http_transport_poll(server->transport, -1);
+        } else {
+            // Requests are handled on the STDIO reader or UART task, just wait to be woken
+            char drain[64];
+            if (read(g_wakeup_pipe[0], drain, sizeof(drain)) < 0 && errno != EINTR) {
+                break;
+            }
         }
+    }
 
-        usleep(10000); // 10ms
+    // Give async tool calls a chance to answer, then finish in-flight requests and
+    // flush their replies before the listener goes away
+    size_t unfinished = mcp_tool_executor_drain(server->tool_executor, EMBED_MCP_SHUTDOWN_DRAIN_MS);
+    if (unfinished > 0) {
+        mcp_log_warn("Stopping with %zu tool call(s) still running", unfinished);
+    }
+    mcp_tool_executor_shutdown(server->tool_executor);
+
+    // Event streams end along with the last replies
+    mcp_list_notifier_close_all(server->list_notifier);
+
+    if (server->worker_pool) {
+        mcp_worker_pool_destroy(server->worker_pool);
+        server->worker_pool = NULL;
+
+        // First pass hands queued replies to mongoose, second pass writes them out
+        mcp_http_transport_poll(server->transport, 0);
+        mcp_http_transport_poll(server->transport, 0);
     }
 
     // Stop transport
@@ -710,6 +2449,10 @@ int embed_mcp_run(embed_mcp_server_t *server, embed_mcp_transport_t transport) {
         mcp_session_manager_stop(server->session_manager);
     }
 
+    close(g_wakeup_pipe[0]);
+    close(g_wakeup_pipe[1]);
+    g_wakeup_pipe[0] = g_wakeup_pipe[1] = -1;
+
     if (server->debug) {
         mcp_log_info("Server stopped");
     }
@@ -720,6 +2463,306 @@ int embed_mcp_run(embed_mcp_server_t *server, embed_mcp_transport_t transport) {
 void embed_mcp_stop(embed_mcp_server_t *server) {
     if (server) {
         server->running = 0;
+        wakeup_main_loop();
+    }
+}
+
+// =============================================================================
+// Router (several servers on one HTTP listener)
+// =============================================================================
+
+embed_mcp_router_t *embed_mcp_router_create(const embed_mcp_router_config_t *config) {
+    if (mcp_platform_init() != 0) {
+        set_error("Platform initialization failed");
+        return NULL;
+    }
+
+    const mcp_platform_hal_t *hal;
+    mcp_result_t hal_result = hal_safe_get(&hal);
+    if (hal_result != MCP_OK) {
+        set_error(mcp_error_to_string(hal_result));
+        return NULL;
+    }
+
+    embed_mcp_router_t *router;
+    hal_result = hal_safe_alloc(hal, sizeof(embed_mcp_router_t), (void**)&router);
+    if (hal_result != MCP_OK) {
+        set_error(mcp_error_to_string(hal_result));
+        return NULL;
+    }
+    memset(router, 0, sizeof(embed_mcp_router_t));
+
+    embed_mcp_router_config_t defaults = {0};
+    if (!config) config = &defaults;
+
+    router->host = hal_strdup(hal, config->host ? config->host : "0.0.0.0");
+    if (!router->host) {
+        hal_free(hal, router);
+        set_error("String allocation failed");
+        return NULL;
+    }
+
+    router->port = config->port > 0 ? config->port : 8080;
+    router->debug = config->debug;
+    router->max_connections = config->max_connections > 0 ? config->max_connections : 10;
+    router->worker_threads = config->worker_threads > 0 ? config->worker_threads : 0;
+    router->event_loops = config->event_loops > 0 ? config->event_loops : 1;
+    admission_configure(&router->admission, router->max_connections, config->queue_depth,
+                        config->queue_wait_ms, config->session_max_in_flight);
+    router->compression_threshold = config->compression_threshold != 0 ? config->compression_threshold
+                                                                       : MCP_HTTP_COMPRESSION_THRESHOLD;
+    router->compression_level = config->compression_level > 0 && config->compression_level <= 9
+                                    ? config->compression_level : MCP_HTTP_COMPRESSION_LEVEL;
+
+    int enable_sessions = config->enable_sessions != 0 ? config->enable_sessions : 1;
+    if (enable_sessions && config->stateless_sessions) {
+        router->session_tokens = create_session_tokens(
+            config->session_secret, config->session_timeout > 0 ? config->session_timeout : 3600);
+        if (!router->session_tokens) {
+            embed_mcp_router_destroy(router);
+            set_error("Failed to create session token key");
+            return NULL;
+        }
+    } else if (enable_sessions) {
+        router->session_manager = create_session_manager(
+            router->max_connections,
+            config->session_timeout > 0 ? config->session_timeout : 3600,
+            config->auto_cleanup != 0 ? config->auto_cleanup : 1);
+        if (!router->session_manager) {
+            embed_mcp_router_destroy(router);
+            set_error("Failed to create session manager");
+            return NULL;
+        }
+    }
+
+    return router;
+}
+
+void embed_mcp_router_destroy(embed_mcp_router_t *router) {
+    if (!router) return;
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+
+    while (router->server_count > 0) {
+        embed_mcp_router_remove(router, router->servers[router->server_count - 1]);
+    }
+
+    if (router->session_manager) {
+        mcp_session_manager_destroy(router->session_manager);
+    }
+    destroy_session_tokens(router->session_tokens);
+
+    hal_free(hal, router->servers);
+    hal_free(hal, router->host);
+    hal_free(hal, router);
+
+    mcp_log_flush();
+    mcp_platform_cleanup();
+}
+
+int embed_mcp_router_add(embed_mcp_router_t *router, embed_mcp_server_t *server) {
+    if (!router || !server) {
+        set_error("Invalid router or server");
+        return -1;
+    }
+    if (router->running || server->router || server->running) {
+        set_error("Server cannot be attached while running or routed");
+        return -1;
+    }
+    if (strcmp(server->path, "/metrics") == 0) {
+        set_error("Path is reserved for metrics");
+        return -1;
+    }
+    for (size_t i = 0; i < router->server_count; i++) {
+        if (strcmp(router->servers[i]->path, server->path) == 0) {
+            set_error("Another server already uses this path");
+            return -1;
+        }
+    }
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    if (router->server_count == router->server_capacity) {
+        size_t capacity = router->server_capacity ? router->server_capacity * 2 : 4;
+        embed_mcp_server_t **servers;
+        if (hal_safe_alloc(hal, capacity * sizeof(*servers), (void**)&servers) != MCP_OK) {
+            set_error("Memory allocation failed");
+            return -1;
+        }
+        if (router->server_count > 0) {
+            memcpy(servers, router->servers, router->server_count * sizeof(*servers));
+        }
+        hal_free(hal, router->servers);
+        router->servers = servers;
+        router->server_capacity = capacity;
+    }
+
+    // The router's session manager (or token key) replaces the server's own
+    if (server->session_manager) {
+        mcp_session_manager_destroy(server->session_manager);
+    }
+    destroy_session_tokens(server->session_tokens);
+    server->session_manager = router->session_manager;
+    server->session_tokens = router->session_tokens;
+    server->router = router;
+    router->servers[router->server_count++] = server;
+    return 0;
+}
+
+int embed_mcp_router_remove(embed_mcp_router_t *router, embed_mcp_server_t *server) {
+    if (!router || !server || server->router != router) {
+        set_error("Server is not attached to this router");
+        return -1;
+    }
+    if (router->running) {
+        set_error("Router is running");
+        return -1;
+    }
+
+    for (size_t i = 0; i < router->server_count; i++) {
+        if (router->servers[i] == server) {
+            router->servers[i] = router->servers[--router->server_count];
+            break;
+        }
+    }
+
+    // The session manager stays with the router; a later standalone run goes without
+    server->session_manager = NULL;
+    server->session_tokens = NULL;
+    server->router = NULL;
+    return 0;
+}
+
+// Routed servers only see messages, so the router ends their capture sessions
+static void router_on_connection_closed(mcp_connection_t *connection, void *user_data) {
+    embed_mcp_router_t *router = (embed_mcp_router_t*)user_data;
+
+    for (size_t i = 0; i < router->server_count; i++) {
+        mcp_capture_close(router->servers[i]->capture, connection);
+    }
+}
+
+int embed_mcp_router_run(embed_mcp_router_t *router) {
+    if (!router || router->server_count == 0) {
+        set_error("Router has no servers");
+        return -1;
+    }
+
+    router->transport = create_http_transport(router->host, router->port, NULL,
+                                              router->compression_threshold, router->compression_level,
+                                              router->event_loops);
+    if (!router->transport) {
+        set_error("Failed to create transport");
+        return -1;
+    }
+
+    mcp_http_transport_set_metrics_handler(router->transport, write_router_metrics, router);
+    mcp_transport_set_callbacks(router->transport, NULL, NULL, router_on_connection_closed,
+                                on_transport_error, router);
+
+    for (size_t i = 0; i < router->server_count; i++) {
+        embed_mcp_server_t *server = router->servers[i];
+        if (mcp_http_transport_add_route(router->transport, server->path, on_message_received,
+                                         write_server_metrics, server) != 0) {
+            mcp_transport_destroy(router->transport);
+            router->transport = NULL;
+            set_error("Failed to add route");
+            return -1;
+        }
+    }
+
+    if (router->session_manager && mcp_session_manager_start(router->session_manager) != 0) {
+        mcp_transport_destroy(router->transport);
+        router->transport = NULL;
+        set_error("Failed to start session manager");
+        return -1;
+    }
+
+    // One pool for every server, sized for all of their connections
+    if (router->worker_threads > 0) {
+        router->worker_pool = admission_pool_create((size_t)router->worker_threads, &router->admission);
+        if (!router->worker_pool) {
+            mcp_log_warn("Failed to create worker pool, requests will run on the event loop");
+        }
+    }
+    for (size_t i = 0; i < router->server_count; i++) {
+        embed_mcp_server_t *server = router->servers[i];
+        server->worker_pool = router->worker_pool;
+        server->admission = router->admission;
+        server->running = 1;
+        if (router->worker_pool) {
+            mcp_protocol_set_batch_executor(server->protocol, batch_executor, server);
+        }
+    }
+
+    router->running = 1;
+
+    int result = 0;
+    if (mcp_transport_start(router->transport) != 0) {
+        set_error("Failed to start transport");
+        result = -1;
+    } else {
+        signal(SIGINT, signal_handler);
+        signal(SIGTERM, signal_handler);
+
+        if (router->debug) {
+            mcp_log_info("HTTP router started on %s:%d with %zu server(s)",
+                        router->host, router->port, router->server_count);
+        }
+
+        while (g_running && router->running) {
+            mcp_http_transport_poll(router->transport, -1);
+        }
+    }
+
+    // Same order as embed_mcp_run, with one drain budget for all servers
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    uint64_t start_us = hal && hal->time.get_time_us ? hal->time.get_time_us() : 0;
+    for (size_t i = 0; i < router->server_count; i++) {
+        embed_mcp_server_t *server = router->servers[i];
+        uint32_t budget = EMBED_MCP_SHUTDOWN_DRAIN_MS;
+        if (start_us > 0) {
+            uint64_t elapsed_ms = (hal->time.get_time_us() - start_us) / 1000;
+            budget = elapsed_ms < budget ? budget - (uint32_t)elapsed_ms : 0;
+        }
+        size_t unfinished = mcp_tool_executor_drain(server->tool_executor, budget);
+        if (unfinished > 0) {
+            mcp_log_warn("Server '%s' stopping with %zu tool call(s) still running", server->name, unfinished);
+        }
+        mcp_tool_executor_shutdown(server->tool_executor);
+    }
+
+    if (router->worker_pool) {
+        mcp_worker_pool_destroy(router->worker_pool);
+        router->worker_pool = NULL;
+
+        mcp_http_transport_poll(router->transport, 0);
+        mcp_http_transport_poll(router->transport, 0);
+    }
+    for (size_t i = 0; i < router->server_count; i++) {
+        router->servers[i]->worker_pool = NULL;
+        router->servers[i]->running = 0;
+    }
+
+    mcp_transport_stop(router->transport);
+    mcp_transport_destroy(router->transport);
+    router->transport = NULL;
+
+    if (router->session_manager) {
+        mcp_session_manager_stop(router->session_manager);
+    }
+
+    router->running = 0;
+    if (router->debug) {
+        mcp_log_info("Router stopped");
+    }
+
+    return result;
+}
+
+void embed_mcp_router_stop(embed_mcp_router_t *router) {
+    if (router) {
+        router->running = 0;
+        wakeup_main_loop();
     }
 }
 
@@ -784,7 +2827,14 @@ static cJSON *create_schema_from_params(mcp_param_desc_t *params, size_t param_c
                 break;
 
             case MCP_PARAM_ARRAY: {
-                cJSON_AddStringToObject(param_schema, "type", "array");
+                if (params[i].array_desc.packed) {
+                    // Also accepts a base64 string of little-endian float64 values
+                    const char *types[] = { "array", "string" };
+                    cJSON_AddItemToObject(param_schema, "type", cJSON_CreateStringArray(types, 2));
+                    cJSON_AddStringToObject(param_schema, "contentEncoding", "base64");
+                } else {
+                    cJSON_AddStringToObject(param_schema, "type", "array");
+                }
                 cJSON *items = cJSON_CreateObject();
                 cJSON_AddStringToObject(items, "description", params[i].array_desc.element_description);
 
@@ -840,44 +2890,190 @@ static cJSON *create_schema_from_params(mcp_param_desc_t *params, size_t param_c
 
 
 
-// =============================================================================
-// Unified Pure Function API Implementation
-// =============================================================================
+// =============================================================================
+// Unified Pure Function API Implementation
+// =============================================================================
+
+
+
+
+
+
+
+
+
+
+
+const char *embed_mcp_get_error(void) {
+    return g_error_message[0] ? g_error_message : "No error";
+}
+
+int embed_mcp_enable_capture(embed_mcp_server_t *server, const char *directory) {
+    if (!server || !directory) {
+        set_error("Invalid server or capture directory");
+        return -1;
+    }
+    if (server->running || (server->router && server->router->running)) {
+        set_error("Capture cannot be changed while the server is running");
+        return -1;
+    }
+
+    mcp_capture_t *capture = mcp_capture_create(directory);
+    if (!capture) {
+        set_error("Failed to create capture");
+        return -1;
+    }
+    mcp_capture_destroy(server->capture);
+    server->capture = capture;
+    return 0;
+}
+
+void embed_mcp_disable_capture(embed_mcp_server_t *server) {
+    if (!server || server->running || (server->router && server->router->running)) return;
+
+    mcp_capture_destroy(server->capture);
+    server->capture = NULL;
+}
+
+static int attach_session_store(mcp_session_manager_t *manager, mcp_session_store_t *store) {
+    if (!manager) {
+        set_error("Session store needs session management (not with stateless sessions)");
+        return -1;
+    }
+    if (mcp_session_manager_set_store(manager, store) != 0) {
+        set_error("A session store is already set");
+        return -1;
+    }
+    return 0;
+}
 
+int embed_mcp_set_session_store(embed_mcp_server_t *server, mcp_session_store_t *store) {
+    if (!server || !store) {
+        set_error("Invalid server or session store");
+        return -1;
+    }
+    if (server->running || server->router) {
+        set_error("Session store cannot be set while running or routed");
+        return -1;
+    }
+    return attach_session_store(server->session_manager, store);
+}
 
+int embed_mcp_router_set_session_store(embed_mcp_router_t *router, mcp_session_store_t *store) {
+    if (!router || !store) {
+        set_error("Invalid router or session store");
+        return -1;
+    }
+    if (router->running) {
+        set_error("Router is running");
+        return -1;
+    }
+    return attach_session_store(router->session_manager, store);
+}
 
+int embed_mcp_use_json_pool(const mcp_json_pool_config_t *config) {
+    if (mcp_json_pool_installed()) {
+        set_error("JSON pool is already installed");
+        return -1;
+    }
+    if (mcp_json_pool_install(config) != 0) {
+        set_error("Invalid JSON pool configuration or out of memory");
+        return -1;
+    }
+    return 0;
+}
 
+int embed_mcp_enable_tracing(embed_mcp_server_t *server, size_t spans_per_thread) {
+    if (mcp_trace_enable(spans_per_thread) != 0) {
+        set_error("Tracing needs the HAL microsecond clock");
+        return -1;
+    }
+    if (!server || mcp_tool_registry_has_tool(server->tool_registry, MCP_BUILTIN_TOOL_TRACE_EXPORT)) {
+        return 0;
+    }
 
+    cJSON *schema = mcp_builtin_tool_trace_export_schema();
+    mcp_tool_t *tool = mcp_tool_create(MCP_BUILTIN_TOOL_TRACE_EXPORT, "Trace export",
+                                       "Recorded request trace spans as Chrome trace-event JSON, "
+                                       "with per-phase latency percentiles",
+                                       schema, mcp_builtin_tool_trace_export_execute, NULL);
+    cJSON_Delete(schema);
+    if (!tool || mcp_tool_registry_register_tool(server->tool_registry, tool) != 0) {
+        mcp_tool_destroy(tool);
+        set_error("Failed to register the trace_export tool");
+        return -1;
+    }
+    update_dynamic_capabilities(server);
+    return 0;
+}
 
+void embed_mcp_disable_tracing(void) {
+    mcp_trace_disable();
+}
 
+cJSON *embed_mcp_call_tool(embed_mcp_server_t *server, const char *name, const cJSON *arguments) {
+    if (!server || !name) {
+        set_error("Invalid server or tool name");
+        return NULL;
+    }
+    cJSON *result = mcp_tool_registry_call_tool(server->tool_registry, name, arguments);
 
+    // Cached results and text views borrow their bytes; the caller gets a plain tree
+    if (mcp_json_contains_blob(result)) {
+        char *text = mcp_json_print(result);
+        mcp_json_delete(result);
+        result = text ? cJSON_Parse(text) : NULL;
+        free(text);
+    }
+    return result;
+}
 
+// Note: custom_func_data_t removed - replaced by universal wrapper system
 
+// Note: custom_function_wrapper removed - replaced by universal wrapper system
 
-const char *embed_mcp_get_error(void) {
-    return g_error_message[0] ? g_error_message : "No error";
+static double result_slot_number(const mcp_param_value_t* slot) {
+    switch (slot->type) {
+        case MCP_PARAM_INT: return (double)slot->int_val;
+        case MCP_PARAM_DOUBLE: return slot->double_val;
+        case MCP_PARAM_BOOL: return slot->bool_val;
+        default: return 0.0;
+    }
 }
 
-// Note: custom_func_data_t removed - replaced by universal wrapper system
-
-// Universal function wrapper data
-typedef struct {
-    mcp_universal_func_t wrapper_func;
-    const char** param_names;
-    mcp_param_type_t* param_types;
-    size_t param_count;
-    mcp_return_type_t return_type;
-    void* user_data;
-} universal_func_data_t;
+static void result_string_release(void* ctx) {
+    free(ctx);
+}
 
-// Note: custom_function_wrapper removed - replaced by universal wrapper system
+static cJSON* result_slot_to_json(mcp_return_type_t return_type, const mcp_param_value_t* slot, int borrowed) {
+    switch (return_type) {
+        case MCP_RETURN_INT:
+        case MCP_RETURN_DOUBLE:
+            return cJSON_CreateNumber(result_slot_number(slot));
+        case MCP_RETURN_STRING: {
+            if (slot->type != MCP_PARAM_STRING || !slot->string_val) {
+                return cJSON_CreateString("");
+            }
+            // The string is written out from where it is, then freed with the response
+            char* text = slot->string_val;
+            cJSON* view = mcp_json_create_text_view(text, strlen(text),
+                                                    borrowed ? NULL : result_string_release, text);
+            if (!view && !borrowed) free(text);
+            return view;
+        }
+        case MCP_RETURN_VOID:
+            return cJSON_CreateString("Operation completed");
+        default:
+            return cJSON_CreateString("Unknown result type");
+    }
+}
 
 // Universal function wrapper that calls user-provided wrapper function
 static cJSON* universal_function_wrapper(const cJSON *args, void *user_data) {
     universal_func_data_t* data = (universal_func_data_t*)user_data;
 
     // Create parameter accessor
-    param_accessor_data_t accessor_data = { .args = args };
+    param_accessor_data_t accessor_data = { .args = args, .func = data };
     mcp_param_accessor_t accessor = {
         .get_int = param_get_int,
         .get_double = param_get_double,
@@ -889,11 +3085,36 @@ static cJSON* universal_function_wrapper(const cJSON *args, void *user_data) {
         .has_param = param_has_param,
         .get_param_count = param_get_param_count,
         .get_json = param_get_json,
+        .bind = param_bind,
+        .get_int_at = param_get_int_at,
+        .get_double_at = param_get_double_at,
+        .get_string_at = param_get_string_at,
+        .get_bool_at = param_get_bool_at,
+        .view_array = param_view_array,
+        .view_array_at = param_view_array_at,
+        .result_slot = param_result_slot,
         .data = &accessor_data
     };
 
+    // Array views live in the thread arena until the result has been converted
+    mcp_arena_t* arena = mcp_arena_thread();
+    mcp_arena_mark_t arena_mark = mcp_arena_mark(arena);
+
     // Call the user's wrapper function with the parameter accessor
     void* result = data->wrapper_func(&accessor, data->user_data);
+    if (accessor_data.slots && accessor_data.slots != accessor_data.inline_slots) {
+        free(accessor_data.slots);
+    }
+
+    // Result written into the slot: nothing to free, strings are handed to the response
+    if (result && result == &accessor_data.result) {
+        cJSON* slot_result = mcp_tool_create_success_result_take(result_slot_to_json(data->return_type,
+                                                                                    &accessor_data.result,
+                                                                                    accessor_data.result_borrowed));
+        mcp_arena_rewind(arena, arena_mark);
+        return slot_result;
+    }
+    mcp_arena_rewind(arena, arena_mark);
 
     // Convert result to structured data based on return type
     cJSON* result_data = NULL;
@@ -933,10 +3154,7 @@ static cJSON* universal_function_wrapper(const cJSON *args, void *user_data) {
     }
 
     // Use the standard MCP tool success result format
-    cJSON* mcp_result = mcp_tool_create_success_result(result_data);
-    if (result_data) cJSON_Delete(result_data);
-
-    return mcp_result;
+    return mcp_tool_create_success_result_take(result_data);
 }
 
 
@@ -1070,6 +3288,21 @@ int embed_mcp_add_binary_function_resource(embed_mcp_server_t *server,
     return 0;
 }
 
+int embed_mcp_remove_resource(embed_mcp_server_t *server, const char *uri) {
+    if (!server || !server->resource_registry || !uri) {
+        set_error("Invalid server or resource URI");
+        return -1;
+    }
+
+    if (mcp_resource_registry_remove(server->resource_registry, uri) != 0) {
+        set_error("Resource not found");
+        return -1;
+    }
+
+    update_dynamic_capabilities(server);
+    return 0;
+}
+
 size_t embed_mcp_get_resource_count(embed_mcp_server_t *server) {
     if (!server || !server->resource_registry) {
         return 0;
@@ -1078,6 +3311,57 @@ size_t embed_mcp_get_resource_count(embed_mcp_server_t *server) {
     return mcp_resource_registry_count(server->resource_registry);
 }
 
+int embed_mcp_enable_resource_cache(embed_mcp_server_t *server, size_t max_bytes) {
+    if (!server || !server->resource_registry) {
+        return -1;
+    }
+
+    return mcp_resource_registry_enable_cache(server->resource_registry, max_bytes);
+}
+
+int embed_mcp_set_resource_page_size(embed_mcp_server_t *server, size_t page_size) {
+    if (!server || !server->resource_registry) {
+        return -1;
+    }
+
+    mcp_resource_registry_set_page_size(server->resource_registry, page_size);
+    return 0;
+}
+
+int embed_mcp_set_resource_cache_ttl(embed_mcp_server_t *server, const char *uri, uint32_t ttl_ms) {
+    if (!server || !server->resource_registry || !uri) {
+        return -1;
+    }
+
+    return mcp_resource_registry_set_cache_ttl(server->resource_registry, uri, ttl_ms);
+}
+
+int embed_mcp_notify_resource_changed(embed_mcp_server_t *server, const char *uri) {
+    if (!server || !server->resource_registry || !uri) {
+        return -1;
+    }
+
+    mcp_resource_registry_notify_changed(server->resource_registry, uri);
+    return 0;
+}
+
+int embed_mcp_get_resource_cache_stats(embed_mcp_server_t *server, embed_mcp_cache_stats_t *stats) {
+    if (!server || !server->resource_registry || !stats) {
+        return -1;
+    }
+
+    mcp_resource_cache_stats_t cache_stats;
+    mcp_resource_registry_get_cache_stats(server->resource_registry, &cache_stats);
+
+    stats->hits = cache_stats.hits;
+    stats->misses = cache_stats.misses;
+    stats->evictions = cache_stats.evictions;
+    stats->entries = cache_stats.entries;
+    stats->bytes = cache_stats.bytes;
+    stats->coalesced = cache_stats.coalesced;
+    return 0;
+}
+
 // =============================================================================
 // Resource Templates API Implementation
 // =============================================================================
@@ -1154,6 +3438,9 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
     }
 
     func_data->wrapper_func = wrapper_func;
+    func_data->param_hashes = NULL;
+    func_data->bound_names = NULL;
+    func_data->bound_order = 1;
     func_data->param_count = param_count;
     func_data->return_type = return_type;
     func_data->user_data = user_data;
@@ -1216,6 +3503,14 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
             }
             memcpy(func_data->param_types, param_types, param_count * sizeof(mcp_param_type_t));
         }
+
+        // Precompute name hashes for slot binding (binding falls back to hashing per call)
+        func_data->param_hashes = malloc(param_count * sizeof(uint32_t));
+        if (func_data->param_hashes) {
+            for (size_t i = 0; i < param_count; i++) {
+                func_data->param_hashes[i] = param_name_hash(func_data->param_names[i]);
+            }
+        }
     } else {
         func_data->param_names = NULL;
         func_data->param_types = NULL;
@@ -1245,6 +3540,7 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
                 if (func_data->param_types) {
                     free(func_data->param_types);
                 }
+                free(func_data->param_hashes);
                 free(func_data);
                 set_error("Memory allocation failed");
                 return -1;
@@ -1274,6 +3570,7 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
         if (func_data->param_types) {
             free(func_data->param_types);
         }
+        free(func_data->param_hashes);
         free(func_data);
         set_error("Failed to create input schema");
         return -1;
@@ -1296,6 +3593,7 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
         if (func_data->param_types) {
             free(func_data->param_types);
         }
+        free(func_data->param_hashes);
         free(func_data);
         set_error("Failed to create tool");
         return -1;
@@ -1314,6 +3612,264 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
     return 0;
 }
 
+int embed_mcp_add_tool_table(embed_mcp_server_t *server,
+                             const embed_mcp_tool_desc_t *tools,
+                             size_t count) {
+    if (!server || !server->tool_registry) {
+        set_error("Invalid server or tool registry not initialized");
+        return -1;
+    }
+
+    if (!tools || count == 0) {
+        set_error("Invalid parameters: tools and count are required");
+        return -1;
+    }
+
+    size_t total_params = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!tools[i].name || !tools[i].description || !tools[i].wrapper_func ||
+            (tools[i].param_count > 0 && !tools[i].param_names)) {
+            set_error("Invalid tool descriptor: name, description, wrapper_func and param_names are required");
+            return -1;
+        }
+        total_params += tools[i].param_count;
+    }
+
+    // One allocation: header, tools, wrapper data, then the parameter name hashes
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    size_t size = sizeof(embed_mcp_tool_table_t) + count * sizeof(mcp_tool_t) +
+                  count * sizeof(universal_func_data_t) + total_params * sizeof(uint32_t);
+    embed_mcp_tool_table_t *table = hal ? hal->memory.alloc(size) : NULL;
+    if (!table) {
+        set_error("Memory allocation failed");
+        return -1;
+    }
+
+    table->next = NULL;
+    table->count = count;
+    table->tools = (mcp_tool_t*)(table + 1);
+    table->funcs = (universal_func_data_t*)(table->tools + count);
+    uint32_t *hashes = (uint32_t*)(table->funcs + count);
+
+    for (size_t i = 0; i < count; i++) {
+        const embed_mcp_tool_desc_t *desc = &tools[i];
+        universal_func_data_t *func_data = &table->funcs[i];
+
+        func_data->wrapper_func = desc->wrapper_func;
+        func_data->param_names = (const char**)desc->param_names;
+        func_data->param_types = NULL;
+        func_data->param_hashes = desc->param_count > 0 ? hashes : NULL;
+        func_data->param_count = desc->param_count;
+        func_data->return_type = desc->return_type;
+        func_data->user_data = desc->user_data;
+        func_data->bound_names = NULL;
+        func_data->bound_order = 0;
+
+        for (size_t j = 0; j < desc->param_count; j++) {
+            *hashes++ = param_name_hash(desc->param_names[j]);
+        }
+
+        mcp_tool_init_static(&table->tools[i], desc->name, desc->name, desc->description,
+                             desc->input_schema_json, universal_function_wrapper, func_data);
+    }
+
+    if (mcp_tool_registry_register_tools(server->tool_registry, table->tools, count) != 0) {
+        for (size_t i = 0; i < count; i++) {
+            mcp_tool_destroy(&table->tools[i]);
+        }
+        hal->memory.free(table);
+        set_error("Failed to register tool table");
+        return -1;
+    }
+
+    table->next = server->tool_tables;
+    server->tool_tables = table;
+
+    // Update capabilities to reflect new tools
+    update_dynamic_capabilities(server);
+
+    return 0;
+}
+
+char *embed_mcp_param_schema_json(const mcp_param_desc_t *params, size_t param_count) {
+    if (param_count > 0 && !params) {
+        set_error("Invalid parameters: params is required when param_count > 0");
+        return NULL;
+    }
+
+    cJSON *schema = create_schema_from_params((mcp_param_desc_t*)params, param_count);
+    if (!schema) {
+        set_error("Failed to create input schema");
+        return NULL;
+    }
+
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    char *json = mcp_json_write_compact(&buffer, schema) == 0 ? mcp_json_buffer_detach(&buffer) : NULL;
+    mcp_json_buffer_free(&buffer);
+    cJSON_Delete(schema);
+
+    if (!json) {
+        set_error("Memory allocation failed");
+    }
+    return json;
+}
+
+// Registry calls bypass the executor; async tools can only run through it
+static cJSON *async_tool_sync_fallback(const cJSON *parameters, void *user_data) {
+    (void)parameters;
+    (void)user_data;
+    return mcp_tool_create_execution_error("Tool can only run asynchronously");
+}
+
+int embed_mcp_add_async_tool(embed_mcp_server_t *server,
+                             const char *name,
+                             const char *description,
+                             const mcp_param_desc_t *params,
+                             size_t param_count,
+                             mcp_tool_execute_async_func_t handler,
+                             void *user_data) {
+    if (!server || !server->tool_registry) {
+        set_error("Invalid server or tool registry not initialized");
+        return -1;
+    }
+
+    if (!name || !description || !handler || (param_count > 0 && !params)) {
+        set_error("Invalid parameters: name, description, and handler are required");
+        return -1;
+    }
+
+    cJSON *input_schema = create_schema_from_params((mcp_param_desc_t*)params, param_count);
+    if (!input_schema) {
+        set_error("Failed to create input schema");
+        return -1;
+    }
+
+    mcp_tool_t *tool = mcp_tool_create(name, name, description, input_schema,
+                                      async_tool_sync_fallback, user_data);
+    cJSON_Delete(input_schema);
+    if (!tool) {
+        set_error("Failed to create tool");
+        return -1;
+    }
+    mcp_tool_set_async_handler(tool, handler);
+
+    if (mcp_tool_registry_register_tool(server->tool_registry, tool) != 0) {
+        mcp_tool_destroy(tool);
+        set_error("Failed to register tool");
+        return -1;
+    }
+
+    update_dynamic_capabilities(server);
+
+    return 0;
+}
+
+int embed_mcp_remove_tool(embed_mcp_server_t *server, const char *name) {
+    if (!server || !server->tool_registry || !name) {
+        set_error("Invalid server or tool name");
+        return -1;
+    }
+
+    if (mcp_tool_registry_unregister_tool(server->tool_registry, name) != 0) {
+        set_error("Tool not found");
+        return -1;
+    }
+
+    update_dynamic_capabilities(server);
+    return 0;
+}
+
+int embed_mcp_set_tool_timeout(embed_mcp_server_t *server, const char *tool_name, uint32_t timeout_ms) {
+    if (!server || !server->tool_registry || !tool_name) {
+        return -1;
+    }
+
+    mcp_tool_t *tool = mcp_tool_registry_find_tool(server->tool_registry, tool_name);
+    if (!tool) {
+        set_error("Tool not found");
+        return -1;
+    }
+
+    int result = mcp_tool_set_execution_constraints(tool, timeout_ms, tool->max_memory_usage_bytes);
+    mcp_tool_unref(tool);
+    return result;
+}
+
+int embed_mcp_set_tool_cache_ttl(embed_mcp_server_t *server, const char *tool_name, uint32_t ttl_ms) {
+    if (!server || !server->tool_registry || !tool_name) {
+        return -1;
+    }
+
+    if (ttl_ms > 0 &&
+        mcp_tool_registry_enable_result_cache(server->tool_registry, EMBED_MCP_TOOL_CACHE_BYTES) != 0) {
+        set_error("Failed to create the tool result cache");
+        return -1;
+    }
+
+    mcp_tool_t *tool = mcp_tool_registry_find_tool(server->tool_registry, tool_name);
+    if (!tool) {
+        set_error("Tool not found");
+        return -1;
+    }
+
+    int result = mcp_tool_set_cache_ttl(tool, ttl_ms);
+    mcp_tool_unref(tool);
+    mcp_tool_registry_invalidate_results(server->tool_registry, tool_name);
+    return result;
+}
+
+int embed_mcp_enable_tool_cache(embed_mcp_server_t *server, size_t max_bytes) {
+    if (!server || !server->tool_registry) {
+        return -1;
+    }
+
+    return mcp_tool_registry_enable_result_cache(server->tool_registry, max_bytes);
+}
+
+int embed_mcp_invalidate_tool_cache(embed_mcp_server_t *server, const char *tool_name) {
+    if (!server || !server->tool_registry || !tool_name) {
+        return -1;
+    }
+
+    mcp_tool_registry_invalidate_results(server->tool_registry, tool_name);
+    return 0;
+}
+
+int embed_mcp_set_tool_concurrency(embed_mcp_server_t *server, const char *tool_name,
+                                   size_t max_concurrent, size_t max_waiting) {
+    if (!server || !server->tool_registry || !tool_name) {
+        return -1;
+    }
+
+    mcp_tool_t *tool = mcp_tool_registry_find_tool(server->tool_registry, tool_name);
+    if (!tool) {
+        set_error("Tool not found");
+        return -1;
+    }
+
+    // Every waiter parks a worker; more waiters than workers would let one saturated
+    // tool stall the whole server. Without a pool requests run on the transport thread.
+    int workers = server->router ? server->router->worker_threads : server->worker_threads;
+    size_t budget = workers > 0 ? (size_t)workers : 1;
+    size_t waiting = max_waiting;
+    size_t count = 0;
+    mcp_tool_stats_t *stats = mcp_tool_registry_snapshot_stats(server->tool_registry, &count);
+    for (size_t i = 0; stats && i < count; i++) {
+        if (strcmp(stats[i].name, tool_name) != 0) waiting += stats[i].max_waiting_calls;
+    }
+    free(stats);
+    if (waiting > budget) {
+        set_error("max_waiting across tools exceeds the worker threads");
+        mcp_tool_unref(tool);
+        return -1;
+    }
+
+    int result = mcp_tool_set_concurrency_limits(tool, max_concurrent, max_waiting);
+    mcp_tool_unref(tool);
+    return result;
+}
+
 
 
 
@@ -1,6 +1,7 @@
 #ifndef EMBED_MCP_H
 #define EMBED_MCP_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -16,18 +17,36 @@
 // Resource interface for templates
 #include "tools/resource_interface.h"
 
+// Tool interface for async tools (mcp_tool_call_t)
+#include "tools/tool_interface.h"
+
+// Slab pool for cJSON allocations (mcp_json_pool_config_t)
+#include "utils/json_pool.h"
+
+// Shared session stores (mcp_session_store_t, mcp_session_store_kv_create)
+#include "application/session_store_kv.h"
+
+// UART transport board driver (mcp_uart_driver_t)
+#include "transport/uart_transport.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // Forward declarations
 typedef struct embed_mcp_server embed_mcp_server_t;
+typedef struct embed_mcp_router embed_mcp_router_t;
 
 // Tool handler function type (legacy)
 // Parameters: args (JSON object with tool arguments)
 // Returns: JSON object with tool result (caller must free)
 typedef cJSON* (*embed_mcp_tool_handler_t)(const cJSON *args);
 
+// Request method handler
+// Parameters: params (JSON-RPC params, may be NULL), user_data (as registered)
+// Returns: JSON result object (caller must free), or NULL to report an internal error
+typedef cJSON* (*embed_mcp_method_handler_t)(const cJSON *params, void *user_data);
+
 // Parameter types
 typedef enum {
     MCP_PARAM_INT,
@@ -83,6 +102,30 @@ struct mcp_param_accessor {
     // For rare complex cases: direct JSON access
     const cJSON* (*get_json)(mcp_param_accessor_t* self, const char* name);
 
+    // Slot binding: resolve the named parameters into slots 0..count-1 with one
+    // pass over the arguments, then read them by index. Missing or mistyped
+    // arguments read as the same defaults as the by-name getters.
+    const mcp_param_value_t* (*bind)(mcp_param_accessor_t* self, const char* const* names, size_t count);
+    int64_t (*get_int_at)(mcp_param_accessor_t* self, size_t slot);
+    double (*get_double_at)(mcp_param_accessor_t* self, size_t slot);
+    const char* (*get_string_at)(mcp_param_accessor_t* self, size_t slot);
+    int (*get_bool_at)(mcp_param_accessor_t* self, size_t slot);
+
+    // Array views: the elements converted to element_type (const double*, const int*,
+    // const bool* or const char* const*) without a per-call malloc. The memory is
+    // owned by the server and stays valid until the wrapper returns - do not free it.
+    // Numeric arrays also accept a base64 string of little-endian float64 values.
+    const void* (*view_array)(mcp_param_accessor_t* self, const char* name,
+                              mcp_param_type_t element_type, size_t* count);
+    const void* (*view_array_at)(mcp_param_accessor_t* self, size_t slot,
+                                 mcp_param_type_t element_type, size_t* count);
+
+    // Result slot: instead of returning a malloc'd value, a wrapper may write its
+    // result into this slot and return the slot pointer. A string stored there is
+    // freed after the response is written unless borrowed is non-zero, in which
+    // case it must stay valid until then (e.g. a string literal).
+    mcp_param_value_t* (*result_slot)(mcp_param_accessor_t* self, int borrowed);
+
     // Internal data
     void* data;
 };
@@ -107,6 +150,7 @@ typedef enum {
 typedef struct {
     mcp_param_type_t element_type;      // Type of elements in the array
     const char *element_description;    // Description of what each element represents
+    int packed;                         // Numeric arrays: also accept base64 float64 (little-endian)
 } mcp_array_desc_t;
 
 /**
@@ -135,10 +179,26 @@ typedef struct {
     const char *json_schema;            // Complete JSON Schema for output format
 } mcp_output_desc_t;
 
+/**
+ * Tool descriptor for embed_mcp_add_tool_table() - everything is borrowed, so a
+ * table of these can live in flash or .rodata (see EMBED_MCP_TOOL below)
+ */
+typedef struct {
+    const char *name;                   // Tool name
+    const char *description;            // Tool description
+    const char *input_schema_json;      // Pre-serialized input JSON Schema (NULL: no validation)
+    const char *const *param_names;     // Parameter names, in the schema's property order
+    size_t param_count;                 // Number of parameters
+    mcp_return_type_t return_type;      // Return value type
+    mcp_universal_func_t wrapper_func;  // Universal wrapper function
+    void *user_data;                    // Passed to wrapper_func unchanged
+} embed_mcp_tool_desc_t;
+
 // Transport types
 typedef enum {
     EMBED_MCP_TRANSPORT_STDIO,
-    EMBED_MCP_TRANSPORT_HTTP
+    EMBED_MCP_TRANSPORT_HTTP,
+    EMBED_MCP_TRANSPORT_UART    // COBS/CRC-16 framed JSON or CBOR over a serial line (needs uart_driver)
 } embed_mcp_transport_t;
 
 /**
@@ -160,8 +220,78 @@ typedef struct {
     int session_timeout;        // Session timeout in seconds (default: 3600)
     int enable_sessions;        // Enable session management (0=off, 1=on, default: 1)
     int auto_cleanup;           // Auto cleanup expired sessions (0=off, 1=on, default: 1)
+
+    // Stateless HTTP sessions: initialize hands out a signed Mcp-Session-Id carrying the
+    // negotiated protocol version, client capabilities and expiry (session_timeout), and
+    // later requests are checked against the signature instead of a session table. Any
+    // server with the same secret accepts the token, so no sticky routing is needed.
+    int stateless_sessions;     // 0=off (default), 1=on; no session manager is kept
+    const char *session_secret; // Signing secret shared by the nodes (NULL: random, this process only)
+
+    // Request execution
+    int worker_threads;         // HTTP request worker threads (0=run on event loop, default: 0)
+    int event_loops;            // HTTP event loop threads sharing the port via SO_REUSEPORT (default: 1)
+
+    // notifications/tools/list_changed and notifications/resources/list_changed go to
+    // STDIO and UART clients once initialized, and to HTTP clients holding a GET stream
+    // on the endpoint. A burst of registrations is sent as one notification.
+    int list_changed_debounce_ms;   // Quiet time before a change is sent (0=default: 100)
+
+    // Admission control for HTTP requests on the worker pool (worker_threads > 0). Requests
+    // queue by class - initialize, ping and notifications first, then listings, then tool
+    // calls and everything else - and are shed with HTTP 503 and error -32002 when their
+    // class is full or its oldest request has waited too long. A session over its limit
+    // of requests in flight gets 429.
+    int queue_depth;            // Waiting requests per class (default: 4 * max_connections)
+    int queue_wait_ms;          // Longest a class's oldest request may wait (0=no limit, default: 0)
+    int session_max_in_flight;  // Requests one session may have in flight (0=no limit, default: 0)
+
+    // HTTP response compression (only in builds made with COMPRESSION=1)
+    int compression_threshold;  // Compress responses of at least this many bytes (<0=off, default: 1024)
+    int compression_level;      // zlib level 1-9 (default: 6)
+
+    // Memory budgets in bytes, shared by every server in the process (0 = no limit).
+    // Applied by embed_mcp_create() when any is set; requests that would exceed one
+    // are refused before parsing with error -32000 and data.retryable.
+    size_t memory_budget;           // HAL heap plus requests in flight
+    size_t session_memory_limit;    // Requests in flight on one session
+    size_t request_memory_limit;    // One request: 4x its size (text, parse tree, reply)
+
+    // UART transport: the board's DMA driver and the ring sizes (0 = defaults, 2 KiB
+    // RX and 4 KiB TX). Replies larger than the TX ring stream through it.
+    const mcp_uart_driver_t *uart_driver;
+    size_t uart_rx_ring_size;
+    size_t uart_tx_ring_size;
+    size_t uart_max_message_size;   // Longest request (default: 16 KiB)
+    bool uart_cbor;                 // Also accept CBOR messages, negotiated in initialize
 } embed_mcp_config_t;
 
+/**
+ * Router configuration - one HTTP listener shared by several servers
+ * Each server added to the router answers at its own config path; the servers' host,
+ * port, session, worker and compression settings are replaced by these.
+ */
+typedef struct {
+    const char *host;           // HTTP bind address (default: "0.0.0.0")
+    int port;                   // HTTP port number (default: 8080)
+    int debug;                  // Enable debug logging (0=off, 1=on, default: 0)
+
+    // Shared by all servers
+    int max_connections;        // Maximum concurrent connections (default: 10)
+    int session_timeout;        // Session timeout in seconds (default: 3600)
+    int enable_sessions;        // Enable session management (0=off, 1=on, default: 1)
+    int auto_cleanup;           // Auto cleanup expired sessions (0=off, 1=on, default: 1)
+    int stateless_sessions;     // Signed session tokens instead of a session table (see embed_mcp_config_t)
+    const char *session_secret; // Token signing secret (NULL: random, this process only)
+    int worker_threads;         // HTTP request worker threads (0=run on event loop, default: 0)
+    int event_loops;            // HTTP event loop threads sharing the port via SO_REUSEPORT (default: 1)
+    int queue_depth;            // Admission control (see embed_mcp_config_t)
+    int queue_wait_ms;
+    int session_max_in_flight;
+    int compression_threshold;  // Compress responses of at least this many bytes (<0=off, default: 1024)
+    int compression_level;      // zlib level 1-9 (default: 6)
+} embed_mcp_router_config_t;
+
 // =============================================================================
 // Core API Functions
 // =============================================================================
@@ -273,6 +403,48 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
                        mcp_universal_func_t wrapper_func,
                        void *user_data);
 
+/**
+ * Register a table of tools whose descriptors and schemas are compile-time constants
+ *
+ * Unlike embed_mcp_add_tool(), nothing is copied or built per tool: the tools point
+ * at the descriptors' strings, each schema is parsed and compiled by the tool's first
+ * call, and tools/list emits the schema text verbatim. The whole table takes a single
+ * allocation. The table and everything it points to must outlive the server.
+ *
+ * ```c
+ * EMBED_MCP_WRAPPER(add_wrapper, add, INT, INT, a, INT, b)
+ * EMBED_MCP_WRAPPER(scale_wrapper, scale, DOUBLE, DOUBLE_ARRAY, values, DOUBLE, factor)
+ *
+ * static const embed_mcp_tool_desc_t tools[] = {   // File scope
+ *     EMBED_MCP_TOOL("add", "Add two numbers", add_wrapper, MCP_RETURN_INT, INT, a, INT, b),
+ *     EMBED_MCP_TOOL("scale", "Scale values", scale_wrapper, MCP_RETURN_DOUBLE,
+ *                    DOUBLE_ARRAY, values, DOUBLE, factor),
+ * };
+ * embed_mcp_add_tool_table(server, tools, sizeof(tools) / sizeof(tools[0]));
+ * ```
+ *
+ * Registration is all or nothing: if any name is invalid or already taken, no tool
+ * of the table is registered.
+ * @param server Server instance
+ * @param tools Descriptor table
+ * @param count Number of descriptors
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_add_tool_table(embed_mcp_server_t *server,
+                             const embed_mcp_tool_desc_t *tools,
+                             size_t count);
+
+/**
+ * Serialize the input schema embed_mcp_add_tool() would build for params
+ * Meant for build-time generators that emit EMBED_MCP_TOOL_WITH_SCHEMA() literals
+ * for parameters the EMBED_MCP_TOOL() schema does not cover (descriptions, optional
+ * parameters, object parameters).
+ * @param params Parameter descriptions
+ * @param param_count Number of parameters
+ * @return Compact JSON (caller frees with free()), or NULL on error
+ */
+char *embed_mcp_param_schema_json(const mcp_param_desc_t *params, size_t param_count);
+
 
 
 
@@ -336,7 +508,10 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
 // =============================================================================
 
 // Parameter pair processing (type, name) -> extraction code
-#define PROCESS_PARAM_PAIR(type, name) type##_EXTRACT(name, params);
+#define PROCESS_PARAM_PAIR(type, name) type##_BIND(name, params);
+
+// Parameter pair -> name string, for the wrapper's binding table
+#define PARAM_NAME_STRING(type, name) #name,
 
 // Recursive parameter processing using FOR_EACH pattern
 #define FOR_EACH_PAIR(macro, ...) FOR_EACH_PAIR_IMPL(GET_ARG_COUNT(__VA_ARGS__), macro, __VA_ARGS__)
@@ -406,44 +581,66 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
 #define STRING_EXTRACT(name, params) const char* name = params->get_string(params, #name)
 #define BOOL_EXTRACT(name, params) bool name = params->get_bool(params, #name)
 
-// Array type extraction helpers
+// Slot-bound extraction used by EMBED_MCP_WRAPPER (mcp_slot_ is the wrapper's slot counter)
+#define INT_BIND(name, params) int name = (int)params->get_int_at(params, mcp_slot_++)
+#define DOUBLE_BIND(name, params) double name = params->get_double_at(params, mcp_slot_++)
+#define STRING_BIND(name, params) const char* name = params->get_string_at(params, mcp_slot_++)
+#define BOOL_BIND(name, params) bool name = params->get_bool_at(params, mcp_slot_++)
+#define INT_ARRAY_BIND(name, params) \
+    size_t name##_count; \
+    const int* name = params->view_array_at(params, mcp_slot_++, MCP_PARAM_INT, &name##_count)
+#define DOUBLE_ARRAY_BIND(name, params) \
+    size_t name##_count; \
+    const double* name = params->view_array_at(params, mcp_slot_++, MCP_PARAM_DOUBLE, &name##_count)
+#define STRING_ARRAY_BIND(name, params) \
+    size_t name##_count; \
+    const char* const* name = params->view_array_at(params, mcp_slot_++, MCP_PARAM_STRING, &name##_count)
+#define BOOL_ARRAY_BIND(name, params) \
+    size_t name##_count; \
+    const bool* name = params->view_array_at(params, mcp_slot_++, MCP_PARAM_BOOL, &name##_count)
+
+// Array type extraction helpers - views owned by the server, nothing to free
 #define INT_ARRAY_EXTRACT(name, params) \
     size_t name##_count; \
-    int64_t* name##_raw = params->get_int_array(params, #name, &name##_count); \
-    int* name = NULL; \
-    if (name##_raw) { \
-        name = malloc(name##_count * sizeof(int)); \
-        for (size_t i = 0; i < name##_count; i++) { \
-            name[i] = (int)name##_raw[i]; \
-        } \
-        free(name##_raw); \
-    }
+    const int* name = params->view_array(params, #name, MCP_PARAM_INT, &name##_count)
 
 #define DOUBLE_ARRAY_EXTRACT(name, params) \
     size_t name##_count; \
-    double* name = params->get_double_array(params, #name, &name##_count)
+    const double* name = params->view_array(params, #name, MCP_PARAM_DOUBLE, &name##_count)
 
 #define STRING_ARRAY_EXTRACT(name, params) \
     size_t name##_count; \
-    char** name = params->get_string_array(params, #name, &name##_count)
+    const char* const* name = params->view_array(params, #name, MCP_PARAM_STRING, &name##_count)
 
 #define BOOL_ARRAY_EXTRACT(name, params) \
     size_t name##_count; \
-    int64_t* name##_raw = params->get_int_array(params, #name, &name##_count); \
-    bool* name = NULL; \
-    if (name##_raw) { \
-        name = malloc(name##_count * sizeof(bool)); \
-        for (size_t i = 0; i < name##_count; i++) { \
-            name[i] = (name##_raw[i] != 0); \
-        } \
-        free(name##_raw); \
-    }
+    const bool* name = params->view_array(params, #name, MCP_PARAM_BOOL, &name##_count)
 
-// Return value helpers
+// Return value helpers - scalars go through the accessor's result slot. Define
+// EMBED_MCP_LEGACY_RETURN to get the old malloc'd-pointer results instead.
+#ifdef EMBED_MCP_LEGACY_RETURN
 #define INT_RETURN(result) do { int* ret = malloc(sizeof(int)); *ret = (result); return ret; } while(0)
 #define DOUBLE_RETURN(result) do { double* ret = malloc(sizeof(double)); *ret = (result); return ret; } while(0)
 #define STRING_RETURN(result) return (result)
 #define BOOL_RETURN(result) do { int* ret = malloc(sizeof(int)); *ret = (result); return ret; } while(0)
+#else
+#define INT_RETURN(result) do { \
+    mcp_param_value_t* mcp_ret_ = params->result_slot(params, 0); \
+    mcp_ret_->type = MCP_PARAM_INT; mcp_ret_->int_val = (result); return mcp_ret_; } while(0)
+#define DOUBLE_RETURN(result) do { \
+    mcp_param_value_t* mcp_ret_ = params->result_slot(params, 0); \
+    mcp_ret_->type = MCP_PARAM_DOUBLE; mcp_ret_->double_val = (result); return mcp_ret_; } while(0)
+#define STRING_RETURN(result) do { \
+    mcp_param_value_t* mcp_ret_ = params->result_slot(params, 0); \
+    mcp_ret_->type = MCP_PARAM_STRING; mcp_ret_->string_val = (result); return mcp_ret_; } while(0)
+#define BOOL_RETURN(result) do { \
+    mcp_param_value_t* mcp_ret_ = params->result_slot(params, 0); \
+    mcp_ret_->type = MCP_PARAM_BOOL; mcp_ret_->bool_val = (result) ? 1 : 0; return mcp_ret_; } while(0)
+#endif
+// For functions returning a string they keep ownership of (literal or static buffer)
+#define STRING_VIEW_RETURN(result) do { \
+    mcp_param_value_t* mcp_ret_ = params->result_slot(params, 1); \
+    mcp_ret_->type = MCP_PARAM_STRING; mcp_ret_->string_val = (char*)(result); return mcp_ret_; } while(0)
 #define VOID_RETURN(result) do { (void)(result); return NULL; } while(0)
 
 // Array return value helpers
@@ -517,8 +714,12 @@ int embed_mcp_add_tool(embed_mcp_server_t *server,
  */
 #define EMBED_MCP_WRAPPER(wrapper_name, func_name, return_type, ...) \
     void* wrapper_name(mcp_param_accessor_t* params, void* user_data) { \
+        static const char* const mcp_param_names_[] = { FOR_EACH_PAIR(PARAM_NAME_STRING, __VA_ARGS__) NULL }; \
+        size_t mcp_slot_ = 0; \
         (void)user_data; \
+        params->bind(params, mcp_param_names_, sizeof(mcp_param_names_) / sizeof(mcp_param_names_[0]) - 1); \
         FOR_EACH_PAIR(PROCESS_PARAM_PAIR, __VA_ARGS__) \
+        (void)mcp_slot_; \
         return_type##_RETURN(CALL_FUNCTION_WITH_PARAMS(func_name, __VA_ARGS__)); \
     }
 
@@ -598,13 +799,122 @@ int embed_mcp_add_tool_with_schema(embed_mcp_server_t *server,
                                    const cJSON *schema,
                                    embed_mcp_tool_handler_t handler);
 
+/**
+ * Add a tool that finishes in the background
+ * The handler starts the work and returns 0; the call is finished later, from any
+ * thread, with mcp_tool_call_complete(). While it runs the tool can send progress
+ * with mcp_tool_call_report_progress() and should stop once
+ * mcp_tool_call_is_cancelled() turns true (client cancelled or deadline passed).
+ * @param server Server instance
+ * @param name Tool name (must be unique)
+ * @param description Tool description
+ * @param params Parameter descriptions used for the input schema (may be NULL)
+ * @param param_count Number of parameters
+ * @param handler Function starting the tool
+ * @param user_data Passed to the handler unchanged
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_add_async_tool(embed_mcp_server_t *server,
+                             const char *name,
+                             const char *description,
+                             const mcp_param_desc_t *params,
+                             size_t param_count,
+                             mcp_tool_execute_async_func_t handler,
+                             void *user_data);
+
+/**
+ * Unregister a tool while the server runs, e.g. when a plugin is unloaded
+ * Calls already running finish normally; calls arriving afterwards get tool not
+ * found. Lookups never wait for the removal, nor the removal for calls in flight.
+ * Listening clients are sent notifications/tools/list_changed.
+ * @param server Server instance
+ * @param name Tool name
+ * @return 0 on success, -1 if no such tool is registered
+ */
+int embed_mcp_remove_tool(embed_mcp_server_t *server, const char *name);
+
+/**
+ * Set how long a tool may run before the call is answered with a timeout error
+ * Tools get 30 seconds by default. A sync tool cannot be interrupted: it keeps
+ * running, but its late result is dropped.
+ * @param server Server instance
+ * @param tool_name Registered tool
+ * @param timeout_ms Deadline in milliseconds, 0 for none
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_set_tool_timeout(embed_mcp_server_t *server, const char *tool_name, uint32_t timeout_ms);
+
+/**
+ * Cache a tool's results for ttl_ms, for tools whose result only depends on their
+ * arguments (no side effects, no clock or device reads). Calls with the same
+ * arguments, in any member order, are answered from the cache without running the
+ * tool; error results are never cached. The first TTL set enables a 256 KiB cache
+ * unless embed_mcp_enable_tool_cache() was called before. Results of async tools
+ * are not cached.
+ * @param server Server instance
+ * @param tool_name Registered tool
+ * @param ttl_ms Time to live in milliseconds, 0 to stop caching (drops its results)
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_set_tool_cache_ttl(embed_mcp_server_t *server, const char *tool_name, uint32_t ttl_ms);
+
+/**
+ * Enable the tool result cache with a byte budget, least recently used results are
+ * evicted past it. Has no effect once the cache exists.
+ * @param server Server instance
+ * @param max_bytes Serialized results kept at most
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_enable_tool_cache(embed_mcp_server_t *server, size_t max_bytes);
+
+/**
+ * Drop a tool's cached results, e.g. after the data behind it changed
+ * @param server Server instance
+ * @param tool_name Tool name
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_invalidate_tool_cache(embed_mcp_server_t *server, const char *tool_name);
+
+/**
+ * Limit how many calls of a tool run at once, e.g. for a tool on a serial device
+ * Calls beyond max_concurrent wait on their worker while fewer than max_waiting are
+ * waiting; further calls fail at once with a retryable busy_error result, so a
+ * saturated tool does not take the worker pool down with it. A waiter is refused the
+ * same way if no slot frees up within the tool's max_execution_time_ms (30 s if it
+ * has none). Tools have no limit by default. Usage and refusals show in the tool's
+ * stats and on /metrics.
+ * Waiters hold workers, so max_waiting summed over all tools may not exceed the
+ * worker thread count (the router's while routed); a setting that would is refused.
+ * @param server Server instance
+ * @param tool_name Registered tool
+ * @param max_concurrent Calls running at once, 0 for no limit
+ * @param max_waiting Calls that may wait for a slot, 0 to refuse right away
+ * @return 0 on success, -1 on error or if the waiters would fill the worker pool
+ */
+int embed_mcp_set_tool_concurrency(embed_mcp_server_t *server, const char *tool_name,
+                                   size_t max_concurrent, size_t max_waiting);
+
+/**
+ * Handle an additional JSON-RPC request method
+ * Methods are dispatched through a hash table that is built while the server is
+ * set up, so register them before calling embed_mcp_run(). Registering an
+ * existing method name replaces its handler.
+ * @param server Server instance
+ * @param method Method name (e.g. "prompts/list")
+ * @param handler Function producing the result object
+ * @param user_data Passed to the handler unchanged
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_add_method(embed_mcp_server_t *server, const char *method,
+                         embed_mcp_method_handler_t handler, void *user_data);
+
 
 
 /**
  * Run server with specified transport
  * This function blocks until the server is stopped
  * @param server Server instance
- * @param transport Transport type (EMBED_MCP_TRANSPORT_STDIO or EMBED_MCP_TRANSPORT_HTTP)
+ * @param transport Transport type (EMBED_MCP_TRANSPORT_STDIO, _HTTP or _UART)
  * @return 0 on success, -1 on error
  */
 int embed_mcp_run(embed_mcp_server_t *server, embed_mcp_transport_t transport);
@@ -615,6 +925,62 @@ int embed_mcp_run(embed_mcp_server_t *server, embed_mcp_transport_t transport);
  */
 void embed_mcp_stop(embed_mcp_server_t *server);
 
+// =============================================================================
+// Router - several servers on one HTTP port
+// =============================================================================
+
+/**
+ * Create a router. Servers are reached at POST <path>; GET <path>/metrics serves a
+ * server's tool and cache metrics, GET /metrics the shared worker and session metrics.
+ * @param config Router configuration (NULL for defaults)
+ * @return Router instance or NULL on error
+ */
+embed_mcp_router_t *embed_mcp_router_create(const embed_mcp_router_config_t *config);
+
+/**
+ * Destroy a router; attached servers are detached, not destroyed
+ * @param router Router instance
+ */
+void embed_mcp_router_destroy(embed_mcp_router_t *router);
+
+/**
+ * Attach a server at its config path. The server's own session manager is replaced
+ * by the router's. Not allowed while the router runs.
+ * @param router Router instance
+ * @param server Server instance (not running, path not used by another server)
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_router_add(embed_mcp_router_t *router, embed_mcp_server_t *server);
+
+/**
+ * Detach a server (embed_mcp_destroy does this too). Not allowed while the router runs.
+ * @param router Router instance
+ * @param server Attached server
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_router_remove(embed_mcp_router_t *router, embed_mcp_server_t *server);
+
+/**
+ * Keep the router's sessions in a shared store (see embed_mcp_set_session_store)
+ * @param router Router instance (not running, stateful sessions)
+ * @param store Session store, owned by the router on success
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_router_set_session_store(embed_mcp_router_t *router, mcp_session_store_t *store);
+
+/**
+ * Serve all attached servers over HTTP (blocking)
+ * @param router Router instance
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_router_run(embed_mcp_router_t *router);
+
+/**
+ * Stop the running router
+ * @param router Router instance
+ */
+void embed_mcp_router_stop(embed_mcp_router_t *router);
+
 // =============================================================================
 // Convenience Functions
 // =============================================================================
@@ -644,6 +1010,74 @@ int embed_mcp_quick_start(const char *name, const char *version,
  */
 const char *embed_mcp_get_error(void);
 
+/**
+ * Capture JSON-RPC traffic for replay (disabled by default)
+ * Every inbound and outbound frame is appended with a timestamp to a file per
+ * session under directory, named <start>-<n>-<label>.mcap. Replay captures with
+ * bin/mcp_replay. Call before embed_mcp_run() or embed_mcp_router_run().
+ * @param server Server instance
+ * @param directory Existing directory for the capture files
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_enable_capture(embed_mcp_server_t *server, const char *directory);
+
+/**
+ * Stop capturing and close the capture files (not while the server runs)
+ * @param server Server instance
+ */
+void embed_mcp_disable_capture(embed_mcp_server_t *server);
+
+/**
+ * Keep sessions in a store shared by several nodes (application/session_store.h)
+ * The session table becomes a cache in front of the store: new sessions are written
+ * through, a request naming a session this node has not seen reads it from the store,
+ * and activity is written back in batches every cleanup interval. A client whose node
+ * goes away carries on at another one without initializing again. Call before
+ * embed_mcp_run(); not with stateless_sessions.
+ * @param server Server instance (not running, not routed)
+ * @param store Session store, e.g. from mcp_session_store_kv_create(); owned by the
+ *              server on success
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_set_session_store(embed_mcp_server_t *server, mcp_session_store_t *store);
+
+/**
+ * Call a registered sync tool in-process, without going through a transport
+ * @param server Server instance
+ * @param name Tool name
+ * @param arguments Tool arguments (may be NULL)
+ * @return tools/call result (caller frees with cJSON_Delete), or NULL on error
+ */
+cJSON *embed_mcp_call_tool(embed_mcp_server_t *server, const char *name, const cJSON *arguments);
+
+/**
+ * Allocate cJSON nodes and short strings from a size-class slab pool (process-wide)
+ * Call once, before any server is created and before any cJSON value exists; the
+ * pool stays installed until the process exits. On FreeRTOS, MCP_JSON_POOL_STATIC
+ * with a statically allocated buffer keeps small JSON allocations off the heap.
+ * @param config Pool configuration, or NULL for a pool that grows from the HAL heap
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_use_json_pool(const mcp_json_pool_config_t *config);
+
+/**
+ * Record request trace spans (process-wide, off by default)
+ * Every thread keeps its last spans_per_thread spans: parse, method dispatch, method
+ * handler, tool lookup and execution, result serialization and send, each timed with
+ * the HAL microsecond clock. The builtin tool "trace_export" returns them as Chrome
+ * trace-event JSON (chrome://tracing, Perfetto) with per-phase percentiles, and
+ * GET /metrics adds embedmcp_trace_phase_duration_seconds.
+ * @param server Server that gets the trace_export tool (NULL: record only)
+ * @param spans_per_thread Spans kept per thread (0: 1024)
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_enable_tracing(embed_mcp_server_t *server, size_t spans_per_thread);
+
+/**
+ * Stop recording trace spans; those recorded can still be exported
+ */
+void embed_mcp_disable_tracing(void);
+
 // =============================================================================
 // Convenience Macros for Parameter Definitions
 // =============================================================================
@@ -671,6 +1105,10 @@ const char *embed_mcp_get_error(void);
 #define MCP_PARAM_ARRAY_STRING_DEF(name, desc, elem_desc, req) \
     {name, desc, MCP_PARAM_ARRAY, req, .array_desc = {MCP_PARAM_STRING, elem_desc}}
 
+// Double array that may also be sent as base64-packed little-endian float64
+#define MCP_PARAM_ARRAY_DOUBLE_PACKED_DEF(name, desc, elem_desc, req) \
+    {name, desc, MCP_PARAM_ARRAY, req, .array_desc = {MCP_PARAM_DOUBLE, elem_desc, 1}}
+
 // Object parameter macro
 #define MCP_PARAM_OBJECT_DEF(name, desc, schema, req) \
     {name, desc, MCP_PARAM_OBJECT, req, .object_schema = schema}
@@ -679,6 +1117,70 @@ const char *embed_mcp_get_error(void);
 #define MCP_OUTPUT_DESC(desc, schema) \
     &(mcp_output_desc_t){desc, schema}
 
+// =============================================================================
+// Compile-time Tool Tables
+// =============================================================================
+
+/**
+ * Descriptor initializers for embed_mcp_add_tool_table(), taking the same
+ * (type, name) pairs as EMBED_MCP_WRAPPER:
+ *
+ * EMBED_MCP_TOOL(name, description, wrapper, return_type, type1, name1, type2, name2, ...)
+ * EMBED_MCP_TOOL_WITH_SCHEMA(name, description, schema, wrapper, return_type, type1, name1, ...)
+ *
+ * EMBED_MCP_TOOL builds the input schema as a string literal: every parameter is
+ * required and no other property is accepted. Types are INT, DOUBLE, STRING, BOOL
+ * and their _ARRAY forms. Define tables using them at file scope: the names array
+ * is a compound literal, which only has static storage there.
+ */
+
+// Pairs joined by a separator, for JSON lists built at compile time
+#define FOR_EACH_PAIR_SEP(macro, sep, ...) FOR_EACH_PAIR_SEP_IMPL(GET_ARG_COUNT(__VA_ARGS__), macro, sep, __VA_ARGS__)
+#define FOR_EACH_PAIR_SEP_IMPL(count, macro, sep, ...) CONCAT(FOR_EACH_PAIR_SEP_, count)(macro, sep, __VA_ARGS__)
+
+#define FOR_EACH_PAIR_SEP_1(macro, sep, t1) // No parameters
+#define FOR_EACH_PAIR_SEP_2(macro, sep, t1, n1) macro(t1, n1)
+#define FOR_EACH_PAIR_SEP_4(macro, sep, t1, n1, ...) macro(t1, n1) sep FOR_EACH_PAIR_SEP_2(macro, sep, __VA_ARGS__)
+#define FOR_EACH_PAIR_SEP_6(macro, sep, t1, n1, ...) macro(t1, n1) sep FOR_EACH_PAIR_SEP_4(macro, sep, __VA_ARGS__)
+#define FOR_EACH_PAIR_SEP_8(macro, sep, t1, n1, ...) macro(t1, n1) sep FOR_EACH_PAIR_SEP_6(macro, sep, __VA_ARGS__)
+#define FOR_EACH_PAIR_SEP_10(macro, sep, t1, n1, ...) macro(t1, n1) sep FOR_EACH_PAIR_SEP_8(macro, sep, __VA_ARGS__)
+#define FOR_EACH_PAIR_SEP_12(macro, sep, t1, n1, ...) macro(t1, n1) sep FOR_EACH_PAIR_SEP_10(macro, sep, __VA_ARGS__)
+#define FOR_EACH_PAIR_SEP_14(macro, sep, t1, n1, ...) macro(t1, n1) sep FOR_EACH_PAIR_SEP_12(macro, sep, __VA_ARGS__)
+#define FOR_EACH_PAIR_SEP_16(macro, sep, t1, n1, ...) macro(t1, n1) sep FOR_EACH_PAIR_SEP_14(macro, sep, __VA_ARGS__)
+#define FOR_EACH_PAIR_SEP_18(macro, sep, t1, n1, ...) macro(t1, n1) sep FOR_EACH_PAIR_SEP_16(macro, sep, __VA_ARGS__)
+#define FOR_EACH_PAIR_SEP_20(macro, sep, t1, n1, ...) macro(t1, n1) sep FOR_EACH_PAIR_SEP_18(macro, sep, __VA_ARGS__)
+
+// Schema fragments per parameter type
+#define INT_SCHEMA "\"type\":\"integer\""
+#define DOUBLE_SCHEMA "\"type\":\"number\""
+#define STRING_SCHEMA "\"type\":\"string\""
+#define BOOL_SCHEMA "\"type\":\"boolean\""
+#define INT_ARRAY_SCHEMA "\"type\":\"array\",\"items\":{" INT_SCHEMA "}"
+#define DOUBLE_ARRAY_SCHEMA "\"type\":\"array\",\"items\":{" DOUBLE_SCHEMA "}"
+#define STRING_ARRAY_SCHEMA "\"type\":\"array\",\"items\":{" STRING_SCHEMA "}"
+#define BOOL_ARRAY_SCHEMA "\"type\":\"array\",\"items\":{" BOOL_SCHEMA "}"
+
+#define PARAM_SCHEMA_PROPERTY(type, name) "\"" #name "\":{" type##_SCHEMA "}"
+#define PARAM_SCHEMA_REQUIRED(type, name) "\"" #name "\""
+
+// Input schema literal, laid out like the one embed_mcp_add_tool() builds
+#define EMBED_MCP_SCHEMA(...) \
+    "{\"$schema\":\"http://json-schema.org/draft-07/schema#\",\"type\":\"object\"," \
+    "\"title\":\"Tool Parameters\",\"description\":\"Parameters for the tool\",\"properties\":{" \
+    FOR_EACH_PAIR_SEP(PARAM_SCHEMA_PROPERTY, ",", __VA_ARGS__) \
+    "},\"required\":[" \
+    FOR_EACH_PAIR_SEP(PARAM_SCHEMA_REQUIRED, ",", __VA_ARGS__) \
+    "],\"additionalProperties\":false}"
+
+#define EMBED_MCP_TOOL_WITH_SCHEMA(tool_name, tool_description, schema, wrapper, return_type, ...) \
+    { tool_name, tool_description, schema, \
+      (const char* const[]){ FOR_EACH_PAIR(PARAM_NAME_STRING, __VA_ARGS__) NULL }, \
+      GET_ARG_COUNT(__VA_ARGS__) / 2, return_type, wrapper, NULL }
+
+#define EMBED_MCP_TOOL(tool_name, tool_description, wrapper, return_type, ...) \
+    EMBED_MCP_TOOL_WITH_SCHEMA(tool_name, tool_description, EMBED_MCP_SCHEMA(__VA_ARGS__), \
+                               wrapper, return_type, __VA_ARGS__)
+
 // =============================================================================
 // Resource API - MCP Resources Support
 // =============================================================================
@@ -790,6 +1292,16 @@ int embed_mcp_add_binary_function_resource(embed_mcp_server_t *server,
                                            embed_mcp_binary_resource_function_t function,
                                            void *user_data);
 
+/**
+ * Unregister a resource while the server runs
+ * Reads already in progress finish with it; its cached content is dropped and
+ * listening clients are sent notifications/resources/list_changed.
+ * @param server Server instance
+ * @param uri Resource URI
+ * @return 0 on success, -1 if no such resource is registered
+ */
+int embed_mcp_remove_resource(embed_mcp_server_t *server, const char *uri);
+
 /**
  * Get the number of registered resources
  * @param server Server instance
@@ -797,6 +1309,67 @@ int embed_mcp_add_binary_function_resource(embed_mcp_server_t *server,
  */
 size_t embed_mcp_get_resource_count(embed_mcp_server_t *server);
 
+/**
+ * Paginate resources/list (disabled by default)
+ * Clients page through the list by sending back each response's nextCursor.
+ * @param server Server instance
+ * @param page_size Resources per page, 0 to return everything at once
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_set_resource_page_size(embed_mcp_server_t *server, size_t page_size);
+
+/**
+ * Resource cache counters
+ */
+typedef struct {
+    uint64_t hits;          // Reads served from the cache
+    uint64_t misses;        // Reads that had to load and encode the resource
+    uint64_t evictions;     // Entries dropped to stay within the size bound
+    size_t entries;         // Entries currently cached
+    size_t bytes;           // Encoded bytes currently cached
+    uint64_t coalesced;     // Reads that waited for an identical read in progress and shared its content
+} embed_mcp_cache_stats_t;
+
+/**
+ * Cache encoded resources/read responses (disabled by default)
+ * Static and file resources are cached right away - files are revalidated by
+ * mtime and size on every read. Function resources are only cached once they
+ * have a TTL, see embed_mcp_set_resource_cache_ttl().
+ * @param server Server instance
+ * @param max_bytes Upper bound on cached encoded content
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_enable_resource_cache(embed_mcp_server_t *server, size_t max_bytes);
+
+/**
+ * Let reads of a function resource be served from the cache for ttl_ms
+ * @param server Server instance
+ * @param uri URI of a registered resource
+ * @param ttl_ms Time to live in milliseconds, 0 to stop caching the resource
+ * @return 0 on success, -1 if the resource is not found
+ */
+int embed_mcp_set_resource_cache_ttl(embed_mcp_server_t *server, const char *uri, uint32_t ttl_ms);
+
+/**
+ * Get resource cache counters
+ * @param server Server instance
+ * @param stats Output statistics (all zero while the cache is disabled)
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_get_resource_cache_stats(embed_mcp_server_t *server, embed_mcp_cache_stats_t *stats);
+
+/**
+ * Report that a function resource's content has changed
+ * Clients subscribed with resources/subscribe are sent notifications/resources/updated
+ * once the resource has been read again and found to differ; its cached content is
+ * dropped. File resources are watched without this (inotify on Linux). Safe to call
+ * from any thread.
+ * @param server Server instance
+ * @param uri Resource URI
+ * @return 0 on success, -1 on error
+ */
+int embed_mcp_notify_resource_changed(embed_mcp_server_t *server, const char *uri);
+
 // =============================================================================
 // Resource Templates API
 // =============================================================================
@@ -821,6 +1394,8 @@ void mcp_file_resource_init(void);
 void mcp_file_resource_cleanup(void);
 int mcp_file_resource_handler(const mcp_resource_template_context_t *context,
                               mcp_resource_content_t *content);
+// Path the handler reads for uri (pointing into uri), or NULL if it would refuse it
+const char *mcp_file_resource_path(const char *uri);
 
 #ifdef __cplusplus
 }
@@ -61,6 +61,17 @@ static int custom_network_poll(int timeout_ms) {
     return 0; // 示例返回
 }
 
+static int custom_network_wakeup(void) {
+    // 这里可以使用：
+    // - 向轮询中的自唤醒管道/eventfd写入
+    // - RTOS的任务通知或信号量
+
+    // 示例伪代码：
+    // return custom_network_signal_poller();
+
+    return 0; // 示例返回
+}
+
 static int custom_http_server_stop(mcp_hal_server_t server) {
     mcp_log_info("Custom Platform: Stopping HTTP server");
     
@@ -159,8 +170,16 @@ static const mcp_platform_hal_t custom_platform_hal = {
         // HTTP服务器接口 - 使用自定义实现
         .http_server_start = custom_http_server_start,
         .http_response_send = custom_http_response_send,
+        .http_response_sendv = NULL,    // 可选：向量发送(头部/响应体分段，可转交缓冲区所有权)
         .network_poll = custom_network_poll,
+        .network_wakeup = custom_network_wakeup,
         .http_server_stop = custom_http_server_stop,
+        .http_stream_begin = NULL,  // 可选：分块(SSE)流式响应，NULL时只发送完整响应
+        .http_stream_write = NULL,
+        .http_stream_end = NULL,
+        .http_server_start_ex = NULL,   // 可选：每个服务器独立的事件循环(多线程轮询、SO_REUSEPORT)
+        .http_server_poll = NULL,
+        .http_server_wakeup = NULL,
         
         // 底层网络接口 - 用于不支持高级HTTP库的平台
         .socket_create = custom_socket_create,
@@ -11,6 +11,8 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include "utils/mem_budget.h"
 
 // 为了编译通过，这里使用模拟的FreeRTOS类型和函数
 // 在实际RTOS项目中，这些会被真正的FreeRTOS API替代
@@ -47,30 +49,53 @@ static void vSemaphoreDelete(SemaphoreHandle_t sem) { free(sem); }
 
 #define portTICK_PERIOD_MS 1
 
-// FreeRTOS内存管理
+// FreeRTOS内存管理 - 块前加一个记录大小的头部，用于预算统计(utils/mem_budget.h)和realloc
+typedef union {
+    size_t size;
+    void* align_ptr;
+    long long align_ll;
+    double align_d;
+} freertos_block_header_t;
+
 static void* freertos_mem_alloc(size_t size) {
-    return pvPortMalloc(size);
+    if (size > SIZE_MAX - sizeof(freertos_block_header_t)) return NULL;
+
+    freertos_block_header_t* header = pvPortMalloc(sizeof(freertos_block_header_t) + size);
+    if (!header) return NULL;
+    header->size = size;
+    mcp_mem_budget_charge(sizeof(freertos_block_header_t) + size);
+    return header + 1;
 }
 
 static void freertos_mem_free(void* ptr) {
-    vPortFree(ptr);
+    if (!ptr) return;
+
+    freertos_block_header_t* header = (freertos_block_header_t*)ptr - 1;
+    mcp_mem_budget_uncharge(sizeof(freertos_block_header_t) + header->size);
+    vPortFree(header);
 }
 
 static void* freertos_mem_realloc(void* ptr, size_t new_size) {
-    // FreeRTOS没有realloc，手动实现
-    if (!ptr) return pvPortMalloc(new_size);
-    
-    void* new_ptr = pvPortMalloc(new_size);
-    if (new_ptr && ptr) {
-        // 简化：假设新大小总是更大，实际需要记录原大小
-        memcpy(new_ptr, ptr, new_size);
-        vPortFree(ptr);
+    // FreeRTOS没有realloc，按头部记录的原大小复制
+    if (!ptr) return freertos_mem_alloc(new_size);
+    if (new_size == 0) {
+        freertos_mem_free(ptr);
+        return NULL;
+    }
+
+    size_t old_size = ((freertos_block_header_t*)ptr - 1)->size;
+    void* new_ptr = freertos_mem_alloc(new_size);
+    if (new_ptr) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+        freertos_mem_free(ptr);
     }
     return new_ptr;
 }
 
 static size_t freertos_mem_get_free_size(void) {
-    return xPortGetFreeHeapSize();
+    size_t heap = xPortGetFreeHeapSize();
+    size_t budget = mcp_mem_budget_available();
+    return budget < heap ? budget : heap;
 }
 
 // FreeRTOS任务管理
@@ -182,6 +207,7 @@ static void freertos_delay_us(uint32_t us) {
 }
 
 // FreeRTOS传输层（UART示例）
+// 字节级收发接口，服务器不经过这里；UART DMA 传输见 transport/uart_transport.h
 static int freertos_transport_init(mcp_hal_transport_type_t type, void* config) {
     if (type == MCP_HAL_TRANSPORT_UART) {
         // 初始化UART硬件
@@ -220,6 +246,54 @@ static bool freertos_transport_is_connected(void) {
 }
 
 // FreeRTOS平台初始化
+// FreeRTOS文件读取 - 没有mmap，整个文件读入堆内存
+typedef struct {
+    void* data;
+} freertos_file_view_t;
+
+static void* freertos_file_map(const char* path, const void** data, size_t* size) {
+    if (!path || !data || !size) return NULL;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    if (length < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    freertos_file_view_t* view = pvPortMalloc(sizeof(freertos_file_view_t));
+    if (!view) {
+        fclose(file);
+        return NULL;
+    }
+
+    view->data = pvPortMalloc((size_t)length + 1);
+    if (!view->data || fread(view->data, 1, (size_t)length, file) != (size_t)length) {
+        if (view->data) vPortFree(view->data);
+        vPortFree(view);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+
+    *data = view->data;
+    *size = (size_t)length;
+    return view;
+}
+
+static void freertos_file_unmap(void* handle) {
+    freertos_file_view_t* view = (freertos_file_view_t*)handle;
+    if (!view) return;
+
+    vPortFree(view->data);
+    vPortFree(view);
+}
+
 static int freertos_platform_init(void) {
     return 0;
 }
@@ -273,6 +347,11 @@ static const mcp_platform_hal_t freertos_hal = {
         .delay_us = freertos_delay_us
     },
     
+    .file = {
+        .map = freertos_file_map,
+        .unmap = freertos_file_unmap
+    },
+    
     .transport = {
         .init = freertos_transport_init,
         .send = freertos_transport_send,
@@ -7,36 +7,150 @@
 #include <pthread.h>
 #include <unistd.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <poll.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <netinet/in.h>
 #include <stdio.h>
 #include <string.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+#include "utils/mem_budget.h"
 
 // Mongoose HAL实现 - mongoose就是我们的跨平台HAL层
 // mongoose内部支持Linux/FreeRTOS/ESP32等15+平台，我们只需要封装统一接口
 #include "../platform/linux/mongoose.h"
+#include "../platform/linux/linux_uring_http.h"
 
-// 全局mongoose管理器 - 这就是我们的HAL核心
-static struct mg_mgr g_mongoose_mgr;
-static bool g_mongoose_initialized = false;
+// 跨线程响应队列 - mongoose不是线程安全的，工作线程产生的响应
+// 先入队，由事件循环的轮询线程在mg_mgr_poll()之后统一发送
+// 头部(以及调用者不转交所有权时的响应体)复制到节点的缓冲区里；发送后节点连同缓冲区
+// 放回空闲链表复用
+typedef enum {
+    HAL_REPLY_FULL,             // 完整响应(Content-Length)
+    HAL_REPLY_STREAM_BEGIN,     // 分块响应的状态行和头部(可带第一块)
+    HAL_REPLY_STREAM_CHUNK,     // 一个数据块
+    HAL_REPLY_STREAM_END        // 结束块
+} hal_reply_op_t;
+
+typedef struct hal_pending_reply {
+    unsigned long conn_id;
+    hal_reply_op_t op;
+    int status_code;
+    char* buffer;
+    size_t capacity;
+    mcp_hal_iovec_t headers[MCP_HAL_IOV_MAX];  // 指向buffer
+    size_t header_count;
+    mcp_hal_iovec_t body[MCP_HAL_IOV_MAX];     // 指向buffer或owner的内存
+    size_t body_count;
+    void (*release)(void* owner);
+    void* owner;
+    struct hal_pending_reply* next;
+} hal_pending_reply_t;
+
+// 空闲节点上限，以及超过该大小的缓冲区不保留
+#define HAL_REPLY_POOL_MAX 16
+#define HAL_REPLY_POOL_BUFFER_MAX (64 * 1024)
+
+// 空闲节点链表由所有事件循环共用
+static pthread_mutex_t g_reply_mutex = PTHREAD_MUTEX_INITIALIZER;
+static hal_pending_reply_t* g_reply_free = NULL;
+static size_t g_reply_free_count = 0;
+
+// 事件循环 - 每个HTTP服务器一个mongoose管理器，各自的响应队列和轮询线程。
+// 不同线程上的事件循环互不共享状态，监听同一端口时由内核(SO_REUSEPORT)分配连接
+#define HAL_LOOP_MAX 16
+
+// 连接句柄的高4位是事件循环编号，其余位是mongoose连接ID
+#define HAL_LOOP_SHIFT (sizeof(uintptr_t) * 8 - 4)
+#define HAL_CONN_ID_MASK (((uintptr_t)1 << HAL_LOOP_SHIFT) - 1)
+
+typedef struct {
+    bool in_use;                // 原子读写，发送方可能在任意线程
+    bool mutex_ready;
+    struct mg_mgr mgr;
+    struct mg_connection* listener;
+    void* user_data;            // 服务器的user_data
+
+    pthread_mutex_t reply_mutex;
+    hal_pending_reply_t* reply_head;
+    hal_pending_reply_t* reply_tail;
+
+    // 连接关闭通知 - 连接槽存放在mongoose连接的data字段中
+    mcp_hal_http_close_handler_t close_handler;
+    pthread_t poll_thread;
+    bool poll_thread_known;
+
+    // 唤醒目标 - mg_wakeup()需要一个有效的连接ID，使用监听连接
+    unsigned long wakeup_conn_id;
+} hal_loop_t;
+
+static pthread_mutex_t g_loops_mutex = PTHREAD_MUTEX_INITIALIZER;
+static hal_loop_t g_loops[HAL_LOOP_MAX];
+static int g_default_loop = -1;     // network_poll()/network_wakeup()驱动的循环，原子读写
+
+// 内存按块的实际可用大小计入预算(utils/mem_budget.h)，不加块头：
+// 误用free()释放的HAL块只会让统计偏高，不会破坏堆
+#if defined(__GLIBC__)
+#define HAL_BLOCK_SIZE(ptr) malloc_usable_size(ptr)
+#elif defined(__APPLE__)
+#define HAL_BLOCK_SIZE(ptr) malloc_size(ptr)
+#else
+#define HAL_BLOCK_SIZE(ptr) ((size_t)0)
+#endif
 
-// Linux内存管理
 static void* linux_mem_alloc(size_t size) {
-    return malloc(size);
+    void* ptr = malloc(size);
+    if (ptr) {
+        mcp_mem_budget_charge(HAL_BLOCK_SIZE(ptr));
+    }
+    return ptr;
 }
 
 static void linux_mem_free(void* ptr) {
+    if (!ptr) return;
+    mcp_mem_budget_uncharge(HAL_BLOCK_SIZE(ptr));
     free(ptr);
 }
 
 static void* linux_mem_realloc(void* ptr, size_t new_size) {
-    return realloc(ptr, new_size);
+    size_t old_size = ptr ? HAL_BLOCK_SIZE(ptr) : 0;
+    void* new_ptr = realloc(ptr, new_size);
+    if (new_ptr) {
+        mcp_mem_budget_uncharge(old_size);
+        mcp_mem_budget_charge(HAL_BLOCK_SIZE(new_ptr));
+    } else if (new_size == 0 && ptr) {
+        mcp_mem_budget_uncharge(old_size);
+    }
+    return new_ptr;
 }
 
 static size_t linux_mem_get_free_size(void) {
-    // 简化实现，实际可以读取/proc/meminfo
-    return 1024 * 1024; // 返回1MB作为示例
+    // 配置了全局预算时返回预算余量，否则读取系统可用内存
+    size_t available = mcp_mem_budget_available();
+    if (available != SIZE_MAX) return available;
+
+#ifdef _SC_AVPHYS_PAGES
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0) {
+        return (size_t)pages * (size_t)page_size;
+    }
+#endif
+    return 1024 * 1024;
 }
 
 // Linux线程管理
@@ -114,16 +228,17 @@ static int linux_mutex_destroy(void* mutex) {
 }
 
 // Linux时间函数
+// 单调时钟，不受系统时间调整影响（用于计时和超时）
 static uint32_t linux_get_tick_ms(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint32_t)(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
 }
 
 static uint64_t linux_get_time_us(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint64_t)(tv.tv_sec * 1000000 + tv.tv_usec);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
 }
 
 static void linux_delay_ms(uint32_t ms) {
@@ -135,20 +250,241 @@ static void linux_delay_us(uint32_t us) {
 }
 
 // mongoose事件处理器 - 将mongoose事件转换为HAL回调
+static void* hal_connection_slot(const struct mg_connection *c) {
+    void* slot;
+    memcpy(&slot, c->data, sizeof(slot));  // data是char数组，不保证指针对齐
+    return slot;
+}
+
+static void hal_set_connection_slot(struct mg_connection *c, void* slot) {
+    memcpy(c->data, &slot, sizeof(slot));
+}
+
+// mongoose的状态文本表是私有的，这里只列出本项目用到的状态码
+static const char* hal_status_text(int status_code) {
+    switch (status_code) {
+        case 200: return "OK";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "";
+    }
+}
+
+// 固定的头部片段，长度在编译期确定
+#define HAL_LITERAL(text) { text, sizeof(text) - 1 }
+static const mcp_hal_iovec_t g_default_headers = HAL_LITERAL("Content-Type: application/json\r\n");
+
+// 一次写出的所有片段：状态行、头部、长度/分块标记、响应体、结尾
+#define HAL_WRITE_IOV_MAX (2 * MCP_HAL_IOV_MAX + 4)
+
+typedef struct {
+    struct iovec iov[HAL_WRITE_IOV_MAX];
+    size_t count;
+    char status_line[64];
+    char length_line[48];
+} hal_write_t;
+
+static void hal_write_add(hal_write_t* w, const void* data, size_t len) {
+    if (len > 0 && w->count < HAL_WRITE_IOV_MAX) {
+        w->iov[w->count].iov_base = (void*)data;
+        w->iov[w->count].iov_len = len;
+        w->count++;
+    }
+}
+
+// 数字格式化不经过printf
+static size_t hal_format_number(char* out, size_t value, unsigned base) {
+    char digits[24];
+    size_t n = 0;
+    do {
+        digits[n++] = "0123456789abcdef"[value % base];
+        value /= base;
+    } while (value > 0);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = digits[n - 1 - i];
+    }
+    return n;
+}
+
+static size_t hal_format_line(char* out, const char* prefix, size_t value, unsigned base, const char* suffix) {
+    size_t len = strlen(prefix);
+    memcpy(out, prefix, len);
+    len += hal_format_number(out + len, value, base);
+    size_t suffix_len = strlen(suffix);
+    memcpy(out + len, suffix, suffix_len);
+    return len + suffix_len;
+}
+
+static void hal_write_status(hal_write_t* w, int status_code) {
+    const char* text = hal_status_text(status_code);
+    size_t len = hal_format_line(w->status_line, "HTTP/1.1 ", (size_t)(status_code > 0 ? status_code : 500), 10, " ");
+    size_t text_len = strlen(text);
+    memcpy(w->status_line + len, text, text_len);
+    memcpy(w->status_line + len + text_len, "\r\n", 2);
+    hal_write_add(w, w->status_line, len + text_len + 2);
+}
+
+// 先直接写socket(发送缓冲区为空时)，写不完的部分交给mongoose的发送缓冲区
+static void hal_connection_writev(struct mg_connection* c, const struct iovec* iov, size_t count) {
+    size_t sent = 0;
+    if (c->send.len == 0 && !c->is_tls) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = (struct iovec*)iov;
+        msg.msg_iovlen = count;
+        ssize_t n = sendmsg((int)(size_t)c->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            sent = (size_t)n;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (sent >= iov[i].iov_len) {
+            sent -= iov[i].iov_len;
+            continue;
+        }
+        mg_send(c, (const char*)iov[i].iov_base + sent, iov[i].iov_len - sent);
+        sent = 0;
+    }
+}
+
+// 写出一个响应或分块，头部和响应体不经过printf，也不先拼接到一起
+static void hal_write_parts(struct mg_connection* c, hal_reply_op_t op, int status_code,
+                            const mcp_hal_iovec_t* headers, size_t header_count,
+                            const mcp_hal_iovec_t* body, size_t body_count) {
+    hal_write_t w;
+    w.count = 0;
+
+    size_t body_len = 0;
+    for (size_t i = 0; i < body_count; i++) {
+        body_len += body[i].len;
+    }
+
+    if (op == HAL_REPLY_FULL || op == HAL_REPLY_STREAM_BEGIN) {
+        hal_write_status(&w, status_code);
+        if (header_count == 0) {
+            headers = &g_default_headers;
+            header_count = 1;
+        }
+        for (size_t i = 0; i < header_count; i++) {
+            hal_write_add(&w, headers[i].data, headers[i].len);
+        }
+    }
+
+    switch (op) {
+        case HAL_REPLY_FULL:
+            hal_write_add(&w, w.length_line,
+                          hal_format_line(w.length_line, "Content-Length: ", body_len, 10, "\r\n\r\n"));
+            break;
+        case HAL_REPLY_STREAM_BEGIN:
+            hal_write_add(&w, "Transfer-Encoding: chunked\r\n\r\n", 30);
+            if (body_len > 0) {
+                hal_write_add(&w, w.length_line, hal_format_line(w.length_line, "", body_len, 16, "\r\n"));
+            }
+            break;
+        case HAL_REPLY_STREAM_CHUNK:
+            hal_write_add(&w, w.length_line, hal_format_line(w.length_line, "", body_len, 16, "\r\n"));
+            break;
+        case HAL_REPLY_STREAM_END:
+            hal_write_add(&w, "0\r\n\r\n", 5);
+            break;
+    }
+
+    for (size_t i = 0; i < body_count; i++) {
+        hal_write_add(&w, body[i].data, body[i].len);
+    }
+    if ((op == HAL_REPLY_STREAM_BEGIN || op == HAL_REPLY_STREAM_CHUNK) && body_len > 0) {
+        hal_write_add(&w, "\r\n", 2);
+    }
+
+    hal_connection_writev(c, w.iov, w.count);
+
+    // 响应结束，mongoose可以处理该连接上的下一个请求；分块响应期间is_resp保持置位
+    if (op == HAL_REPLY_FULL || op == HAL_REPLY_STREAM_END) {
+        c->is_resp = 0;
+    }
+}
+
+// 处理器同步返回的响应
+static void hal_write_reply(struct mg_connection *c, const mcp_hal_http_response_t* response) {
+    mcp_hal_iovec_t headers = { response->headers, response->headers ? strlen(response->headers) : 0 };
+    mcp_hal_iovec_t body = { response->body, response->body ? response->body_len : 0 };
+    hal_write_parts(c, HAL_REPLY_FULL, response->status_code, &headers, response->headers ? 1 : 0, &body, 1);
+}
+
+// 复制请求头为C字符串(过长时截断)，没有该请求头时返回NULL
+static const char* hal_copy_header(struct mg_http_message *hm, const char* name, char* buffer, size_t size) {
+    struct mg_str* header = mg_http_get_header(hm, name);
+    if (!header) {
+        return NULL;
+    }
+    size_t len = header->len < size - 1 ? header->len : size - 1;
+    memcpy(buffer, header->buf, len);
+    buffer[len] = '\0';
+    return buffer;
+}
+
+static mcp_hal_connection_t hal_make_handle(const hal_loop_t* loop, unsigned long conn_id) {
+    uintptr_t index = (uintptr_t)(loop - g_loops);
+    return (mcp_hal_connection_t)((index << HAL_LOOP_SHIFT) | ((uintptr_t)conn_id & HAL_CONN_ID_MASK));
+}
+
 static void hal_mongoose_event_handler(struct mg_connection *c, int ev, void *ev_data) {
+    hal_loop_t* loop = (hal_loop_t*)c->mgr->userdata;
+
+    if (ev == MG_EV_CLOSE) {
+        void* slot = hal_connection_slot(c);
+        if (slot && loop->close_handler) {
+            hal_set_connection_slot(c, NULL);
+            loop->close_handler(slot, loop->user_data);
+        }
+        return;
+    }
+
     if (ev == MG_EV_HTTP_MSG) {
         struct mg_http_message *hm = (struct mg_http_message *)ev_data;
         mcp_hal_http_handler_t handler = (mcp_hal_http_handler_t)c->fn_data;
-        void* user_data = c->mgr->userdata;
+        void* user_data = loop->user_data;
 
         if (handler) {
+            // mongoose的字符串不以NUL结尾，复制方法和路径(过长时截断，不会误匹配)
+            char method[16];
+            char uri[256];
+            size_t method_len = hm->method.len < sizeof(method) - 1 ? hm->method.len : sizeof(method) - 1;
+            size_t uri_len = hm->uri.len < sizeof(uri) - 1 ? hm->uri.len : sizeof(uri) - 1;
+            memcpy(method, hm->method.buf, method_len);
+            method[method_len] = '\0';
+            memcpy(uri, hm->uri.buf, uri_len);
+            uri[uri_len] = '\0';
+
+            char accept[256];
+            char accept_encoding[128];
+            char session_id[160];
+
+            // keep-alive连接的后续请求拿回同一个连接槽
+            void* slot = hal_connection_slot(c);
+
             // 转换mongoose请求到HAL请求
             mcp_hal_http_request_t hal_req = {
-                .method = "POST",  // 简化处理，假设都是POST
-                .uri = "/mcp",     // 简化处理，假设都是/mcp
+                .method = method,
+                .uri = uri,
                 .body = hm->body.buf,
                 .body_len = hm->body.len,
-                .connection = (mcp_hal_connection_t)c
+                .accept = hal_copy_header(hm, "Accept", accept, sizeof(accept)),
+                .accept_encoding = hal_copy_header(hm, "Accept-Encoding", accept_encoding, sizeof(accept_encoding)),
+                .session_id = hal_copy_header(hm, "Mcp-Session-Id", session_id, sizeof(session_id)),
+                // 连接句柄使用事件循环编号和mongoose连接ID而非指针，跨线程持有时连接关闭也不会悬空
+                .connection = hal_make_handle(loop, c->id),
+                .connection_data = loop->close_handler ? &slot : NULL
             };
 
             // 创建HAL响应
@@ -156,69 +492,710 @@ static void hal_mongoose_event_handler(struct mg_connection *c, int ev, void *ev
 
             // 调用HAL处理器
             handler(&hal_req, &hal_resp, user_data);
+            hal_set_connection_slot(c, slot);
 
             // 发送响应
             if (hal_resp.status_code > 0) {
-                mg_http_reply(c, hal_resp.status_code,
-                             hal_resp.headers ? hal_resp.headers : "Content-Type: application/json\r\n",
-                             "%.*s", (int)hal_resp.body_len, hal_resp.body ? hal_resp.body : "");
+                hal_write_reply(c, &hal_resp);
             }
         }
     }
 }
 
+// mongoose的HTTP协议处理函数是静态的，只能从mg_http_listen()创建的连接上取得。
+// 用一个临时的本机UDP监听连接取一次(不接收任何数据)，之后立即关闭
+static mg_event_handler_t hal_http_protocol_handler(struct mg_mgr* mgr) {
+    static mg_event_handler_t handler = NULL;
+    if (!handler) {
+        struct mg_connection* probe = mg_http_listen(mgr, "udp://127.0.0.1:0", NULL, NULL);
+        if (probe) {
+            handler = probe->pfn;
+            probe->is_closing = 1;
+        }
+    }
+    return handler;
+}
+
+// SO_REUSEPORT监听 - mongoose的监听器只设置SO_REUSEADDR，这里自己创建socket再交给mongoose
+static struct mg_connection* hal_listen_reuse_port(struct mg_mgr* mgr, const char* url) {
+    struct mg_addr addr;
+    memset(&addr, 0, sizeof(addr));
+    if (!mg_aton(mg_url_host(url), &addr)) {
+        return NULL;
+    }
+    addr.port = mg_htons(mg_url_port(url));
+
+    union {
+        struct sockaddr sa;
+        struct sockaddr_in sin;
+        struct sockaddr_in6 sin6;
+    } usa;
+    memset(&usa, 0, sizeof(usa));
+    socklen_t slen;
+    if (addr.is_ip6) {
+        usa.sin6.sin6_family = AF_INET6;
+        usa.sin6.sin6_port = addr.port;
+        memcpy(&usa.sin6.sin6_addr, addr.ip, 16);
+        slen = sizeof(usa.sin6);
+    } else {
+        usa.sin.sin_family = AF_INET;
+        usa.sin.sin_port = addr.port;
+        memcpy(&usa.sin.sin_addr, addr.ip, 4);
+        slen = sizeof(usa.sin);
+    }
+
+    mg_event_handler_t http_handler = hal_http_protocol_handler(mgr);
+    int fd = socket(usa.sa.sa_family, SOCK_STREAM, IPPROTO_TCP);
+    if (!http_handler || fd < 0) {
+        return NULL;
+    }
+
+    int on = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0 ||
+        (addr.is_ip6 && setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on)) != 0) ||
+        bind(fd, &usa.sa, slen) != 0 ||
+        listen(fd, MG_SOCK_LISTEN_BACKLOG_SIZE) != 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    struct mg_connection* conn = mg_wrapfd(mgr, fd, hal_mongoose_event_handler, NULL);
+    if (!conn) {
+        close(fd);
+        return NULL;
+    }
+    // 与mg_http_listen()创建的监听连接相同：接受的连接继承协议处理函数
+    conn->is_listening = 1;
+    conn->loc = addr;
+    conn->pfn = http_handler;
+    return conn;
+}
+
 // HAL网络接口实现 - 基于mongoose
-static mcp_hal_server_t linux_hal_http_listen(const char* url, mcp_hal_http_handler_t handler, void* user_data) {
-    if (!g_mongoose_initialized) {
-        mg_mgr_init(&g_mongoose_mgr);
-        g_mongoose_initialized = true;
+static mcp_hal_server_t linux_hal_http_listen_ex(const char* url, unsigned int flags,
+                                                 mcp_hal_http_handler_t handler, void* user_data) {
+    pthread_mutex_lock(&g_loops_mutex);
+    hal_loop_t* loop = NULL;
+    for (size_t i = 0; i < HAL_LOOP_MAX; i++) {
+        if (!__atomic_load_n(&g_loops[i].in_use, __ATOMIC_ACQUIRE)) {
+            loop = &g_loops[i];
+            break;
+        }
+    }
+    if (!loop) {
+        pthread_mutex_unlock(&g_loops_mutex);
+        return NULL;
+    }
+
+    // 槽位的互斥锁只初始化一次，停止后仍可能有发送方短暂访问
+    if (!loop->mutex_ready) {
+        pthread_mutex_init(&loop->reply_mutex, NULL);
+        loop->mutex_ready = true;
+    }
+
+    mg_mgr_init(&loop->mgr);
+    // mongoose内部的socketpair就是轮询的自唤醒管道
+    if (!mg_wakeup_init(&loop->mgr)) {
+        mg_mgr_free(&loop->mgr);
+        pthread_mutex_unlock(&g_loops_mutex);
+        return NULL;
     }
+    loop->mgr.userdata = loop;
 
     // 创建HTTP监听器，使用mongoose
-    struct mg_connection* conn = mg_http_listen(&g_mongoose_mgr, url, hal_mongoose_event_handler, NULL);
+    struct mg_connection* conn = (flags & MCP_HAL_SERVER_REUSE_PORT)
+        ? hal_listen_reuse_port(&loop->mgr, url)
+        : mg_http_listen(&loop->mgr, url, hal_mongoose_event_handler, NULL);
     if (!conn) {
+        mg_mgr_free(&loop->mgr);
+        pthread_mutex_unlock(&g_loops_mutex);
         return NULL;
     }
 
     // 保存用户回调和数据
     conn->fn_data = handler;
-    conn->mgr->userdata = user_data;
+    loop->listener = conn;
+    loop->user_data = user_data;
+    loop->close_handler = NULL;
+    loop->poll_thread_known = false;
+    loop->reply_head = loop->reply_tail = NULL;
+    loop->wakeup_conn_id = conn->id;
+    __atomic_store_n(&loop->in_use, true, __ATOMIC_RELEASE);
+
+    int index = (int)(loop - g_loops);
+    int none = -1;
+    __atomic_compare_exchange_n(&g_default_loop, &none, index, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_loops_mutex);
 
-    return (mcp_hal_server_t)conn;
+    return (mcp_hal_server_t)loop;
+}
+
+static mcp_hal_server_t linux_hal_http_listen(const char* url, mcp_hal_http_handler_t handler, void* user_data) {
+    return linux_hal_http_listen_ex(url, 0, handler, user_data);
+}
+
+// 连接句柄所属的事件循环，服务器已停止时返回NULL
+static hal_loop_t* hal_handle_loop(mcp_hal_connection_t conn, unsigned long* conn_id) {
+    uintptr_t handle = (uintptr_t)conn;
+    hal_loop_t* loop = &g_loops[handle >> HAL_LOOP_SHIFT];
+    *conn_id = (unsigned long)(handle & HAL_CONN_ID_MASK);
+    if (*conn_id == 0 || !__atomic_load_n(&loop->in_use, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    return loop;
+}
+
+static hal_loop_t* hal_default_loop(void) {
+    int index = __atomic_load_n(&g_default_loop, __ATOMIC_ACQUIRE);
+    if (index < 0 || !__atomic_load_n(&g_loops[index].in_use, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    return &g_loops[index];
+}
+
+// 根据连接ID查找mongoose连接，连接已关闭时返回NULL
+static struct mg_connection* hal_find_connection(hal_loop_t* loop, unsigned long conn_id) {
+    for (struct mg_connection* c = loop->mgr.conns; c != NULL; c = c->next) {
+        if ((c->id & HAL_CONN_ID_MASK) == conn_id) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+static bool hal_on_poll_thread(const hal_loop_t* loop) {
+    return loop->poll_thread_known && pthread_equal(pthread_self(), loop->poll_thread);
+}
+
+static void hal_release_reply(hal_pending_reply_t* reply) {
+    if (reply->release) {
+        reply->release(reply->owner);
+        reply->release = NULL;
+        reply->owner = NULL;
+    }
+
+    pthread_mutex_lock(&g_reply_mutex);
+    if (g_reply_free_count < HAL_REPLY_POOL_MAX && reply->capacity <= HAL_REPLY_POOL_BUFFER_MAX) {
+        reply->next = g_reply_free;
+        g_reply_free = reply;
+        g_reply_free_count++;
+        reply = NULL;
+    }
+    pthread_mutex_unlock(&g_reply_mutex);
+
+    if (reply) {
+        free(reply->buffer);
+        free(reply);
+    }
+}
+
+static size_t hal_iov_length(const mcp_hal_iovec_t* iov, size_t count) {
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++) {
+        len += iov[i].len;
+    }
+    return len;
+}
+
+static int hal_queue_reply(hal_loop_t* loop, unsigned long conn_id, hal_reply_op_t op,
+                           const mcp_hal_http_responsev_t* response) {
+    bool copy_body = response->release == NULL;
+    size_t headers_len = hal_iov_length(response->headers, response->header_count);
+    size_t body_len = hal_iov_length(response->body, response->body_count);
+    size_t needed = headers_len + (copy_body ? body_len : 0) + 1;
+
+    pthread_mutex_lock(&g_reply_mutex);
+    hal_pending_reply_t* reply = g_reply_free;
+    if (reply) {
+        g_reply_free = reply->next;
+        g_reply_free_count--;
+    }
+    pthread_mutex_unlock(&g_reply_mutex);
+
+    if (!reply) {
+        reply = calloc(1, sizeof(hal_pending_reply_t));
+        if (!reply) {
+            if (response->release) response->release(response->owner);
+            return -1;
+        }
+    }
+    reply->release = response->release;
+    reply->owner = response->owner;
+
+    if (reply->capacity < needed) {
+        char* buffer = realloc(reply->buffer, needed);
+        if (!buffer) {
+            hal_release_reply(reply);
+            return -1;
+        }
+        reply->buffer = buffer;
+        reply->capacity = needed;
+    }
+
+    reply->conn_id = conn_id;
+    reply->op = op;
+    reply->status_code = response->status_code;
+
+    // 头部合并为一段复制；响应体按片段复制，转交所有权时直接引用
+    char* cursor = reply->buffer;
+    reply->header_count = 0;
+    if (response->header_count > 0) {
+        reply->headers[0].data = cursor;
+        reply->headers[0].len = headers_len;
+        reply->header_count = 1;
+        for (size_t i = 0; i < response->header_count; i++) {
+            memcpy(cursor, response->headers[i].data, response->headers[i].len);
+            cursor += response->headers[i].len;
+        }
+    }
+    reply->body_count = 0;
+    for (size_t i = 0; i < response->body_count; i++) {
+        if (copy_body) {
+            memcpy(cursor, response->body[i].data, response->body[i].len);
+            reply->body[i].data = cursor;
+            cursor += response->body[i].len;
+        } else {
+            reply->body[i].data = response->body[i].data;
+        }
+        reply->body[i].len = response->body[i].len;
+        reply->body_count++;
+    }
+    reply->next = NULL;
+
+    pthread_mutex_lock(&loop->reply_mutex);
+    if (loop->reply_tail) {
+        loop->reply_tail->next = reply;
+    } else {
+        loop->reply_head = reply;
+    }
+    loop->reply_tail = reply;
+    pthread_mutex_unlock(&loop->reply_mutex);
+
+    // 唤醒阻塞中的轮询线程立即发送
+    mg_wakeup(&loop->mgr, loop->wakeup_conn_id, "", 0);
+
+    return (int)body_len;
+}
+
+static int hal_send_reply_now(hal_loop_t* loop, unsigned long conn_id, hal_reply_op_t op, int status_code,
+                              const mcp_hal_iovec_t* headers, size_t header_count,
+                              const mcp_hal_iovec_t* body, size_t body_count) {
+    struct mg_connection* c = hal_find_connection(loop, conn_id);
+    if (!c || c->is_closing) {
+        return -1;  // 客户端已断开
+    }
+
+    hal_write_parts(c, op, status_code, headers, header_count, body, body_count);
+    return (int)hal_iov_length(body, body_count);
+}
+
+// 在轮询线程上发送所有排队的响应
+static void hal_flush_pending_replies(hal_loop_t* loop) {
+    pthread_mutex_lock(&loop->reply_mutex);
+    hal_pending_reply_t* reply = loop->reply_head;
+    loop->reply_head = loop->reply_tail = NULL;
+    pthread_mutex_unlock(&loop->reply_mutex);
+
+    while (reply) {
+        hal_pending_reply_t* next = reply->next;
+        hal_send_reply_now(loop, reply->conn_id, reply->op, reply->status_code,
+                           reply->headers, reply->header_count, reply->body, reply->body_count);
+        hal_release_reply(reply);
+        reply = next;
+    }
+}
+
+static int hal_send_reply(mcp_hal_connection_t conn, hal_reply_op_t op, const mcp_hal_http_responsev_t* response) {
+    unsigned long conn_id = 0;
+    hal_loop_t* loop = hal_handle_loop(conn, &conn_id);
+    if (!loop || !response || response->header_count > MCP_HAL_IOV_MAX ||
+        response->body_count > MCP_HAL_IOV_MAX) {
+        if (response && response->release) response->release(response->owner);
+        return -1;
+    }
+
+    // 非本循环的轮询线程(例如工作线程)不能直接操作mongoose，排队等待轮询线程发送
+    if (!hal_on_poll_thread(loop)) {
+        return hal_queue_reply(loop, conn_id, op, response);
+    }
+
+    // 先发出已排队的部分，同一响应的各个分块保持发送顺序
+    hal_flush_pending_replies(loop);
+    int result = hal_send_reply_now(loop, conn_id, op, response->status_code, response->headers,
+                                    response->header_count, response->body, response->body_count);
+    // 数据已写入socket或mongoose的发送缓冲区
+    if (response->release) {
+        response->release(response->owner);
+    }
+    return result;
+}
+
+static int hal_send_plain(mcp_hal_connection_t conn, hal_reply_op_t op, const mcp_hal_http_response_t* response) {
+    if (!response) {
+        return -1;
+    }
+    mcp_hal_iovec_t headers = { response->headers, response->headers ? strlen(response->headers) : 0 };
+    mcp_hal_iovec_t body = { response->body, response->body ? response->body_len : 0 };
+    mcp_hal_http_responsev_t vectored = {
+        .status_code = response->status_code,
+        .headers = &headers,
+        .header_count = response->headers ? 1 : 0,
+        .body = &body,
+        .body_count = 1
+    };
+    return hal_send_reply(conn, op, &vectored);
 }
 
 static int linux_hal_http_reply(mcp_hal_connection_t conn, const mcp_hal_http_response_t* response) {
-    struct mg_connection* c = (struct mg_connection*)conn;
-    if (!c || !response) {
+    return hal_send_plain(conn, HAL_REPLY_FULL, response);
+}
+
+static int linux_hal_http_replyv(mcp_hal_connection_t conn, const mcp_hal_http_responsev_t* response) {
+    return hal_send_reply(conn, HAL_REPLY_FULL, response);
+}
+
+static int linux_hal_http_stream_begin(mcp_hal_connection_t conn, const mcp_hal_http_response_t* response) {
+    return hal_send_plain(conn, HAL_REPLY_STREAM_BEGIN, response);
+}
+
+static int linux_hal_http_stream_write(mcp_hal_connection_t conn, const char* data, size_t len) {
+    if (!data || len == 0) {
+        return -1;  // 空块表示结束，只能由http_stream_end发送
+    }
+    mcp_hal_http_response_t chunk = { .body = data, .body_len = len };
+    return hal_send_plain(conn, HAL_REPLY_STREAM_CHUNK, &chunk);
+}
+
+static int linux_hal_http_stream_end(mcp_hal_connection_t conn) {
+    mcp_hal_http_response_t end = { .body = "", .body_len = 0 };
+    return hal_send_plain(conn, HAL_REPLY_STREAM_END, &end);
+}
+
+static int hal_loop_poll(hal_loop_t* loop, int timeout_ms) {
+    if (!loop || !__atomic_load_n(&loop->in_use, __ATOMIC_ACQUIRE)) {
         return -1;
     }
 
-    mg_http_reply(c, response->status_code,
-                 response->headers ? response->headers : "Content-Type: application/json\r\n",
-                 "%.*s", (int)response->body_len, response->body ? response->body : "");
+    loop->poll_thread = pthread_self();
+    loop->poll_thread_known = true;
 
-    return (int)response->body_len;
+    mg_mgr_poll(&loop->mgr, timeout_ms);
+    hal_flush_pending_replies(loop);
+    return 0;
+}
+
+// 只调用send()，可在信号处理函数中使用
+static int hal_loop_wakeup(hal_loop_t* loop) {
+    if (!loop || !__atomic_load_n(&loop->in_use, __ATOMIC_ACQUIRE) || loop->wakeup_conn_id == 0) {
+        return -1;
+    }
+
+    return mg_wakeup(&loop->mgr, loop->wakeup_conn_id, "", 0) ? 0 : -1;
 }
 
 static int linux_hal_poll(int timeout_ms) {
-    if (!g_mongoose_initialized) {
+    return hal_loop_poll(hal_default_loop(), timeout_ms);
+}
+
+static int linux_hal_wakeup(void) {
+    return hal_loop_wakeup(hal_default_loop());
+}
+
+static int linux_hal_server_poll(mcp_hal_server_t server, int timeout_ms) {
+    return hal_loop_poll((hal_loop_t*)server, timeout_ms);
+}
+
+static int linux_hal_server_wakeup(mcp_hal_server_t server) {
+    return hal_loop_wakeup((hal_loop_t*)server);
+}
+
+// 在轮询该服务器的线程上调用(或该线程已不再轮询时)
+static int linux_hal_server_stop(mcp_hal_server_t server) {
+    hal_loop_t* loop = (hal_loop_t*)server;
+    if (!loop || !__atomic_load_n(&loop->in_use, __ATOMIC_ACQUIRE)) {
         return -1;
     }
 
-    mg_mgr_poll(&g_mongoose_mgr, timeout_ms);
+    loop->listener->is_closing = 1;
+
+    // 客户端连接一并关闭，连接槽的所有者(传输层)此后可能已不存在
+    for (struct mg_connection* c = loop->mgr.conns; c != NULL; c = c->next) {
+        if (c->is_accepted && c->fn == hal_mongoose_event_handler) {
+            hal_set_connection_slot(c, NULL);
+            c->is_draining = 1;    // 已排队的响应发完再关闭
+        }
+    }
+
+    // 发出已排队的响应后释放整个事件循环
+    hal_flush_pending_replies(loop);
+    mg_mgr_poll(&loop->mgr, 0);
+
+    pthread_mutex_lock(&g_loops_mutex);
+    __atomic_store_n(&loop->in_use, false, __ATOMIC_RELEASE);
+    int index = (int)(loop - g_loops);
+    __atomic_compare_exchange_n(&g_default_loop, &index, -1, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_loops_mutex);
+
+    mg_mgr_free(&loop->mgr);
+    loop->listener = NULL;
+
+    // 停止后才到达的响应已无处可发
+    pthread_mutex_lock(&loop->reply_mutex);
+    hal_pending_reply_t* reply = loop->reply_head;
+    loop->reply_head = loop->reply_tail = NULL;
+    pthread_mutex_unlock(&loop->reply_mutex);
+    while (reply) {
+        hal_pending_reply_t* next = reply->next;
+        hal_release_reply(reply);
+        reply = next;
+    }
     return 0;
 }
 
-static int linux_hal_server_stop(mcp_hal_server_t server) {
-    struct mg_connection* conn = (struct mg_connection*)server;
-    if (conn) {
-        conn->is_closing = 1;
+static int linux_hal_server_set_close_handler(mcp_hal_server_t server, mcp_hal_http_close_handler_t handler) {
+    if (!server) {
+        return -1;
     }
+    ((hal_loop_t*)server)->close_handler = handler;
     return 0;
 }
 
 // 注意：传输清理现在由传输层直接处理
 
+// 文件视图 - 不可变文件(chattr +i)以只读mmap提供，页面直接交给响应写出，不经过堆拷贝；
+// 其他文件用pread复制到堆上。日志等文件可能被原地截断或轮转，截断后访问映射页会触发
+// SIGBUS并终止整个服务器，而编码响应时直接读取这些页面，所以只映射内核保证不会变化的文件。
+// 同一文件(设备/inode/大小/修改时间均相同)的并发读取共享一个视图
+typedef struct hal_file_view {
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    void* data;
+    bool mapped;                // data是映射(否则是堆上的副本)
+    size_t ref_count;
+    struct hal_file_view* next;
+} hal_file_view_t;
+
+static pthread_mutex_t g_file_view_mutex = PTHREAD_MUTEX_INITIALIZER;
+static hal_file_view_t* g_file_views = NULL;
+
+static bool hal_file_view_matches(const hal_file_view_t* view, const struct stat* st) {
+    return view->dev == st->st_dev && view->ino == st->st_ino && view->size == st->st_size &&
+           view->mtime.tv_sec == st->st_mtim.tv_sec && view->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+// 文件带有不可变标志时，任何进程(包括root)都不能截断或改写它
+static bool hal_file_immutable(int fd) {
+    int flags = 0;
+    return ioctl(fd, FS_IOC_GETFLAGS, &flags) == 0 && (flags & FS_IMMUTABLE_FL);
+}
+
+// 读取文件开头的size字节；文件在读取期间变短时失败
+static int hal_file_read_all(int fd, void* buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, (char*)buffer + done, size - done, (off_t)done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+static void* linux_file_map(const char* path, const void** data, size_t* size) {
+    if (!path || !data || !size) return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_file_view_mutex);
+
+    hal_file_view_t* view = g_file_views;
+    while (view && !hal_file_view_matches(view, &st)) {
+        view = view->next;
+    }
+
+    if (view) {
+        view->ref_count++;
+    } else {
+        view = calloc(1, sizeof(hal_file_view_t));
+        if (view && st.st_size > 0 && hal_file_immutable(fd)) {
+            // MAP_POPULATE预先建立页表，避免编码时逐页缺页
+            view->data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+            if (view->data == MAP_FAILED) {
+                free(view);
+                view = NULL;
+            } else {
+                // madvise每次只接受一种建议
+                madvise(view->data, (size_t)st.st_size, MADV_SEQUENTIAL);
+                madvise(view->data, (size_t)st.st_size, MADV_WILLNEED);
+                view->mapped = true;
+            }
+        } else if (view && st.st_size > 0) {
+            view->data = malloc((size_t)st.st_size);
+            if (!view->data || hal_file_read_all(fd, view->data, (size_t)st.st_size) != 0) {
+                free(view->data);
+                free(view);
+                view = NULL;
+            }
+        }
+
+        if (view) {
+            view->dev = st.st_dev;
+            view->ino = st.st_ino;
+            view->size = st.st_size;
+            view->mtime = st.st_mtim;
+            view->ref_count = 1;
+            view->next = g_file_views;
+            g_file_views = view;
+        }
+    }
+
+    pthread_mutex_unlock(&g_file_view_mutex);
+    close(fd);
+
+    if (!view) return NULL;
+
+    // 空文件没有映射，返回一个有效的空指针
+    *data = view->data ? view->data : (const void*)"";
+    *size = (size_t)view->size;
+    return view;
+}
+
+static void linux_file_unmap(void* handle) {
+    hal_file_view_t* view = (hal_file_view_t*)handle;
+    if (!view) return;
+
+    pthread_mutex_lock(&g_file_view_mutex);
+
+    if (--view->ref_count > 0) {
+        pthread_mutex_unlock(&g_file_view_mutex);
+        return;
+    }
+
+    hal_file_view_t** link = &g_file_views;
+    while (*link && *link != view) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = view->next;
+    }
+
+    pthread_mutex_unlock(&g_file_view_mutex);
+
+    if (view->mapped) {
+        munmap(view->data, (size_t)view->size);
+    } else {
+        free(view->data);
+    }
+    free(view);
+}
+
+// 文件监视 - inotify监视文件本身，eventfd用于从其他线程唤醒等待
+// 文件被替换(重命名覆盖、删除)后旧监视失效，调用者再次watch_add同一路径即可跟上新文件
+typedef struct {
+    int inotify_fd;
+    int wakeup_fd;
+} hal_watch_set_t;
+
+#define HAL_WATCH_MASK (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF)
+
+static void* linux_watch_open(void) {
+    hal_watch_set_t* set = calloc(1, sizeof(hal_watch_set_t));
+    if (!set) return NULL;
+
+    set->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    set->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (set->inotify_fd < 0 || set->wakeup_fd < 0) {
+        if (set->inotify_fd >= 0) close(set->inotify_fd);
+        if (set->wakeup_fd >= 0) close(set->wakeup_fd);
+        free(set);
+        return NULL;
+    }
+    return set;
+}
+
+static int linux_watch_add(void* handle, const char* path) {
+    hal_watch_set_t* set = (hal_watch_set_t*)handle;
+    if (!set || !path) return -1;
+
+    // 同一inode返回已有的监视描述符
+    return inotify_add_watch(set->inotify_fd, path, HAL_WATCH_MASK);
+}
+
+static void linux_watch_remove(void* handle, int id) {
+    hal_watch_set_t* set = (hal_watch_set_t*)handle;
+    if (!set || id < 0) return;
+
+    // 已随文件失效的监视返回EINVAL，忽略即可
+    inotify_rm_watch(set->inotify_fd, id);
+}
+
+static int linux_watch_wait(void* handle, int* ids, size_t max_ids, int timeout_ms) {
+    hal_watch_set_t* set = (hal_watch_set_t*)handle;
+    if (!set || !ids || max_ids == 0) return -1;
+
+    struct pollfd fds[2] = {
+        { .fd = set->inotify_fd, .events = POLLIN },
+        { .fd = set->wakeup_fd, .events = POLLIN }
+    };
+    int ready = poll(fds, 2, timeout_ms);
+    if (ready < 0) return errno == EINTR ? 0 : -1;
+
+    if (fds[1].revents & POLLIN) {
+        uint64_t value;
+        ssize_t ignored = read(set->wakeup_fd, &value, sizeof(value));
+        (void)ignored;
+    }
+    if (!(fds[0].revents & POLLIN)) return 0;
+
+    // 一次读出所有事件，同一监视的多个事件只报告一次
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    size_t count = 0;
+    ssize_t length;
+    while ((length = read(set->inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + length; ) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + event->len;
+
+            bool seen = false;
+            for (size_t i = 0; i < count && !seen; i++) {
+                seen = ids[i] == event->wd;
+            }
+            if (!seen && count < max_ids && event->wd >= 0) {
+                ids[count++] = event->wd;
+            }
+        }
+    }
+    return (int)count;
+}
+
+static int linux_watch_wakeup(void* handle) {
+    hal_watch_set_t* set = (hal_watch_set_t*)handle;
+    if (!set) return -1;
+
+    uint64_t one = 1;
+    return write(set->wakeup_fd, &one, sizeof(one)) == sizeof(one) ? 0 : -1;
+}
+
+static void linux_watch_close(void* handle) {
+    hal_watch_set_t* set = (hal_watch_set_t*)handle;
+    if (!set) return;
+
+    close(set->inotify_fd);
+    close(set->wakeup_fd);
+    free(set);
+}
+
 // Linux平台初始化
 static int linux_platform_init(void) {
     // Linux平台特定的初始化
@@ -226,7 +1203,21 @@ static int linux_platform_init(void) {
 }
 
 static void linux_platform_cleanup(void) {
-    // Linux平台特定的清理
+    // Linux平台特定的清理：释放响应节点池
+    linux_uring_cleanup();
+
+    pthread_mutex_lock(&g_reply_mutex);
+    hal_pending_reply_t* reply = g_reply_free;
+    g_reply_free = NULL;
+    g_reply_free_count = 0;
+    pthread_mutex_unlock(&g_reply_mutex);
+
+    while (reply) {
+        hal_pending_reply_t* next = reply->next;
+        free(reply->buffer);
+        free(reply);
+        reply = next;
+    }
 }
 
 // Linux平台能力
@@ -274,12 +1265,32 @@ static const mcp_platform_hal_t linux_hal = {
         .delay_us = linux_delay_us
     },
     
+    .file = {
+        .map = linux_file_map,
+        .unmap = linux_file_unmap,
+        .watch_open = linux_watch_open,
+        .watch_add = linux_watch_add,
+        .watch_remove = linux_watch_remove,
+        .watch_wait = linux_watch_wait,
+        .watch_wakeup = linux_watch_wakeup,
+        .watch_close = linux_watch_close
+    },
+    
     .network = {
         // HTTP服务器接口 - 通用接口名称，当前使用mongoose实现
         .http_server_start = linux_hal_http_listen,
         .http_response_send = linux_hal_http_reply,
+        .http_response_sendv = linux_hal_http_replyv,
         .network_poll = linux_hal_poll,
+        .network_wakeup = linux_hal_wakeup,
         .http_server_stop = linux_hal_server_stop,
+        .http_server_set_close_handler = linux_hal_server_set_close_handler,
+        .http_stream_begin = linux_hal_http_stream_begin,
+        .http_stream_write = linux_hal_http_stream_write,
+        .http_stream_end = linux_hal_http_stream_end,
+        .http_server_start_ex = linux_hal_http_listen_ex,
+        .http_server_poll = linux_hal_server_poll,
+        .http_server_wakeup = linux_hal_server_wakeup,
 
         // 底层网络接口 - 用于不支持高级HTTP库的平台
         .socket_create = NULL,  // 当前使用mongoose，不需要直接socket操作
@@ -293,7 +1304,33 @@ static const mcp_platform_hal_t linux_hal = {
     .cleanup = linux_platform_cleanup
 };
 
+// 网络后端选择 - 环境变量EMBED_MCP_NET_BACKEND=mongoose|io_uring；未设置时
+// 编译了io_uring后端且内核支持就用它，否则用mongoose
+static mcp_platform_hal_t g_linux_uring_hal;
+static const mcp_platform_hal_t* g_linux_selected_hal = &linux_hal;
+static pthread_once_t g_linux_select_once = PTHREAD_ONCE_INIT;
+
+static void linux_hal_select_network(void) {
+    const char* backend = getenv("EMBED_MCP_NET_BACKEND");
+    if (backend && strcmp(backend, "mongoose") == 0) {
+        return;
+    }
+
+    const mcp_platform_network_t* network = linux_uring_network();
+    if (!network) {
+        return;     // 未编译或内核不支持，退回mongoose
+    }
+    g_linux_uring_hal = linux_hal;
+    g_linux_uring_hal.network = *network;
+    g_linux_selected_hal = &g_linux_uring_hal;
+}
+
+static const mcp_platform_hal_t* linux_hal_select(void) {
+    pthread_once(&g_linux_select_once, linux_hal_select_network);
+    return g_linux_selected_hal;
+}
+
 // 使用通用宏实现导出函数
-HAL_IMPLEMENT_EXPORTS(linux_hal, linux_capabilities, linux_platform_init, linux_platform_cleanup)
+HAL_IMPLEMENT_EXPORTS(*linux_hal_select(), linux_capabilities, linux_platform_init, linux_platform_cleanup)
 
 #endif // MCP_PLATFORM_LINUX
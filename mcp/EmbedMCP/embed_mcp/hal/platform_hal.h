@@ -55,6 +55,28 @@ typedef struct {
     void (*delay_us)(uint32_t us);
 } mcp_platform_time_t;
 
+// File interface - read-only views of whole files
+typedef struct {
+    // Open a view of path; on success returns a handle and sets data/size. The bytes
+    // stay valid until unmap() even if the file is truncated meanwhile, and are not
+    // NUL-terminated. Returns NULL on error.
+    void* (*map)(const char* path, const void** data, size_t* size);
+    void (*unmap)(void* view);
+
+    // Optional (NULL watch_open: files are not watched). A watch set reports files that
+    // were written, replaced or removed. watch_add() returns a watch id >= 0 (the same
+    // id again for a file already watched) or -1; watch_wait() blocks up to timeout_ms
+    // (< 0: forever) and fills ids with the watches that fired, returning their count,
+    // 0 on timeout or wakeup, -1 on error. watch_wakeup() is safe from any thread; the
+    // other calls are made by the thread that waits.
+    void* (*watch_open)(void);
+    int (*watch_add)(void* set, const char* path);
+    void (*watch_remove)(void* set, int id);
+    int (*watch_wait)(void* set, int* ids, size_t max_ids, int timeout_ms);
+    int (*watch_wakeup)(void* set);
+    void (*watch_close)(void* set);
+} mcp_platform_file_t;
+
 // HAL network types
 typedef enum {
     MCP_HAL_NET_TCP,               // TCP network
@@ -114,7 +136,13 @@ typedef struct {
     const char* uri;
     const char* body;
     size_t body_len;
+    const char* accept;            // Accept header, NULL when absent (may be truncated)
+    const char* accept_encoding;   // Accept-Encoding header, NULL when absent (may be truncated)
+    const char* session_id;        // Mcp-Session-Id header, NULL when absent (may be truncated)
     mcp_hal_connection_t connection;
+    // Per-connection slot, preserved across keep-alive requests on the same connection;
+    // NULL when the HAL has no connection lifetime tracking
+    void** connection_data;
 } mcp_hal_http_request_t;
 
 // HTTP response structure
@@ -125,24 +153,83 @@ typedef struct {
     size_t body_len;
 } mcp_hal_http_response_t;
 
+// One piece of a vectored reply
+typedef struct {
+    const void* data;
+    size_t len;
+} mcp_hal_iovec_t;
+
+// Most header / body pieces in one vectored reply
+#define MCP_HAL_IOV_MAX 8
+
+// Vectored HTTP response; the HAL writes the status line and Content-Length itself
+typedef struct {
+    int status_code;
+    const mcp_hal_iovec_t* headers;     // Complete header lines ("Name: value\r\n"), always copied
+    size_t header_count;
+    const mcp_hal_iovec_t* body;
+    size_t body_count;
+    // Optional: the HAL takes ownership of owner and calls release(owner) once the body
+    // is on its way (on any thread, also when sending fails). The body pieces must stay
+    // valid until then and are not copied; without release they are copied as needed.
+    void (*release)(void* owner);
+    void* owner;
+} mcp_hal_http_responsev_t;
+
 // HTTP event callback
 typedef void (*mcp_hal_http_handler_t)(const mcp_hal_http_request_t* request,
                                       mcp_hal_http_response_t* response,
                                       void* user_data);
 
+// Connection closed, called on the polling thread with the connection's non-NULL
+// connection_data slot and the server's user_data
+typedef void (*mcp_hal_http_close_handler_t)(void* connection_data, void* user_data);
+
+// http_server_start_ex flags
+#define MCP_HAL_SERVER_REUSE_PORT (1u << 0)  // Several servers share the port, the OS spreads connections
+
 // HAL network interface - generic network abstraction interface
 // Note: Uses generic names, underlying can be mongoose, lwIP, or other network libraries
 typedef struct {
     // HTTP server interface - generic interface names
     mcp_hal_server_t (*http_server_start)(const char* url, mcp_hal_http_handler_t handler, void* user_data);
+    // May be called from any thread; replies made off the polling thread are queued
+    // and sent by the next network_poll(). Returns -1 if the connection is gone.
     int (*http_response_send)(mcp_hal_connection_t conn, const mcp_hal_http_response_t* response);
+    // Optional (NULL: use http_response_send). Same rules, returns the body length
+    int (*http_response_sendv)(mcp_hal_connection_t conn, const mcp_hal_http_responsev_t* response);
 
     // Network event polling - generic interface names
+    // timeout_ms < 0 blocks until there is network activity or network_wakeup() is called
     int (*network_poll)(int timeout_ms);
 
+    // Make a blocked network_poll() return. Safe to call from any thread and from signal handlers
+    int (*network_wakeup)(void);
+
     // Server management - generic interface names
+    // Stopping also closes the server's client connections and forgets their connection_data
     int (*http_server_stop)(mcp_hal_server_t server);
 
+    // Optional (NULL: no connection_data support). A NULL handler stops close notifications.
+    int (*http_server_set_close_handler)(mcp_hal_server_t server, mcp_hal_http_close_handler_t handler);
+
+    // Optional (NULL: replies are sent whole). A streamed reply is sent as status and
+    // headers (plus body_len bytes of body, if any) with chunked transfer encoding, then
+    // any number of non-empty chunks, then the end. Same threading rules as
+    // http_response_send; the parts of one reply go out in the order they were sent.
+    int (*http_stream_begin)(mcp_hal_connection_t conn, const mcp_hal_http_response_t* response);
+    int (*http_stream_write)(mcp_hal_connection_t conn, const char* data, size_t len);
+    int (*http_stream_end)(mcp_hal_connection_t conn);
+
+    // Optional (NULL: one event loop for all servers, driven by network_poll). Every server
+    // started with http_server_start_ex runs its own event loop, polled by
+    // http_server_poll on one thread at a time; servers on different threads do not share
+    // any state. network_poll / network_wakeup drive the first server started.
+    mcp_hal_server_t (*http_server_start_ex)(const char* url, unsigned int flags,
+                                             mcp_hal_http_handler_t handler, void* user_data);
+    int (*http_server_poll)(mcp_hal_server_t server, int timeout_ms);
+    int (*http_server_wakeup)(mcp_hal_server_t server);
+
     // Low-level network interface (for platforms that don't support high-level HTTP libraries)
     int (*socket_create)(int domain, int type, int protocol);
     int (*socket_bind)(int sockfd, const char* address, uint16_t port);
@@ -161,6 +248,7 @@ typedef struct {
     mcp_platform_thread_t thread;
     mcp_platform_sync_t sync;
     mcp_platform_time_t time;
+    mcp_platform_file_t file;        // Optional - NULL map means use stdio
     mcp_platform_network_t network;  // Use network interface instead of transport interface
 
     // Platform initialization and cleanup
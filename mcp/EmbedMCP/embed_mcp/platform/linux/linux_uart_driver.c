@@ -0,0 +1,256 @@
+#include "linux_uart_driver.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// Device poll timeout, bounds how long stop() waits for the reader
+#define LINUX_UART_POLL_MS 100
+
+typedef struct {
+    mcp_uart_driver_t driver;       // First, so the driver pointer is the context
+    int fd;
+    mcp_transport_t *transport;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t wake_cond;       // Transport task waiting in wait()
+    pthread_cond_t tx_cond;         // Writer waiting for a transfer
+    bool woken;
+    bool running;
+    bool threads_started;
+
+    // "DMA" reception: the reader thread fills the ring and publishes its position
+    pthread_t rx_thread;
+    uint8_t *ring;
+    size_t size;
+    size_t position;
+
+    // "DMA" transmission of one block at a time
+    pthread_t tx_thread;
+    const uint8_t *tx_data;
+    size_t tx_length;
+} linux_uart_t;
+
+static speed_t linux_uart_speed(int baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        default: return B115200;
+    }
+}
+
+static void *linux_uart_rx_thread(void *arg) {
+    linux_uart_t *uart = (linux_uart_t*)arg;
+
+    while (__atomic_load_n(&uart->running, __ATOMIC_ACQUIRE)) {
+        struct pollfd pfd = { .fd = uart->fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, LINUX_UART_POLL_MS);
+        if (ready <= 0) continue;
+
+        // Like circular DMA: write up to the end of the ring, then wrap
+        size_t position = __atomic_load_n(&uart->position, __ATOMIC_RELAXED);
+        ssize_t count = read(uart->fd, uart->ring + position, uart->size - position);
+        if (count <= 0) {
+            if (count < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+            // Hung up (e.g. the other end of a pty closed) - wait for it to come back
+            struct timespec pause = { 0, LINUX_UART_POLL_MS * 1000000L };
+            nanosleep(&pause, NULL);
+            continue;
+        }
+
+        __atomic_store_n(&uart->position, (position + (size_t)count) % uart->size, __ATOMIC_RELEASE);
+        mcp_uart_transport_rx_event(uart->transport);
+    }
+
+    return NULL;
+}
+
+static void *linux_uart_tx_thread(void *arg) {
+    linux_uart_t *uart = (linux_uart_t*)arg;
+
+    pthread_mutex_lock(&uart->mutex);
+    while (uart->running) {
+        if (!uart->tx_data) {
+            pthread_cond_wait(&uart->tx_cond, &uart->mutex);
+            continue;
+        }
+
+        const uint8_t *data = uart->tx_data;
+        size_t length = uart->tx_length;
+        pthread_mutex_unlock(&uart->mutex);
+
+        size_t offset = 0;
+        while (offset < length) {
+            ssize_t written = write(uart->fd, data + offset, length - offset);
+            if (written < 0) {
+                if (errno == EINTR || errno == EAGAIN) continue;
+                break;  // The block is lost, as on a line nobody listens to
+            }
+            offset += (size_t)written;
+        }
+
+        pthread_mutex_lock(&uart->mutex);
+        uart->tx_data = NULL;
+        pthread_mutex_unlock(&uart->mutex);
+        mcp_uart_transport_tx_complete(uart->transport);
+        pthread_mutex_lock(&uart->mutex);
+    }
+    pthread_mutex_unlock(&uart->mutex);
+
+    return NULL;
+}
+
+static int linux_uart_start(void *ctx, mcp_transport_t *transport, uint8_t *ring, size_t size) {
+    linux_uart_t *uart = (linux_uart_t*)ctx;
+    if (uart->threads_started) return -1;
+
+    uart->transport = transport;
+    uart->ring = ring;
+    uart->size = size;
+    uart->position = 0;
+    uart->tx_data = NULL;
+    uart->woken = false;
+    uart->running = true;
+
+    if (pthread_create(&uart->rx_thread, NULL, linux_uart_rx_thread, uart) != 0) {
+        uart->running = false;
+        return -1;
+    }
+    if (pthread_create(&uart->tx_thread, NULL, linux_uart_tx_thread, uart) != 0) {
+        __atomic_store_n(&uart->running, false, __ATOMIC_RELEASE);
+        pthread_join(uart->rx_thread, NULL);
+        return -1;
+    }
+
+    uart->threads_started = true;
+    return 0;
+}
+
+static size_t linux_uart_rx_position(void *ctx) {
+    linux_uart_t *uart = (linux_uart_t*)ctx;
+    return __atomic_load_n(&uart->position, __ATOMIC_ACQUIRE);
+}
+
+static int linux_uart_tx_start(void *ctx, const uint8_t *data, size_t length) {
+    linux_uart_t *uart = (linux_uart_t*)ctx;
+
+    pthread_mutex_lock(&uart->mutex);
+    if (uart->tx_data || !uart->running) {
+        pthread_mutex_unlock(&uart->mutex);
+        return -1;
+    }
+    uart->tx_data = data;
+    uart->tx_length = length;
+    pthread_cond_signal(&uart->tx_cond);
+    pthread_mutex_unlock(&uart->mutex);
+
+    return 0;
+}
+
+static void linux_uart_wait(void *ctx, uint32_t timeout_ms) {
+    linux_uart_t *uart = (linux_uart_t*)ctx;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&uart->mutex);
+    while (!uart->woken) {
+        if (pthread_cond_timedwait(&uart->wake_cond, &uart->mutex, &deadline) == ETIMEDOUT) break;
+    }
+    uart->woken = false;
+    pthread_mutex_unlock(&uart->mutex);
+}
+
+static void linux_uart_wake(void *ctx) {
+    linux_uart_t *uart = (linux_uart_t*)ctx;
+
+    pthread_mutex_lock(&uart->mutex);
+    uart->woken = true;
+    pthread_cond_signal(&uart->wake_cond);
+    pthread_mutex_unlock(&uart->mutex);
+}
+
+static void linux_uart_stop(void *ctx) {
+    linux_uart_t *uart = (linux_uart_t*)ctx;
+    if (!uart->threads_started) return;
+
+    pthread_mutex_lock(&uart->mutex);
+    __atomic_store_n(&uart->running, false, __ATOMIC_RELEASE);
+    pthread_cond_signal(&uart->tx_cond);
+    pthread_mutex_unlock(&uart->mutex);
+
+    pthread_join(uart->rx_thread, NULL);
+    pthread_join(uart->tx_thread, NULL);
+    uart->threads_started = false;
+}
+
+mcp_uart_driver_t *linux_uart_driver_create(const char *device, int baud) {
+    if (!device) return NULL;
+
+    linux_uart_t *uart = calloc(1, sizeof(linux_uart_t));
+    if (!uart) return NULL;
+
+    uart->fd = open(device, O_RDWR | O_NOCTTY);
+    if (uart->fd < 0) {
+        free(uart);
+        return NULL;
+    }
+
+    // Raw 8N1, no flow control
+    struct termios tio;
+    if (tcgetattr(uart->fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        cfsetispeed(&tio, linux_uart_speed(baud));
+        cfsetospeed(&tio, linux_uart_speed(baud));
+        tcsetattr(uart->fd, TCSANOW, &tio);
+    }
+
+    pthread_mutex_init(&uart->mutex, NULL);
+    pthread_cond_init(&uart->wake_cond, NULL);
+    pthread_cond_init(&uart->tx_cond, NULL);
+
+    uart->driver.ctx = uart;
+    uart->driver.start = linux_uart_start;
+    uart->driver.rx_position = linux_uart_rx_position;
+    uart->driver.tx_start = linux_uart_tx_start;
+    uart->driver.wait = linux_uart_wait;
+    uart->driver.wake = linux_uart_wake;
+    uart->driver.stop = linux_uart_stop;
+
+    return &uart->driver;
+}
+
+void linux_uart_driver_destroy(mcp_uart_driver_t *driver) {
+    if (!driver) return;
+
+    linux_uart_t *uart = (linux_uart_t*)driver->ctx;
+    linux_uart_stop(uart);
+
+    close(uart->fd);
+    pthread_cond_destroy(&uart->tx_cond);
+    pthread_cond_destroy(&uart->wake_cond);
+    pthread_mutex_destroy(&uart->mutex);
+    free(uart);
+}
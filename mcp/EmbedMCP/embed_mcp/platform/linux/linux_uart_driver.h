@@ -0,0 +1,21 @@
+#ifndef LINUX_UART_DRIVER_H
+#define LINUX_UART_DRIVER_H
+
+#include "../../transport/uart_transport.h"
+
+// Linux UART driver for the UART transport - a serial device (or pty) with the
+// MCU's DMA emulated by a reader and a writer thread. For development and testing
+// on a host; boards supply their own mcp_uart_driver_t.
+
+/**
+ * Open a serial device in raw mode
+ * @param device Device path, e.g. /dev/ttyUSB0
+ * @param baud Baud rate (ignored for devices that are not terminals)
+ * @return Driver, or NULL on error
+ */
+mcp_uart_driver_t *linux_uart_driver_create(const char *device, int baud);
+
+// Stop the driver if needed and close the device
+void linux_uart_driver_destroy(mcp_uart_driver_t *driver);
+
+#endif // LINUX_UART_DRIVER_H
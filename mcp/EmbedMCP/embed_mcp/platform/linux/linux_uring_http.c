@@ -0,0 +1,1517 @@
+#include "linux_uring_http.h"
+
+#if defined(MCP_ENABLE_IO_URING)
+
+#include "mongoose.h"
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+// Linux io_uring HTTP后端 - 与mongoose后端实现同一个HAL网络接口。
+// 每个事件循环一个环：监听socket上一个多重接受请求，每个连接一个多重接收请求，
+// 数据落在注册给内核的接收缓冲区里；响应以sendmsg请求发出。一次轮询产生的所有
+// 请求合并在一次io_uring_enter()中提交，连接数多时没有逐个socket的读写和poll集合重建
+
+// 环大小：提交队列项数，完成队列是它的4倍
+#define URING_ENTRIES 256
+#define URING_CQ_ENTRIES (4 * URING_ENTRIES)
+
+// 接收缓冲区，每个事件循环一组，数量是2的幂
+#define URING_RECV_BUFFERS 256
+#define URING_RECV_BUFFER_SIZE 4096
+#define URING_RECV_GROUP 0
+
+// 单个连接缓存的未处理请求数据上限，与mongoose相同
+#define URING_INPUT_MAX MG_MAX_RECV_SIZE
+
+#define URING_LOOP_MAX 16
+
+// 连接句柄的高4位是事件循环编号，其余位是连接ID；连接ID的低位是连接表槽位，高位是代数
+#define URING_LOOP_SHIFT (sizeof(uintptr_t) * 8 - 4)
+#define URING_CONN_ID_MASK (((uintptr_t)1 << URING_LOOP_SHIFT) - 1)
+#define URING_SLOT_BITS 16
+#define URING_SLOT_MASK (((uintptr_t)1 << URING_SLOT_BITS) - 1)
+
+// user_data的低3位是操作类型，其余位是连接或事件循环的地址
+typedef enum {
+    URING_OP_IGNORE = 0,        // 取消和关闭，完成时无需处理
+    URING_OP_ACCEPT,
+    URING_OP_WAKEUP,
+    URING_OP_RECV,
+    URING_OP_SEND
+} uring_op_t;
+
+#define URING_OP_MASK ((uint64_t)7)
+
+typedef enum {
+    URING_REPLY_FULL,           // 完整响应(Content-Length)
+    URING_REPLY_STREAM_BEGIN,   // 分块响应的状态行和头部(可带第一块)
+    URING_REPLY_STREAM_CHUNK,   // 一个数据块
+    URING_REPLY_STREAM_END      // 结束块
+} uring_reply_op_t;
+
+// 头部一段，响应体最多MCP_HAL_IOV_MAX段，再加分块结尾
+#define URING_IOV_MAX (MCP_HAL_IOV_MAX + 2)
+
+// 状态行和长度行的最大长度
+#define URING_HEAD_RESERVE 112
+
+// 一段待发送的输出。状态行、头部、长度或分块标记，以及复制的响应体连续放在buffer里；
+// 转交所有权的响应体直接引用，发送完成(或连接关闭)后才调用release
+typedef struct uring_out {
+    struct uring_out* next;
+    uintptr_t conn_id;          // 跨线程排队时的目标连接
+    bool ends_response;         // 完整响应或结束块
+    struct msghdr msg;
+    struct iovec iov[URING_IOV_MAX];
+    void (*release)(void* owner);
+    void* owner;
+    char* buffer;
+    size_t capacity;
+} uring_out_t;
+
+// 空闲节点上限，以及超过该大小的缓冲区不保留
+#define URING_OUT_POOL_MAX 64
+#define URING_OUT_POOL_BUFFER_MAX (64 * 1024)
+
+// 空闲节点链表由所有事件循环共用
+static pthread_mutex_t g_out_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uring_out_t* g_out_free = NULL;
+static size_t g_out_free_count = 0;
+
+typedef struct uring_conn {
+    uintptr_t id;
+    int fd;
+    unsigned ops;               // 已提交、尚未结束的接收和发送
+    bool recv_armed;
+    bool sending;
+    bool responding;            // 请求已交给处理器，响应还没有结束
+    bool keep_alive;            // 请求没有带Connection: close
+    bool draining;              // 已排队的输出发完后关闭
+    bool closing;
+    bool dispatching;           // 正在调用处理器，连接不能释放
+    bool ready;                 // 在就绪链表上：响应已结束，缓存里可能还有请求
+    void* slot;                 // connection_data
+    char* input;                // 还不完整或尚未处理的请求数据
+    size_t input_len;
+    size_t input_capacity;
+    uring_out_t* out_head;
+    uring_out_t* out_tail;
+    struct uring_conn* ready_next;
+} uring_conn_t;
+
+typedef struct {
+    bool in_use;                // 原子读写，发送方可能在任意线程
+    bool mutex_ready;
+    bool stopping;
+
+    // 映射的提交队列和完成队列，只由轮询线程访问
+    int ring_fd;
+    void* ring;
+    size_t ring_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned sq_local_tail;     // 已填写的提交项，进入内核时才发布
+    unsigned sq_unsubmitted;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe* cqes;
+    unsigned inflight;          // 还没收到最后一个完成项的接受、唤醒、接收和发送
+
+    // 接收缓冲区环：内核从这里挑选缓冲区，处理完的数据立即归还
+    struct io_uring_buf_ring* buf_ring;
+    size_t buf_ring_size;
+    char* buf_memory;
+    uint16_t buf_tail;
+
+    int listen_fd;
+    int wakeup_fd;              // eventfd，其他线程和信号处理函数写入
+    uint64_t wakeup_value;
+    bool accept_armed;
+    bool wakeup_armed;
+
+    mcp_hal_http_handler_t handler;
+    void* user_data;            // 服务器的user_data
+    mcp_hal_http_close_handler_t close_handler;
+
+    // 连接表，按槽位索引
+    uring_conn_t** conns;
+    uint32_t* free_slots;
+    size_t conn_capacity;
+    size_t free_count;
+    uintptr_t generation;
+    uring_conn_t* ready;
+
+    // 跨线程响应队列 - 工作线程的响应先入队，由轮询线程提交
+    pthread_mutex_t reply_mutex;
+    uring_out_t* reply_head;
+    uring_out_t* reply_tail;
+
+    pthread_t poll_thread;
+    bool poll_thread_known;
+} uring_loop_t;
+
+static pthread_mutex_t g_loops_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uring_loop_t g_loops[URING_LOOP_MAX];
+static int g_default_loop = -1;     // network_poll()/network_wakeup()驱动的循环，原子读写
+
+// 环的建立和提交
+
+static void uring_close_ring(uring_loop_t* loop) {
+    // 关闭环时内核一并注销接收缓冲区环
+    if (loop->ring_fd >= 0) close(loop->ring_fd);
+    if (loop->ring) munmap(loop->ring, loop->ring_size);
+    if (loop->sqes) munmap(loop->sqes, loop->sqes_size);
+    if (loop->buf_ring) munmap(loop->buf_ring, loop->buf_ring_size);
+    free(loop->buf_memory);
+    loop->ring_fd = -1;
+    loop->ring = NULL;
+    loop->sqes = NULL;
+    loop->buf_ring = NULL;
+    loop->buf_memory = NULL;
+}
+
+static int uring_setup(uring_loop_t* loop) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // COOP_TASKRUN：完成处理留到轮询线程下次进入内核时做，不打断它
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SUBMIT_ALL;
+    params.cq_entries = URING_CQ_ENTRIES;
+
+    int fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    if (fd < 0) {
+        return -1;
+    }
+    loop->ring_fd = fd;
+
+    // 需要单次映射两个队列(5.4)和带超时的等待(5.11)
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        uring_close_ring(loop);
+        return -1;
+    }
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    loop->ring_size = sq_size > cq_size ? sq_size : cq_size;
+    loop->ring = mmap(NULL, loop->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQ_RING);
+    if (loop->ring == MAP_FAILED) {
+        loop->ring = NULL;
+        uring_close_ring(loop);
+        return -1;
+    }
+    loop->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    loop->sqes = mmap(NULL, loop->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQES);
+    if (loop->sqes == MAP_FAILED) {
+        loop->sqes = NULL;
+        uring_close_ring(loop);
+        return -1;
+    }
+
+    char* ring = (char*)loop->ring;
+    loop->sq_head = (unsigned*)(ring + params.sq_off.head);
+    loop->sq_tail = (unsigned*)(ring + params.sq_off.tail);
+    loop->sq_mask = *(unsigned*)(ring + params.sq_off.ring_mask);
+    loop->sq_entries = params.sq_entries;
+    loop->sq_local_tail = *loop->sq_tail;
+    loop->sq_unsubmitted = 0;
+    loop->cq_head = (unsigned*)(ring + params.cq_off.head);
+    loop->cq_tail = (unsigned*)(ring + params.cq_off.tail);
+    loop->cq_mask = *(unsigned*)(ring + params.cq_off.ring_mask);
+    loop->cqes = (struct io_uring_cqe*)(ring + params.cq_off.cqes);
+    loop->inflight = 0;
+
+    // 提交项与下标数组一一对应，之后只需推进尾指针
+    unsigned* array = (unsigned*)(ring + params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; i++) {
+        array[i] = i;
+    }
+    return 0;
+}
+
+static void uring_recycle_buffer(uring_loop_t* loop, uint16_t bid) {
+    struct io_uring_buf* buf = &loop->buf_ring->bufs[loop->buf_tail & (URING_RECV_BUFFERS - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(loop->buf_memory + (size_t)bid * URING_RECV_BUFFER_SIZE);
+    buf->len = URING_RECV_BUFFER_SIZE;
+    buf->bid = bid;
+    loop->buf_tail++;
+    __atomic_store_n(&loop->buf_ring->tail, loop->buf_tail, __ATOMIC_RELEASE);
+}
+
+// 注册接收缓冲区环(5.19)，之后的多重接收从这组缓冲区里取
+static int uring_setup_buffers(uring_loop_t* loop) {
+    loop->buf_ring_size = URING_RECV_BUFFERS * sizeof(struct io_uring_buf);
+    loop->buf_ring = mmap(NULL, loop->buf_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (loop->buf_ring == MAP_FAILED) {
+        loop->buf_ring = NULL;
+        return -1;
+    }
+    loop->buf_memory = malloc((size_t)URING_RECV_BUFFERS * URING_RECV_BUFFER_SIZE);
+    if (!loop->buf_memory) {
+        return -1;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)loop->buf_ring;
+    reg.ring_entries = URING_RECV_BUFFERS;
+    reg.bgid = URING_RECV_GROUP;
+    if (syscall(__NR_io_uring_register, loop->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        return -1;
+    }
+
+    loop->buf_tail = 0;
+    for (uint16_t bid = 0; bid < URING_RECV_BUFFERS; bid++) {
+        uring_recycle_buffer(loop, bid);
+    }
+    return 0;
+}
+
+// 提交已填写的请求；wait时等待至少一个完成项(timeout_ms < 0：一直等)
+static int uring_enter(uring_loop_t* loop, bool wait, int timeout_ms) {
+    __atomic_store_n(loop->sq_tail, loop->sq_local_tail, __ATOMIC_RELEASE);
+
+    unsigned flags = IORING_ENTER_GETEVENTS;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    void* argp = NULL;
+    size_t argsz = 0;
+    if (wait && timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argsz = sizeof(arg);
+    }
+
+    int submitted = (int)syscall(__NR_io_uring_enter, loop->ring_fd, loop->sq_unsubmitted,
+                                 wait ? 1 : 0, flags, argp, argsz);
+    if (submitted < 0) {
+        // 超时、信号打断或完成队列暂满都不是错误，下次再提交
+        return (errno == ETIME || errno == EINTR || errno == EAGAIN || errno == EBUSY) ? 0 : -1;
+    }
+    loop->sq_unsubmitted -= (unsigned)submitted < loop->sq_unsubmitted ? (unsigned)submitted
+                                                                       : loop->sq_unsubmitted;
+    return 0;
+}
+
+// 取一个空的提交项，队列满时先提交已填写的部分
+static struct io_uring_sqe* uring_get_sqe(uring_loop_t* loop) {
+    if (loop->sq_local_tail - __atomic_load_n(loop->sq_head, __ATOMIC_ACQUIRE) >= loop->sq_entries) {
+        uring_enter(loop, false, 0);
+        if (loop->sq_local_tail - __atomic_load_n(loop->sq_head, __ATOMIC_ACQUIRE) >= loop->sq_entries) {
+            return NULL;
+        }
+    }
+    struct io_uring_sqe* sqe = &loop->sqes[loop->sq_local_tail & loop->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    loop->sq_local_tail++;
+    loop->sq_unsubmitted++;
+    return sqe;
+}
+
+static uint64_t uring_tag(void* target, uring_op_t op) {
+    return (uint64_t)(uintptr_t)target | (uint64_t)op;
+}
+
+static void uring_arm_accept(uring_loop_t* loop) {
+    struct io_uring_sqe* sqe = uring_get_sqe(loop);
+    if (!sqe) return;   // 下次轮询再提交
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = loop->listen_fd;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = uring_tag(loop, URING_OP_ACCEPT);
+    loop->accept_armed = true;
+    loop->inflight++;
+}
+
+static void uring_arm_wakeup(uring_loop_t* loop) {
+    struct io_uring_sqe* sqe = uring_get_sqe(loop);
+    if (!sqe) return;
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = loop->wakeup_fd;
+    sqe->addr = (uint64_t)(uintptr_t)&loop->wakeup_value;
+    sqe->len = sizeof(loop->wakeup_value);
+    sqe->off = (uint64_t)-1;
+    sqe->user_data = uring_tag(loop, URING_OP_WAKEUP);
+    loop->wakeup_armed = true;
+    loop->inflight++;
+}
+
+// 输出节点
+
+static void uring_out_release(uring_out_t* out) {
+    if (out->release) {
+        out->release(out->owner);
+        out->release = NULL;
+        out->owner = NULL;
+    }
+
+    pthread_mutex_lock(&g_out_mutex);
+    if (g_out_free_count < URING_OUT_POOL_MAX && out->capacity <= URING_OUT_POOL_BUFFER_MAX) {
+        out->next = g_out_free;
+        g_out_free = out;
+        g_out_free_count++;
+        out = NULL;
+    }
+    pthread_mutex_unlock(&g_out_mutex);
+
+    if (out) {
+        free(out->buffer);
+        free(out);
+    }
+}
+
+// mongoose后端同样只列出本项目用到的状态码
+static const char* uring_status_text(int status_code) {
+    switch (status_code) {
+        case 200: return "OK";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "";
+    }
+}
+
+static char* uring_append(char* out, const void* data, size_t len) {
+    memcpy(out, data, len);
+    return out + len;
+}
+
+// 数字格式化不经过printf
+static char* uring_append_number(char* out, size_t value, unsigned base) {
+    char digits[24];
+    size_t n = 0;
+    do {
+        digits[n++] = "0123456789abcdef"[value % base];
+        value /= base;
+    } while (value > 0);
+    while (n > 0) {
+        *out++ = digits[--n];
+    }
+    return out;
+}
+
+static size_t uring_iov_length(const mcp_hal_iovec_t* iov, size_t count) {
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++) {
+        len += iov[i].len;
+    }
+    return len;
+}
+
+// 按mongoose后端相同的格式生成一个响应或分块。失败时已调用release
+static uring_out_t* uring_out_create(uring_reply_op_t op, const mcp_hal_http_responsev_t* response) {
+    static const char default_headers[] = "Content-Type: application/json\r\n";
+    bool copy_body = response->release == NULL;
+    size_t headers_len = uring_iov_length(response->headers, response->header_count);
+    size_t body_len = uring_iov_length(response->body, response->body_count);
+    size_t needed = URING_HEAD_RESERVE + headers_len + sizeof(default_headers) +
+                    (copy_body ? body_len : 0) + 2;
+
+    pthread_mutex_lock(&g_out_mutex);
+    uring_out_t* out = g_out_free;
+    if (out) {
+        g_out_free = out->next;
+        g_out_free_count--;
+    }
+    pthread_mutex_unlock(&g_out_mutex);
+
+    if (!out) {
+        out = calloc(1, sizeof(uring_out_t));
+        if (!out) {
+            if (response->release) response->release(response->owner);
+            return NULL;
+        }
+    }
+    out->release = response->release;
+    out->owner = response->owner;
+
+    if (out->capacity < needed) {
+        char* buffer = realloc(out->buffer, needed);
+        if (!buffer) {
+            uring_out_release(out);
+            return NULL;
+        }
+        out->buffer = buffer;
+        out->capacity = needed;
+    }
+
+    char* p = out->buffer;
+    if (op == URING_REPLY_FULL || op == URING_REPLY_STREAM_BEGIN) {
+        int status_code = response->status_code > 0 ? response->status_code : 500;
+        const char* text = uring_status_text(status_code);
+        p = uring_append(p, "HTTP/1.1 ", 9);
+        p = uring_append_number(p, (size_t)status_code, 10);
+        p = uring_append(p, " ", 1);
+        p = uring_append(p, text, strlen(text));
+        p = uring_append(p, "\r\n", 2);
+        if (response->header_count == 0) {
+            p = uring_append(p, default_headers, sizeof(default_headers) - 1);
+        }
+        for (size_t i = 0; i < response->header_count; i++) {
+            p = uring_append(p, response->headers[i].data, response->headers[i].len);
+        }
+    }
+
+    switch (op) {
+        case URING_REPLY_FULL:
+            p = uring_append(p, "Content-Length: ", 16);
+            p = uring_append_number(p, body_len, 10);
+            p = uring_append(p, "\r\n\r\n", 4);
+            break;
+        case URING_REPLY_STREAM_BEGIN:
+            p = uring_append(p, "Transfer-Encoding: chunked\r\n\r\n", 30);
+            if (body_len > 0) {
+                p = uring_append_number(p, body_len, 16);
+                p = uring_append(p, "\r\n", 2);
+            }
+            break;
+        case URING_REPLY_STREAM_CHUNK:
+            p = uring_append_number(p, body_len, 16);
+            p = uring_append(p, "\r\n", 2);
+            break;
+        case URING_REPLY_STREAM_END:
+            p = uring_append(p, "0\r\n\r\n", 5);
+            break;
+    }
+
+    bool trailer = (op == URING_REPLY_STREAM_BEGIN || op == URING_REPLY_STREAM_CHUNK) && body_len > 0;
+    size_t count = 0;
+    if (copy_body) {
+        // 复制的响应体接在头部之后，整个输出是一段
+        for (size_t i = 0; i < response->body_count; i++) {
+            p = uring_append(p, response->body[i].data, response->body[i].len);
+        }
+        if (trailer) {
+            p = uring_append(p, "\r\n", 2);
+        }
+        out->iov[count].iov_base = out->buffer;
+        out->iov[count].iov_len = (size_t)(p - out->buffer);
+        count++;
+    } else {
+        out->iov[count].iov_base = out->buffer;
+        out->iov[count].iov_len = (size_t)(p - out->buffer);
+        count++;
+        for (size_t i = 0; i < response->body_count; i++) {
+            if (response->body[i].len > 0) {
+                out->iov[count].iov_base = (void*)response->body[i].data;
+                out->iov[count].iov_len = response->body[i].len;
+                count++;
+            }
+        }
+        if (trailer) {
+            out->iov[count].iov_base = (void*)"\r\n";
+            out->iov[count].iov_len = 2;
+            count++;
+        }
+    }
+
+    memset(&out->msg, 0, sizeof(out->msg));
+    out->msg.msg_iov = out->iov;
+    out->msg.msg_iovlen = count;
+    out->ends_response = op == URING_REPLY_FULL || op == URING_REPLY_STREAM_END;
+    out->next = NULL;
+    return out;
+}
+
+// 跳过已发出的字节，全部发完时返回true
+static bool uring_out_advance(uring_out_t* out, size_t sent) {
+    struct msghdr* msg = &out->msg;
+    while (msg->msg_iovlen > 0 && sent >= msg->msg_iov->iov_len) {
+        sent -= msg->msg_iov->iov_len;
+        msg->msg_iov++;
+        msg->msg_iovlen--;
+    }
+    if (msg->msg_iovlen > 0) {
+        msg->msg_iov->iov_base = (char*)msg->msg_iov->iov_base + sent;
+        msg->msg_iov->iov_len -= sent;
+    }
+    return msg->msg_iovlen == 0;
+}
+
+// 连接
+
+static mcp_hal_connection_t uring_make_handle(const uring_loop_t* loop, uintptr_t conn_id) {
+    uintptr_t index = (uintptr_t)(loop - g_loops);
+    return (mcp_hal_connection_t)((index << URING_LOOP_SHIFT) | (conn_id & URING_CONN_ID_MASK));
+}
+
+// 连接句柄所属的事件循环，服务器已停止时返回NULL
+static uring_loop_t* uring_handle_loop(mcp_hal_connection_t conn, uintptr_t* conn_id) {
+    uintptr_t handle = (uintptr_t)conn;
+    uring_loop_t* loop = &g_loops[handle >> URING_LOOP_SHIFT];
+    *conn_id = handle & URING_CONN_ID_MASK;
+    if (*conn_id == 0 || !__atomic_load_n(&loop->in_use, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    return loop;
+}
+
+static uring_conn_t* uring_find_connection(uring_loop_t* loop, uintptr_t conn_id) {
+    size_t slot = (size_t)(conn_id & URING_SLOT_MASK);
+    uring_conn_t* conn = slot < loop->conn_capacity ? loop->conns[slot] : NULL;
+    return conn && conn->id == conn_id ? conn : NULL;
+}
+
+static int uring_grow_connections(uring_loop_t* loop) {
+    size_t capacity = loop->conn_capacity ? loop->conn_capacity * 2 : 64;
+    if (capacity > (size_t)URING_SLOT_MASK + 1) {
+        return -1;
+    }
+
+    uring_conn_t** conns = realloc(loop->conns, capacity * sizeof(uring_conn_t*));
+    if (!conns) return -1;
+    loop->conns = conns;
+    uint32_t* free_slots = realloc(loop->free_slots, capacity * sizeof(uint32_t));
+    if (!free_slots) return -1;
+    loop->free_slots = free_slots;
+
+    // 低槽位先用
+    for (size_t slot = capacity; slot > loop->conn_capacity; slot--) {
+        loop->conns[slot - 1] = NULL;
+        loop->free_slots[loop->free_count++] = (uint32_t)(slot - 1);
+    }
+    loop->conn_capacity = capacity;
+    return 0;
+}
+
+static void uring_mark_ready(uring_loop_t* loop, uring_conn_t* conn) {
+    if (!conn->ready) {
+        conn->ready = true;
+        conn->ready_next = loop->ready;
+        loop->ready = conn;
+    }
+}
+
+static void uring_conn_close(uring_loop_t* loop, uring_conn_t* conn) {
+    if (conn->closing) {
+        return;
+    }
+    conn->closing = true;
+
+    if (conn->slot && loop->close_handler) {
+        void* slot = conn->slot;
+        conn->slot = NULL;
+        loop->close_handler(slot, loop->user_data);
+    }
+
+    // 取消该socket上仍在进行的接收和发送，全部结束后才关闭描述符、释放连接
+    if (conn->ops > 0) {
+        struct io_uring_sqe* sqe = uring_get_sqe(loop);
+        if (sqe) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = conn->fd;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+            sqe->user_data = uring_tag(NULL, URING_OP_IGNORE);
+        } else {
+            shutdown(conn->fd, SHUT_RDWR);
+        }
+    }
+}
+
+// 关闭的连接在没有进行中的请求、也不在处理器或就绪链表上时释放
+static void uring_conn_try_free(uring_loop_t* loop, uring_conn_t* conn) {
+    if (!conn->closing || conn->ops > 0 || conn->dispatching || conn->ready) {
+        return;
+    }
+
+    while (conn->out_head) {
+        uring_out_t* next = conn->out_head->next;
+        uring_out_release(conn->out_head);
+        conn->out_head = next;
+    }
+
+    struct io_uring_sqe* sqe = uring_get_sqe(loop);
+    if (sqe) {
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = conn->fd;
+        sqe->user_data = uring_tag(NULL, URING_OP_IGNORE);
+    } else {
+        close(conn->fd);
+    }
+
+    size_t slot = (size_t)(conn->id & URING_SLOT_MASK);
+    loop->conns[slot] = NULL;
+    loop->free_slots[loop->free_count++] = (uint32_t)slot;
+    free(conn->input);
+    free(conn);
+}
+
+static void uring_arm_recv(uring_loop_t* loop, uring_conn_t* conn) {
+    struct io_uring_sqe* sqe = uring_get_sqe(loop);
+    if (!sqe) {
+        uring_conn_close(loop, conn);
+        return;
+    }
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn->fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_RECV_GROUP;
+    sqe->user_data = uring_tag(conn, URING_OP_RECV);
+    conn->recv_armed = true;
+    conn->ops++;
+    loop->inflight++;
+}
+
+// 同一连接同时只有一个发送请求，输出按排队顺序发出
+static void uring_conn_send(uring_loop_t* loop, uring_conn_t* conn) {
+    if (conn->sending || conn->closing || !conn->out_head) {
+        return;
+    }
+
+    struct io_uring_sqe* sqe = uring_get_sqe(loop);
+    if (!sqe) {
+        uring_conn_close(loop, conn);
+        return;
+    }
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = conn->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&conn->out_head->msg;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = uring_tag(conn, URING_OP_SEND);
+    conn->sending = true;
+    conn->ops++;
+    loop->inflight++;
+}
+
+static void uring_conn_append(uring_loop_t* loop, uring_conn_t* conn, uring_out_t* out) {
+    if (conn->closing) {
+        uring_out_release(out);
+        return;
+    }
+
+    out->next = NULL;
+    if (conn->out_tail) {
+        conn->out_tail->next = out;
+    } else {
+        conn->out_head = out;
+    }
+    conn->out_tail = out;
+
+    // 响应结束，可以处理该连接上的下一个请求；分块响应期间responding保持置位
+    if (out->ends_response) {
+        conn->responding = false;
+        if (!conn->keep_alive) {
+            conn->draining = true;
+        } else if (conn->input_len > 0) {
+            uring_mark_ready(loop, conn);
+        }
+    }
+    uring_conn_send(loop, conn);
+}
+
+static void uring_conn_reply_status(uring_loop_t* loop, uring_conn_t* conn, int status_code) {
+    mcp_hal_http_responsev_t response = { .status_code = status_code };
+    uring_out_t* out = uring_out_create(URING_REPLY_FULL, &response);
+    conn->keep_alive = false;
+    if (out) {
+        uring_conn_append(loop, conn, out);
+    } else {
+        uring_conn_close(loop, conn);
+    }
+}
+
+// 复制mongoose字符串为C字符串(过长时截断，不会误匹配)
+static const char* uring_copy_str(struct mg_str str, char* buffer, size_t size) {
+    size_t len = str.len < size - 1 ? str.len : size - 1;
+    memcpy(buffer, str.buf, len);
+    buffer[len] = '\0';
+    return buffer;
+}
+
+// 复制请求头，没有该请求头时返回NULL
+static const char* uring_copy_header(struct mg_http_message* hm, const char* name, char* buffer, size_t size) {
+    struct mg_str* header = mg_http_get_header(hm, name);
+    return header ? uring_copy_str(*header, buffer, size) : NULL;
+}
+
+static void uring_conn_request(uring_loop_t* loop, uring_conn_t* conn, struct mg_http_message* hm) {
+    char method[16];
+    char uri[256];
+    char accept[256];
+    char accept_encoding[128];
+    char session_id[160];
+
+    struct mg_str* connection = mg_http_get_header(hm, "Connection");
+    conn->keep_alive = !(connection && mg_strcasecmp(*connection, mg_str("close")) == 0);
+    conn->responding = true;
+
+    if (!loop->handler) {
+        uring_conn_reply_status(loop, conn, 500);
+        return;
+    }
+
+    // keep-alive连接的后续请求拿回同一个连接槽
+    void* slot = conn->slot;
+
+    mcp_hal_http_request_t request = {
+        .method = uring_copy_str(hm->method, method, sizeof(method)),
+        .uri = uring_copy_str(hm->uri, uri, sizeof(uri)),
+        .body = hm->body.buf,
+        .body_len = hm->body.len,
+        .accept = uring_copy_header(hm, "Accept", accept, sizeof(accept)),
+        .accept_encoding = uring_copy_header(hm, "Accept-Encoding", accept_encoding, sizeof(accept_encoding)),
+        .session_id = uring_copy_header(hm, "Mcp-Session-Id", session_id, sizeof(session_id)),
+        .connection = uring_make_handle(loop, conn->id),
+        .connection_data = loop->close_handler ? &slot : NULL
+    };
+    mcp_hal_http_response_t response = {0};
+
+    loop->handler(&request, &response, loop->user_data);
+
+    if (!conn->closing) {
+        conn->slot = slot;
+    } else if (slot && loop->close_handler) {
+        loop->close_handler(slot, loop->user_data);  // 连接在处理期间关闭
+    }
+
+    if (response.status_code > 0) {
+        mcp_hal_iovec_t headers = { response.headers, response.headers ? strlen(response.headers) : 0 };
+        mcp_hal_iovec_t body = { response.body, response.body ? response.body_len : 0 };
+        mcp_hal_http_responsev_t vectored = {
+            .status_code = response.status_code,
+            .headers = &headers,
+            .header_count = response.headers ? 1 : 0,
+            .body = &body,
+            .body_count = 1
+        };
+        uring_out_t* out = uring_out_create(URING_REPLY_FULL, &vectored);
+        if (out) {
+            uring_conn_append(loop, conn, out);
+        } else {
+            uring_conn_close(loop, conn);
+        }
+    }
+}
+
+// 依次把data中完整的请求交给处理器，返回处理掉的字节数。请求不完整、连接正在响应
+// 或将要关闭时停下
+static size_t uring_conn_dispatch(uring_loop_t* loop, uring_conn_t* conn, const char* data, size_t len) {
+    size_t offset = 0;
+    conn->dispatching = true;
+
+    while (offset < len && !conn->responding && !conn->draining && !conn->closing) {
+        struct mg_http_message hm;
+        int n = mg_http_parse(data + offset, len - offset, &hm);
+        if (n < 0) {
+            uring_conn_close(loop, conn);
+            break;
+        }
+        if (n == 0) {
+            break;  // 头部还不完整
+        }
+
+        // 不支持分块编码的请求体，POST和PUT必须带Content-Length
+        if (mg_http_get_header(&hm, "Transfer-Encoding") != NULL || hm.body.len == (size_t)~0) {
+            uring_conn_reply_status(loop, conn, 411);
+            break;
+        }
+        if (hm.body.len > URING_INPUT_MAX - (size_t)n) {
+            uring_conn_reply_status(loop, conn, 413);
+            break;
+        }
+        if (hm.body.len > len - offset - (size_t)n) {
+            break;  // 请求体还没收全
+        }
+
+        offset += (size_t)n + hm.body.len;
+        uring_conn_request(loop, conn, &hm);
+    }
+
+    conn->dispatching = false;
+    return offset;
+}
+
+static void uring_conn_process_input(uring_loop_t* loop, uring_conn_t* conn) {
+    size_t used = uring_conn_dispatch(loop, conn, conn->input, conn->input_len);
+    if (used > 0) {
+        memmove(conn->input, conn->input + used, conn->input_len - used);
+        conn->input_len -= used;
+    }
+}
+
+static void uring_conn_received(uring_loop_t* loop, uring_conn_t* conn, const char* data, size_t len) {
+    if (conn->closing || conn->draining) {
+        return;
+    }
+
+    // 没有缓存的数据时直接在接收缓冲区里解析，完整的请求不经过复制
+    bool buffered = conn->input_len > 0;
+    if (!buffered) {
+        size_t used = uring_conn_dispatch(loop, conn, data, len);
+        data += used;
+        len -= used;
+        if (len == 0 || conn->closing || conn->draining) {
+            return;
+        }
+    }
+
+    if (conn->input_len + len > URING_INPUT_MAX) {
+        uring_conn_close(loop, conn);
+        return;
+    }
+    if (conn->input_len + len > conn->input_capacity) {
+        size_t capacity = conn->input_capacity ? conn->input_capacity : URING_RECV_BUFFER_SIZE;
+        while (capacity < conn->input_len + len) {
+            capacity *= 2;
+        }
+        char* input = realloc(conn->input, capacity);
+        if (!input) {
+            uring_conn_close(loop, conn);
+            return;
+        }
+        conn->input = input;
+        conn->input_capacity = capacity;
+    }
+    memcpy(conn->input + conn->input_len, data, len);
+    conn->input_len += len;
+
+    if (buffered) {
+        uring_conn_process_input(loop, conn);
+    }
+}
+
+static void uring_conn_open(uring_loop_t* loop, int fd) {
+    uring_conn_t* conn = NULL;
+    if ((loop->free_count > 0 || uring_grow_connections(loop) == 0) &&
+        (conn = calloc(1, sizeof(uring_conn_t))) != NULL) {
+        uint32_t slot = loop->free_slots[--loop->free_count];
+        uintptr_t generation_mask = URING_CONN_ID_MASK >> URING_SLOT_BITS;
+        loop->generation = (loop->generation + 1) & generation_mask;
+        if (loop->generation == 0) {
+            loop->generation = 1;   // 连接ID不为0
+        }
+        conn->id = (loop->generation << URING_SLOT_BITS) | slot;
+        conn->fd = fd;
+        conn->keep_alive = true;
+        loop->conns[slot] = conn;
+        uring_arm_recv(loop, conn);
+        uring_conn_try_free(loop, conn);
+        return;
+    }
+    close(fd);
+}
+
+// 完成项
+
+static void uring_complete_recv(uring_loop_t* loop, uring_conn_t* conn, const struct io_uring_cqe* cqe) {
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        conn->recv_armed = false;
+        conn->ops--;
+        loop->inflight--;
+    }
+
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        if (cqe->res > 0) {
+            uring_conn_received(loop, conn, loop->buf_memory + (size_t)bid * URING_RECV_BUFFER_SIZE,
+                                (size_t)cqe->res);
+        }
+        uring_recycle_buffer(loop, bid);
+    }
+
+    // ENOBUFS：缓冲区暂时用完，重新提交即可
+    if (cqe->res == 0 || (cqe->res < 0 && cqe->res != -ENOBUFS)) {
+        uring_conn_close(loop, conn);
+    } else if (!conn->recv_armed && !conn->closing) {
+        uring_arm_recv(loop, conn);
+    }
+}
+
+static void uring_complete_send(uring_loop_t* loop, uring_conn_t* conn, const struct io_uring_cqe* cqe) {
+    conn->sending = false;
+    conn->ops--;
+    loop->inflight--;
+
+    if (cqe->res < 0 || conn->closing) {
+        uring_conn_close(loop, conn);
+        return;
+    }
+
+    if (uring_out_advance(conn->out_head, (size_t)cqe->res)) {
+        uring_out_t* out = conn->out_head;
+        conn->out_head = out->next;
+        if (!conn->out_head) {
+            conn->out_tail = NULL;
+        }
+        uring_out_release(out);
+    }
+
+    if (conn->out_head) {
+        uring_conn_send(loop, conn);
+    } else if (conn->draining) {
+        uring_conn_close(loop, conn);
+    }
+}
+
+static void uring_complete(uring_loop_t* loop, const struct io_uring_cqe* cqe) {
+    uring_op_t op = (uring_op_t)(cqe->user_data & URING_OP_MASK);
+    void* target = (void*)(uintptr_t)(cqe->user_data & ~URING_OP_MASK);
+
+    switch (op) {
+        case URING_OP_ACCEPT:
+            // 出错(例如EMFILE)后多重接受结束，下次轮询重新提交
+            if (!(cqe->flags & IORING_CQE_F_MORE)) {
+                loop->accept_armed = false;
+                loop->inflight--;
+            }
+            if (cqe->res >= 0) {
+                if (loop->stopping) {
+                    close(cqe->res);
+                } else {
+                    uring_conn_open(loop, cqe->res);
+                }
+            }
+            break;
+        case URING_OP_WAKEUP:
+            loop->wakeup_armed = false;
+            loop->inflight--;
+            break;
+        case URING_OP_RECV:
+            uring_complete_recv(loop, (uring_conn_t*)target, cqe);
+            uring_conn_try_free(loop, (uring_conn_t*)target);
+            break;
+        case URING_OP_SEND:
+            uring_complete_send(loop, (uring_conn_t*)target, cqe);
+            uring_conn_try_free(loop, (uring_conn_t*)target);
+            break;
+        case URING_OP_IGNORE:
+            break;
+    }
+}
+
+static void uring_reap(uring_loop_t* loop) {
+    unsigned head = *loop->cq_head;
+    unsigned tail;
+    while (head != (tail = __atomic_load_n(loop->cq_tail, __ATOMIC_ACQUIRE))) {
+        while (head != tail) {
+            // 先复制并归还完成项，处理时可能再填写提交项
+            struct io_uring_cqe cqe = loop->cqes[head & loop->cq_mask];
+            head++;
+            __atomic_store_n(loop->cq_head, head, __ATOMIC_RELEASE);
+            uring_complete(loop, &cqe);
+        }
+    }
+}
+
+// 轮询
+
+// 在轮询线程上把其他线程排队的响应交给各自的连接
+static void uring_flush_replies(uring_loop_t* loop) {
+    pthread_mutex_lock(&loop->reply_mutex);
+    uring_out_t* out = loop->reply_head;
+    loop->reply_head = loop->reply_tail = NULL;
+    pthread_mutex_unlock(&loop->reply_mutex);
+
+    while (out) {
+        uring_out_t* next = out->next;
+        uring_conn_t* conn = uring_find_connection(loop, out->conn_id);
+        if (conn) {
+            uring_conn_append(loop, conn, out);
+            uring_conn_try_free(loop, conn);
+        } else {
+            uring_out_release(out);     // 客户端已断开
+        }
+        out = next;
+    }
+}
+
+// 响应结束的连接继续处理缓存里的后续请求
+static void uring_process_ready(uring_loop_t* loop) {
+    while (loop->ready) {
+        uring_conn_t* conn = loop->ready;
+        loop->ready = conn->ready_next;
+        conn->ready = false;
+        if (!conn->closing) {
+            uring_conn_process_input(loop, conn);
+        }
+        uring_conn_try_free(loop, conn);
+    }
+}
+
+static void uring_rearm(uring_loop_t* loop) {
+    if (!loop->accept_armed && loop->listen_fd >= 0 && !loop->stopping) {
+        uring_arm_accept(loop);
+    }
+    if (!loop->wakeup_armed && !loop->stopping) {
+        uring_arm_wakeup(loop);
+    }
+}
+
+static int uring_loop_poll(uring_loop_t* loop, int timeout_ms) {
+    if (!loop || !__atomic_load_n(&loop->in_use, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+
+    loop->poll_thread = pthread_self();
+    loop->poll_thread_known = true;
+
+    uring_rearm(loop);
+    uring_flush_replies(loop);
+    uring_process_ready(loop);
+
+    // 提交与等待在同一次进入内核中完成
+    if (uring_enter(loop, timeout_ms != 0, timeout_ms) != 0) {
+        return -1;
+    }
+    uring_reap(loop);
+    uring_flush_replies(loop);
+    uring_process_ready(loop);
+    uring_rearm(loop);
+
+    // 本轮产生的响应一次提交，不等下一次轮询
+    if (loop->sq_unsubmitted > 0) {
+        uring_enter(loop, false, 0);
+    }
+    return 0;
+}
+
+// 只调用write()，可在信号处理函数中使用
+static int uring_loop_wakeup(uring_loop_t* loop) {
+    if (!loop || !__atomic_load_n(&loop->in_use, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+
+    uint64_t one = 1;
+    return write(loop->wakeup_fd, &one, sizeof(one)) == sizeof(one) ? 0 : -1;
+}
+
+static bool uring_on_poll_thread(const uring_loop_t* loop) {
+    return loop->poll_thread_known && pthread_equal(pthread_self(), loop->poll_thread);
+}
+
+static int uring_send_reply(mcp_hal_connection_t handle, uring_reply_op_t op,
+                            const mcp_hal_http_responsev_t* response) {
+    uintptr_t conn_id = 0;
+    uring_loop_t* loop = uring_handle_loop(handle, &conn_id);
+    if (!loop || !response || response->header_count > MCP_HAL_IOV_MAX ||
+        response->body_count > MCP_HAL_IOV_MAX) {
+        if (response && response->release) response->release(response->owner);
+        return -1;
+    }
+
+    size_t body_len = uring_iov_length(response->body, response->body_count);
+    uring_out_t* out = uring_out_create(op, response);
+    if (!out) {
+        return -1;
+    }
+
+    // 非本循环的轮询线程(例如工作线程)不能操作环，排队等待轮询线程提交
+    if (!uring_on_poll_thread(loop)) {
+        out->conn_id = conn_id;
+        pthread_mutex_lock(&loop->reply_mutex);
+        if (loop->reply_tail) {
+            loop->reply_tail->next = out;
+        } else {
+            loop->reply_head = out;
+        }
+        loop->reply_tail = out;
+        pthread_mutex_unlock(&loop->reply_mutex);
+
+        uring_loop_wakeup(loop);
+        return (int)body_len;
+    }
+
+    // 先交出已排队的部分，同一响应的各个分块保持发送顺序
+    uring_flush_replies(loop);
+    uring_conn_t* conn = uring_find_connection(loop, conn_id);
+    if (!conn || conn->closing) {
+        uring_out_release(out);
+        return -1;  // 客户端已断开
+    }
+    uring_conn_append(loop, conn, out);
+    uring_conn_try_free(loop, conn);
+    return (int)body_len;
+}
+
+static int uring_send_plain(mcp_hal_connection_t conn, uring_reply_op_t op, const mcp_hal_http_response_t* response) {
+    if (!response) {
+        return -1;
+    }
+    mcp_hal_iovec_t headers = { response->headers, response->headers ? strlen(response->headers) : 0 };
+    mcp_hal_iovec_t body = { response->body, response->body ? response->body_len : 0 };
+    mcp_hal_http_responsev_t vectored = {
+        .status_code = response->status_code,
+        .headers = &headers,
+        .header_count = response->headers ? 1 : 0,
+        .body = &body,
+        .body_count = 1
+    };
+    return uring_send_reply(conn, op, &vectored);
+}
+
+static int uring_http_reply(mcp_hal_connection_t conn, const mcp_hal_http_response_t* response) {
+    return uring_send_plain(conn, URING_REPLY_FULL, response);
+}
+
+static int uring_http_replyv(mcp_hal_connection_t conn, const mcp_hal_http_responsev_t* response) {
+    return uring_send_reply(conn, URING_REPLY_FULL, response);
+}
+
+static int uring_http_stream_begin(mcp_hal_connection_t conn, const mcp_hal_http_response_t* response) {
+    return uring_send_plain(conn, URING_REPLY_STREAM_BEGIN, response);
+}
+
+static int uring_http_stream_write(mcp_hal_connection_t conn, const char* data, size_t len) {
+    if (!data || len == 0) {
+        return -1;  // 空块表示结束，只能由http_stream_end发送
+    }
+    mcp_hal_http_response_t chunk = { .body = data, .body_len = len };
+    return uring_send_plain(conn, URING_REPLY_STREAM_CHUNK, &chunk);
+}
+
+static int uring_http_stream_end(mcp_hal_connection_t conn) {
+    mcp_hal_http_response_t end = { .body = "", .body_len = 0 };
+    return uring_send_plain(conn, URING_REPLY_STREAM_END, &end);
+}
+
+// 服务器
+
+// 与mongoose后端的SO_REUSEPORT监听相同，地址解析借用mongoose
+static int uring_listen_socket(const char* url, unsigned int flags) {
+    struct mg_addr addr;
+    memset(&addr, 0, sizeof(addr));
+    if (!mg_aton(mg_url_host(url), &addr)) {
+        return -1;
+    }
+    addr.port = mg_htons(mg_url_port(url));
+
+    union {
+        struct sockaddr sa;
+        struct sockaddr_in sin;
+        struct sockaddr_in6 sin6;
+    } usa;
+    memset(&usa, 0, sizeof(usa));
+    socklen_t slen;
+    if (addr.is_ip6) {
+        usa.sin6.sin6_family = AF_INET6;
+        usa.sin6.sin6_port = addr.port;
+        memcpy(&usa.sin6.sin6_addr, addr.ip, 16);
+        slen = sizeof(usa.sin6);
+    } else {
+        usa.sin.sin_family = AF_INET;
+        usa.sin.sin_port = addr.port;
+        memcpy(&usa.sin.sin_addr, addr.ip, 4);
+        slen = sizeof(usa.sin);
+    }
+
+    int fd = socket(usa.sa.sa_family, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int on = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+        ((flags & MCP_HAL_SERVER_REUSE_PORT) && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) ||
+        (addr.is_ip6 && setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on)) != 0) ||
+        bind(fd, &usa.sa, slen) != 0 ||
+        listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void uring_loop_close(uring_loop_t* loop) {
+    if (loop->listen_fd >= 0) close(loop->listen_fd);
+    if (loop->wakeup_fd >= 0) close(loop->wakeup_fd);
+    loop->listen_fd = loop->wakeup_fd = -1;
+    uring_close_ring(loop);
+
+    free(loop->conns);
+    free(loop->free_slots);
+    loop->conns = NULL;
+    loop->free_slots = NULL;
+    loop->conn_capacity = loop->free_count = 0;
+}
+
+static int uring_loop_open(uring_loop_t* loop, const char* url, unsigned int flags) {
+    loop->ring_fd = loop->listen_fd = loop->wakeup_fd = -1;
+    loop->ring = NULL;
+    loop->sqes = NULL;
+    loop->buf_ring = NULL;
+    loop->buf_memory = NULL;
+    loop->conns = NULL;
+    loop->free_slots = NULL;
+    loop->conn_capacity = loop->free_count = 0;
+    loop->generation = 0;
+    loop->ready = NULL;
+    loop->accept_armed = loop->wakeup_armed = false;
+    loop->stopping = false;
+
+    if (uring_setup(loop) != 0 || uring_setup_buffers(loop) != 0 ||
+        (loop->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0 ||
+        (loop->listen_fd = uring_listen_socket(url, flags)) < 0) {
+        uring_loop_close(loop);
+        return -1;
+    }
+    return 0;
+}
+
+static mcp_hal_server_t uring_server_start_ex(const char* url, unsigned int flags,
+                                              mcp_hal_http_handler_t handler, void* user_data) {
+    pthread_mutex_lock(&g_loops_mutex);
+    uring_loop_t* loop = NULL;
+    for (size_t i = 0; i < URING_LOOP_MAX; i++) {
+        if (!__atomic_load_n(&g_loops[i].in_use, __ATOMIC_ACQUIRE)) {
+            loop = &g_loops[i];
+            break;
+        }
+    }
+    if (!loop) {
+        pthread_mutex_unlock(&g_loops_mutex);
+        return NULL;
+    }
+
+    // 槽位的互斥锁只初始化一次，停止后仍可能有发送方短暂访问
+    if (!loop->mutex_ready) {
+        pthread_mutex_init(&loop->reply_mutex, NULL);
+        loop->mutex_ready = true;
+    }
+
+    if (uring_loop_open(loop, url, flags) != 0) {
+        pthread_mutex_unlock(&g_loops_mutex);
+        return NULL;
+    }
+
+    loop->handler = handler;
+    loop->user_data = user_data;
+    loop->close_handler = NULL;
+    loop->poll_thread_known = false;
+    loop->reply_head = loop->reply_tail = NULL;
+    __atomic_store_n(&loop->in_use, true, __ATOMIC_RELEASE);
+
+    int index = (int)(loop - g_loops);
+    int none = -1;
+    __atomic_compare_exchange_n(&g_default_loop, &none, index, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_loops_mutex);
+
+    return (mcp_hal_server_t)loop;
+}
+
+static mcp_hal_server_t uring_server_start(const char* url, mcp_hal_http_handler_t handler, void* user_data) {
+    return uring_server_start_ex(url, 0, handler, user_data);
+}
+
+// 在轮询该服务器的线程上调用(或该线程已不再轮询时)
+static int uring_server_stop(mcp_hal_server_t server) {
+    uring_loop_t* loop = (uring_loop_t*)server;
+    if (!loop || !__atomic_load_n(&loop->in_use, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+
+    // 客户端连接一并关闭，连接槽的所有者(传输层)此后可能已不存在；
+    // 已排队的响应随一次提交发出
+    uring_flush_replies(loop);
+    for (size_t slot = 0; slot < loop->conn_capacity; slot++) {
+        uring_conn_t* conn = loop->conns[slot];
+        if (conn) {
+            conn->slot = NULL;
+            conn->draining = true;
+        }
+    }
+    uring_enter(loop, false, 0);
+    uring_reap(loop);
+
+    pthread_mutex_lock(&g_loops_mutex);
+    __atomic_store_n(&loop->in_use, false, __ATOMIC_RELEASE);
+    int index = (int)(loop - g_loops);
+    __atomic_compare_exchange_n(&g_default_loop, &index, -1, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_loops_mutex);
+
+    // 取消其余请求并等它们全部结束，之后内核不再访问接收缓冲区和待发送的数据
+    loop->stopping = true;
+    for (size_t slot = 0; slot < loop->conn_capacity; slot++) {
+        uring_conn_t* conn = loop->conns[slot];
+        if (conn) {
+            uring_conn_close(loop, conn);
+            uring_conn_try_free(loop, conn);
+        }
+    }
+    struct io_uring_sqe* sqe = uring_get_sqe(loop);
+    if (sqe) {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+        sqe->user_data = uring_tag(NULL, URING_OP_IGNORE);
+    }
+    while (loop->inflight > 0 && uring_enter(loop, true, -1) == 0) {
+        uring_reap(loop);
+    }
+    // 提交最后的关闭请求
+    uring_enter(loop, false, 0);
+    uring_loop_close(loop);
+
+    // 停止后才到达的响应已无处可发
+    pthread_mutex_lock(&loop->reply_mutex);
+    uring_out_t* out = loop->reply_head;
+    loop->reply_head = loop->reply_tail = NULL;
+    pthread_mutex_unlock(&loop->reply_mutex);
+    while (out) {
+        uring_out_t* next = out->next;
+        uring_out_release(out);
+        out = next;
+    }
+    return 0;
+}
+
+static int uring_server_set_close_handler(mcp_hal_server_t server, mcp_hal_http_close_handler_t handler) {
+    if (!server) {
+        return -1;
+    }
+    ((uring_loop_t*)server)->close_handler = handler;
+    return 0;
+}
+
+static uring_loop_t* uring_default_loop(void) {
+    int index = __atomic_load_n(&g_default_loop, __ATOMIC_ACQUIRE);
+    if (index < 0 || !__atomic_load_n(&g_loops[index].in_use, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    return &g_loops[index];
+}
+
+static int uring_poll(int timeout_ms) {
+    return uring_loop_poll(uring_default_loop(), timeout_ms);
+}
+
+static int uring_wakeup(void) {
+    return uring_loop_wakeup(uring_default_loop());
+}
+
+static int uring_server_poll(mcp_hal_server_t server, int timeout_ms) {
+    return uring_loop_poll((uring_loop_t*)server, timeout_ms);
+}
+
+static int uring_server_wakeup(mcp_hal_server_t server) {
+    return uring_loop_wakeup((uring_loop_t*)server);
+}
+
+// 运行中的内核是否支持：在socketpair上提交一个多重接收，看它是否从缓冲区环取到数据
+static bool uring_probe(void) {
+    uring_loop_t loop;
+    memset(&loop, 0, sizeof(loop));
+    loop.ring_fd = loop.listen_fd = loop.wakeup_fd = -1;
+    int pair[2] = { -1, -1 };
+    bool supported = false;
+
+    if (uring_setup(&loop) == 0 && uring_setup_buffers(&loop) == 0 &&
+        socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) == 0) {
+        struct io_uring_sqe* sqe = uring_get_sqe(&loop);
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = pair[0];
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = URING_RECV_GROUP;
+
+        if (write(pair[1], "x", 1) == 1 && uring_enter(&loop, true, 1000) == 0) {
+            unsigned head = *loop.cq_head;
+            if (head != __atomic_load_n(loop.cq_tail, __ATOMIC_ACQUIRE)) {
+                const struct io_uring_cqe* cqe = &loop.cqes[head & loop.cq_mask];
+                supported = cqe->res == 1 && (cqe->flags & IORING_CQE_F_BUFFER) &&
+                            (cqe->flags & IORING_CQE_F_MORE);
+            }
+        }
+    }
+
+    // 先关闭socket结束接收，再拆除环
+    if (pair[0] >= 0) close(pair[0]);
+    if (pair[1] >= 0) close(pair[1]);
+    uring_loop_close(&loop);
+    return supported;
+}
+
+static const mcp_platform_network_t g_uring_network = {
+    .http_server_start = uring_server_start,
+    .http_response_send = uring_http_reply,
+    .http_response_sendv = uring_http_replyv,
+    .network_poll = uring_poll,
+    .network_wakeup = uring_wakeup,
+    .http_server_stop = uring_server_stop,
+    .http_server_set_close_handler = uring_server_set_close_handler,
+    .http_stream_begin = uring_http_stream_begin,
+    .http_stream_write = uring_http_stream_write,
+    .http_stream_end = uring_http_stream_end,
+    .http_server_start_ex = uring_server_start_ex,
+    .http_server_poll = uring_server_poll,
+    .http_server_wakeup = uring_server_wakeup,
+
+    .socket_create = NULL,
+    .socket_bind = NULL,
+    .socket_send = NULL,
+    .socket_recv = NULL,
+    .socket_close = NULL
+};
+
+static pthread_once_t g_probe_once = PTHREAD_ONCE_INIT;
+static bool g_supported = false;
+
+static void uring_probe_once(void) {
+    g_supported = uring_probe();
+}
+
+const mcp_platform_network_t* linux_uring_network(void) {
+    pthread_once(&g_probe_once, uring_probe_once);
+    return g_supported ? &g_uring_network : NULL;
+}
+
+void linux_uring_cleanup(void) {
+    pthread_mutex_lock(&g_out_mutex);
+    uring_out_t* out = g_out_free;
+    g_out_free = NULL;
+    g_out_free_count = 0;
+    pthread_mutex_unlock(&g_out_mutex);
+
+    while (out) {
+        uring_out_t* next = out->next;
+        free(out->buffer);
+        free(out);
+        out = next;
+    }
+}
+
+#else
+
+const mcp_platform_network_t* linux_uring_network(void) {
+    return NULL;
+}
+
+void linux_uring_cleanup(void) {
+}
+
+#endif // MCP_ENABLE_IO_URING
@@ -0,0 +1,26 @@
+#ifndef LINUX_URING_HTTP_H
+#define LINUX_URING_HTTP_H
+
+#include "../../hal/platform_hal.h"
+
+// io_uring HTTP backend for the Linux HAL - called by HAL layer
+//
+// Built with IO_URING=1 (MCP_ENABLE_IO_URING). Listeners use multishot accept, each
+// connection one multishot recv into a ring of kernel-registered provided buffers, and
+// replies go out as sendmsg requests. Everything a poll produces is submitted in one
+// io_uring_enter() batch. Requests are parsed with mongoose's HTTP parser and handed
+// to the same mcp_hal_http_handler_t as the mongoose backend.
+
+/**
+ * Get the io_uring network interface
+ * @return Network interface, NULL if not built in or the running kernel lacks
+ *         multishot recv or provided buffer rings (Linux 6.0)
+ */
+const mcp_platform_network_t* linux_uring_network(void);
+
+/**
+ * Free pooled reply buffers; called from platform cleanup
+ */
+void linux_uring_cleanup(void);
+
+#endif // LINUX_URING_HTTP_H
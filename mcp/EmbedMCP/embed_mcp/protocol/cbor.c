@@ -0,0 +1,597 @@
+#include "protocol/cbor.h"
+#include "utils/base64.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <pthread.h>
+
+// CBOR major types
+#define CBOR_UINT   0
+#define CBOR_NINT   1
+#define CBOR_BYTES  2
+#define CBOR_TEXT   3
+#define CBOR_ARRAY  4
+#define CBOR_MAP    5
+#define CBOR_TAG    6
+#define CBOR_SIMPLE 7
+
+#define CBOR_INDEFINITE 31
+#define CBOR_BREAK      0xFF
+
+// Transcoding buffers above this size are released after use
+#define CBOR_THREAD_BUFFER_KEEP_LIMIT (64 * 1024)
+
+bool mcp_cbor_is_message(const void *data, size_t length) {
+    if (!data || length == 0) return false;
+    uint8_t major = ((const uint8_t*)data)[0] >> 5;
+    return major == CBOR_ARRAY || major == CBOR_MAP;
+}
+
+// =============================================================================
+// Decoding
+// =============================================================================
+
+typedef struct {
+    const uint8_t *data;
+    const uint8_t *end;
+    int depth;
+} cbor_reader_t;
+
+// Initial byte and argument of an item; additional info 31 marks indefinite length
+// (or a break), and tells floats apart by size
+typedef struct {
+    uint8_t major;
+    uint8_t info;
+    uint64_t argument;
+} cbor_head_t;
+
+static int cbor_read_head(cbor_reader_t *reader, cbor_head_t *head) {
+    if (reader->data >= reader->end) return -1;
+
+    uint8_t initial = *reader->data++;
+    head->major = initial >> 5;
+    head->info = initial & 31;
+    head->argument = head->info;
+
+    if (head->info < 24 || head->info == CBOR_INDEFINITE) return 0;
+    if (head->info > 27) return -1;
+
+    size_t size = (size_t)1 << (head->info - 24);
+    if ((size_t)(reader->end - reader->data) < size) return -1;
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value = (value << 8) | reader->data[i];
+    }
+    reader->data += size;
+    head->argument = value;
+    return 0;
+}
+
+// Read a byte or text string (chunks of an indefinite one are joined) into a
+// cJSON-allocated, NUL-terminated copy
+static char *cbor_read_string(cbor_reader_t *reader, const cbor_head_t *head, size_t *length) {
+    if (head->info != CBOR_INDEFINITE) {
+        uint64_t argument = head->argument;
+        if (argument > (uint64_t)(reader->end - reader->data)) return NULL;
+        char *copy = cJSON_malloc((size_t)argument + 1);
+        if (!copy) return NULL;
+        memcpy(copy, reader->data, (size_t)argument);
+        copy[argument] = '\0';
+        reader->data += argument;
+        *length = (size_t)argument;
+        return copy;
+    }
+
+    char *joined = NULL;
+    size_t total = 0;
+    for (;;) {
+        if (reader->data >= reader->end) break;
+        if (*reader->data == CBOR_BREAK) {
+            reader->data++;
+            if (!joined) joined = cJSON_malloc(1);
+            if (joined) joined[total] = '\0';
+            *length = total;
+            return joined;
+        }
+
+        cbor_head_t chunk;
+        if (cbor_read_head(reader, &chunk) != 0 || chunk.major != head->major ||
+            chunk.info == CBOR_INDEFINITE || chunk.argument > (uint64_t)(reader->end - reader->data)) {
+            break;
+        }
+        size_t chunk_length = (size_t)chunk.argument;
+
+        char *grown = cJSON_malloc(total + chunk_length + 1);
+        if (!grown) break;
+        if (joined) {
+            memcpy(grown, joined, total);
+            cJSON_free(joined);
+        }
+        joined = grown;
+        memcpy(joined + total, reader->data, chunk_length);
+        total += chunk_length;
+        reader->data += chunk_length;
+    }
+
+    cJSON_free(joined);
+    return NULL;
+}
+
+static cJSON *cbor_string_item(char *text) {
+    cJSON *item = cJSON_CreateNull();
+    if (!item) {
+        cJSON_free(text);
+        return NULL;
+    }
+    item->type = cJSON_String;
+    item->valuestring = text;
+    return item;
+}
+
+static double cbor_half_to_double(uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value;
+    if (exponent == 0) {
+        value = ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    } else {
+        value = mantissa == 0 ? INFINITY : NAN;
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+// Append to a container without cJSON_AddItemToArray's walk to the tail
+static void cbor_append(cJSON *container, cJSON *item) {
+    if (!container->child) {
+        container->child = item;
+        item->prev = item;
+    } else {
+        cJSON *tail = container->child->prev;
+        tail->next = item;
+        item->prev = tail;
+        container->child->prev = item;
+    }
+}
+
+static cJSON *cbor_read_item(cbor_reader_t *reader);
+
+static bool cbor_at_break(cbor_reader_t *reader) {
+    if (reader->data < reader->end && *reader->data == CBOR_BREAK) {
+        reader->data++;
+        return true;
+    }
+    return false;
+}
+
+static cJSON *cbor_read_container(cbor_reader_t *reader, const cbor_head_t *head) {
+    uint8_t major = head->major;
+    uint64_t count = head->argument;
+    bool indefinite = head->info == CBOR_INDEFINITE;
+
+    // Every entry takes at least one byte (two for a map), so a bogus count fails early
+    uint64_t remaining = (uint64_t)(reader->end - reader->data);
+    if (!indefinite && count > (major == CBOR_MAP ? remaining / 2 : remaining)) return NULL;
+    if (++reader->depth > MCP_CBOR_MAX_DEPTH) return NULL;
+
+    cJSON *container = major == CBOR_MAP ? cJSON_CreateObject() : cJSON_CreateArray();
+    if (!container) return NULL;
+
+    for (uint64_t i = 0; indefinite || i < count; i++) {
+        if (indefinite && cbor_at_break(reader)) break;
+
+        char *key = NULL;
+        if (major == CBOR_MAP) {
+            cbor_head_t key_head;
+            size_t key_length;
+            if (cbor_read_head(reader, &key_head) != 0 || key_head.major != CBOR_TEXT ||
+                !(key = cbor_read_string(reader, &key_head, &key_length))) {
+                cJSON_Delete(container);
+                return NULL;
+            }
+        }
+
+        cJSON *item = cbor_read_item(reader);
+        if (!item) {
+            cJSON_free(key);
+            cJSON_Delete(container);
+            return NULL;
+        }
+        item->string = key;
+        cbor_append(container, item);
+    }
+
+    reader->depth--;
+    return container;
+}
+
+static cJSON *cbor_read_item(cbor_reader_t *reader) {
+    cbor_head_t head;
+    if (cbor_read_head(reader, &head) != 0) return NULL;
+
+    bool indefinite = head.info == CBOR_INDEFINITE;
+    size_t length;
+
+    switch (head.major) {
+        case CBOR_UINT:
+            return indefinite ? NULL : cJSON_CreateNumber((double)head.argument);
+        case CBOR_NINT:
+            return indefinite ? NULL : cJSON_CreateNumber(-1.0 - (double)head.argument);
+        case CBOR_TEXT: {
+            char *text = cbor_read_string(reader, &head, &length);
+            return text ? cbor_string_item(text) : NULL;
+        }
+        case CBOR_BYTES: {
+            char *bytes = cbor_read_string(reader, &head, &length);
+            if (!bytes) return NULL;
+            char *text = cJSON_malloc(base64_encoded_size(length) + 1);
+            if (text) {
+                text[base64_encode_raw((const unsigned char*)bytes, length, text)] = '\0';
+            }
+            cJSON_free(bytes);
+            return text ? cbor_string_item(text) : NULL;
+        }
+        case CBOR_ARRAY:
+        case CBOR_MAP:
+            return cbor_read_container(reader, &head);
+        case CBOR_TAG: {
+            // Tags (bignums, dates...) add nothing JSON can carry: keep the tagged item
+            if (indefinite || ++reader->depth > MCP_CBOR_MAX_DEPTH) return NULL;
+            cJSON *item = cbor_read_item(reader);
+            reader->depth--;
+            return item;
+        }
+        default:
+            break;
+    }
+
+    // Simple values and floats
+    switch (head.info) {
+        case 20: return cJSON_CreateFalse();
+        case 21: return cJSON_CreateTrue();
+        case 22:
+        case 23: return cJSON_CreateNull();     // null, undefined
+        case 25: return cJSON_CreateNumber(cbor_half_to_double((uint16_t)head.argument));
+        case 26: {
+            uint32_t bits = (uint32_t)head.argument;
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return cJSON_CreateNumber(value);
+        }
+        case 27: {
+            uint64_t bits = head.argument;
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return cJSON_CreateNumber(value);
+        }
+        default:
+            return NULL;
+    }
+}
+
+cJSON *mcp_cbor_decode(const uint8_t *data, size_t length) {
+    if (!data || length == 0) return NULL;
+
+    cbor_reader_t reader = { .data = data, .end = data + length, .depth = 0 };
+    cJSON *item = cbor_read_item(&reader);
+    if (item && reader.data != reader.end) {
+        cJSON_Delete(item);
+        return NULL;
+    }
+    return item;
+}
+
+// =============================================================================
+// Transcoding JSON text
+// =============================================================================
+
+static int cbor_write_head(mcp_json_buffer_t *out, uint8_t major, uint64_t argument) {
+    if (mcp_json_buffer_reserve(out, 9) != 0) return -1;
+
+    uint8_t *p = (uint8_t*)out->data + out->length;
+    uint8_t type = (uint8_t)(major << 5);
+    size_t size;
+
+    if (argument < 24) {
+        p[0] = type | (uint8_t)argument;
+        out->length += 1;
+        return 0;
+    } else if (argument <= 0xFF) {
+        p[0] = type | 24;
+        size = 1;
+    } else if (argument <= 0xFFFF) {
+        p[0] = type | 25;
+        size = 2;
+    } else if (argument <= 0xFFFFFFFFull) {
+        p[0] = type | 26;
+        size = 4;
+    } else {
+        p[0] = type | 27;
+        size = 8;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        p[size - i] = (uint8_t)(argument >> (8 * i));
+    }
+    out->length += 1 + size;
+    return 0;
+}
+
+static int cbor_write_byte(mcp_json_buffer_t *out, uint8_t byte) {
+    if (mcp_json_buffer_reserve(out, 1) != 0) return -1;
+    out->data[out->length++] = (char)byte;
+    return 0;
+}
+
+static int cbor_hex4(const char *p, const char *end, unsigned int *value) {
+    if (end - p < 4) return -1;
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        unsigned int digit;
+        if (c >= '0' && c <= '9') digit = (unsigned int)(c - '0');
+        else if (c >= 'a' && c <= 'f') digit = (unsigned int)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') digit = (unsigned int)(c - 'A' + 10);
+        else return -1;
+        *value = (*value << 4) | digit;
+    }
+    return 0;
+}
+
+// Decode one escape sequence (p after the backslash) to UTF-8. Returns its length in
+// bytes, writing them to utf8 when not NULL, and advances p; -1 when malformed.
+static int cbor_unescape(const char **p, const char *end, uint8_t *utf8) {
+    if (*p >= end) return -1;
+
+    char c = *(*p)++;
+    uint8_t simple;
+    switch (c) {
+        case '"': simple = '"'; break;
+        case '\\': simple = '\\'; break;
+        case '/': simple = '/'; break;
+        case 'b': simple = '\b'; break;
+        case 'f': simple = '\f'; break;
+        case 'n': simple = '\n'; break;
+        case 'r': simple = '\r'; break;
+        case 't': simple = '\t'; break;
+        case 'u': {
+            unsigned int code;
+            if (cbor_hex4(*p, end, &code) != 0) return -1;
+            *p += 4;
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                unsigned int low;
+                if (end - *p < 6 || (*p)[0] != '\\' || (*p)[1] != 'u' ||
+                    cbor_hex4(*p + 2, end, &low) != 0 || low < 0xDC00 || low > 0xDFFF) {
+                    return -1;
+                }
+                *p += 6;
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+
+            uint8_t bytes[4];
+            int count;
+            if (code < 0x80) {
+                bytes[0] = (uint8_t)code;
+                count = 1;
+            } else if (code < 0x800) {
+                bytes[0] = (uint8_t)(0xC0 | (code >> 6));
+                bytes[1] = (uint8_t)(0x80 | (code & 0x3F));
+                count = 2;
+            } else if (code < 0x10000) {
+                bytes[0] = (uint8_t)(0xE0 | (code >> 12));
+                bytes[1] = (uint8_t)(0x80 | ((code >> 6) & 0x3F));
+                bytes[2] = (uint8_t)(0x80 | (code & 0x3F));
+                count = 3;
+            } else {
+                bytes[0] = (uint8_t)(0xF0 | (code >> 18));
+                bytes[1] = (uint8_t)(0x80 | ((code >> 12) & 0x3F));
+                bytes[2] = (uint8_t)(0x80 | ((code >> 6) & 0x3F));
+                bytes[3] = (uint8_t)(0x80 | (code & 0x3F));
+                count = 4;
+            }
+            if (utf8) memcpy(utf8, bytes, (size_t)count);
+            return count;
+        }
+        default:
+            return -1;
+    }
+
+    if (utf8) *utf8 = simple;
+    return 1;
+}
+
+// A JSON string (p after the opening quote) as a CBOR text string. Strings without
+// escapes - nearly all of them - are copied in one piece.
+static int cbor_transcode_string(mcp_json_buffer_t *out, const char **cursor, const char *end) {
+    const char *start = *cursor;
+    const char *p = start;
+    size_t decoded = 0;
+    bool escaped = false;
+
+    // First pass: find the closing quote and the decoded length
+    while (p < end && *p != '"') {
+        if (*p == '\\') {
+            p++;
+            int count = cbor_unescape(&p, end, NULL);
+            if (count < 0) return -1;
+            decoded += (size_t)count;
+            escaped = true;
+        } else {
+            p++;
+            decoded++;
+        }
+    }
+    if (p >= end) return -1;
+    const char *close = p;
+
+    if (cbor_write_head(out, CBOR_TEXT, decoded) != 0 ||
+        mcp_json_buffer_reserve(out, decoded) != 0) {
+        return -1;
+    }
+
+    uint8_t *dest = (uint8_t*)out->data + out->length;
+    if (!escaped) {
+        memcpy(dest, start, decoded);
+    } else {
+        for (p = start; p < close;) {
+            if (*p == '\\') {
+                p++;
+                dest += cbor_unescape(&p, end, dest);
+            } else {
+                *dest++ = (uint8_t)*p++;
+            }
+        }
+    }
+    out->length += decoded;
+
+    *cursor = close + 1;
+    return 0;
+}
+
+static int cbor_transcode_number(mcp_json_buffer_t *out, const char **cursor, const char *end) {
+    const char *start = *cursor;
+    const char *p = start;
+    bool integer = true;
+
+    while (p < end && ((*p >= '0' && *p <= '9') || *p == '+' || *p == '-' || *p == '.' || *p == 'e' || *p == 'E')) {
+        if (*p == '.' || *p == 'e' || *p == 'E') integer = false;
+        p++;
+    }
+
+    char text[64];
+    size_t length = (size_t)(p - start);
+    if (length == 0 || length >= sizeof(text)) return -1;
+    memcpy(text, start, length);
+    text[length] = '\0';
+    *cursor = p;
+
+    if (integer && length < 19) {
+        long long value = strtoll(text, NULL, 10);
+        return value < 0 ? cbor_write_head(out, CBOR_NINT, (uint64_t)(-1 - value))
+                         : cbor_write_head(out, CBOR_UINT, (uint64_t)value);
+    }
+
+    double value = strtod(text, NULL);
+    if (mcp_json_buffer_reserve(out, 9) != 0) return -1;
+
+    // Narrowing a double outside float's range is undefined, so only try it within range
+    bool narrow = isnan(value) || (isfinite(value) && fabs(value) <= FLT_MAX);
+    float single = narrow ? (float)value : 0.0f;
+    uint8_t *dest = (uint8_t*)out->data + out->length;
+    if (narrow && ((double)single == value || isnan(value))) {
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        dest[0] = (CBOR_SIMPLE << 5) | 26;
+        for (int i = 0; i < 4; i++) dest[4 - i] = (uint8_t)(bits >> (8 * i));
+        out->length += 5;
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        dest[0] = (CBOR_SIMPLE << 5) | 27;
+        for (int i = 0; i < 8; i++) dest[8 - i] = (uint8_t)(bits >> (8 * i));
+        out->length += 9;
+    }
+    return 0;
+}
+
+static int cbor_transcode_literal(mcp_json_buffer_t *out, const char **cursor, const char *end,
+                                  const char *literal, uint8_t simple) {
+    size_t length = strlen(literal);
+    if ((size_t)(end - *cursor) < length || memcmp(*cursor, literal, length) != 0) return -1;
+    *cursor += length;
+    return cbor_write_byte(out, (CBOR_SIMPLE << 5) | simple);
+}
+
+int mcp_cbor_from_json(mcp_json_buffer_t *out, const char *json, size_t length) {
+    if (!out || !json) return -1;
+
+    const char *p = json;
+    const char *end = json + length;
+    int depth = 0;
+    int result = 0;
+
+    while (p < end && result == 0) {
+        switch (*p) {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+            case ',':
+            case ':':
+                p++;
+                break;
+            case '{':
+                p++;
+                depth++;
+                result = cbor_write_byte(out, (CBOR_MAP << 5) | CBOR_INDEFINITE);
+                break;
+            case '[':
+                p++;
+                depth++;
+                result = cbor_write_byte(out, (CBOR_ARRAY << 5) | CBOR_INDEFINITE);
+                break;
+            case '}':
+            case ']':
+                p++;
+                if (--depth < 0) return -1;
+                result = cbor_write_byte(out, CBOR_BREAK);
+                break;
+            case '"':
+                p++;
+                result = cbor_transcode_string(out, &p, end);
+                break;
+            case 't':
+                result = cbor_transcode_literal(out, &p, end, "true", 21);
+                break;
+            case 'f':
+                result = cbor_transcode_literal(out, &p, end, "false", 20);
+                break;
+            case 'n':
+                result = cbor_transcode_literal(out, &p, end, "null", 22);
+                break;
+            default:
+                result = cbor_transcode_number(out, &p, end);
+                break;
+        }
+    }
+
+    return result == 0 && depth == 0 ? 0 : -1;
+}
+
+// Per-thread transcoding buffer, released when the thread exits
+static pthread_key_t g_cbor_buffer_key;
+static pthread_once_t g_cbor_buffer_once = PTHREAD_ONCE_INIT;
+
+static void cbor_buffer_destroy(void *arg) {
+    mcp_json_buffer_t *buffer = (mcp_json_buffer_t*)arg;
+    mcp_json_buffer_free(buffer);
+    free(buffer);
+}
+
+static void cbor_buffer_key_init(void) {
+    pthread_key_create(&g_cbor_buffer_key, cbor_buffer_destroy);
+}
+
+mcp_json_buffer_t *mcp_cbor_thread_buffer(void) {
+    pthread_once(&g_cbor_buffer_once, cbor_buffer_key_init);
+
+    mcp_json_buffer_t *buffer = pthread_getspecific(g_cbor_buffer_key);
+    if (!buffer) {
+        buffer = malloc(sizeof(mcp_json_buffer_t));
+        if (!buffer) return NULL;
+        mcp_json_buffer_init(buffer);
+        if (pthread_setspecific(g_cbor_buffer_key, buffer) != 0) {
+            free(buffer);
+            return NULL;
+        }
+    }
+
+    if (buffer->capacity > CBOR_THREAD_BUFFER_KEEP_LIMIT) {
+        mcp_json_buffer_free(buffer);
+    }
+    mcp_json_buffer_reset(buffer);
+    return buffer;
+}
@@ -0,0 +1,48 @@
+#ifndef MCP_CBOR_H
+#define MCP_CBOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cjson/cJSON.h"
+#include "protocol/json_writer.h"
+
+/**
+ * CBOR (RFC 8949) wire encoding for JSON-RPC messages on constrained links.
+ *
+ * Inbound messages decode straight into the cJSON tree jsonrpc_parse_document()
+ * would have built from the equivalent JSON text, so everything above the parser
+ * is unchanged. Outbound messages are written as JSON text by the usual writers
+ * and transcoded in one pass, without building a tree.
+ *
+ * CBOR is only decoded on connections flagged MCP_CONNECTION_FLAG_CBOR, which a
+ * transport sets once its link is configured for CBOR. A JSON-RPC message is a
+ * CBOR map or array, whose first byte (0x80-0xBF) can never start JSON text, so
+ * such a transport can still tell a stray JSON frame apart.
+ */
+
+// Deepest nesting accepted from the wire
+#define MCP_CBOR_MAX_DEPTH 128
+
+// True when data holds a CBOR message rather than JSON text
+bool mcp_cbor_is_message(const void *data, size_t length);
+
+/**
+ * Decode one CBOR item filling all of data
+ * Byte strings become base64 strings, as blobs are in JSON; tags are skipped.
+ * @return cJSON tree (free with cJSON_Delete), or NULL when malformed
+ */
+cJSON *mcp_cbor_decode(const uint8_t *data, size_t length);
+
+/**
+ * Transcode JSON text to CBOR, appending to out. Containers are written with
+ * indefinite length, integers in their shortest form, and other numbers as
+ * single precision when that is exact.
+ * @return 0 on success, -1 on malformed input or allocation failure
+ */
+int mcp_cbor_from_json(mcp_json_buffer_t *out, const char *json, size_t length);
+
+// Buffer owned by the calling thread for transcoding; distinct from mcp_json_thread_buffer()
+mcp_json_buffer_t *mcp_cbor_thread_buffer(void);
+
+#endif // MCP_CBOR_H
@@ -0,0 +1,455 @@
+#include "protocol/json_writer.h"
+#include "utils/base64.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JSON_BUFFER_MIN_CAPACITY 256
+#define JSON_THREAD_BUFFER_KEEP_LIMIT (1024 * 1024)  // Larger buffers are released after use
+
+// Buffer management
+void mcp_json_buffer_init(mcp_json_buffer_t *buffer) {
+    if (!buffer) return;
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+void mcp_json_buffer_reset(mcp_json_buffer_t *buffer) {
+    if (!buffer) return;
+    buffer->length = 0;
+    if (buffer->data) {
+        buffer->data[0] = '\0';
+    }
+}
+
+void mcp_json_buffer_free(mcp_json_buffer_t *buffer) {
+    if (!buffer) return;
+    free(buffer->data);
+    mcp_json_buffer_init(buffer);
+}
+
+int mcp_json_buffer_reserve(mcp_json_buffer_t *buffer, size_t additional) {
+    if (!buffer) return -1;
+
+    // Always keep room for the terminating NUL
+    size_t needed = buffer->length + additional + 1;
+    if (needed <= buffer->capacity) return 0;
+
+    size_t capacity = buffer->capacity ? buffer->capacity : JSON_BUFFER_MIN_CAPACITY;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+
+    char *data = realloc(buffer->data, capacity);
+    if (!data) return -1;
+
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+char *mcp_json_buffer_detach(mcp_json_buffer_t *buffer) {
+    if (!buffer) return NULL;
+
+    if (!buffer->data && mcp_json_buffer_reserve(buffer, 0) != 0) {
+        return NULL;
+    }
+    buffer->data[buffer->length] = '\0';
+
+    char *data = buffer->data;
+    mcp_json_buffer_init(buffer);
+    return data;
+}
+
+// Per-thread buffer, released when the thread exits
+static pthread_key_t g_thread_buffer_key;
+static pthread_once_t g_thread_buffer_once = PTHREAD_ONCE_INIT;
+
+static void thread_buffer_destroy(void *arg) {
+    mcp_json_buffer_t *buffer = (mcp_json_buffer_t*)arg;
+    mcp_json_buffer_free(buffer);
+    free(buffer);
+}
+
+static void thread_buffer_key_init(void) {
+    pthread_key_create(&g_thread_buffer_key, thread_buffer_destroy);
+}
+
+mcp_json_buffer_t *mcp_json_thread_buffer(void) {
+    pthread_once(&g_thread_buffer_once, thread_buffer_key_init);
+
+    mcp_json_buffer_t *buffer = pthread_getspecific(g_thread_buffer_key);
+    if (!buffer) {
+        buffer = malloc(sizeof(mcp_json_buffer_t));
+        if (!buffer) return NULL;
+        mcp_json_buffer_init(buffer);
+        if (pthread_setspecific(g_thread_buffer_key, buffer) != 0) {
+            free(buffer);
+            return NULL;
+        }
+    }
+
+    // Don't let one oversized response pin its memory for the thread's lifetime
+    if (buffer->capacity > JSON_THREAD_BUFFER_KEEP_LIMIT) {
+        mcp_json_buffer_free(buffer);
+    }
+    mcp_json_buffer_reset(buffer);
+    return buffer;
+}
+
+// Low-level writers
+int mcp_json_write_raw(mcp_json_buffer_t *buffer, const char *data, size_t length) {
+    if (mcp_json_buffer_reserve(buffer, length) != 0) return -1;
+
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+    return 0;
+}
+
+int mcp_json_write_literal(mcp_json_buffer_t *buffer, const char *text) {
+    return mcp_json_write_raw(buffer, text, strlen(text));
+}
+
+int mcp_json_write_string(mcp_json_buffer_t *buffer, const char *text) {
+    if (!text) return mcp_json_write_raw(buffer, "\"\"", 2);
+    return mcp_json_write_string_len(buffer, text, strlen(text));
+}
+
+int mcp_json_write_string_len(mcp_json_buffer_t *buffer, const char *text, size_t length) {
+    if (!text && length > 0) return -1;
+
+    // Worst case every byte becomes a \uXXXX escape
+    if (mcp_json_buffer_reserve(buffer, length * 6 + 2) != 0) return -1;
+
+    char *out = buffer->data + buffer->length;
+    *out++ = '"';
+
+    const unsigned char *end = (const unsigned char*)text + length;
+    for (const unsigned char *p = (const unsigned char*)text; p < end; p++) {
+        switch (*p) {
+            case '"':  *out++ = '\\'; *out++ = '"'; break;
+            case '\\': *out++ = '\\'; *out++ = '\\'; break;
+            case '\b': *out++ = '\\'; *out++ = 'b'; break;
+            case '\f': *out++ = '\\'; *out++ = 'f'; break;
+            case '\n': *out++ = '\\'; *out++ = 'n'; break;
+            case '\r': *out++ = '\\'; *out++ = 'r'; break;
+            case '\t': *out++ = '\\'; *out++ = 't'; break;
+            default:
+                if (*p < 0x20) {
+                    out += sprintf(out, "\\u%04x", *p);
+                } else {
+                    *out++ = (char)*p;
+                }
+                break;
+        }
+    }
+
+    *out++ = '"';
+    buffer->length = (size_t)(out - buffer->data);
+    buffer->data[buffer->length] = '\0';
+    return 0;
+}
+
+int mcp_json_write_number(mcp_json_buffer_t *buffer, double number) {
+    char digits[32];
+    int length;
+
+    // Same rules as cJSON: NaN/Infinity become null, integral values print without exponent
+    if (isnan(number) || isinf(number)) {
+        return mcp_json_write_raw(buffer, "null", 4);
+    }
+
+    if (number == (double)(long long)number && fabs(number) < 1e15) {
+        length = snprintf(digits, sizeof(digits), "%lld", (long long)number);
+    } else {
+        length = snprintf(digits, sizeof(digits), "%1.15g", number);
+        if (strtod(digits, NULL) != number) {
+            length = snprintf(digits, sizeof(digits), "%1.17g", number);
+        }
+    }
+
+    if (length < 0 || (size_t)length >= sizeof(digits)) return -1;
+    return mcp_json_write_raw(buffer, digits, (size_t)length);
+}
+
+int mcp_json_write_int(mcp_json_buffer_t *buffer, long long number) {
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%lld", number);
+    if (length < 0) return -1;
+    return mcp_json_write_raw(buffer, digits, (size_t)length);
+}
+
+int mcp_json_write_base64(mcp_json_buffer_t *buffer, const void *data, size_t length) {
+    size_t encoded = base64_encoded_size(length);
+    if (mcp_json_buffer_reserve(buffer, encoded + 2) != 0) return -1;
+
+    char *out = buffer->data + buffer->length;
+    *out++ = '"';
+    out += base64_encode_raw((const unsigned char*)data, length, out);
+    *out++ = '"';
+
+    buffer->length = (size_t)(out - buffer->data);
+    buffer->data[buffer->length] = '\0';
+    return 0;
+}
+
+// Binary blobs. The descriptor is stored as the item's valuestring so cJSON_Delete
+// frees it; the leading NUL makes anything that treats it as text see "".
+typedef enum {
+    JSON_BLOB_BASE64,           // Binary data, emitted as a base64 string
+    JSON_BLOB_TEXT,             // Text, emitted as an escaped string
+    JSON_BLOB_RAW,              // Pre-serialized JSON, emitted verbatim
+    JSON_BLOB_JSON_TEXT         // A borrowed cJSON tree, emitted as its compact text in a string
+} json_blob_kind_t;
+
+typedef struct {
+    char empty[8];
+    const void *data;
+    size_t length;
+    json_blob_kind_t kind;
+    mcp_json_release_t release;
+    void *ctx;
+} json_blob_t;
+
+static cJSON *create_blob(const void *data, size_t length, json_blob_kind_t kind,
+                          mcp_json_release_t release, void *ctx) {
+    if (!data && length > 0) return NULL;
+
+    cJSON *item = cJSON_CreateRaw("");
+    json_blob_t *blob = cJSON_malloc(sizeof(json_blob_t));
+    if (!item || !blob) {
+        cJSON_Delete(item);
+        cJSON_free(blob);
+        return NULL;
+    }
+
+    memset(blob, 0, sizeof(json_blob_t));
+    blob->data = data;
+    blob->length = length;
+    blob->kind = kind;
+    blob->release = release;
+    blob->ctx = ctx;
+
+    cJSON_free(item->valuestring);
+    item->valuestring = (char*)blob;
+    item->type |= MCP_JSON_BLOB_FLAG;
+    return item;
+}
+
+cJSON *mcp_json_create_blob(const void *data, size_t length, mcp_json_release_t release, void *ctx) {
+    return create_blob(data, length, JSON_BLOB_BASE64, release, ctx);
+}
+
+cJSON *mcp_json_create_text_view(const char *text, size_t length, mcp_json_release_t release, void *ctx) {
+    return create_blob(text, length, JSON_BLOB_TEXT, release, ctx);
+}
+
+cJSON *mcp_json_create_raw_view(const char *json, size_t length, mcp_json_release_t release, void *ctx) {
+    return create_blob(json, length, JSON_BLOB_RAW, release, ctx);
+}
+
+cJSON *mcp_json_create_json_text_view(const cJSON *item) {
+    if (!item) return NULL;
+    return create_blob(item, 0, JSON_BLOB_JSON_TEXT, NULL, NULL);
+}
+
+bool mcp_json_is_blob(const cJSON *item) {
+    return item && (item->type & 0xFF) == cJSON_Raw && (item->type & MCP_JSON_BLOB_FLAG);
+}
+
+bool mcp_json_contains_blob(const cJSON *item) {
+    for (; item; item = item->next) {
+        if (mcp_json_is_blob(item) || (item->child && mcp_json_contains_blob(item->child))) return true;
+    }
+    return false;
+}
+
+static void release_blobs(cJSON *item) {
+    for (; item; item = item->next) {
+        if (mcp_json_is_blob(item)) {
+            json_blob_t *blob = (json_blob_t*)item->valuestring;
+            if (blob->release) {
+                blob->release(blob->ctx);
+                blob->release = NULL;
+            }
+        } else if (item->child) {
+            release_blobs(item->child);
+        }
+    }
+}
+
+void mcp_json_delete(cJSON *item) {
+    if (!item) return;
+
+    if (mcp_json_is_blob(item)) {
+        json_blob_t *blob = (json_blob_t*)item->valuestring;
+        if (blob->release) blob->release(blob->ctx);
+    } else {
+        release_blobs(item->child);
+    }
+    cJSON_Delete(item);
+}
+
+// Tree serialization
+static int write_compact(mcp_json_buffer_t *buffer, const cJSON *item);
+
+// The tree's compact text goes to the end of the buffer, is escaped behind itself and
+// moved down over it, so no separate copy is allocated
+static int write_json_text(mcp_json_buffer_t *buffer, const cJSON *tree) {
+    size_t start = buffer->length;
+    if (write_compact(buffer, tree) != 0) return -1;
+
+    size_t length = buffer->length - start;
+    if (mcp_json_buffer_reserve(buffer, length * 6 + 2) != 0) return -1;
+    if (mcp_json_write_string_len(buffer, buffer->data + start, length) != 0) return -1;
+
+    memmove(buffer->data + start, buffer->data + start + length, buffer->length - start - length);
+    buffer->length -= length;
+    buffer->data[buffer->length] = '\0';
+    return 0;
+}
+
+static int write_blob(mcp_json_buffer_t *buffer, const cJSON *item) {
+    const json_blob_t *blob = (const json_blob_t*)item->valuestring;
+    switch (blob->kind) {
+        case JSON_BLOB_JSON_TEXT:
+            return write_json_text(buffer, (const cJSON*)blob->data);
+        case JSON_BLOB_TEXT:
+            return mcp_json_write_string_len(buffer, (const char*)blob->data, blob->length);
+        case JSON_BLOB_RAW:
+            return mcp_json_write_raw(buffer, (const char*)blob->data, blob->length);
+        default:
+            return mcp_json_write_base64(buffer, blob->data, blob->length);
+    }
+}
+
+static int write_compact(mcp_json_buffer_t *buffer, const cJSON *item) {
+    switch (item->type & 0xFF) {
+        case cJSON_NULL:
+            return mcp_json_write_raw(buffer, "null", 4);
+        case cJSON_False:
+            return mcp_json_write_raw(buffer, "false", 5);
+        case cJSON_True:
+            return mcp_json_write_raw(buffer, "true", 4);
+        case cJSON_Number:
+            return mcp_json_write_number(buffer, item->valuedouble);
+        case cJSON_String:
+            return mcp_json_write_string(buffer, item->valuestring);
+        case cJSON_Raw:
+            if (!item->valuestring) return -1;
+            if (item->type & MCP_JSON_BLOB_FLAG) return write_blob(buffer, item);
+            return mcp_json_write_literal(buffer, item->valuestring);
+
+        case cJSON_Array: {
+            if (mcp_json_write_raw(buffer, "[", 1) != 0) return -1;
+            for (const cJSON *child = item->child; child; child = child->next) {
+                if (child != item->child && mcp_json_write_raw(buffer, ",", 1) != 0) return -1;
+                if (write_compact(buffer, child) != 0) return -1;
+            }
+            return mcp_json_write_raw(buffer, "]", 1);
+        }
+
+        case cJSON_Object: {
+            if (mcp_json_write_raw(buffer, "{", 1) != 0) return -1;
+            for (const cJSON *child = item->child; child; child = child->next) {
+                if (child != item->child && mcp_json_write_raw(buffer, ",", 1) != 0) return -1;
+                if (mcp_json_write_string(buffer, child->string) != 0) return -1;
+                if (mcp_json_write_raw(buffer, ":", 1) != 0) return -1;
+                if (write_compact(buffer, child) != 0) return -1;
+            }
+            return mcp_json_write_raw(buffer, "}", 1);
+        }
+
+        default:
+            return -1;
+    }
+}
+
+// Same layout as cJSON_Print: tab indentation, one object member per line
+static int write_indent(mcp_json_buffer_t *buffer, int depth) {
+    for (int i = 0; i < depth; i++) {
+        if (mcp_json_write_raw(buffer, "\t", 1) != 0) return -1;
+    }
+    return 0;
+}
+
+static int write_pretty(mcp_json_buffer_t *buffer, const cJSON *item, int depth) {
+    switch (item->type & 0xFF) {
+        case cJSON_Array: {
+            if (mcp_json_write_raw(buffer, "[", 1) != 0) return -1;
+            for (const cJSON *child = item->child; child; child = child->next) {
+                if (child != item->child && mcp_json_write_raw(buffer, ", ", 2) != 0) return -1;
+                if (write_pretty(buffer, child, depth) != 0) return -1;
+            }
+            return mcp_json_write_raw(buffer, "]", 1);
+        }
+
+        case cJSON_Object: {
+            if (mcp_json_write_raw(buffer, "{\n", 2) != 0) return -1;
+            for (const cJSON *child = item->child; child; child = child->next) {
+                if (write_indent(buffer, depth + 1) != 0) return -1;
+                if (mcp_json_write_string(buffer, child->string) != 0) return -1;
+                if (mcp_json_write_raw(buffer, ":\t", 2) != 0) return -1;
+                if (write_pretty(buffer, child, depth + 1) != 0) return -1;
+                if (mcp_json_write_raw(buffer, child->next ? ",\n" : "\n", child->next ? 2 : 1) != 0) return -1;
+            }
+            if (write_indent(buffer, depth) != 0) return -1;
+            return mcp_json_write_raw(buffer, "}", 1);
+        }
+
+        default:
+            return write_compact(buffer, item);
+    }
+}
+
+int mcp_json_write_value(mcp_json_buffer_t *buffer, const cJSON *item) {
+    if (!buffer || !item) return -1;
+    return write_compact(buffer, item);
+}
+
+int mcp_json_write_compact(mcp_json_buffer_t *buffer, const cJSON *item) {
+    if (!buffer || !item) return -1;
+    return write_compact(buffer, item);
+}
+
+// Pretty printing
+int mcp_json_write_pretty(mcp_json_buffer_t *buffer, const cJSON *item) {
+    if (!buffer || !item) return -1;
+    return write_pretty(buffer, item, 0);
+}
+
+char *mcp_json_pretty_text(const char *json, size_t length) {
+    if (!json) return NULL;
+
+    // Reparsed, so spliced fragments are laid out like the rest of the document
+    cJSON *document = cJSON_ParseWithLength(json, length);
+    if (!document) return NULL;
+
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    int result = write_pretty(&buffer, document, 0);
+    cJSON_Delete(document);
+    if (result != 0) {
+        mcp_json_buffer_free(&buffer);
+        return NULL;
+    }
+    return mcp_json_buffer_detach(&buffer);
+}
+
+char *mcp_json_print(const cJSON *item) {
+    if (!item) return NULL;
+
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+
+    if (mcp_json_write_value(&buffer, item) != 0) {
+        mcp_json_buffer_free(&buffer);
+        return NULL;
+    }
+
+    return mcp_json_buffer_detach(&buffer);
+}
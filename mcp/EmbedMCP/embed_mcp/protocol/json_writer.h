@@ -0,0 +1,67 @@
+#ifndef MCP_JSON_WRITER_H
+#define MCP_JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "cjson/cJSON.h"
+
+// Growable output buffer, reused across messages to avoid per-response mallocs
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} mcp_json_buffer_t;
+
+// Buffer management
+void mcp_json_buffer_init(mcp_json_buffer_t *buffer);
+void mcp_json_buffer_reset(mcp_json_buffer_t *buffer);     // Keeps the allocation
+void mcp_json_buffer_free(mcp_json_buffer_t *buffer);
+int mcp_json_buffer_reserve(mcp_json_buffer_t *buffer, size_t additional);
+char *mcp_json_buffer_detach(mcp_json_buffer_t *buffer);   // Caller owns the returned string
+
+// Buffer owned by the calling thread; it is reset, not freed, between uses
+mcp_json_buffer_t *mcp_json_thread_buffer(void);
+
+// Low-level writers - all return 0 on success, -1 on allocation failure
+int mcp_json_write_raw(mcp_json_buffer_t *buffer, const char *data, size_t length);
+int mcp_json_write_literal(mcp_json_buffer_t *buffer, const char *text);
+int mcp_json_write_string(mcp_json_buffer_t *buffer, const char *text);
+int mcp_json_write_string_len(mcp_json_buffer_t *buffer, const char *text, size_t length);
+int mcp_json_write_number(mcp_json_buffer_t *buffer, double number);
+int mcp_json_write_int(mcp_json_buffer_t *buffer, long long number);
+int mcp_json_write_base64(mcp_json_buffer_t *buffer, const void *data, size_t length);  // Quoted
+
+// Blob node: a cJSON_Raw item over borrowed bytes that the writer emits as a base64
+// string (text views: an escaped string, raw views: verbatim JSON), encoded straight
+// into the output buffer. release(ctx) runs when the tree is freed with mcp_json_delete() (plain
+// cJSON_Delete skips it).
+#define MCP_JSON_BLOB_FLAG (1 << 12)
+
+typedef void (*mcp_json_release_t)(void *ctx);
+
+cJSON *mcp_json_create_blob(const void *data, size_t length, mcp_json_release_t release, void *ctx);
+cJSON *mcp_json_create_text_view(const char *text, size_t length, mcp_json_release_t release, void *ctx);
+cJSON *mcp_json_create_raw_view(const char *json, size_t length, mcp_json_release_t release, void *ctx);
+// A string holding item's compact JSON text, serialized while the tree is written;
+// item is borrowed and must outlive the view (e.g. another member of the same tree)
+cJSON *mcp_json_create_json_text_view(const cJSON *item);
+bool mcp_json_is_blob(const cJSON *item);
+bool mcp_json_contains_blob(const cJSON *item);   // item, its siblings or anything below
+void mcp_json_delete(cJSON *item);
+
+// Serialize a cJSON tree compactly. cJSON_Raw items are emitted verbatim, so
+// pre-serialized fragments (cached schemas, tool output) can be spliced in without
+// reparsing. Wire output is always compact: STDIO and UART frame messages by newline.
+int mcp_json_write_value(mcp_json_buffer_t *buffer, const cJSON *item);
+int mcp_json_write_compact(mcp_json_buffer_t *buffer, const cJSON *item);  // Same as write_value
+
+// Pretty printing, for logs only. write_pretty leaves cJSON_Raw fragments compact;
+// pretty_text reparses a serialized document so every level is indented (caller frees,
+// NULL if the text does not parse).
+int mcp_json_write_pretty(mcp_json_buffer_t *buffer, const cJSON *item);
+char *mcp_json_pretty_text(const char *json, size_t length);
+
+// Convenience: serialize into a newly allocated compact string
+char *mcp_json_print(const cJSON *item);
+
+#endif // MCP_JSON_WRITER_H
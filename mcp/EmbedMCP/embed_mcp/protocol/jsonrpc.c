@@ -1,4 +1,6 @@
 #include "protocol/jsonrpc.h"
+#include "protocol/json_writer.h"
+#include "protocol/cbor.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -52,6 +54,26 @@ mcp_message_t *jsonrpc_parse_message(jsonrpc_parser_t *parser, const char *json_
     return message;
 }
 
+mcp_message_t *jsonrpc_parse_message_in_arena(jsonrpc_parser_t *parser, mcp_arena_t *arena,
+                                             const char *json_data) {
+    if (!parser || !arena || !json_data) return NULL;
+    
+    size_t data_len = strlen(json_data);
+    if (data_len > parser->config.max_message_size) {
+        parser->parse_errors++;
+        return NULL;
+    }
+    
+    mcp_message_t *message = mcp_message_parse_in_arena(arena, json_data);
+    if (message) {
+        parser->messages_parsed++;
+    } else {
+        parser->parse_errors++;
+    }
+    
+    return message;
+}
+
 mcp_request_t *jsonrpc_parse_request(jsonrpc_parser_t *parser, const char *json_data) {
     mcp_message_t *message = jsonrpc_parse_message(parser, json_data);
     if (!message) return NULL;
@@ -87,82 +109,99 @@ char *jsonrpc_serialize_message(const mcp_message_t *message) {
     return mcp_message_serialize(message);
 }
 
-char *jsonrpc_serialize_request(const mcp_request_t *request) {
-    if (!request || !mcp_request_validate(request)) return NULL;
-    
-    cJSON *json = cJSON_CreateObject();
-    if (!json) return NULL;
-    
-    cJSON_AddStringToObject(json, JSONRPC_FIELD_JSONRPC, request->jsonrpc ? request->jsonrpc : JSONRPC_VERSION);
-    
-    if (request->id) {
-        cJSON_AddItemToObject(json, JSONRPC_FIELD_ID, cJSON_Duplicate(request->id, 1));
+// Streaming writers
+int jsonrpc_write_request(mcp_json_buffer_t *buffer, const cJSON *id,
+                          const char *method, const cJSON *params) {
+    if (!buffer || !method) return -1;
+
+    if (mcp_json_write_literal(buffer, "{\"" JSONRPC_FIELD_JSONRPC "\":\"" JSONRPC_VERSION "\"") != 0) return -1;
+    if (id) {
+        if (mcp_json_write_literal(buffer, ",\"" JSONRPC_FIELD_ID "\":") != 0) return -1;
+        if (mcp_json_write_value(buffer, id) != 0) return -1;
     }
-    
-    cJSON_AddStringToObject(json, JSONRPC_FIELD_METHOD, request->method);
-    
-    if (request->params) {
-        cJSON_AddItemToObject(json, JSONRPC_FIELD_PARAMS, cJSON_Duplicate(request->params, 1));
+    if (mcp_json_write_literal(buffer, ",\"" JSONRPC_FIELD_METHOD "\":") != 0) return -1;
+    if (mcp_json_write_string(buffer, method) != 0) return -1;
+    if (params) {
+        if (mcp_json_write_literal(buffer, ",\"" JSONRPC_FIELD_PARAMS "\":") != 0) return -1;
+        if (mcp_json_write_value(buffer, params) != 0) return -1;
     }
-    
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
-    
-    return json_string;
+    return mcp_json_write_raw(buffer, "}", 1);
 }
 
-char *jsonrpc_serialize_response(const mcp_response_t *response) {
-    if (!response || !mcp_response_validate(response)) return NULL;
-    
-    cJSON *json = cJSON_CreateObject();
-    if (!json) return NULL;
-    
-    cJSON_AddStringToObject(json, JSONRPC_FIELD_JSONRPC, response->jsonrpc ? response->jsonrpc : JSONRPC_VERSION);
-    
-    if (response->id) {
-        cJSON_AddItemToObject(json, JSONRPC_FIELD_ID, cJSON_Duplicate(response->id, 1));
+int jsonrpc_write_response(mcp_json_buffer_t *buffer, const cJSON *id,
+                           const cJSON *result, const cJSON *error) {
+    if (!buffer || (!result && !error)) return -1;
+
+    if (mcp_json_write_literal(buffer, "{\"" JSONRPC_FIELD_JSONRPC "\":\"" JSONRPC_VERSION "\"") != 0) return -1;
+    if (id) {
+        if (mcp_json_write_literal(buffer, ",\"" JSONRPC_FIELD_ID "\":") != 0) return -1;
+        if (mcp_json_write_value(buffer, id) != 0) return -1;
     }
-    
-    if (response->result) {
-        cJSON_AddItemToObject(json, JSONRPC_FIELD_RESULT, cJSON_Duplicate(response->result, 1));
+    if (result) {
+        if (mcp_json_write_literal(buffer, ",\"" JSONRPC_FIELD_RESULT "\":") != 0) return -1;
+        if (mcp_json_write_value(buffer, result) != 0) return -1;
     }
-    
-    if (response->error) {
-        cJSON_AddItemToObject(json, JSONRPC_FIELD_ERROR, cJSON_Duplicate(response->error, 1));
+    if (error) {
+        if (mcp_json_write_literal(buffer, ",\"" JSONRPC_FIELD_ERROR "\":") != 0) return -1;
+        if (mcp_json_write_value(buffer, error) != 0) return -1;
     }
-    
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
-    
-    return json_string;
+    return mcp_json_write_raw(buffer, "}", 1);
 }
 
-char *jsonrpc_serialize_error(cJSON *id, int code, const char *message, cJSON *data) {
-    cJSON *json = cJSON_CreateObject();
-    if (!json) return NULL;
-    
-    cJSON_AddStringToObject(json, JSONRPC_FIELD_JSONRPC, JSONRPC_VERSION);
-    
+int jsonrpc_write_error(mcp_json_buffer_t *buffer, const cJSON *id, int code,
+                        const char *message, const cJSON *data) {
+    if (!buffer) return -1;
+
+    if (!message) message = "Unknown error";
+
+    if (mcp_json_write_literal(buffer, "{\"" JSONRPC_FIELD_JSONRPC "\":\"" JSONRPC_VERSION "\",\"" JSONRPC_FIELD_ID "\":") != 0) return -1;
     if (id) {
-        cJSON_AddItemToObject(json, JSONRPC_FIELD_ID, cJSON_Duplicate(id, 1));
+        if (mcp_json_write_value(buffer, id) != 0) return -1;
     } else {
-        cJSON_AddNullToObject(json, JSONRPC_FIELD_ID);
+        if (mcp_json_write_raw(buffer, "null", 4) != 0) return -1;
     }
-    
-    cJSON *error_obj = cJSON_CreateObject();
-    cJSON_AddNumberToObject(error_obj, JSONRPC_FIELD_ERROR_CODE, code);
-    cJSON_AddStringToObject(error_obj, JSONRPC_FIELD_ERROR_MESSAGE, message ? message : "Unknown error");
-    
+    if (mcp_json_write_literal(buffer, ",\"" JSONRPC_FIELD_ERROR "\":{\"" JSONRPC_FIELD_ERROR_CODE "\":") != 0) return -1;
+    if (mcp_json_write_int(buffer, code) != 0) return -1;
+    if (mcp_json_write_literal(buffer, ",\"" JSONRPC_FIELD_ERROR_MESSAGE "\":") != 0) return -1;
+    if (mcp_json_write_string(buffer, message) != 0) return -1;
     if (data) {
-        cJSON_AddItemToObject(error_obj, JSONRPC_FIELD_ERROR_DATA, cJSON_Duplicate(data, 1));
+        if (mcp_json_write_literal(buffer, ",\"" JSONRPC_FIELD_ERROR_DATA "\":") != 0) return -1;
+        if (mcp_json_write_value(buffer, data) != 0) return -1;
     }
-    
-    cJSON_AddItemToObject(json, JSONRPC_FIELD_ERROR, error_obj);
-    
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
-    
-    return json_string;
+    return mcp_json_write_raw(buffer, "}}", 2);
+}
+
+// Run a writer into a fresh buffer and hand the string to the caller
+static char *detach_or_free(mcp_json_buffer_t *buffer, int write_result) {
+    if (write_result != 0) {
+        mcp_json_buffer_free(buffer);
+        return NULL;
+    }
+    return mcp_json_buffer_detach(buffer);
+}
+
+char *jsonrpc_serialize_request(const mcp_request_t *request) {
+    if (!request || !mcp_request_validate(request)) return NULL;
+
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    return detach_or_free(&buffer, jsonrpc_write_request(&buffer, request->id,
+                                                         request->method, request->params));
+}
+
+char *jsonrpc_serialize_response(const mcp_response_t *response) {
+    if (!response || !mcp_response_validate(response)) return NULL;
+
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    return detach_or_free(&buffer, jsonrpc_write_response(&buffer, response->id,
+                                                          response->result, response->error));
+}
+
+char *jsonrpc_serialize_error(cJSON *id, int code, const char *message, cJSON *data) {
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    return detach_or_free(&buffer, jsonrpc_write_error(&buffer, id, code, message, data));
 }
 
 // Validation functions
@@ -273,6 +312,109 @@ cJSON *jsonrpc_extract_id(const cJSON *json) {
     return id ? cJSON_Duplicate(id, 1) : NULL;
 }
 
+// Scanner for jsonrpc_peek_id() and jsonrpc_peek_method(): positions past the value or
+// string starting at p
+static const char *peek_skip_ws(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+static const char *peek_skip_string(const char *p, const char *end) {
+    for (p++; p < end; p++) {
+        if (*p == '\\') {
+            p++;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return NULL;
+}
+
+static const char *peek_skip_value(const char *p, const char *end) {
+    if (p >= end) return NULL;
+    if (*p == '"') return peek_skip_string(p, end);
+
+    if (*p != '{' && *p != '[') {
+        while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+               *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+            p++;
+        }
+        return p;
+    }
+
+    size_t depth = 0;
+    while (p < end) {
+        if (*p == '"') {
+            p = peek_skip_string(p, end);
+            if (!p) return NULL;
+            continue;
+        }
+        if (*p == '{' || *p == '[') {
+            depth++;
+        } else if ((*p == '}' || *p == ']') && --depth == 0) {
+            return p + 1;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+// Text of a top-level member's value in a single message, NULL if absent
+static const char *peek_member(const char *json_data, size_t length, const char *name,
+                               size_t *value_length) {
+    const char *end = json_data + length;
+    const char *p = peek_skip_ws(json_data, end);
+    if (p >= end || *p != '{') return NULL;
+    p = peek_skip_ws(p + 1, end);
+
+    size_t name_length = strlen(name);
+    while (p < end && *p == '"') {
+        const char *key = p + 1;
+        p = peek_skip_string(p, end);
+        if (!p) return NULL;
+        bool match = (size_t)(p - 1 - key) == name_length && memcmp(key, name, name_length) == 0;
+
+        p = peek_skip_ws(p, end);
+        if (p >= end || *p != ':') return NULL;
+        p = peek_skip_ws(p + 1, end);
+
+        const char *value = p;
+        p = peek_skip_value(p, end);
+        if (!p || p == value) return NULL;
+        if (match) {
+            *value_length = (size_t)(p - value);
+            return value;
+        }
+
+        p = peek_skip_ws(p, end);
+        if (p >= end || *p != ',') return NULL;
+        p = peek_skip_ws(p + 1, end);
+    }
+    return NULL;
+}
+
+const char *jsonrpc_peek_id(const char *json_data, size_t length, size_t *id_length) {
+    if (!json_data || !id_length) return NULL;
+
+    size_t value_length = 0;
+    const char *value = peek_member(json_data, length, JSONRPC_FIELD_ID, &value_length);
+    if (!value || *value == '{' || *value == '[') return NULL;
+
+    *id_length = value_length;
+    return value;
+}
+
+const char *jsonrpc_peek_method(const char *json_data, size_t length, size_t *method_length) {
+    if (!json_data || !method_length) return NULL;
+
+    size_t value_length = 0;
+    const char *value = peek_member(json_data, length, JSONRPC_FIELD_METHOD, &value_length);
+    if (!value || *value != '"' || value_length < 2) return NULL;
+
+    *method_length = value_length - 2;
+    return value + 1;
+}
+
 bool jsonrpc_id_match(const cJSON *id1, const cJSON *id2) {
     if (!id1 && !id2) return true;
     if (!id1 || !id2) return false;
@@ -333,6 +475,131 @@ char *jsonrpc_create_error_response(cJSON *id, int code, const char *message, cJ
     return jsonrpc_serialize_error(id, code, message, data);
 }
 
+// Batch processing
+bool jsonrpc_is_batch(const char *json_data) {
+    if (!json_data) return false;
+    
+    while (*json_data == ' ' || *json_data == '\t' || *json_data == '\r' || *json_data == '\n') {
+        json_data++;
+    }
+    return *json_data == '[';
+}
+
+cJSON *jsonrpc_parse_batch_document(jsonrpc_parser_t *parser, const char *json_data) {
+    if (!parser || !json_data) return NULL;
+    
+    cJSON *json = jsonrpc_parse_document(parser, json_data, strlen(json_data));
+    if (json && !cJSON_IsArray(json)) {
+        cJSON_Delete(json);
+        parser->parse_errors++;
+        return NULL;
+    }
+    return json;
+}
+
+// Size limit and stats shared by the JSON and CBOR parses
+static cJSON *jsonrpc_parse_checked(jsonrpc_parser_t *parser, const char *data, size_t length, bool cbor) {
+    if (!parser || !data) return NULL;
+    
+    if (length > parser->config.max_message_size) {
+        parser->parse_errors++;
+        return NULL;
+    }
+    
+    cJSON *json = cbor ? mcp_cbor_decode((const uint8_t*)data, length)
+                       : cJSON_ParseWithLength(data, length);
+    if (!json) {
+        parser->parse_errors++;
+        return NULL;
+    }
+    
+    parser->messages_parsed += cJSON_IsArray(json) ? (size_t)cJSON_GetArraySize(json) : 1;
+    return json;
+}
+
+cJSON *jsonrpc_parse_document(jsonrpc_parser_t *parser, const char *json_data, size_t length) {
+    return jsonrpc_parse_checked(parser, json_data, length, false);
+}
+
+cJSON *jsonrpc_parse_cbor_document(jsonrpc_parser_t *parser, const uint8_t *data, size_t length) {
+    return jsonrpc_parse_checked(parser, (const char*)data, length, true);
+}
+
+jsonrpc_batch_t *jsonrpc_batch_create(void) {
+    return calloc(1, sizeof(jsonrpc_batch_t));
+}
+
+void jsonrpc_batch_destroy(jsonrpc_batch_t *batch) {
+    if (!batch) return;
+    
+    for (size_t i = 0; i < batch->count; i++) {
+        mcp_message_destroy(batch->messages[i]);
+    }
+    free(batch->messages);
+    free(batch);
+}
+
+int jsonrpc_batch_add_message(jsonrpc_batch_t *batch, mcp_message_t *message) {
+    if (!batch) return -1;
+    
+    if (batch->count == batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity * 2 : 8;
+        mcp_message_t **messages = realloc(batch->messages, capacity * sizeof(mcp_message_t*));
+        if (!messages) return -1;
+        batch->messages = messages;
+        batch->capacity = capacity;
+    }
+    
+    batch->messages[batch->count++] = message;
+    return 0;
+}
+
+char *jsonrpc_batch_serialize(const jsonrpc_batch_t *batch) {
+    if (!batch) return NULL;
+    
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    
+    int result = mcp_json_write_raw(&buffer, "[", 1);
+    for (size_t i = 0; result == 0 && i < batch->count; i++) {
+        char *item = mcp_message_serialize(batch->messages[i]);
+        if (!item) {
+            result = -1;
+            break;
+        }
+        if (i > 0) result = mcp_json_write_raw(&buffer, ",", 1);
+        if (result == 0) result = mcp_json_write_literal(&buffer, item);
+        free(item);
+    }
+    if (result == 0) result = mcp_json_write_raw(&buffer, "]", 1);
+    
+    return detach_or_free(&buffer, result);
+}
+
+jsonrpc_batch_t *jsonrpc_batch_parse(jsonrpc_parser_t *parser, const char *json_data) {
+    cJSON *json = jsonrpc_parse_batch_document(parser, json_data);
+    if (!json) return NULL;
+    
+    jsonrpc_batch_t *batch = jsonrpc_batch_create();
+    if (!batch) {
+        cJSON_Delete(json);
+        return NULL;
+    }
+    
+    // Invalid entries are kept as NULL so positions still line up with the input
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, json) {
+        if (jsonrpc_batch_add_message(batch, mcp_message_from_json(item)) != 0) {
+            jsonrpc_batch_destroy(batch);
+            cJSON_Delete(json);
+            return NULL;
+        }
+    }
+    
+    cJSON_Delete(json);
+    return batch;
+}
+
 // Configuration helpers
 jsonrpc_parser_config_t *jsonrpc_config_create_default(void) {
     jsonrpc_parser_config_t *config = calloc(1, sizeof(jsonrpc_parser_config_t));
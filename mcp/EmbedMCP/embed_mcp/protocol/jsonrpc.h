@@ -3,8 +3,10 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "cjson/cJSON.h"
 #include "message.h"
+#include "json_writer.h"
 
 // JSON-RPC 2.0 specification constants
 #define JSONRPC_VERSION "2.0"
@@ -36,6 +38,9 @@ void jsonrpc_parser_destroy(jsonrpc_parser_t *parser);
 
 // Message parsing functions
 mcp_message_t *jsonrpc_parse_message(jsonrpc_parser_t *parser, const char *json_data);
+// Release with mcp_message_release() before rewinding the arena
+mcp_message_t *jsonrpc_parse_message_in_arena(jsonrpc_parser_t *parser, mcp_arena_t *arena,
+                                             const char *json_data);
 mcp_request_t *jsonrpc_parse_request(jsonrpc_parser_t *parser, const char *json_data);
 mcp_response_t *jsonrpc_parse_response(jsonrpc_parser_t *parser, const char *json_data);
 
@@ -45,6 +50,14 @@ char *jsonrpc_serialize_request(const mcp_request_t *request);
 char *jsonrpc_serialize_response(const mcp_response_t *response);
 char *jsonrpc_serialize_error(cJSON *id, int code, const char *message, cJSON *data);
 
+// Streaming serialization into a caller-owned buffer (appends, returns 0 or -1)
+int jsonrpc_write_request(mcp_json_buffer_t *buffer, const cJSON *id,
+                          const char *method, const cJSON *params);
+int jsonrpc_write_response(mcp_json_buffer_t *buffer, const cJSON *id,
+                           const cJSON *result, const cJSON *error);
+int jsonrpc_write_error(mcp_json_buffer_t *buffer, const cJSON *id, int code,
+                        const char *message, const cJSON *data);
+
 // Validation functions
 bool jsonrpc_validate_message(const cJSON *json);
 bool jsonrpc_validate_request(const cJSON *json);
@@ -61,12 +74,17 @@ bool jsonrpc_is_error_response(const cJSON *json);
 cJSON *jsonrpc_extract_id(const cJSON *json);
 bool jsonrpc_id_match(const cJSON *id1, const cJSON *id2);
 char *jsonrpc_id_to_string(const cJSON *id);
+// Text of a single message's top-level id (string, number or null) found without parsing
+// the rest, so a request can be refused before it is parsed; NULL if there is none
+const char *jsonrpc_peek_id(const char *json_data, size_t length, size_t *id_length);
+// Same for the method name, without the quotes (escapes are left as they are)
+const char *jsonrpc_peek_method(const char *json_data, size_t length, size_t *method_length);
 
 // Error handling
 cJSON *jsonrpc_create_error_object(int code, const char *message, cJSON *data);
 char *jsonrpc_create_error_response(cJSON *id, int code, const char *message, cJSON *data);
 
-// Batch processing (for future extension)
+// Batch processing
 typedef struct {
     mcp_message_t **messages;
     size_t count;
@@ -77,7 +95,16 @@ jsonrpc_batch_t *jsonrpc_batch_create(void);
 void jsonrpc_batch_destroy(jsonrpc_batch_t *batch);
 int jsonrpc_batch_add_message(jsonrpc_batch_t *batch, mcp_message_t *message);
 char *jsonrpc_batch_serialize(const jsonrpc_batch_t *batch);
+// Entries that are not valid messages are stored as NULL
 jsonrpc_batch_t *jsonrpc_batch_parse(jsonrpc_parser_t *parser, const char *json_data);
+bool jsonrpc_is_batch(const char *json_data);
+// Parses a batch array, enforcing the parser's size limit; NULL if not an array
+cJSON *jsonrpc_parse_batch_document(jsonrpc_parser_t *parser, const char *json_data);
+// Parses one message or batch of known length (needs no NUL terminator), enforcing the
+// size limit. The single parse of the request: messages are viewed straight out of it.
+cJSON *jsonrpc_parse_document(jsonrpc_parser_t *parser, const char *json_data, size_t length);
+// Same, for a CBOR message (protocol/cbor.h); only for connections that negotiated CBOR
+cJSON *jsonrpc_parse_cbor_document(jsonrpc_parser_t *parser, const uint8_t *data, size_t length);
 
 // Configuration helpers
 jsonrpc_parser_config_t *jsonrpc_config_create_default(void);
@@ -1,9 +1,33 @@
 #include "protocol/mcp_protocol.h"
 #include "hal/platform_hal.h"
+#include "utils/logging.h"
+#include "utils/trace.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+// Error recorded by the method handler running on this thread
+typedef struct {
+    int code;                   // 0 = none
+    const char *details;
+    bool deferred;              // Handler will reply later by other means
+} request_error_t;
+
+#if defined(__GNUC__)
+static __thread request_error_t t_request_error;
+#else
+static request_error_t t_request_error;
+#endif
+
+// Built-in methods
+static cJSON *builtin_initialize(const mcp_request_t *request, void *user_data) {
+    return mcp_protocol_handle_initialize((mcp_protocol_t*)user_data, request);
+}
+
+static cJSON *builtin_ping(const mcp_request_t *request, void *user_data) {
+    return mcp_protocol_handle_ping((mcp_protocol_t*)user_data, request);
+}
+
 // Protocol lifecycle
 mcp_protocol_t *mcp_protocol_create(const mcp_protocol_config_t *config) {
     const mcp_platform_hal_t *hal = mcp_platform_get_hal();
@@ -41,7 +65,7 @@ mcp_protocol_t *mcp_protocol_create(const mcp_protocol_config_t *config) {
     } else {
         protocol->config = mcp_protocol_config_create_default();
         if (!protocol->config) {
-            free(protocol);
+            hal->memory.free(protocol);
             return NULL;
         }
     }
@@ -50,7 +74,7 @@ mcp_protocol_t *mcp_protocol_create(const mcp_protocol_config_t *config) {
     protocol->state_machine = mcp_protocol_state_create();
     if (!protocol->state_machine) {
         mcp_protocol_config_destroy(protocol->config);
-        free(protocol);
+        hal->memory.free(protocol);
         return NULL;
     }
     
@@ -65,10 +89,24 @@ mcp_protocol_t *mcp_protocol_create(const mcp_protocol_config_t *config) {
     if (!protocol->parser) {
         mcp_protocol_state_destroy(protocol->state_machine);
         mcp_protocol_config_destroy(protocol->config);
-        free(protocol);
+        hal->memory.free(protocol);
         return NULL;
     }
     
+    protocol->methods = mcp_method_table_create(16);
+    protocol->notifications = mcp_method_table_create(8);
+    if (!protocol->methods || !protocol->notifications ||
+        mcp_method_table_register(protocol->methods, MCP_METHOD_INITIALIZE, builtin_initialize, protocol) != 0 ||
+        mcp_method_table_register(protocol->methods, MCP_METHOD_PING, builtin_ping, protocol) != 0) {
+        mcp_method_table_destroy(protocol->notifications);
+        mcp_method_table_destroy(protocol->methods);
+        jsonrpc_parser_destroy(protocol->parser);
+        mcp_protocol_state_destroy(protocol->state_machine);
+        mcp_protocol_config_destroy(protocol->config);
+        hal->memory.free(protocol);
+        return NULL;
+    }
+
     protocol->initialized = false;
     protocol->pending_requests = 0;
     protocol->last_activity = time(NULL);
@@ -81,6 +119,8 @@ void mcp_protocol_destroy(mcp_protocol_t *protocol) {
 
     const mcp_platform_hal_t *hal = mcp_platform_get_hal();
 
+    mcp_method_table_destroy(protocol->notifications);
+    mcp_method_table_destroy(protocol->methods);
     jsonrpc_parser_destroy(protocol->parser);
     mcp_protocol_state_destroy(protocol->state_machine);
     mcp_protocol_config_destroy(protocol->config);
@@ -119,9 +159,10 @@ void mcp_protocol_config_destroy(mcp_protocol_config_t *config) {
     const mcp_platform_hal_t *hal = mcp_platform_get_hal();
 
     if (hal) {
-        if (config->server_name) hal->memory.free(config->server_name);
-        if (config->server_version) hal->memory.free(config->server_version);
-        if (config->instructions) hal->memory.free(config->instructions);
+        // The strings come from strdup(), the struct from the HAL
+        free(config->server_name);
+        free(config->server_version);
+        free(config->instructions);
 
         mcp_capabilities_destroy(config->capabilities);
         hal->memory.free(config);
@@ -184,28 +225,71 @@ void mcp_protocol_set_request_handler(mcp_protocol_t *protocol,
     protocol->user_data = user_data;
 }
 
-// Message handling
-int mcp_protocol_handle_message(mcp_protocol_t *protocol, const char *json_data) {
-    if (!protocol || !json_data) return -1;
+int mcp_protocol_register_method(mcp_protocol_t *protocol, const char *method,
+                                 mcp_method_handler_t handler, void *user_data) {
+    if (!protocol || !method || !handler) return -1;
     
-    protocol->last_activity = time(NULL);
+    return mcp_method_table_register(protocol->methods, method, handler, user_data);
+}
+
+int mcp_protocol_register_notification(mcp_protocol_t *protocol, const char *method,
+                                       mcp_method_handler_t handler, void *user_data) {
+    if (!protocol || !method || !handler) return -1;
     
-    mcp_message_t *message = jsonrpc_parse_message(protocol->parser, json_data);
-    if (!message) {
-        if (protocol->error_callback) {
-            protocol->error_callback(JSONRPC_PARSE_ERROR, "Failed to parse JSON-RPC message", protocol->user_data);
-        }
-        return mcp_protocol_send_parse_error(protocol, NULL);
-    }
+    return mcp_method_table_register(protocol->notifications, method, handler, user_data);
+}
+
+void mcp_protocol_set_batch_executor(mcp_protocol_t *protocol,
+                                    mcp_protocol_executor_t executor, void *user_data) {
+    if (!protocol) return;
     
+    protocol->batch_executor = executor;
+    protocol->batch_executor_data = user_data;
+}
+
+// Replies produced while a batch entry is handled are captured here instead of sent
+#if defined(__GNUC__)
+static __thread mcp_json_buffer_t *t_reply_capture = NULL;
+#else
+static mcp_json_buffer_t *t_reply_capture = NULL;
+#endif
+
+// The debug log gets an indented copy; the wire always carries the compact form
+static void protocol_log_outgoing(const char *data, size_t length) {
+    if (!mcp_log_enabled(MCP_LOG_LEVEL_DEBUG)) return;
+
+    char *pretty = mcp_json_pretty_text(data, length);
+    if (pretty) {
+        mcp_log_debug("Sending message (%zu bytes):\n%s", length, pretty);
+        free(pretty);
+    } else {
+        mcp_log_debug("Sending message (%zu bytes): %.*s", length, (int)length, data);
+    }
+}
+
+// Send a serialized reply, or keep it for the enclosing batch response
+static int protocol_emit_reply(mcp_protocol_t *protocol, const char *data, size_t length) {
+    if (t_reply_capture) {
+        if (mcp_json_write_raw(t_reply_capture, data, length) != 0) return -1;
+        return (int)length;
+    }
+    protocol_log_outgoing(data, length);
+    uint64_t span = mcp_trace_begin();
+    int result = protocol->send_callback(data, length, protocol->user_data);
+    mcp_trace_end(MCP_TRACE_SEND, span, NULL);
+    return result;
+}
+
+// Dispatch one parsed message; its views are allocated from arena
+static int protocol_dispatch_message(mcp_protocol_t *protocol, mcp_arena_t *arena,
+                                     const mcp_message_t *message) {
     int result = 0;
     
     switch (message->type) {
         case MCP_MESSAGE_REQUEST: {
-            mcp_request_t *request = mcp_message_to_request(message);
+            mcp_request_t *request = mcp_message_view_request(arena, message);
             if (request) {
                 result = mcp_protocol_handle_request(protocol, request);
-                mcp_request_destroy(request);
             } else {
                 result = mcp_protocol_send_invalid_request_error(protocol, message->id);
             }
@@ -213,20 +297,18 @@ int mcp_protocol_handle_message(mcp_protocol_t *protocol, const char *json_data)
         }
         
         case MCP_MESSAGE_NOTIFICATION: {
-            mcp_request_t *notification = mcp_message_to_request(message);
+            mcp_request_t *notification = mcp_message_view_request(arena, message);
             if (notification) {
                 result = mcp_protocol_handle_notification(protocol, notification);
-                mcp_request_destroy(notification);
             }
             break;
         }
         
         case MCP_MESSAGE_RESPONSE:
         case MCP_MESSAGE_ERROR: {
-            mcp_response_t *response = mcp_message_to_response(message);
+            mcp_response_t *response = mcp_message_view_response(arena, message);
             if (response) {
                 result = mcp_protocol_handle_response(protocol, response);
-                mcp_response_destroy(response);
             }
             break;
         }
@@ -236,31 +318,245 @@ int mcp_protocol_handle_message(mcp_protocol_t *protocol, const char *json_data)
             break;
     }
     
-    mcp_message_destroy(message);
     return result;
 }
 
+static int protocol_handle_batch_document(mcp_protocol_t *protocol, cJSON *document);
+static int protocol_handle_document(mcp_protocol_t *protocol, const char *data, size_t length, bool cbor);
+
+// Method of the message being handled, named by its request span
+#if defined(__GNUC__)
+static __thread char t_trace_method[MCP_TRACE_DETAIL_SIZE];
+#else
+static char t_trace_method[MCP_TRACE_DETAIL_SIZE];
+#endif
+
+// Message handling
+int mcp_protocol_handle_message(mcp_protocol_t *protocol, const char *json_data) {
+    if (!protocol || !json_data) return -1;
+    return mcp_protocol_handle_message_len(protocol, json_data, strlen(json_data));
+}
+
+// Handle one message in either encoding, inside its request span
+static int protocol_handle_encoded(mcp_protocol_t *protocol, const char *data, size_t length, bool cbor) {
+    if (!protocol || !data) return -1;
+    
+    protocol->last_activity = time(NULL);
+    
+    uint32_t previous_request = mcp_trace_begin_request();
+    uint64_t request_span = mcp_trace_begin();
+    int result = protocol_handle_document(protocol, data, length, cbor);
+    mcp_trace_end(MCP_TRACE_REQUEST, request_span, t_trace_method);
+    mcp_trace_end_request(previous_request);
+    t_trace_method[0] = '\0';
+    return result;
+}
+
+int mcp_protocol_handle_message_len(mcp_protocol_t *protocol, const char *json_data, size_t length) {
+    return protocol_handle_encoded(protocol, json_data, length, false);
+}
+
+int mcp_protocol_handle_cbor_message(mcp_protocol_t *protocol, const uint8_t *data, size_t length) {
+    return protocol_handle_encoded(protocol, (const char*)data, length, true);
+}
+
+// Parse one message or batch and dispatch it
+static int protocol_handle_document(mcp_protocol_t *protocol, const char *data, size_t length, bool cbor) {
+    uint64_t parse_span = mcp_trace_begin();
+    cJSON *document = cbor ? jsonrpc_parse_cbor_document(protocol->parser, (const uint8_t*)data, length)
+                           : jsonrpc_parse_document(protocol->parser, data, length);
+    if (!document) {
+        mcp_trace_end(MCP_TRACE_PARSE, parse_span, NULL);
+        if (protocol->error_callback) {
+            protocol->error_callback(JSONRPC_PARSE_ERROR, "Failed to parse JSON-RPC message", protocol->user_data);
+        }
+        return mcp_protocol_send_parse_error(protocol, NULL);
+    }
+    
+    if (cJSON_IsArray(document)) {
+        mcp_trace_end(MCP_TRACE_PARSE, parse_span, NULL);
+        if (parse_span) snprintf(t_trace_method, sizeof(t_trace_method), "batch");
+        return protocol_handle_batch_document(protocol, document);
+    }
+    
+    // Everything derived from this message comes from the thread's arena and is
+    // dropped in one step below, after the response has been sent
+    mcp_arena_t *arena = mcp_arena_thread();
+    if (!arena) {
+        cJSON_Delete(document);
+        return -1;
+    }
+    mcp_arena_mark_t mark = mcp_arena_mark(arena);
+    
+    mcp_message_t *message = mcp_message_view_in_arena(arena, document);
+    mcp_trace_end(MCP_TRACE_PARSE, parse_span, NULL);
+    if (!message) {
+        // Well-formed JSON but not a JSON-RPC message
+        mcp_arena_rewind(arena, mark);
+        const cJSON *id = cJSON_IsObject(document) ? cJSON_GetObjectItem(document, "id") : NULL;
+        int result = mcp_protocol_send_invalid_request_error(
+            protocol, (cJSON_IsString(id) || cJSON_IsNumber(id)) ? (cJSON*)id : NULL);
+        cJSON_Delete(document);
+        return result;
+    }
+    message->root = document;
+    
+    if (parse_span && message->method) {
+        snprintf(t_trace_method, sizeof(t_trace_method), "%s", message->method);
+    }
+    
+    int result = protocol_dispatch_message(protocol, arena, message);
+    mcp_arena_rewind(arena, mark);
+    return result;
+}
+
+// Batch handling - entries may run on different threads, each reply lands in its own slot
+typedef struct {
+    mcp_protocol_t *protocol;
+    cJSON **entries;
+    mcp_json_buffer_t *replies;
+} protocol_batch_t;
+
+static void protocol_batch_run_entry(void *arg, size_t index) {
+    protocol_batch_t *batch = (protocol_batch_t*)arg;
+    mcp_protocol_t *protocol = batch->protocol;
+    
+    mcp_json_buffer_t *previous_capture = t_reply_capture;
+    t_reply_capture = &batch->replies[index];
+    
+    mcp_arena_t *arena = mcp_arena_thread();
+    if (arena) {
+        mcp_arena_mark_t mark = mcp_arena_mark(arena);
+        
+        mcp_message_t *message = mcp_message_view_in_arena(arena, batch->entries[index]);
+        if (message) {
+            protocol_dispatch_message(protocol, arena, message);
+        } else {
+            mcp_protocol_send_invalid_request_error(protocol, NULL);
+        }
+        
+        mcp_arena_rewind(arena, mark);
+    } else {
+        mcp_protocol_send_internal_error(protocol, NULL, "Out of memory");
+    }
+    
+    t_reply_capture = previous_capture;
+}
+
+int mcp_protocol_handle_batch(mcp_protocol_t *protocol, const char *json_data) {
+    if (!protocol || !json_data) return -1;
+    
+    cJSON *document = jsonrpc_parse_batch_document(protocol->parser, json_data);
+    if (!document) {
+        if (protocol->error_callback) {
+            protocol->error_callback(JSONRPC_PARSE_ERROR, "Failed to parse JSON-RPC batch", protocol->user_data);
+        }
+        return mcp_protocol_send_parse_error(protocol, NULL);
+    }
+    
+    return protocol_handle_batch_document(protocol, document);
+}
+
+// Takes ownership of the parsed batch array
+static int protocol_handle_batch_document(mcp_protocol_t *protocol, cJSON *document) {
+    // An empty batch isn't valid; an oversized one is refused as a whole
+    size_t count = (size_t)cJSON_GetArraySize(document);
+    if (count == 0 || count > MCP_PROTOCOL_MAX_BATCH_SIZE) {
+        cJSON_Delete(document);
+        return mcp_protocol_send_invalid_request_error(protocol, NULL);
+    }
+    
+    protocol_batch_t batch = { .protocol = protocol };
+    batch.entries = calloc(count, sizeof(cJSON*));
+    batch.replies = calloc(count, sizeof(mcp_json_buffer_t));
+    if (!batch.entries || !batch.replies) {
+        free(batch.entries);
+        free(batch.replies);
+        cJSON_Delete(document);
+        return mcp_protocol_send_internal_error(protocol, NULL, "Out of memory");
+    }
+    
+    size_t index = 0;
+    cJSON *entry = NULL;
+    cJSON_ArrayForEach(entry, document) {
+        batch.entries[index++] = entry;
+    }
+    
+    if (protocol->batch_executor) {
+        protocol->batch_executor(protocol_batch_run_entry, &batch, count, protocol->batch_executor_data);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            protocol_batch_run_entry(&batch, i);
+        }
+    }
+    
+    // Gather replies in request order; notifications contribute nothing
+    mcp_json_buffer_t *combined = mcp_json_thread_buffer();
+    int result = combined ? 0 : -1;
+    bool any_reply = false;
+    
+    if (combined) {
+        result = mcp_json_write_raw(combined, "[", 1);
+        for (size_t i = 0; result == 0 && i < count; i++) {
+            if (batch.replies[i].length == 0) continue;
+            if (any_reply) result = mcp_json_write_raw(combined, ",", 1);
+            if (result == 0) {
+                result = mcp_json_write_raw(combined, batch.replies[i].data, batch.replies[i].length);
+            }
+            any_reply = true;
+        }
+        if (result == 0) result = mcp_json_write_raw(combined, "]", 1);
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        mcp_json_buffer_free(&batch.replies[i]);
+    }
+    free(batch.replies);
+    free(batch.entries);
+    cJSON_Delete(document);
+    
+    if (result != 0) return -1;
+    if (!any_reply) return 0;
+    
+    return protocol_emit_reply(protocol, combined->data, combined->length);
+}
+
 int mcp_protocol_handle_request(mcp_protocol_t *protocol, const mcp_request_t *request) {
     if (!protocol || !request) return -1;
 
     cJSON *result = NULL;
 
-    // Handle built-in methods directly without state checks
-    if (strcmp(request->method, MCP_METHOD_INITIALIZE) == 0) {
-        result = mcp_protocol_handle_initialize(protocol, request);
-    } else if (strcmp(request->method, MCP_METHOD_PING) == 0) {
-        result = mcp_protocol_handle_ping(protocol, request);
+    mcp_log_debug("Handling request: %s", request->method);
+    t_request_error.code = 0;
+    t_request_error.deferred = false;
+
+    // Built-in and registered methods, then the application-level fallback
+    uint64_t span = mcp_trace_begin();
+    const mcp_method_entry_t *method = mcp_method_table_lookup(protocol->methods, request->method);
+    mcp_trace_end(MCP_TRACE_DISPATCH, span, request->method);
+    
+    span = mcp_trace_begin();
+    if (method) {
+        result = method->handler(request, method->user_data);
     } else if (protocol->request_handler) {
-        // Delegate to application-level handler (tools/list, tools/call, etc.)
+        // Methods not in the table go to the application-level handler
         result = protocol->request_handler(request, protocol->user_data);
     } else {
         return mcp_protocol_send_method_not_found_error(protocol, request->id, request->method);
     }
+    mcp_trace_end(MCP_TRACE_HANDLE, span, request->method);
 
     if (result) {
         int send_result = mcp_protocol_send_response(protocol, request->id, result);
-        cJSON_Delete(result);
+        mcp_json_delete(result);
         return send_result;
+    } else if (t_request_error.deferred) {
+        return 0;
+    } else if (t_request_error.code == JSONRPC_INVALID_PARAMS) {
+        return mcp_protocol_send_invalid_params_error(protocol, request->id, t_request_error.details);
+    } else if (t_request_error.code != 0) {
+        return mcp_protocol_send_error_response(protocol, request->id, t_request_error.code,
+                                                t_request_error.details, NULL);
     } else {
         return mcp_protocol_send_internal_error(protocol, request->id, "Request handler returned null");
     }
@@ -282,9 +578,16 @@ int mcp_protocol_handle_response(mcp_protocol_t *protocol, const mcp_response_t
 int mcp_protocol_handle_notification(mcp_protocol_t *protocol, const mcp_request_t *notification) {
     if (!protocol || !notification) return -1;
     
-    // Handle built-in notifications
+    // Handle built-in notifications; the application may also watch initialized
     if (strcmp(notification->method, MCP_METHOD_INITIALIZED) == 0) {
-        return mcp_protocol_handle_initialized(protocol, notification);
+        int result = mcp_protocol_handle_initialized(protocol, notification);
+        if (result != 0) return result;
+    }
+    
+    const mcp_method_entry_t *handler = mcp_method_table_lookup(protocol->notifications, notification->method);
+    if (handler) {
+        mcp_json_delete(handler->handler(notification, handler->user_data));
+        return 0;
     }
     
     // For other notifications, just log them for now
@@ -299,52 +602,38 @@ int mcp_protocol_handle_notification(mcp_protocol_t *protocol, const mcp_request
 int mcp_protocol_send_response(mcp_protocol_t *protocol, cJSON *id, cJSON *result) {
     if (!protocol || !protocol->send_callback) return -1;
     
-    mcp_response_t response = {
-        .jsonrpc = "2.0",
-        .id = id,
-        .result = result,
-        .error = NULL
-    };
-    
-    char *json_str = jsonrpc_serialize_response(&response);
-    if (!json_str) return -1;
+    if (!result) return -1;
     
-    int send_result = protocol->send_callback(json_str, strlen(json_str), protocol->user_data);
-    free(json_str);
+    // Serialize straight into the thread's reusable buffer - no copy of the result tree
+    uint64_t span = mcp_trace_begin();
+    mcp_json_buffer_t *buffer = mcp_json_thread_buffer();
+    if (!buffer || jsonrpc_write_response(buffer, id, result, NULL) != 0) return -1;
+    mcp_trace_end(MCP_TRACE_SERIALIZE, span, NULL);
     
-    return send_result;
+    return protocol_emit_reply(protocol, buffer->data, buffer->length);
 }
 
 int mcp_protocol_send_error_response(mcp_protocol_t *protocol, cJSON *id, 
                                     int code, const char *message, cJSON *data) {
     if (!protocol || !protocol->send_callback) return -1;
     
-    char *json_str = jsonrpc_serialize_error(id, code, message, data);
-    if (!json_str) return -1;
-    
-    int send_result = protocol->send_callback(json_str, strlen(json_str), protocol->user_data);
-    free(json_str);
+    mcp_json_buffer_t *buffer = mcp_json_thread_buffer();
+    if (!buffer || jsonrpc_write_error(buffer, id, code, message, data) != 0) return -1;
     
-    return send_result;
+    return protocol_emit_reply(protocol, buffer->data, buffer->length);
 }
 
 int mcp_protocol_send_request(mcp_protocol_t *protocol, cJSON *id,
                              const char *method, cJSON *params) {
     if (!protocol || !protocol->send_callback || !method) return -1;
 
-    mcp_request_t request = {
-        .jsonrpc = "2.0",
-        .id = id,
-        .method = (char*)method,
-        .params = params,
-        .is_notification = false
-    };
+    if (!id) return -1;
 
-    char *json_str = jsonrpc_serialize_request(&request);
-    if (!json_str) return -1;
+    mcp_json_buffer_t *buffer = mcp_json_thread_buffer();
+    if (!buffer || jsonrpc_write_request(buffer, id, method, params) != 0) return -1;
+    protocol_log_outgoing(buffer->data, buffer->length);
 
-    int send_result = protocol->send_callback(json_str, strlen(json_str), protocol->user_data);
-    free(json_str);
+    int send_result = protocol->send_callback(buffer->data, buffer->length, protocol->user_data);
 
     if (send_result == 0) {
         protocol->pending_requests++;
@@ -458,6 +747,19 @@ cJSON *mcp_protocol_create_capabilities_json(const mcp_protocol_t *protocol) {
 
 
 // Error helpers
+void mcp_protocol_set_request_error(int code, const char *details) {
+    t_request_error.code = code;
+    t_request_error.details = details;
+}
+
+bool mcp_protocol_can_defer_response(void) {
+    return t_reply_capture == NULL;
+}
+
+void mcp_protocol_defer_response(void) {
+    t_request_error.deferred = true;
+}
+
 int mcp_protocol_send_parse_error(mcp_protocol_t *protocol, cJSON *id) {
     return mcp_protocol_send_error_response(protocol, id, JSONRPC_PARSE_ERROR, "Parse error", NULL);
 }
@@ -507,19 +809,9 @@ int mcp_protocol_send_internal_error(mcp_protocol_t *protocol, cJSON *id, const
 int mcp_protocol_send_notification(mcp_protocol_t *protocol, const char *method, cJSON *params) {
     if (!protocol || !protocol->send_callback || !method) return -1;
     
-    mcp_request_t notification = {
-        .jsonrpc = "2.0",
-        .id = NULL,
-        .method = (char*)method,
-        .params = params,
-        .is_notification = true
-    };
-    
-    char *json_str = jsonrpc_serialize_request(&notification);
-    if (!json_str) return -1;
+    mcp_json_buffer_t *buffer = mcp_json_thread_buffer();
+    if (!buffer || jsonrpc_write_request(buffer, NULL, method, params) != 0) return -1;
+    protocol_log_outgoing(buffer->data, buffer->length);
     
-    int send_result = protocol->send_callback(json_str, strlen(json_str), protocol->user_data);
-    free(json_str);
-    
-    return send_result;
+    return protocol->send_callback(buffer->data, buffer->length, protocol->user_data);
 }
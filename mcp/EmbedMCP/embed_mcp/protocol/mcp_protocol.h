@@ -3,10 +3,12 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "cjson/cJSON.h"
 #include "message.h"
 #include "jsonrpc.h"
 #include "protocol_state.h"
+#include "method_table.h"
 
 // Forward declarations
 typedef struct mcp_protocol mcp_protocol_t;
@@ -19,9 +21,14 @@ typedef struct mcp_protocol mcp_protocol_t;
 #define MCP_METHOD_CALL_TOOL "tools/call"
 #define MCP_METHOD_LIST_RESOURCES "resources/list"
 #define MCP_METHOD_READ_RESOURCE "resources/read"
+#define MCP_METHOD_SUBSCRIBE_RESOURCE "resources/subscribe"
+#define MCP_METHOD_UNSUBSCRIBE_RESOURCE "resources/unsubscribe"
 #define MCP_METHOD_LIST_PROMPTS "prompts/list"
 #define MCP_METHOD_GET_PROMPT "prompts/get"
 #define MCP_METHOD_SET_LEVEL "logging/setLevel"
+#define MCP_METHOD_CANCELLED "notifications/cancelled"
+#define MCP_METHOD_PROGRESS "notifications/progress"
+#define MCP_METHOD_RESOURCE_UPDATED "notifications/resources/updated"
 
 // Protocol callback functions
 typedef int (*mcp_send_callback_t)(const char *data, size_t length, void *user_data);
@@ -29,8 +36,17 @@ typedef void (*mcp_error_callback_t)(int code, const char *message, void *user_d
 typedef void (*mcp_state_change_callback_t)(mcp_protocol_state_t old_state, 
                                            mcp_protocol_state_t new_state, void *user_data);
 
-// Request handler callback
-typedef cJSON *(*mcp_request_handler_t)(const mcp_request_t *request, void *user_data);
+// Request handler callback (same shape as a method table handler)
+typedef mcp_method_handler_t mcp_request_handler_t;
+
+// Batch execution - runs task(arg, i) for every i in [0, count) and returns when all
+// have finished. Without an executor, batch entries are handled one after another.
+typedef void (*mcp_protocol_task_t)(void *arg, size_t index);
+typedef void (*mcp_protocol_executor_t)(mcp_protocol_task_t task, void *arg, size_t count,
+                                        void *user_data);
+
+// Upper bound on entries in one JSON-RPC batch
+#define MCP_PROTOCOL_MAX_BATCH_SIZE 256
 
 // Protocol configuration
 typedef struct {
@@ -59,6 +75,11 @@ struct mcp_protocol {
     
     // JSON-RPC parser
     jsonrpc_parser_t *parser;
+
+    // Request methods, looked up by hash
+    mcp_method_table_t *methods;
+    // Notification handlers (their return value is ignored)
+    mcp_method_table_t *notifications;
     
     // Callbacks
     mcp_send_callback_t send_callback;
@@ -66,6 +87,8 @@ struct mcp_protocol {
     mcp_state_change_callback_t state_change_callback;
     mcp_request_handler_t request_handler;
     void *user_data;
+    mcp_protocol_executor_t batch_executor;
+    void *batch_executor_data;
     
     // Internal state
     bool initialized;
@@ -94,9 +117,24 @@ void mcp_protocol_set_state_change_callback(mcp_protocol_t *protocol,
                                            mcp_state_change_callback_t callback, void *user_data);
 void mcp_protocol_set_request_handler(mcp_protocol_t *protocol,
                                      mcp_request_handler_t handler, void *user_data);
+// Method registration - handlers are looked up before the generic request handler,
+// which only sees methods missing from the table
+int mcp_protocol_register_method(mcp_protocol_t *protocol, const char *method,
+                                 mcp_method_handler_t handler, void *user_data);
+int mcp_protocol_register_notification(mcp_protocol_t *protocol, const char *method,
+                                       mcp_method_handler_t handler, void *user_data);
+void mcp_protocol_set_batch_executor(mcp_protocol_t *protocol,
+                                    mcp_protocol_executor_t executor, void *user_data);
 
 // Message handling
 int mcp_protocol_handle_message(mcp_protocol_t *protocol, const char *json_data);
+// Same, for a buffer of known length that need not be NUL-terminated (e.g. an HTTP body).
+// The message is parsed once; requests, notifications and batch entries are dispatched
+// as views into that tree, down to the tool arguments.
+int mcp_protocol_handle_message_len(mcp_protocol_t *protocol, const char *json_data, size_t length);
+// Same, for a CBOR message (protocol/cbor.h) from a connection that negotiated CBOR
+int mcp_protocol_handle_cbor_message(mcp_protocol_t *protocol, const uint8_t *data, size_t length);
+int mcp_protocol_handle_batch(mcp_protocol_t *protocol, const char *json_data);
 int mcp_protocol_handle_request(mcp_protocol_t *protocol, const mcp_request_t *request);
 int mcp_protocol_handle_response(mcp_protocol_t *protocol, const mcp_response_t *response);
 int mcp_protocol_handle_notification(mcp_protocol_t *protocol, const mcp_request_t *notification);
@@ -124,6 +162,14 @@ cJSON *mcp_protocol_create_server_info(const mcp_protocol_t *protocol);
 cJSON *mcp_protocol_create_capabilities_json(const mcp_protocol_t *protocol);
 
 // Error helpers
+// A method handler that returns NULL after calling set_request_error gets that
+// error in its response instead of the generic internal error. The error is kept
+// per thread and cleared before each request; details must outlive the handler.
+void mcp_protocol_set_request_error(int code, const char *details);
+// A method handler that returns NULL after calling defer_response sends nothing: the
+// reply goes out later by other means. Only possible outside batches (can_defer).
+bool mcp_protocol_can_defer_response(void);
+void mcp_protocol_defer_response(void);
 int mcp_protocol_send_parse_error(mcp_protocol_t *protocol, cJSON *id);
 int mcp_protocol_send_invalid_request_error(mcp_protocol_t *protocol, cJSON *id);
 int mcp_protocol_send_method_not_found_error(mcp_protocol_t *protocol, cJSON *id, const char *method);
@@ -1,4 +1,5 @@
 #include "protocol/message.h"
+#include "protocol/json_writer.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -100,6 +101,17 @@ mcp_message_t *mcp_message_create_error_response(cJSON *id, int code, const char
     return message;
 }
 
+// Type is decided the same way for heap and arena messages
+static void message_classify(mcp_message_t *message) {
+    if (message->method) {
+        message->type = message->id ? MCP_MESSAGE_REQUEST : MCP_MESSAGE_NOTIFICATION;
+    } else if (message->error) {
+        message->type = MCP_MESSAGE_ERROR;
+    } else {
+        message->type = MCP_MESSAGE_RESPONSE;
+    }
+}
+
 // Message parsing
 mcp_message_t *mcp_message_parse(const char *json_data) {
     if (!json_data) return NULL;
@@ -107,11 +119,17 @@ mcp_message_t *mcp_message_parse(const char *json_data) {
     cJSON *json = cJSON_Parse(json_data);
     if (!json) return NULL;
     
+    mcp_message_t *message = mcp_message_from_json(json);
+    cJSON_Delete(json);
+    
+    return message;
+}
+
+mcp_message_t *mcp_message_from_json(cJSON *json) {
+    if (!cJSON_IsObject(json)) return NULL;
+    
     mcp_message_t *message = calloc(1, sizeof(mcp_message_t));
-    if (!message) {
-        cJSON_Delete(json);
-        return NULL;
-    }
+    if (!message) return NULL;
     
     // Parse jsonrpc field
     cJSON *jsonrpc = cJSON_GetObjectItem(json, "jsonrpc");
@@ -119,59 +137,118 @@ mcp_message_t *mcp_message_parse(const char *json_data) {
         message->jsonrpc = strdup(jsonrpc->valuestring);
     }
     
-    // Parse id field
-    cJSON *id = cJSON_GetObjectItem(json, "id");
-    if (id) {
-        message->id = cJSON_Duplicate(id, 1);
-    }
-    
     // Parse method field
     cJSON *method = cJSON_GetObjectItem(json, "method");
     if (method && cJSON_IsString(method)) {
         message->method = strdup(method->valuestring);
     }
     
-    // Parse params field
-    cJSON *params = cJSON_GetObjectItem(json, "params");
-    if (params) {
-        message->params = cJSON_Duplicate(params, 1);
-    }
+    // Subtrees are moved out of the document rather than copied
+    message->id = cJSON_DetachItemFromObject(json, "id");
+    message->params = cJSON_DetachItemFromObject(json, "params");
+    message->result = cJSON_DetachItemFromObject(json, "result");
+    message->error = cJSON_DetachItemFromObject(json, "error");
+    
+    // Determine message type
+    message_classify(message);
     
-    // Parse result field
-    cJSON *result = cJSON_GetObjectItem(json, "result");
-    if (result) {
-        message->result = cJSON_Duplicate(result, 1);
+    if (!mcp_message_validate(message)) {
+        mcp_message_destroy(message);
+        return NULL;
     }
     
-    // Parse error field
-    cJSON *error = cJSON_GetObjectItem(json, "error");
-    if (error) {
-        message->error = cJSON_Duplicate(error, 1);
+    return message;
+}
+
+// Arena-scoped parsing
+mcp_message_t *mcp_message_view_in_arena(mcp_arena_t *arena, const cJSON *json) {
+    if (!arena || !cJSON_IsObject(json)) return NULL;
+    
+    mcp_message_t *message = mcp_arena_calloc(arena, sizeof(mcp_message_t));
+    if (!message) return NULL;
+    
+    cJSON *jsonrpc = cJSON_GetObjectItem(json, "jsonrpc");
+    if (cJSON_IsString(jsonrpc)) {
+        message->jsonrpc = jsonrpc->valuestring;
     }
     
-    // Determine message type
-    if (message->method) {
-        message->type = message->id ? MCP_MESSAGE_REQUEST : MCP_MESSAGE_NOTIFICATION;
-    } else if (message->error) {
-        message->type = MCP_MESSAGE_ERROR;
-    } else {
-        message->type = MCP_MESSAGE_RESPONSE;
+    cJSON *method = cJSON_GetObjectItem(json, "method");
+    if (cJSON_IsString(method)) {
+        message->method = method->valuestring;
     }
     
-    cJSON_Delete(json);
+    message->id = cJSON_GetObjectItem(json, "id");
+    message->params = cJSON_GetObjectItem(json, "params");
+    message->result = cJSON_GetObjectItem(json, "result");
+    message->error = cJSON_GetObjectItem(json, "error");
     
-    if (!mcp_message_validate(message)) {
-        mcp_message_destroy(message);
+    message_classify(message);
+    
+    return mcp_message_validate(message) ? message : NULL;
+}
+
+mcp_message_t *mcp_message_parse_in_arena(mcp_arena_t *arena, const char *json_data) {
+    if (!arena || !json_data) return NULL;
+    
+    cJSON *json = cJSON_Parse(json_data);
+    if (!json) return NULL;
+    
+    mcp_message_t *message = mcp_message_view_in_arena(arena, json);
+    if (!message) {
+        cJSON_Delete(json);
         return NULL;
     }
     
+    message->root = json;
     return message;
 }
 
+mcp_request_t *mcp_message_view_request(mcp_arena_t *arena, const mcp_message_t *message) {
+    if (!message || (message->type != MCP_MESSAGE_REQUEST && message->type != MCP_MESSAGE_NOTIFICATION)) {
+        return NULL;
+    }
+    
+    mcp_request_t *request = mcp_arena_alloc(arena, sizeof(mcp_request_t));
+    if (!request) return NULL;
+    
+    request->jsonrpc = message->jsonrpc;
+    request->id = message->id;
+    request->method = message->method;
+    request->params = message->params;
+    request->is_notification = (message->type == MCP_MESSAGE_NOTIFICATION);
+    
+    return request;
+}
+
+mcp_response_t *mcp_message_view_response(mcp_arena_t *arena, const mcp_message_t *message) {
+    if (!message || (message->type != MCP_MESSAGE_RESPONSE && message->type != MCP_MESSAGE_ERROR)) {
+        return NULL;
+    }
+    
+    mcp_response_t *response = mcp_arena_alloc(arena, sizeof(mcp_response_t));
+    if (!response) return NULL;
+    
+    response->jsonrpc = message->jsonrpc;
+    response->id = message->id;
+    response->result = message->result;
+    response->error = message->error;
+    
+    return response;
+}
+
+void mcp_message_release(mcp_message_t *message) {
+    if (!message) return;
+    
+    // The struct itself belongs to the arena
+    cJSON_Delete(message->root);
+    memset(message, 0, sizeof(mcp_message_t));
+}
+
 // Message serialization
 char *mcp_message_serialize(const mcp_message_t *message) {
     if (!message || !mcp_message_validate(message)) return NULL;
     
+    // Assemble the envelope from references - the writer never copies the payload
     cJSON *json = cJSON_CreateObject();
     if (!json) return NULL;
     
@@ -180,7 +257,7 @@ char *mcp_message_serialize(const mcp_message_t *message) {
     
     // Add id field (if present)
     if (message->id) {
-        cJSON_AddItemToObject(json, "id", cJSON_Duplicate(message->id, 1));
+        cJSON_AddItemReferenceToObject(json, "id", message->id);
     }
     
     // Add method field (for requests and notifications)
@@ -190,20 +267,20 @@ char *mcp_message_serialize(const mcp_message_t *message) {
     
     // Add params field (if present)
     if (message->params) {
-        cJSON_AddItemToObject(json, "params", cJSON_Duplicate(message->params, 1));
+        cJSON_AddItemReferenceToObject(json, "params", message->params);
     }
     
     // Add result field (for successful responses)
     if (message->result) {
-        cJSON_AddItemToObject(json, "result", cJSON_Duplicate(message->result, 1));
+        cJSON_AddItemReferenceToObject(json, "result", message->result);
     }
     
     // Add error field (for error responses)
     if (message->error) {
-        cJSON_AddItemToObject(json, "error", cJSON_Duplicate(message->error, 1));
+        cJSON_AddItemReferenceToObject(json, "error", message->error);
     }
     
-    char *json_string = cJSON_Print(json);
+    char *json_string = mcp_json_print(json);
     cJSON_Delete(json);
     
     return json_string;
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "cjson/cJSON.h"
+#include "utils/arena.h"
 
 // MCP Protocol Version
 #define MCP_PROTOCOL_VERSION "2025-03-26"
@@ -19,6 +20,9 @@
 #define MCP_ERROR_INVALID_PARAMS -32602
 #define MCP_ERROR_METHOD_NOT_FOUND -32601
 #define MCP_ERROR_INTERNAL_ERROR -32603
+#define MCP_ERROR_RESOURCE_LIMIT -32000     // Refused by a memory budget, data.retryable says if it may pass later
+#define MCP_ERROR_UNKNOWN_SESSION -32001    // Mcp-Session-Id unknown or expired (HTTP 404), start a new session
+#define MCP_ERROR_OVERLOADED -32002         // Shed by admission control (HTTP 503 or 429), retry later
 
 // MCP Message Types
 typedef enum {
@@ -37,6 +41,7 @@ typedef struct {
     cJSON *params;           // Parameters (optional)
     cJSON *result;           // Result (responses only)
     cJSON *error;            // Error (error responses only)
+    cJSON *root;             // Parsed document when the fields above borrow from it (arena messages)
 } mcp_message_t;
 
 // MCP Request Structure (simplified view of message)
@@ -71,8 +76,20 @@ mcp_message_t *mcp_message_create_error_response(cJSON *id, int code, const char
 
 // Message parsing and serialization
 mcp_message_t *mcp_message_parse(const char *json_data);
+// Build a heap message from a parsed object; id/params/result/error are moved out of json
+mcp_message_t *mcp_message_from_json(cJSON *json);
 char *mcp_message_serialize(const mcp_message_t *message);
 
+// Arena-scoped parsing: the message and its views live in the arena and borrow
+// strings and subtrees from the parsed document instead of copying them.
+// Call mcp_message_release() before rewinding the arena.
+mcp_message_t *mcp_message_parse_in_arena(mcp_arena_t *arena, const char *json_data);
+// View over an already parsed object, which must outlive the message
+mcp_message_t *mcp_message_view_in_arena(mcp_arena_t *arena, const cJSON *json);
+mcp_request_t *mcp_message_view_request(mcp_arena_t *arena, const mcp_message_t *message);
+mcp_response_t *mcp_message_view_response(mcp_arena_t *arena, const mcp_message_t *message);
+void mcp_message_release(mcp_message_t *message);
+
 // Message validation
 bool mcp_message_validate(const mcp_message_t *message);
 bool mcp_request_validate(const mcp_request_t *request);
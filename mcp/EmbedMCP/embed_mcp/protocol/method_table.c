@@ -0,0 +1,112 @@
+#include "protocol/method_table.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define METHOD_TABLE_MIN_CAPACITY 16
+
+// FNV-1a hash of a method name
+static uint32_t method_name_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Slot holding method, or the first empty slot of its probe chain
+static mcp_method_entry_t *method_table_probe(mcp_method_entry_t *slots, size_t capacity,
+                                              const char *method, uint32_t hash) {
+    size_t mask = capacity - 1;
+    size_t index = hash & mask;
+
+    while (slots[index].name) {
+        if (slots[index].hash == hash && strcmp(slots[index].name, method) == 0) {
+            break;
+        }
+        index = (index + 1) & mask;
+    }
+
+    return &slots[index];
+}
+
+static int method_table_grow(mcp_method_table_t *table) {
+    size_t capacity = table->capacity * 2;
+    mcp_method_entry_t *slots = calloc(capacity, sizeof(mcp_method_entry_t));
+    if (!slots) return -1;
+
+    for (size_t i = 0; i < table->capacity; i++) {
+        mcp_method_entry_t *entry = &table->slots[i];
+        if (entry->name) {
+            *method_table_probe(slots, capacity, entry->name, entry->hash) = *entry;
+        }
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return 0;
+}
+
+// Table lifecycle
+mcp_method_table_t *mcp_method_table_create(size_t initial_capacity) {
+    mcp_method_table_t *table = calloc(1, sizeof(mcp_method_table_t));
+    if (!table) return NULL;
+
+    size_t capacity = METHOD_TABLE_MIN_CAPACITY;
+    while (capacity < initial_capacity * 2) {
+        capacity *= 2;
+    }
+
+    table->slots = calloc(capacity, sizeof(mcp_method_entry_t));
+    if (!table->slots) {
+        free(table);
+        return NULL;
+    }
+    table->capacity = capacity;
+
+    return table;
+}
+
+void mcp_method_table_destroy(mcp_method_table_t *table) {
+    if (!table) return;
+
+    for (size_t i = 0; i < table->capacity; i++) {
+        free(table->slots[i].name);
+    }
+    free(table->slots);
+    free(table);
+}
+
+int mcp_method_table_register(mcp_method_table_t *table, const char *method,
+                              mcp_method_handler_t handler, void *user_data) {
+    if (!table || !method || !handler) return -1;
+
+    // Keep the load factor at or below one half so probe chains stay short
+    if ((table->count + 1) * 2 > table->capacity && method_table_grow(table) != 0) {
+        return -1;
+    }
+
+    uint32_t hash = method_name_hash(method);
+    mcp_method_entry_t *entry = method_table_probe(table->slots, table->capacity, method, hash);
+
+    if (!entry->name) {
+        entry->name = strdup(method);
+        if (!entry->name) return -1;
+        entry->hash = hash;
+        table->count++;
+    }
+
+    entry->handler = handler;
+    entry->user_data = user_data;
+    return 0;
+}
+
+const mcp_method_entry_t *mcp_method_table_lookup(const mcp_method_table_t *table,
+                                                  const char *method) {
+    if (!table || !method) return NULL;
+
+    uint32_t hash = method_name_hash(method);
+    mcp_method_entry_t *entry = method_table_probe(table->slots, table->capacity, method, hash);
+    return entry->name ? entry : NULL;
+}
@@ -0,0 +1,39 @@
+#ifndef MCP_METHOD_TABLE_H
+#define MCP_METHOD_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cjson/cJSON.h"
+#include "message.h"
+
+// Method handler - returns the result object (caller frees) or NULL on failure
+typedef cJSON *(*mcp_method_handler_t)(const mcp_request_t *request, void *user_data);
+
+typedef struct {
+    char *name;
+    uint32_t hash;
+    mcp_method_handler_t handler;
+    void *user_data;
+} mcp_method_entry_t;
+
+// Open-addressing hash table of request methods. It is filled while the server is
+// set up and only read afterwards, so lookups take no lock.
+typedef struct {
+    mcp_method_entry_t *slots;
+    size_t capacity;            // Power of two
+    size_t count;
+} mcp_method_table_t;
+
+// Table lifecycle
+mcp_method_table_t *mcp_method_table_create(size_t initial_capacity);
+void mcp_method_table_destroy(mcp_method_table_t *table);
+
+// Add or replace a method; returns 0 on success, -1 on error
+int mcp_method_table_register(mcp_method_table_t *table, const char *method,
+                              mcp_method_handler_t handler, void *user_data);
+
+// Find a method; returns NULL if it is not registered
+const mcp_method_entry_t *mcp_method_table_lookup(const mcp_method_table_t *table,
+                                                  const char *method);
+
+#endif // MCP_METHOD_TABLE_H
@@ -303,6 +303,8 @@ bool mcp_capabilities_merge(mcp_capabilities_t *target, const mcp_capabilities_t
     // Merge server capabilities (logical OR)
     target->server.tools = target->server.tools || source->server.tools;
     target->server.resources = target->server.resources || source->server.resources;
+    target->server.resources_subscribe = target->server.resources_subscribe ||
+                                         source->server.resources_subscribe;
     target->server.prompts = target->server.prompts || source->server.prompts;
     target->server.logging = target->server.logging || source->server.logging;
 
@@ -331,7 +333,7 @@ cJSON *mcp_capabilities_to_json(const mcp_capabilities_t *capabilities) {
     // Add resources capability if enabled
     if (capabilities->server.resources) {
         cJSON *resources = cJSON_CreateObject();
-        cJSON_AddBoolToObject(resources, "subscribe", false);
+        cJSON_AddBoolToObject(resources, "subscribe", capabilities->server.resources_subscribe);
         cJSON_AddBoolToObject(resources, "listChanged", true);
         cJSON_AddItemToObject(json, "resources", resources);
     }
@@ -362,6 +364,9 @@ mcp_capabilities_t *mcp_capabilities_from_json(const cJSON *json) {
     if (server && cJSON_IsObject(server)) {
         capabilities->server.tools = cJSON_GetObjectItem(server, "tools") != NULL;
         capabilities->server.resources = cJSON_GetObjectItem(server, "resources") != NULL;
+        cJSON *resources = cJSON_GetObjectItem(server, "resources");
+        capabilities->server.resources_subscribe = cJSON_IsObject(resources) &&
+                                                   cJSON_IsTrue(cJSON_GetObjectItem(resources, "subscribe"));
         capabilities->server.prompts = cJSON_GetObjectItem(server, "prompts") != NULL;
         capabilities->server.logging = cJSON_GetObjectItem(server, "logging") != NULL;
     }
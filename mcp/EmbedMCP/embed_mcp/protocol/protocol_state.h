@@ -34,6 +34,7 @@ typedef struct {
     struct {
         bool tools;              // Supports tools
         bool resources;          // Supports resources
+        bool resources_subscribe; // Supports resources/subscribe
         bool prompts;           // Supports prompts
         bool logging;           // Supports logging
     } server;
@@ -1,8 +1,10 @@
 #include "tools/builtin_tools.h"
 #include "utils/logging.h"
 #include "cjson/cJSON.h"
+#include "protocol/json_writer.h"
 #include "utils/base64.h"
 #include "utils/uuid4.h"
+#include "utils/trace.h"
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
@@ -39,9 +41,7 @@ cJSON *mcp_builtin_tool_base64_encode_execute(const cJSON *parameters, void *use
     cJSON *result_data = cJSON_CreateString(output);
     free(output);
 
-    cJSON *success_result = mcp_tool_create_success_result(result_data);
-    cJSON_Delete(result_data);
-    return success_result;
+    return mcp_tool_create_success_result_take(result_data);
 }
 
 // Base64解码实现
@@ -76,9 +76,7 @@ cJSON *mcp_builtin_tool_base64_decode_execute(const cJSON *parameters, void *use
     cJSON *result_data = cJSON_CreateString((char*)output);
     free(output);
 
-    cJSON *success_result = mcp_tool_create_success_result(result_data);
-    cJSON_Delete(result_data);
-    return success_result;
+    return mcp_tool_create_success_result_take(result_data);
 }
 
 // UUID生成实现
@@ -103,9 +101,7 @@ cJSON *mcp_builtin_tool_uuid_execute(const cJSON *parameters, void *user_data) {
     }
 
     cJSON *result_data = cJSON_CreateString(uuid_str);
-    cJSON *success_result = mcp_tool_create_success_result(result_data);
-    cJSON_Delete(result_data);
-    return success_result;
+    return mcp_tool_create_success_result_take(result_data);
 }
 
 // 时间戳实现
@@ -115,9 +111,82 @@ cJSON *mcp_builtin_tool_timestamp_execute(const cJSON *parameters, void *user_da
 
     time_t timestamp = time(NULL);
     cJSON *result_data = cJSON_CreateNumber((double)timestamp);
-    cJSON *success_result = mcp_tool_create_success_result(result_data);
-    cJSON_Delete(result_data);
-    return success_result;
+    return mcp_tool_create_success_result_take(result_data);
+}
+
+// 请求跟踪导出
+cJSON *mcp_builtin_tool_trace_export_schema(void) {
+    cJSON *schema = cJSON_CreateObject();
+    cJSON *properties = cJSON_AddObjectToObject(schema, "properties");
+    cJSON *clear = cJSON_AddObjectToObject(properties, "clear");
+    cJSON_AddStringToObject(schema, "type", "object");
+    cJSON_AddStringToObject(clear, "type", "boolean");
+    cJSON_AddStringToObject(clear, "description", "Drop the spans after exporting them");
+    return schema;
+}
+
+static cJSON *trace_phase_summary(mcp_trace_phase_t phase) {
+    mcp_histogram_t latency;
+    mcp_trace_get_phase(phase, &latency);
+
+    cJSON *summary = cJSON_CreateObject();
+    cJSON_AddNumberToObject(summary, "count", (double)latency.count);
+    cJSON_AddNumberToObject(summary, "totalUs", (double)latency.sum_us);
+    cJSON_AddNumberToObject(summary, "p50Us", (double)mcp_histogram_percentile(&latency, 0.50));
+    cJSON_AddNumberToObject(summary, "p90Us", (double)mcp_histogram_percentile(&latency, 0.90));
+    cJSON_AddNumberToObject(summary, "p99Us", (double)mcp_histogram_percentile(&latency, 0.99));
+    cJSON_AddNumberToObject(summary, "maxUs", (double)latency.max_us);
+    return summary;
+}
+
+cJSON *mcp_builtin_tool_trace_export_execute(const cJSON *parameters, void *user_data) {
+    (void)user_data;
+
+    mcp_json_buffer_t trace;
+    mcp_json_buffer_init(&trace);
+    if (mcp_trace_write_chrome(&trace) != 0) {
+        mcp_json_buffer_free(&trace);
+        return mcp_tool_create_error_result(MCP_TOOL_ERROR_EXECUTION, "Memory allocation failed", NULL);
+    }
+
+    // 统计与导出的跟踪对应，清除放在最后
+    mcp_trace_stats_t stats;
+    mcp_trace_get_stats(&stats);
+    cJSON *summary = cJSON_CreateObject();
+    cJSON_AddBoolToObject(summary, "enabled", stats.enabled);
+    cJSON_AddNumberToObject(summary, "threads", (double)stats.threads);
+    cJSON_AddNumberToObject(summary, "spans", (double)stats.spans);
+    cJSON_AddNumberToObject(summary, "overwritten", (double)stats.overwritten);
+    cJSON *phases = cJSON_AddObjectToObject(summary, "phases");
+    for (int i = 0; i < MCP_TRACE_PHASE_COUNT; i++) {
+        cJSON_AddItemToObject(phases, mcp_trace_phase_name((mcp_trace_phase_t)i),
+                              trace_phase_summary((mcp_trace_phase_t)i));
+    }
+
+    cJSON *clear = parameters ? cJSON_GetObjectItem(parameters, "clear") : NULL;
+    if (cJSON_IsTrue(clear)) {
+        mcp_trace_clear();
+    }
+
+    // 跟踪可能有几百KB，文本直接引用缓冲区而不复制
+    size_t length = trace.length;
+    char *text = mcp_json_buffer_detach(&trace);
+    cJSON *text_view = text ? mcp_json_create_text_view(text, length, free, text) : NULL;
+    if (!text_view) {
+        free(text);
+        cJSON_Delete(summary);
+        return mcp_tool_create_error_result(MCP_TOOL_ERROR_EXECUTION, "Memory allocation failed", NULL);
+    }
+
+    cJSON *result = cJSON_CreateObject();
+    cJSON *content = cJSON_AddArrayToObject(result, "content");
+    cJSON *text_block = cJSON_CreateObject();
+    cJSON_AddStringToObject(text_block, "type", "text");
+    cJSON_AddItemToObject(text_block, "text", text_view);
+    cJSON_AddItemToArray(content, text_block);
+    cJSON_AddItemToObject(result, "structuredContent", summary);
+    cJSON_AddBoolToObject(result, "isError", false);
+    return result;
 }
 
 // 简化的注册函数
@@ -13,11 +13,17 @@ cJSON *mcp_builtin_tool_timestamp_execute(const cJSON *parameters, void *user_da
 cJSON *mcp_builtin_tool_uuid_execute(const cJSON *parameters, void *user_data);
 cJSON *mcp_builtin_tool_base64_encode_execute(const cJSON *parameters, void *user_data);
 cJSON *mcp_builtin_tool_base64_decode_execute(const cJSON *parameters, void *user_data);
+// Recorded trace spans as Chrome trace-event JSON, per-phase summaries as structured content
+cJSON *mcp_builtin_tool_trace_export_execute(const cJSON *parameters, void *user_data);
 
 // Tool name constants for implemented tools
 #define MCP_BUILTIN_TOOL_TIMESTAMP "timestamp"
 #define MCP_BUILTIN_TOOL_UUID "uuid"
 #define MCP_BUILTIN_TOOL_BASE64_ENCODE "base64_encode"
 #define MCP_BUILTIN_TOOL_BASE64_DECODE "base64_decode"
+#define MCP_BUILTIN_TOOL_TRACE_EXPORT "trace_export"
+
+// Input schema of trace_export (caller frees)
+cJSON *mcp_builtin_tool_trace_export_schema(void);
 
 #endif // MCP_BUILTIN_TOOLS_H
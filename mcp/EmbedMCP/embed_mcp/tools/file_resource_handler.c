@@ -1,5 +1,6 @@
 #include "resource_interface.h"
 #include "utils/logging.h"
+#include "hal/platform_hal.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -11,6 +12,10 @@
 // File Resource Handler - Simple file access
 // =============================================================================
 
+// Size limits: heap reads copy the whole file, mapped reads only reference it
+#define FILE_RESOURCE_MAX_SIZE (1024 * 1024)
+#define FILE_RESOURCE_MAX_MAPPED_SIZE (256 * 1024 * 1024)
+
 /**
  * Simple MIME type detection based on file extension
  */
@@ -52,43 +57,38 @@ static const char* get_mime_type_from_extension(const char *filename) {
 static int is_path_safe(const char *path) {
     if (!path) return 0;
 
-    printf("[DEBUG] Checking path safety: '%s'\n", path);
+    mcp_log_debug("File resource: Checking path safety: '%s'", path);
 
     // Don't allow absolute paths outside current directory
     if (path[0] == '/') {
-        printf("[DEBUG] Rejected: absolute path\n");
+        mcp_log_debug("File resource: Rejected: absolute path");
         return 0;
     }
 
     // Don't allow parent directory traversal
     if (strstr(path, "..") != NULL) {
-        printf("[DEBUG] Rejected: parent directory traversal\n");
+        mcp_log_debug("File resource: Rejected: parent directory traversal");
         return 0;
     }
 
     // Don't allow hidden files, but allow ./path
     if (path[0] == '.' && path[1] != '/') {
-        printf("[DEBUG] Rejected: hidden file (path[0]='%c', path[1]='%c')\n", path[0], path[1]);
+        mcp_log_debug("File resource: Rejected: hidden file (path[0]='%c', path[1]='%c')", path[0], path[1]);
         return 0;
     }
 
-    printf("[DEBUG] Path approved\n");
+    mcp_log_debug("File resource: Path approved");
     return 1;
 }
 
 /**
- * File resource handler function
+ * File a URI served by the file resource handler refers to
  */
-int mcp_file_resource_handler(const mcp_resource_template_context_t *context,
-                              mcp_resource_content_t *content) {
-    if (!context || !context->resolved_uri || !content) {
-        return -1;
-    }
-
-    const char *resolved_uri = context->resolved_uri;
+const char *mcp_file_resource_path(const char *uri) {
+    if (!uri) return NULL;
 
     // Extract file path from URI (remove file:// prefix)
-    const char *file_path = resolved_uri;
+    const char *file_path = uri;
     if (strncmp(file_path, "file://", 7) == 0) {
         file_path += 7;
     }
@@ -100,53 +100,48 @@ int mcp_file_resource_handler(const mcp_resource_template_context_t *context,
 
     // Security check
     if (!is_path_safe(file_path)) {
-        printf("[FILE_RESOURCE] Access denied to path: %s\n", file_path);
-        return -1;
-    }
-
-    // Check if file exists and get stats
-    struct stat file_stat;
-    if (stat(file_path, &file_stat) != 0) {
-        printf("[FILE_RESOURCE] File not found: %s\n", file_path);
-        return -1;
+        mcp_log_debug("File resource: Access denied to path: %s", file_path);
+        return NULL;
     }
+    return file_path;
+}
 
-    // Check if it's a regular file
-    if (!S_ISREG(file_stat.st_mode)) {
-        printf("[FILE_RESOURCE] Not a regular file: %s\n", file_path);
+/**
+ * File resource handler function
+ */
+int mcp_file_resource_handler(const mcp_resource_template_context_t *context,
+                              mcp_resource_content_t *content) {
+    if (!context || !context->resolved_uri || !content) {
         return -1;
     }
 
-    // Check file size (limit to 1MB for safety)
-    if (file_stat.st_size > 1024 * 1024) {
-        printf("[FILE_RESOURCE] File too large: %s (%lld bytes)\n", file_path, (long long)file_stat.st_size);
+    const char *file_path = mcp_file_resource_path(context->resolved_uri);
+    if (!file_path) {
         return -1;
     }
 
-    // Open and read file
-    FILE *file = fopen(file_path, "rb");
-    if (!file) {
-        printf("[FILE_RESOURCE] Cannot open file: %s\n", file_path);
+    // Check if file exists and is a regular file
+    struct stat file_stat;
+    if (stat(file_path, &file_stat) != 0) {
+        mcp_log_debug("File resource: File not found: %s", file_path);
         return -1;
     }
 
-    // Allocate buffer
-    size_t file_size = file_stat.st_size;
-    void *data = malloc(file_size + 1); // +1 for null terminator for text files
-    if (!data) {
-        fclose(file);
+    if (!S_ISREG(file_stat.st_mode)) {
+        mcp_log_debug("File resource: Not a regular file: %s", file_path);
         return -1;
     }
 
-    // Read file content
-    size_t bytes_read = fread(data, 1, file_size, file);
-    fclose(file);
+    // Platform file views are shared by concurrent reads and encoded in place, so larger files are fine there
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    size_t max_size = (hal && hal->file.map) ? FILE_RESOURCE_MAX_MAPPED_SIZE : FILE_RESOURCE_MAX_SIZE;
 
-    if (bytes_read != file_size) {
-        free(data);
-        printf("[FILE_RESOURCE] Failed to read complete file: %s\n", file_path);
+    // Map or read the file
+    if (mcp_resource_content_load_file(content, file_path, max_size) != 0) {
+        mcp_log_debug("File resource: Cannot read file: %s", file_path);
         return -1;
     }
+    size_t file_size = content->size;
 
     // Determine MIME type
     const char *mime_type = get_mime_type_from_extension(file_path);
@@ -158,17 +153,10 @@ int mcp_file_resource_handler(const mcp_resource_template_context_t *context,
                   (strcmp(mime_type, "application/javascript") == 0);
 
     // Fill content structure
-    content->data = data;
-    content->size = file_size;
     content->mime_type = strdup(mime_type);
     content->is_binary = is_text ? 0 : 1;
 
-    if (is_text) {
-        // Null-terminate text content
-        ((char*)data)[file_size] = '\0';
-    }
-
-    printf("[FILE_RESOURCE] Successfully read file: %s (%zu bytes, %s)\n",
+    mcp_log_debug("File resource: Successfully read file: %s (%zu bytes, %s)",
            file_path, file_size, mime_type);
 
     return 0;
@@ -0,0 +1,257 @@
+#include "resource_cache.h"
+#include "protocol/json_writer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define CACHE_INITIAL_BUCKETS 64
+
+struct mcp_resource_cache_entry {
+    char *uri;
+    uint32_t hash;
+    mcp_resource_cache_validator_t validator;
+    char *json;
+    size_t length;
+    size_t ref_count;                       // Cache's reference plus one per live view
+    mcp_resource_cache_entry_t *hash_next;
+    mcp_resource_cache_entry_t *lru_prev;
+    mcp_resource_cache_entry_t *lru_next;
+};
+
+// FNV-1a hash of a URI
+static uint32_t cache_uri_hash(const char *uri) {
+    uint32_t hash = 2166136261u;
+    while (*uri) {
+        hash ^= (unsigned char)*uri++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void cache_entry_unref(void *arg) {
+    mcp_resource_cache_entry_t *entry = (mcp_resource_cache_entry_t*)arg;
+    if (__atomic_sub_fetch(&entry->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(entry->json);
+        free(entry->uri);
+        free(entry);
+    }
+}
+
+static cJSON *cache_entry_view(mcp_resource_cache_entry_t *entry) {
+    __atomic_add_fetch(&entry->ref_count, 1, __ATOMIC_RELAXED);
+
+    cJSON *view = mcp_json_create_raw_view(entry->json, entry->length, cache_entry_unref, entry);
+    if (!view) {
+        cache_entry_unref(entry);
+    }
+    return view;
+}
+
+static bool cache_entry_valid(const mcp_resource_cache_entry_t *entry,
+                              const mcp_resource_cache_validator_t *validator, uint64_t now_ms) {
+    if (entry->validator.expires_ms != 0 && now_ms >= entry->validator.expires_ms) {
+        return false;
+    }
+    return entry->validator.mtime_sec == validator->mtime_sec &&
+           entry->validator.mtime_nsec == validator->mtime_nsec &&
+           entry->validator.size == validator->size;
+}
+
+static uint64_t cache_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+// Internal list/table helpers - caller holds the mutex
+static void lru_unlink(mcp_resource_cache_t *cache, mcp_resource_cache_entry_t *entry) {
+    if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+    else cache->lru_head = entry->lru_next;
+    if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+    else cache->lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void lru_push_front(mcp_resource_cache_t *cache, mcp_resource_cache_entry_t *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head) cache->lru_head->lru_prev = entry;
+    cache->lru_head = entry;
+    if (!cache->lru_tail) cache->lru_tail = entry;
+}
+
+static mcp_resource_cache_entry_t **bucket_find(mcp_resource_cache_t *cache, const char *uri,
+                                                uint32_t hash) {
+    mcp_resource_cache_entry_t **link = &cache->buckets[hash & (cache->bucket_count - 1)];
+    while (*link && ((*link)->hash != hash || strcmp((*link)->uri, uri) != 0)) {
+        link = &(*link)->hash_next;
+    }
+    return link;
+}
+
+static void cache_remove(mcp_resource_cache_t *cache, mcp_resource_cache_entry_t *entry) {
+    mcp_resource_cache_entry_t **link = bucket_find(cache, entry->uri, entry->hash);
+    if (*link == entry) {
+        *link = entry->hash_next;
+    }
+    lru_unlink(cache, entry);
+    cache->entries--;
+    cache->bytes -= entry->length;
+    cache_entry_unref(entry);
+}
+
+static void cache_grow(mcp_resource_cache_t *cache) {
+    size_t bucket_count = cache->bucket_count * 2;
+    mcp_resource_cache_entry_t **buckets = calloc(bucket_count, sizeof(*buckets));
+    if (!buckets) return;  // Keep the old table, chains just get longer
+
+    for (size_t i = 0; i < cache->bucket_count; i++) {
+        mcp_resource_cache_entry_t *entry = cache->buckets[i];
+        while (entry) {
+            mcp_resource_cache_entry_t *next = entry->hash_next;
+            size_t index = entry->hash & (bucket_count - 1);
+            entry->hash_next = buckets[index];
+            buckets[index] = entry;
+            entry = next;
+        }
+    }
+
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = bucket_count;
+}
+
+// Cache lifecycle
+mcp_resource_cache_t *mcp_resource_cache_create(size_t max_bytes) {
+    mcp_resource_cache_t *cache = calloc(1, sizeof(mcp_resource_cache_t));
+    if (!cache) return NULL;
+
+    cache->buckets = calloc(CACHE_INITIAL_BUCKETS, sizeof(*cache->buckets));
+    if (!cache->buckets || pthread_mutex_init(&cache->mutex, NULL) != 0) {
+        free(cache->buckets);
+        free(cache);
+        return NULL;
+    }
+
+    cache->bucket_count = CACHE_INITIAL_BUCKETS;
+    cache->max_bytes = max_bytes;
+    return cache;
+}
+
+void mcp_resource_cache_destroy(mcp_resource_cache_t *cache) {
+    if (!cache) return;
+
+    while (cache->lru_head) {
+        cache_remove(cache, cache->lru_head);
+    }
+
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache->buckets);
+    free(cache);
+}
+
+// Lookup and store
+cJSON *mcp_resource_cache_lookup(mcp_resource_cache_t *cache, const char *uri,
+                                 const mcp_resource_cache_validator_t *validator) {
+    if (!cache || !uri || !validator) return NULL;
+
+    uint32_t hash = cache_uri_hash(uri);
+    uint64_t now_ms = cache_now_ms();
+    cJSON *view = NULL;
+
+    pthread_mutex_lock(&cache->mutex);
+
+    mcp_resource_cache_entry_t *entry = *bucket_find(cache, uri, hash);
+    if (entry && !cache_entry_valid(entry, validator, now_ms)) {
+        cache_remove(cache, entry);
+        entry = NULL;
+    }
+
+    if (entry) {
+        lru_unlink(cache, entry);
+        lru_push_front(cache, entry);
+        view = cache_entry_view(entry);
+    }
+
+    if (view) cache->hits++;
+    else cache->misses++;
+
+    pthread_mutex_unlock(&cache->mutex);
+    return view;
+}
+
+cJSON *mcp_resource_cache_store(mcp_resource_cache_t *cache, const char *uri,
+                                const mcp_resource_cache_validator_t *validator,
+                                char *json, size_t length) {
+    if (!cache || !uri || !validator || !json || length > cache->max_bytes) {
+        free(json);
+        return NULL;
+    }
+
+    mcp_resource_cache_entry_t *entry = calloc(1, sizeof(mcp_resource_cache_entry_t));
+    if (!entry || !(entry->uri = strdup(uri))) {
+        free(entry);
+        free(json);
+        return NULL;
+    }
+
+    entry->hash = cache_uri_hash(uri);
+    entry->validator = *validator;
+    entry->json = json;
+    entry->length = length;
+    entry->ref_count = 1;
+
+    pthread_mutex_lock(&cache->mutex);
+
+    // Replace a concurrent store of the same URI, then make room
+    mcp_resource_cache_entry_t *existing = *bucket_find(cache, uri, entry->hash);
+    if (existing) {
+        cache_remove(cache, existing);
+    }
+    while (cache->lru_tail && cache->bytes + length > cache->max_bytes) {
+        cache_remove(cache, cache->lru_tail);
+        cache->evictions++;
+    }
+    if (cache->entries >= cache->bucket_count) {
+        cache_grow(cache);
+    }
+
+    mcp_resource_cache_entry_t **bucket = &cache->buckets[entry->hash & (cache->bucket_count - 1)];
+    entry->hash_next = *bucket;
+    *bucket = entry;
+    lru_push_front(cache, entry);
+    cache->entries++;
+    cache->bytes += length;
+
+    cJSON *view = cache_entry_view(entry);
+
+    pthread_mutex_unlock(&cache->mutex);
+    return view;
+}
+
+void mcp_resource_cache_invalidate(mcp_resource_cache_t *cache, const char *uri) {
+    if (!cache || !uri) return;
+
+    pthread_mutex_lock(&cache->mutex);
+    mcp_resource_cache_entry_t *entry = *bucket_find(cache, uri, cache_uri_hash(uri));
+    if (entry) {
+        cache_remove(cache, entry);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+void mcp_resource_cache_get_stats(mcp_resource_cache_t *cache, mcp_resource_cache_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(mcp_resource_cache_stats_t));
+    if (!cache) return;
+
+    pthread_mutex_lock(&cache->mutex);
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->evictions = cache->evictions;
+    stats->entries = cache->entries;
+    stats->bytes = cache->bytes;
+    stats->max_bytes = cache->max_bytes;
+    pthread_mutex_unlock(&cache->mutex);
+}
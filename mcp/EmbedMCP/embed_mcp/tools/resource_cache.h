@@ -0,0 +1,85 @@
+#ifndef RESOURCE_CACHE_H
+#define RESOURCE_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "cjson/cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Size-bounded LRU cache of serialized resources/read content objects.
+ * Entries are reference counted, so a response can keep writing a cached
+ * fragment after it has been evicted.
+ */
+typedef struct mcp_resource_cache_entry mcp_resource_cache_entry_t;
+
+/**
+ * What a cached entry must still match to be served
+ */
+typedef struct {
+    int64_t mtime_sec;      // File resources: modification time and size
+    int64_t mtime_nsec;
+    uint64_t size;
+    uint64_t expires_ms;    // Function resources: absolute expiry, 0 = never
+} mcp_resource_cache_validator_t;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t entries;
+    size_t bytes;
+    size_t max_bytes;
+    uint64_t coalesced;     // Filled in by the registry: reads that shared a concurrent read
+} mcp_resource_cache_stats_t;
+
+typedef struct {
+    mcp_resource_cache_entry_t **buckets;
+    size_t bucket_count;                    // Power of two
+    mcp_resource_cache_entry_t *lru_head;   // Most recently used
+    mcp_resource_cache_entry_t *lru_tail;
+    size_t entries;
+    size_t bytes;
+    size_t max_bytes;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    pthread_mutex_t mutex;
+} mcp_resource_cache_t;
+
+/**
+ * Create a cache holding at most max_bytes of serialized content
+ * @return Allocated cache, or NULL on error
+ */
+mcp_resource_cache_t *mcp_resource_cache_create(size_t max_bytes);
+void mcp_resource_cache_destroy(mcp_resource_cache_t *cache);
+
+/**
+ * Look up a fragment
+ * @return Raw JSON node borrowing the cached bytes (free with mcp_json_delete),
+ *         or NULL on a miss or when the entry no longer matches the validator
+ */
+cJSON *mcp_resource_cache_lookup(mcp_resource_cache_t *cache, const char *uri,
+                                 const mcp_resource_cache_validator_t *validator);
+
+/**
+ * Store a serialized fragment (ownership of json is taken in all cases)
+ * @return Raw JSON node for the stored fragment, or NULL if it could not be
+ *         cached (too large, out of memory) - json has been freed then
+ */
+cJSON *mcp_resource_cache_store(mcp_resource_cache_t *cache, const char *uri,
+                                const mcp_resource_cache_validator_t *validator,
+                                char *json, size_t length);
+
+void mcp_resource_cache_invalidate(mcp_resource_cache_t *cache, const char *uri);
+void mcp_resource_cache_get_stats(mcp_resource_cache_t *cache, mcp_resource_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RESOURCE_CACHE_H
@@ -1,4 +1,5 @@
 #include "resource_interface.h"
+#include "hal/platform_hal.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -7,10 +8,14 @@
 void mcp_resource_content_cleanup(mcp_resource_content_t *content) {
     if (!content) return;
     
-    if (content->data) {
+    if (content->release) {
+        content->release(content->release_ctx);
+    } else if (content->data) {
         free(content->data);
-        content->data = NULL;
     }
+    content->data = NULL;
+    content->release = NULL;
+    content->release_ctx = NULL;
     if (content->mime_type) {
         free(content->mime_type);
         content->mime_type = NULL;
@@ -19,6 +24,68 @@ void mcp_resource_content_cleanup(mcp_resource_content_t *content) {
     content->is_binary = 0;
 }
 
+// Load a whole file, mapped when the platform supports it
+int mcp_resource_content_load_file(mcp_resource_content_t *content, const char *path, size_t max_size) {
+    if (!content || !path) return -1;
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    if (hal && hal->file.map && hal->file.unmap) {
+        const void *data = NULL;
+        size_t size = 0;
+        void *view = hal->file.map(path, &data, &size);
+        if (!view) return -1;
+
+        if (max_size > 0 && size > max_size) {
+            hal->file.unmap(view);
+            return -1;
+        }
+
+        content->data = (void*)data;
+        content->size = size;
+        content->release = hal->file.unmap;
+        content->release_ctx = view;
+        return 0;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+    
+    // Get file size
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    if (size < 0 || (max_size > 0 && (size_t)size > max_size)) {
+        fclose(file);
+        return -1;
+    }
+    
+    // Allocate buffer
+    void *data = malloc(size + 1); // +1 for null terminator
+    if (!data) {
+        fclose(file);
+        return -1;
+    }
+    
+    // Read file
+    size_t read_size = fread(data, 1, size, file);
+    fclose(file);
+    
+    if (read_size != (size_t)size) {
+        free(data);
+        return -1;
+    }
+    
+    // Null terminate for text files
+    ((char*)data)[size] = '\0';
+
+    content->data = data;
+    content->size = size;
+    content->release = NULL;
+    content->release_ctx = NULL;
+    return 0;
+}
+
 // Create a new resource descriptor
 mcp_resource_desc_t *mcp_resource_desc_create(const char *uri,
                                               const char *name,
@@ -36,7 +103,6 @@ mcp_resource_desc_t *mcp_resource_desc_create(const char *uri,
     resource->description = description ? strdup(description) : NULL;
     resource->mime_type = strdup(mime_type ? mime_type : "text/plain");
     resource->type = type;
-    resource->next = NULL;
     
     // Check allocation success
     if (!resource->uri || !resource->name || !resource->mime_type) {
@@ -81,43 +147,11 @@ void mcp_resource_desc_destroy(mcp_resource_desc_t *resource) {
 
 // Helper function to read file content
 static int read_file_content(const char *path, mcp_resource_content_t *content, const char *mime_type) {
-    FILE *file = fopen(path, "rb");
-    if (!file) return -1;
-    
-    // Get file size
-    fseek(file, 0, SEEK_END);
-    long size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    
-    if (size < 0) {
-        fclose(file);
-        return -1;
-    }
-    
-    // Allocate buffer
-    void *data = malloc(size + 1); // +1 for null terminator
-    if (!data) {
-        fclose(file);
-        return -1;
-    }
-    
-    // Read file
-    size_t read_size = fread(data, 1, size, file);
-    fclose(file);
-    
-    if (read_size != (size_t)size) {
-        free(data);
-        return -1;
-    }
-    
-    // Null terminate for text files
-    ((char*)data)[size] = '\0';
+    if (mcp_resource_content_load_file(content, path, 0) != 0) return -1;
     
     // Determine if binary based on MIME type
     int is_binary = mime_type && !strncmp(mime_type, "text/", 5) ? 0 : 1;
     
-    content->data = data;
-    content->size = size;
     content->mime_type = strdup(mime_type ? mime_type : "application/octet-stream");
     content->is_binary = is_binary;
     
@@ -31,6 +31,11 @@ typedef struct {
     size_t size;            // Size of data in bytes
     char *mime_type;        // MIME type of content (allocated, caller must free)
     int is_binary;          // 1 if binary data, 0 if text
+
+    // Set for borrowed data (e.g. a mapped file): cleanup calls release(release_ctx)
+    // instead of free(data). Borrowed text is not NUL-terminated - use size.
+    void (*release)(void *ctx);
+    void *release_ctx;
 } mcp_resource_content_t;
 
 /**
@@ -85,9 +90,8 @@ struct mcp_resource_desc {
             char *url;      // HTTP URL (allocated)
         } http;
     } data;
-    
-    // Linked list for registry
-    mcp_resource_desc_t *next;
+
+    uint32_t cache_ttl_ms;  // Function resources: how long a cached read stays valid (0 = never cached, atomic)
 };
 
 /**
@@ -96,6 +100,17 @@ struct mcp_resource_desc {
  */
 void mcp_resource_content_cleanup(mcp_resource_content_t *content);
 
+/**
+ * Load a whole file into a content structure
+ * Uses the platform's file views when available (shared by concurrent reads, see
+ * release), otherwise reads the file into a NUL-terminated heap buffer.
+ * @param content Content structure (data, size and release are filled in)
+ * @param path File path
+ * @param max_size Largest accepted file, 0 for no limit
+ * @return 0 on success, -1 on error
+ */
+int mcp_resource_content_load_file(mcp_resource_content_t *content, const char *path, size_t max_size);
+
 /**
  * Create a new resource descriptor
  * @param uri Resource URI (will be copied)
@@ -138,13 +153,21 @@ typedef struct {
     int required;         // 1 if required, 0 if optional
 } mcp_resource_template_param_t;
 
+/**
+ * Parameter captured from a resolved URI
+ */
+typedef struct {
+    const char *name;             // Parameter name from the URI template
+    const char *value;            // Points into resolved_uri, not NUL-terminated
+    size_t value_length;
+} mcp_resource_template_arg_t;
+
 /**
  * Context passed to resource template handlers
  */
 typedef struct {
     const char *resolved_uri;     // The resolved URI with parameters filled in
-    char **param_names;           // Array of parameter names
-    char **param_values;          // Array of parameter values
+    const mcp_resource_template_arg_t *params;  // Parameters in template order
     size_t param_count;           // Number of parameters
     void *user_data;              // User-provided data
 } mcp_resource_template_context_t;
@@ -167,8 +190,6 @@ typedef struct mcp_resource_template {
     int (*handler)(const mcp_resource_template_context_t *context,
                    mcp_resource_content_t *content);
     void *user_data;              // User data passed to handler
-
-    struct mcp_resource_template *next;  // Linked list
 } mcp_resource_template_t;
 
 /**
@@ -201,13 +222,22 @@ void mcp_resource_template_set_handler(mcp_resource_template_t *template,
                                                       mcp_resource_content_t *content),
                                        void *user_data);
 
+/**
+ * Look up a captured parameter by name
+ * @param length Output value length (can be NULL)
+ * @return Pointer to the value inside resolved_uri, or NULL if absent
+ */
+const char *mcp_resource_template_get_param(const mcp_resource_template_context_t *context,
+                                            const char *name, size_t *length);
+
 /**
  * Check if a URI matches a template
  */
 int mcp_resource_template_matches_uri(const char *uri_template, const char *uri);
 
 /**
- * Parse URI against template and extract parameters
+ * Parse URI against template and extract parameters (heap copies, caller frees)
+ * Registered templates are matched through the registry's compiled trie instead.
  */
 int mcp_resource_template_parse_uri(const char *uri_template,
                                     const char *resolved_uri,
@@ -1,7 +1,11 @@
 #include "resource_registry.h"
+#include "protocol/json_writer.h"
+#include "utils/epoch.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
 
 // Helper function to detect MIME type from file extension
 static const char *detect_mime_type(const char *file_path) {
@@ -39,18 +43,192 @@ static const char *detect_mime_type(const char *file_path) {
     return "application/octet-stream";
 }
 
+#define RESOURCE_INDEX_MIN_CAPACITY 16
+
+typedef struct {
+    uint32_t hash;
+    mcp_resource_desc_t *resource;   // NULL = empty slot
+} mcp_resource_index_slot_t;
+
+// Registered templates and their compiled patterns, shared by snapshots until a
+// template is added
+typedef struct {
+    size_t count;
+    mcp_resource_template_t **templates;  // Newest first, as resources/templates/list lists them
+    mcp_uri_trie_t trie;
+} resource_template_set_t;
+
+// The registered resources at one version. Never changed once published; the
+// descriptors and template set it points to are retired on their own when they leave.
+struct mcp_resource_snapshot {
+    uint64_t version;                     // Bumped on every change
+    size_t count;
+    mcp_resource_desc_t **order;          // Registration order; list cursors are offsets into it
+    mcp_resource_index_slot_t *index;     // URI lookup (open addressing, at most half full)
+    size_t index_capacity;                // Power of two
+    resource_template_set_t *templates;   // NULL until a template is registered
+};
+
+// FNV-1a hash of a resource URI
+static uint32_t resource_uri_hash(const char *uri) {
+    uint32_t hash = 2166136261u;
+    while (*uri) {
+        hash ^= (unsigned char)*uri++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Slot holding uri, or the first empty slot of its probe chain
+static mcp_resource_index_slot_t *resource_index_probe(mcp_resource_index_slot_t *slots, size_t capacity,
+                                                       const char *uri, uint32_t hash) {
+    size_t mask = capacity - 1;
+    size_t index = hash & mask;
+
+    while (slots[index].resource) {
+        if (slots[index].hash == hash && strcmp(slots[index].resource->uri, uri) == 0) {
+            break;
+        }
+        index = (index + 1) & mask;
+    }
+
+    return &slots[index];
+}
+
+static void resource_desc_free(void *resource) {
+    mcp_resource_desc_destroy((mcp_resource_desc_t*)resource);
+}
+
+static void resource_template_set_free(void *arg) {
+    resource_template_set_t *set = (resource_template_set_t*)arg;
+    if (!set) return;
+
+    mcp_uri_trie_destroy(&set->trie);
+    free(set);
+}
+
+// Templates of base (may be NULL) plus template; NULL if its pattern is malformed or
+// taken, or out of memory
+static resource_template_set_t *resource_template_set_create(const resource_template_set_t *base,
+                                                             mcp_resource_template_t *template) {
+    size_t count = (base ? base->count : 0) + 1;
+    resource_template_set_t *set = malloc(sizeof(resource_template_set_t) +
+                                          count * sizeof(mcp_resource_template_t*));
+    if (!set) return NULL;
+
+    set->count = count;
+    set->templates = (mcp_resource_template_t**)(set + 1);
+    set->templates[0] = template;
+    for (size_t i = 1; i < count; i++) {
+        set->templates[i] = base->templates[i - 1];
+    }
+
+    // The trie is compiled afresh in registration order, so readers of the old set
+    // never see it change
+    mcp_uri_trie_init(&set->trie);
+    for (size_t i = count; i > 0; i--) {
+        mcp_resource_template_t *current = set->templates[i - 1];
+        if (mcp_uri_trie_insert(&set->trie, current->uri_template, current) != 0) {
+            resource_template_set_free(set);
+            return NULL;
+        }
+    }
+    return set;
+}
+
+/**
+ * Build the snapshot that follows base (NULL: the empty first one): its resources
+ * minus removed, plus added (both may be NULL), with the given templates. The URI
+ * must not be registered already.
+ */
+static mcp_resource_snapshot_t *resource_snapshot_create(const mcp_resource_snapshot_t *base,
+                                                         const mcp_resource_desc_t *removed,
+                                                         mcp_resource_desc_t *added,
+                                                         resource_template_set_t *templates) {
+    size_t count = (base ? base->count : 0) - (removed ? 1 : 0) + (added ? 1 : 0);
+    size_t capacity = RESOURCE_INDEX_MIN_CAPACITY;
+    while (count * 2 > capacity) {
+        capacity *= 2;
+    }
+
+    mcp_resource_snapshot_t *snapshot = calloc(1, sizeof(mcp_resource_snapshot_t) +
+                                                  count * sizeof(mcp_resource_desc_t*) +
+                                                  capacity * sizeof(mcp_resource_index_slot_t));
+    if (!snapshot) return NULL;
+
+    snapshot->version = base ? base->version + 1 : 0;
+    snapshot->order = (mcp_resource_desc_t**)(snapshot + 1);
+    snapshot->index = (mcp_resource_index_slot_t*)(snapshot->order + count);
+    snapshot->index_capacity = capacity;
+    snapshot->templates = templates;
+
+    size_t n = 0;
+    for (size_t i = 0; base && i < base->count; i++) {
+        if (base->order[i] != removed) {
+            snapshot->order[n++] = base->order[i];
+        }
+    }
+
+    // Slots keep their hashes, so the index is copied, or re-placed, without rehashing URIs
+    if (base && !removed && base->index_capacity == capacity) {
+        memcpy(snapshot->index, base->index, capacity * sizeof(mcp_resource_index_slot_t));
+    } else {
+        for (size_t i = 0; base && i < base->index_capacity; i++) {
+            const mcp_resource_index_slot_t *slot = &base->index[i];
+            if (slot->resource && slot->resource != removed) {
+                *resource_index_probe(snapshot->index, capacity, slot->resource->uri, slot->hash) = *slot;
+            }
+        }
+    }
+
+    if (added) {
+        uint32_t hash = resource_uri_hash(added->uri);
+        mcp_resource_index_slot_t *slot = resource_index_probe(snapshot->index, capacity, added->uri, hash);
+        slot->hash = hash;
+        slot->resource = added;
+        snapshot->order[n++] = added;
+    }
+
+    snapshot->count = n;
+    return snapshot;
+}
+
+// Current snapshot; the caller must be inside an epoch and not use it after leaving
+static mcp_resource_snapshot_t *resource_snapshot_current(const mcp_resource_registry_t *registry) {
+    return __atomic_load_n(&registry->snapshot, __ATOMIC_ACQUIRE);
+}
+
+// Replace the snapshot; caller must hold the registry lock
+static void resource_snapshot_publish(mcp_resource_registry_t *registry, mcp_resource_snapshot_t *next) {
+    mcp_resource_snapshot_t *previous = __atomic_exchange_n(&registry->snapshot, next, __ATOMIC_SEQ_CST);
+    mcp_epoch_retire(previous, free);
+}
+
 // Create a new resource registry
 mcp_resource_registry_t *mcp_resource_registry_create(void) {
     mcp_resource_registry_t *registry = calloc(1, sizeof(mcp_resource_registry_t));
     if (!registry) return NULL;
 
-    registry->resources = NULL;
-    registry->count = 0;
     registry->enable_logging = 0;
 
-    // Initialize templates
-    registry->templates = NULL;
-    registry->template_count = 0;
+    registry->snapshot = resource_snapshot_create(NULL, NULL, NULL, NULL);
+    if (!registry->snapshot) {
+        free(registry);
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&registry->lock, NULL) != 0) {
+        free(registry->snapshot);
+        free(registry);
+        return NULL;
+    }
+
+    if (mcp_single_flight_group_init(&registry->reads) != 0) {
+        pthread_mutex_destroy(&registry->lock);
+        free(registry->snapshot);
+        free(registry);
+        return NULL;
+    }
 
     return registry;
 }
@@ -59,22 +237,29 @@ mcp_resource_registry_t *mcp_resource_registry_create(void) {
 void mcp_resource_registry_destroy(mcp_resource_registry_t *registry) {
     if (!registry) return;
 
+    pthread_mutex_lock(&registry->lock);
+    mcp_resource_snapshot_t *snapshot = __atomic_exchange_n(&registry->snapshot, NULL, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&registry->lock);
+
+    // Let replaced snapshots and removed resources go first
+    mcp_epoch_barrier();
+
     // Free all resources
-    mcp_resource_desc_t *current = registry->resources;
-    while (current) {
-        mcp_resource_desc_t *next = current->next;
-        mcp_resource_desc_destroy(current);
-        current = next;
+    for (size_t i = 0; i < snapshot->count; i++) {
+        mcp_resource_desc_destroy(snapshot->order[i]);
     }
 
     // Free all templates
-    mcp_resource_template_t *template_current = registry->templates;
-    while (template_current) {
-        mcp_resource_template_t *template_next = template_current->next;
-        mcp_resource_template_destroy(template_current);
-        template_current = template_next;
+    resource_template_set_t *templates = snapshot->templates;
+    for (size_t i = 0; templates && i < templates->count; i++) {
+        mcp_resource_template_destroy(templates->templates[i]);
     }
+    resource_template_set_free(templates);
+    free(snapshot);
 
+    mcp_resource_cache_destroy(registry->cache);
+    mcp_single_flight_group_destroy(&registry->reads);
+    pthread_mutex_destroy(&registry->lock);
     free(registry);
 }
 
@@ -82,23 +267,33 @@ void mcp_resource_registry_destroy(mcp_resource_registry_t *registry) {
 static int add_resource_to_registry(mcp_resource_registry_t *registry, mcp_resource_desc_t *resource) {
     if (!registry || !resource) return -1;
     
+    pthread_mutex_lock(&registry->lock);
+    mcp_resource_snapshot_t *current = registry->snapshot;
+
     // Check for duplicate URI
-    if (mcp_resource_registry_find(registry, resource->uri)) {
+    if (resource_index_probe(current->index, current->index_capacity, resource->uri,
+                             resource_uri_hash(resource->uri))->resource) {
+        pthread_mutex_unlock(&registry->lock);
         if (registry->enable_logging) {
             fprintf(stderr, "[RESOURCE] Warning: Resource with URI '%s' already exists\n", resource->uri);
         }
         mcp_resource_desc_destroy(resource);
         return -1;
     }
+
+    mcp_resource_snapshot_t *next = resource_snapshot_create(current, NULL, resource, current->templates);
+    if (!next) {
+        pthread_mutex_unlock(&registry->lock);
+        mcp_resource_desc_destroy(resource);
+        return -1;
+    }
+    resource_snapshot_publish(registry, next);
     
-    // Add to front of list
-    resource->next = registry->resources;
-    registry->resources = resource;
-    registry->count++;
-    
+    // Still under the lock: a concurrent removal could free the resource
     if (registry->enable_logging) {
         fprintf(stderr, "[RESOURCE] Registered resource: %s (%s)\n", resource->name, resource->uri);
     }
+    pthread_mutex_unlock(&registry->lock);
     
     return 0;
 }
@@ -228,24 +423,63 @@ int mcp_resource_registry_add_file(mcp_resource_registry_t *registry,
     return add_resource_to_registry(registry, resource);
 }
 
+int mcp_resource_registry_remove(mcp_resource_registry_t *registry, const char *uri) {
+    if (!registry || !uri) return -1;
+
+    pthread_mutex_lock(&registry->lock);
+    mcp_resource_snapshot_t *current = registry->snapshot;
+
+    mcp_resource_desc_t *resource = resource_index_probe(current->index, current->index_capacity, uri,
+                                                         resource_uri_hash(uri))->resource;
+    mcp_resource_snapshot_t *next = resource ? resource_snapshot_create(current, resource, NULL,
+                                                                        current->templates) : NULL;
+    if (!next) {
+        pthread_mutex_unlock(&registry->lock);
+        return -1;
+    }
+    resource_snapshot_publish(registry, next);
+    mcp_epoch_retire(resource, resource_desc_free);
+    pthread_mutex_unlock(&registry->lock);
+
+    // A resource registered under the URI later must not be served this content
+    mcp_resource_cache_invalidate(__atomic_load_n(&registry->cache, __ATOMIC_ACQUIRE), uri);
+
+    if (registry->enable_logging) {
+        fprintf(stderr, "[RESOURCE] Removed resource: %s\n", uri);
+    }
+    return 0;
+}
+
 // Find a resource by URI
 mcp_resource_desc_t *mcp_resource_registry_find(mcp_resource_registry_t *registry, const char *uri) {
     if (!registry || !uri) return NULL;
 
-    mcp_resource_desc_t *current = registry->resources;
-    while (current) {
-        if (strcmp(current->uri, uri) == 0) {
-            return current;
-        }
-        current = current->next;
-    }
+    mcp_epoch_enter();
+    const mcp_resource_snapshot_t *snapshot = resource_snapshot_current(registry);
+    mcp_resource_desc_t *resource = snapshot->count == 0 ? NULL :
+        resource_index_probe(snapshot->index, snapshot->index_capacity, uri, resource_uri_hash(uri))->resource;
+    mcp_epoch_exit();
 
-    return NULL;
+    return resource;
 }
 
 // Get the number of registered resources
 size_t mcp_resource_registry_count(mcp_resource_registry_t *registry) {
-    return registry ? registry->count : 0;
+    if (!registry) return 0;
+
+    mcp_epoch_enter();
+    size_t count = resource_snapshot_current(registry)->count;
+    mcp_epoch_exit();
+    return count;
+}
+
+uint64_t mcp_resource_registry_get_version(mcp_resource_registry_t *registry) {
+    if (!registry) return 0;
+
+    mcp_epoch_enter();
+    uint64_t version = resource_snapshot_current(registry)->version;
+    mcp_epoch_exit();
+    return version;
 }
 
 // Generate JSON list of all resources
@@ -255,10 +489,13 @@ cJSON *mcp_resource_registry_list_resources(mcp_resource_registry_t *registry) {
     cJSON *resources_array = cJSON_CreateArray();
     if (!resources_array) return NULL;
 
-    mcp_resource_desc_t *current = registry->resources;
-    while (current) {
+    mcp_epoch_enter();
+    const mcp_resource_snapshot_t *snapshot = resource_snapshot_current(registry);
+    for (size_t i = 0; i < snapshot->count; i++) {
+        const mcp_resource_desc_t *current = snapshot->order[i];
         cJSON *resource_obj = cJSON_CreateObject();
         if (!resource_obj) {
+            mcp_epoch_exit();
             cJSON_Delete(resources_array);
             return NULL;
         }
@@ -271,22 +508,354 @@ cJSON *mcp_resource_registry_list_resources(mcp_resource_registry_t *registry) {
         cJSON_AddStringToObject(resource_obj, "mimeType", current->mime_type);
 
         cJSON_AddItemToArray(resources_array, resource_obj);
-        current = current->next;
     }
+    mcp_epoch_exit();
 
     return resources_array;
 }
 
+static int write_resource_entry(mcp_json_buffer_t *buffer, const mcp_resource_desc_t *resource) {
+    if (mcp_json_write_literal(buffer, "{\"uri\":") != 0 ||
+        mcp_json_write_string(buffer, resource->uri) != 0 ||
+        mcp_json_write_literal(buffer, ",\"name\":") != 0 ||
+        mcp_json_write_string(buffer, resource->name) != 0) {
+        return -1;
+    }
+    if (resource->description &&
+        (mcp_json_write_literal(buffer, ",\"description\":") != 0 ||
+         mcp_json_write_string(buffer, resource->description) != 0)) {
+        return -1;
+    }
+    if (mcp_json_write_literal(buffer, ",\"mimeType\":") != 0 ||
+        mcp_json_write_string(buffer, resource->mime_type) != 0) {
+        return -1;
+    }
+    return mcp_json_write_literal(buffer, "}");
+}
+
+// Cursors are the decimal offset of the next resource in registration order
+static int parse_cursor(const char *cursor, size_t count, size_t *offset) {
+    if (!cursor) {
+        *offset = 0;
+        return 0;
+    }
+
+    size_t value = 0;
+    if (*cursor == '\0') return -1;
+    for (const char *p = cursor; *p; p++) {
+        if (*p < '0' || *p > '9' || value > count) return -1;
+        value = value * 10 + (size_t)(*p - '0');
+    }
+    if (value > count) return -1;
+
+    *offset = value;
+    return 0;
+}
+
+int mcp_resource_registry_list_page(mcp_resource_registry_t *registry, const char *cursor,
+                                    cJSON **page) {
+    if (!registry || !page) return -1;
+    *page = NULL;
+
+    // One snapshot for the whole page; a change between pages may shift the offsets,
+    // as with any offset cursor
+    mcp_epoch_enter();
+    const mcp_resource_snapshot_t *snapshot = resource_snapshot_current(registry);
+    size_t count = snapshot->count;
+
+    size_t offset;
+    if (parse_cursor(cursor, count, &offset) != 0) {
+        mcp_epoch_exit();
+        return -1;
+    }
+
+    size_t page_size = __atomic_load_n(&registry->page_size, __ATOMIC_RELAXED);
+    size_t end = count;
+    if (page_size > 0 && end - offset > page_size) {
+        end = offset + page_size;
+    }
+
+    // Entries are written straight into one buffer and spliced into the response as a raw array
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    int result = mcp_json_write_literal(&buffer, "[");
+    for (size_t i = offset; result == 0 && i < end; i++) {
+        if (i > offset) {
+            result = mcp_json_write_literal(&buffer, ",");
+        }
+        if (result == 0) {
+            result = write_resource_entry(&buffer, snapshot->order[i]);
+        }
+    }
+    if (result == 0) {
+        result = mcp_json_write_literal(&buffer, "]");
+    }
+    mcp_epoch_exit();
+    if (result != 0) {
+        mcp_json_buffer_free(&buffer);
+        return -1;
+    }
+
+    size_t length = buffer.length;
+    char *json = mcp_json_buffer_detach(&buffer);
+    cJSON *resources = json ? mcp_json_create_raw_view(json, length, free, json) : NULL;
+    cJSON *result_obj = cJSON_CreateObject();
+    if (!resources || !result_obj) {
+        if (resources) mcp_json_delete(resources);
+        else free(json);
+        cJSON_Delete(result_obj);
+        return -1;
+    }
+
+    cJSON_AddItemToObject(result_obj, "resources", resources);
+    if (end < count) {
+        char next_cursor[24];
+        snprintf(next_cursor, sizeof(next_cursor), "%zu", end);
+        cJSON_AddStringToObject(result_obj, "nextCursor", next_cursor);
+    }
+
+    *page = result_obj;
+    return 0;
+}
+
+void mcp_resource_registry_set_page_size(mcp_resource_registry_t *registry, size_t page_size) {
+    if (registry) {
+        __atomic_store_n(&registry->page_size, page_size, __ATOMIC_RELAXED);
+    }
+}
+
 // Read resource content by URI
 int mcp_resource_registry_read_resource(mcp_resource_registry_t *registry,
                                         const char *uri,
                                         mcp_resource_content_t *content) {
     if (!registry || !uri || !content) return -1;
 
+    mcp_epoch_enter();
+    mcp_resource_desc_t *resource = mcp_resource_registry_find(registry, uri);
+    int result = resource ? mcp_resource_read_content(resource, content) : -1;
+    mcp_epoch_exit();
+
+    return result;
+}
+
+// Encode read content as a resources/read content object
+cJSON *mcp_resource_content_to_json(const char *uri, mcp_resource_content_t *content) {
+    if (!uri || !content) return NULL;
+
+    cJSON *content_obj = cJSON_CreateObject();
+    if (!content_obj) return NULL;
+
+    cJSON_AddStringToObject(content_obj, "uri", uri);
+    cJSON_AddStringToObject(content_obj, "mimeType", content->mime_type);
+
+    // The content buffer (heap or mapped file) is handed to the tree and written
+    // out from there - base64 for binary data, escaped in place for text
+    mcp_json_release_t release = content->release ? content->release : free;
+    void *release_ctx = content->release ? content->release_ctx : content->data;
+    cJSON *body;
+
+    if (content->is_binary) {
+        body = mcp_json_create_blob(content->data, content->size, release, release_ctx);
+    } else {
+        // Heap text is NUL-terminated, borrowed text is only delimited by its size
+        size_t length = content->release ? content->size :
+                        (content->data ? strlen((const char*)content->data) : 0);
+        body = mcp_json_create_text_view((const char*)content->data, length, release, release_ctx);
+    }
+
+    if (!body) {
+        cJSON_Delete(content_obj);
+        return NULL;
+    }
+
+    content->data = NULL;
+    content->release = NULL;
+    cJSON_AddItemToObject(content_obj, content->is_binary ? "blob" : "text", body);
+    return content_obj;
+}
+
+// Build the cache validator for a resource; returns 0 when its reads may be cached
+static int resource_cache_validator(const mcp_resource_desc_t *resource,
+                                    mcp_resource_cache_validator_t *validator) {
+    memset(validator, 0, sizeof(mcp_resource_cache_validator_t));
+
+    switch (resource->type) {
+        case MCP_RESOURCE_TEXT:
+        case MCP_RESOURCE_BINARY:
+            return 0;  // Immutable once registered
+
+        case MCP_RESOURCE_FILE: {
+            struct stat st;
+            if (stat(resource->data.file.path, &st) != 0) return -1;
+            validator->mtime_sec = (int64_t)st.st_mtim.tv_sec;
+            validator->mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+            validator->size = (uint64_t)st.st_size;
+            return 0;
+        }
+
+        case MCP_RESOURCE_FUNCTION:
+            return __atomic_load_n(&resource->cache_ttl_ms, __ATOMIC_RELAXED) > 0 ? 0 : -1;
+
+        default:
+            return -1;
+    }
+}
+
+static uint64_t resource_cache_expiry(const mcp_resource_desc_t *resource) {
+    if (resource->type != MCP_RESOURCE_FUNCTION) return 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000 +
+           __atomic_load_n(&resource->cache_ttl_ms, __ATOMIC_RELAXED);
+}
+
+// Encode content and, when cacheable, store the compact fragment
+static cJSON *resource_encode_and_cache(mcp_resource_registry_t *registry, const char *uri,
+                                        const mcp_resource_cache_validator_t *validator,
+                                        mcp_resource_content_t *content) {
+    cJSON *content_obj = mcp_resource_content_to_json(uri, content);
+    if (!content_obj || !validator) return content_obj;
+
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    if (mcp_json_write_compact(&buffer, content_obj) != 0) {
+        mcp_json_buffer_free(&buffer);
+        return content_obj;
+    }
+
+    size_t length = buffer.length;
+    mcp_resource_cache_t *cache = __atomic_load_n(&registry->cache, __ATOMIC_ACQUIRE);
+    cJSON *cached = mcp_resource_cache_store(cache, uri, validator, mcp_json_buffer_detach(&buffer), length);
+    if (!cached) return content_obj;  // Too large to cache, serve the tree as is
+
+    mcp_json_delete(content_obj);
+    return cached;
+}
+
+// Read and encode; validator is NULL when the content may not be cached
+static cJSON *resource_read_contents(mcp_resource_registry_t *registry, const char *uri,
+                                    mcp_resource_desc_t *resource,
+                                    mcp_resource_cache_validator_t *validator) {
+    mcp_resource_content_t content = {0};
+
+    if (!resource) {
+        if (mcp_resource_registry_read_template(registry, uri, &content) != 0) {
+            mcp_resource_content_cleanup(&content);
+            return NULL;
+        }
+        cJSON *content_obj = mcp_resource_content_to_json(uri, &content);
+        mcp_resource_content_cleanup(&content);
+        return content_obj;
+    }
+
+    if (mcp_resource_read_content(resource, &content) != 0) {
+        mcp_resource_content_cleanup(&content);
+        return NULL;
+    }
+
+    if (validator) {
+        validator->expires_ms = resource_cache_expiry(resource);
+    }
+
+    cJSON *content_obj = resource_encode_and_cache(registry, uri, validator, &content);
+    mcp_resource_content_cleanup(&content);
+    return content_obj;
+}
+
+cJSON *mcp_resource_registry_read_contents(mcp_resource_registry_t *registry, const char *uri) {
+    if (!registry || !uri) return NULL;
+
+    // The resource (or template) stays valid for the whole read even if it is
+    // removed meanwhile
+    mcp_epoch_enter();
+    mcp_resource_desc_t *resource = mcp_resource_registry_find(registry, uri);
+    mcp_resource_cache_t *cache = __atomic_load_n(&registry->cache, __ATOMIC_ACQUIRE);
+
+    mcp_resource_cache_validator_t validator;
+    int cacheable = resource && cache && resource_cache_validator(resource, &validator) == 0;
+
+    if (cacheable) {
+        cJSON *cached = mcp_resource_cache_lookup(cache, uri, &validator);
+        if (cached) {
+            mcp_epoch_exit();
+            return cached;
+        }
+    }
+
+    // At a reconnect storm many sessions read the same URI at once: one reads the
+    // backend, the others wait for its content
+    bool leader;
+    mcp_single_flight_t *flight = mcp_single_flight_join(&registry->reads, uri, strlen(uri), &leader);
+    if (flight && !leader) {
+        cJSON *shared = mcp_single_flight_wait(flight);
+        if (shared) {
+            mcp_epoch_exit();
+            return shared;
+        }
+        flight = NULL;  // The leader failed, try on our own
+    }
+
+    cJSON *content_obj = resource_read_contents(registry, uri, resource, cacheable ? &validator : NULL);
+    mcp_single_flight_finish(flight, content_obj);
+    mcp_epoch_exit();
+    return content_obj;
+}
+
+// Resource cache configuration
+int mcp_resource_registry_enable_cache(mcp_resource_registry_t *registry, size_t max_bytes) {
+    if (!registry || max_bytes == 0) return -1;
+    if (__atomic_load_n(&registry->cache, __ATOMIC_ACQUIRE)) return 0;
+
+    mcp_resource_cache_t *cache = mcp_resource_cache_create(max_bytes);
+    if (!cache) return -1;
+
+    mcp_resource_cache_t *expected = NULL;
+    if (!__atomic_compare_exchange_n(&registry->cache, &expected, cache, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        mcp_resource_cache_destroy(cache);
+    }
+    return 0;
+}
+
+int mcp_resource_registry_set_cache_ttl(mcp_resource_registry_t *registry, const char *uri,
+                                        uint32_t ttl_ms) {
+    mcp_epoch_enter();
     mcp_resource_desc_t *resource = mcp_resource_registry_find(registry, uri);
+    if (resource) {
+        __atomic_store_n(&resource->cache_ttl_ms, ttl_ms, __ATOMIC_RELAXED);
+    }
+    mcp_epoch_exit();
     if (!resource) return -1;
 
-    return mcp_resource_read_content(resource, content);
+    mcp_resource_cache_invalidate(__atomic_load_n(&registry->cache, __ATOMIC_ACQUIRE), uri);
+    return 0;
+}
+
+void mcp_resource_registry_get_cache_stats(mcp_resource_registry_t *registry,
+                                           mcp_resource_cache_stats_t *stats) {
+    mcp_resource_cache_get_stats(registry ? __atomic_load_n(&registry->cache, __ATOMIC_ACQUIRE) : NULL, stats);
+    if (registry && stats) {
+        stats->coalesced = mcp_single_flight_shared(&registry->reads);
+    }
+}
+
+void mcp_resource_registry_notify_changed(mcp_resource_registry_t *registry, const char *uri) {
+    if (!registry || !uri) return;
+
+    mcp_resource_cache_invalidate(__atomic_load_n(&registry->cache, __ATOMIC_ACQUIRE), uri);
+    if (registry->changed_callback) {
+        registry->changed_callback(uri, registry->changed_user_data);
+    }
+}
+
+void mcp_resource_registry_set_changed_callback(mcp_resource_registry_t *registry,
+                                                mcp_resource_changed_callback_t callback,
+                                                void *user_data) {
+    if (!registry) return;
+
+    registry->changed_callback = callback;
+    registry->changed_user_data = user_data;
 }
 
 // Enable or disable logging
@@ -306,22 +875,40 @@ int mcp_resource_registry_add_template(mcp_resource_registry_t *registry,
         return -1;
     }
 
+    pthread_mutex_lock(&registry->lock);
+    mcp_resource_snapshot_t *current = registry->snapshot;
+    resource_template_set_t *templates = current->templates;
+
     // Check for duplicate template name
-    mcp_resource_template_t *current = registry->templates;
-    while (current) {
-        if (strcmp(current->name, template->name) == 0) {
+    for (size_t i = 0; templates && i < templates->count; i++) {
+        if (strcmp(templates->templates[i]->name, template->name) == 0) {
+            pthread_mutex_unlock(&registry->lock);
             if (registry->enable_logging) {
                 fprintf(stderr, "[RESOURCE] Warning: Template with name '%s' already exists\n", template->name);
             }
             return -1;
         }
-        current = current->next;
     }
 
-    // Add to linked list
-    template->next = registry->templates;
-    registry->templates = template;
-    registry->template_count++;
+    // Compile the patterns; this also rejects malformed and duplicate templates
+    resource_template_set_t *set = resource_template_set_create(templates, template);
+    if (!set) {
+        pthread_mutex_unlock(&registry->lock);
+        if (registry->enable_logging) {
+            fprintf(stderr, "[RESOURCE] Warning: Invalid or duplicate URI template '%s'\n", template->uri_template);
+        }
+        return -1;
+    }
+
+    mcp_resource_snapshot_t *next = resource_snapshot_create(current, NULL, NULL, set);
+    if (!next) {
+        pthread_mutex_unlock(&registry->lock);
+        resource_template_set_free(set);
+        return -1;
+    }
+    resource_snapshot_publish(registry, next);
+    mcp_epoch_retire(templates, resource_template_set_free);
+    pthread_mutex_unlock(&registry->lock);
 
     if (registry->enable_logging) {
         printf("✅ Registered %s template (%s)\n", template->name, template->uri_template);
@@ -331,7 +918,13 @@ int mcp_resource_registry_add_template(mcp_resource_registry_t *registry,
 }
 
 size_t mcp_resource_registry_template_count(mcp_resource_registry_t *registry) {
-    return registry ? registry->template_count : 0;
+    if (!registry) return 0;
+
+    mcp_epoch_enter();
+    const resource_template_set_t *templates = resource_snapshot_current(registry)->templates;
+    size_t count = templates ? templates->count : 0;
+    mcp_epoch_exit();
+    return count;
 }
 
 cJSON *mcp_resource_registry_list_templates(mcp_resource_registry_t *registry) {
@@ -340,10 +933,13 @@ cJSON *mcp_resource_registry_list_templates(mcp_resource_registry_t *registry) {
     cJSON *templates_array = cJSON_CreateArray();
     if (!templates_array) return NULL;
 
-    mcp_resource_template_t *current = registry->templates;
-    while (current) {
+    mcp_epoch_enter();
+    const resource_template_set_t *templates = resource_snapshot_current(registry)->templates;
+    for (size_t i = 0; templates && i < templates->count; i++) {
+        const mcp_resource_template_t *current = templates->templates[i];
         cJSON *template_obj = cJSON_CreateObject();
         if (!template_obj) {
+            mcp_epoch_exit();
             cJSON_Delete(templates_array);
             return NULL;
         }
@@ -361,25 +957,31 @@ cJSON *mcp_resource_registry_list_templates(mcp_resource_registry_t *registry) {
         }
 
         cJSON_AddItemToArray(templates_array, template_obj);
-        current = current->next;
     }
+    mcp_epoch_exit();
 
     return templates_array;
 }
 
+// Match uri against the current templates; the caller must be inside an epoch, and
+// the match (parameter names point into the trie) is valid until it leaves
+static int resource_template_match(mcp_resource_registry_t *registry, const char *uri,
+                                   mcp_uri_trie_match_t *match) {
+    const resource_template_set_t *templates = resource_snapshot_current(registry)->templates;
+    return templates && mcp_uri_trie_match(&templates->trie, uri, match);
+}
+
 mcp_resource_template_t *mcp_resource_registry_find_template(mcp_resource_registry_t *registry,
                                                              const char *uri) {
     if (!registry || !uri) return NULL;
 
-    mcp_resource_template_t *current = registry->templates;
-    while (current) {
-        if (mcp_resource_template_matches_uri(current->uri_template, uri)) {
-            return current;
-        }
-        current = current->next;
-    }
+    // Templates are never removed, so the pointer outlives the epoch
+    mcp_uri_trie_match_t match;
+    mcp_epoch_enter();
+    int found = resource_template_match(registry, uri, &match);
+    mcp_epoch_exit();
 
-    return NULL;
+    return found ? (mcp_resource_template_t*)match.value : NULL;
 }
 
 int mcp_resource_registry_read_template(mcp_resource_registry_t *registry,
@@ -389,47 +991,38 @@ int mcp_resource_registry_read_template(mcp_resource_registry_t *registry,
         return -1;
     }
 
-    mcp_resource_template_t *template = mcp_resource_registry_find_template(registry, uri);
-    if (!template || !template->handler) {
+    // One walk finds the template and captures its parameters as slices of uri
+    mcp_uri_trie_match_t match;
+    mcp_epoch_enter();
+    if (!resource_template_match(registry, uri, &match)) {
+        mcp_epoch_exit();
         return -1;
     }
 
-    // Parse URI parameters
-    char **param_names = NULL;
-    char **param_values = NULL;
-    size_t param_count = 0;
-
-    int parse_result = mcp_resource_template_parse_uri(template->uri_template, uri,
-                                                       &param_names, &param_values, &param_count);
-    if (parse_result != 0) {
+    mcp_resource_template_t *template = (mcp_resource_template_t*)match.value;
+    if (!template->handler) {
+        mcp_epoch_exit();
         return -1;
     }
 
+    mcp_resource_template_arg_t params[MCP_URI_TRIE_MAX_PARAMS];
+    for (size_t i = 0; i < match.param_count; i++) {
+        params[i].name = match.names[i];
+        params[i].value = match.params[i].data;
+        params[i].value_length = match.params[i].length;
+    }
+
     // Create context
     mcp_resource_template_context_t context = {
         .resolved_uri = uri,
-        .param_names = param_names,
-        .param_values = param_values,
-        .param_count = param_count,
+        .params = params,
+        .param_count = match.param_count,
         .user_data = template->user_data
     };
 
-    // Call handler
+    // Call handler; the parameter names stay valid until the epoch is left
+    memset(content, 0, sizeof(mcp_resource_content_t));
     int result = template->handler(&context, content);
-
-    // Clean up parameters
-    if (param_names) {
-        for (size_t i = 0; i < param_count; i++) {
-            free(param_names[i]);
-        }
-        free(param_names);
-    }
-    if (param_values) {
-        for (size_t i = 0; i < param_count; i++) {
-            free(param_values[i]);
-        }
-        free(param_values);
-    }
-
+    mcp_epoch_exit();
     return result;
 }
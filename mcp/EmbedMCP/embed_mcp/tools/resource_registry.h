@@ -2,23 +2,46 @@
 #define RESOURCE_REGISTRY_H
 
 #include "resource_interface.h"
+#include "resource_cache.h"
+#include "single_flight.h"
+#include "uri_trie.h"
 #include "cjson/cJSON.h"
+#include <pthread.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Called with the URI passed to mcp_resource_registry_notify_changed()
+ */
+typedef void (*mcp_resource_changed_callback_t)(const char *uri, void *user_data);
+
+typedef struct mcp_resource_snapshot mcp_resource_snapshot_t;
+
 /**
  * Resource registry structure (opaque)
  */
 struct mcp_resource_registry {
-    mcp_resource_desc_t *resources;  // Linked list of resources
-    size_t count;                    // Number of registered resources
+    // Registered resources and templates: an immutable snapshot (URI index,
+    // registration order, compiled templates) replaced as a whole by every change.
+    // Readers load it inside an epoch (utils/epoch.h) and never lock; a replaced
+    // snapshot, and any resource removed with it, is freed once no reader can see it.
+    mcp_resource_snapshot_t *snapshot;   // Atomic, never NULL after create
+    pthread_mutex_t lock;                // Serializes writers; readers never take it
+
     int enable_logging;              // Enable debug logging
+    size_t page_size;                // Resources per list page, 0 = no pagination (atomic)
+
+    // Encoded resources/read contents, NULL until enabled (set once, atomic)
+    mcp_resource_cache_t *cache;
+
+    // Reads in progress, joined by identical concurrent reads
+    mcp_single_flight_group_t reads;
 
-    // Resource Templates support
-    mcp_resource_template_t *templates;  // Linked list of templates
-    size_t template_count;               // Number of registered templates
+    // Told about mcp_resource_registry_notify_changed(), NULL: nobody listens
+    mcp_resource_changed_callback_t changed_callback;
+    void *changed_user_data;
 };
 
 /**
@@ -124,8 +147,19 @@ int mcp_resource_registry_add_file(mcp_resource_registry_t *registry,
                                    const char *mime_type,
                                    const char *file_path);
 
+/**
+ * Remove a resource. Reads already in progress finish with it; the descriptor is
+ * freed once they have.
+ * @param registry Resource registry
+ * @param uri Resource URI
+ * @return 0 on success, -1 if not found or out of memory
+ */
+int mcp_resource_registry_remove(mcp_resource_registry_t *registry, const char *uri);
+
 /**
  * Find a resource by URI
+ * The descriptor may be removed concurrently: to use it beyond a NULL check, call
+ * inside mcp_epoch_enter()/mcp_epoch_exit() and use it only until leaving.
  * @param registry Resource registry
  * @param uri Resource URI to find
  * @return Resource descriptor, or NULL if not found
@@ -139,6 +173,12 @@ mcp_resource_desc_t *mcp_resource_registry_find(mcp_resource_registry_t *registr
  */
 size_t mcp_resource_registry_count(mcp_resource_registry_t *registry);
 
+/**
+ * Get the registry version, which changes whenever resources/list or
+ * resources/templates/list would (resource or template added or removed)
+ */
+uint64_t mcp_resource_registry_get_version(mcp_resource_registry_t *registry);
+
 /**
  * Generate JSON list of all resources (for resources/list response)
  * @param registry Resource registry
@@ -146,6 +186,23 @@ size_t mcp_resource_registry_count(mcp_resource_registry_t *registry);
  */
 cJSON *mcp_resource_registry_list_resources(mcp_resource_registry_t *registry);
 
+/**
+ * Serialize one page of resources/list
+ * @param registry Resource registry
+ * @param cursor Cursor from a previous page's nextCursor, or NULL for the first page
+ * @param page Output {"resources":[...], "nextCursor"?} object (free with mcp_json_delete)
+ * @return 0 on success, -1 if the cursor is invalid or on allocation failure
+ */
+int mcp_resource_registry_list_page(mcp_resource_registry_t *registry, const char *cursor,
+                                    cJSON **page);
+
+/**
+ * Set how many resources a resources/list page holds
+ * @param registry Resource registry
+ * @param page_size Resources per page, 0 to return everything in one page
+ */
+void mcp_resource_registry_set_page_size(mcp_resource_registry_t *registry, size_t page_size);
+
 /**
  * Read resource content by URI
  * @param registry Resource registry
@@ -157,6 +214,72 @@ int mcp_resource_registry_read_resource(mcp_resource_registry_t *registry,
                                         const char *uri,
                                         mcp_resource_content_t *content);
 
+/**
+ * Read a resource (static or template) and encode it as a resources/read content object
+ * Static text/binary and file resources, and function resources with a TTL, are
+ * served from the cache when it is enabled; template reads are never cached.
+ * Identical reads that arrive while one is in progress wait for it and share its
+ * encoded content instead of reading again.
+ * @param registry Resource registry
+ * @param uri Resource URI
+ * @return {"uri","mimeType","text"|"blob"} object (free with mcp_json_delete), or NULL if not found
+ */
+cJSON *mcp_resource_registry_read_contents(mcp_resource_registry_t *registry, const char *uri);
+
+/**
+ * Encode read content as a resources/read content object
+ * @param uri Resource URI
+ * @param content Content to encode (its data is handed to the returned tree, caller still cleans up)
+ * @return Content object (free with mcp_json_delete), or NULL on error
+ */
+cJSON *mcp_resource_content_to_json(const char *uri, mcp_resource_content_t *content);
+
+/**
+ * Enable the resource content cache
+ * @param registry Resource registry
+ * @param max_bytes Upper bound on cached encoded content
+ * @return 0 on success, -1 on error
+ */
+int mcp_resource_registry_enable_cache(mcp_resource_registry_t *registry, size_t max_bytes);
+
+/**
+ * Set how long reads of a function resource may be served from the cache
+ * @param registry Resource registry
+ * @param uri Resource URI
+ * @param ttl_ms Time to live in milliseconds, 0 disables caching for the resource
+ * @return 0 on success, -1 if the resource is not found
+ */
+int mcp_resource_registry_set_cache_ttl(mcp_resource_registry_t *registry, const char *uri,
+                                        uint32_t ttl_ms);
+
+/**
+ * Get resource cache counters (all zero while the cache is disabled)
+ * @param registry Resource registry
+ * @param stats Output statistics
+ */
+void mcp_resource_registry_get_cache_stats(mcp_resource_registry_t *registry,
+                                           mcp_resource_cache_stats_t *stats);
+
+/**
+ * Report that the content of a function resource (or any resource the registry
+ * cannot watch itself) has changed. Its cached content is dropped, and subscribers
+ * are sent notifications/resources/updated if the content read now differs from
+ * what they were last told about. Safe to call from any thread.
+ * @param registry Resource registry
+ * @param uri Resource URI
+ */
+void mcp_resource_registry_notify_changed(mcp_resource_registry_t *registry, const char *uri);
+
+/**
+ * Set the callback mcp_resource_registry_notify_changed() reports to
+ * @param registry Resource registry
+ * @param callback Callback, NULL to stop reporting
+ * @param user_data Passed to the callback
+ */
+void mcp_resource_registry_set_changed_callback(mcp_resource_registry_t *registry,
+                                                mcp_resource_changed_callback_t callback,
+                                                void *user_data);
+
 /**
  * Enable or disable logging for the registry
  * @param registry Resource registry
@@ -1,4 +1,5 @@
 #include "resource_interface.h"
+#include "uri_trie.h"
 #include "utils/logging.h"
 #include <stdlib.h>
 #include <string.h>
@@ -98,8 +99,22 @@ void mcp_resource_template_set_handler(mcp_resource_template_t *template,
     template->user_data = user_data;
 }
 
+const char *mcp_resource_template_get_param(const mcp_resource_template_context_t *context,
+                                            const char *name, size_t *length) {
+    if (!context || !name) return NULL;
+
+    for (size_t i = 0; i < context->param_count; i++) {
+        if (strcmp(context->params[i].name, name) == 0) {
+            if (length) *length = context->params[i].value_length;
+            return context->params[i].value;
+        }
+    }
+
+    return NULL;
+}
+
 // =============================================================================
-// URI Template Parsing - Simplified implementation
+// URI Template Parsing - standalone helpers over a one-template trie
 // =============================================================================
 
 int mcp_resource_template_parse_uri(const char *uri_template,
@@ -115,64 +130,51 @@ int mcp_resource_template_parse_uri(const char *uri_template,
     *param_values = NULL;
     *param_count = 0;
 
-    // For simplicity, we only support one {param} at the end of the template
-    // This covers the most common case: file:///{path}
-    const char *param_start = strstr(uri_template, "{");
-    if (!param_start) {
-        return 0; // No parameters
-    }
-    
-    const char *param_end = strchr(param_start, '}');
-    if (!param_end) {
-        return -1; // Malformed template
-    }
-    
-    // Check if there's anything after the parameter (not supported in simple mode)
-    if (*(param_end + 1) != '\0') {
-        return -1; // Complex templates not supported
+    mcp_uri_trie_t trie;
+    mcp_uri_trie_match_t match;
+    mcp_uri_trie_init(&trie);
+
+    if (mcp_uri_trie_insert(&trie, uri_template, (void*)uri_template) != 0 ||
+        !mcp_uri_trie_match(&trie, resolved_uri, &match)) {
+        mcp_uri_trie_destroy(&trie);
+        return -1;
     }
-    
-    // Extract parameter name
-    size_t param_name_len = param_end - param_start - 1;
-    char *param_name = malloc(param_name_len + 1);
-    if (!param_name) return -1;
-    
-    strncpy(param_name, param_start + 1, param_name_len);
-    param_name[param_name_len] = '\0';
-    
-    // Extract parameter value (everything after the prefix)
-    size_t prefix_len = param_start - uri_template;
-    if (strncmp(uri_template, resolved_uri, prefix_len) != 0) {
-        free(param_name);
-        return -1; // URI doesn't match template prefix
+
+    if (match.param_count == 0) {
+        mcp_uri_trie_destroy(&trie);
+        return 0; // No parameters
     }
-    
-    const char *param_value = resolved_uri + prefix_len;
-    char *value_copy = strdup(param_value);
-    if (!value_copy) {
-        free(param_name);
-        return -1;
+
+    char **names = calloc(match.param_count, sizeof(char*));
+    char **values = calloc(match.param_count, sizeof(char*));
+    int result = (names && values) ? 0 : -1;
+
+    for (size_t i = 0; result == 0 && i < match.param_count; i++) {
+        names[i] = strdup(match.names[i]);
+        values[i] = malloc(match.params[i].length + 1);
+        if (!names[i] || !values[i]) {
+            result = -1;
+            break;
+        }
+        memcpy(values[i], match.params[i].data, match.params[i].length);
+        values[i][match.params[i].length] = '\0';
     }
-    
-    // Allocate result arrays
-    char **names = malloc(sizeof(char*));
-    char **values = malloc(sizeof(char*));
-    if (!names || !values) {
-        free(param_name);
-        free(value_copy);
+
+    if (result != 0) {
+        for (size_t i = 0; i < match.param_count; i++) {
+            if (names) free(names[i]);
+            if (values) free(values[i]);
+        }
         free(names);
         free(values);
-        return -1;
+    } else {
+        *param_names = names;
+        *param_values = values;
+        *param_count = match.param_count;
     }
-    
-    names[0] = param_name;
-    values[0] = value_copy;
-    
-    *param_names = names;
-    *param_values = values;
-    *param_count = 1;
-    
-    return 0;
+
+    mcp_uri_trie_destroy(&trie);
+    return result;
 }
 
 int mcp_resource_template_matches_uri(const char *uri_template, const char *uri) {
@@ -180,26 +182,13 @@ int mcp_resource_template_matches_uri(const char *uri_template, const char *uri)
         return 0;
     }
 
-    char **param_names = NULL;
-    char **param_values = NULL;
-    size_t param_count = 0;
+    mcp_uri_trie_t trie;
+    mcp_uri_trie_match_t match;
+    mcp_uri_trie_init(&trie);
 
-    int result = mcp_resource_template_parse_uri(uri_template, uri, 
-                                                 &param_names, &param_values, &param_count);
-    
-    // Clean up
-    if (param_names) {
-        for (size_t i = 0; i < param_count; i++) {
-            free(param_names[i]);
-        }
-        free(param_names);
-    }
-    if (param_values) {
-        for (size_t i = 0; i < param_count; i++) {
-            free(param_values[i]);
-        }
-        free(param_values);
-    }
+    int matched = mcp_uri_trie_insert(&trie, uri_template, (void*)uri_template) == 0 &&
+                  mcp_uri_trie_match(&trie, uri, &match);
 
-    return (result == 0) ? 1 : 0;
+    mcp_uri_trie_destroy(&trie);
+    return matched;
 }
@@ -0,0 +1,360 @@
+#include "resource_watcher.h"
+#include "utils/epoch.h"
+#include "utils/logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Watch ids handed out by one HAL wait
+#define WATCHER_EVENT_BATCH 32
+
+static uint64_t watcher_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+// 64-bit FNV-1a of data, with the state after the first prefix_length bytes in
+// *prefix_hash (left alone when data is shorter)
+static uint64_t watcher_hash(const uint8_t *data, size_t length, uint64_t prefix_length,
+                             uint64_t *prefix_hash) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        if (i == prefix_length) *prefix_hash = hash;
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    if (prefix_length == length) *prefix_hash = hash;
+    return hash;
+}
+
+// Caller holds mutex
+static mcp_resource_watch_t *watcher_find(mcp_resource_watcher_t *watcher, const char *uri) {
+    for (mcp_resource_watch_t *watch = watcher->watches; watch; watch = watch->next) {
+        if (strcmp(watch->uri, uri) == 0) return watch;
+    }
+    return NULL;
+}
+
+// Another watch on the same file shares its HAL watch. Caller holds mutex.
+static bool watcher_id_shared(mcp_resource_watcher_t *watcher, const mcp_resource_watch_t *except, int id) {
+    for (mcp_resource_watch_t *watch = watcher->watches; watch; watch = watch->next) {
+        if (watch != except && watch->watch_id == id) return true;
+    }
+    return false;
+}
+
+// Caller holds mutex; an earlier deadline is kept
+static void watcher_mark(mcp_resource_watch_t *watch, uint64_t due_ms) {
+    if (!watch->dirty || due_ms < watch->due_ms) {
+        watch->due_ms = due_ms;
+    }
+    watch->dirty = true;
+}
+
+// Caller holds mutex
+static void watcher_wakeup(mcp_resource_watcher_t *watcher) {
+    if (watcher->files) {
+        watcher->hal->file.watch_wakeup(watcher->files);
+    } else {
+        pthread_cond_broadcast(&watcher->cond);
+    }
+}
+
+static void watcher_drop(mcp_resource_watcher_t *watcher, mcp_resource_watch_t *watch) {
+    pthread_mutex_lock(&watcher->mutex);
+    for (mcp_resource_watch_t **link = &watcher->watches; *link; link = &(*link)->next) {
+        if (*link == watch) {
+            *link = watch->next;
+            watcher->watch_count--;
+            break;
+        }
+    }
+    bool shared = watch->watch_id >= 0 && watcher_id_shared(watcher, watch, watch->watch_id);
+    pthread_mutex_unlock(&watcher->mutex);
+
+    if (watch->watch_id >= 0 && !shared) {
+        watcher->hal->file.watch_remove(watcher->files, watch->watch_id);
+    }
+    free(watch->uri);
+    free(watch->path);
+    free(watch);
+}
+
+// Watch the file again: a file replaced by rename or removed has lost its watch
+static void watcher_arm(mcp_resource_watcher_t *watcher, mcp_resource_watch_t *watch) {
+    int id = watcher->hal->file.watch_add(watcher->files, watch->path);
+    if (id == watch->watch_id) return;
+
+    pthread_mutex_lock(&watcher->mutex);
+    int previous = watch->watch_id;
+    watch->watch_id = id;
+    bool shared = previous >= 0 && watcher_id_shared(watcher, watch, previous);
+    if (id < 0) {
+        // Look for the file again later
+        watcher_mark(watch, watcher_now_ms() + MCP_RESOURCE_WATCH_RETRY_MS);
+    }
+    pthread_mutex_unlock(&watcher->mutex);
+
+    if (previous >= 0 && !shared) {
+        watcher->hal->file.watch_remove(watcher->files, previous);
+    }
+}
+
+static int watcher_read(mcp_resource_watcher_t *watcher, const char *uri, mcp_resource_content_t *content) {
+    // The resource may be removed while it is read
+    mcp_epoch_enter();
+    mcp_resource_desc_t *resource = mcp_resource_registry_find(watcher->registry, uri);
+    int result = resource ? mcp_resource_read_content(resource, content)
+                          : mcp_resource_registry_read_template(watcher->registry, uri, content);
+    mcp_epoch_exit();
+    return result;
+}
+
+// Re-read one watch on the watcher thread and report it if the content changed
+static void watcher_process(mcp_resource_watcher_t *watcher, mcp_resource_watch_t *watch) {
+    if (watcher->interested && !watcher->interested(watch->uri, watcher->user_data)) {
+        mcp_log_debug("Nobody is subscribed to %s, no longer watched", watch->uri);
+        watcher_drop(watcher, watch);
+        return;
+    }
+    if (watch->path && watcher->files) {
+        watcher_arm(watcher, watch);
+    }
+
+    mcp_resource_content_t content = {0};
+    bool readable = watcher_read(watcher, watch->uri, &content) == 0;
+    __atomic_add_fetch(&watcher->reads, 1, __ATOMIC_RELAXED);
+
+    uint64_t size = readable ? (uint64_t)content.size : 0;
+    uint64_t prefix_hash = 0;
+    uint64_t hash = readable ? watcher_hash((const uint8_t*)content.data, content.size, watch->size,
+                                            &prefix_hash) : 0;
+    mcp_resource_content_cleanup(&content);
+
+    bool changed = !watch->baseline &&
+                   (readable != watch->have_content || hash != watch->hash || size != watch->size);
+    mcp_resource_append_t appended = {
+        .offset = watch->size,
+        .length = size - watch->size
+    };
+    bool grew = changed && readable && watch->have_content && watch->path &&
+                watch->size > 0 && size > watch->size && prefix_hash == watch->hash;
+
+    watch->baseline = false;
+    watch->have_content = readable;
+    watch->hash = hash;
+    watch->size = size;
+
+    if (changed) {
+        __atomic_add_fetch(&watcher->updates, 1, __ATOMIC_RELAXED);
+        watcher->updated(watch->uri, grew ? &appended : NULL, watcher->user_data);
+    }
+}
+
+// Wait for file events, a reported change or the next deadline. Called and returns
+// with mutex held.
+static void watcher_wait(mcp_resource_watcher_t *watcher, int64_t timeout_ms) {
+    if (!watcher->files) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&watcher->cond, &watcher->mutex);
+            return;
+        }
+        uint64_t deadline = watcher_now_ms() + (uint64_t)timeout_ms;
+        struct timespec until = {
+            .tv_sec = (time_t)(deadline / 1000u),
+            .tv_nsec = (long)(deadline % 1000u) * 1000000L
+        };
+        pthread_cond_timedwait(&watcher->cond, &watcher->mutex, &until);
+        return;
+    }
+
+    int ids[WATCHER_EVENT_BATCH];
+    pthread_mutex_unlock(&watcher->mutex);
+    int count = watcher->hal->file.watch_wait(watcher->files, ids, WATCHER_EVENT_BATCH,
+                                              timeout_ms > INT32_MAX ? INT32_MAX : (int)timeout_ms);
+    pthread_mutex_lock(&watcher->mutex);
+
+    uint64_t due = watcher_now_ms() + MCP_RESOURCE_WATCH_SETTLE_MS;
+    for (int i = 0; i < count; i++) {
+        for (mcp_resource_watch_t *watch = watcher->watches; watch; watch = watch->next) {
+            if (watch->watch_id == ids[i]) {
+                watcher_mark(watch, due);
+                __atomic_add_fetch(&watcher->events, 1, __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+static void *watcher_thread(void *arg) {
+    mcp_resource_watcher_t *watcher = (mcp_resource_watcher_t*)arg;
+
+    pthread_mutex_lock(&watcher->mutex);
+    while (watcher->running) {
+        uint64_t now = watcher_now_ms();
+        int64_t timeout_ms = -1;
+        mcp_resource_watch_t *due = NULL;
+        for (mcp_resource_watch_t *watch = watcher->watches; watch && !due; watch = watch->next) {
+            if (!watch->dirty) continue;
+            if (watch->due_ms <= now) {
+                due = watch;
+            } else if (timeout_ms < 0 || (int64_t)(watch->due_ms - now) < timeout_ms) {
+                timeout_ms = (int64_t)(watch->due_ms - now);
+            }
+        }
+
+        if (!due) {
+            watcher_wait(watcher, timeout_ms);
+            continue;
+        }
+
+        due->dirty = false;
+        pthread_mutex_unlock(&watcher->mutex);
+        watcher_process(watcher, due);
+        pthread_mutex_lock(&watcher->mutex);
+    }
+    pthread_mutex_unlock(&watcher->mutex);
+
+    return NULL;
+}
+
+mcp_resource_watcher_t *mcp_resource_watcher_create(mcp_resource_registry_t *registry,
+                                                    mcp_resource_updated_callback_t updated,
+                                                    mcp_resource_interest_callback_t interested,
+                                                    void *user_data) {
+    if (!registry || !updated) return NULL;
+
+    mcp_resource_watcher_t *watcher = calloc(1, sizeof(mcp_resource_watcher_t));
+    if (!watcher) return NULL;
+
+    watcher->registry = registry;
+    watcher->updated = updated;
+    watcher->interested = interested;
+    watcher->user_data = user_data;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (pthread_mutex_init(&watcher->mutex, NULL) != 0) {
+        pthread_condattr_destroy(&attr);
+        free(watcher);
+        return NULL;
+    }
+    if (pthread_cond_init(&watcher->cond, &attr) != 0) {
+        pthread_condattr_destroy(&attr);
+        pthread_mutex_destroy(&watcher->mutex);
+        free(watcher);
+        return NULL;
+    }
+    pthread_condattr_destroy(&attr);
+
+    // Without a HAL watch set, only reported changes are seen
+    watcher->hal = mcp_platform_get_hal();
+    if (watcher->hal && watcher->hal->file.watch_open) {
+        watcher->files = watcher->hal->file.watch_open();
+    }
+    if (!watcher->files) {
+        mcp_log_debug("File watching unavailable, file resources are not watched");
+    }
+
+    watcher->running = true;
+    if (pthread_create(&watcher->thread, NULL, watcher_thread, watcher) != 0) {
+        if (watcher->files) watcher->hal->file.watch_close(watcher->files);
+        pthread_cond_destroy(&watcher->cond);
+        pthread_mutex_destroy(&watcher->mutex);
+        free(watcher);
+        return NULL;
+    }
+
+    return watcher;
+}
+
+void mcp_resource_watcher_destroy(mcp_resource_watcher_t *watcher) {
+    if (!watcher) return;
+
+    pthread_mutex_lock(&watcher->mutex);
+    watcher->running = false;
+    watcher_wakeup(watcher);
+    pthread_mutex_unlock(&watcher->mutex);
+    pthread_join(watcher->thread, NULL);
+
+    // Closing the set removes its watches
+    mcp_resource_watch_t *watch = watcher->watches;
+    while (watch) {
+        mcp_resource_watch_t *next = watch->next;
+        free(watch->uri);
+        free(watch->path);
+        free(watch);
+        watch = next;
+    }
+    if (watcher->files) {
+        watcher->hal->file.watch_close(watcher->files);
+    }
+
+    pthread_cond_destroy(&watcher->cond);
+    pthread_mutex_destroy(&watcher->mutex);
+    free(watcher);
+}
+
+int mcp_resource_watcher_watch(mcp_resource_watcher_t *watcher, const char *uri, const char *path) {
+    if (!watcher || !uri) return -1;
+
+    pthread_mutex_lock(&watcher->mutex);
+    if (watcher_find(watcher, uri)) {
+        pthread_mutex_unlock(&watcher->mutex);
+        return 0;
+    }
+    if (watcher->watch_count >= MCP_RESOURCE_WATCH_MAX) {
+        pthread_mutex_unlock(&watcher->mutex);
+        return -1;
+    }
+
+    mcp_resource_watch_t *watch = calloc(1, sizeof(mcp_resource_watch_t));
+    if (watch) {
+        watch->uri = strdup(uri);
+        watch->path = path ? strdup(path) : NULL;
+    }
+    if (!watch || !watch->uri || (path && !watch->path)) {
+        pthread_mutex_unlock(&watcher->mutex);
+        if (watch) {
+            free(watch->uri);
+            free(watch->path);
+            free(watch);
+        }
+        return -1;
+    }
+
+    // The thread watches the file and records the content changes are measured against
+    watch->watch_id = -1;
+    watch->baseline = true;
+    watcher_mark(watch, watcher_now_ms());
+    watch->next = watcher->watches;
+    watcher->watches = watch;
+    watcher->watch_count++;
+    watcher_wakeup(watcher);
+    pthread_mutex_unlock(&watcher->mutex);
+
+    return 0;
+}
+
+void mcp_resource_watcher_changed(mcp_resource_watcher_t *watcher, const char *uri) {
+    if (!watcher || !uri) return;
+
+    pthread_mutex_lock(&watcher->mutex);
+    mcp_resource_watch_t *watch = watcher_find(watcher, uri);
+    if (watch) {
+        __atomic_add_fetch(&watcher->events, 1, __ATOMIC_RELAXED);
+        watcher_mark(watch, watcher_now_ms() + MCP_RESOURCE_WATCH_SETTLE_MS);
+        watcher_wakeup(watcher);
+    }
+    pthread_mutex_unlock(&watcher->mutex);
+}
+
+size_t mcp_resource_watcher_count(mcp_resource_watcher_t *watcher) {
+    if (!watcher) return 0;
+
+    pthread_mutex_lock(&watcher->mutex);
+    size_t count = watcher->watch_count;
+    pthread_mutex_unlock(&watcher->mutex);
+    return count;
+}
@@ -0,0 +1,127 @@
+#ifndef RESOURCE_WATCHER_H
+#define RESOURCE_WATCHER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "resource_registry.h"
+#include "hal/platform_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Watches subscribed resources and reports when their content changes.
+ *
+ * Files are watched through the platform HAL (inotify on Linux), so a resource
+ * backed by a file is re-read only after the file was written. Other resources are
+ * re-read when the application reports a change with
+ * mcp_resource_registry_notify_changed(). Either way the content is hashed and
+ * compared with what was read before: a write that leaves the content as it was
+ * reports nothing. Events within MCP_RESOURCE_WATCH_SETTLE_MS are read once.
+ *
+ * A watch lives as long as someone is interested: when it fires and the interest
+ * callback says nobody is subscribed any more, it is dropped.
+ */
+
+// Most resources watched at once
+#ifndef MCP_RESOURCE_WATCH_MAX
+#define MCP_RESOURCE_WATCH_MAX 256
+#endif
+
+// Events closer together than this are read once (a file written in several pieces)
+#define MCP_RESOURCE_WATCH_SETTLE_MS 50
+
+// How often a missing file is looked for again
+#define MCP_RESOURCE_WATCH_RETRY_MS 1000
+
+/**
+ * The content only grew: bytes before offset are unchanged, length bytes were added
+ */
+typedef struct {
+    uint64_t offset;
+    uint64_t length;
+} mcp_resource_append_t;
+
+// Content of uri changed (or it can no longer be read); appended is NULL unless the
+// file only grew. Called on the watcher thread.
+typedef void (*mcp_resource_updated_callback_t)(const char *uri, const mcp_resource_append_t *appended,
+                                                void *user_data);
+
+// Whether any client is still subscribed to uri. Called on the watcher thread.
+typedef bool (*mcp_resource_interest_callback_t)(const char *uri, void *user_data);
+
+// One watched resource (internal)
+typedef struct mcp_resource_watch {
+    char *uri;
+    char *path;                     // File behind the resource, NULL: changes are reported
+    int watch_id;                   // HAL watch, -1 while not watched (missing file)
+    bool dirty;                     // To be read at due_ms
+    uint64_t due_ms;
+    bool baseline;                  // Not read yet: the first read is only recorded
+    bool have_content;              // hash and size describe the content last read
+    uint64_t hash;
+    uint64_t size;
+    struct mcp_resource_watch *next;
+} mcp_resource_watch_t;
+
+typedef struct mcp_resource_watcher {
+    mcp_resource_registry_t *registry;
+    mcp_resource_updated_callback_t updated;
+    mcp_resource_interest_callback_t interested;
+    void *user_data;
+
+    const mcp_platform_hal_t *hal;
+    void *files;                    // HAL watch set, NULL: files are not watched
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;            // Waited on when there is no HAL watch set (monotonic clock)
+    pthread_t thread;
+    bool running;
+
+    mcp_resource_watch_t *watches;  // Unlinked and freed only by the watcher thread
+    size_t watch_count;
+
+    // Statistics (atomic)
+    uint64_t events;                // File events and reported changes
+    uint64_t reads;                 // Content re-read after an event
+    uint64_t updates;               // Reads that found different content
+} mcp_resource_watcher_t;
+
+/**
+ * Create a watcher and start its thread
+ * @param registry Registry the resources are read from
+ * @param updated Called when content changed
+ * @param interested Called before a watch is read, to drop watches nobody wants
+ * @return Watcher, or NULL on error
+ */
+mcp_resource_watcher_t *mcp_resource_watcher_create(mcp_resource_registry_t *registry,
+                                                    mcp_resource_updated_callback_t updated,
+                                                    mcp_resource_interest_callback_t interested,
+                                                    void *user_data);
+
+// Stop the thread and drop all watches
+void mcp_resource_watcher_destroy(mcp_resource_watcher_t *watcher);
+
+/**
+ * Start watching a resource; watching it again does nothing. Its current content is
+ * read on the watcher thread, later changes are reported against it.
+ * @param path File behind the resource (copied), NULL if changes are reported with
+ *             mcp_resource_watcher_changed()
+ * @return 0 on success, -1 when MCP_RESOURCE_WATCH_MAX resources are watched or on error
+ */
+int mcp_resource_watcher_watch(mcp_resource_watcher_t *watcher, const char *uri, const char *path);
+
+// The content of uri may have changed; does nothing unless uri is watched
+void mcp_resource_watcher_changed(mcp_resource_watcher_t *watcher, const char *uri);
+
+// Number of resources watched
+size_t mcp_resource_watcher_count(mcp_resource_watcher_t *watcher);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RESOURCE_WATCHER_H
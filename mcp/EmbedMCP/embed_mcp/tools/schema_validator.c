@@ -0,0 +1,535 @@
+#include "tools/schema_validator.h"
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Type tags, one bit per JSON Schema type
+#define SCHEMA_TYPE_NULL    0x01
+#define SCHEMA_TYPE_BOOLEAN 0x02
+#define SCHEMA_TYPE_INTEGER 0x04
+#define SCHEMA_TYPE_NUMBER  0x08
+#define SCHEMA_TYPE_STRING  0x10
+#define SCHEMA_TYPE_ARRAY   0x20
+#define SCHEMA_TYPE_OBJECT  0x40
+
+#define SCHEMA_HAS_MINIMUM      0x01
+#define SCHEMA_HAS_MAXIMUM      0x02
+#define SCHEMA_HAS_EXCL_MINIMUM 0x04
+#define SCHEMA_HAS_EXCL_MAXIMUM 0x08
+#define SCHEMA_REJECT           0x10    // The "false" schema
+
+#define SCHEMA_ANY        -1            // items/additional: no constraint
+#define SCHEMA_FORBIDDEN  -2            // additional: no undeclared properties
+
+#define SCHEMA_SEEN_INLINE 4            // Bitset words kept on the stack (256 properties)
+#define SCHEMA_EXACT_INTEGER 9007199254740992.0     // 2^53, every double beyond is integral
+
+typedef struct {
+    uint8_t types;                      // Allowed type bits, 0 = any
+    uint8_t flags;
+    double minimum;
+    double maximum;
+    double exclusive_minimum;
+    double exclusive_maximum;
+    uint32_t min_length;                // Strings, in code points
+    uint32_t max_length;
+    uint32_t min_items;
+    uint32_t max_items;
+    uint32_t first_property;            // Contiguous range in properties
+    uint32_t property_count;
+    int32_t items;                      // Node for array elements, or SCHEMA_ANY
+    int32_t additional;                 // Node for undeclared properties, SCHEMA_ANY or SCHEMA_FORBIDDEN
+    cJSON *enum_values;                 // Owned copy, NULL = no enum
+} schema_node_t;
+
+typedef struct {
+    uint32_t name;                      // Offset into the name pool
+    uint32_t hash;
+    int32_t node;
+    bool required;
+} schema_property_t;
+
+struct mcp_schema_validator {
+    schema_node_t *nodes;               // Node 0 is the root
+    size_t node_count;
+    size_t node_capacity;
+    schema_property_t *properties;
+    size_t property_count;
+    size_t property_capacity;
+    char *names;                        // NUL-terminated property names
+    size_t names_length;
+    size_t names_capacity;
+    bool failed;                        // An allocation failed while compiling
+};
+
+// Error path: a chain of stack frames from the value back to the root
+typedef struct schema_path {
+    const struct schema_path *parent;
+    const char *key;                    // Property name, or NULL for an array index
+    size_t index;
+} schema_path_t;
+
+// FNV-1a, same as the parameter binding hash
+static uint32_t schema_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool grow_array(void **array, size_t *capacity, size_t needed, size_t element_size) {
+    if (needed <= *capacity) return true;
+
+    size_t capacity_new = *capacity ? *capacity * 2 : 8;
+    while (capacity_new < needed) capacity_new *= 2;
+    void *resized = realloc(*array, capacity_new * element_size);
+    if (!resized) return false;
+    *array = resized;
+    *capacity = capacity_new;
+    return true;
+}
+
+// =============================================================================
+// Compilation
+// =============================================================================
+
+static int32_t add_node(mcp_schema_validator_t *validator) {
+    if (!grow_array((void**)&validator->nodes, &validator->node_capacity, validator->node_count + 1,
+                    sizeof(schema_node_t))) {
+        validator->failed = true;
+        return SCHEMA_ANY;
+    }
+
+    schema_node_t *node = &validator->nodes[validator->node_count];
+    memset(node, 0, sizeof(schema_node_t));
+    node->max_length = UINT32_MAX;
+    node->max_items = UINT32_MAX;
+    node->items = SCHEMA_ANY;
+    node->additional = SCHEMA_ANY;
+    return (int32_t)validator->node_count++;
+}
+
+static bool add_name(mcp_schema_validator_t *validator, const char *name, uint32_t *offset) {
+    size_t length = strlen(name) + 1;
+    if (!grow_array((void**)&validator->names, &validator->names_capacity, validator->names_length + length, 1)) {
+        validator->failed = true;
+        return false;
+    }
+
+    memcpy(validator->names + validator->names_length, name, length);
+    *offset = (uint32_t)validator->names_length;
+    validator->names_length += length;
+    return true;
+}
+
+static uint8_t type_bit(const char *name) {
+    if (strcmp(name, "string") == 0) return SCHEMA_TYPE_STRING;
+    if (strcmp(name, "number") == 0) return SCHEMA_TYPE_NUMBER;
+    if (strcmp(name, "integer") == 0) return SCHEMA_TYPE_INTEGER;
+    if (strcmp(name, "boolean") == 0) return SCHEMA_TYPE_BOOLEAN;
+    if (strcmp(name, "object") == 0) return SCHEMA_TYPE_OBJECT;
+    if (strcmp(name, "array") == 0) return SCHEMA_TYPE_ARRAY;
+    if (strcmp(name, "null") == 0) return SCHEMA_TYPE_NULL;
+    return 0;
+}
+
+static uint32_t count_keyword(const cJSON *schema, const char *keyword, uint32_t fallback) {
+    const cJSON *value = cJSON_GetObjectItemCaseSensitive(schema, keyword);
+    if (!cJSON_IsNumber(value) || value->valuedouble < 0) return fallback;
+    return value->valuedouble >= (double)UINT32_MAX ? UINT32_MAX : (uint32_t)value->valuedouble;
+}
+
+static void compile_bounds(schema_node_t *node, const cJSON *schema) {
+    const cJSON *minimum = cJSON_GetObjectItemCaseSensitive(schema, "minimum");
+    const cJSON *maximum = cJSON_GetObjectItemCaseSensitive(schema, "maximum");
+    const cJSON *exclusive_minimum = cJSON_GetObjectItemCaseSensitive(schema, "exclusiveMinimum");
+    const cJSON *exclusive_maximum = cJSON_GetObjectItemCaseSensitive(schema, "exclusiveMaximum");
+
+    if (cJSON_IsNumber(minimum)) {
+        // Draft 4 spells an exclusive bound as minimum plus exclusiveMinimum: true
+        node->flags |= cJSON_IsTrue(exclusive_minimum) ? SCHEMA_HAS_EXCL_MINIMUM : SCHEMA_HAS_MINIMUM;
+        node->minimum = minimum->valuedouble;
+        node->exclusive_minimum = minimum->valuedouble;
+    }
+    if (cJSON_IsNumber(maximum)) {
+        node->flags |= cJSON_IsTrue(exclusive_maximum) ? SCHEMA_HAS_EXCL_MAXIMUM : SCHEMA_HAS_MAXIMUM;
+        node->maximum = maximum->valuedouble;
+        node->exclusive_maximum = maximum->valuedouble;
+    }
+    if (cJSON_IsNumber(exclusive_minimum) &&
+        (!(node->flags & SCHEMA_HAS_EXCL_MINIMUM) || exclusive_minimum->valuedouble > node->exclusive_minimum)) {
+        node->flags |= SCHEMA_HAS_EXCL_MINIMUM;
+        node->exclusive_minimum = exclusive_minimum->valuedouble;
+    }
+    if (cJSON_IsNumber(exclusive_maximum) &&
+        (!(node->flags & SCHEMA_HAS_EXCL_MAXIMUM) || exclusive_maximum->valuedouble < node->exclusive_maximum)) {
+        node->flags |= SCHEMA_HAS_EXCL_MAXIMUM;
+        node->exclusive_maximum = exclusive_maximum->valuedouble;
+    }
+}
+
+static int32_t compile_node(mcp_schema_validator_t *validator, const cJSON *schema, int depth);
+
+// Properties and required names share one contiguous range; required names that
+// have no property schema accept any value
+static void compile_properties(mcp_schema_validator_t *validator, schema_node_t *node,
+                               const cJSON *schema, int depth) {
+    const cJSON *properties = cJSON_GetObjectItemCaseSensitive(schema, "properties");
+    const cJSON *required = cJSON_GetObjectItemCaseSensitive(schema, "required");
+    if (!cJSON_IsObject(properties)) properties = NULL;
+    if (!cJSON_IsArray(required)) required = NULL;
+
+    size_t count = 0;
+    for (const cJSON *property = properties ? properties->child : NULL; property; property = property->next) {
+        if (property->string) count++;
+    }
+    for (const cJSON *name = required ? required->child : NULL; name; name = name->next) {
+        if (cJSON_IsString(name) && !cJSON_GetObjectItemCaseSensitive(properties, name->valuestring)) count++;
+    }
+    if (count == 0) return;
+
+    size_t first = validator->property_count;
+    if (!grow_array((void**)&validator->properties, &validator->property_capacity, first + count,
+                    sizeof(schema_property_t))) {
+        validator->failed = true;
+        return;
+    }
+    validator->property_count += count;
+    node->first_property = (uint32_t)first;
+    node->property_count = (uint32_t)count;
+
+    size_t index = first;
+    for (const cJSON *property = properties ? properties->child : NULL; property; property = property->next) {
+        if (!property->string) continue;
+        schema_property_t *entry = &validator->properties[index++];
+        entry->hash = schema_hash(property->string);
+        entry->node = SCHEMA_ANY;
+        entry->required = false;
+        add_name(validator, property->string, &entry->name);
+    }
+    for (const cJSON *name = required ? required->child : NULL; name; name = name->next) {
+        if (!cJSON_IsString(name) || cJSON_GetObjectItemCaseSensitive(properties, name->valuestring)) continue;
+        schema_property_t *entry = &validator->properties[index++];
+        entry->hash = schema_hash(name->valuestring);
+        entry->node = SCHEMA_ANY;
+        entry->required = true;
+        add_name(validator, name->valuestring, &entry->name);
+    }
+    if (validator->failed) return;
+
+    for (const cJSON *name = required ? required->child : NULL; name; name = name->next) {
+        if (!cJSON_IsString(name)) continue;
+        for (size_t i = first; i < first + count; i++) {
+            if (strcmp(validator->names + validator->properties[i].name, name->valuestring) == 0) {
+                validator->properties[i].required = true;
+                break;
+            }
+        }
+    }
+
+    // Children append nodes and properties of their own, so entries are addressed by index
+    index = first;
+    for (const cJSON *property = properties ? properties->child : NULL; property; property = property->next) {
+        if (!property->string) continue;
+        int32_t child = compile_node(validator, property, depth + 1);
+        validator->properties[index++].node = child;
+    }
+}
+
+static int32_t compile_node(mcp_schema_validator_t *validator, const cJSON *schema, int depth) {
+    int32_t index = add_node(validator);
+    if (index < 0) return SCHEMA_ANY;
+
+    schema_node_t node = validator->nodes[index];
+    if (cJSON_IsFalse(schema)) {
+        node.flags |= SCHEMA_REJECT;
+    }
+    if (!cJSON_IsObject(schema) || depth >= MCP_SCHEMA_MAX_DEPTH) {
+        validator->nodes[index] = node;
+        return index;
+    }
+
+    const cJSON *type = cJSON_GetObjectItemCaseSensitive(schema, "type");
+    if (cJSON_IsString(type)) {
+        node.types = type_bit(type->valuestring);
+    } else if (cJSON_IsArray(type)) {
+        for (const cJSON *entry = type->child; entry; entry = entry->next) {
+            if (cJSON_IsString(entry)) node.types |= type_bit(entry->valuestring);
+        }
+    }
+
+    compile_bounds(&node, schema);
+    node.min_length = count_keyword(schema, "minLength", 0);
+    node.max_length = count_keyword(schema, "maxLength", UINT32_MAX);
+    node.min_items = count_keyword(schema, "minItems", 0);
+    node.max_items = count_keyword(schema, "maxItems", UINT32_MAX);
+
+    const cJSON *enum_values = cJSON_GetObjectItemCaseSensitive(schema, "enum");
+    if (cJSON_IsArray(enum_values)) {
+        node.enum_values = cJSON_Duplicate(enum_values, 1);
+        if (!node.enum_values) validator->failed = true;
+    }
+
+    compile_properties(validator, &node, schema, depth);
+
+    const cJSON *additional = cJSON_GetObjectItemCaseSensitive(schema, "additionalProperties");
+    if (cJSON_IsFalse(additional)) {
+        node.additional = SCHEMA_FORBIDDEN;
+    } else if (cJSON_IsObject(additional)) {
+        node.additional = compile_node(validator, additional, depth + 1);
+    }
+
+    const cJSON *items = cJSON_GetObjectItemCaseSensitive(schema, "items");
+    if (cJSON_IsObject(items) || cJSON_IsFalse(items)) {
+        node.items = compile_node(validator, items, depth + 1);
+    }
+
+    validator->nodes[index] = node;
+    return index;
+}
+
+mcp_schema_validator_t *mcp_schema_validator_compile(const cJSON *schema) {
+    mcp_schema_validator_t *validator = calloc(1, sizeof(mcp_schema_validator_t));
+    if (!validator) return NULL;
+
+    compile_node(validator, schema, 0);
+    if (validator->failed) {
+        mcp_schema_validator_destroy(validator);
+        return NULL;
+    }
+    return validator;
+}
+
+void mcp_schema_validator_destroy(mcp_schema_validator_t *validator) {
+    if (!validator) return;
+
+    for (size_t i = 0; i < validator->node_count; i++) {
+        cJSON_Delete(validator->nodes[i].enum_values);
+    }
+    free(validator->nodes);
+    free(validator->properties);
+    free(validator->names);
+    free(validator);
+}
+
+size_t mcp_schema_validator_property_count(const mcp_schema_validator_t *validator) {
+    return validator && validator->node_count > 0 ? validator->nodes[0].property_count : 0;
+}
+
+const char *mcp_schema_validator_property_name(const mcp_schema_validator_t *validator, size_t index) {
+    if (index >= mcp_schema_validator_property_count(validator)) return NULL;
+    return validator->names + validator->properties[validator->nodes[0].first_property + index].name;
+}
+
+// =============================================================================
+// Validation
+// =============================================================================
+
+static bool fail(char *error, size_t error_size, const schema_path_t *path, const char *format, ...) {
+    if (!error || error_size == 0) return false;
+
+    // Walk to the root first so segments come out in order
+    const schema_path_t *chain[MCP_SCHEMA_MAX_DEPTH + 2];
+    size_t depth = 0;
+    for (; path && path->parent && depth < sizeof(chain) / sizeof(chain[0]); path = path->parent) {
+        chain[depth++] = path;
+    }
+
+    size_t length = 0;
+    while (depth-- > 0 && length < error_size) {
+        const schema_path_t *segment = chain[depth];
+        int written = segment->key
+            ? snprintf(error + length, error_size - length, "%s%s", length ? "." : "", segment->key)
+            : snprintf(error + length, error_size - length, "[%zu]", segment->index);
+        if (written < 0) break;
+        length += (size_t)written;
+    }
+    if (length > 0 && length + 2 < error_size) {
+        memcpy(error + length, ": ", 3);
+        length += 2;
+    }
+    if (length < error_size) {
+        va_list args;
+        va_start(args, format);
+        vsnprintf(error + length, error_size - length, format, args);
+        va_end(args);
+    }
+    return false;
+}
+
+static uint8_t value_type(const cJSON *value) {
+    switch (value->type & 0xFF) {
+        case cJSON_NULL: return SCHEMA_TYPE_NULL;
+        case cJSON_False:
+        case cJSON_True: return SCHEMA_TYPE_BOOLEAN;
+        case cJSON_Number: return SCHEMA_TYPE_NUMBER;
+        case cJSON_String: return SCHEMA_TYPE_STRING;
+        case cJSON_Array: return SCHEMA_TYPE_ARRAY;
+        case cJSON_Object: return SCHEMA_TYPE_OBJECT;
+        default: return 0;
+    }
+}
+
+static bool type_matches(uint8_t types, const cJSON *value) {
+    uint8_t type = value_type(value);
+    if (types & type) return true;
+    if (type == SCHEMA_TYPE_NUMBER && (types & SCHEMA_TYPE_INTEGER)) {
+        double number = value->valuedouble;
+        return number >= SCHEMA_EXACT_INTEGER || number <= -SCHEMA_EXACT_INTEGER ||
+               number == (double)(int64_t)number;
+    }
+    return false;
+}
+
+static void format_types(char *out, size_t size, uint8_t types) {
+    static const char *names[] = { "null", "boolean", "integer", "number", "string", "array", "object" };
+    size_t length = 0;
+    out[0] = '\0';
+    for (int bit = 0; bit < 7 && length < size; bit++) {
+        if (!(types & (1u << bit))) continue;
+        int written = snprintf(out + length, size - length, "%s%s", length ? " or " : "", names[bit]);
+        if (written < 0) break;
+        length += (size_t)written;
+    }
+}
+
+static size_t utf8_length(const char *text) {
+    size_t count = 0;
+    for (; *text; text++) {
+        if (((unsigned char)*text & 0xC0) != 0x80) count++;
+    }
+    return count;
+}
+
+static bool validate_node(const mcp_schema_validator_t *validator, int32_t index, const cJSON *value,
+                          const schema_path_t *path, const cJSON **bound, char *error, size_t error_size);
+
+static bool validate_object(const mcp_schema_validator_t *validator, const schema_node_t *node,
+                            const cJSON *value, const schema_path_t *path, const cJSON **bound,
+                            char *error, size_t error_size) {
+    const schema_property_t *properties = validator->properties + node->first_property;
+    uint64_t seen_inline[SCHEMA_SEEN_INLINE] = { 0 };
+    uint64_t *seen = seen_inline;
+    size_t words = (node->property_count + 63) / 64;
+    if (words > SCHEMA_SEEN_INLINE) {
+        seen = calloc(words, sizeof(uint64_t));
+        if (!seen) return fail(error, error_size, path, "out of memory");
+    }
+
+    bool valid = true;
+    for (const cJSON *member = value->child; member && valid; member = member->next) {
+        if (!member->string) continue;
+
+        schema_path_t member_path = { path, member->string, 0 };
+        uint32_t hash = node->property_count > 0 ? schema_hash(member->string) : 0;
+        size_t i = 0;
+        for (; i < node->property_count; i++) {
+            if (properties[i].hash == hash && strcmp(validator->names + properties[i].name, member->string) == 0) {
+                break;
+            }
+        }
+
+        if (i < node->property_count) {
+            seen[i / 64] |= (uint64_t)1 << (i % 64);
+            if (bound) bound[i] = member;
+            valid = validate_node(validator, properties[i].node, member, &member_path, NULL, error, error_size);
+        } else if (node->additional == SCHEMA_FORBIDDEN) {
+            valid = fail(error, error_size, path, "unexpected property '%s'", member->string);
+        } else {
+            valid = validate_node(validator, node->additional, member, &member_path, NULL, error, error_size);
+        }
+    }
+
+    for (size_t i = 0; i < node->property_count && valid; i++) {
+        if (properties[i].required && !(seen[i / 64] & ((uint64_t)1 << (i % 64)))) {
+            valid = fail(error, error_size, path, "missing required property '%s'",
+                         validator->names + properties[i].name);
+        }
+    }
+
+    if (seen != seen_inline) free(seen);
+    return valid;
+}
+
+static bool validate_node(const mcp_schema_validator_t *validator, int32_t index, const cJSON *value,
+                          const schema_path_t *path, const cJSON **bound, char *error, size_t error_size) {
+    if (index < 0) return true;
+    const schema_node_t *node = &validator->nodes[index];
+
+    if (node->flags & SCHEMA_REJECT) {
+        return fail(error, error_size, path, "no value is allowed here");
+    }
+    if (node->types && !type_matches(node->types, value)) {
+        char expected[64];
+        format_types(expected, sizeof(expected), node->types);
+        return fail(error, error_size, path, "expected %s", expected);
+    }
+
+    if (cJSON_IsNumber(value)) {
+        double number = value->valuedouble;
+        if ((node->flags & SCHEMA_HAS_MINIMUM) && number < node->minimum) {
+            return fail(error, error_size, path, "must be >= %g", node->minimum);
+        }
+        if ((node->flags & SCHEMA_HAS_MAXIMUM) && number > node->maximum) {
+            return fail(error, error_size, path, "must be <= %g", node->maximum);
+        }
+        if ((node->flags & SCHEMA_HAS_EXCL_MINIMUM) && number <= node->exclusive_minimum) {
+            return fail(error, error_size, path, "must be > %g", node->exclusive_minimum);
+        }
+        if ((node->flags & SCHEMA_HAS_EXCL_MAXIMUM) && number >= node->exclusive_maximum) {
+            return fail(error, error_size, path, "must be < %g", node->exclusive_maximum);
+        }
+    } else if (cJSON_IsString(value)) {
+        if (node->min_length > 0 || node->max_length < UINT32_MAX) {
+            size_t length = utf8_length(value->valuestring);
+            if (length < node->min_length) {
+                return fail(error, error_size, path, "must be at least %u characters", (unsigned)node->min_length);
+            }
+            if (length > node->max_length) {
+                return fail(error, error_size, path, "must be at most %u characters", (unsigned)node->max_length);
+            }
+        }
+    } else if (cJSON_IsArray(value)) {
+        size_t count = 0;
+        for (const cJSON *item = value->child; item; item = item->next, count++) {
+            if (node->items == SCHEMA_ANY) continue;
+            schema_path_t item_path = { path, NULL, count };
+            if (!validate_node(validator, node->items, item, &item_path, NULL, error, error_size)) return false;
+        }
+        if (count < node->min_items) {
+            return fail(error, error_size, path, "needs at least %u items", (unsigned)node->min_items);
+        }
+        if (count > node->max_items) {
+            return fail(error, error_size, path, "allows at most %u items", (unsigned)node->max_items);
+        }
+    } else if (cJSON_IsObject(value)) {
+        if (node->property_count > 0 || node->additional != SCHEMA_ANY) {
+            if (!validate_object(validator, node, value, path, bound, error, error_size)) return false;
+        }
+    }
+
+    if (node->enum_values) {
+        const cJSON *option = node->enum_values->child;
+        while (option && !cJSON_Compare(value, option, 1)) option = option->next;
+        if (!option) return fail(error, error_size, path, "not one of the allowed values");
+    }
+
+    return true;
+}
+
+bool mcp_schema_validate(const mcp_schema_validator_t *validator, const cJSON *value,
+                         const cJSON **bound, char *error, size_t error_size) {
+    if (error && error_size > 0) error[0] = '\0';
+    if (bound) {
+        memset(bound, 0, mcp_schema_validator_property_count(validator) * sizeof(const cJSON*));
+    }
+    if (!validator || validator->node_count == 0) return true;
+    if (!value) return fail(error, error_size, NULL, "no value provided");
+
+    schema_path_t root = { NULL, NULL, 0 };
+    return validate_node(validator, 0, value, &root, bound, error, error_size);
+}
@@ -0,0 +1,43 @@
+#ifndef MCP_SCHEMA_VALIDATOR_H
+#define MCP_SCHEMA_VALIDATOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "cjson/cJSON.h"
+
+// JSON Schema subset compiled into a flat validator program, so a tool's arguments
+// are checked in one pass without walking or string-comparing the schema tree.
+//
+// Supported keywords: type (string or array, including "integer"), properties,
+// required, additionalProperties (boolean or schema), items (single schema),
+// minItems/maxItems, minLength/maxLength (code points), minimum/maximum,
+// exclusiveMinimum/exclusiveMaximum (number and draft-4 boolean forms) and enum.
+// Other keywords (pattern, $ref, anyOf, ...) are ignored and accept any value.
+
+#define MCP_SCHEMA_MAX_DEPTH 32     // Deeper subschemas accept any value
+#define MCP_SCHEMA_ERROR_SIZE 256
+
+typedef struct mcp_schema_validator mcp_schema_validator_t;
+
+/**
+ * Compile a schema; the validator keeps no reference to it
+ * @return Validator (NULL schema compiles to one that accepts anything), NULL on allocation failure
+ */
+mcp_schema_validator_t *mcp_schema_validator_compile(const cJSON *schema);
+void mcp_schema_validator_destroy(mcp_schema_validator_t *validator);
+
+// Properties declared at the top level, in schema order
+size_t mcp_schema_validator_property_count(const mcp_schema_validator_t *validator);
+const char *mcp_schema_validator_property_name(const mcp_schema_validator_t *validator, size_t index);
+
+/**
+ * Check value against the compiled schema
+ * @param bound NULL, or property_count entries that receive the top-level member
+ *              matching each property (NULL when absent), filled in the same pass
+ * @param error Optional buffer for a message naming the offending path
+ * @return true if value is valid
+ */
+bool mcp_schema_validate(const mcp_schema_validator_t *validator, const cJSON *value,
+                         const cJSON **bound, char *error, size_t error_size);
+
+#endif // MCP_SCHEMA_VALIDATOR_H
@@ -0,0 +1,151 @@
+#include "single_flight.h"
+#include "protocol/json_writer.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct mcp_single_flight {
+    mcp_single_flight_group_t *group;
+    mcp_single_flight_t *next;
+    uint64_t hash;
+    size_t waiters;
+    bool landed;
+    char *json;                     // Leader's encoded result, NULL when there is none
+    size_t length;
+    size_t ref_count;               // Leader's reference plus one per waiter or view
+    size_t key_length;
+    char key[];
+};
+
+// 64-bit FNV-1a
+static uint64_t flight_hash(const char *data, size_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static void flight_unref(void *arg) {
+    mcp_single_flight_t *flight = (mcp_single_flight_t*)arg;
+    if (__atomic_sub_fetch(&flight->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(flight->json);
+        free(flight);
+    }
+}
+
+int mcp_single_flight_group_init(mcp_single_flight_group_t *group) {
+    memset(group, 0, sizeof(mcp_single_flight_group_t));
+    if (pthread_mutex_init(&group->mutex, NULL) != 0) return -1;
+    if (pthread_cond_init(&group->done, NULL) != 0) {
+        pthread_mutex_destroy(&group->mutex);
+        return -1;
+    }
+    return 0;
+}
+
+void mcp_single_flight_group_destroy(mcp_single_flight_group_t *group) {
+    pthread_cond_destroy(&group->done);
+    pthread_mutex_destroy(&group->mutex);
+}
+
+mcp_single_flight_t *mcp_single_flight_join(mcp_single_flight_group_t *group, const char *key,
+                                            size_t key_length, bool *leader) {
+    *leader = true;
+    uint64_t hash = flight_hash(key, key_length);
+    mcp_single_flight_t **bucket = &group->buckets[hash % MCP_SINGLE_FLIGHT_BUCKETS];
+
+    pthread_mutex_lock(&group->mutex);
+
+    for (mcp_single_flight_t *flight = *bucket; flight; flight = flight->next) {
+        if (flight->hash == hash && flight->key_length == key_length &&
+            memcmp(flight->key, key, key_length) == 0) {
+            flight->waiters++;
+            __atomic_add_fetch(&flight->ref_count, 1, __ATOMIC_RELAXED);
+            pthread_mutex_unlock(&group->mutex);
+            *leader = false;
+            return flight;
+        }
+    }
+
+    mcp_single_flight_t *flight = malloc(sizeof(mcp_single_flight_t) + key_length);
+    if (flight) {
+        memset(flight, 0, sizeof(mcp_single_flight_t));
+        flight->group = group;
+        flight->hash = hash;
+        flight->ref_count = 1;
+        flight->key_length = key_length;
+        memcpy(flight->key, key, key_length);
+        flight->next = *bucket;
+        *bucket = flight;
+        group->led++;
+    }
+
+    pthread_mutex_unlock(&group->mutex);
+    return flight;
+}
+
+cJSON *mcp_single_flight_wait(mcp_single_flight_t *flight) {
+    mcp_single_flight_group_t *group = flight->group;
+
+    pthread_mutex_lock(&group->mutex);
+    while (!flight->landed) {
+        pthread_cond_wait(&group->done, &group->mutex);
+    }
+    pthread_mutex_unlock(&group->mutex);
+
+    // The view takes over this waiter's reference
+    cJSON *view = NULL;
+    if (flight->json) {
+        view = mcp_json_create_raw_view(flight->json, flight->length, flight_unref, flight);
+    }
+    if (!view) {
+        flight_unref(flight);
+    }
+    return view;
+}
+
+void mcp_single_flight_finish(mcp_single_flight_t *flight, const cJSON *result) {
+    if (!flight) return;
+    mcp_single_flight_group_t *group = flight->group;
+
+    // Out of the table first, so the waiter count can no longer grow
+    pthread_mutex_lock(&group->mutex);
+    mcp_single_flight_t **link = &group->buckets[flight->hash % MCP_SINGLE_FLIGHT_BUCKETS];
+    while (*link != flight) {
+        link = &(*link)->next;
+    }
+    *link = flight->next;
+    size_t waiters = flight->waiters;
+    pthread_mutex_unlock(&group->mutex);
+
+    char *json = NULL;
+    size_t length = 0;
+    if (waiters > 0 && result) {
+        mcp_json_buffer_t buffer;
+        mcp_json_buffer_init(&buffer);
+        if (mcp_json_write_compact(&buffer, result) == 0) {
+            length = buffer.length;
+            json = mcp_json_buffer_detach(&buffer);
+        } else {
+            mcp_json_buffer_free(&buffer);
+        }
+    }
+
+    pthread_mutex_lock(&group->mutex);
+    flight->json = json;
+    flight->length = length;
+    flight->landed = true;
+    if (json) group->shared += waiters;
+    pthread_cond_broadcast(&group->done);
+    pthread_mutex_unlock(&group->mutex);
+
+    flight_unref(flight);
+}
+
+uint64_t mcp_single_flight_shared(mcp_single_flight_group_t *group) {
+    pthread_mutex_lock(&group->mutex);
+    uint64_t shared = group->shared;
+    pthread_mutex_unlock(&group->mutex);
+    return shared;
+}
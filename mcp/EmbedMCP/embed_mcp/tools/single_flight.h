@@ -0,0 +1,66 @@
+#ifndef SINGLE_FLIGHT_H
+#define SINGLE_FLIGHT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "cjson/cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Single-flight coalescing of identical concurrent reads and calls. The first
+ * request for a key leads: it does the work while later requests for the same key
+ * wait for it, then all of them get a raw JSON view of the leader's encoded
+ * result. The encoded bytes are reference counted, the last view frees them.
+ * A flight lives only while its leader runs; nothing is remembered afterwards.
+ */
+#define MCP_SINGLE_FLIGHT_BUCKETS 32
+
+typedef struct mcp_single_flight mcp_single_flight_t;
+
+typedef struct {
+    mcp_single_flight_t *buckets[MCP_SINGLE_FLIGHT_BUCKETS];
+    pthread_mutex_t mutex;
+    pthread_cond_t done;            // Broadcast whenever a flight lands
+    uint64_t led;                   // Flights that ran
+    uint64_t shared;                // Requests answered with another request's result
+} mcp_single_flight_group_t;
+
+int mcp_single_flight_group_init(mcp_single_flight_group_t *group);
+void mcp_single_flight_group_destroy(mcp_single_flight_group_t *group);
+
+/**
+ * Join the flight for a key, starting it when none is in the air
+ * @param leader Set to true when the caller must do the work and call
+ *        mcp_single_flight_finish(), false when it must call mcp_single_flight_wait()
+ * @return Flight, or NULL out of memory (the caller then works on its own)
+ */
+mcp_single_flight_t *mcp_single_flight_join(mcp_single_flight_group_t *group, const char *key,
+                                            size_t key_length, bool *leader);
+
+/**
+ * Wait for the leader and take its result
+ * @return Raw JSON node over the shared bytes (free with mcp_json_delete), or NULL
+ *         when the leader had no result to share - the caller then works on its own
+ */
+cJSON *mcp_single_flight_wait(mcp_single_flight_t *flight);
+
+/**
+ * Land a flight: hand result to the waiters (it is only serialized when someone
+ * waits) and drop the leader's reference. The caller keeps ownership of result.
+ * @param result Leader's result, NULL to let the waiters work on their own
+ */
+void mcp_single_flight_finish(mcp_single_flight_t *flight, const cJSON *result);
+
+// Requests answered with another request's result so far
+uint64_t mcp_single_flight_shared(mcp_single_flight_group_t *group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINGLE_FLIGHT_H
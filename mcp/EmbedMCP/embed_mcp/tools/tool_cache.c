@@ -0,0 +1,355 @@
+#include "tool_cache.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CACHE_INITIAL_BUCKETS 16
+#define CACHE_SORT_STACK 16
+
+struct mcp_tool_cache_entry {
+    char *key;                              // Tool name, NUL, canonical arguments
+    size_t key_length;
+    uint64_t hash;
+    uint64_t expires_ms;
+    char *json;
+    size_t length;
+    size_t ref_count;                       // Cache's reference plus one per live view
+    mcp_tool_cache_entry_t *hash_next;
+    mcp_tool_cache_entry_t *lru_prev;
+    mcp_tool_cache_entry_t *lru_next;
+};
+
+// 64-bit FNV-1a
+static uint64_t cache_key_hash(const char *data, size_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t cache_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+// Canonical arguments: compact, object members sorted by name
+static int compare_members(const void *a, const void *b) {
+    const cJSON *left = *(const cJSON *const *)a;
+    const cJSON *right = *(const cJSON *const *)b;
+    return strcmp(left->string, right->string);
+}
+
+static int write_canonical(mcp_json_buffer_t *buffer, const cJSON *item) {
+    if (cJSON_IsObject(item)) {
+        size_t count = 0;
+        for (const cJSON *child = item->child; child; child = child->next) count++;
+
+        const cJSON *stack[CACHE_SORT_STACK];
+        const cJSON **members = count <= CACHE_SORT_STACK ? stack : malloc(count * sizeof(*members));
+        if (!members) return -1;
+
+        size_t i = 0;
+        for (const cJSON *child = item->child; child; child = child->next) members[i++] = child;
+        qsort(members, count, sizeof(*members), compare_members);
+
+        int result = mcp_json_write_raw(buffer, "{", 1);
+        for (i = 0; result == 0 && i < count; i++) {
+            if (i > 0) result = mcp_json_write_raw(buffer, ",", 1);
+            if (result == 0) result = mcp_json_write_string(buffer, members[i]->string);
+            if (result == 0) result = mcp_json_write_raw(buffer, ":", 1);
+            if (result == 0) result = write_canonical(buffer, members[i]);
+        }
+        if (result == 0) result = mcp_json_write_raw(buffer, "}", 1);
+
+        if (members != stack) free(members);
+        return result;
+    }
+    if (cJSON_IsArray(item)) {
+        int result = mcp_json_write_raw(buffer, "[", 1);
+        for (const cJSON *child = item->child; result == 0 && child; child = child->next) {
+            if (child != item->child) result = mcp_json_write_raw(buffer, ",", 1);
+            if (result == 0) result = write_canonical(buffer, child);
+        }
+        return result == 0 ? mcp_json_write_raw(buffer, "]", 1) : -1;
+    }
+    return mcp_json_write_compact(buffer, item);
+}
+
+int mcp_tool_cache_key_build(mcp_tool_cache_key_t *key, const char *tool_name, const cJSON *arguments) {
+    mcp_json_buffer_init(&key->text);
+    key->hash = 0;
+    key->ttl_ms = 0;
+    key->flight = NULL;
+    if (!tool_name) return -1;
+
+    int result = mcp_json_write_raw(&key->text, tool_name, strlen(tool_name) + 1);
+    if (result == 0 && arguments) result = write_canonical(&key->text, arguments);
+    if (result != 0) {
+        mcp_json_buffer_free(&key->text);
+        return -1;
+    }
+
+    key->hash = cache_key_hash(key->text.data, key->text.length);
+    return 0;
+}
+
+void mcp_tool_cache_key_free(mcp_tool_cache_key_t *key) {
+    if (!key) return;
+    mcp_single_flight_finish(key->flight, NULL);
+    key->flight = NULL;
+    mcp_json_buffer_free(&key->text);
+}
+
+static void cache_entry_unref(void *arg) {
+    mcp_tool_cache_entry_t *entry = (mcp_tool_cache_entry_t*)arg;
+    if (__atomic_sub_fetch(&entry->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(entry->json);
+        free(entry->key);
+        free(entry);
+    }
+}
+
+static cJSON *cache_entry_view(mcp_tool_cache_entry_t *entry) {
+    __atomic_add_fetch(&entry->ref_count, 1, __ATOMIC_RELAXED);
+
+    cJSON *view = mcp_json_create_raw_view(entry->json, entry->length, cache_entry_unref, entry);
+    if (!view) {
+        cache_entry_unref(entry);
+    }
+    return view;
+}
+
+static mcp_tool_cache_shard_t *cache_shard(mcp_tool_cache_t *cache, uint64_t hash) {
+    // Top bits pick the shard, low bits the bucket
+    return &cache->shards[(hash >> 56) % MCP_TOOL_CACHE_SHARDS];
+}
+
+// Internal list/table helpers - caller holds the shard's mutex
+static void lru_unlink(mcp_tool_cache_shard_t *shard, mcp_tool_cache_entry_t *entry) {
+    if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+    else shard->lru_head = entry->lru_next;
+    if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+    else shard->lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void lru_push_front(mcp_tool_cache_shard_t *shard, mcp_tool_cache_entry_t *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = shard->lru_head;
+    if (shard->lru_head) shard->lru_head->lru_prev = entry;
+    shard->lru_head = entry;
+    if (!shard->lru_tail) shard->lru_tail = entry;
+}
+
+static mcp_tool_cache_entry_t **bucket_find(mcp_tool_cache_shard_t *shard, const char *key,
+                                            size_t key_length, uint64_t hash) {
+    mcp_tool_cache_entry_t **link = &shard->buckets[hash & (shard->bucket_count - 1)];
+    while (*link && ((*link)->hash != hash || (*link)->key_length != key_length ||
+                     memcmp((*link)->key, key, key_length) != 0)) {
+        link = &(*link)->hash_next;
+    }
+    return link;
+}
+
+static void cache_remove(mcp_tool_cache_shard_t *shard, mcp_tool_cache_entry_t *entry) {
+    mcp_tool_cache_entry_t **link = bucket_find(shard, entry->key, entry->key_length, entry->hash);
+    if (*link == entry) {
+        *link = entry->hash_next;
+    }
+    lru_unlink(shard, entry);
+    shard->entries--;
+    shard->bytes -= entry->length + entry->key_length;
+    cache_entry_unref(entry);
+}
+
+static void cache_grow(mcp_tool_cache_shard_t *shard) {
+    size_t bucket_count = shard->bucket_count * 2;
+    mcp_tool_cache_entry_t **buckets = calloc(bucket_count, sizeof(*buckets));
+    if (!buckets) return;  // Keep the old table, chains just get longer
+
+    for (size_t i = 0; i < shard->bucket_count; i++) {
+        mcp_tool_cache_entry_t *entry = shard->buckets[i];
+        while (entry) {
+            mcp_tool_cache_entry_t *next = entry->hash_next;
+            size_t index = entry->hash & (bucket_count - 1);
+            entry->hash_next = buckets[index];
+            buckets[index] = entry;
+            entry = next;
+        }
+    }
+
+    free(shard->buckets);
+    shard->buckets = buckets;
+    shard->bucket_count = bucket_count;
+}
+
+// Cache lifecycle
+mcp_tool_cache_t *mcp_tool_cache_create(size_t max_bytes) {
+    if (max_bytes < MCP_TOOL_CACHE_SHARDS) return NULL;
+
+    void *memory = NULL;
+    if (posix_memalign(&memory, MCP_CACHE_LINE_SIZE, sizeof(mcp_tool_cache_t)) != 0) {
+        return NULL;
+    }
+    mcp_tool_cache_t *cache = (mcp_tool_cache_t*)memory;
+    memset(cache, 0, sizeof(mcp_tool_cache_t));
+    cache->shard_max_bytes = max_bytes / MCP_TOOL_CACHE_SHARDS;
+
+    for (size_t i = 0; i < MCP_TOOL_CACHE_SHARDS; i++) {
+        mcp_tool_cache_shard_t *shard = &cache->shards[i];
+        shard->buckets = calloc(CACHE_INITIAL_BUCKETS, sizeof(*shard->buckets));
+        if (!shard->buckets || pthread_mutex_init(&shard->mutex, NULL) != 0) {
+            free(shard->buckets);
+            shard->buckets = NULL;
+            mcp_tool_cache_destroy(cache);
+            return NULL;
+        }
+        shard->bucket_count = CACHE_INITIAL_BUCKETS;
+    }
+    return cache;
+}
+
+void mcp_tool_cache_destroy(mcp_tool_cache_t *cache) {
+    if (!cache) return;
+
+    for (size_t i = 0; i < MCP_TOOL_CACHE_SHARDS; i++) {
+        mcp_tool_cache_shard_t *shard = &cache->shards[i];
+        if (!shard->buckets) break;  // Creation stopped here
+
+        while (shard->lru_head) {
+            cache_remove(shard, shard->lru_head);
+        }
+        pthread_mutex_destroy(&shard->mutex);
+        free(shard->buckets);
+    }
+    free(cache);
+}
+
+// Lookup and store
+cJSON *mcp_tool_cache_lookup(mcp_tool_cache_t *cache, const mcp_tool_cache_key_t *key) {
+    if (!cache || !key || !key->text.data) return NULL;
+
+    mcp_tool_cache_shard_t *shard = cache_shard(cache, key->hash);
+    uint64_t now_ms = cache_now_ms();
+    cJSON *view = NULL;
+
+    pthread_mutex_lock(&shard->mutex);
+
+    mcp_tool_cache_entry_t *entry = *bucket_find(shard, key->text.data, key->text.length, key->hash);
+    if (entry && now_ms >= entry->expires_ms) {
+        cache_remove(shard, entry);
+        entry = NULL;
+    }
+
+    if (entry) {
+        lru_unlink(shard, entry);
+        lru_push_front(shard, entry);
+        view = cache_entry_view(entry);
+    }
+
+    if (view) shard->hits++;
+    else shard->misses++;
+
+    pthread_mutex_unlock(&shard->mutex);
+    return view;
+}
+
+cJSON *mcp_tool_cache_store(mcp_tool_cache_t *cache, const mcp_tool_cache_key_t *key,
+                            uint32_t ttl_ms, char *json, size_t length) {
+    if (!cache || !key || !key->text.data || !json ||
+        length + key->text.length > cache->shard_max_bytes) {
+        free(json);
+        return NULL;
+    }
+
+    mcp_tool_cache_entry_t *entry = calloc(1, sizeof(mcp_tool_cache_entry_t));
+    if (entry) entry->key = malloc(key->text.length);
+    if (!entry || !entry->key) {
+        free(entry);
+        free(json);
+        return NULL;
+    }
+
+    memcpy(entry->key, key->text.data, key->text.length);
+    entry->key_length = key->text.length;
+    entry->hash = key->hash;
+    entry->expires_ms = cache_now_ms() + ttl_ms;
+    entry->json = json;
+    entry->length = length;
+    entry->ref_count = 1;
+
+    mcp_tool_cache_shard_t *shard = cache_shard(cache, key->hash);
+    size_t size = length + entry->key_length;
+
+    pthread_mutex_lock(&shard->mutex);
+
+    // Replace a concurrent store of the same call, then make room
+    mcp_tool_cache_entry_t *existing = *bucket_find(shard, entry->key, entry->key_length, entry->hash);
+    if (existing) {
+        cache_remove(shard, existing);
+    }
+    while (shard->lru_tail && shard->bytes + size > cache->shard_max_bytes) {
+        cache_remove(shard, shard->lru_tail);
+        shard->evictions++;
+    }
+    if (shard->entries >= shard->bucket_count) {
+        cache_grow(shard);
+    }
+
+    mcp_tool_cache_entry_t **bucket = &shard->buckets[entry->hash & (shard->bucket_count - 1)];
+    entry->hash_next = *bucket;
+    *bucket = entry;
+    lru_push_front(shard, entry);
+    shard->entries++;
+    shard->bytes += size;
+
+    cJSON *view = cache_entry_view(entry);
+
+    pthread_mutex_unlock(&shard->mutex);
+    return view;
+}
+
+size_t mcp_tool_cache_invalidate_tool(mcp_tool_cache_t *cache, const char *tool_name) {
+    if (!cache || !tool_name) return 0;
+
+    // The name and its NUL prefix every key of the tool
+    size_t prefix = strlen(tool_name) + 1;
+    size_t dropped = 0;
+
+    for (size_t i = 0; i < MCP_TOOL_CACHE_SHARDS; i++) {
+        mcp_tool_cache_shard_t *shard = &cache->shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        mcp_tool_cache_entry_t *entry = shard->lru_head;
+        while (entry) {
+            mcp_tool_cache_entry_t *next = entry->lru_next;
+            if (entry->key_length >= prefix && memcmp(entry->key, tool_name, prefix) == 0) {
+                cache_remove(shard, entry);
+                dropped++;
+            }
+            entry = next;
+        }
+        pthread_mutex_unlock(&shard->mutex);
+    }
+    return dropped;
+}
+
+void mcp_tool_cache_get_stats(mcp_tool_cache_t *cache, mcp_tool_cache_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(mcp_tool_cache_stats_t));
+    if (!cache) return;
+
+    stats->max_bytes = cache->shard_max_bytes * MCP_TOOL_CACHE_SHARDS;
+    for (size_t i = 0; i < MCP_TOOL_CACHE_SHARDS; i++) {
+        mcp_tool_cache_shard_t *shard = &cache->shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->evictions += shard->evictions;
+        stats->entries += shard->entries;
+        stats->bytes += shard->bytes;
+        pthread_mutex_unlock(&shard->mutex);
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef TOOL_CACHE_H
+#define TOOL_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "cjson/cJSON.h"
+#include "protocol/json_writer.h"
+#include "single_flight.h"
+#include "utils/counter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Size-bounded LRU cache of serialized tools/call results, for tools whose result
+ * only depends on their arguments. Keys are the tool name plus a canonical form of
+ * the arguments (object members sorted), so {"a":1,"b":2} and {"b":2,"a":1} share an
+ * entry. The cache is split into shards by key hash, each with its own lock and LRU
+ * list, so concurrent calls of different tools rarely meet. Entries are reference
+ * counted like resource cache entries.
+ */
+#define MCP_TOOL_CACHE_SHARDS 8
+
+typedef struct mcp_tool_cache_entry mcp_tool_cache_entry_t;
+
+// Key of one call
+typedef struct {
+    mcp_json_buffer_t text;     // Tool name, NUL, canonical arguments
+    uint64_t hash;
+    uint32_t ttl_ms;            // Tool TTL when the key was built
+    mcp_single_flight_t *flight;  // Set while this call leads identical concurrent calls
+} mcp_tool_cache_key_t;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t entries;
+    size_t bytes;
+    size_t max_bytes;
+    uint64_t coalesced;         // Filled in by the registry: calls that shared a concurrent call
+} mcp_tool_cache_stats_t;
+
+typedef struct {
+    mcp_tool_cache_entry_t **buckets;
+    size_t bucket_count;                    // Power of two
+    mcp_tool_cache_entry_t *lru_head;       // Most recently used
+    mcp_tool_cache_entry_t *lru_tail;
+    size_t entries;
+    size_t bytes;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    pthread_mutex_t mutex;
+} MCP_CACHE_ALIGNED mcp_tool_cache_shard_t;
+
+typedef struct {
+    mcp_tool_cache_shard_t shards[MCP_TOOL_CACHE_SHARDS];
+    size_t shard_max_bytes;
+} mcp_tool_cache_t;
+
+/**
+ * Create a cache holding at most max_bytes of serialized results, split evenly
+ * between the shards
+ * @return Allocated cache, or NULL on error
+ */
+mcp_tool_cache_t *mcp_tool_cache_create(size_t max_bytes);
+void mcp_tool_cache_destroy(mcp_tool_cache_t *cache);
+
+/**
+ * Build the key of a call
+ * @return 0 on success, -1 out of memory (key is left empty)
+ */
+int mcp_tool_cache_key_build(mcp_tool_cache_key_t *key, const char *tool_name, const cJSON *arguments);
+// Free a key; a flight it still leads lands without a result
+void mcp_tool_cache_key_free(mcp_tool_cache_key_t *key);
+
+/**
+ * Look up a result
+ * @return Raw JSON node borrowing the cached bytes (free with mcp_json_delete),
+ *         or NULL on a miss or when the entry has expired
+ */
+cJSON *mcp_tool_cache_lookup(mcp_tool_cache_t *cache, const mcp_tool_cache_key_t *key);
+
+/**
+ * Store a serialized result (ownership of json is taken in all cases)
+ * @param ttl_ms Time to live in milliseconds
+ * @return Raw JSON node for the stored result, or NULL if it could not be cached
+ *         (too large, out of memory) - json has been freed then
+ */
+cJSON *mcp_tool_cache_store(mcp_tool_cache_t *cache, const mcp_tool_cache_key_t *key,
+                            uint32_t ttl_ms, char *json, size_t length);
+
+// Drop every result of a tool, returns how many were dropped
+size_t mcp_tool_cache_invalidate_tool(mcp_tool_cache_t *cache, const char *tool_name);
+void mcp_tool_cache_get_stats(mcp_tool_cache_t *cache, mcp_tool_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOOL_CACHE_H
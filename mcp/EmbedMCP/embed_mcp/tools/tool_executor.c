@@ -0,0 +1,591 @@
+#include "tools/tool_executor.h"
+#include "protocol/mcp_protocol.h"
+#include "protocol/json_writer.h"
+#include "utils/logging.h"
+#include "utils/trace.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Why a call ended
+typedef enum {
+    CALL_END_COMPLETED,
+    CALL_END_TIMED_OUT,
+    CALL_END_CANCELLED,
+    CALL_END_SHUTDOWN
+} call_end_t;
+
+struct mcp_tool_call {
+    mcp_tool_executor_t *executor;
+    mcp_tool_t *tool;                   // Pinned for the lifetime of the call
+    cJSON *id;
+    cJSON *progress_token;
+    cJSON *arguments;                   // Async tools: the call's own copy
+
+    uint64_t started_us;                // Monotonic
+    uint64_t deadline_ms;               // Monotonic, 0 = none
+    int cancelled;                      // Atomic, polled by the tool
+
+    // Guarded by the executor mutex
+    bool can_defer;
+    bool send_result;                   // The result goes out through send() even when waiting
+    bool waiting;                       // The submitting thread takes the result itself
+    bool in_send;                       // A send() for this call is running
+    bool done;
+    bool replied;                       // The outcome went out through send()
+    cJSON *result;                      // Kept for the waiting submitter
+    mcp_tool_call_t *prev;
+    mcp_tool_call_t *next;
+    mcp_tool_call_t *expired_next;      // Watchdog scratch list
+
+    int ref_count;                      // Runner (until complete) + submitter + watchdog/cancel pins
+    void *reply_ctx;                    // Points into the same allocation
+    void *context;
+    void (*release_context)(void *context);
+};
+
+struct mcp_tool_executor {
+    pthread_mutex_t mutex;
+    pthread_cond_t watchdog_cond;       // Monotonic clock
+    pthread_cond_t done_cond;           // Calls finishing, senders draining
+    pthread_t watchdog;
+    bool watchdog_running;
+    bool open;
+    uint64_t watchdog_wakeup_ms;        // Deadline the watchdog sleeps until, 0 = none
+
+    mcp_tool_call_t *calls;             // In flight, newest first
+    size_t in_flight;
+    size_t sending;                     // send() calls in progress
+
+    mcp_tool_executor_send_t send;
+    mcp_tool_executor_complete_t on_complete;
+    void *user_data;
+
+    int ref_count;                      // Owner + one per live call
+};
+
+// Call being executed on this thread (sync tools, async start functions)
+#if defined(__GNUC__)
+static __thread mcp_tool_call_t *t_current_call = NULL;
+#else
+static mcp_tool_call_t *t_current_call = NULL;
+#endif
+
+static uint64_t executor_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint64_t executor_now_ms(void) {
+    return executor_now_us() / 1000u;
+}
+
+static void executor_unref(mcp_tool_executor_t *executor) {
+    if (__atomic_sub_fetch(&executor->ref_count, 1, __ATOMIC_ACQ_REL) != 0) return;
+
+    pthread_cond_destroy(&executor->done_cond);
+    pthread_cond_destroy(&executor->watchdog_cond);
+    pthread_mutex_destroy(&executor->mutex);
+    free(executor);
+}
+
+static void call_ref(mcp_tool_call_t *call) {
+    __atomic_add_fetch(&call->ref_count, 1, __ATOMIC_RELAXED);
+}
+
+static void call_unref(mcp_tool_call_t *call) {
+    if (__atomic_sub_fetch(&call->ref_count, 1, __ATOMIC_ACQ_REL) != 0) return;
+
+    mcp_tool_executor_t *executor = call->executor;
+    mcp_json_delete(call->result);
+    cJSON_Delete(call->arguments);
+    cJSON_Delete(call->progress_token);
+    cJSON_Delete(call->id);
+    mcp_tool_unref(call->tool);
+    if (call->release_context) call->release_context(call->context);
+    free(call);
+    executor_unref(executor);
+}
+
+// Caller holds the mutex
+static void call_unlink(mcp_tool_executor_t *executor, mcp_tool_call_t *call) {
+    if (call->prev) call->prev->next = call->next;
+    else executor->calls = call->next;
+    if (call->next) call->next->prev = call->prev;
+    call->prev = call->next = NULL;
+    executor->in_flight--;
+}
+
+static void executor_send(mcp_tool_executor_t *executor, mcp_tool_call_t *call,
+                          mcp_tool_call_send_kind_t kind, const char *data, size_t length) {
+    if (executor->send(call->reply_ctx, kind, data, length, executor->user_data) < 0) {
+        mcp_log_warn("Tool call '%s': failed to deliver %s", mcp_tool_get_name(call->tool),
+                     kind == MCP_TOOL_CALL_SEND_NOTIFICATION ? "progress" : "response");
+    }
+}
+
+// Caller holds the mutex; sends of one call run one at a time
+static void call_begin_send(mcp_tool_call_t *call) {
+    mcp_tool_executor_t *executor = call->executor;
+    while (call->in_send) {
+        pthread_cond_wait(&executor->done_cond, &executor->mutex);
+    }
+    call->in_send = true;
+    executor->sending++;
+}
+
+// Caller holds the mutex; destroy() waits for senders before the transport goes away
+static void call_end_send(mcp_tool_call_t *call) {
+    mcp_tool_executor_t *executor = call->executor;
+    call->in_send = false;
+    executor->sending--;
+    pthread_cond_broadcast(&executor->done_cond);
+}
+
+// First outcome wins: completion, timeout or cancellation. Takes ownership of result.
+static void call_finish(mcp_tool_call_t *call, cJSON *result, call_end_t end) {
+    mcp_tool_executor_t *executor = call->executor;
+
+    pthread_mutex_lock(&executor->mutex);
+    if (call->done) {
+        pthread_mutex_unlock(&executor->mutex);
+        mcp_json_delete(result);
+        return;
+    }
+
+    call->done = true;
+    call_unlink(executor, call);
+
+    if (executor->on_complete && result) {
+        double elapsed = (double)(executor_now_us() - call->started_us) / 1000000.0;
+        executor->on_complete(call->tool, result, elapsed, call->context, executor->user_data);
+    }
+
+    // A sync tool that finishes in time answers through its submitter; everything
+    // else goes out through send() when the request allows it
+    bool deliver = executor->open && end != CALL_END_SHUTDOWN && call->can_defer &&
+                   !(call->waiting && end == CALL_END_COMPLETED && !call->send_result);
+    if (!deliver) {
+        call->result = result;
+        pthread_cond_broadcast(&executor->done_cond);
+        pthread_mutex_unlock(&executor->mutex);
+        return;
+    }
+
+    // A progress notification still being sent goes out before the result
+    call->replied = true;
+    call_begin_send(call);
+    pthread_cond_broadcast(&executor->done_cond);
+    pthread_mutex_unlock(&executor->mutex);
+
+    if (end == CALL_END_CANCELLED) {
+        executor_send(executor, call, MCP_TOOL_CALL_SEND_CANCELLED, NULL, 0);
+    } else {
+        mcp_json_buffer_t buffer;
+        mcp_json_buffer_init(&buffer);
+        if (jsonrpc_write_response(&buffer, call->id, result, NULL) == 0) {
+            executor_send(executor, call, MCP_TOOL_CALL_SEND_RESULT, buffer.data, buffer.length);
+        }
+        mcp_json_buffer_free(&buffer);
+    }
+    mcp_json_delete(result);
+
+    pthread_mutex_lock(&executor->mutex);
+    call_end_send(call);
+    pthread_mutex_unlock(&executor->mutex);
+}
+
+// Deadline enforcement
+static void *executor_watchdog(void *arg) {
+    mcp_tool_executor_t *executor = (mcp_tool_executor_t*)arg;
+
+    pthread_mutex_lock(&executor->mutex);
+    while (executor->open) {
+        uint64_t now = executor_now_ms();
+        uint64_t earliest = 0;
+        mcp_tool_call_t *expired = NULL;
+
+        for (mcp_tool_call_t *call = executor->calls; call; call = call->next) {
+            if (call->deadline_ms == 0) continue;
+            if (call->deadline_ms <= now) {
+                call_ref(call);
+                call->expired_next = expired;
+                expired = call;
+            } else if (earliest == 0 || call->deadline_ms < earliest) {
+                earliest = call->deadline_ms;
+            }
+        }
+
+        if (expired) {
+            pthread_mutex_unlock(&executor->mutex);
+            while (expired) {
+                mcp_tool_call_t *call = expired;
+                expired = call->expired_next;
+                mcp_log_warn("Tool '%s' exceeded its %zu ms deadline", mcp_tool_get_name(call->tool),
+                             call->tool->max_execution_time_ms);
+                __atomic_store_n(&call->cancelled, 1, __ATOMIC_RELEASE);
+                call_finish(call, mcp_tool_create_timeout_error(), CALL_END_TIMED_OUT);
+                call_unref(call);
+            }
+            pthread_mutex_lock(&executor->mutex);
+            continue;
+        }
+
+        executor->watchdog_wakeup_ms = earliest;
+        if (earliest == 0) {
+            pthread_cond_wait(&executor->watchdog_cond, &executor->mutex);
+        } else {
+            struct timespec until = {
+                .tv_sec = (time_t)(earliest / 1000u),
+                .tv_nsec = (long)(earliest % 1000u) * 1000000L
+            };
+            pthread_cond_timedwait(&executor->watchdog_cond, &executor->mutex, &until);
+        }
+    }
+    pthread_mutex_unlock(&executor->mutex);
+
+    return NULL;
+}
+
+// Executor lifecycle
+mcp_tool_executor_t *mcp_tool_executor_create(mcp_tool_executor_send_t send,
+                                              mcp_tool_executor_complete_t on_complete,
+                                              void *user_data) {
+    if (!send) return NULL;
+
+    mcp_tool_executor_t *executor = calloc(1, sizeof(mcp_tool_executor_t));
+    if (!executor) return NULL;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    if (pthread_mutex_init(&executor->mutex, NULL) != 0) {
+        pthread_condattr_destroy(&attr);
+        free(executor);
+        return NULL;
+    }
+    if (pthread_cond_init(&executor->watchdog_cond, &attr) != 0) {
+        pthread_condattr_destroy(&attr);
+        pthread_mutex_destroy(&executor->mutex);
+        free(executor);
+        return NULL;
+    }
+    pthread_condattr_destroy(&attr);
+    if (pthread_cond_init(&executor->done_cond, NULL) != 0) {
+        pthread_cond_destroy(&executor->watchdog_cond);
+        pthread_mutex_destroy(&executor->mutex);
+        free(executor);
+        return NULL;
+    }
+
+    executor->send = send;
+    executor->on_complete = on_complete;
+    executor->user_data = user_data;
+    executor->open = true;
+    executor->ref_count = 1;
+
+    if (pthread_create(&executor->watchdog, NULL, executor_watchdog, executor) != 0) {
+        executor_unref(executor);
+        return NULL;
+    }
+    executor->watchdog_running = true;
+
+    return executor;
+}
+
+void mcp_tool_executor_shutdown(mcp_tool_executor_t *executor) {
+    if (!executor) return;
+
+    pthread_mutex_lock(&executor->mutex);
+    executor->open = false;
+    pthread_cond_broadcast(&executor->watchdog_cond);
+    pthread_mutex_unlock(&executor->mutex);
+
+    if (executor->watchdog_running) {
+        pthread_join(executor->watchdog, NULL);
+        executor->watchdog_running = false;
+    }
+
+    // Nothing is sent any more; tools still running see the cancellation
+    for (;;) {
+        pthread_mutex_lock(&executor->mutex);
+        mcp_tool_call_t *call = executor->calls;
+        if (call) call_ref(call);
+        pthread_mutex_unlock(&executor->mutex);
+        if (!call) break;
+
+        __atomic_store_n(&call->cancelled, 1, __ATOMIC_RELEASE);
+        call_finish(call, NULL, CALL_END_SHUTDOWN);
+        call_unref(call);
+    }
+
+    pthread_mutex_lock(&executor->mutex);
+    while (executor->sending > 0) {
+        pthread_cond_wait(&executor->done_cond, &executor->mutex);
+    }
+    pthread_mutex_unlock(&executor->mutex);
+}
+
+void mcp_tool_executor_destroy(mcp_tool_executor_t *executor) {
+    if (!executor) return;
+
+    mcp_tool_executor_shutdown(executor);
+    executor_unref(executor);
+}
+
+// Call execution
+static mcp_tool_call_t *call_create(mcp_tool_executor_t *executor, mcp_tool_t *tool,
+                                    const mcp_tool_call_request_t *request) {
+    size_t header = (sizeof(mcp_tool_call_t) + 15) & ~(size_t)15;
+    mcp_tool_call_t *call = calloc(1, header + request->reply_ctx_size);
+    if (!call) return NULL;
+
+    call->id = request->id ? cJSON_Duplicate(request->id, 1) : NULL;
+    call->progress_token = request->progress_token ? cJSON_Duplicate(request->progress_token, 1) : NULL;
+    if ((request->id && !call->id) || (request->progress_token && !call->progress_token)) {
+        cJSON_Delete(call->id);
+        cJSON_Delete(call->progress_token);
+        free(call);
+        return NULL;
+    }
+
+    if (request->reply_ctx_size > 0) {
+        call->reply_ctx = (char*)call + header;
+        memcpy(call->reply_ctx, request->reply_ctx, request->reply_ctx_size);
+    }
+
+    call->executor = executor;
+    call->tool = mcp_tool_ref(tool);
+    call->context = request->context;
+    call->release_context = request->release_context;
+    call->can_defer = request->can_defer;
+    call->send_result = request->send_result;
+    call->waiting = !tool->execute_async || !request->can_defer;
+    call->ref_count = 2;    // Runner and submitter
+    __atomic_add_fetch(&executor->ref_count, 1, __ATOMIC_RELAXED);
+
+    return call;
+}
+
+// Returns -1 once the executor is shutting down
+static int call_register(mcp_tool_executor_t *executor, mcp_tool_call_t *call) {
+    pthread_mutex_lock(&executor->mutex);
+    if (!executor->open) {
+        pthread_mutex_unlock(&executor->mutex);
+        return -1;
+    }
+
+    call->next = executor->calls;
+    if (executor->calls) executor->calls->prev = call;
+    executor->calls = call;
+    executor->in_flight++;
+    call->started_us = executor_now_us();
+
+    // Only disturb the watchdog when this deadline comes before the one it sleeps on
+    if (call->tool->max_execution_time_ms > 0) {
+        call->deadline_ms = call->started_us / 1000u + call->tool->max_execution_time_ms;
+        if (executor->watchdog_wakeup_ms == 0 || call->deadline_ms < executor->watchdog_wakeup_ms) {
+            executor->watchdog_wakeup_ms = call->deadline_ms;
+            pthread_cond_signal(&executor->watchdog_cond);
+        }
+    }
+    pthread_mutex_unlock(&executor->mutex);
+
+    return 0;
+}
+
+int mcp_tool_executor_call(mcp_tool_executor_t *executor, mcp_tool_t *tool,
+                           const cJSON *arguments, const mcp_tool_call_request_t *request,
+                           cJSON **result) {
+    if (!executor || !tool || !request || !result) {
+        if (request && request->release_context) request->release_context(request->context);
+        return -1;
+    }
+    *result = NULL;
+
+    // Bad arguments are answered right away, before anything is started
+    if (tool->execute_async) {
+        cJSON *error = mcp_tool_check_parameters(tool, arguments);
+        if (error) {
+            if (request->release_context) request->release_context(request->context);
+            *result = error;
+            return 1;
+        }
+    }
+
+    mcp_tool_call_t *call = call_create(executor, tool, request);
+    if (!call) {
+        if (request->release_context) request->release_context(request->context);
+        return -1;
+    }
+
+    if (tool->execute_async && arguments) {
+        call->arguments = cJSON_Duplicate(arguments, 1);
+        if (!call->arguments) {
+            call_unref(call);
+            call_unref(call);
+            return -1;
+        }
+    }
+
+    if (call_register(executor, call) != 0) {
+        call_unref(call);
+        call_unref(call);
+        return -1;
+    }
+
+    mcp_tool_call_t *previous_call = t_current_call;
+    t_current_call = call;
+    uint64_t span = mcp_trace_begin();
+    if (tool->execute_async) {
+        if (tool->execute_async(call->arguments, call, tool->user_data) != 0) {
+            mcp_tool_call_complete(call, mcp_tool_create_execution_error("Tool could not be started"));
+        }
+    } else {
+        mcp_tool_call_complete(call, mcp_tool_execute(tool, arguments));
+    }
+    // Async tools: until the handler returned, not until the call completed
+    mcp_trace_end(MCP_TRACE_EXECUTE, span, tool->name);
+    t_current_call = previous_call;
+
+    if (!call->waiting) {
+        call_unref(call);
+        return 0;
+    }
+
+    pthread_mutex_lock(&executor->mutex);
+    while (!call->done) {
+        pthread_cond_wait(&executor->done_cond, &executor->mutex);
+    }
+    bool replied = call->replied;
+    *result = call->result;
+    call->result = NULL;
+    pthread_mutex_unlock(&executor->mutex);
+
+    call_unref(call);
+
+    if (replied) return 0;
+    return *result ? 1 : -1;
+}
+
+int mcp_tool_executor_cancel(mcp_tool_executor_t *executor, const cJSON *request_id) {
+    if (!executor || !request_id) return -1;
+
+    // Request ids are only unique per client; the first call in flight with the id is taken
+    pthread_mutex_lock(&executor->mutex);
+    mcp_tool_call_t *call = executor->calls;
+    while (call && !jsonrpc_id_match(call->id, request_id)) {
+        call = call->next;
+    }
+    if (call) call_ref(call);
+    pthread_mutex_unlock(&executor->mutex);
+
+    if (!call) return -1;
+
+    mcp_log_debug("Cancelling tool call '%s'", mcp_tool_get_name(call->tool));
+    __atomic_store_n(&call->cancelled, 1, __ATOMIC_RELEASE);
+    call_finish(call, NULL, CALL_END_CANCELLED);
+    call_unref(call);
+    return 0;
+}
+
+size_t mcp_tool_executor_drain(mcp_tool_executor_t *executor, uint32_t timeout_ms) {
+    if (!executor) return 0;
+
+    // done_cond runs on the realtime clock
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += timeout_ms / 1000u;
+    until.tv_nsec += (long)(timeout_ms % 1000u) * 1000000L;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&executor->mutex);
+    while (executor->in_flight > 0 &&
+           pthread_cond_timedwait(&executor->done_cond, &executor->mutex, &until) == 0) {
+    }
+    size_t in_flight = executor->in_flight;
+    pthread_mutex_unlock(&executor->mutex);
+
+    return in_flight;
+}
+
+size_t mcp_tool_executor_in_flight(mcp_tool_executor_t *executor) {
+    if (!executor) return 0;
+
+    pthread_mutex_lock(&executor->mutex);
+    size_t in_flight = executor->in_flight;
+    pthread_mutex_unlock(&executor->mutex);
+
+    return in_flight;
+}
+
+// Tool-facing call API
+mcp_tool_call_t *mcp_tool_call_current(void) {
+    return t_current_call;
+}
+
+const cJSON *mcp_tool_call_get_arguments(const mcp_tool_call_t *call) {
+    return call ? call->arguments : NULL;
+}
+
+bool mcp_tool_call_is_cancelled(const mcp_tool_call_t *call) {
+    return call && __atomic_load_n(&call->cancelled, __ATOMIC_ACQUIRE) != 0;
+}
+
+int mcp_tool_call_report_progress(mcp_tool_call_t *call, double progress, double total,
+                                  const char *message) {
+    if (!call) return -1;
+    if (!call->progress_token) return 0;   // The client did not ask for progress
+
+    mcp_tool_executor_t *executor = call->executor;
+    pthread_mutex_lock(&executor->mutex);
+    while (call->in_send && !call->done) {
+        pthread_cond_wait(&executor->done_cond, &executor->mutex);
+    }
+    if (call->done || !executor->open) {
+        pthread_mutex_unlock(&executor->mutex);
+        return -1;
+    }
+    call_begin_send(call);
+    pthread_mutex_unlock(&executor->mutex);
+
+    int result = -1;
+    cJSON *params = cJSON_CreateObject();
+    if (params) {
+        cJSON_AddItemReferenceToObject(params, "progressToken", call->progress_token);
+        cJSON_AddNumberToObject(params, "progress", progress);
+        if (total > 0) cJSON_AddNumberToObject(params, "total", total);
+        if (message) cJSON_AddStringToObject(params, "message", message);
+
+        mcp_json_buffer_t buffer;
+        mcp_json_buffer_init(&buffer);
+        if (jsonrpc_write_request(&buffer, NULL, MCP_METHOD_PROGRESS, params) == 0) {
+            result = executor->send(call->reply_ctx, MCP_TOOL_CALL_SEND_NOTIFICATION,
+                                    buffer.data, buffer.length, executor->user_data) < 0 ? -1 : 0;
+        }
+        mcp_json_buffer_free(&buffer);
+        cJSON_Delete(params);
+    }
+
+    pthread_mutex_lock(&executor->mutex);
+    call_end_send(call);
+    pthread_mutex_unlock(&executor->mutex);
+
+    return result;
+}
+
+void mcp_tool_call_complete(mcp_tool_call_t *call, cJSON *result) {
+    if (!call) return;
+
+    if (!result) {
+        result = mcp_tool_create_execution_error("Tool execution returned null result");
+    }
+    call_finish(call, result, CALL_END_COMPLETED);
+    call_unref(call);
+}
@@ -0,0 +1,83 @@
+#ifndef MCP_TOOL_EXECUTOR_H
+#define MCP_TOOL_EXECUTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "tool_interface.h"
+#include "cjson/cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Runs tools/call requests that need more than a plain function call: async tools,
+ * deadlines (max_execution_time_ms), cancellation and progress. Calls in flight are
+ * kept in a table; a watchdog thread answers calls whose deadline has passed with
+ * the timeout error, and later results for them are dropped.
+ */
+typedef struct mcp_tool_executor mcp_tool_executor_t;
+
+// What a message sent for a call is
+typedef enum {
+    MCP_TOOL_CALL_SEND_RESULT,          // Response to the tools/call request
+    MCP_TOOL_CALL_SEND_NOTIFICATION,    // notifications/progress for the request
+    MCP_TOOL_CALL_SEND_CANCELLED        // Request was cancelled, no response follows (data is NULL)
+} mcp_tool_call_send_kind_t;
+
+// Delivers a serialized message for a call; reply_ctx points at the call's copy of
+// the request's reply context. May run on any thread, but the sends of one call never
+// overlap and nothing follows its RESULT or CANCELLED message.
+typedef int (*mcp_tool_executor_send_t)(void *reply_ctx, mcp_tool_call_send_kind_t kind,
+                                        const char *data, size_t length, void *user_data);
+
+// Observes every call that produced a result (also timeouts), on the finishing thread;
+// context is the request's context
+typedef void (*mcp_tool_executor_complete_t)(const mcp_tool_t *tool, const cJSON *result,
+                                             double execution_time, void *context, void *user_data);
+
+// One tools/call request
+typedef struct {
+    const cJSON *id;                // Request id, copied
+    const cJSON *progress_token;    // params._meta.progressToken, copied (NULL: no progress)
+    bool can_defer;                 // The response may be sent later through send()
+    bool send_result;               // Deliver even a sync tool's result through send() (needs can_defer)
+    const void *reply_ctx;          // Copied into the call, handed back to send()
+    size_t reply_ctx_size;
+    void *context;                  // Handed to on_complete; owned by the call from here on
+    void (*release_context)(void *context);  // Runs when the call is freed (also on failure)
+} mcp_tool_call_request_t;
+
+// Executor lifecycle
+mcp_tool_executor_t *mcp_tool_executor_create(mcp_tool_executor_send_t send,
+                                              mcp_tool_executor_complete_t on_complete,
+                                              void *user_data);
+// Shutdown cancels everything still in flight (without replying), stops the watchdog
+// and refuses new calls; destroy also shuts down. Async tools may still complete
+// afterwards, their results are dropped.
+void mcp_tool_executor_shutdown(mcp_tool_executor_t *executor);
+void mcp_tool_executor_destroy(mcp_tool_executor_t *executor);
+
+/**
+ * Run tool for a request. Sync tools run on the calling thread.
+ * Returns 1 with *result set when the caller should send the response itself,
+ * 0 when the response is (or already was) delivered through send(), and -1 if the
+ * call failed without a result (out of memory, or cancelled while the caller waited).
+ */
+int mcp_tool_executor_call(mcp_tool_executor_t *executor, mcp_tool_t *tool,
+                           const cJSON *arguments, const mcp_tool_call_request_t *request,
+                           cJSON **result);
+
+// notifications/cancelled: returns 0 if a call with this request id was in flight
+int mcp_tool_executor_cancel(mcp_tool_executor_t *executor, const cJSON *request_id);
+
+// Wait up to timeout_ms for calls in flight to finish; returns how many are left
+size_t mcp_tool_executor_drain(mcp_tool_executor_t *executor, uint32_t timeout_ms);
+size_t mcp_tool_executor_in_flight(mcp_tool_executor_t *executor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MCP_TOOL_EXECUTOR_H
@@ -1,8 +1,24 @@
 #include "tools/tool_interface.h"
+#include "protocol/json_writer.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+// Top-level properties bound on the stack by mcp_tool_execute()
+#define TOOL_INLINE_BOUND 16
+
+// Arguments checked by the tool mcp_tool_execute() is running on this thread
+typedef struct {
+    const cJSON *parameters;
+    const cJSON **members;
+    size_t count;
+} bound_arguments_t;
+
+static __thread const bound_arguments_t *t_bound_arguments = NULL;
+
+// Absent arguments are checked as an empty object
+static const cJSON k_no_arguments = { .type = cJSON_Object };
+
 // Tool creation and destruction
 mcp_tool_t *mcp_tool_create(const char *name,
                            const char *title,
@@ -34,6 +50,7 @@ mcp_tool_t *mcp_tool_create_full(const char *name,
     
     tool->input_schema = input_schema ? cJSON_Duplicate(input_schema, 1) : NULL;
     tool->output_schema = output_schema ? cJSON_Duplicate(output_schema, 1) : NULL;
+    tool->input_validator = input_schema ? mcp_schema_validator_compile(input_schema) : NULL;
     
     tool->execute = execute_func;
     tool->validate = validate_func;
@@ -51,7 +68,8 @@ mcp_tool_t *mcp_tool_create_full(const char *name,
     
     tool->ref_count = 1;
     
-    if (!tool->name || !tool->title || !tool->description || !tool->category) {
+    if (!tool->name || !tool->title || !tool->description || !tool->category ||
+        (input_schema && (!tool->input_schema || !tool->input_validator))) {
         mcp_tool_destroy(tool);
         return NULL;
     }
@@ -59,6 +77,35 @@ mcp_tool_t *mcp_tool_create_full(const char *name,
     return tool;
 }
 
+int mcp_tool_init_static(mcp_tool_t *tool,
+                         const char *name,
+                         const char *title,
+                         const char *description,
+                         const char *input_schema_json,
+                         mcp_tool_execute_func_t execute_func,
+                         void *user_data) {
+    if (!tool || !name || !execute_func) return -1;
+    
+    memset(tool, 0, sizeof(mcp_tool_t));
+    
+    tool->name = (char*)name;
+    tool->title = (char*)(title ? title : name);
+    tool->description = (char*)(description ? description : "");
+    tool->input_schema_json = input_schema_json;
+    
+    tool->execute = execute_func;
+    tool->user_data = user_data;
+    
+    // category stays NULL (reads as general) until set, so nothing is allocated here
+    tool->max_execution_time_ms = 30000;
+    tool->max_memory_usage_bytes = 1024 * 1024;
+    
+    tool->ref_count = 1;
+    tool->is_static = true;
+    
+    return 0;
+}
+
 void mcp_tool_destroy(mcp_tool_t *tool) {
     if (!tool) return;
     
@@ -67,32 +114,37 @@ void mcp_tool_destroy(mcp_tool_t *tool) {
         tool->cleanup(tool->user_data);
     }
     
-    free(tool->name);
-    free(tool->title);
-    free(tool->description);
+    if (!tool->is_static) {
+        free(tool->name);
+        free(tool->title);
+        free(tool->description);
+    }
     free(tool->version);
     free(tool->author);
     free(tool->category);
     
     if (tool->input_schema) cJSON_Delete(tool->input_schema);
     if (tool->output_schema) cJSON_Delete(tool->output_schema);
+    mcp_schema_validator_destroy(tool->input_validator);
     
-    free(tool);
+    if (!tool->is_static) {
+        free(tool);
+    }
 }
 
 // Tool reference counting
 mcp_tool_t *mcp_tool_ref(mcp_tool_t *tool) {
     if (!tool) return NULL;
     
-    tool->ref_count++;
+    // Tools are pinned concurrently by worker threads
+    __atomic_add_fetch(&tool->ref_count, 1, __ATOMIC_RELAXED);
     return tool;
 }
 
 void mcp_tool_unref(mcp_tool_t *tool) {
     if (!tool) return;
     
-    tool->ref_count--;
-    if (tool->ref_count <= 0) {
+    if (__atomic_sub_fetch(&tool->ref_count, 1, __ATOMIC_ACQ_REL) <= 0) {
         mcp_tool_destroy(tool);
     }
 }
@@ -111,7 +163,20 @@ const char *mcp_tool_get_description(const mcp_tool_t *tool) {
 }
 
 const cJSON *mcp_tool_get_input_schema(const mcp_tool_t *tool) {
-    return tool ? tool->input_schema : NULL;
+    if (!tool) return NULL;
+    
+    cJSON *schema = __atomic_load_n(&tool->input_schema, __ATOMIC_ACQUIRE);
+    if (schema || !tool->input_schema_json) return schema;
+    
+    // Static tool: parse the schema text once; a thread losing the race drops its copy
+    cJSON *parsed = cJSON_Parse(tool->input_schema_json);
+    if (!parsed) return NULL;
+    if (!__atomic_compare_exchange_n(&((mcp_tool_t*)tool)->input_schema, &schema, parsed, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        cJSON_Delete(parsed);
+        return schema;
+    }
+    return parsed;
 }
 
 const cJSON *mcp_tool_get_output_schema(const mcp_tool_t *tool) {
@@ -153,6 +218,14 @@ int mcp_tool_set_async(mcp_tool_t *tool, bool is_async) {
     return 0;
 }
 
+int mcp_tool_set_async_handler(mcp_tool_t *tool, mcp_tool_execute_async_func_t execute_async) {
+    if (!tool) return -1;
+    
+    tool->execute_async = execute_async;
+    tool->is_async = execute_async != NULL;
+    return 0;
+}
+
 int mcp_tool_set_dangerous(mcp_tool_t *tool, bool is_dangerous) {
     if (!tool) return -1;
     
@@ -171,6 +244,25 @@ int mcp_tool_set_execution_constraints(mcp_tool_t *tool,
     return 0;
 }
 
+int mcp_tool_set_concurrency_limits(mcp_tool_t *tool,
+                                    size_t max_concurrent_calls,
+                                    size_t max_waiting_calls) {
+    if (!tool) return -1;
+    
+    // Read by calls in flight without a lock
+    __atomic_store_n(&tool->max_concurrent_calls, max_concurrent_calls, __ATOMIC_RELAXED);
+    __atomic_store_n(&tool->max_waiting_calls, max_waiting_calls, __ATOMIC_RELAXED);
+    
+    return 0;
+}
+
+int mcp_tool_set_cache_ttl(mcp_tool_t *tool, uint32_t cache_ttl_ms) {
+    if (!tool) return -1;
+    
+    __atomic_store_n(&tool->cache_ttl_ms, cache_ttl_ms, __ATOMIC_RELAXED);
+    return 0;
+}
+
 const char *mcp_tool_get_version(const mcp_tool_t *tool) {
     return tool ? tool->version : NULL;
 }
@@ -180,7 +272,8 @@ const char *mcp_tool_get_author(const mcp_tool_t *tool) {
 }
 
 const char *mcp_tool_get_category(const mcp_tool_t *tool) {
-    return tool ? tool->category : NULL;
+    if (!tool) return NULL;
+    return tool->category ? tool->category : MCP_TOOL_CATEGORY_GENERAL;
 }
 
 bool mcp_tool_is_async(const mcp_tool_t *tool) {
@@ -192,26 +285,83 @@ bool mcp_tool_is_dangerous(const mcp_tool_t *tool) {
 }
 
 // Tool execution
-cJSON *mcp_tool_execute(const mcp_tool_t *tool, const cJSON *parameters) {
-    if (!tool || !tool->execute) {
-        return mcp_tool_create_error_result(MCP_TOOL_ERROR_INTERNAL, "Tool or execute function is null", NULL);
-    }
+
+// The compiled input schema; a static tool compiles its schema text on first use.
+// The parse tree is only needed for compiling, so it is not kept.
+static const mcp_schema_validator_t *tool_input_validator(const mcp_tool_t *tool) {
+    mcp_schema_validator_t *validator = __atomic_load_n(&tool->input_validator, __ATOMIC_ACQUIRE);
+    if (validator || !tool->input_schema_json) return validator;
     
+    cJSON *schema = cJSON_Parse(tool->input_schema_json);
+    mcp_schema_validator_t *compiled = schema ? mcp_schema_validator_compile(schema) : NULL;
+    cJSON_Delete(schema);
+    if (!compiled) return NULL;
+    
+    if (!__atomic_compare_exchange_n(&((mcp_tool_t*)tool)->input_validator, &validator, compiled, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        mcp_schema_validator_destroy(compiled);
+        return validator;
+    }
+    return compiled;
+}
+
+static cJSON *check_parameters(const mcp_tool_t *tool, const mcp_schema_validator_t *validator,
+                               const cJSON *parameters, const cJSON **bound) {
     // Validate parameters if validation function is provided
     if (tool->validate && !tool->validate(parameters, tool->user_data)) {
         return mcp_tool_create_validation_error("Parameter validation failed");
     }
     
-    // Validate against input schema if provided
-    if (tool->input_schema && !mcp_tool_validate_parameter_against_schema(parameters, tool->input_schema)) {
-        char *error_msg = mcp_tool_get_validation_error_message(parameters, tool->input_schema);
-        cJSON *result = mcp_tool_create_validation_error(error_msg ? error_msg : "Schema validation failed");
-        free(error_msg);
-        return result;
+    // Schema text that does not parse must not let every call through
+    if (!validator && tool->input_schema_json) {
+        return mcp_tool_create_error_result(MCP_TOOL_ERROR_INTERNAL, "Tool input schema could not be compiled", NULL);
+    }
+    
+    // Validate against the compiled input schema, binding top-level members on the way
+    char error_msg[MCP_SCHEMA_ERROR_SIZE];
+    if (validator &&
+        !mcp_schema_validate(validator, parameters ? parameters : &k_no_arguments, bound,
+                             error_msg, sizeof(error_msg))) {
+        return mcp_tool_create_validation_error(error_msg[0] ? error_msg : "Schema validation failed");
     }
     
-    // Execute the tool
+    return NULL;
+}
+
+cJSON *mcp_tool_check_parameters(const mcp_tool_t *tool, const cJSON *parameters) {
+    return check_parameters(tool, tool_input_validator(tool), parameters, NULL);
+}
+
+const cJSON *const *mcp_tool_get_bound_arguments(const cJSON *parameters, size_t *count) {
+    const bound_arguments_t *bound = t_bound_arguments;
+    if (!bound || bound->parameters != parameters) return NULL;
+    if (count) *count = bound->count;
+    return bound->members;
+}
+
+cJSON *mcp_tool_execute(const mcp_tool_t *tool, const cJSON *parameters) {
+    if (!tool || !tool->execute) {
+        return mcp_tool_create_error_result(MCP_TOOL_ERROR_INTERNAL, "Tool or execute function is null", NULL);
+    }
+    
+    const cJSON *inline_members[TOOL_INLINE_BOUND];
+    const mcp_schema_validator_t *validator = tool_input_validator(tool);
+    size_t count = mcp_schema_validator_property_count(validator);
+    const cJSON **members = count <= TOOL_INLINE_BOUND ? inline_members : malloc(count * sizeof(const cJSON*));
+    
+    cJSON *error = check_parameters(tool, validator, parameters, members);
+    if (error) {
+        if (members != inline_members) free(members);
+        return error;
+    }
+    
+    // Execute the tool; a wrapper reads the bound members instead of searching again
+    bound_arguments_t bound = { parameters, members, count };
+    const bound_arguments_t *previous = t_bound_arguments;
+    t_bound_arguments = (members && parameters) ? &bound : NULL;
     cJSON *result = tool->execute(parameters, tool->user_data);
+    t_bound_arguments = previous;
+    if (members != inline_members) free(members);
     
     // If no result returned, create an error
     if (!result) {
@@ -230,9 +380,12 @@ bool mcp_tool_validate_parameters(const mcp_tool_t *tool, const cJSON *parameter
     }
     
     // Use schema validation if available
-    if (tool->input_schema) {
-        return mcp_tool_validate_parameter_against_schema(parameters, tool->input_schema);
+    const mcp_schema_validator_t *validator = tool_input_validator(tool);
+    if (validator) {
+        return mcp_schema_validate(validator, parameters ? parameters : &k_no_arguments,
+                                   NULL, NULL, 0);
     }
+    if (tool->input_schema_json) return false;
     
     // No validation available, assume valid
     return true;
@@ -249,8 +402,9 @@ cJSON *mcp_tool_to_json(const mcp_tool_t *tool) {
     cJSON_AddStringToObject(json, "title", tool->title);
     cJSON_AddStringToObject(json, "description", tool->description);
     
-    if (tool->input_schema) {
-        cJSON_AddItemToObject(json, "inputSchema", cJSON_Duplicate(tool->input_schema, 1));
+    const cJSON *input_schema = mcp_tool_get_input_schema(tool);
+    if (input_schema) {
+        cJSON_AddItemToObject(json, "inputSchema", cJSON_Duplicate(input_schema, 1));
     }
     
     if (tool->output_schema) {
@@ -265,12 +419,15 @@ cJSON *mcp_tool_to_json(const mcp_tool_t *tool) {
         cJSON_AddStringToObject(json, "author", tool->author);
     }
     
-    cJSON_AddStringToObject(json, "category", tool->category);
+    cJSON_AddStringToObject(json, "category", mcp_tool_get_category(tool));
     cJSON_AddBoolToObject(json, "isAsync", tool->is_async);
     cJSON_AddBoolToObject(json, "isDangerous", tool->is_dangerous);
     
     cJSON_AddNumberToObject(json, "maxExecutionTimeMs", (double)tool->max_execution_time_ms);
     cJSON_AddNumberToObject(json, "maxMemoryUsageBytes", (double)tool->max_memory_usage_bytes);
+    cJSON_AddNumberToObject(json, "maxConcurrentCalls", (double)tool->max_concurrent_calls);
+    cJSON_AddNumberToObject(json, "maxWaitingCalls", (double)tool->max_waiting_calls);
+    cJSON_AddNumberToObject(json, "cacheTtlMs", (double)tool->cache_ttl_ms);
     
     return json;
 }
@@ -289,13 +446,40 @@ cJSON *mcp_tool_to_mcp_tool_definition(const mcp_tool_t *tool) {
     
     cJSON_AddStringToObject(json, "description", tool->description);
     
-    if (tool->input_schema) {
-        cJSON_AddItemToObject(json, "inputSchema", cJSON_Duplicate(tool->input_schema, 1));
+    const cJSON *input_schema = mcp_tool_get_input_schema(tool);
+    if (input_schema) {
+        cJSON_AddItemToObject(json, "inputSchema", cJSON_Duplicate(input_schema, 1));
     }
     
     return json;
 }
 
+int mcp_tool_write_definition(mcp_json_buffer_t *buffer, const mcp_tool_t *tool) {
+    if (!buffer || !tool) return -1;
+    
+    int rc = mcp_json_write_literal(buffer, "{\"name\":");
+    rc |= mcp_json_write_string(buffer, tool->name);
+    
+    if (tool->title && strcmp(tool->title, tool->name) != 0) {
+        rc |= mcp_json_write_literal(buffer, ",\"title\":");
+        rc |= mcp_json_write_string(buffer, tool->title);
+    }
+    
+    rc |= mcp_json_write_literal(buffer, ",\"description\":");
+    rc |= mcp_json_write_string(buffer, tool->description);
+    
+    if (tool->input_schema_json) {
+        rc |= mcp_json_write_literal(buffer, ",\"inputSchema\":");
+        rc |= mcp_json_write_literal(buffer, tool->input_schema_json);
+    } else if (tool->input_schema) {
+        rc |= mcp_json_write_literal(buffer, ",\"inputSchema\":");
+        rc |= mcp_json_write_compact(buffer, tool->input_schema);
+    }
+    
+    rc |= mcp_json_write_literal(buffer, "}");
+    return rc ? -1 : 0;
+}
+
 // Tool validation
 bool mcp_tool_validate(const mcp_tool_t *tool) {
     if (!tool) return false;
@@ -467,35 +651,24 @@ bool mcp_tool_validate_parameter_against_schema(const cJSON *value, const cJSON
     if (!schema) return true; // No schema means no validation
     if (!value) return false;
 
-    // Get the type from schema
-    cJSON *type = cJSON_GetObjectItem(schema, "type");
-    if (type && cJSON_IsString(type)) {
-        if (!mcp_tool_validate_parameter_type(value, type->valuestring)) {
-            return false;
-        }
-    }
-
-    // Additional validations can be added here (minimum, maximum, pattern, etc.)
-
-    return true;
+    mcp_schema_validator_t *validator = mcp_schema_validator_compile(schema);
+    if (!validator) return false;
+    bool valid = mcp_schema_validate(validator, value, NULL, NULL, 0);
+    mcp_schema_validator_destroy(validator);
+    return valid;
 }
 
 char *mcp_tool_get_validation_error_message(const cJSON *value, const cJSON *schema) {
     if (!schema) return strdup("No schema provided");
     if (!value) return strdup("No value provided");
 
-    cJSON *type = cJSON_GetObjectItem(schema, "type");
-    if (type && cJSON_IsString(type)) {
-        if (!mcp_tool_validate_parameter_type(value, type->valuestring)) {
-            char *msg = malloc(256);
-            if (msg) {
-                snprintf(msg, 256, "Expected type '%s' but got different type", type->valuestring);
-            }
-            return msg;
-        }
-    }
+    char message[MCP_SCHEMA_ERROR_SIZE];
+    mcp_schema_validator_t *validator = mcp_schema_validator_compile(schema);
+    if (!validator) return strdup("Validation failed");
+    bool valid = mcp_schema_validate(validator, value, NULL, message, sizeof(message));
+    mcp_schema_validator_destroy(validator);
 
-    return strdup("Validation failed");
+    return strdup(!valid && message[0] ? message : "Validation failed");
 }
 
 // Error result creation
@@ -552,13 +725,21 @@ cJSON *mcp_tool_create_memory_error(void) {
 
 // Success result creation
 cJSON *mcp_tool_create_success_result(cJSON *data) {
+    return mcp_tool_create_success_result_take(data ? cJSON_Duplicate(data, 1) : NULL);
+}
+
+cJSON *mcp_tool_create_success_result_take(cJSON *data) {
     cJSON *result = cJSON_CreateObject();
-    if (!result) return NULL;
+    if (!result) {
+        cJSON_Delete(data);
+        return NULL;
+    }
 
     // Create content array according to MCP spec
     cJSON *content = cJSON_CreateArray();
     if (!content) {
         cJSON_Delete(result);
+        cJSON_Delete(data);
         return NULL;
     }
 
@@ -567,10 +748,14 @@ cJSON *mcp_tool_create_success_result(cJSON *data) {
     cJSON_AddStringToObject(text_block, "type", "text");
 
     if (data) {
-        // Convert data to string representation
-        char *data_str = cJSON_Print(data);
-        cJSON_AddStringToObject(text_block, "text", data_str ? data_str : "{}");
-        if (data_str) free(data_str);
+        // The text is data's compact form, produced while the response is written
+        // rather than kept as a second copy next to structuredContent
+        cJSON *text = mcp_json_create_json_text_view(data);
+        if (text) {
+            cJSON_AddItemToObject(text_block, "text", text);
+        } else {
+            cJSON_AddStringToObject(text_block, "text", "{}");
+        }
     } else {
         cJSON_AddStringToObject(text_block, "text", "Success");
     }
@@ -578,9 +763,9 @@ cJSON *mcp_tool_create_success_result(cJSON *data) {
     cJSON_AddItemToArray(content, text_block);
     cJSON_AddItemToObject(result, "content", content);
 
-    // Add structured content if data provided
+    // Structured content takes ownership of data
     if (data) {
-        cJSON_AddItemToObject(result, "structuredContent", cJSON_Duplicate(data, 1));
+        cJSON_AddItemToObject(result, "structuredContent", data);
     }
 
     cJSON_AddBoolToObject(result, "isError", false);
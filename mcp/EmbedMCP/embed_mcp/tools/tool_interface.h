@@ -3,14 +3,24 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "cjson/cJSON.h"
+#include "protocol/json_writer.h"
+#include "tools/schema_validator.h"
 
 // Forward declarations
 typedef struct mcp_tool mcp_tool_t;
+typedef struct mcp_tool_call mcp_tool_call_t;
 
 // Tool execution function type
 typedef cJSON *(*mcp_tool_execute_func_t)(const cJSON *parameters, void *user_data);
 
+// Asynchronous execution: start the work and return 0 (-1 if it could not be
+// started). The call is finished later, from any thread, with mcp_tool_call_complete().
+// parameters stays valid until then (it is the call's own copy).
+typedef int (*mcp_tool_execute_async_func_t)(const cJSON *parameters, mcp_tool_call_t *call,
+                                             void *user_data);
+
 // Tool validation function type
 typedef bool (*mcp_tool_validate_func_t)(const cJSON *parameters, void *user_data);
 
@@ -27,9 +37,12 @@ struct mcp_tool {
     // Schema definition
     cJSON *input_schema;
     cJSON *output_schema;
+    mcp_schema_validator_t *input_validator;   // Compiled from input_schema at creation
+    const char *input_schema_json;  // Static tools: pre-serialized schema, parsed on demand
     
     // Function pointers
     mcp_tool_execute_func_t execute;
+    mcp_tool_execute_async_func_t execute_async;  // Optional, used instead of execute when set
     mcp_tool_validate_func_t validate;  // Optional
     mcp_tool_cleanup_func_t cleanup;    // Optional
     
@@ -43,12 +56,22 @@ struct mcp_tool {
     bool is_async;
     bool is_dangerous;
     
-    // Execution constraints
+    // Execution constraints (0 = no deadline)
     size_t max_execution_time_ms;
     size_t max_memory_usage_bytes;
+
+    // Bulkhead enforced by the registry (0 = no limit): calls running at once, and calls
+    // that may block a worker waiting for one of them; beyond that calls are refused
+    size_t max_concurrent_calls;
+    size_t max_waiting_calls;
+
+    // Results are a function of the arguments alone and may be served from the
+    // registry's result cache for this long (0 = not cacheable)
+    uint32_t cache_ttl_ms;
     
     // Internal reference counting
     int ref_count;
+    bool is_static;     // Strings and schema text borrowed, storage owned by the caller
 };
 
 // Tool creation and destruction
@@ -71,6 +94,22 @@ mcp_tool_t *mcp_tool_create_full(const char *name,
 
 void mcp_tool_destroy(mcp_tool_t *tool);
 
+/**
+ * Set up a tool in caller-provided storage without allocating
+ * name, title, description and input_schema_json are borrowed and must outlive the
+ * tool (string literals, typically). The schema is parsed and compiled on the first
+ * call; until then tools/list emits the text as is. When the last reference goes,
+ * the tool's own allocations are released but its storage is left to the caller.
+ * @return 0 on success, -1 on invalid arguments
+ */
+int mcp_tool_init_static(mcp_tool_t *tool,
+                         const char *name,
+                         const char *title,
+                         const char *description,
+                         const char *input_schema_json,
+                         mcp_tool_execute_func_t execute_func,
+                         void *user_data);
+
 // Tool reference counting
 mcp_tool_t *mcp_tool_ref(mcp_tool_t *tool);
 void mcp_tool_unref(mcp_tool_t *tool);
@@ -87,10 +126,15 @@ int mcp_tool_set_version(mcp_tool_t *tool, const char *version);
 int mcp_tool_set_author(mcp_tool_t *tool, const char *author);
 int mcp_tool_set_category(mcp_tool_t *tool, const char *category);
 int mcp_tool_set_async(mcp_tool_t *tool, bool is_async);
+int mcp_tool_set_async_handler(mcp_tool_t *tool, mcp_tool_execute_async_func_t execute_async);
 int mcp_tool_set_dangerous(mcp_tool_t *tool, bool is_dangerous);
 int mcp_tool_set_execution_constraints(mcp_tool_t *tool,
                                       size_t max_execution_time_ms,
                                       size_t max_memory_usage_bytes);
+int mcp_tool_set_concurrency_limits(mcp_tool_t *tool,
+                                    size_t max_concurrent_calls,
+                                    size_t max_waiting_calls);
+int mcp_tool_set_cache_ttl(mcp_tool_t *tool, uint32_t cache_ttl_ms);
 
 const char *mcp_tool_get_version(const mcp_tool_t *tool);
 const char *mcp_tool_get_author(const mcp_tool_t *tool);
@@ -101,10 +145,31 @@ bool mcp_tool_is_dangerous(const mcp_tool_t *tool);
 // Tool execution
 cJSON *mcp_tool_execute(const mcp_tool_t *tool, const cJSON *parameters);
 bool mcp_tool_validate_parameters(const mcp_tool_t *tool, const cJSON *parameters);
+// Runs the validate function and schema check; NULL if parameters pass, else an error result
+cJSON *mcp_tool_check_parameters(const mcp_tool_t *tool, const cJSON *parameters);
+// While mcp_tool_execute() runs a tool on this thread: the argument members the schema
+// check matched to each top-level property (in schema order), if parameters are the
+// arguments it checked. NULL otherwise.
+const cJSON *const *mcp_tool_get_bound_arguments(const cJSON *parameters, size_t *count);
+
+// In-flight call, handed to async tools (see tools/tool_executor.h). Sync tools run
+// by the executor can reach theirs through mcp_tool_call_current().
+mcp_tool_call_t *mcp_tool_call_current(void);
+const cJSON *mcp_tool_call_get_arguments(const mcp_tool_call_t *call);
+// True once the client cancelled the request or its deadline passed - stop early
+bool mcp_tool_call_is_cancelled(const mcp_tool_call_t *call);
+// Sends notifications/progress if the client asked for it (total <= 0: unknown, message optional)
+int mcp_tool_call_report_progress(mcp_tool_call_t *call, double progress, double total,
+                                  const char *message);
+// Finish the call with a tool result (ownership is taken, NULL reports an execution
+// error). Must be called exactly once; the call must not be used afterwards.
+void mcp_tool_call_complete(mcp_tool_call_t *call, cJSON *result);
 
 // Tool serialization
 cJSON *mcp_tool_to_json(const mcp_tool_t *tool);
 cJSON *mcp_tool_to_mcp_tool_definition(const mcp_tool_t *tool);
+// Same definition written straight into a buffer; a static tool's schema text is copied verbatim
+int mcp_tool_write_definition(mcp_json_buffer_t *buffer, const mcp_tool_t *tool);
 
 // Tool validation
 bool mcp_tool_validate(const mcp_tool_t *tool);
@@ -122,6 +187,7 @@ cJSON *mcp_tool_create_boolean_schema(const char *description);
 
 // Parameter validation utilities
 bool mcp_tool_validate_parameter_type(const cJSON *value, const char *expected_type);
+// Compile the schema for a single check; tools use the validator compiled at creation
 bool mcp_tool_validate_parameter_against_schema(const cJSON *value, const cJSON *schema);
 char *mcp_tool_get_validation_error_message(const cJSON *value, const cJSON *schema);
 
@@ -134,6 +200,8 @@ cJSON *mcp_tool_create_memory_error(void);
 
 // Success result creation
 cJSON *mcp_tool_create_success_result(cJSON *data);
+// Same, but takes ownership of data instead of copying it
+cJSON *mcp_tool_create_success_result_take(cJSON *data);
 
 
 // Tool categories (predefined constants)
@@ -153,6 +221,7 @@ cJSON *mcp_tool_create_success_result(cJSON *data);
 #define MCP_TOOL_ERROR_MEMORY "memory_error"
 #define MCP_TOOL_ERROR_PERMISSION "permission_error"
 #define MCP_TOOL_ERROR_NOT_FOUND "not_found_error"
+#define MCP_TOOL_ERROR_BUSY "busy_error"
 #define MCP_TOOL_ERROR_INTERNAL "internal_error"
 
 #endif // MCP_TOOL_INTERFACE_H
@@ -1,10 +1,242 @@
 #include "tools/tool_registry.h"
 #include "tools/builtin_tools.h"
+#include "protocol/json_writer.h"
 #include "hal/platform_hal.h"
+#include "utils/epoch.h"
 #include "utils/logging.h"
+#include "utils/trace.h"
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <errno.h>
+#include <stdint.h>
+
+#define TOOL_INDEX_MIN_CAPACITY 16
+
+// Serialized tools/list array; each response holds a reference through a raw view
+struct mcp_tool_list_cache {
+    char *json;
+    size_t length;
+    size_t ref_count;               // Snapshot's reference plus one per live view
+};
+
+// The registered tools at one version. Never changed once published, except that
+// the first tools/list fills in its serialization.
+struct mcp_tool_snapshot {
+    uint64_t version;                   // Bumped on every register/unregister
+    size_t count;
+    mcp_tool_entry_t **tools;           // Registration order, used for tools/list
+    mcp_tool_entry_t **index;           // Open addressing by name, at most 3/4 full
+    size_t index_capacity;              // Power of two
+    mcp_tool_list_cache_t *list_cache;  // Atomic, NULL until the first tools/list
+};
+
+// Entries registered together by mcp_tool_registry_register_tools()
+struct mcp_tool_entry_block {
+    struct mcp_tool_entry_block *next;
+    mcp_tool_entry_t entries[];
+};
+
+// Monotonic wall clock from the HAL; CPU time (clock()) misses tools that block
+static uint64_t registry_now_us(void) {
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    if (hal && hal->time.get_time_us) {
+        return hal->time.get_time_us();
+    }
+    return (uint64_t)time(NULL) * 1000000u;
+}
+
+// FNV-1a hash of a tool name
+static uint32_t tool_name_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void tool_entry_ref(mcp_tool_entry_t *entry) {
+    __atomic_add_fetch(&entry->ref_count, 1, __ATOMIC_RELAXED);
+}
+
+static void tool_entry_unref(mcp_tool_entry_t *entry) {
+    if (__atomic_sub_fetch(&entry->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
+        mcp_tool_unref(entry->tool);
+        free(entry->stats);
+        entry->stats = NULL;
+        if (!entry->in_block) {
+            free(entry);
+        }
+    }
+}
+
+// Statistics shards, allocated on the first recorded call so tools that are never
+// called cost no stats memory. NULL if the allocation fails.
+static mcp_tool_stats_shard_t *tool_entry_stats_shards(mcp_tool_entry_t *entry) {
+    mcp_tool_stats_shard_t *stats = __atomic_load_n(&entry->stats, __ATOMIC_ACQUIRE);
+    if (stats) return stats;
+    
+    void *shards = NULL;
+    if (posix_memalign(&shards, MCP_CACHE_LINE_SIZE,
+                       MCP_COUNTER_SHARDS * sizeof(mcp_tool_stats_shard_t)) != 0) {
+        return NULL;
+    }
+    memset(shards, 0, MCP_COUNTER_SHARDS * sizeof(mcp_tool_stats_shard_t));
+    
+    if (!__atomic_compare_exchange_n(&entry->stats, &stats, (mcp_tool_stats_shard_t*)shards, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        free(shards);
+        return stats;
+    }
+    return shards;
+}
+
+static void tool_list_cache_unref(void *arg) {
+    mcp_tool_list_cache_t *cache = (mcp_tool_list_cache_t*)arg;
+    if (cache && __atomic_sub_fetch(&cache->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(cache->json);
+        free(cache);
+    }
+}
+
+static void tool_stats_shard_reset(mcp_tool_stats_shard_t *shard) {
+    __atomic_store_n(&shard->calls_made, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->calls_successful, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->calls_failed, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->total_execution_us, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->last_called, 0, __ATOMIC_RELAXED);
+    for (size_t i = 0; i < MCP_HISTOGRAM_BUCKETS; i++) {
+        __atomic_store_n(&shard->latency.buckets[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&shard->latency.count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->latency.sum_us, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->latency.max_us, 0, __ATOMIC_RELAXED);
+}
+
+// Sum the shards; name is left to the caller
+static void tool_entry_aggregate(const mcp_tool_entry_t *entry, mcp_tool_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->is_builtin = entry->is_builtin;
+    stats->max_concurrent_calls = __atomic_load_n(&entry->tool->max_concurrent_calls, __ATOMIC_RELAXED);
+    stats->max_waiting_calls = __atomic_load_n(&entry->tool->max_waiting_calls, __ATOMIC_RELAXED);
+    stats->calls_active = __atomic_load_n(&entry->calls_active, __ATOMIC_RELAXED);
+    stats->calls_waiting = __atomic_load_n(&entry->calls_waiting, __ATOMIC_RELAXED);
+    stats->calls_rejected = __atomic_load_n(&entry->calls_rejected, __ATOMIC_RELAXED);
+    stats->cache_ttl_ms = __atomic_load_n(&entry->tool->cache_ttl_ms, __ATOMIC_RELAXED);
+    stats->cache_hits = __atomic_load_n(&entry->cache_hits, __ATOMIC_RELAXED);
+    stats->cache_misses = __atomic_load_n(&entry->cache_misses, __ATOMIC_RELAXED);
+
+    const mcp_tool_stats_shard_t *shards = __atomic_load_n(&entry->stats, __ATOMIC_ACQUIRE);
+    if (!shards) return;
+
+    uint64_t total_us = 0;
+    for (unsigned i = 0; i < MCP_COUNTER_SHARDS; i++) {
+        const mcp_tool_stats_shard_t *shard = &shards[i];
+        stats->calls_made += __atomic_load_n(&shard->calls_made, __ATOMIC_RELAXED);
+        stats->calls_successful += __atomic_load_n(&shard->calls_successful, __ATOMIC_RELAXED);
+        stats->calls_failed += __atomic_load_n(&shard->calls_failed, __ATOMIC_RELAXED);
+        total_us += __atomic_load_n(&shard->total_execution_us, __ATOMIC_RELAXED);
+
+        time_t last = __atomic_load_n(&shard->last_called, __ATOMIC_RELAXED);
+        if (last > stats->last_called) stats->last_called = last;
+
+        mcp_histogram_merge(&stats->latency, &shard->latency);
+    }
+    stats->total_execution_time = (double)total_us / 1000000.0;
+}
+
+// Slot holding tool_name, or the first empty slot of its probe chain
+static mcp_tool_entry_t **tool_index_probe(mcp_tool_entry_t **index, size_t capacity, const char *tool_name,
+                                           uint32_t hash) {
+    size_t mask = capacity - 1;
+    size_t i = hash & mask;
+    while (index[i]) {
+        if (index[i]->name_hash == hash && strcmp(mcp_tool_get_name(index[i]->tool), tool_name) == 0) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return &index[i];
+}
+
+// Dropped once no reader can see the snapshot any more
+static void tool_snapshot_free(void *arg) {
+    mcp_tool_snapshot_t *snapshot = (mcp_tool_snapshot_t*)arg;
+    if (!snapshot) return;
+
+    for (size_t i = 0; i < snapshot->count; i++) {
+        tool_entry_unref(snapshot->tools[i]);
+    }
+    tool_list_cache_unref(snapshot->list_cache);
+    free(snapshot);
+}
+
+/**
+ * Build the snapshot that follows base (NULL: the empty first one): its tools minus
+ * removed, then added_count entries from added, in registration order. The index is
+ * built from scratch, so it never holds tombstones. Returns NULL out of memory, or
+ * with *clash set to the name if two tools share it.
+ */
+static mcp_tool_snapshot_t *tool_snapshot_create(const mcp_tool_snapshot_t *base, const mcp_tool_entry_t *removed,
+                                                 mcp_tool_entry_t *added, size_t added_count,
+                                                 const char **clash) {
+    size_t count = (base ? base->count : 0) - (removed ? 1 : 0) + added_count;
+    size_t capacity = TOOL_INDEX_MIN_CAPACITY;
+    while (count * 4 > capacity * 3) {
+        capacity *= 2;
+    }
+
+    mcp_tool_snapshot_t *snapshot = calloc(1, sizeof(mcp_tool_snapshot_t) +
+                                              (count + capacity) * sizeof(mcp_tool_entry_t*));
+    if (!snapshot) return NULL;
+
+    snapshot->version = base ? base->version + 1 : 0;
+    snapshot->tools = (mcp_tool_entry_t**)(snapshot + 1);
+    snapshot->index = snapshot->tools + count;
+    snapshot->index_capacity = capacity;
+
+    size_t n = 0;
+    for (size_t i = 0; base && i < base->count; i++) {
+        if (base->tools[i] != removed) {
+            snapshot->tools[n++] = base->tools[i];
+        }
+    }
+    for (size_t i = 0; i < added_count; i++) {
+        snapshot->tools[n++] = &added[i];
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        mcp_tool_entry_t *entry = snapshot->tools[i];
+        const char *tool_name = mcp_tool_get_name(entry->tool);
+        mcp_tool_entry_t **slot = tool_index_probe(snapshot->index, capacity, tool_name, entry->name_hash);
+        if (*slot) {
+            if (clash) *clash = tool_name;
+            free(snapshot);
+            return NULL;
+        }
+        *slot = entry;
+    }
+
+    // Each snapshot holds its entries until it is freed
+    for (size_t i = 0; i < n; i++) {
+        tool_entry_ref(snapshot->tools[i]);
+    }
+    snapshot->count = n;
+    return snapshot;
+}
+
+// Current snapshot; the caller must be inside an epoch and not use it after leaving
+static mcp_tool_snapshot_t *tool_snapshot_current(const mcp_tool_registry_t *registry) {
+    return __atomic_load_n(&registry->snapshot, __ATOMIC_ACQUIRE);
+}
+
+// Replace the snapshot; caller must hold registry_mutex. Readers still on the old
+// one keep it until they leave their epoch.
+static void tool_snapshot_publish(mcp_tool_registry_t *registry, mcp_tool_snapshot_t *next) {
+    mcp_tool_snapshot_t *previous = __atomic_exchange_n(&registry->snapshot, next, __ATOMIC_SEQ_CST);
+    mcp_epoch_retire(previous, tool_snapshot_free);
+}
 
 // Tool registry lifecycle
 mcp_tool_registry_t *mcp_tool_registry_create(const mcp_tool_registry_config_t *config) {
@@ -26,28 +258,33 @@ mcp_tool_registry_t *mcp_tool_registry_create(const mcp_tool_registry_config_t *
         registry->config.tool_timeout = 30; // 30 seconds
     }
     
-    // Initialize thread safety
-    if (pthread_rwlock_init(&registry->tools_lock, NULL) != 0) {
-        free(registry);
+    // Initialize tool storage
+    registry->snapshot = tool_snapshot_create(NULL, NULL, NULL, 0, NULL);
+    if (!registry->snapshot) {
+        hal->memory.free(registry);
         return NULL;
     }
     
+    // Initialize thread safety
     if (pthread_mutex_init(&registry->registry_mutex, NULL) != 0) {
-        pthread_rwlock_destroy(&registry->tools_lock);
-        free(registry);
+        tool_snapshot_free(registry->snapshot);
+        hal->memory.free(registry);
         return NULL;
     }
     
-    // Initialize tool storage
-    registry->tools = NULL;
-    registry->tool_count = 0;
+    if (mcp_single_flight_group_init(&registry->calls) != 0) {
+        pthread_mutex_destroy(&registry->registry_mutex);
+        tool_snapshot_free(registry->snapshot);
+        hal->memory.free(registry);
+        return NULL;
+    }
     
     // Initialize statistics
     registry->total_tools_registered = 0;
     registry->tools_unregistered = 0;
-    registry->total_calls_made = 0;
-    registry->total_calls_successful = 0;
-    registry->total_calls_failed = 0;
+    mcp_counter_reset(&registry->total_calls_made);
+    mcp_counter_reset(&registry->total_calls_successful);
+    mcp_counter_reset(&registry->total_calls_failed);
     
     mcp_log_info("Tool registry created with max_tools=%zu", registry->config.max_tools);
     
@@ -60,22 +297,25 @@ void mcp_tool_registry_destroy(mcp_tool_registry_t *registry) {
     const mcp_platform_hal_t *hal = mcp_platform_get_hal();
 
     // Unregister all tools
-    pthread_rwlock_wrlock(&registry->tools_lock);
-
-    mcp_tool_entry_t *current = registry->tools;
-    while (current) {
-        mcp_tool_entry_t *next = current->next;
-        mcp_tool_unref(current->tool);
-        if (hal) {
-            hal->memory.free(current);
-        }
-        current = next;
+    pthread_mutex_lock(&registry->registry_mutex);
+    mcp_tool_snapshot_t *snapshot = __atomic_exchange_n(&registry->snapshot, NULL, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&registry->registry_mutex);
+
+    // Replaced snapshots still waiting to be freed may hold entries of the blocks
+    mcp_epoch_barrier();
+    tool_snapshot_free(snapshot);
+
+    while (registry->entry_blocks) {
+        mcp_tool_entry_block_t *next = registry->entry_blocks->next;
+        free(registry->entry_blocks);
+        registry->entry_blocks = next;
     }
 
-    pthread_rwlock_unlock(&registry->tools_lock);
+    mcp_tool_cache_destroy(registry->result_cache);
+    registry->result_cache = NULL;
+    mcp_single_flight_group_destroy(&registry->calls);
 
     // Cleanup thread safety
-    pthread_rwlock_destroy(&registry->tools_lock);
     pthread_mutex_destroy(&registry->registry_mutex);
 
     if (hal) {
@@ -117,19 +357,23 @@ int mcp_tool_registry_register_tool(mcp_tool_registry_t *registry, mcp_tool_t *t
     }
     
     const char *tool_name = mcp_tool_get_name(tool);
+    uint32_t hash = tool_name_hash(tool_name);
+    
+    pthread_mutex_lock(&registry->registry_mutex);
     
-    pthread_rwlock_wrlock(&registry->tools_lock);
+    // Writers are serialized, so the snapshot cannot change under us
+    mcp_tool_snapshot_t *current = registry->snapshot;
     
     // Check if tool already exists
-    if (mcp_tool_registry_find_tool_entry(registry, tool_name)) {
-        pthread_rwlock_unlock(&registry->tools_lock);
+    if (*tool_index_probe(current->index, current->index_capacity, tool_name, hash)) {
+        pthread_mutex_unlock(&registry->registry_mutex);
         mcp_log_error("Tool '%s' already registered", tool_name);
         return -1;
     }
     
     // Check maximum tools limit
-    if (registry->tool_count >= registry->config.max_tools) {
-        pthread_rwlock_unlock(&registry->tools_lock);
+    if (current->count >= registry->config.max_tools) {
+        pthread_mutex_unlock(&registry->registry_mutex);
         mcp_log_error("Maximum tools limit reached (%zu)", registry->config.max_tools);
         return -1;
     }
@@ -137,81 +381,137 @@ int mcp_tool_registry_register_tool(mcp_tool_registry_t *registry, mcp_tool_t *t
     // Create tool entry
     mcp_tool_entry_t *entry = calloc(1, sizeof(mcp_tool_entry_t));
     if (!entry) {
-        pthread_rwlock_unlock(&registry->tools_lock);
+        pthread_mutex_unlock(&registry->registry_mutex);
         return -1;
     }
     
-    entry->tool = mcp_tool_ref(tool);
+    entry->tool = tool;
     entry->registered_time = time(NULL);
     entry->is_builtin = false; // Will be set by built-in tool registration
-    entry->calls_made = 0;
-    entry->calls_successful = 0;
-    entry->calls_failed = 0;
-    entry->last_called = 0;
-    entry->total_execution_time = 0.0;
-    entry->average_execution_time = 0.0;
-    entry->next = registry->tools;
+    entry->stats = NULL;
+    entry->name_hash = hash;
+    entry->ref_count = 0;      // The snapshot takes the first reference
     
-    registry->tools = entry;
-    registry->tool_count++;
-    registry->total_tools_registered++;
+    // Appended to keep tools/list in registration order
+    mcp_tool_snapshot_t *next = tool_snapshot_create(current, NULL, entry, 1, NULL);
+    if (!next) {
+        pthread_mutex_unlock(&registry->registry_mutex);
+        free(entry);
+        return -1;
+    }
+    mcp_tool_ref(tool);
+    
+    __atomic_add_fetch(&registry->total_tools_registered, 1, __ATOMIC_RELAXED);
+    tool_snapshot_publish(registry, next);
     
-    pthread_rwlock_unlock(&registry->tools_lock);
+    pthread_mutex_unlock(&registry->registry_mutex);
     
     mcp_log_debug("Tool '%s' registered successfully", tool_name);
     
     return 0;
 }
 
+int mcp_tool_registry_register_tools(mcp_tool_registry_t *registry, mcp_tool_t *tools, size_t count) {
+    if (!registry || (!tools && count > 0)) return -1;
+    if (count == 0) return 0;
+    
+    if (registry->config.strict_validation) {
+        for (size_t i = 0; i < count; i++) {
+            if (!mcp_tool_validate(&tools[i])) {
+                mcp_log_error("Tool validation failed for '%s'", mcp_tool_get_name(&tools[i]));
+                return -1;
+            }
+        }
+    }
+    
+    mcp_tool_entry_block_t *block = calloc(1, sizeof(mcp_tool_entry_block_t) + count * sizeof(mcp_tool_entry_t));
+    if (!block) return -1;
+    
+    time_t now = time(NULL);
+    for (size_t i = 0; i < count; i++) {
+        mcp_tool_entry_t *entry = &block->entries[i];
+        entry->tool = &tools[i];
+        entry->registered_time = now;
+        entry->name_hash = tool_name_hash(mcp_tool_get_name(&tools[i]));
+        entry->in_block = true;
+    }
+    
+    pthread_mutex_lock(&registry->registry_mutex);
+    
+    mcp_tool_snapshot_t *current = registry->snapshot;
+    if (current->count + count > registry->config.max_tools) {
+        pthread_mutex_unlock(&registry->registry_mutex);
+        free(block);
+        mcp_log_error("Maximum tools limit reached (%zu)", registry->config.max_tools);
+        return -1;
+    }
+    
+    // A name taken already, or twice inside the batch, fails the whole batch
+    const char *clash = NULL;
+    mcp_tool_snapshot_t *next = tool_snapshot_create(current, NULL, block->entries, count, &clash);
+    if (!next) {
+        pthread_mutex_unlock(&registry->registry_mutex);
+        free(block);
+        if (clash) {
+            mcp_log_error("Tool '%s' already registered", clash);
+        }
+        return -1;
+    }
+    
+    block->next = registry->entry_blocks;
+    registry->entry_blocks = block;
+    
+    __atomic_add_fetch(&registry->total_tools_registered, count, __ATOMIC_RELAXED);
+    tool_snapshot_publish(registry, next);
+    
+    pthread_mutex_unlock(&registry->registry_mutex);
+    
+    mcp_log_debug("Registered %zu tools as a batch", count);
+    
+    return 0;
+}
+
 int mcp_tool_registry_unregister_tool(mcp_tool_registry_t *registry, const char *tool_name) {
     if (!registry || !tool_name) return -1;
     
-    pthread_rwlock_wrlock(&registry->tools_lock);
+    pthread_mutex_lock(&registry->registry_mutex);
     
-    mcp_tool_entry_t *prev = NULL;
-    mcp_tool_entry_t *current = registry->tools;
+    mcp_tool_snapshot_t *current = registry->snapshot;
+    mcp_tool_entry_t *entry = *tool_index_probe(current->index, current->index_capacity, tool_name,
+                                                tool_name_hash(tool_name));
+    if (!entry) {
+        pthread_mutex_unlock(&registry->registry_mutex);
+        mcp_log_error("Tool '%s' not found for unregistration", tool_name);
+        return -1;
+    }
     
-    while (current) {
-        if (strcmp(mcp_tool_get_name(current->tool), tool_name) == 0) {
-            // Remove from list
-            if (prev) {
-                prev->next = current->next;
-            } else {
-                registry->tools = current->next;
-            }
-            
-            // Cleanup entry
-            mcp_tool_unref(current->tool);
-            free(current);
-            
-            registry->tool_count--;
-            registry->tools_unregistered++;
-            
-            pthread_rwlock_unlock(&registry->tools_lock);
-            
-            mcp_log_debug("Tool '%s' unregistered successfully", tool_name);
-            return 0;
-        }
-        
-        prev = current;
-        current = current->next;
+    mcp_tool_snapshot_t *next = tool_snapshot_create(current, entry, NULL, 0, NULL);
+    if (!next) {
+        pthread_mutex_unlock(&registry->registry_mutex);
+        return -1;
     }
     
-    pthread_rwlock_unlock(&registry->tools_lock);
+    __atomic_add_fetch(&registry->tools_unregistered, 1, __ATOMIC_RELAXED);
+    
+    // Calls that looked the tool up already go on; the old snapshot's reference
+    // goes with it, and in-flight calls keep the entry alive until they finish
+    tool_snapshot_publish(registry, next);
     
-    mcp_log_error("Tool '%s' not found for unregistration", tool_name);
-    return -1;
+    pthread_mutex_unlock(&registry->registry_mutex);
+    
+    // A tool registered under the name later must not get these
+    mcp_tool_registry_invalidate_results(registry, tool_name);
+    
+    mcp_log_debug("Tool '%s' unregistered successfully", tool_name);
+    return 0;
 }
 
 bool mcp_tool_registry_has_tool(const mcp_tool_registry_t *registry, const char *tool_name) {
     if (!registry || !tool_name) return false;
     
-    pthread_rwlock_rdlock((pthread_rwlock_t*)&registry->tools_lock);
-    
-    mcp_tool_entry_t *entry = mcp_tool_registry_find_tool_entry(registry, tool_name);
-    bool found = (entry != NULL);
-    
-    pthread_rwlock_unlock((pthread_rwlock_t*)&registry->tools_lock);
+    mcp_epoch_enter();
+    bool found = mcp_tool_registry_find_tool_entry(registry, tool_name) != NULL;
+    mcp_epoch_exit();
     
     return found;
 }
@@ -220,12 +520,10 @@ bool mcp_tool_registry_has_tool(const mcp_tool_registry_t *registry, const char
 mcp_tool_t *mcp_tool_registry_find_tool(const mcp_tool_registry_t *registry, const char *tool_name) {
     if (!registry || !tool_name) return NULL;
     
-    pthread_rwlock_rdlock((pthread_rwlock_t*)&registry->tools_lock);
-    
+    mcp_epoch_enter();
     mcp_tool_entry_t *entry = mcp_tool_registry_find_tool_entry(registry, tool_name);
     mcp_tool_t *tool = entry ? mcp_tool_ref(entry->tool) : NULL;
-    
-    pthread_rwlock_unlock((pthread_rwlock_t*)&registry->tools_lock);
+    mcp_epoch_exit();
     
     return tool;
 }
@@ -233,108 +531,600 @@ mcp_tool_t *mcp_tool_registry_find_tool(const mcp_tool_registry_t *registry, con
 mcp_tool_entry_t *mcp_tool_registry_find_tool_entry(const mcp_tool_registry_t *registry, const char *tool_name) {
     if (!registry || !tool_name) return NULL;
     
-    mcp_tool_entry_t *current = registry->tools;
-    while (current) {
-        if (strcmp(mcp_tool_get_name(current->tool), tool_name) == 0) {
-            return current;
+    const mcp_tool_snapshot_t *snapshot = tool_snapshot_current(registry);
+    return *tool_index_probe(snapshot->index, snapshot->index_capacity, tool_name, tool_name_hash(tool_name));
+}
+
+mcp_tool_entry_t *mcp_tool_registry_acquire_entry(const mcp_tool_registry_t *registry, const char *tool_name) {
+    if (!registry || !tool_name) return NULL;
+    
+    // The snapshot's reference keeps the entry alive until the epoch is left
+    mcp_epoch_enter();
+    mcp_tool_entry_t *entry = mcp_tool_registry_find_tool_entry(registry, tool_name);
+    if (entry) tool_entry_ref(entry);
+    mcp_epoch_exit();
+    
+    return entry;
+}
+
+void mcp_tool_registry_release_entry(mcp_tool_entry_t *entry) {
+    if (entry) tool_entry_unref(entry);
+}
+
+// Callers blocked by a bulkhead wait on the queue their tool hashes to, so a finished
+// call only wakes waiters of its own tool (and the rare tool sharing its stripe)
+#define BULKHEAD_WAIT_STRIPES 16
+#define BULKHEAD_DEFAULT_WAIT_MS 30000
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} bulkhead_queue_t;
+
+static bulkhead_queue_t g_bulkhead_queues[BULKHEAD_WAIT_STRIPES];
+static pthread_once_t g_bulkhead_once = PTHREAD_ONCE_INIT;
+
+static void bulkhead_queues_init(void) {
+    for (size_t i = 0; i < BULKHEAD_WAIT_STRIPES; i++) {
+        pthread_mutex_init(&g_bulkhead_queues[i].mutex, NULL);
+        pthread_cond_init(&g_bulkhead_queues[i].cond, NULL);
+    }
+}
+
+static bulkhead_queue_t *bulkhead_queue_for(const mcp_tool_entry_t *entry) {
+    pthread_once(&g_bulkhead_once, bulkhead_queues_init);
+    uintptr_t key = (uintptr_t)entry->tool;
+    key ^= key >> 7;
+    return &g_bulkhead_queues[(key >> 4) % BULKHEAD_WAIT_STRIPES];
+}
+
+static bool tool_entry_try_enter(mcp_tool_entry_t *entry) {
+    size_t limit = __atomic_load_n(&entry->tool->max_concurrent_calls, __ATOMIC_RELAXED);
+    size_t active = __atomic_load_n(&entry->calls_active, __ATOMIC_SEQ_CST);
+    while (limit == 0 || active < limit) {
+        if (__atomic_compare_exchange_n(&entry->calls_active, &active, active + 1, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int mcp_tool_registry_admit_call(mcp_tool_entry_t *entry) {
+    if (!entry) return -1;
+    if (tool_entry_try_enter(entry)) return 0;
+    
+    // A waiter holds a worker, so it gives up after the tool's own execution budget
+    size_t wait_ms = entry->tool->max_execution_time_ms;
+    if (wait_ms == 0) wait_ms = BULKHEAD_DEFAULT_WAIT_MS;
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += (time_t)(wait_ms / 1000);
+    until.tv_nsec += (long)(wait_ms % 1000) * 1000000L;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+    
+    // calls_waiting goes up before the retry, so a call finishing in between sees the
+    // waiter and signals once we are in pthread_cond_timedwait
+    bulkhead_queue_t *queue = bulkhead_queue_for(entry);
+    int result = -1;
+    pthread_mutex_lock(&queue->mutex);
+    if (entry->calls_waiting < __atomic_load_n(&entry->tool->max_waiting_calls, __ATOMIC_RELAXED)) {
+        __atomic_add_fetch(&entry->calls_waiting, 1, __ATOMIC_SEQ_CST);
+        for (;;) {
+            if (tool_entry_try_enter(entry)) {
+                result = 0;
+                break;
+            }
+            if (pthread_cond_timedwait(&queue->cond, &queue->mutex, &until) == ETIMEDOUT) {
+                if (tool_entry_try_enter(entry)) result = 0;
+                break;
+            }
         }
-        current = current->next;
+        __atomic_sub_fetch(&entry->calls_waiting, 1, __ATOMIC_SEQ_CST);
     }
+    pthread_mutex_unlock(&queue->mutex);
     
-    return NULL;
+    if (result != 0) {
+        __atomic_add_fetch(&entry->calls_rejected, 1, __ATOMIC_RELAXED);
+    }
+    return result;
+}
+
+void mcp_tool_registry_finish_call(mcp_tool_entry_t *entry) {
+    if (!entry) return;
+    
+    __atomic_sub_fetch(&entry->calls_active, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&entry->calls_waiting, __ATOMIC_SEQ_CST) > 0) {
+        // Only one slot came free; a stripe shared with another tool needs the broadcast
+        // so the right waiter is not left asleep
+        bulkhead_queue_t *queue = bulkhead_queue_for(entry);
+        pthread_mutex_lock(&queue->mutex);
+        pthread_cond_broadcast(&queue->cond);
+        pthread_mutex_unlock(&queue->mutex);
+    }
+}
+
+// Result cache
+int mcp_tool_registry_enable_result_cache(mcp_tool_registry_t *registry, size_t max_bytes) {
+    if (!registry || max_bytes == 0) return -1;
+    if (__atomic_load_n(&registry->result_cache, __ATOMIC_ACQUIRE)) return 0;
+    
+    mcp_tool_cache_t *cache = mcp_tool_cache_create(max_bytes);
+    if (!cache) return -1;
+    
+    mcp_tool_cache_t *expected = NULL;
+    if (!__atomic_compare_exchange_n(&registry->result_cache, &expected, cache, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        mcp_tool_cache_destroy(cache);
+    }
+    return 0;
+}
+
+cJSON *mcp_tool_registry_cache_lookup(mcp_tool_registry_t *registry, mcp_tool_entry_t *entry,
+                                      const cJSON *arguments, mcp_tool_cache_key_t *key) {
+    mcp_json_buffer_init(&key->text);
+    key->hash = 0;
+    key->ttl_ms = 0;
+    key->flight = NULL;
+    
+    mcp_tool_cache_t *cache = registry ? __atomic_load_n(&registry->result_cache, __ATOMIC_ACQUIRE) : NULL;
+    uint32_t ttl_ms = entry ? __atomic_load_n(&entry->tool->cache_ttl_ms, __ATOMIC_RELAXED) : 0;
+    if (!cache || ttl_ms == 0 ||
+        mcp_tool_cache_key_build(key, mcp_tool_get_name(entry->tool), arguments) != 0) {
+        return NULL;
+    }
+    key->ttl_ms = ttl_ms;
+    
+    cJSON *cached = mcp_tool_cache_lookup(cache, key);
+    
+    // Not cached yet: join an identical call in progress, or lead one
+    if (!cached) {
+        bool leader;
+        mcp_single_flight_t *flight = mcp_single_flight_join(&registry->calls, key->text.data,
+                                                             key->text.length, &leader);
+        if (flight && !leader) {
+            cached = mcp_single_flight_wait(flight);  // NULL: nothing shared, run on our own
+        } else {
+            key->flight = flight;
+        }
+    }
+    
+    __atomic_add_fetch(cached ? &entry->cache_hits : &entry->cache_misses, 1, __ATOMIC_RELAXED);
+    return cached;
+}
+
+static cJSON *tool_result_cache(mcp_tool_cache_t *cache, const mcp_tool_cache_key_t *key, cJSON *result) {
+    if (!cache || !key->text.data || key->ttl_ms == 0 || !result) return result;
+    
+    // Errors may be transient, only results are remembered
+    cJSON *is_error = cJSON_GetObjectItem(result, "isError");
+    if (cJSON_IsTrue(is_error)) return result;
+    
+    mcp_json_buffer_t json;
+    mcp_json_buffer_init(&json);
+    if (mcp_json_write_compact(&json, result) != 0) {
+        mcp_json_buffer_free(&json);
+        return result;
+    }
+    
+    size_t length = json.length;
+    cJSON *view = mcp_tool_cache_store(cache, key, key->ttl_ms, mcp_json_buffer_detach(&json), length);
+    if (!view) return result;
+    
+    mcp_json_delete(result);
+    return view;
+}
+
+cJSON *mcp_tool_registry_cache_store(mcp_tool_registry_t *registry, mcp_tool_cache_key_t *key,
+                                     cJSON *result) {
+    mcp_tool_cache_t *cache = registry ? __atomic_load_n(&registry->result_cache, __ATOMIC_ACQUIRE) : NULL;
+    result = tool_result_cache(cache, key, result);
+    
+    // Calls that waited for this one get the same result, errors included
+    mcp_single_flight_finish(key->flight, result);
+    key->flight = NULL;
+    return result;
+}
+
+size_t mcp_tool_registry_invalidate_results(mcp_tool_registry_t *registry, const char *tool_name) {
+    if (!registry) return 0;
+    return mcp_tool_cache_invalidate_tool(__atomic_load_n(&registry->result_cache, __ATOMIC_ACQUIRE),
+                                          tool_name);
+}
+
+void mcp_tool_registry_get_result_cache_stats(mcp_tool_registry_t *registry, mcp_tool_cache_stats_t *stats) {
+    mcp_tool_cache_get_stats(registry ? __atomic_load_n(&registry->result_cache, __ATOMIC_ACQUIRE) : NULL,
+                             stats);
+    if (registry && stats) {
+        stats->coalesced = mcp_single_flight_shared(&registry->calls);
+    }
 }
 
 // Tool execution
+static void tool_entry_record_call(mcp_tool_registry_t *registry, mcp_tool_entry_t *entry,
+                                   const cJSON *result, double execution_time) {
+    mcp_tool_stats_shard_t *shards = tool_entry_stats_shards(entry);
+    if (!shards) return;
+    
+    mcp_tool_stats_shard_t *shard = &shards[mcp_counter_shard()];
+    uint64_t execution_us = execution_time > 0.0 ? (uint64_t)(execution_time * 1000000.0) : 0;
+    
+    __atomic_add_fetch(&shard->calls_made, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&shard->total_execution_us, execution_us, __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->last_called, time(NULL), __ATOMIC_RELAXED);
+    mcp_histogram_record_atomic(&shard->latency, execution_us);
+    
+    // Check if the result indicates an error using MCP format
+    cJSON *is_error = cJSON_GetObjectItem(result, "isError");
+    if (result && (!is_error || !cJSON_IsTrue(is_error))) {
+        __atomic_add_fetch(&shard->calls_successful, 1, __ATOMIC_RELAXED);
+        mcp_counter_inc(&registry->total_calls_successful);
+    } else {
+        __atomic_add_fetch(&shard->calls_failed, 1, __ATOMIC_RELAXED);
+        mcp_counter_inc(&registry->total_calls_failed);
+    }
+    
+    mcp_counter_inc(&registry->total_calls_made);
+}
+
 cJSON *mcp_tool_registry_call_tool(mcp_tool_registry_t *registry, const char *tool_name, const cJSON *parameters) {
     if (!registry || !tool_name) {
         return mcp_tool_registry_create_tool_not_found_error(tool_name);
     }
     
-    pthread_rwlock_rdlock(&registry->tools_lock);
+    uint64_t span = mcp_trace_begin();
+    mcp_epoch_enter();
     
     mcp_tool_entry_t *entry = mcp_tool_registry_find_tool_entry(registry, tool_name);
     if (!entry) {
-        pthread_rwlock_unlock(&registry->tools_lock);
+        mcp_epoch_exit();
         return mcp_tool_registry_create_tool_not_found_error(tool_name);
     }
+    mcp_trace_end(MCP_TRACE_DISPATCH, span, tool_name);
     
-    mcp_tool_t *tool = mcp_tool_ref(entry->tool);
+    // Pin the entry (and through it the tool) so it outlives the snapshot and stats
+    // can be updated without a second lookup
+    tool_entry_ref(entry);
     
-    pthread_rwlock_unlock(&registry->tools_lock);
+    mcp_epoch_exit();
     
-    // Execute tool and measure time
-    clock_t start_time = clock();
-    cJSON *result = mcp_tool_execute(tool, parameters);
-    clock_t end_time = clock();
+    cJSON *result = mcp_tool_registry_call_entry(registry, entry, parameters);
+    tool_entry_unref(entry);
     
-    double execution_time = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
+    return result;
+}
+
+cJSON *mcp_tool_registry_call_entry(mcp_tool_registry_t *registry, mcp_tool_entry_t *entry,
+                                    const cJSON *parameters) {
+    if (!registry || !entry) {
+        return mcp_tool_registry_create_tool_not_found_error(NULL);
+    }
+    const char *tool_name = entry->tool->name;
     
-    // Update statistics
-    pthread_rwlock_wrlock(&registry->tools_lock);
+    // A cached result needs no slot and no statistics
+    mcp_tool_cache_key_t key;
+    cJSON *cached = mcp_tool_registry_cache_lookup(registry, entry, parameters, &key);
+    if (cached) {
+        mcp_tool_cache_key_free(&key);
+        return cached;
+    }
     
-    entry = mcp_tool_registry_find_tool_entry(registry, tool_name);
-    if (entry && registry->config.enable_tool_stats) {
-        entry->calls_made++;
-        entry->last_called = time(NULL);
-        entry->total_execution_time += execution_time;
-        entry->average_execution_time = entry->total_execution_time / entry->calls_made;
-        
-        // Check if the result indicates an error using MCP format
-        cJSON *is_error = cJSON_GetObjectItem(result, "isError");
-        if (result && (!is_error || !cJSON_IsTrue(is_error))) {
-            entry->calls_successful++;
-            registry->total_calls_successful++;
-        } else {
-            entry->calls_failed++;
-            registry->total_calls_failed++;
-        }
-        
-        registry->total_calls_made++;
+    if (mcp_tool_registry_admit_call(entry) != 0) {
+        mcp_tool_cache_key_free(&key);
+        return mcp_tool_registry_create_busy_error(tool_name);
     }
     
-    pthread_rwlock_unlock(&registry->tools_lock);
+    // Execute tool and measure wall-clock time
+    uint64_t start_us = registry_now_us();
+    uint64_t span = mcp_trace_begin();
+    cJSON *result = mcp_tool_execute(entry->tool, parameters);
+    mcp_trace_end(MCP_TRACE_EXECUTE, span, tool_name);
+    double execution_time = (double)(registry_now_us() - start_us) / 1000000.0;
+    mcp_tool_registry_finish_call(entry);
     
-    mcp_tool_unref(tool);
+    // Update statistics (the entry is pinned)
+    if (registry->config.enable_tool_stats) {
+        tool_entry_record_call(registry, entry, result, execution_time);
+    }
+    
+    result = mcp_tool_registry_cache_store(registry, &key, result);
+    mcp_tool_cache_key_free(&key);
     
     return result;
 }
 
+void mcp_tool_registry_record_call(mcp_tool_registry_t *registry, const char *tool_name,
+                                   const cJSON *result, double execution_time) {
+    if (!registry || !tool_name || !registry->config.enable_tool_stats) return;
+    
+    mcp_tool_entry_t *entry = mcp_tool_registry_acquire_entry(registry, tool_name);
+    if (entry) {
+        tool_entry_record_call(registry, entry, result, execution_time);
+        tool_entry_unref(entry);
+    }
+}
+
+void mcp_tool_registry_record_entry_call(mcp_tool_registry_t *registry, mcp_tool_entry_t *entry,
+                                         const cJSON *result, double execution_time) {
+    if (!registry || !entry || !registry->config.enable_tool_stats) return;
+    tool_entry_record_call(registry, entry, result, execution_time);
+}
+
 // Tool listing
 cJSON *mcp_tool_registry_list_tools(const mcp_tool_registry_t *registry) {
     if (!registry) return NULL;
     
-    pthread_rwlock_rdlock((pthread_rwlock_t*)&registry->tools_lock);
-    
     cJSON *tools_array = cJSON_CreateArray();
-    if (!tools_array) {
-        pthread_rwlock_unlock((pthread_rwlock_t*)&registry->tools_lock);
-        return NULL;
-    }
+    if (!tools_array) return NULL;
     
-    mcp_tool_entry_t *current = registry->tools;
-    while (current) {
-        cJSON *tool_def = mcp_tool_to_mcp_tool_definition(current->tool);
+    mcp_epoch_enter();
+    const mcp_tool_snapshot_t *snapshot = tool_snapshot_current(registry);
+    for (size_t i = 0; i < snapshot->count; i++) {
+        cJSON *tool_def = mcp_tool_to_mcp_tool_definition(snapshot->tools[i]->tool);
         if (tool_def) {
             cJSON_AddItemToArray(tools_array, tool_def);
         }
-        current = current->next;
     }
-    
-    pthread_rwlock_unlock((pthread_rwlock_t*)&registry->tools_lock);
+    mcp_epoch_exit();
     
     return tools_array;
 }
 
+// Serialize the tools array straight from the tools, without building a cJSON tree;
+// caller must be inside the epoch the snapshot was loaded in
+static mcp_tool_list_cache_t *tool_list_cache_build(const mcp_tool_snapshot_t *snapshot) {
+    mcp_json_buffer_t buffer;
+    mcp_json_buffer_init(&buffer);
+    
+    int rc = mcp_json_write_literal(&buffer, "[");
+    for (size_t i = 0; i < snapshot->count && rc == 0; i++) {
+        if (i > 0) {
+            rc = mcp_json_write_literal(&buffer, ",");
+        }
+        if (rc == 0) {
+            rc = mcp_tool_write_definition(&buffer, snapshot->tools[i]->tool);
+        }
+    }
+    if (rc == 0) {
+        rc = mcp_json_write_literal(&buffer, "]");
+    }
+    
+    mcp_tool_list_cache_t *cache = rc == 0 ? malloc(sizeof(mcp_tool_list_cache_t)) : NULL;
+    if (!cache) {
+        mcp_json_buffer_free(&buffer);
+        return NULL;
+    }
+    cache->length = buffer.length;
+    cache->json = mcp_json_buffer_detach(&buffer);
+    cache->ref_count = 1;
+    if (!cache->json) {
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+// Caller must be inside the epoch the cache's snapshot was loaded in
+static cJSON *tool_list_cache_view(mcp_tool_list_cache_t *cache) {
+    __atomic_add_fetch(&cache->ref_count, 1, __ATOMIC_RELAXED);
+    
+    cJSON *view = mcp_json_create_raw_view(cache->json, cache->length, tool_list_cache_unref, cache);
+    if (!view) {
+        tool_list_cache_unref(cache);
+    }
+    return view;
+}
+
+cJSON *mcp_tool_registry_list_tools_raw(mcp_tool_registry_t *registry) {
+    if (!registry) return NULL;
+    
+    mcp_epoch_enter();
+    mcp_tool_snapshot_t *snapshot = tool_snapshot_current(registry);
+    mcp_tool_list_cache_t *cache = __atomic_load_n(&snapshot->list_cache, __ATOMIC_ACQUIRE);
+    
+    // Cache is cold - serialize once per snapshot; if another thread won the race, use its copy
+    if (!cache) {
+        mcp_tool_list_cache_t *built = tool_list_cache_build(snapshot);
+        if (built && __atomic_compare_exchange_n(&snapshot->list_cache, &cache, built, false,
+                                                 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            cache = built;
+        } else {
+            tool_list_cache_unref(built);
+        }
+    }
+    
+    cJSON *raw = cache ? tool_list_cache_view(cache) : NULL;
+    mcp_epoch_exit();
+    
+    return raw;
+}
+
+uint64_t mcp_tool_registry_get_version(const mcp_tool_registry_t *registry) {
+    if (!registry) return 0;
+    
+    mcp_epoch_enter();
+    uint64_t version = tool_snapshot_current(registry)->version;
+    mcp_epoch_exit();
+    
+    return version;
+}
+
 size_t mcp_tool_registry_get_tool_count(const mcp_tool_registry_t *registry) {
     if (!registry) return 0;
     
-    pthread_rwlock_rdlock((pthread_rwlock_t*)&registry->tools_lock);
-    size_t count = registry->tool_count;
-    pthread_rwlock_unlock((pthread_rwlock_t*)&registry->tools_lock);
+    mcp_epoch_enter();
+    size_t count = tool_snapshot_current(registry)->count;
+    mcp_epoch_exit();
     
     return count;
 }
 
+// Registry statistics
+static void add_latency_stats(cJSON *object, const mcp_histogram_t *latency) {
+    cJSON *stats = cJSON_AddObjectToObject(object, "latency");
+    if (!stats) return;
+
+    cJSON_AddNumberToObject(stats, "count", (double)latency->count);
+    cJSON_AddNumberToObject(stats, "p50Us", (double)mcp_histogram_percentile(latency, 0.50));
+    cJSON_AddNumberToObject(stats, "p90Us", (double)mcp_histogram_percentile(latency, 0.90));
+    cJSON_AddNumberToObject(stats, "p99Us", (double)mcp_histogram_percentile(latency, 0.99));
+    cJSON_AddNumberToObject(stats, "maxUs", (double)latency->max_us);
+}
+
+static cJSON *tool_entry_stats(const mcp_tool_entry_t *entry) {
+    cJSON *stats = cJSON_CreateObject();
+    if (!stats) return NULL;
+
+    mcp_tool_stats_t totals;
+    tool_entry_aggregate(entry, &totals);
+
+    cJSON_AddStringToObject(stats, "name", mcp_tool_get_name(entry->tool));
+    cJSON_AddBoolToObject(stats, "builtin", totals.is_builtin);
+    cJSON_AddNumberToObject(stats, "callsMade", (double)totals.calls_made);
+    cJSON_AddNumberToObject(stats, "callsSuccessful", (double)totals.calls_successful);
+    cJSON_AddNumberToObject(stats, "callsFailed", (double)totals.calls_failed);
+    cJSON_AddNumberToObject(stats, "lastCalled", (double)totals.last_called);
+    cJSON_AddNumberToObject(stats, "totalExecutionTime", totals.total_execution_time);
+    cJSON_AddNumberToObject(stats, "averageExecutionTime",
+                            totals.calls_made > 0 ? totals.total_execution_time / (double)totals.calls_made : 0.0);
+    add_latency_stats(stats, &totals.latency);
+
+    cJSON *bulkhead = cJSON_AddObjectToObject(stats, "concurrency");
+    if (bulkhead) {
+        cJSON_AddNumberToObject(bulkhead, "maxConcurrentCalls", (double)totals.max_concurrent_calls);
+        cJSON_AddNumberToObject(bulkhead, "maxWaitingCalls", (double)totals.max_waiting_calls);
+        cJSON_AddNumberToObject(bulkhead, "active", (double)totals.calls_active);
+        cJSON_AddNumberToObject(bulkhead, "waiting", (double)totals.calls_waiting);
+        cJSON_AddNumberToObject(bulkhead, "rejected", (double)totals.calls_rejected);
+    }
+
+    size_t lookups = totals.cache_hits + totals.cache_misses;
+    cJSON *cache = totals.cache_ttl_ms || lookups ? cJSON_AddObjectToObject(stats, "cache") : NULL;
+    if (cache) {
+        cJSON_AddNumberToObject(cache, "ttlMs", (double)totals.cache_ttl_ms);
+        cJSON_AddNumberToObject(cache, "hits", (double)totals.cache_hits);
+        cJSON_AddNumberToObject(cache, "misses", (double)totals.cache_misses);
+        cJSON_AddNumberToObject(cache, "hitRate", lookups > 0 ? (double)totals.cache_hits / (double)lookups : 0.0);
+    }
+    return stats;
+}
+
+mcp_tool_stats_t *mcp_tool_registry_snapshot_stats(const mcp_tool_registry_t *registry, size_t *count) {
+    if (count) *count = 0;
+    if (!registry || !count) return NULL;
+
+    mcp_epoch_enter();
+    const mcp_tool_snapshot_t *snapshot = tool_snapshot_current(registry);
+
+    // Entries first, names packed after them
+    size_t names_size = 0;
+    for (size_t i = 0; i < snapshot->count; i++) {
+        names_size += strlen(mcp_tool_get_name(snapshot->tools[i]->tool)) + 1;
+    }
+
+    size_t n = snapshot->count;
+    mcp_tool_stats_t *stats = n > 0 ? malloc(n * sizeof(mcp_tool_stats_t) + names_size) : NULL;
+    if (stats) {
+        char *names = (char*)(stats + n);
+        for (size_t i = 0; i < n; i++) {
+            const mcp_tool_entry_t *entry = snapshot->tools[i];
+            const char *name = mcp_tool_get_name(entry->tool);
+            size_t length = strlen(name) + 1;
+            memcpy(names, name, length);
+
+            tool_entry_aggregate(entry, &stats[i]);
+            stats[i].name = names;
+            names += length;
+        }
+        *count = n;
+    }
+
+    mcp_epoch_exit();
+
+    return stats;
+}
+
+cJSON *mcp_tool_registry_get_stats(const mcp_tool_registry_t *registry) {
+    if (!registry) return NULL;
+
+    cJSON *stats = cJSON_CreateObject();
+    if (!stats) return NULL;
+
+    mcp_epoch_enter();
+    const mcp_tool_snapshot_t *snapshot = tool_snapshot_current(registry);
+
+    cJSON_AddNumberToObject(stats, "toolCount", (double)snapshot->count);
+    cJSON_AddNumberToObject(stats, "totalToolsRegistered",
+                            (double)__atomic_load_n(&registry->total_tools_registered, __ATOMIC_RELAXED));
+    cJSON_AddNumberToObject(stats, "toolsUnregistered",
+                            (double)__atomic_load_n(&registry->tools_unregistered, __ATOMIC_RELAXED));
+    cJSON_AddNumberToObject(stats, "totalCallsMade", (double)mcp_counter_read(&registry->total_calls_made));
+    cJSON_AddNumberToObject(stats, "totalCallsSuccessful",
+                            (double)mcp_counter_read(&registry->total_calls_successful));
+    cJSON_AddNumberToObject(stats, "totalCallsFailed", (double)mcp_counter_read(&registry->total_calls_failed));
+
+    cJSON *tools = cJSON_AddArrayToObject(stats, "tools");
+    for (size_t i = 0; i < snapshot->count && tools; i++) {
+        cJSON_AddItemToArray(tools, tool_entry_stats(snapshot->tools[i]));
+    }
+
+    mcp_epoch_exit();
+
+    mcp_tool_cache_stats_t cache_stats;
+    mcp_tool_registry_get_result_cache_stats((mcp_tool_registry_t*)registry, &cache_stats);
+    if (cache_stats.max_bytes > 0) {
+        cJSON *cache = cJSON_AddObjectToObject(stats, "resultCache");
+        if (cache) {
+            cJSON_AddNumberToObject(cache, "entries", (double)cache_stats.entries);
+            cJSON_AddNumberToObject(cache, "bytes", (double)cache_stats.bytes);
+            cJSON_AddNumberToObject(cache, "maxBytes", (double)cache_stats.max_bytes);
+            cJSON_AddNumberToObject(cache, "evictions", (double)cache_stats.evictions);
+            cJSON_AddNumberToObject(cache, "coalesced", (double)cache_stats.coalesced);
+        }
+    }
+
+    return stats;
+}
+
+cJSON *mcp_tool_registry_get_tool_stats(const mcp_tool_registry_t *registry, const char *tool_name) {
+    if (!registry || !tool_name) return NULL;
+
+    mcp_epoch_enter();
+    mcp_tool_entry_t *entry = mcp_tool_registry_find_tool_entry(registry, tool_name);
+    cJSON *stats = entry ? tool_entry_stats(entry) : NULL;
+    mcp_epoch_exit();
+
+    return stats;
+}
+
+void mcp_tool_registry_reset_stats(mcp_tool_registry_t *registry) {
+    if (!registry) return;
+
+    // Calls recorded while this runs may survive the reset, as with any concurrent reset
+    mcp_epoch_enter();
+    const mcp_tool_snapshot_t *snapshot = tool_snapshot_current(registry);
+
+    for (size_t e = 0; e < snapshot->count; e++) {
+        mcp_tool_entry_t *entry = snapshot->tools[e];
+        __atomic_store_n(&entry->calls_rejected, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry->cache_hits, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry->cache_misses, 0, __ATOMIC_RELAXED);
+        mcp_tool_stats_shard_t *shards = __atomic_load_n(&entry->stats, __ATOMIC_ACQUIRE);
+        if (!shards) continue;
+        for (unsigned i = 0; i < MCP_COUNTER_SHARDS; i++) {
+            tool_stats_shard_reset(&shards[i]);
+        }
+    }
+    mcp_counter_reset(&registry->total_calls_made);
+    mcp_counter_reset(&registry->total_calls_successful);
+    mcp_counter_reset(&registry->total_calls_failed);
+
+    mcp_epoch_exit();
+}
+
 // Configuration helpers
 mcp_tool_registry_config_t *mcp_tool_registry_config_create_default(void) {
     mcp_tool_registry_config_t *config = calloc(1, sizeof(mcp_tool_registry_config_t));
@@ -368,4 +1158,19 @@ cJSON *mcp_tool_registry_create_tool_not_found_error(const char *tool_name) {
     return result;
 }
 
+cJSON *mcp_tool_registry_create_busy_error(const char *tool_name) {
+    cJSON *data = cJSON_CreateObject();
+    if (data && tool_name) {
+        cJSON_AddStringToObject(data, "tool_name", tool_name);
+    }
+    if (data) {
+        cJSON_AddBoolToObject(data, "retryable", true);
+    }
+    
+    cJSON *result = mcp_tool_create_error_result(MCP_TOOL_ERROR_BUSY, "Tool is at its concurrency limit", data);
+    
+    if (data) cJSON_Delete(data);
+    return result;
+}
+
 
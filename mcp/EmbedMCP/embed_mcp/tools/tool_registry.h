@@ -2,7 +2,11 @@
 #define MCP_TOOL_REGISTRY_H
 
 #include "tool_interface.h"
+#include "tool_cache.h"
+#include "utils/histogram.h"
+#include "utils/counter.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include <pthread.h>
 #include "cjson/cJSON.h"
@@ -10,6 +14,20 @@
 // Forward declarations
 typedef struct mcp_tool_registry mcp_tool_registry_t;
 typedef struct mcp_tool_entry mcp_tool_entry_t;
+typedef struct mcp_tool_list_cache mcp_tool_list_cache_t;
+typedef struct mcp_tool_entry_block mcp_tool_entry_block_t;
+typedef struct mcp_tool_snapshot mcp_tool_snapshot_t;
+
+// One thread's share of a tool's statistics (see utils/counter.h), updated with
+// relaxed atomics and summed on read
+typedef struct {
+    size_t calls_made;
+    size_t calls_successful;
+    size_t calls_failed;
+    uint64_t total_execution_us;    // Wall clock
+    time_t last_called;
+    mcp_histogram_t latency;        // Wall-clock call latency, microseconds
+} MCP_CACHE_ALIGNED mcp_tool_stats_shard_t;
 
 // Tool entry structure
 struct mcp_tool_entry {
@@ -19,16 +37,23 @@ struct mcp_tool_entry {
     time_t registered_time;
     bool is_builtin;
     
-    // Statistics
-    size_t calls_made;
-    size_t calls_successful;
-    size_t calls_failed;
-    time_t last_called;
-    double total_execution_time;
-    double average_execution_time;
+    // Statistics, MCP_COUNTER_SHARDS cache-line aligned shards allocated by the first
+    // recorded call (NULL until then)
+    mcp_tool_stats_shard_t *stats;
+    
+    // Bulkhead usage (tool->max_concurrent_calls), atomic
+    size_t calls_active;            // Admitted, not finished
+    size_t calls_waiting;           // Blocked waiting for a slot
+    size_t calls_rejected;          // Refused with the tool at its limits
+    
+    // Result cache (tool->cache_ttl_ms), atomic
+    size_t cache_hits;
+    size_t cache_misses;
     
     // Internal
-    struct mcp_tool_entry *next;
+    uint32_t name_hash;             // Precomputed hash of the tool name for the index
+    int ref_count;                  // One per snapshot holding the entry plus one per in-flight call
+    bool in_block;                  // Part of an mcp_tool_entry_block_t, not freed on its own
 };
 
 // Tool registry configuration
@@ -45,20 +70,30 @@ struct mcp_tool_registry {
     // Configuration
     mcp_tool_registry_config_t config;
     
-    // Tool storage
-    mcp_tool_entry_t *tools;
-    size_t tool_count;
-    
-    // Thread safety
-    pthread_rwlock_t tools_lock;
+    // Registered tools: an immutable snapshot (registration order, name index and
+    // serialized tools/list), replaced as a whole by every register or unregister.
+    // Readers load it inside an epoch (utils/epoch.h) and never lock; replaced
+    // snapshots are freed once no reader can see them.
+    mcp_tool_snapshot_t *snapshot;  // Atomic, never NULL after create
+
+    // Entries of tools registered as a batch, one allocation per batch
+    mcp_tool_entry_block_t *entry_blocks;
+
+    // Results of cacheable tools, NULL until enabled
+    mcp_tool_cache_t *result_cache;
+
+    // Calls of cacheable tools in progress, joined by identical concurrent calls
+    mcp_single_flight_group_t calls;
+
+    // Serializes writers (register, unregister, destroy); readers never take it
     pthread_mutex_t registry_mutex;
     
     // Statistics
-    size_t total_tools_registered;
+    size_t total_tools_registered;  // Written under registry_mutex, read atomically
     size_t tools_unregistered;
-    size_t total_calls_made;
-    size_t total_calls_successful;
-    size_t total_calls_failed;
+    mcp_counter_t total_calls_made;
+    mcp_counter_t total_calls_successful;
+    mcp_counter_t total_calls_failed;
 };
 
 // Tool registry lifecycle
@@ -70,21 +105,76 @@ int mcp_tool_registry_stop(mcp_tool_registry_t *registry);
 
 // Tool registration
 int mcp_tool_registry_register_tool(mcp_tool_registry_t *registry, mcp_tool_t *tool);
+// Register count tools stored contiguously (e.g. set up with mcp_tool_init_static()).
+// All entries share one allocation and the index grows at most once; the registry
+// takes over the tools' references. Nothing is registered if any name is taken.
+int mcp_tool_registry_register_tools(mcp_tool_registry_t *registry, mcp_tool_t *tools, size_t count);
 int mcp_tool_registry_unregister_tool(mcp_tool_registry_t *registry, const char *tool_name);
 bool mcp_tool_registry_has_tool(const mcp_tool_registry_t *registry, const char *tool_name);
 
 // Tool lookup
 mcp_tool_t *mcp_tool_registry_find_tool(const mcp_tool_registry_t *registry, const char *tool_name);
+// Pinned entry (keeps entry->tool alive after unregistration); release when done
+mcp_tool_entry_t *mcp_tool_registry_acquire_entry(const mcp_tool_registry_t *registry, const char *tool_name);
+void mcp_tool_registry_release_entry(mcp_tool_entry_t *entry);
+// Caller must be inside mcp_epoch_enter()/mcp_epoch_exit(); the entry is not pinned
+// and may only be used until the epoch is left
 mcp_tool_entry_t *mcp_tool_registry_find_tool_entry(const mcp_tool_registry_t *registry, 
                                                    const char *tool_name);
 
-// Tool execution
+/**
+ * Bulkhead: admit a call of a pinned entry before running its tool, and finish it once
+ * the tool is done (for async tools, when the call completes). With the tool at
+ * max_concurrent_calls the caller blocks for a slot if fewer than max_waiting_calls
+ * are waiting already, and is refused otherwise, so a saturated tool fails fast
+ * instead of tying up every worker. A waiter gives up and is refused once the tool's
+ * max_execution_time_ms (30 s if the tool has none) has passed.
+ * @return 0 if admitted, -1 if refused
+ */
+int mcp_tool_registry_admit_call(mcp_tool_entry_t *entry);
+void mcp_tool_registry_finish_call(mcp_tool_entry_t *entry);
+
+/**
+ * Result cache for tools with a cache_ttl_ms. call_tool uses it by itself; callers
+ * that run tools another way (the tool executor) look up first and store after.
+ * lookup returns a raw view of the cached result (free with mcp_json_delete) or NULL;
+ * on a miss of a cacheable tool it fills in key for the store, otherwise key is left
+ * empty. While a call of a cacheable tool runs, identical calls wait in lookup and
+ * get its result too; the caller that gets NULL leads and must run the tool. store
+ * takes ownership of result and returns what to send in its place. Free key with
+ * mcp_tool_cache_key_free() in any case.
+ */
+int mcp_tool_registry_enable_result_cache(mcp_tool_registry_t *registry, size_t max_bytes);
+cJSON *mcp_tool_registry_cache_lookup(mcp_tool_registry_t *registry, mcp_tool_entry_t *entry,
+                                      const cJSON *arguments, mcp_tool_cache_key_t *key);
+cJSON *mcp_tool_registry_cache_store(mcp_tool_registry_t *registry, mcp_tool_cache_key_t *key,
+                                     cJSON *result);
+// Drop a tool's cached results, returns how many were dropped
+size_t mcp_tool_registry_invalidate_results(mcp_tool_registry_t *registry, const char *tool_name);
+void mcp_tool_registry_get_result_cache_stats(mcp_tool_registry_t *registry, mcp_tool_cache_stats_t *stats);
+
+// Tool execution (cached results first, then admitted through the bulkhead); the
+// result may be a raw view, free it with mcp_json_delete()
 cJSON *mcp_tool_registry_call_tool(mcp_tool_registry_t *registry,
                                   const char *tool_name,
                                   const cJSON *parameters);
+// Same for an entry the caller has pinned with mcp_tool_registry_acquire_entry(), which
+// skips the lookup; the pin stays with the caller
+cJSON *mcp_tool_registry_call_entry(mcp_tool_registry_t *registry, mcp_tool_entry_t *entry,
+                                    const cJSON *parameters);
+// Statistics for a call that ran outside call_tool (e.g. through the tool executor).
+// Lookup and recording are both lock-free.
+void mcp_tool_registry_record_call(mcp_tool_registry_t *registry, const char *tool_name,
+                                   const cJSON *result, double execution_time);
+void mcp_tool_registry_record_entry_call(mcp_tool_registry_t *registry, mcp_tool_entry_t *entry,
+                                         const cJSON *result, double execution_time);
 
 // Tool listing
 cJSON *mcp_tool_registry_list_tools(const mcp_tool_registry_t *registry);
+// Tools array as a raw view of the cached serialization (shared, not copied per call);
+// free the result with mcp_json_delete()
+cJSON *mcp_tool_registry_list_tools_raw(mcp_tool_registry_t *registry);
+uint64_t mcp_tool_registry_get_version(const mcp_tool_registry_t *registry);
 cJSON *mcp_tool_registry_get_tool_info(const mcp_tool_registry_t *registry, const char *tool_name);
 size_t mcp_tool_registry_get_tool_count(const mcp_tool_registry_t *registry);
 
@@ -97,6 +187,31 @@ bool mcp_tool_registry_validate_tool(const mcp_tool_t *tool);
 bool mcp_tool_registry_validate_parameters(const mcp_tool_t *tool, const cJSON *parameters);
 
 // Registry statistics
+typedef struct {
+    const char *name;               // Points into the snapshot allocation
+    bool is_builtin;
+    size_t calls_made;
+    size_t calls_successful;
+    size_t calls_failed;
+    time_t last_called;
+    double total_execution_time;    // Seconds
+    mcp_histogram_t latency;
+
+    // Bulkhead
+    size_t max_concurrent_calls;    // 0 = no limit
+    size_t max_waiting_calls;
+    size_t calls_active;
+    size_t calls_waiting;
+    size_t calls_rejected;
+
+    // Result cache
+    uint32_t cache_ttl_ms;          // 0 = not cached
+    size_t cache_hits;
+    size_t cache_misses;
+} mcp_tool_stats_t;
+
+// Copy every tool's statistics from the current snapshot, for rendering afterwards. Returns one allocation (free() it), NULL when empty or out of memory.
+mcp_tool_stats_t *mcp_tool_registry_snapshot_stats(const mcp_tool_registry_t *registry, size_t *count);
 cJSON *mcp_tool_registry_get_stats(const mcp_tool_registry_t *registry);
 cJSON *mcp_tool_registry_get_tool_stats(const mcp_tool_registry_t *registry, const char *tool_name);
 void mcp_tool_registry_reset_stats(mcp_tool_registry_t *registry);
@@ -133,6 +248,7 @@ void mcp_tool_registry_set_tool_called_callback(mcp_tool_registry_t *registry,
 // Error handling
 cJSON *mcp_tool_registry_create_error_result(int code, const char *message, cJSON *data);
 cJSON *mcp_tool_registry_create_tool_not_found_error(const char *tool_name);
+cJSON *mcp_tool_registry_create_busy_error(const char *tool_name);
 cJSON *mcp_tool_registry_create_invalid_params_error(const char *details);
 cJSON *mcp_tool_registry_create_execution_error(const char *details);
 
@@ -0,0 +1,260 @@
+#include "uri_trie.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char *label;                    // Literal run, never empty
+    size_t length;
+    mcp_uri_trie_node_t *child;
+} mcp_uri_trie_edge_t;
+
+struct mcp_uri_trie_node {
+    mcp_uri_trie_edge_t *edges;     // Literal edges, distinct first bytes
+    size_t edge_count;
+    mcp_uri_trie_node_t *param;     // {name} edge
+
+    // Set when a template ends here
+    void *value;
+    char **names;
+    size_t name_count;
+};
+
+static mcp_uri_trie_node_t *node_create(void) {
+    return calloc(1, sizeof(mcp_uri_trie_node_t));
+}
+
+static void node_destroy(mcp_uri_trie_node_t *node) {
+    if (!node) return;
+
+    for (size_t i = 0; i < node->edge_count; i++) {
+        free(node->edges[i].label);
+        node_destroy(node->edges[i].child);
+    }
+    free(node->edges);
+    node_destroy(node->param);
+
+    for (size_t i = 0; i < node->name_count; i++) {
+        free(node->names[i]);
+    }
+    free(node->names);
+    free(node);
+}
+
+static char *copy_range(const char *text, size_t length) {
+    char *copy = malloc(length + 1);
+    if (copy) {
+        memcpy(copy, text, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+// Insert a literal run below node, splitting edges as needed; returns the node it ends at
+static mcp_uri_trie_node_t *insert_literal(mcp_uri_trie_node_t *node, const char *text, size_t length) {
+    while (length > 0) {
+        mcp_uri_trie_edge_t *edge = NULL;
+        for (size_t i = 0; i < node->edge_count; i++) {
+            if (node->edges[i].label[0] == text[0]) {
+                edge = &node->edges[i];
+                break;
+            }
+        }
+
+        if (!edge) {
+            mcp_uri_trie_edge_t *edges = realloc(node->edges, (node->edge_count + 1) * sizeof(*edges));
+            if (!edges) return NULL;
+            node->edges = edges;
+
+            mcp_uri_trie_node_t *child = node_create();
+            char *label = copy_range(text, length);
+            if (!child || !label) {
+                free(child);
+                free(label);
+                return NULL;
+            }
+
+            edges[node->edge_count].label = label;
+            edges[node->edge_count].length = length;
+            edges[node->edge_count].child = child;
+            node->edge_count++;
+            return child;
+        }
+
+        size_t common = 0;
+        while (common < edge->length && common < length && edge->label[common] == text[common]) {
+            common++;
+        }
+
+        if (common < edge->length) {
+            // Split: edge keeps the shared prefix, a new middle node takes the remainder
+            mcp_uri_trie_node_t *middle = node_create();
+            char *head = copy_range(edge->label, common);
+            char *tail = copy_range(edge->label + common, edge->length - common);
+            mcp_uri_trie_edge_t *middle_edge = malloc(sizeof(mcp_uri_trie_edge_t));
+            if (!middle || !head || !tail || !middle_edge) {
+                free(middle);
+                free(head);
+                free(tail);
+                free(middle_edge);
+                return NULL;
+            }
+
+            middle_edge->label = tail;
+            middle_edge->length = edge->length - common;
+            middle_edge->child = edge->child;
+            middle->edges = middle_edge;
+            middle->edge_count = 1;
+
+            free(edge->label);
+            edge->label = head;
+            edge->length = common;
+            edge->child = middle;
+        }
+
+        node = edge->child;
+        text += common;
+        length -= common;
+    }
+
+    return node;
+}
+
+void mcp_uri_trie_init(mcp_uri_trie_t *trie) {
+    if (!trie) return;
+    trie->root = NULL;
+    trie->count = 0;
+}
+
+void mcp_uri_trie_destroy(mcp_uri_trie_t *trie) {
+    if (!trie) return;
+    node_destroy(trie->root);
+    trie->root = NULL;
+    trie->count = 0;
+}
+
+int mcp_uri_trie_insert(mcp_uri_trie_t *trie, const char *uri_template, void *value) {
+    if (!trie || !uri_template) return -1;
+
+    if (!trie->root && !(trie->root = node_create())) {
+        return -1;
+    }
+
+    // Parameter names are collected first so a failed insert leaves no terminal behind
+    char *names[MCP_URI_TRIE_MAX_PARAMS];
+    size_t name_count = 0;
+    mcp_uri_trie_node_t *node = trie->root;
+    const char *p = uri_template;
+
+    while (node && *p) {
+        if (*p == '{') {
+            const char *close = strchr(p, '}');
+            if (!close || close == p + 1 || name_count == MCP_URI_TRIE_MAX_PARAMS) {
+                node = NULL;
+                break;
+            }
+
+            names[name_count] = copy_range(p + 1, (size_t)(close - p - 1));
+            if (!names[name_count]) {
+                node = NULL;
+                break;
+            }
+            name_count++;
+
+            if (!node->param && !(node->param = node_create())) {
+                node = NULL;
+                break;
+            }
+            node = node->param;
+            p = close + 1;
+        } else {
+            size_t length = strcspn(p, "{}");
+            if (length == 0) {      // Stray '}'
+                node = NULL;
+                break;
+            }
+            node = insert_literal(node, p, length);
+            p += length;
+        }
+    }
+
+    if (!node || node->value) {
+        for (size_t i = 0; i < name_count; i++) {
+            free(names[i]);
+        }
+        return -1;
+    }
+
+    if (name_count > 0) {
+        node->names = malloc(name_count * sizeof(char*));
+        if (!node->names) {
+            for (size_t i = 0; i < name_count; i++) {
+                free(names[i]);
+            }
+            return -1;
+        }
+        memcpy(node->names, names, name_count * sizeof(char*));
+    }
+
+    node->name_count = name_count;
+    node->value = value;
+    trie->count++;
+    return 0;
+}
+
+static int match_terminal(const mcp_uri_trie_node_t *node, size_t depth, mcp_uri_trie_match_t *match) {
+    if (!node->value || node->name_count != depth) return 0;
+
+    match->value = node->value;
+    match->names = (const char *const *)node->names;
+    match->param_count = depth;
+    return 1;
+}
+
+static int match_node(const mcp_uri_trie_node_t *node, const char *uri, size_t pos, size_t length,
+                      size_t depth, mcp_uri_trie_match_t *match) {
+    if (pos == length && match_terminal(node, depth, match)) {
+        return 1;
+    }
+
+    // Literal edges first - at most one can start with the next byte
+    if (pos < length) {
+        for (size_t i = 0; i < node->edge_count; i++) {
+            const mcp_uri_trie_edge_t *edge = &node->edges[i];
+            if (edge->label[0] != uri[pos]) continue;
+
+            if (edge->length <= length - pos && memcmp(edge->label, uri + pos, edge->length) == 0 &&
+                match_node(edge->child, uri, pos + edge->length, length, depth, match)) {
+                return 1;
+            }
+            break;
+        }
+    }
+
+    if (!node->param || depth == MCP_URI_TRIE_MAX_PARAMS) {
+        return 0;
+    }
+
+    // Segment parameter: longest non-empty run without '/' that lets the rest match
+    size_t segment_end = pos;
+    while (segment_end < length && uri[segment_end] != '/') {
+        segment_end++;
+    }
+    for (size_t end = segment_end; end > pos; end--) {
+        match->params[depth].data = uri + pos;
+        match->params[depth].length = end - pos;
+        if (match_node(node->param, uri, end, length, depth + 1, match)) {
+            return 1;
+        }
+    }
+
+    // Trailing parameter takes everything that is left
+    match->params[depth].data = uri + pos;
+    match->params[depth].length = length - pos;
+    return match_terminal(node->param, depth + 1, match);
+}
+
+int mcp_uri_trie_match(const mcp_uri_trie_t *trie, const char *uri, mcp_uri_trie_match_t *match) {
+    if (!trie || !trie->root || !uri || !match) return 0;
+
+    return match_node(trie->root, uri, 0, strlen(uri), 0, match);
+}
@@ -0,0 +1,64 @@
+#ifndef URI_TRIE_H
+#define URI_TRIE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Compiled URI templates. Each template ("file:///{path}", "db://{table}/{id}")
+ * is split into literal runs and {name} expressions and inserted into a radix
+ * trie, so matching a URI and extracting its parameters is a single walk.
+ *
+ * A {name} followed by more template text captures one non-empty path segment
+ * (no '/'); a trailing {name} captures the rest of the URI. Literal edges are
+ * preferred over parameters, so the most specific template wins.
+ */
+
+#define MCP_URI_TRIE_MAX_PARAMS 8
+
+typedef struct mcp_uri_trie_node mcp_uri_trie_node_t;
+
+typedef struct {
+    mcp_uri_trie_node_t *root;
+    size_t count;                   // Number of inserted templates
+} mcp_uri_trie_t;
+
+/**
+ * Captured parameter value - points into the matched URI, not NUL-terminated
+ */
+typedef struct {
+    const char *data;
+    size_t length;
+} mcp_uri_slice_t;
+
+typedef struct {
+    void *value;                                // Value passed to insert
+    const char *const *names;                   // Parameter names, in template order
+    mcp_uri_slice_t params[MCP_URI_TRIE_MAX_PARAMS];
+    size_t param_count;
+} mcp_uri_trie_match_t;
+
+void mcp_uri_trie_init(mcp_uri_trie_t *trie);
+void mcp_uri_trie_destroy(mcp_uri_trie_t *trie);
+
+/**
+ * Compile a template into the trie
+ * @return 0 on success, -1 if the template is malformed, has too many
+ *         parameters, is already present, or on allocation failure
+ */
+int mcp_uri_trie_insert(mcp_uri_trie_t *trie, const char *uri_template, void *value);
+
+/**
+ * Match a URI against all compiled templates
+ * @return 1 on a match (filled in match), 0 otherwise
+ */
+int mcp_uri_trie_match(const mcp_uri_trie_t *trie, const char *uri, mcp_uri_trie_match_t *match);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // URI_TRIE_H
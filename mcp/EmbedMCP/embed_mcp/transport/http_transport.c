@@ -2,61 +2,408 @@
 #include "hal/platform_hal.h"
 #include "utils/logging.h"
 #include "protocol/message.h"
-#include "protocol/jsonrpc.h"
+#include "utils/metrics.h"
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
+struct mcp_http_connection {
+    mcp_connection_t base;
+    mcp_http_connection_t *prev;  // 活跃链表
+    mcp_http_connection_t *next;  // 活跃链表或空闲链表
+    char session_id[MCP_HTTP_SESSION_ID_MAX];   // 当前请求的 Mcp-Session-Id，base.session_id 指向这里
+};
+
+// 从空闲链表取出(或新建)连接对象，加入活跃链表
+static mcp_http_connection_t* http_connection_acquire(mcp_http_event_loop_t* loop,
+                                                      mcp_hal_connection_t hal_conn, time_t now) {
+    mcp_http_transport_data_t* data = loop->data;
+    mcp_http_connection_t* conn = loop->free_connections;
+    if (conn) {
+        loop->free_connections = conn->next;
+        loop->free_connection_count--;
+        memset(conn, 0, sizeof(*conn));
+    } else {
+        conn = calloc(1, sizeof(mcp_http_connection_t));
+        if (!conn) {
+            return NULL;
+        }
+    }
+
+    conn->base.transport = data->transport;
+    conn->base.is_active = true;
+    conn->base.created_time = now;
+    conn->base.private_data = (void*)hal_conn;  // 保存HAL连接
+
+    conn->next = loop->live_connections;
+    if (conn->next) conn->next->prev = conn;
+    loop->live_connections = conn;
+    __atomic_add_fetch(&loop->connections_opened, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&loop->connections_open, 1, __ATOMIC_RELAXED);
+
+    if (data->transport->on_connection_opened) {
+        data->transport->on_connection_opened(&conn->base, data->transport->user_data);
+    }
+    return conn;
+}
+
+// 从活跃链表移除，放回空闲链表(超过上限时释放)
+static void http_connection_release(mcp_http_event_loop_t* loop, mcp_http_connection_t* conn) {
+    mcp_http_transport_data_t* data = loop->data;
+    conn->base.is_active = false;
+    if (data->transport->on_connection_closed) {
+        data->transport->on_connection_closed(&conn->base, data->transport->user_data);
+    }
+
+    if (conn->prev) conn->prev->next = conn->next;
+    else loop->live_connections = conn->next;
+    if (conn->next) conn->next->prev = conn->prev;
+    __atomic_sub_fetch(&loop->connections_open, 1, __ATOMIC_RELAXED);
+
+    if (loop->free_connection_count < MCP_HTTP_CONNECTION_POOL_MAX) {
+        conn->prev = NULL;
+        conn->next = loop->free_connections;
+        loop->free_connections = conn;
+        loop->free_connection_count++;
+    } else {
+        free(conn);
+    }
+}
+
+// HAL通知连接关闭(事件循环线程)
+static void http_connection_closed(void* connection_data, void* user_data) {
+    http_connection_release((mcp_http_event_loop_t*)user_data, (mcp_http_connection_t*)connection_data);
+}
+
+// 一个MCP请求得到了响应(或202)
+static void http_request_done(mcp_http_transport_data_t* data) {
+    size_t pending = __atomic_load_n(&data->active_connections, __ATOMIC_RELAXED);
+    while (pending > 0 &&
+           !__atomic_compare_exchange_n(&data->active_connections, &pending, pending - 1,
+                                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// 汇总所有事件循环的统计
+typedef struct {
+    size_t total_requests;
+    size_t metrics_requests;
+    size_t connections_opened;
+    size_t connections_open;
+    size_t keepalive_requests;
+} http_loop_totals_t;
+
+static void http_sum_loops(mcp_http_transport_data_t* data, http_loop_totals_t* totals,
+                           mcp_histogram_t* request_sizes) {
+    memset(totals, 0, sizeof(*totals));
+    if (request_sizes) {
+        mcp_histogram_reset(request_sizes);
+    }
+    for (size_t i = 0; i < data->loop_count; i++) {
+        mcp_http_event_loop_t* loop = &data->loops[i];
+        totals->total_requests += __atomic_load_n(&loop->total_requests, __ATOMIC_RELAXED);
+        totals->metrics_requests += __atomic_load_n(&loop->metrics_requests, __ATOMIC_RELAXED);
+        totals->connections_opened += __atomic_load_n(&loop->connections_opened, __ATOMIC_RELAXED);
+        totals->connections_open += __atomic_load_n(&loop->connections_open, __ATOMIC_RELAXED);
+        totals->keepalive_requests += __atomic_load_n(&loop->keepalive_requests, __ATOMIC_RELAXED);
+        if (request_sizes) {
+            mcp_histogram_merge(request_sizes, &loop->request_sizes);
+        }
+    }
+}
+
+static int http_write_transport_metrics(mcp_http_transport_data_t* data, mcp_json_buffer_t* out) {
+    http_loop_totals_t totals;
+    mcp_histogram_t request_sizes;
+    http_sum_loops(data, &totals, &request_sizes);
+
+    if (mcp_metrics_write_family(out, "embedmcp_http_requests", MCP_METRICS_COUNTER,
+                                 "MCP requests received over HTTP") != 0 ||
+        mcp_metrics_write_counter(out, "embedmcp_http_requests", NULL, NULL, totals.total_requests) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_requests_in_flight", MCP_METRICS_GAUGE,
+                                 "MCP requests waiting for their response") != 0 ||
+        mcp_metrics_write_gauge(out, "embedmcp_http_requests_in_flight", NULL, NULL,
+                                (double)__atomic_load_n(&data->active_connections, __ATOMIC_RELAXED)) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_request_size_bytes", MCP_METRICS_HISTOGRAM,
+                                 "Size of MCP request bodies") != 0 ||
+        mcp_metrics_write_histogram(out, "embedmcp_http_request_size_bytes", NULL, NULL,
+                                    &request_sizes, MCP_METRICS_UNIT_BYTES) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_event_loops", MCP_METRICS_GAUGE,
+                                 "Event loop threads serving the HTTP port") != 0 ||
+        mcp_metrics_write_gauge(out, "embedmcp_http_event_loops", NULL, NULL, (double)data->loop_count) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_connections_opened", MCP_METRICS_COUNTER,
+                                 "HTTP connections that sent an MCP request") != 0 ||
+        mcp_metrics_write_counter(out, "embedmcp_http_connections_opened", NULL, NULL,
+                                  totals.connections_opened) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_connections", MCP_METRICS_GAUGE,
+                                 "Open HTTP connections that sent an MCP request") != 0 ||
+        mcp_metrics_write_gauge(out, "embedmcp_http_connections", NULL, NULL,
+                                (double)totals.connections_open) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_keepalive_requests", MCP_METRICS_COUNTER,
+                                 "MCP requests on an already open connection") != 0 ||
+        mcp_metrics_write_counter(out, "embedmcp_http_keepalive_requests", NULL, NULL,
+                                  totals.keepalive_requests) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_streamed_responses", MCP_METRICS_COUNTER,
+                                 "MCP responses sent as an event stream") != 0 ||
+        mcp_metrics_write_counter(out, "embedmcp_http_streamed_responses", NULL, NULL,
+                                  __atomic_load_n(&data->streamed_responses, __ATOMIC_RELAXED)) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_compressed_responses", MCP_METRICS_COUNTER,
+                                 "MCP responses sent with a Content-Encoding") != 0 ||
+        mcp_metrics_write_counter(out, "embedmcp_http_compressed_responses", NULL, NULL,
+                                  __atomic_load_n(&data->compressed_responses, __ATOMIC_RELAXED)) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_compression_cache_hits", MCP_METRICS_COUNTER,
+                                 "Compressed responses that reused a cached compressed body") != 0 ||
+        mcp_metrics_write_counter(out, "embedmcp_http_compression_cache_hits", NULL, NULL,
+                                  __atomic_load_n(&data->compression_cache_hits, __ATOMIC_RELAXED)) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_compressed_input_bytes", MCP_METRICS_COUNTER,
+                                 "Size of compressed responses before compression") != 0 ||
+        mcp_metrics_write_counter(out, "embedmcp_http_compressed_input_bytes", NULL, NULL,
+                                  __atomic_load_n(&data->compressed_bytes_in, __ATOMIC_RELAXED)) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_compressed_output_bytes", MCP_METRICS_COUNTER,
+                                 "Size of compressed responses on the wire") != 0 ||
+        mcp_metrics_write_counter(out, "embedmcp_http_compressed_output_bytes", NULL, NULL,
+                                  __atomic_load_n(&data->compressed_bytes_out, __ATOMIC_RELAXED)) != 0 ||
+        mcp_metrics_write_family(out, "embedmcp_http_metrics_scrapes", MCP_METRICS_COUNTER,
+                                 "Requests for /metrics") != 0 ||
+        mcp_metrics_write_counter(out, "embedmcp_http_metrics_scrapes", NULL, NULL, totals.metrics_requests) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// GET /metrics - 在轮询线程上渲染，响应体指向复用缓冲区，由HAL在返回后立即发送
+static void http_serve_metrics(mcp_http_event_loop_t* loop, mcp_http_metrics_handler_t handler,
+                               void* user_data, mcp_hal_http_response_t* response) {
+    mcp_http_transport_data_t* data = loop->data;
+    mcp_json_buffer_t* out = &loop->metrics_buffer;
+    mcp_json_buffer_reset(out);
+    __atomic_add_fetch(&loop->metrics_requests, 1, __ATOMIC_RELAXED);
+
+    int result = http_write_transport_metrics(data, out);
+    if (result == 0 && handler) {
+        result = handler(out, user_data);
+    }
+    if (result == 0) {
+        result = mcp_metrics_write_eof(out);
+    }
+
+    if (result != 0) {
+        mcp_log_error("HTTP Transport: Failed to render metrics");
+        response->status_code = 500;
+        response->headers = "Content-Type: text/plain\r\n";
+        response->body = "Internal Server Error";
+        response->body_len = strlen(response->body);
+        return;
+    }
+
+    response->status_code = 200;
+    response->headers = "Content-Type: " MCP_METRICS_CONTENT_TYPE "\r\n";
+    response->body = out->data;
+    response->body_len = out->length;
+}
+
+// 查找路径与uri前uri_len个字符相同的路由，调用者持有routes_lock
+static const mcp_http_route_t* http_find_route(const mcp_http_transport_data_t* data,
+                                               const char* uri, size_t uri_len) {
+    for (size_t i = 0; i < data->route_count; i++) {
+        const mcp_http_route_t* route = &data->routes[i];
+        if (route->path_len == uri_len && memcmp(route->path, uri, uri_len) == 0) {
+            return route;
+        }
+    }
+    return NULL;
+}
+
+// 请求所在连接的连接对象：keep-alive连接复用第一个请求时取得的对象；
+// 同时记录本次请求的 Mcp-Session-Id。内存不足时返回NULL
+static mcp_http_connection_t* http_request_connection(mcp_http_event_loop_t* loop,
+                                                      const mcp_hal_http_request_t* request,
+                                                      time_t now) {
+    mcp_http_connection_t* conn = request->connection_data ? *request->connection_data : NULL;
+    if (conn) {
+        __atomic_add_fetch(&loop->keepalive_requests, 1, __ATOMIC_RELAXED);
+    } else {
+        conn = http_connection_acquire(loop, request->connection, now);
+        if (!conn) {
+            return NULL;
+        }
+        if (request->connection_data) {
+            *request->connection_data = conn;
+        }
+    }
+
+    mcp_connection_t* connection = &conn->base;
+    connection->flags = 0;
+    connection->session_id = NULL;
+    if (request->session_id) {
+        size_t session_len = strlen(request->session_id);
+        if (session_len < sizeof(conn->session_id)) {
+            memcpy(conn->session_id, request->session_id, session_len + 1);
+            connection->session_id = conn->session_id;
+        }
+    }
+    connection->last_activity = now;
+    return conn;
+}
+
+static void http_internal_error(mcp_hal_http_response_t* response) {
+    mcp_log_error("HTTP Transport: Failed to allocate connection");
+    response->status_code = 500;
+    response->headers = "Content-Type: application/json\r\n";
+    response->body = "{\"error\":\"Internal server error\"}";
+    response->body_len = strlen(response->body);
+}
+
+// 一个MCP请求(POST请求体)交给on_message；返回false表示没有可处理的内容
+static bool http_dispatch_request(mcp_http_event_loop_t* loop, const mcp_hal_http_request_t* request,
+                                  mcp_hal_http_response_t* response,
+                                  mcp_message_received_callback_t on_message, void* user_data) {
+    mcp_http_transport_data_t* data = loop->data;
+
+    // 请求体原样交给协议层，只解析一次：请求、通知(回复202)和批量都由解析结果分派，
+    // 这里不再预先扫描请求体
+    if (request->body && request->body_len > 0) {
+        // 超过max_request_size的请求体不交给协议层，直接回复413
+        if (data->max_request_size > 0 && request->body_len > data->max_request_size) {
+            mcp_log_warn("HTTP Transport: Request body of %zu bytes exceeds %zu, rejected",
+                         request->body_len, data->max_request_size);
+            response->status_code = 413;
+            response->headers = "Content-Type: application/json\r\n";
+            response->body = "{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32000,"
+                             "\"message\":\"Request body too large\",\"data\":{\"retryable\":false}}}";
+            response->body_len = strlen(response->body);
+            return true;
+        }
+
+        time_t now = time(NULL);
+
+        mcp_http_connection_t* conn = http_request_connection(loop, request, now);
+        if (!conn) {
+            http_internal_error(response);
+            return true;
+        }
+
+        mcp_connection_t* connection = &conn->base;
+        if (request->accept && strstr(request->accept, "text/event-stream") &&
+            data->hal->network.http_stream_begin) {
+            connection->flags |= MCP_CONNECTION_FLAG_EVENT_STREAM;
+        }
+        if (data->compression_threshold > 0) {
+            switch (mcp_compress_negotiate(request->accept_encoding)) {
+                case MCP_COMPRESS_GZIP: connection->flags |= MCP_CONNECTION_FLAG_GZIP; break;
+                case MCP_COMPRESS_DEFLATE: connection->flags |= MCP_CONNECTION_FLAG_DEFLATE; break;
+                default: break;
+            }
+        }
+        connection->messages_received++;
+        connection->bytes_received += request->body_len;
+
+        __atomic_add_fetch(&loop->total_requests, 1, __ATOMIC_RELAXED);
+        // 其他事件循环渲染 /metrics 时会同时读取
+        if (data->loop_count > 1) {
+            mcp_histogram_record_atomic(&loop->request_sizes, request->body_len);
+        } else {
+            mcp_histogram_record(&loop->request_sizes, request->body_len);
+        }
+        __atomic_add_fetch(&data->active_connections, 1, __ATOMIC_RELAXED);
+
+        // 调用消息接收回调
+        if (on_message) {
+            on_message(request->body, request->body_len, connection, user_data);
+        }
+
+        // 连接对象只在回调期间有效，异步处理方需自行复制(HAL连接句柄可跨线程持有)；
+        // HAL不跟踪连接生命周期时每个请求结束即归还
+        if (!request->connection_data) {
+            http_connection_release(loop, conn);
+        }
+
+        // 延迟响应 - 不设置响应内容，等待send函数调用
+        response->status_code = 0;  // 特殊标记表示延迟响应
+        return true;
+    }
+    return false;
+}
+
+// GET <endpoint>：客户端为服务器主动发送的消息(如 list_changed 通知)打开的SSE流。
+// 连接对象交给stream_handler，由它开始事件流或回复错误；流一直保持到客户端断开
+// 或 mcp_http_transport_stream_end()。HAL不支持分块发送或不跟踪连接时回复405
+static void http_open_stream(mcp_http_event_loop_t* loop, const mcp_hal_http_request_t* request,
+                             mcp_hal_http_response_t* response) {
+    mcp_http_transport_data_t* data = loop->data;
+
+    if (!data->stream_handler || !data->hal->network.http_stream_begin || !request->connection_data ||
+        !request->accept || !strstr(request->accept, "text/event-stream")) {
+        response->status_code = 405;
+        response->headers = "Allow: POST\r\nContent-Type: text/plain\r\n";
+        response->body = "Method Not Allowed";
+        response->body_len = strlen(response->body);
+        return;
+    }
+
+    mcp_http_connection_t* conn = http_request_connection(loop, request, time(NULL));
+    if (!conn) {
+        http_internal_error(response);
+        return;
+    }
+    conn->base.flags = MCP_CONNECTION_FLAG_EVENT_STREAM;
+
+    __atomic_add_fetch(&loop->total_requests, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&data->active_connections, 1, __ATOMIC_RELAXED);
+    data->stream_handler(&conn->base, data->stream_user_data);
+
+    response->status_code = 0;  // 延迟响应
+}
+
 // HTTP请求处理函数 - 通过HAL接口
 static void http_request_handler(const mcp_hal_http_request_t* request,
                                 mcp_hal_http_response_t* response,
                                 void* user_data) {
-    mcp_http_transport_data_t* data = (mcp_http_transport_data_t*)user_data;
+    mcp_http_event_loop_t* loop = (mcp_http_event_loop_t*)user_data;
+    mcp_http_transport_data_t* data = loop->data;
 
     mcp_log_debug("HTTP Transport: Received %s request to %s", request->method, request->uri);
 
-    // 检查是否为POST请求到/mcp端点
-    if (strcmp(request->method, "POST") == 0 && strcmp(request->uri, "/mcp") == 0) {
-
-        // 处理notifications/initialized
-        if (request->body && strstr(request->body, "notifications/initialized")) {
-            mcp_log_debug("HTTP Transport: Received notifications/initialized");
-            response->status_code = 202;
-            response->headers = "Content-Type: application/json\r\nAccess-Control-Allow-Origin: *\r\n";
-            response->body = "";
-            response->body_len = 0;
-            return;
-        }
-
-        // 检查是否为MCP请求
-        if (request->body && strstr(request->body, "\"method\"")) {
-            // 创建连接对象
-            mcp_connection_t* connection = calloc(1, sizeof(mcp_connection_t));
-            if (!connection) {
-                mcp_log_error("HTTP Transport: Failed to allocate connection");
-                response->status_code = 500;
-                response->headers = "Content-Type: application/json\r\n";
-                response->body = "{\"error\":\"Internal server error\"}";
-                response->body_len = strlen(response->body);
-                return;
-            }
+    bool is_get = strcmp(request->method, "GET") == 0;
+    bool is_post = strcmp(request->method, "POST") == 0;
+
+    if (is_get && strcmp(request->uri, "/metrics") == 0) {
+        http_serve_metrics(loop, data->metrics_handler, data->metrics_user_data, response);
+        return;
+    }
 
-            // 初始化连接对象
-            connection->transport = data->transport;
-            connection->is_active = true;
-            connection->created_time = time(NULL);
-            connection->last_activity = time(NULL);
-            connection->private_data = (void*)request->connection;  // 保存HAL连接
+    // 路由的注册方在注销返回后不会再收到请求：分派期间持有读锁
+    bool handled = false;
+    pthread_rwlock_rdlock(&data->routes_lock);
+    if (data->route_count > 0) {
+        static const char metrics_suffix[] = "/metrics";
+        const size_t suffix_len = sizeof(metrics_suffix) - 1;
+        size_t uri_len = strlen(request->uri);
+        const mcp_http_route_t* route = NULL;
 
-            // 调用消息接收回调
-            if (data->transport->on_message) {
-                data->transport->on_message(request->body, request->body_len, connection, data->transport->user_data);
+        if (is_post) {
+            route = http_find_route(data, request->uri, uri_len);
+            handled = route && http_dispatch_request(loop, request, response,
+                                                     route->on_message, route->user_data);
+        } else if (is_get && uri_len > suffix_len &&
+                   strcmp(request->uri + uri_len - suffix_len, metrics_suffix) == 0) {
+            // GET <path>/metrics
+            route = http_find_route(data, request->uri, uri_len - suffix_len);
+            if (route) {
+                http_serve_metrics(loop, route->metrics_handler, route->user_data, response);
+                handled = true;
             }
-
-            // 延迟响应 - 不设置响应内容，等待send函数调用
-            response->status_code = 0;  // 特殊标记表示延迟响应
-            return;
         }
+    } else if (is_post && strcmp(request->uri, data->endpoint_path) == 0) {
+        handled = http_dispatch_request(loop, request, response,
+                                        data->transport->on_message, data->transport->user_data);
+    } else if (is_get && strcmp(request->uri, data->endpoint_path) == 0) {
+        http_open_stream(loop, request, response);
+        handled = true;
+    }
+    pthread_rwlock_unlock(&data->routes_lock);
+    if (handled) {
+        return;
     }
 
     // 默认404响应
@@ -106,13 +453,24 @@ int mcp_http_transport_init_impl(mcp_transport_t *transport, const mcp_transport
         if (config->config.http.bind_address) {
             transport->config->config.http.bind_address = strdup(config->config.http.bind_address);
         }
+        if (config->config.http.endpoint_path) {
+            transport->config->config.http.endpoint_path = strdup(config->config.http.endpoint_path);
+        }
     }
 
     // Initialize HTTP data
     data->port = config->config.http.port;
     data->bind_address = config->config.http.bind_address ? strdup(config->config.http.bind_address) : strdup("0.0.0.0");
+    data->endpoint_path = strdup(config->config.http.endpoint_path ? config->config.http.endpoint_path : "/mcp");
     data->enable_cors = config->config.http.enable_cors;
     data->max_request_size = config->config.http.max_request_size;
+    data->compression_threshold = mcp_compress_available() ? config->config.http.compression_threshold : 0;
+    data->compression_level = config->config.http.compression_level;
+    pthread_mutex_init(&data->compression_mutex, NULL);
+    pthread_rwlock_init(&data->routes_lock, NULL);
+    data->event_loops = config->config.http.event_loops;
+    if (data->event_loops < 1) data->event_loops = 1;
+    if (data->event_loops > MCP_HTTP_EVENT_LOOPS_MAX) data->event_loops = MCP_HTTP_EVENT_LOOPS_MAX;
     data->server_running = false;
     data->transport = transport;
 
@@ -123,6 +481,50 @@ int mcp_http_transport_init_impl(mcp_transport_t *transport, const mcp_transport
     return 0;
 }
 
+// 第1个之后的事件循环各自的轮询线程
+static void *http_event_loop_thread(void *arg) {
+    mcp_http_event_loop_t *loop = (mcp_http_event_loop_t*)arg;
+    const mcp_platform_hal_t *hal = loop->data->hal;
+
+    while (__atomic_load_n(&loop->running, __ATOMIC_ACQUIRE)) {
+        if (hal->network.http_server_poll(loop->server, -1) != 0) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// 停止事件循环的HAL服务器并归还它的连接对象(该循环已不再被轮询)
+static void http_event_loop_stop(mcp_http_transport_data_t *data, mcp_http_event_loop_t *loop) {
+    if (loop->server) {
+        if (data->hal->network.http_server_set_close_handler) {
+            data->hal->network.http_server_set_close_handler(loop->server, NULL);
+        }
+        data->hal->network.http_server_stop(loop->server);
+        loop->server = NULL;
+    }
+
+    // HAL已忘记连接槽，剩余的连接对象在这里归还
+    while (loop->live_connections) {
+        http_connection_release(loop, loop->live_connections);
+    }
+}
+
+static void http_event_loops_free(mcp_http_transport_data_t *data) {
+    for (size_t i = 0; i < data->loop_count; i++) {
+        mcp_http_event_loop_t *loop = &data->loops[i];
+        while (loop->free_connections) {
+            mcp_http_connection_t *next = loop->free_connections->next;
+            free(loop->free_connections);
+            loop->free_connections = next;
+        }
+        mcp_json_buffer_free(&loop->metrics_buffer);
+    }
+    free(data->loops);
+    data->loops = NULL;
+    data->loop_count = 0;
+}
+
 int mcp_http_transport_start_impl(mcp_transport_t *transport) {
     if (!transport || !transport->private_data) {
         mcp_log_error("HTTP Transport: Invalid parameters for start");
@@ -136,21 +538,71 @@ int mcp_http_transport_start_impl(mcp_transport_t *transport) {
         return 0;
     }
 
+    // 多个事件循环需要HAL为每个服务器提供独立的循环；端口0时各监听器会拿到不同端口
+    size_t loop_count = (size_t)data->event_loops;
+    if (loop_count > 1 && (!data->hal->network.http_server_start_ex ||
+                           !data->hal->network.http_server_poll || data->port == 0)) {
+        mcp_log_warn("HTTP Transport: %zu event loops not supported here, using one", loop_count);
+        loop_count = 1;
+    }
+
+    // 统计在运行之间保留，只在第一次启动时分配
+    if (!data->loops) {
+        data->loops = calloc(loop_count, sizeof(mcp_http_event_loop_t));
+        if (!data->loops) {
+            mcp_log_error("HTTP Transport: Failed to allocate event loops");
+            return -1;
+        }
+        data->loop_count = loop_count;
+        for (size_t i = 0; i < loop_count; i++) {
+            data->loops[i].data = data;
+            mcp_json_buffer_init(&data->loops[i].metrics_buffer);
+        }
+    }
+
     // 构建监听地址
     char listen_url[512];
     snprintf(listen_url, sizeof(listen_url), "http://%s:%d", data->bind_address, data->port);
 
-    // 通过HAL启动HTTP服务器 - 使用通用接口名称
-    data->server = data->hal->network.http_server_start(listen_url, http_request_handler, data);
-    if (!data->server) {
-        mcp_log_error("HTTP Transport: Failed to start server on %s", listen_url);
-        return -1;
+    // 通过HAL启动HTTP服务器 - 使用通用接口名称；每个事件循环一个监听器
+    for (size_t i = 0; i < data->loop_count; i++) {
+        mcp_http_event_loop_t *loop = &data->loops[i];
+        loop->server = data->loop_count > 1
+            ? data->hal->network.http_server_start_ex(listen_url, MCP_HAL_SERVER_REUSE_PORT,
+                                                      http_request_handler, loop)
+            : data->hal->network.http_server_start(listen_url, http_request_handler, loop);
+        if (!loop->server) {
+            mcp_log_error("HTTP Transport: Failed to start server on %s", listen_url);
+            break;
+        }
+
+        // 连接对象随HAL连接关闭归还
+        if (data->hal->network.http_server_set_close_handler) {
+            data->hal->network.http_server_set_close_handler(loop->server, http_connection_closed);
+        }
+
+        __atomic_store_n(&loop->running, true, __ATOMIC_RELEASE);
+        if (i > 0) {
+            if (pthread_create(&loop->thread, NULL, http_event_loop_thread, loop) != 0) {
+                mcp_log_error("HTTP Transport: Failed to start event loop thread");
+                __atomic_store_n(&loop->running, false, __ATOMIC_RELEASE);
+                http_event_loop_stop(data, loop);
+                break;
+            }
+            loop->has_thread = true;
+        }
     }
 
     data->server_running = true;
+    if (!data->loops[data->loop_count - 1].server) {
+        mcp_http_transport_stop_impl(transport);
+        return -1;
+    }
+
     transport->state = MCP_TRANSPORT_STATE_RUNNING;
 
-    mcp_log_info("HTTP Transport: Server started on %s:%d", data->bind_address, data->port);
+    mcp_log_info("HTTP Transport: Server started on %s:%d (%zu event loop%s)", data->bind_address,
+                 data->port, data->loop_count, data->loop_count == 1 ? "" : "s");
     return 0;
 }
 
@@ -165,10 +617,20 @@ int mcp_http_transport_stop_impl(mcp_transport_t *transport) {
         return 0;
     }
 
+    // 先让其他事件循环的线程退出，再在这里停止它们的服务器
+    for (size_t i = 0; i < data->loop_count; i++) {
+        mcp_http_event_loop_t *loop = &data->loops[i];
+        __atomic_store_n(&loop->running, false, __ATOMIC_RELEASE);
+        if (loop->has_thread) {
+            data->hal->network.http_server_wakeup(loop->server);
+            pthread_join(loop->thread, NULL);
+            loop->has_thread = false;
+        }
+    }
+
     // 通过HAL停止服务器 - 使用通用接口名称
-    if (data->server) {
-        data->hal->network.http_server_stop(data->server);
-        data->server = NULL;
+    for (size_t i = 0; i < data->loop_count; i++) {
+        http_event_loop_stop(data, &data->loops[i]);
     }
 
     data->server_running = false;
@@ -178,6 +640,149 @@ int mcp_http_transport_stop_impl(mcp_transport_t *transport) {
     return 0;
 }
 
+#define HTTP_JSON_HEADERS \
+    "Content-Type: application/json\r\n" \
+    "Access-Control-Allow-Origin: *\r\n" \
+    "Access-Control-Allow-Headers: Content-Type, Authorization, Mcp-Session-Id, Mcp-Protocol-Version\r\n"
+#define HTTP_GZIP_HEADERS "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n"
+#define HTTP_DEFLATE_HEADERS "Content-Encoding: deflate\r\nVary: Accept-Encoding\r\n"
+#define HTTP_IOV(literal) { literal, sizeof(literal) - 1 }
+
+// HAL没有向量发送接口时拼接成一次普通发送(本文件只发送单段响应体)
+static int http_send_vectored(mcp_http_transport_data_t *data, mcp_hal_connection_t hal_conn,
+                              const mcp_hal_http_responsev_t *response) {
+    if (data->hal->network.http_response_sendv) {
+        return data->hal->network.http_response_sendv(hal_conn, response);
+    }
+
+    char headers[512];
+    size_t headers_len = 0;
+    for (size_t i = 0; i < response->header_count; i++) {
+        if (headers_len + response->headers[i].len >= sizeof(headers)) break;
+        memcpy(headers + headers_len, response->headers[i].data, response->headers[i].len);
+        headers_len += response->headers[i].len;
+    }
+    headers[headers_len] = '\0';
+
+    mcp_hal_http_response_t plain = {
+        .status_code = response->status_code,
+        .headers = headers,
+        .body = response->body_count > 0 ? response->body[0].data : "",
+        .body_len = response->body_count > 0 ? response->body[0].len : 0
+    };
+    int result = data->hal->network.http_response_send(hal_conn, &plain);
+    if (response->release) {
+        response->release(response->owner);
+    }
+    return result;
+}
+
+static mcp_compress_encoding_t http_connection_encoding(const mcp_connection_t *connection) {
+    if (connection->flags & MCP_CONNECTION_FLAG_GZIP) return MCP_COMPRESS_GZIP;
+    if (connection->flags & MCP_CONNECTION_FLAG_DEFLATE) return MCP_COMPRESS_DEFLATE;
+    return MCP_COMPRESS_NONE;
+}
+
+// 响应以 {"jsonrpc":"2.0","id":<id>,"result": 开头时返回该前缀的长度，否则返回0。
+// 前缀之后的内容与请求id无关，可以缓存其压缩结果
+static size_t http_response_prefix_length(const char *message, size_t length) {
+    static const char head[] = "{\"jsonrpc\":\"2.0\",\"id\":";
+    static const char result[] = ",\"result\":";
+    const size_t head_len = sizeof(head) - 1;
+    const size_t result_len = sizeof(result) - 1;
+
+    if (length < head_len || memcmp(message, head, head_len) != 0) {
+        return 0;
+    }
+    size_t limit = length < 256 ? length : 256;    // id不会很长
+    for (size_t i = head_len; i + result_len <= limit; i++) {
+        if (message[i] == ',' && memcmp(message + i, result, result_len) == 0) {
+            return i + result_len;
+        }
+    }
+    return 0;
+}
+
+// 在调用者持有compression_mutex时查找缓存
+static mcp_http_compression_entry_t *http_compression_lookup(mcp_http_transport_data_t *data,
+                                                             const char *body, size_t body_len) {
+    for (size_t i = 0; i < MCP_HTTP_COMPRESSION_CACHE_SLOTS; i++) {
+        mcp_http_compression_entry_t *entry = &data->compression_cache[i];
+        if (entry->body && entry->body_len == body_len && memcmp(entry->body, body, body_len) == 0) {
+            entry->last_used = ++data->compression_clock;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// 压缩后的内容存入最久未用的槽位，segment的缓冲区归缓存所有
+static void http_compression_store(mcp_http_transport_data_t *data, const char *body, size_t body_len,
+                                   mcp_compress_segment_t *segment) {
+    char *copy = malloc(body_len);
+    if (!copy) {
+        return;
+    }
+    memcpy(copy, body, body_len);
+
+    pthread_mutex_lock(&data->compression_mutex);
+    mcp_http_compression_entry_t *slot = &data->compression_cache[0];
+    for (size_t i = 1; i < MCP_HTTP_COMPRESSION_CACHE_SLOTS; i++) {
+        if (data->compression_cache[i].last_used < slot->last_used) {
+            slot = &data->compression_cache[i];
+        }
+    }
+    free(slot->body);
+    mcp_compress_segment_free(&slot->segment);
+    slot->body = copy;
+    slot->body_len = body_len;
+    slot->segment = *segment;
+    slot->last_used = ++data->compression_clock;
+    memset(segment, 0, sizeof(*segment));
+    pthread_mutex_unlock(&data->compression_mutex);
+}
+
+static int http_compress_response(mcp_http_transport_data_t *data, mcp_compress_encoding_t encoding,
+                                  const char *message, size_t length, mcp_json_buffer_t *out) {
+    size_t prefix_len = http_response_prefix_length(message, length);
+    const char *body = message + prefix_len;
+    size_t body_len = length - prefix_len;
+    if (prefix_len == 0 || body_len > MCP_HTTP_COMPRESSION_CACHE_MAX) {
+        return mcp_compress_buffer(out, encoding, message, length, data->compression_level);
+    }
+
+    mcp_compress_segment_t prefix = { 0 };
+    if (mcp_compress_segment(&prefix, message, prefix_len, data->compression_level, false) != 0) {
+        return -1;
+    }
+
+    int result;
+    pthread_mutex_lock(&data->compression_mutex);
+    mcp_http_compression_entry_t *entry = http_compression_lookup(data, body, body_len);
+    if (entry) {
+        const mcp_compress_segment_t *segments[2] = { &prefix, &entry->segment };
+        result = mcp_compress_assemble(out, encoding, segments, 2);
+        pthread_mutex_unlock(&data->compression_mutex);
+        __atomic_add_fetch(&data->compression_cache_hits, 1, __ATOMIC_RELAXED);
+    } else {
+        pthread_mutex_unlock(&data->compression_mutex);
+
+        mcp_compress_segment_t segment = { 0 };
+        result = mcp_compress_segment(&segment, body, body_len, data->compression_level, true);
+        if (result == 0) {
+            const mcp_compress_segment_t *segments[2] = { &prefix, &segment };
+            result = mcp_compress_assemble(out, encoding, segments, 2);
+        }
+        if (result == 0) {
+            http_compression_store(data, body, body_len, &segment);
+        }
+        mcp_compress_segment_free(&segment);
+    }
+
+    mcp_compress_segment_free(&prefix);
+    return result;
+}
+
 int mcp_http_transport_send_impl(mcp_connection_t *connection, const char *message, size_t length) {
     if (!connection || !message || length == 0) {
         return -1;
@@ -195,22 +800,198 @@ int mcp_http_transport_send_impl(mcp_connection_t *connection, const char *messa
         return -1;
     }
 
-    // 构造HAL响应
-    mcp_hal_http_response_t response = {
+    // 头部是预先确定长度的固定片段，响应体不拼接也不复制
+    mcp_hal_iovec_t headers[5] = { HTTP_IOV(HTTP_JSON_HEADERS) };
+    mcp_hal_iovec_t body = { message, length };
+    mcp_hal_http_responsev_t response = {
         .status_code = 200,
+        .headers = headers,
+        .header_count = 1,
+        .body = &body,
+        .body_count = 1
+    };
+
+    // 新建会话(initialize)的响应带上会话ID
+    if ((connection->flags & MCP_CONNECTION_FLAG_NEW_SESSION) && connection->session_id) {
+        static const mcp_hal_iovec_t session_name = HTTP_IOV("Mcp-Session-Id: ");
+        static const mcp_hal_iovec_t line_end = HTTP_IOV("\r\n");
+        headers[response.header_count++] = session_name;
+        headers[response.header_count].data = connection->session_id;
+        headers[response.header_count++].len = strlen(connection->session_id);
+        headers[response.header_count++] = line_end;
+    }
+
+    // 客户端接受压缩且响应足够大时压缩，压缩失败或没有变小则原样发送；
+    // 压缩结果的缓冲区转交给HAL，发送后由HAL释放
+    mcp_compress_encoding_t encoding = http_connection_encoding(connection);
+    mcp_json_buffer_t compressed;
+    mcp_json_buffer_init(&compressed);
+    if (encoding != MCP_COMPRESS_NONE && length >= data->compression_threshold &&
+        http_compress_response(data, encoding, message, length, &compressed) == 0 &&
+        compressed.length < length) {
+        static const mcp_hal_iovec_t gzip_headers = HTTP_IOV(HTTP_GZIP_HEADERS);
+        static const mcp_hal_iovec_t deflate_headers = HTTP_IOV(HTTP_DEFLATE_HEADERS);
+        headers[response.header_count++] = encoding == MCP_COMPRESS_GZIP ? gzip_headers : deflate_headers;
+        body.len = compressed.length;
+        body.data = mcp_json_buffer_detach(&compressed);
+        response.release = free;
+        response.owner = (void*)body.data;
+        __atomic_add_fetch(&data->compressed_responses, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&data->compressed_bytes_in, length, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&data->compressed_bytes_out, body.len, __ATOMIC_RELAXED);
+    }
+    mcp_json_buffer_free(&compressed);
+
+    // 通过HAL发送响应 - 使用通用接口名称
+    int result = http_send_vectored(data, hal_conn, &response);
+    http_request_done(data);
+    if (result > 0) {
+        mcp_log_debug("HTTP Transport: Sent response (%zu bytes, %zu on the wire)", length, body.len);
+    }
+
+    return result;
+}
+
+int mcp_http_transport_send_accepted(mcp_connection_t *connection) {
+    if (!connection || !connection->transport || !connection->transport->private_data) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)connection->transport->private_data;
+    mcp_hal_connection_t hal_conn = (mcp_hal_connection_t)connection->private_data;
+    if (!hal_conn) {
+        return -1;
+    }
+
+    // 只含通知/响应的请求没有应答内容，返回202结束延迟响应
+    mcp_hal_http_response_t response = {
+        .status_code = 202,
         .headers = "Content-Type: application/json\r\n"
+                  "Access-Control-Allow-Origin: *\r\n",
+        .body = "",
+        .body_len = 0
+    };
+
+    int result = data->hal->network.http_response_send(hal_conn, &response);
+    http_request_done(data);
+    return result;
+}
+
+int mcp_http_transport_send_status(mcp_connection_t *connection, int status_code,
+                                   const char *message, size_t length) {
+    if (!connection || !connection->transport || !connection->transport->private_data) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)connection->transport->private_data;
+    mcp_hal_connection_t hal_conn = (mcp_hal_connection_t)connection->private_data;
+    if (!hal_conn) {
+        return -1;
+    }
+
+    mcp_hal_http_response_t response = {
+        .status_code = status_code,
+        .headers = HTTP_JSON_HEADERS,
+        .body = message ? message : "",
+        .body_len = message ? length : 0
+    };
+
+    int result = data->hal->network.http_response_send(hal_conn, &response);
+    http_request_done(data);
+    return result;
+}
+
+int mcp_http_transport_stream_begin(mcp_connection_t *connection) {
+    if (!connection || !connection->transport || !connection->transport->private_data) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)connection->transport->private_data;
+    mcp_hal_connection_t hal_conn = (mcp_hal_connection_t)connection->private_data;
+    if (!hal_conn || !data->hal->network.http_stream_begin) {
+        return -1;
+    }
+
+    mcp_hal_http_response_t response = {
+        .status_code = 200,
+        .headers = "Content-Type: text/event-stream\r\n"
+                  "Cache-Control: no-cache\r\n"
                   "Access-Control-Allow-Origin: *\r\n"
                   "Access-Control-Allow-Headers: Content-Type, Authorization, Mcp-Session-Id, Mcp-Protocol-Version\r\n",
-        .body = message,
-        .body_len = length
+        .body = "",
+        .body_len = 0
     };
 
-    // 通过HAL发送响应 - 使用通用接口名称
-    int result = data->hal->network.http_response_send(hal_conn, &response);
-    if (result > 0) {
-        mcp_log_debug("HTTP Transport: Sent response (%zu bytes)", length);
+    int result = data->hal->network.http_stream_begin(hal_conn, &response);
+    if (result >= 0) {
+        __atomic_add_fetch(&data->streamed_responses, 1, __ATOMIC_RELAXED);
     }
+    return result;
+}
 
+int mcp_http_transport_stream_event(mcp_connection_t *connection, const char *message, size_t length) {
+    if (!connection || !message || length == 0 ||
+        !connection->transport || !connection->transport->private_data) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)connection->transport->private_data;
+    mcp_hal_connection_t hal_conn = (mcp_hal_connection_t)connection->private_data;
+    if (!hal_conn || !data->hal->network.http_stream_write) {
+        return -1;
+    }
+
+    // 一个事件一个分块；美化输出的JSON带换行，每行各占一个 data: 字段
+    mcp_json_buffer_t event;
+    mcp_json_buffer_init(&event);
+    int result = mcp_json_write_literal(&event, "event: message\n");
+    const char *line = message;
+    const char *end = message + length;
+    while (result == 0 && line < end) {
+        const char *newline = memchr(line, '\n', (size_t)(end - line));
+        size_t line_len = newline ? (size_t)(newline - line) : (size_t)(end - line);
+        if (mcp_json_write_literal(&event, "data: ") != 0 ||
+            mcp_json_write_raw(&event, line, line_len) != 0 ||
+            mcp_json_write_literal(&event, "\n") != 0) {
+            result = -1;
+        }
+        line = newline ? newline + 1 : end;
+    }
+    if (result == 0) {
+        result = mcp_json_write_literal(&event, "\n");
+    }
+    if (result == 0) {
+        result = data->hal->network.http_stream_write(hal_conn, event.data, event.length);
+    }
+    mcp_json_buffer_free(&event);
+
+    if (result >= 0) {
+        connection->messages_sent++;
+        connection->bytes_sent += length;
+    }
+    return result;
+}
+
+int mcp_http_transport_stream_end(mcp_connection_t *connection, const char *message, size_t length) {
+    if (!connection || !connection->transport || !connection->transport->private_data) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)connection->transport->private_data;
+    mcp_hal_connection_t hal_conn = (mcp_hal_connection_t)connection->private_data;
+    if (!hal_conn || !data->hal->network.http_stream_end) {
+        return -1;
+    }
+
+    int result = 0;
+    if (message && length > 0) {
+        result = mcp_http_transport_stream_event(connection, message, length);
+    }
+    // 最后一条消息发送失败也要结束响应
+    if (data->hal->network.http_stream_end(hal_conn) < 0) {
+        result = -1;
+    }
+    http_request_done(data);
     return result;
 }
 
@@ -238,8 +1019,10 @@ int mcp_http_transport_get_stats_impl(mcp_transport_t *transport, void *stats) {
         bool server_running;
     } *http_stats = stats;
 
-    http_stats->total_requests = data->total_requests;
-    http_stats->active_connections = data->active_connections;
+    http_loop_totals_t totals;
+    http_sum_loops(data, &totals, NULL);
+    http_stats->total_requests = totals.total_requests;
+    http_stats->active_connections = __atomic_load_n(&data->active_connections, __ATOMIC_RELAXED);
     http_stats->server_running = data->server_running;
 
     return 0;
@@ -256,8 +1039,19 @@ void mcp_http_transport_cleanup_impl(mcp_transport_t *transport) {
     mcp_http_transport_stop_impl(transport);
 
     // 释放资源
+    http_event_loops_free(data);
     free(data->bind_address);
     free(data->endpoint_path);
+    for (size_t i = 0; i < MCP_HTTP_COMPRESSION_CACHE_SLOTS; i++) {
+        free(data->compression_cache[i].body);
+        mcp_compress_segment_free(&data->compression_cache[i].segment);
+    }
+    pthread_mutex_destroy(&data->compression_mutex);
+    for (size_t i = 0; i < data->route_count; i++) {
+        free(data->routes[i].path);
+    }
+    free(data->routes);
+    pthread_rwlock_destroy(&data->routes_lock);
     free(data);
 
     transport->private_data = NULL;
@@ -265,8 +1059,99 @@ void mcp_http_transport_cleanup_impl(mcp_transport_t *transport) {
     mcp_log_info("HTTP Transport: Cleanup completed");
 }
 
-// 轮询函数 - 供主循环调用
-int mcp_http_transport_poll(mcp_transport_t *transport) {
+int mcp_http_transport_set_metrics_handler(mcp_transport_t *transport,
+                                           mcp_http_metrics_handler_t handler, void *user_data) {
+    if (!transport || !transport->private_data || transport->type != MCP_TRANSPORT_HTTP) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)transport->private_data;
+    data->metrics_handler = handler;
+    data->metrics_user_data = user_data;
+    return 0;
+}
+
+int mcp_http_transport_set_stream_handler(mcp_transport_t *transport,
+                                          mcp_connection_opened_callback_t handler, void *user_data) {
+    if (!transport || !transport->private_data || transport->type != MCP_TRANSPORT_HTTP) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)transport->private_data;
+    data->stream_handler = handler;
+    data->stream_user_data = user_data;
+    return 0;
+}
+
+int mcp_http_transport_add_route(mcp_transport_t *transport, const char *path,
+                                 mcp_message_received_callback_t on_message,
+                                 mcp_http_metrics_handler_t metrics_handler, void *user_data) {
+    if (!transport || !transport->private_data || transport->type != MCP_TRANSPORT_HTTP ||
+        !path || path[0] != '/' || !on_message) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)transport->private_data;
+    size_t path_len = strlen(path);
+    char *copy = strdup(path);
+    if (!copy) {
+        return -1;
+    }
+
+    int result = 0;
+    pthread_rwlock_wrlock(&data->routes_lock);
+    if (http_find_route(data, path, path_len) || strcmp(path, "/metrics") == 0) {
+        mcp_log_error("HTTP Transport: Route %s is already taken", path);
+        result = -1;
+    } else if (data->route_count == data->route_capacity) {
+        size_t capacity = data->route_capacity ? data->route_capacity * 2 : 8;
+        mcp_http_route_t *routes = realloc(data->routes, capacity * sizeof(mcp_http_route_t));
+        if (routes) {
+            data->routes = routes;
+            data->route_capacity = capacity;
+        } else {
+            result = -1;
+        }
+    }
+    if (result == 0) {
+        mcp_http_route_t *route = &data->routes[data->route_count++];
+        route->path = copy;
+        route->path_len = path_len;
+        route->on_message = on_message;
+        route->metrics_handler = metrics_handler;
+        route->user_data = user_data;
+        copy = NULL;
+    }
+    pthread_rwlock_unlock(&data->routes_lock);
+
+    free(copy);
+    return result;
+}
+
+int mcp_http_transport_remove_route(mcp_transport_t *transport, const char *path) {
+    if (!transport || !transport->private_data || transport->type != MCP_TRANSPORT_HTTP || !path) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)transport->private_data;
+    char *removed = NULL;
+
+    // 写锁等待正在分派到该路由的请求结束
+    pthread_rwlock_wrlock(&data->routes_lock);
+    const mcp_http_route_t *route = http_find_route(data, path, strlen(path));
+    if (route) {
+        size_t index = (size_t)(route - data->routes);
+        removed = data->routes[index].path;
+        data->routes[index] = data->routes[--data->route_count];
+    }
+    pthread_rwlock_unlock(&data->routes_lock);
+
+    free(removed);
+    return removed ? 0 : -1;
+}
+
+// 轮询函数 - 供主循环调用，timeout_ms < 0 时阻塞直到有网络事件或被唤醒
+int mcp_http_transport_poll(mcp_transport_t *transport, int timeout_ms) {
     if (!transport || !transport->private_data) {
         return -1;
     }
@@ -275,8 +1160,29 @@ int mcp_http_transport_poll(mcp_transport_t *transport) {
 
     // 通过HAL轮询 - 使用通用接口名称
     if (data->server_running && data->hal) {
-        return data->hal->network.network_poll(10); // 10ms超时
+        if (data->hal->network.http_server_poll) {
+            return data->hal->network.http_server_poll(data->loops[0].server, timeout_ms);
+        }
+        return data->hal->network.network_poll(timeout_ms);
     }
 
     return 0;
 }
+
+// 唤醒阻塞在mcp_http_transport_poll()中的主循环
+int mcp_http_transport_wakeup(mcp_transport_t *transport) {
+    if (!transport || !transport->private_data) {
+        return -1;
+    }
+
+    mcp_http_transport_data_t *data = (mcp_http_transport_data_t*)transport->private_data;
+
+    if (data->server_running && data->hal && data->hal->network.http_server_wakeup) {
+        return data->hal->network.http_server_wakeup(data->loops[0].server);
+    }
+    if (data->hal && data->hal->network.network_wakeup) {
+        return data->hal->network.network_wakeup();
+    }
+
+    return -1;
+}
@@ -3,9 +3,96 @@
 
 #include "transport_interface.h"
 #include "../hal/platform_hal.h"
+#include "../protocol/json_writer.h"
+#include "../utils/histogram.h"
+#include "../utils/compress.h"
+#include <pthread.h>
 
-// HTTP transport specific structures (使用HAL接口)
+// 池化的连接对象，与HAL连接(含keep-alive)同生命周期，定义在http_transport.c
+typedef struct mcp_http_connection mcp_http_connection_t;
+
+// Mcp-Session-Id 的最大长度(含结束符)，更长的值按没有会话处理
+#ifndef MCP_HTTP_SESSION_ID_MAX
+#define MCP_HTTP_SESSION_ID_MAX 160
+#endif
+
+// 空闲连接对象保留上限
+#ifndef MCP_HTTP_CONNECTION_POOL_MAX
+#define MCP_HTTP_CONNECTION_POOL_MAX 32
+#endif
+
+// 响应压缩默认值(需要 COMPRESSION=1 构建)：达到阈值的响应按 Accept-Encoding 压缩
+#ifndef MCP_HTTP_COMPRESSION_THRESHOLD
+#define MCP_HTTP_COMPRESSION_THRESHOLD 1024
+#endif
+#ifndef MCP_HTTP_COMPRESSION_LEVEL
+#define MCP_HTTP_COMPRESSION_LEVEL 6
+#endif
+
+// 压缩结果缓存：响应中id之后的部分(如 tools/list 的缓存列表)只压缩一次，
+// 之后的响应只压缩很短的前缀再拼接已压缩的数据。超过上限的响应不缓存
+#ifndef MCP_HTTP_COMPRESSION_CACHE_SLOTS
+#define MCP_HTTP_COMPRESSION_CACHE_SLOTS 4
+#endif
+#ifndef MCP_HTTP_COMPRESSION_CACHE_MAX
+#define MCP_HTTP_COMPRESSION_CACHE_MAX (256 * 1024)
+#endif
+
+typedef struct {
+    char *body;                       // 未压缩的内容(响应中 "result": 之后的部分)
+    size_t body_len;
+    mcp_compress_segment_t segment;   // 压缩后的内容，作为最后一段拼接
+    uint64_t last_used;
+} mcp_http_compression_entry_t;
+
+// 事件循环数上限(见 mcp_transport_config_t 的 event_loops)
+#ifndef MCP_HTTP_EVENT_LOOPS_MAX
+#define MCP_HTTP_EVENT_LOOPS_MAX 16
+#endif
+
+typedef struct mcp_http_transport_data mcp_http_transport_data_t;
+
+// 一个事件循环：HAL服务器(多个循环时以SO_REUSEPORT监听同一端口)、连接对象池和统计。
+// 第0个由调用 mcp_http_transport_poll() 的线程轮询，其余各有一个线程。
+// 请求处理和连接对象只在所属线程上进行；统计由所属线程原子更新，/metrics 汇总所有循环
 typedef struct {
+    mcp_http_transport_data_t *data;
+    mcp_hal_server_t server;          // HAL服务器句柄
+    pthread_t thread;
+    bool has_thread;
+    bool running;                     // 原子读写
+
+    // 统计信息
+    size_t total_requests;
+    size_t metrics_requests;
+    size_t connections_opened;
+    size_t connections_open;
+    size_t keepalive_requests;        // 复用已有连接对象的请求
+    mcp_histogram_t request_sizes;    // 请求体字节数
+
+    // 连接对象
+    mcp_http_connection_t *live_connections;
+    mcp_http_connection_t *free_connections;
+    size_t free_connection_count;
+
+    mcp_json_buffer_t metrics_buffer; // 复用的 /metrics 响应缓冲区
+} mcp_http_event_loop_t;
+
+// GET /metrics 时追加应用层指标(OpenMetrics样本，不含 # EOF)，返回0表示成功
+typedef int (*mcp_http_metrics_handler_t)(mcp_json_buffer_t *out, void *user_data);
+
+// 路由：多个MCP服务器共用一个监听器和事件循环，POST请求按路径分派给各自的回调，
+// GET <path>/metrics 输出传输层指标和该路由的指标。没有路由时使用 endpoint_path 和传输的回调
+typedef struct {
+    char *path;
+    size_t path_len;
+    mcp_message_received_callback_t on_message;
+    mcp_http_metrics_handler_t metrics_handler;   // 可为NULL
+    void *user_data;
+} mcp_http_route_t;
+
+// HTTP transport specific structures (使用HAL接口)
+struct mcp_http_transport_data {
     // 传输配置
     char *bind_address;
     int port;
@@ -16,17 +103,46 @@ typedef struct {
     // 状态
     bool server_running;
 
-    // 统计信息
-    size_t total_requests;
-    size_t active_connections;
+    // 统计信息(原子更新，各事件循环自己的统计在 mcp_http_event_loop_t 中)
+    size_t active_connections;    // 等待响应的MCP请求数
+    size_t streamed_responses;    // 以SSE流发送的响应
+    size_t compressed_responses;
+    size_t compression_cache_hits;
+    size_t compressed_bytes_in;
+    size_t compressed_bytes_out;
+
+    // 响应压缩，threshold为0表示关闭；缓存由compression_mutex保护(响应可在任意线程发送)
+    size_t compression_threshold;
+    int compression_level;
+    pthread_mutex_t compression_mutex;
+    uint64_t compression_clock;
+    mcp_http_compression_entry_t compression_cache[MCP_HTTP_COMPRESSION_CACHE_SLOTS];
+
+    // 路由表，由routes_lock保护(事件循环线程读，注册/注销时写)
+    pthread_rwlock_t routes_lock;
+    mcp_http_route_t *routes;
+    size_t route_count;
+    size_t route_capacity;
+
+    // 事件循环，loop_count在启动时确定(HAL不支持多个事件循环时为1)
+    int event_loops;
+    mcp_http_event_loop_t *loops;
+    size_t loop_count;
+
+    // 指标输出(可能在多个事件循环上同时调用)
+    mcp_http_metrics_handler_t metrics_handler;
+    void *metrics_user_data;
+
+    // GET <endpoint> 打开的SSE流(没有路由时)，为NULL时回复405
+    mcp_connection_opened_callback_t stream_handler;
+    void *stream_user_data;
 
     // MCP 传输引用
     mcp_transport_t* transport;
 
     // HAL接口
     const mcp_platform_hal_t* hal;
-    mcp_hal_server_t server;      // HAL服务器句柄
-} mcp_http_transport_data_t;
+};
 
 // HTTP transport interface implementation
 extern const mcp_transport_interface_t mcp_http_transport_interface;
@@ -36,12 +152,40 @@ int mcp_http_transport_init_impl(mcp_transport_t *transport, const mcp_transport
 int mcp_http_transport_start_impl(mcp_transport_t *transport);
 int mcp_http_transport_stop_impl(mcp_transport_t *transport);
 int mcp_http_transport_send_impl(mcp_connection_t *connection, const char *message, size_t length);
+int mcp_http_transport_send_accepted(mcp_connection_t *connection);  // 202, 无响应体
+// 以指定状态码回复JSON响应体(如会话无效时的404)，结束延迟响应
+int mcp_http_transport_send_status(mcp_connection_t *connection, int status_code,
+                                   const char *message, size_t length);
+
+// SSE流式响应(请求带 Accept: text/event-stream 时连接带 MCP_CONNECTION_FLAG_EVENT_STREAM)：
+// begin发送200和事件流头部，每条JSON-RPC消息作为一个 message 事件以一个分块发出，
+// end发送可选的最后一条消息并结束响应。HAL不支持分块发送时begin返回-1
+int mcp_http_transport_stream_begin(mcp_connection_t *connection);
+int mcp_http_transport_stream_event(mcp_connection_t *connection, const char *message, size_t length);
+int mcp_http_transport_stream_end(mcp_connection_t *connection, const char *message, size_t length);
 int mcp_http_transport_close_connection_impl(mcp_connection_t *connection);
 int mcp_http_transport_get_stats_impl(mcp_transport_t *transport, void *stats);
 void mcp_http_transport_cleanup_impl(mcp_transport_t *transport);
 
-// 轮询函数 - 供主循环调用
-int mcp_http_transport_poll(mcp_transport_t *transport);
+// 注册 /metrics 的应用层指标回调(在事件循环线程上调用)
+int mcp_http_transport_set_metrics_handler(mcp_transport_t *transport,
+                                           mcp_http_metrics_handler_t handler, void *user_data);
+
+// 注册 GET <endpoint> 的处理函数(在事件循环线程上调用)：连接带 MCP_CONNECTION_FLAG_EVENT_STREAM，
+// 处理函数用 mcp_http_transport_stream_begin() 开始事件流，或用 mcp_http_transport_send_status() 拒绝。
+// 事件流可在任意线程写入，客户端断开时照常触发 on_connection_closed
+int mcp_http_transport_set_stream_handler(mcp_transport_t *transport,
+                                          mcp_connection_opened_callback_t handler, void *user_data);
+
+// 注册/注销路由，路径必须唯一；返回0表示成功
+int mcp_http_transport_add_route(mcp_transport_t *transport, const char *path,
+                                 mcp_message_received_callback_t on_message,
+                                 mcp_http_metrics_handler_t metrics_handler, void *user_data);
+int mcp_http_transport_remove_route(mcp_transport_t *transport, const char *path);
+
+// 轮询函数 - 供主循环调用，驱动第0个事件循环；timeout_ms < 0 时阻塞直到有网络事件或被唤醒
+int mcp_http_transport_poll(mcp_transport_t *transport, int timeout_ms);
+int mcp_http_transport_wakeup(mcp_transport_t *transport);
 
 #endif // MCP_HTTP_TRANSPORT_H
 int mcp_http_add_connection(mcp_transport_t *transport, mcp_connection_t *connection);
@@ -1,8 +1,10 @@
 #include "transport/stdio_transport.h"
+#include "utils/mem_budget.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdio.h>
 
 // STDIO transport interface implementation
 const mcp_transport_interface_t mcp_stdio_transport_interface = {
@@ -15,6 +17,8 @@ const mcp_transport_interface_t mcp_stdio_transport_interface = {
     .cleanup = mcp_stdio_transport_cleanup_impl
 };
 
+static int stdio_output_flush(mcp_stdio_transport_data_t *data);
+
 // STDIO-specific functions
 int mcp_stdio_transport_init_impl(mcp_transport_t *transport, const mcp_transport_config_t *config) {
     if (!transport) return -1;
@@ -36,8 +40,13 @@ int mcp_stdio_transport_init_impl(mcp_transport_t *transport, const mcp_transpor
         return -1;
     }
     
-    // Setup buffering
-    size_t buffer_size = config ? config->max_message_size : 8192;
+    // Setup buffering - start small and grow on demand up to the message size limit
+    data->max_message_size = (config && config->max_message_size > 0) ?
+                             config->max_message_size : 1024 * 1024;
+    size_t buffer_size = MCP_STDIO_INITIAL_BUFFER_SIZE;
+    if (buffer_size > data->max_message_size + 1) {
+        buffer_size = data->max_message_size + 1;
+    }
     if (mcp_stdio_transport_setup_buffering(data, buffer_size, true) != 0) {
         free(data);
         return -1;
@@ -67,10 +76,14 @@ int mcp_stdio_transport_start_impl(mcp_transport_t *transport) {
     mcp_connection_t *connection = mcp_stdio_connection_create(transport);
     if (!connection) return -1;
     
+    data->connection = connection;
+
     // Start reader thread
     data->thread_running = true;
+    data->reader_finished = false;
     if (pthread_create(&data->reader_thread, NULL, mcp_stdio_transport_reader_thread, transport) != 0) {
         data->thread_running = false;
+        data->connection = NULL;
         mcp_stdio_connection_destroy(connection);
         return -1;
     }
@@ -90,19 +103,80 @@ int mcp_stdio_transport_stop_impl(mcp_transport_t *transport) {
     
     mcp_stdio_transport_data_t *data = (mcp_stdio_transport_data_t*)transport->private_data;
     
+    if (!data->thread_running) return 0;
+
     // Stop reader thread
     data->thread_running = false;
     
-    // Wait for thread to finish
-    // Note: pthread_timedjoin_np is not available on macOS, so we use pthread_join
-    if (pthread_join(data->reader_thread, NULL) != 0) {
-        // If join fails, try to cancel the thread
+    // A reader still blocked in fgets() would never notice the flag, so cancel it.
+    // It only accepts cancellation while waiting for input.
+    if (!data->reader_finished) {
         pthread_cancel(data->reader_thread);
     }
+
+    pthread_join(data->reader_thread, NULL);
+
+    // Don't lose replies still waiting to be coalesced
+    pthread_mutex_lock(&data->output_mutex);
+    data->output_hold = false;
+    stdio_output_flush(data);
+    pthread_mutex_unlock(&data->output_mutex);
+
+    mcp_stdio_connection_destroy(data->connection);
+    data->connection = NULL;
     
     return 0;
 }
 
+// Output coalescing - callers must hold output_mutex
+static int stdio_output_append(mcp_stdio_transport_data_t *data, const char *message, size_t length) {
+    bool add_delimiter = data->line_buffered && (length == 0 || message[length - 1] != data->line_delimiter);
+    size_t needed = data->output_length + length + (add_delimiter ? 1 : 0);
+
+    if (needed > data->output_capacity) {
+        size_t capacity = data->output_capacity ? data->output_capacity : 4096;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        char *buffer = realloc(data->output_buffer, capacity);
+        if (!buffer) return -1;
+        data->output_buffer = buffer;
+        data->output_capacity = capacity;
+    }
+
+    memcpy(data->output_buffer + data->output_length, message, length);
+    data->output_length += length;
+    if (add_delimiter) {
+        data->output_buffer[data->output_length++] = data->line_delimiter;
+    }
+
+    return 0;
+}
+
+static int stdio_output_flush(mcp_stdio_transport_data_t *data) {
+    if (data->output_length == 0) return 0;
+
+    // Anything written through the FILE (e.g. printf) must go out first
+    fflush(data->output_stream);
+
+    int fd = fileno(data->output_stream);
+    size_t offset = 0;
+    int result = 0;
+
+    while (offset < data->output_length) {
+        ssize_t written = write(fd, data->output_buffer + offset, data->output_length - offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            result = -1;
+            break;
+        }
+        offset += (size_t)written;
+    }
+
+    data->output_length = 0;
+    return result;
+}
+
 int mcp_stdio_transport_send_impl(mcp_connection_t *connection, const char *message, size_t length) {
     if (!connection || !connection->transport || !message) return -1;
     
@@ -111,24 +185,21 @@ int mcp_stdio_transport_send_impl(mcp_connection_t *connection, const char *mess
     
     if (!data) return -1;
     
-    // Lock output mutex
+    // Senders queued behind us will flush, so only the last one issues the write
+    __atomic_add_fetch(&data->output_waiters, 1, __ATOMIC_ACQ_REL);
     pthread_mutex_lock(&data->output_mutex);
+    int waiters = __atomic_sub_fetch(&data->output_waiters, 1, __ATOMIC_ACQ_REL);
     
-    // Write message to output stream
-    size_t written = fwrite(message, 1, length, data->output_stream);
+    int result = stdio_output_append(data, message, length);
     
-    // Add newline if line buffered and message doesn't end with one
-    if (data->line_buffered && length > 0 && message[length - 1] != data->line_delimiter) {
-        fputc(data->line_delimiter, data->output_stream);
-        written++;
+    if (result == 0 && ((waiters == 0 && !data->output_hold) ||
+                        data->output_length >= MCP_STDIO_OUTPUT_FLUSH_THRESHOLD)) {
+        result = stdio_output_flush(data);
     }
     
-    // Flush output
-    fflush(data->output_stream);
-    
     pthread_mutex_unlock(&data->output_mutex);
     
-    return (written == length || (data->line_buffered && written == length + 1)) ? 0 : -1;
+    return result;
 }
 
 int mcp_stdio_transport_close_connection_impl(mcp_connection_t *connection) {
@@ -163,6 +234,8 @@ void mcp_stdio_transport_cleanup_impl(mcp_transport_t *transport) {
     
     // Free buffers
     free(data->input_buffer);
+    free(data->output_buffer);
+    mcp_mem_budget_release(NULL, data->input_buffer_reserved);
     
     // Free private data
     free(data);
@@ -188,6 +261,7 @@ int mcp_stdio_transport_setup_buffering(mcp_stdio_transport_data_t *data,
     data->input_buffer = malloc(buffer_size);
     if (!data->input_buffer) return -1;
     
+    data->input_buffer_start = 0;
     data->input_buffer_size = 0;
     data->input_buffer_capacity = buffer_size;
     data->line_buffered = line_buffered;
@@ -195,39 +269,171 @@ int mcp_stdio_transport_setup_buffering(mcp_stdio_transport_data_t *data,
     return 0;
 }
 
+static int stdio_dispatch_message(mcp_transport_t *transport, const char *line, size_t length);
+
+static void stdio_report_oversized(mcp_transport_t *transport, mcp_stdio_transport_data_t *data) {
+    data->messages_too_large++;
+
+    char message[96];
+    snprintf(message, sizeof(message), "Input message exceeds %zu bytes, discarded", data->max_message_size);
+    mcp_stdio_handle_error(transport, EMSGSIZE, message);
+}
+
+// Dispatch every complete line in the buffer, in place
+static void stdio_process_buffered_lines(mcp_transport_t *transport, mcp_stdio_transport_data_t *data) {
+    char *buffer = data->input_buffer;
+    bool held = false;
+
+    while (data->input_buffer_start < data->input_buffer_size) {
+        char *line = buffer + data->input_buffer_start;
+        size_t available = data->input_buffer_size - data->input_buffer_start;
+        char *newline = memchr(line, data->line_delimiter, available);
+        if (!newline) break;
+
+        size_t length = (size_t)(newline - line);
+        data->input_buffer_start += length + 1;
+
+        // Tail of a line that was already reported as too large
+        if (data->discarding_line) {
+            data->discarding_line = false;
+            continue;
+        }
+
+        if (length > data->max_message_size) {
+            stdio_report_oversized(transport, data);
+            continue;
+        }
+
+        *newline = '\0';
+        if (length > 0 && line[length - 1] == '\r') {
+            line[--length] = '\0';
+        }
+
+        // While more requests are already waiting, queue replies and write them together
+        const char *next = buffer + data->input_buffer_start;
+        bool more = memchr(next, data->line_delimiter, data->input_buffer_size - data->input_buffer_start) != NULL;
+        if (more != held) {
+            pthread_mutex_lock(&data->output_mutex);
+            data->output_hold = more;
+            if (!more) {
+                stdio_output_flush(data);
+            }
+            pthread_mutex_unlock(&data->output_mutex);
+            held = more;
+        }
+
+        if (length > 0) {
+            stdio_dispatch_message(transport, line, length);
+        }
+    }
+
+    if (held) {
+        pthread_mutex_lock(&data->output_mutex);
+        data->output_hold = false;
+        stdio_output_flush(data);
+        pthread_mutex_unlock(&data->output_mutex);
+    }
+
+    if (data->input_buffer_start == data->input_buffer_size) {
+        data->input_buffer_start = 0;
+        data->input_buffer_size = 0;
+    }
+}
+
+// Make room for the next read: compact, grow, or drop an oversized partial line
+static int stdio_prepare_input_buffer(mcp_transport_t *transport, mcp_stdio_transport_data_t *data) {
+    if (data->input_buffer_start > 0) {
+        size_t pending = data->input_buffer_size - data->input_buffer_start;
+        memmove(data->input_buffer, data->input_buffer + data->input_buffer_start, pending);
+        data->input_buffer_start = 0;
+        data->input_buffer_size = pending;
+    }
+
+    if (data->input_buffer_size < data->input_buffer_capacity) return 0;
+
+    // Room for a maximum-size message plus its delimiter
+    size_t limit = data->max_message_size + 1;
+    if (data->input_buffer_capacity < limit) {
+        size_t capacity = data->input_buffer_capacity * 2;
+        if (capacity > limit) capacity = limit;
+
+        // Growth comes out of the memory budget; without room the line is dropped
+        size_t growth = capacity - data->input_buffer_capacity;
+        if (mcp_mem_budget_reserve(NULL, growth) == MCP_MEM_BUDGET_OK) {
+            char *buffer = realloc(data->input_buffer, capacity);
+            if (!buffer) {
+                mcp_mem_budget_release(NULL, growth);
+                return -1;
+            }
+            data->input_buffer = buffer;
+            data->input_buffer_capacity = capacity;
+            data->input_buffer_reserved += growth;
+            return 0;
+        }
+    }
+
+    // The whole buffer is one unterminated line: drop it and skip to its end
+    if (!data->discarding_line) {
+        stdio_report_oversized(transport, data);
+        data->discarding_line = true;
+    }
+    data->input_buffer_size = 0;
+    return 0;
+}
+
 void *mcp_stdio_transport_reader_thread(void *arg) {
     mcp_transport_t *transport = (mcp_transport_t*)arg;
     mcp_stdio_transport_data_t *data = (mcp_stdio_transport_data_t*)transport->private_data;
     
     if (!data) return NULL;
-    
-    char line_buffer[8192];
+
+    int fd = fileno(data->input_stream);
+
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
     
     while (data->thread_running) {
-        // Read line from input stream
-        if (fgets(line_buffer, sizeof(line_buffer), data->input_stream) == NULL) {
-            if (feof(data->input_stream)) {
-                // End of input
-                break;
-            } else if (ferror(data->input_stream)) {
-                // Error reading
-                mcp_stdio_handle_error(transport, errno, "Error reading from stdin");
-                break;
-            }
-            continue;
+        if (stdio_prepare_input_buffer(transport, data) != 0) {
+            mcp_stdio_handle_error(transport, ENOMEM, "Failed to grow input buffer");
+            break;
         }
-        
-        // Remove trailing newline
-        size_t len = strlen(line_buffer);
-        if (len > 0 && line_buffer[len - 1] == '\n') {
-            line_buffer[len - 1] = '\0';
-            len--;
+
+        size_t room = data->input_buffer_capacity - data->input_buffer_size;
+        if (room > MCP_STDIO_READ_CHUNK_SIZE) {
+            room = MCP_STDIO_READ_CHUNK_SIZE;
+        }
+
+        // Read from input - the only place the thread may be cancelled
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+        ssize_t count = read(fd, data->input_buffer + data->input_buffer_size, room);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+
+        if (count == 0) {
+            // End of input - a final line without delimiter is still a message
+            size_t pending = data->input_buffer_size - data->input_buffer_start;
+            if (pending > 0 && !data->discarding_line && pending <= data->max_message_size &&
+                stdio_prepare_input_buffer(transport, data) == 0 &&
+                data->input_buffer_size < data->input_buffer_capacity) {
+                data->input_buffer[data->input_buffer_size++] = data->line_delimiter;
+                stdio_process_buffered_lines(transport, data);
+            }
+            break;
         }
-        
-        // Process the line
-        if (len > 0) {
-            mcp_stdio_process_input_line(transport, line_buffer);
+
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            mcp_stdio_handle_error(transport, errno, "Error reading from stdin");
+            break;
         }
+
+        data->input_buffer_size += (size_t)count;
+        stdio_process_buffered_lines(transport, data);
+    }
+
+    data->reader_finished = true;
+
+    // Input is gone - tell the application so it can leave its main loop
+    if (data->thread_running && data->connection) {
+        mcp_stdio_transport_close_connection_impl(data->connection);
     }
     
     return NULL;
@@ -274,11 +480,8 @@ void mcp_stdio_connection_destroy(mcp_connection_t *connection) {
 }
 
 // STDIO message processing
-int mcp_stdio_process_input_line(mcp_transport_t *transport, const char *line) {
-    if (!transport || !line) return -1;
-    
-    // Find the STDIO connection (there should be only one)
-    // For now, we'll create a dummy connection for the callback
+static int stdio_dispatch_message(mcp_transport_t *transport, const char *line, size_t length) {
+    // The message is handed over in place; it stays valid only for the callback
     mcp_connection_t dummy_connection = {
         .transport = transport,
         .connection_id = "stdio-0",
@@ -290,12 +493,12 @@ int mcp_stdio_process_input_line(mcp_transport_t *transport, const char *line) {
         .messages_sent = 0,
         .messages_received = 1,
         .bytes_sent = 0,
-        .bytes_received = strlen(line)
+        .bytes_received = length
     };
     
     // Call message received callback
     if (transport->on_message) {
-        transport->on_message(line, strlen(line), &dummy_connection, transport->user_data);
+        transport->on_message(line, length, &dummy_connection, transport->user_data);
     }
     
     transport->messages_received++;
@@ -303,6 +506,12 @@ int mcp_stdio_process_input_line(mcp_transport_t *transport, const char *line) {
     return 0;
 }
 
+int mcp_stdio_process_input_line(mcp_transport_t *transport, const char *line) {
+    if (!transport || !line) return -1;
+    
+    return stdio_dispatch_message(transport, line, strlen(line));
+}
+
 int mcp_stdio_send_output_line(mcp_transport_t *transport, const char *line) {
     if (!transport || !line) return -1;
     
@@ -311,15 +520,14 @@ int mcp_stdio_send_output_line(mcp_transport_t *transport, const char *line) {
     
     pthread_mutex_lock(&data->output_mutex);
     
-    fputs(line, data->output_stream);
-    if (data->line_buffered) {
-        fputc(data->line_delimiter, data->output_stream);
+    int result = stdio_output_append(data, line, strlen(line));
+    if (result == 0 && !data->output_hold) {
+        result = stdio_output_flush(data);
     }
-    fflush(data->output_stream);
     
     pthread_mutex_unlock(&data->output_mutex);
     
-    return 0;
+    return result;
 }
 
 // STDIO error handling
@@ -15,11 +15,27 @@ typedef struct {
     pthread_t reader_thread;
     pthread_mutex_t output_mutex;
     bool thread_running;
+    volatile bool reader_finished;  // Reader thread has hit EOF/error and returned
+
+    // The single STDIO connection
+    mcp_connection_t *connection;
     
-    // Buffering
+    // Input framing - bytes [input_buffer_start, input_buffer_size) are pending
     char *input_buffer;
+    size_t input_buffer_start;
     size_t input_buffer_size;
     size_t input_buffer_capacity;
+    size_t max_message_size;        // Longer lines are discarded
+    size_t input_buffer_reserved;   // Growth past the initial size, held in the memory budget
+    bool discarding_line;           // Inside an oversized line, skipping to its newline
+    size_t messages_too_large;
+
+    // Output coalescing (protected by output_mutex)
+    char *output_buffer;
+    size_t output_length;
+    size_t output_capacity;
+    int output_waiters;             // Senders queued behind output_mutex
+    bool output_hold;               // Reader has more requests already buffered
     
     // Line-based processing
     bool line_buffered;
@@ -44,6 +60,13 @@ int mcp_stdio_transport_close_connection_impl(mcp_connection_t *connection);
 int mcp_stdio_transport_get_stats_impl(mcp_transport_t *transport, void *stats);
 void mcp_stdio_transport_cleanup_impl(mcp_transport_t *transport);
 
+// Initial input buffer; it grows up to max_message_size, reserving the growth in the
+// memory budget (utils/mem_budget.h)
+#define MCP_STDIO_INITIAL_BUFFER_SIZE (64 * 1024)
+#define MCP_STDIO_READ_CHUNK_SIZE (64 * 1024)
+// Pending output is written once it reaches this size even while held
+#define MCP_STDIO_OUTPUT_FLUSH_THRESHOLD (64 * 1024)
+
 // STDIO utility functions
 int mcp_stdio_transport_setup_streams(mcp_stdio_transport_data_t *data, 
                                      FILE *input, FILE *output, FILE *error);
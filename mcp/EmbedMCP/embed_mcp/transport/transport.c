@@ -1,6 +1,8 @@
 #include "transport/transport_interface.h"
 #include "transport/stdio_transport.h"
 #include "transport/http_transport.h"
+#include "transport/uart_transport.h"
+#include "protocol/cbor.h"
 #include "utils/logging.h"
 #include <stdlib.h>
 #include <string.h>
@@ -29,6 +31,9 @@ mcp_transport_t *mcp_transport_create(mcp_transport_type_t type) {
         case MCP_TRANSPORT_HTTP:
             transport->interface = &mcp_http_transport_interface;
             break;
+        case MCP_TRANSPORT_UART:
+            transport->interface = &mcp_uart_transport_interface;
+            break;
         default:
             free(transport);
             return NULL;
@@ -77,7 +82,42 @@ mcp_transport_t *mcp_transport_create_http(int port, const char *bind_address) {
     return transport;
 }
 
+mcp_transport_t *mcp_transport_create_uart(const mcp_uart_driver_t *driver) {
+    mcp_transport_config_t *config = mcp_transport_config_create_uart(driver);
+    if (!config) return NULL;
+
+    mcp_transport_t *transport = mcp_transport_create_with_config(config);
+    mcp_transport_config_destroy(config);
+    return transport;
+}
+
+mcp_transport_t *mcp_transport_create_with_config(const mcp_transport_config_t *config) {
+    if (!config) return NULL;
+
+    mcp_transport_t *transport = mcp_transport_create(config->type);
+    if (!transport) return NULL;
+
+    if (mcp_transport_init(transport, config) != 0) {
+        mcp_transport_destroy(transport);
+        return NULL;
+    }
+
+    return transport;
+}
+
+mcp_transport_t *mcp_transport_create_http_with_path(int port, const char *bind_address, const char *endpoint_path) {
+    mcp_transport_config_t *config = mcp_transport_config_create_http(port, bind_address);
+    if (!config) return NULL;
 
+    if (endpoint_path) {
+        free(config->config.http.endpoint_path);
+        config->config.http.endpoint_path = strdup(endpoint_path);
+    }
+
+    mcp_transport_t *transport = mcp_transport_create_with_config(config);
+    mcp_transport_config_destroy(config);
+    return transport;
+}
 
 // Transport lifecycle
 int mcp_transport_init(mcp_transport_t *transport, const mcp_transport_config_t *config) {
@@ -171,6 +211,14 @@ int mcp_connection_send(mcp_connection_t *connection, const char *message, size_
     
     if (!connection->transport->interface->send) return -1;
     
+    // Replies are written as JSON text; peers talking CBOR get them transcoded
+    if (connection->flags & MCP_CONNECTION_FLAG_CBOR) {
+        mcp_json_buffer_t *buffer = mcp_cbor_thread_buffer();
+        if (!buffer || mcp_cbor_from_json(buffer, message, length) != 0) return -1;
+        message = buffer->data;
+        length = buffer->length;
+    }
+    
     int result = connection->transport->interface->send(connection, message, length);
     if (result == 0) {
         connection->messages_sent++;
@@ -209,7 +257,10 @@ const char *mcp_connection_get_session_id(const mcp_connection_t *connection) {
 }
 
 int mcp_connection_set_session_id(mcp_connection_t *connection, const char *session_id) {
-    if (!connection) return -1;
+    // HTTP connections take the session from each request's header
+    if (!connection || (connection->transport && connection->transport->type == MCP_TRANSPORT_HTTP)) {
+        return -1;
+    }
     
     free(connection->session_id);
     connection->session_id = session_id ? strdup(session_id) : NULL;
@@ -254,13 +305,34 @@ mcp_transport_config_t *mcp_transport_config_create_http(int port, const char *b
     
     config->config.http.port = port;
     config->config.http.bind_address = bind_address ? strdup(bind_address) : strdup("0.0.0.0");
+    config->config.http.endpoint_path = strdup("/mcp");
     config->config.http.enable_cors = true;
     config->config.http.max_request_size = 1024 * 1024; // 1MB
+    config->config.http.compression_threshold = MCP_HTTP_COMPRESSION_THRESHOLD;
+    config->config.http.compression_level = MCP_HTTP_COMPRESSION_LEVEL;
+    config->config.http.event_loops = 1;
     
     return config;
 }
 
+mcp_transport_config_t *mcp_transport_config_create_uart(const mcp_uart_driver_t *driver) {
+    if (!driver) return NULL;
 
+    mcp_transport_config_t *config = calloc(1, sizeof(mcp_transport_config_t));
+    if (!config) return NULL;
+
+    config->type = MCP_TRANSPORT_UART;
+    config->enable_logging = false;
+    config->max_message_size = MCP_UART_DEFAULT_MAX_MESSAGE_SIZE;
+    config->max_connections = 1;
+    config->connection_timeout = 0; // The line is always there
+
+    config->config.uart.driver = driver;
+    config->config.uart.rx_ring_size = MCP_UART_DEFAULT_RX_RING_SIZE;
+    config->config.uart.tx_ring_size = MCP_UART_DEFAULT_TX_RING_SIZE;
+
+    return config;
+}
 
 void mcp_transport_config_destroy(mcp_transport_config_t *config) {
     if (!config) return;
@@ -268,6 +340,7 @@ void mcp_transport_config_destroy(mcp_transport_config_t *config) {
     switch (config->type) {
         case MCP_TRANSPORT_HTTP:
             free(config->config.http.bind_address);
+            free(config->config.http.endpoint_path);
             break;
         default:
             break;
@@ -281,6 +354,7 @@ const char *mcp_transport_type_to_string(mcp_transport_type_t type) {
     switch (type) {
         case MCP_TRANSPORT_STDIO: return "STDIO";
         case MCP_TRANSPORT_HTTP: return "HTTP";
+        case MCP_TRANSPORT_UART: return "UART";
         default: return "UNKNOWN";
     }
 }
@@ -8,7 +8,8 @@
 // Transport types
 typedef enum {
     MCP_TRANSPORT_STDIO,
-    MCP_TRANSPORT_HTTP
+    MCP_TRANSPORT_HTTP,
+    MCP_TRANSPORT_UART
 } mcp_transport_type_t;
 
 // Transport states
@@ -20,11 +21,20 @@ typedef enum {
     MCP_TRANSPORT_STATE_ERROR
 } mcp_transport_state_t;
 
+// Wire encodings a transport may carry
+typedef enum {
+    MCP_TRANSPORT_ENCODING_JSON,    // JSON text only
+    MCP_TRANSPORT_ENCODING_CBOR     // JSON text or CBOR, replies in the request's encoding
+} mcp_transport_encoding_t;
+
 // Forward declarations
 typedef struct mcp_transport mcp_transport_t;
 typedef struct mcp_connection mcp_connection_t;
+typedef struct mcp_uart_driver mcp_uart_driver_t;  // transport/uart_transport.h
 
 // Transport callback functions
+// The connection passed to on_message is only valid for the duration of the callback;
+// handlers that reply later must keep their own copy of it.
 typedef void (*mcp_message_received_callback_t)(const char *message, size_t length,
                                                mcp_connection_t *connection, void *user_data);
 typedef void (*mcp_connection_opened_callback_t)(mcp_connection_t *connection, void *user_data);
@@ -41,6 +51,7 @@ typedef struct {
     size_t max_message_size;
     size_t max_connections;
     time_t connection_timeout;
+    mcp_transport_encoding_t encoding;  // Binary encodings need a framed transport (UART)
 
     // Type-specific settings
     union {
@@ -52,9 +63,19 @@ typedef struct {
         struct {
             int port;
             char *bind_address;
+            char *endpoint_path;            // Path MCP requests are POSTed to (default: "/mcp")
             bool enable_cors;
             size_t max_request_size;
+            size_t compression_threshold;   // Compress responses of at least this many bytes (0: off)
+            int compression_level;          // zlib level 1-9
+            int event_loops;                // Event loop threads sharing the port (SO_REUSEPORT), 1: caller's thread only
         } http;
+
+        struct {
+            const mcp_uart_driver_t *driver;  // Board DMA driver, not owned
+            size_t rx_ring_size;            // Circular DMA reception buffer
+            size_t tx_ring_size;            // Framed replies waiting for (or in) a DMA transfer
+        } uart;
     } config;
 } mcp_transport_config_t;
 
@@ -107,12 +128,20 @@ struct mcp_transport {
     time_t started_time;
 };
 
+// Connection flags, describing the request currently being handled
+#define MCP_CONNECTION_FLAG_EVENT_STREAM (1u << 0)  // HTTP: the reply may be streamed as text/event-stream
+#define MCP_CONNECTION_FLAG_GZIP         (1u << 1)  // HTTP: large replies may be gzip encoded
+#define MCP_CONNECTION_FLAG_DEFLATE      (1u << 2)  // HTTP: large replies may be deflate (zlib) encoded
+#define MCP_CONNECTION_FLAG_NEW_SESSION  (1u << 3)  // HTTP: the reply hands session_id to the client
+#define MCP_CONNECTION_FLAG_CBOR         (1u << 4)  // The request arrived as CBOR, replies go back as CBOR
+
 // Connection structure
 struct mcp_connection {
     mcp_transport_t *transport;
     char *connection_id;
-    char *session_id;
+    char *session_id;               // HTTP: the request's Mcp-Session-Id, owned by the transport
     bool is_active;
+    unsigned int flags;
     time_t created_time;
     time_t last_activity;
     void *private_data;
@@ -128,7 +157,9 @@ struct mcp_connection {
 mcp_transport_t *mcp_transport_create(mcp_transport_type_t type);
 mcp_transport_t *mcp_transport_create_stdio(void);
 mcp_transport_t *mcp_transport_create_http(int port, const char *bind_address);
+mcp_transport_t *mcp_transport_create_with_config(const mcp_transport_config_t *config);
 mcp_transport_t *mcp_transport_create_http_with_path(int port, const char *bind_address, const char *endpoint_path);
+mcp_transport_t *mcp_transport_create_uart(const mcp_uart_driver_t *driver);
 
 // Transport lifecycle
 int mcp_transport_init(mcp_transport_t *transport, const mcp_transport_config_t *config);
@@ -156,6 +187,7 @@ int mcp_connection_set_session_id(mcp_connection_t *connection, const char *sess
 mcp_transport_config_t *mcp_transport_config_create_default(mcp_transport_type_t type);
 mcp_transport_config_t *mcp_transport_config_create_stdio(void);
 mcp_transport_config_t *mcp_transport_config_create_http(int port, const char *bind_address);
+mcp_transport_config_t *mcp_transport_config_create_uart(const mcp_uart_driver_t *driver);
 void mcp_transport_config_destroy(mcp_transport_config_t *config);
 
 // Utility functions
@@ -0,0 +1,609 @@
+#include "transport/uart_transport.h"
+#include "hal/platform_hal.h"
+#include "protocol/cbor.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+
+// UART transport interface implementation
+static int uart_transport_init_impl(mcp_transport_t *transport, const mcp_transport_config_t *config);
+static int uart_transport_start_impl(mcp_transport_t *transport);
+static int uart_transport_stop_impl(mcp_transport_t *transport);
+static int uart_transport_send_impl(mcp_connection_t *connection, const char *message, size_t length);
+static int uart_transport_close_connection_impl(mcp_connection_t *connection);
+static int uart_transport_get_stats_impl(mcp_transport_t *transport, void *stats);
+static void uart_transport_cleanup_impl(mcp_transport_t *transport);
+
+const mcp_transport_interface_t mcp_uart_transport_interface = {
+    .init = uart_transport_init_impl,
+    .start = uart_transport_start_impl,
+    .stop = uart_transport_stop_impl,
+    .send = uart_transport_send_impl,
+    .close_connection = uart_transport_close_connection_impl,
+    .get_stats = uart_transport_get_stats_impl,
+    .cleanup = uart_transport_cleanup_impl
+};
+
+// Replies still queued when the transport stops get this long to go out
+#define MCP_UART_DRAIN_TIMEOUT_MS 1000
+
+// CRC-16/CCITT (poly 0x1021, init 0xFFFF), one nibble at a time: 32 bytes of table
+static const uint16_t crc16_nibble_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+};
+
+uint16_t mcp_uart_crc16(const uint8_t *data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc = (uint16_t)((crc << 4) ^ crc16_nibble_table[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crc16_nibble_table[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+static void uart_handle_error(mcp_transport_t *transport, int error_code, const char *message) {
+    if (transport->on_error) {
+        transport->on_error(transport, error_code, message, transport->user_data);
+    }
+}
+
+static void uart_pause(const mcp_uart_transport_data_t *data) {
+    if (data->hal->thread.sleep_ms) {
+        data->hal->thread.sleep_ms(1);
+    } else if (data->hal->thread.yield) {
+        data->hal->thread.yield();
+    }
+}
+
+// Interrupt hooks
+void mcp_uart_transport_rx_event(mcp_transport_t *transport) {
+    mcp_uart_transport_data_t *data = (mcp_uart_transport_data_t*)transport->private_data;
+    data->driver->wake(data->driver->ctx);
+}
+
+void mcp_uart_transport_tx_complete(mcp_transport_t *transport) {
+    mcp_uart_transport_data_t *data = (mcp_uart_transport_data_t*)transport->private_data;
+    __atomic_store_n(&data->tx_done, 1, __ATOMIC_RELEASE);
+    data->driver->wake(data->driver->ctx);
+}
+
+// Room in the TX ring after position - callers must hold tx_mutex
+static size_t uart_tx_free(const mcp_uart_transport_data_t *data, size_t position) {
+    size_t used = (position + data->tx_size - data->tx_tail) % data->tx_size;
+    return data->tx_size - 1 - used;
+}
+
+// Retire a finished transfer and hand everything contiguous that is pending to DMA,
+// so frames queued during a transfer leave together in the next one
+static int uart_tx_service(mcp_transport_t *transport, mcp_uart_transport_data_t *data) {
+    if (__atomic_exchange_n(&data->tx_done, 0, __ATOMIC_ACQ_REL)) {
+        data->tx_tail = (data->tx_tail + data->tx_in_flight) % data->tx_size;
+        data->tx_in_flight = 0;
+    }
+
+    if (data->tx_in_flight > 0 || data->tx_head == data->tx_tail) return 0;
+
+    size_t end = data->tx_head > data->tx_tail ? data->tx_head : data->tx_size;
+    size_t length = end - data->tx_tail;
+    data->tx_in_flight = length;
+
+    if (data->driver->tx_start(data->driver->ctx, data->tx_ring + data->tx_tail, length) != 0) {
+        // Drop the queued output rather than stall every later reply behind it
+        data->tx_in_flight = 0;
+        data->tx_tail = data->tx_head;
+        uart_handle_error(transport, EIO, "UART transmission failed to start");
+        return -1;
+    }
+
+    data->stats.tx_transfers++;
+    data->stats.bytes_sent += length;
+    return 0;
+}
+
+// COBS encoder writing straight into the TX ring: each block starts with a code
+// byte giving the distance to the next zero, filled in once the block closes
+typedef struct {
+    mcp_transport_t *transport;
+    mcp_uart_transport_data_t *data;
+    size_t code;                    // Ring offset of the open block's code byte
+    size_t position;                // Next ring offset to write
+    size_t run;                     // Bytes in the open block, at most 254
+    size_t room;                    // Free bytes after position when last checked
+    int error;
+} uart_cobs_writer_t;
+
+// Code byte, a full block and the delimiter
+#define UART_COBS_BLOCK_RESERVE 256
+
+// Open a block once it is sure to fit. Everything before it is complete, so while
+// the ring is full that part is published for DMA to drain.
+static void uart_cobs_open(uart_cobs_writer_t *writer) {
+    mcp_uart_transport_data_t *data = writer->data;
+    if (writer->error) return;
+
+    if (writer->room < UART_COBS_BLOCK_RESERVE) {
+        data->hal->sync.mutex_lock(data->tx_mutex);
+        while ((writer->room = uart_tx_free(data, writer->position)) < UART_COBS_BLOCK_RESERVE) {
+            // The completion is picked up here too, so a reply sent from the
+            // transport task itself cannot deadlock
+            data->tx_head = writer->position;
+            uart_tx_service(writer->transport, data);
+            if ((writer->room = uart_tx_free(data, writer->position)) >= UART_COBS_BLOCK_RESERVE) break;
+
+            if (!data->running) {
+                writer->error = -1;
+                data->hal->sync.mutex_unlock(data->tx_mutex);
+                return;
+            }
+
+            data->hal->sync.mutex_unlock(data->tx_mutex);
+            uart_pause(data);
+            data->hal->sync.mutex_lock(data->tx_mutex);
+        }
+        data->hal->sync.mutex_unlock(data->tx_mutex);
+    }
+
+    writer->code = writer->position;
+    writer->position = (writer->position + 1) % data->tx_size;
+    writer->run = 0;
+    writer->room--;
+}
+
+static void uart_cobs_close(uart_cobs_writer_t *writer) {
+    writer->data->tx_ring[writer->code] = (uint8_t)(writer->run + 1);
+}
+
+static void uart_cobs_copy(uart_cobs_writer_t *writer, const uint8_t *bytes, size_t length) {
+    mcp_uart_transport_data_t *data = writer->data;
+    size_t first = data->tx_size - writer->position;
+    if (first > length) first = length;
+
+    memcpy(data->tx_ring + writer->position, bytes, first);
+    memcpy(data->tx_ring, bytes + first, length - first);
+    writer->position = (writer->position + length) % data->tx_size;
+    writer->run += length;
+    writer->room -= length;
+}
+
+static void uart_cobs_put(uart_cobs_writer_t *writer, const uint8_t *bytes, size_t length) {
+    while (length > 0 && !writer->error) {
+        size_t chunk = 254 - writer->run;
+        if (chunk > length) chunk = length;
+
+        const uint8_t *zero = memchr(bytes, 0, chunk);
+        size_t copy = zero ? (size_t)(zero - bytes) : chunk;
+        uart_cobs_copy(writer, bytes, copy);
+        bytes += copy;
+        length -= copy;
+
+        if (zero) {
+            // The zero itself becomes the code byte of the next block
+            uart_cobs_close(writer);
+            uart_cobs_open(writer);
+            bytes++;
+            length--;
+        } else if (writer->run == 254) {
+            uart_cobs_close(writer);
+            uart_cobs_open(writer);
+        }
+    }
+}
+
+// Frame a message into the TX ring and publish it - callers must hold send_mutex
+static int uart_tx_frame(mcp_transport_t *transport, mcp_uart_transport_data_t *data,
+                         const char *message, size_t length) {
+    uint16_t crc = mcp_uart_crc16((const uint8_t*)message, length);
+    uint8_t trailer[2] = { (uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF) };
+
+    data->hal->sync.mutex_lock(data->tx_mutex);
+    uart_cobs_writer_t writer = {
+        .transport = transport,
+        .data = data,
+        .position = data->tx_head,
+        .room = uart_tx_free(data, data->tx_head)
+    };
+    data->hal->sync.mutex_unlock(data->tx_mutex);
+
+    uart_cobs_open(&writer);
+    uart_cobs_put(&writer, (const uint8_t*)message, length);
+    uart_cobs_put(&writer, trailer, sizeof(trailer));
+    if (writer.error) return -1;
+    uart_cobs_close(&writer);
+    data->tx_ring[writer.position] = 0;
+
+    data->hal->sync.mutex_lock(data->tx_mutex);
+    data->tx_head = (writer.position + 1) % data->tx_size;
+    data->stats.frames_sent++;
+    int result = uart_tx_service(transport, data);
+    data->hal->sync.mutex_unlock(data->tx_mutex);
+
+    return result;
+}
+
+// In-place COBS decode, returns the decoded length or SIZE_MAX on a malformed frame
+static size_t uart_cobs_decode(uint8_t *frame, size_t length) {
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < length) {
+        uint8_t code = frame[in++];
+        size_t run = (size_t)code - 1;
+        if (code == 0 || run > length - in) return SIZE_MAX;
+
+        memmove(frame + out, frame + in, run);
+        out += run;
+        in += run;
+        if (code != 0xFF && in < length) {
+            frame[out++] = 0;
+        }
+    }
+
+    return out;
+}
+
+static size_t uart_frame_limit(const mcp_uart_transport_data_t *data) {
+    return MCP_UART_FRAME_SIZE(data->max_message_size) - 1;
+}
+
+static void uart_report_oversized(mcp_transport_t *transport, mcp_uart_transport_data_t *data) {
+    data->stats.frames_too_large++;
+
+    char message[96];
+    snprintf(message, sizeof(message), "UART frame exceeds %zu bytes, discarded", data->max_message_size);
+    uart_handle_error(transport, EMSGSIZE, message);
+}
+
+// Copy part of a frame out of the RX ring
+static void uart_frame_append(mcp_transport_t *transport, mcp_uart_transport_data_t *data,
+                              const uint8_t *bytes, size_t length) {
+    if (data->discarding_frame) return;
+
+    size_t needed = data->frame_length + length;
+    if (needed > uart_frame_limit(data)) {
+        uart_report_oversized(transport, data);
+        data->discarding_frame = true;
+        data->frame_length = 0;
+        return;
+    }
+
+    if (needed > data->frame_capacity) {
+        size_t capacity = data->frame_capacity ? data->frame_capacity : 256;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        if (capacity > uart_frame_limit(data)) capacity = uart_frame_limit(data);
+
+        uint8_t *frame = realloc(data->frame, capacity);
+        if (!frame) {
+            uart_handle_error(transport, ENOMEM, "Failed to grow UART frame buffer");
+            data->discarding_frame = true;
+            data->frame_length = 0;
+            return;
+        }
+        data->frame = frame;
+        data->frame_capacity = capacity;
+    }
+
+    memcpy(data->frame + data->frame_length, bytes, length);
+    data->frame_length = needed;
+}
+
+static void uart_dispatch_message(mcp_transport_t *transport, mcp_uart_transport_data_t *data,
+                                  const char *message, size_t length) {
+    // A CBOR request is answered in CBOR, if this link was configured to carry it
+    bool cbor = mcp_cbor_is_message(message, length);
+    if (cbor) {
+        if (data->encoding != MCP_TRANSPORT_ENCODING_CBOR) {
+            uart_handle_error(transport, EPROTONOSUPPORT, "CBOR frame on a JSON-only UART link, discarded");
+            return;
+        }
+        data->stats.frames_cbor++;
+    }
+
+    // The message is handed over in place; it stays valid only for the callback
+    mcp_connection_t dummy_connection = {
+        .transport = transport,
+        .connection_id = "uart-0",
+        .session_id = NULL,
+        .is_active = true,
+        .created_time = time(NULL),
+        .last_activity = time(NULL),
+        .private_data = NULL,
+        .messages_sent = 0,
+        .messages_received = 1,
+        .bytes_sent = 0,
+        .bytes_received = length,
+        .flags = cbor ? MCP_CONNECTION_FLAG_CBOR : 0
+    };
+
+    if (transport->on_message) {
+        transport->on_message(message, length, &dummy_connection, transport->user_data);
+    }
+
+    transport->messages_received++;
+}
+
+// A delimiter arrived: check and dispatch the frame before it (COBS bytes, no delimiter)
+static void uart_frame_complete(mcp_transport_t *transport, mcp_uart_transport_data_t *data,
+                                uint8_t *frame, size_t length) {
+    // Tail of a frame that was already reported as too large
+    if (data->discarding_frame) {
+        data->discarding_frame = false;
+        return;
+    }
+
+    // Back-to-back delimiters are idle filler, used to flush a receiver
+    if (length == 0) return;
+
+    if (length > uart_frame_limit(data)) {
+        uart_report_oversized(transport, data);
+        return;
+    }
+
+    size_t decoded = uart_cobs_decode(frame, length);
+    if (decoded == SIZE_MAX || decoded < 2 ||
+        mcp_uart_crc16(frame, decoded - 2) != (uint16_t)((frame[decoded - 2] << 8) | frame[decoded - 1])) {
+        data->stats.crc_errors++;
+        uart_handle_error(transport, EBADMSG, "UART frame failed its checksum, discarded");
+        return;
+    }
+
+    // The checksum is no longer needed, its first byte terminates the payload
+    size_t payload = decoded - 2;
+    frame[payload] = '\0';
+    data->stats.frames_received++;
+
+    if (payload > 0) {
+        uart_dispatch_message(transport, data, (const char*)frame, payload);
+    }
+}
+
+// Consume what DMA has written since the last pass. Frames lying contiguously in
+// the ring are decoded and dispatched in place; only a frame wrapping around the
+// end of the ring is copied out.
+static void uart_receive(mcp_transport_t *transport, mcp_uart_transport_data_t *data) {
+    size_t head = data->driver->rx_position(data->driver->ctx) % data->rx_size;
+
+    while (data->rx_scan != head) {
+        bool wraps = head < data->rx_scan;
+        size_t end = wraps ? data->rx_size : head;
+        uint8_t *delimiter = memchr(data->rx_ring + data->rx_scan, 0, end - data->rx_scan);
+        size_t scanned = delimiter ? (size_t)(delimiter - data->rx_ring) + 1 : end;
+
+        data->stats.bytes_received += scanned - data->rx_scan;
+        data->rx_scan = scanned % data->rx_size;
+
+        if (!delimiter) {
+            if (wraps) {
+                // The frame continues at the start of the ring
+                uart_frame_append(transport, data, data->rx_ring + data->rx_tail, data->rx_size - data->rx_tail);
+                data->rx_tail = 0;
+            } else if (!data->discarding_frame &&
+                       data->frame_length + (end - data->rx_tail) > uart_frame_limit(data)) {
+                uart_report_oversized(transport, data);
+                data->discarding_frame = true;
+                data->frame_length = 0;
+            }
+            if (data->discarding_frame) {
+                data->rx_tail = data->rx_scan;
+            }
+            continue;
+        }
+
+        uint8_t *frame = data->rx_ring + data->rx_tail;
+        size_t length = (size_t)(delimiter - frame);
+        data->rx_tail = data->rx_scan;
+
+        if (data->frame_length > 0) {
+            uart_frame_append(transport, data, frame, length);
+            frame = data->frame;
+            length = data->frame_length;
+            data->frame_length = 0;
+        }
+
+        uart_frame_complete(transport, data, frame, length);
+    }
+}
+
+static void *uart_io_thread(void *arg) {
+    mcp_transport_t *transport = (mcp_transport_t*)arg;
+    mcp_uart_transport_data_t *data = (mcp_uart_transport_data_t*)transport->private_data;
+
+    while (data->running) {
+        data->driver->wait(data->driver->ctx, MCP_UART_POLL_INTERVAL_MS);
+
+        data->hal->sync.mutex_lock(data->tx_mutex);
+        uart_tx_service(transport, data);
+        data->hal->sync.mutex_unlock(data->tx_mutex);
+
+        uart_receive(transport, data);
+    }
+
+    return NULL;
+}
+
+static int uart_transport_init_impl(mcp_transport_t *transport, const mcp_transport_config_t *config) {
+    if (!transport || !config || !config->config.uart.driver) return -1;
+
+    const mcp_uart_driver_t *driver = config->config.uart.driver;
+    if (!driver->start || !driver->rx_position || !driver->tx_start ||
+        !driver->wait || !driver->wake || !driver->stop) {
+        return -1;
+    }
+
+    mcp_uart_transport_data_t *data = calloc(1, sizeof(mcp_uart_transport_data_t));
+    if (!data) return -1;
+
+    data->driver = driver;
+    data->rx_size = config->config.uart.rx_ring_size > 0 ?
+                    config->config.uart.rx_ring_size : MCP_UART_DEFAULT_RX_RING_SIZE;
+    data->tx_size = config->config.uart.tx_ring_size > 0 ?
+                    config->config.uart.tx_ring_size : MCP_UART_DEFAULT_TX_RING_SIZE;
+    if (data->tx_size < MCP_UART_MIN_TX_RING_SIZE) {
+        data->tx_size = MCP_UART_MIN_TX_RING_SIZE;
+    }
+    data->max_message_size = config->max_message_size > 0 ?
+                             config->max_message_size : MCP_UART_DEFAULT_MAX_MESSAGE_SIZE;
+    data->encoding = config->encoding;
+
+    // Threads and locks go through the HAL, so the transport runs on FreeRTOS as well
+    data->hal = mcp_platform_get_hal();
+    data->rx_ring = malloc(data->rx_size);
+    data->tx_ring = malloc(data->tx_size);
+    if (!data->hal || !data->rx_ring || !data->tx_ring ||
+        data->hal->sync.mutex_create(&data->tx_mutex) != 0) {
+        free(data->rx_ring);
+        free(data->tx_ring);
+        free(data);
+        return -1;
+    }
+    if (data->hal->sync.mutex_create(&data->send_mutex) != 0) {
+        data->hal->sync.mutex_destroy(data->tx_mutex);
+        free(data->rx_ring);
+        free(data->tx_ring);
+        free(data);
+        return -1;
+    }
+
+    transport->config = calloc(1, sizeof(mcp_transport_config_t));
+    if (transport->config) {
+        *transport->config = *config;
+    }
+
+    transport->private_data = data;
+    return 0;
+}
+
+static int uart_transport_start_impl(mcp_transport_t *transport) {
+    if (!transport || !transport->private_data) return -1;
+
+    mcp_uart_transport_data_t *data = (mcp_uart_transport_data_t*)transport->private_data;
+
+    mcp_connection_t *connection = calloc(1, sizeof(mcp_connection_t));
+    if (!connection) return -1;
+    connection->transport = transport;
+    connection->connection_id = strdup("uart-0");
+    connection->is_active = true;
+    connection->created_time = time(NULL);
+    connection->last_activity = time(NULL);
+
+    data->rx_tail = 0;
+    data->rx_scan = 0;
+    data->running = true;
+
+    if (data->driver->start(data->driver->ctx, transport, data->rx_ring, data->rx_size) != 0) {
+        data->running = false;
+        free(connection->connection_id);
+        free(connection);
+        return -1;
+    }
+
+    if (data->hal->thread.create(&data->io_thread, uart_io_thread, transport, 0) != 0) {
+        data->running = false;
+        data->driver->stop(data->driver->ctx);
+        free(connection->connection_id);
+        free(connection);
+        return -1;
+    }
+
+    data->connection = connection;
+
+    if (transport->on_connection_opened) {
+        transport->on_connection_opened(connection, transport->user_data);
+    }
+    transport->connections_opened++;
+
+    return 0;
+}
+
+static int uart_transport_stop_impl(mcp_transport_t *transport) {
+    if (!transport || !transport->private_data) return -1;
+
+    mcp_uart_transport_data_t *data = (mcp_uart_transport_data_t*)transport->private_data;
+    if (!data->running) return 0;
+
+    data->running = false;
+    data->driver->wake(data->driver->ctx);
+    data->hal->thread.join(data->io_thread);
+    data->io_thread = NULL;
+
+    // Don't lose replies still queued for transmission
+    data->hal->sync.mutex_lock(data->tx_mutex);
+    for (int waited = 0; waited < MCP_UART_DRAIN_TIMEOUT_MS; waited++) {
+        uart_tx_service(transport, data);
+        if (data->tx_head == data->tx_tail) break;
+        data->hal->sync.mutex_unlock(data->tx_mutex);
+        uart_pause(data);
+        data->hal->sync.mutex_lock(data->tx_mutex);
+    }
+    data->hal->sync.mutex_unlock(data->tx_mutex);
+
+    data->driver->stop(data->driver->ctx);
+
+    if (data->connection) {
+        free(data->connection->connection_id);
+        free(data->connection);
+        data->connection = NULL;
+    }
+
+    return 0;
+}
+
+static int uart_transport_send_impl(mcp_connection_t *connection, const char *message, size_t length) {
+    if (!connection || !connection->transport || !message) return -1;
+
+    mcp_transport_t *transport = connection->transport;
+    mcp_uart_transport_data_t *data = (mcp_uart_transport_data_t*)transport->private_data;
+    if (!data) return -1;
+
+    // One frame at a time, so frames streaming through the ring stay whole
+    data->hal->sync.mutex_lock(data->send_mutex);
+    int result = uart_tx_frame(transport, data, message, length);
+    data->hal->sync.mutex_unlock(data->send_mutex);
+
+    if (result == 0) {
+        transport->messages_sent++;
+    }
+    return result;
+}
+
+static int uart_transport_close_connection_impl(mcp_connection_t *connection) {
+    if (!connection) return -1;
+
+    // The serial line cannot be closed, only marked inactive
+    connection->is_active = false;
+
+    if (connection->transport && connection->transport->on_connection_closed) {
+        connection->transport->on_connection_closed(connection, connection->transport->user_data);
+    }
+
+    return 0;
+}
+
+static int uart_transport_get_stats_impl(mcp_transport_t *transport, void *stats) {
+    if (!transport || !transport->private_data || !stats) return -1;
+
+    mcp_uart_transport_data_t *data = (mcp_uart_transport_data_t*)transport->private_data;
+
+    data->hal->sync.mutex_lock(data->tx_mutex);
+    *(mcp_uart_transport_stats_t*)stats = data->stats;
+    data->hal->sync.mutex_unlock(data->tx_mutex);
+
+    return 0;
+}
+
+static void uart_transport_cleanup_impl(mcp_transport_t *transport) {
+    if (!transport || !transport->private_data) return;
+
+    mcp_uart_transport_data_t *data = (mcp_uart_transport_data_t*)transport->private_data;
+
+    data->hal->sync.mutex_destroy(data->send_mutex);
+    data->hal->sync.mutex_destroy(data->tx_mutex);
+    free(data->rx_ring);
+    free(data->tx_ring);
+    free(data->frame);
+    free(data);
+    transport->private_data = NULL;
+}
@@ -0,0 +1,113 @@
+#ifndef MCP_UART_TRANSPORT_H
+#define MCP_UART_TRANSPORT_H
+
+#include "transport_interface.h"
+#include "../hal/platform_hal.h"
+#include <stdint.h>
+
+/**
+ * UART transport for MCUs. Reception runs as circular DMA into an RX ring with the
+ * idle-line interrupt reporting progress; replies are framed straight into a TX ring
+ * that DMA drains, chaining back-to-back frames into one transfer.
+ *
+ * Frames are COBS encoded (no 0x00 inside a frame) and end with a 0x00 delimiter,
+ * so a receiver resynchronizes on the next delimiter after noise or a dropped
+ * byte. Inside the encoding the JSON payload is followed by its CRC-16/CCITT
+ * (poly 0x1021, init 0xFFFF), big-endian; frames failing the check are dropped.
+ */
+
+/**
+ * Board driver. The callbacks run on the transport task except where noted; the
+ * driver's interrupt handlers report progress with mcp_uart_transport_rx_event()
+ * and mcp_uart_transport_tx_complete().
+ */
+struct mcp_uart_driver {
+    void *ctx;
+
+    // Start circular reception into ring (DMA with idle-line interrupt). transport
+    // is the handle the interrupt handlers pass to the mcp_uart_transport_* hooks.
+    int (*start)(void *ctx, mcp_transport_t *transport, uint8_t *ring, size_t size);
+    // Ring offset the next received byte will be written to (size - NDTR on STM32)
+    size_t (*rx_position)(void *ctx);
+    // Start one transmission; data stays valid until the completion is reported
+    int (*tx_start)(void *ctx, const uint8_t *data, size_t length);
+    // Block the transport task until wake() or timeout
+    void (*wait)(void *ctx, uint32_t timeout_ms);
+    // Release wait(); must be callable from interrupt context
+    void (*wake)(void *ctx);
+    // Stop both directions
+    void (*stop)(void *ctx);
+};
+
+typedef struct {
+    uint64_t frames_received;
+    uint64_t frames_sent;
+    uint64_t crc_errors;            // Frames dropped for a bad checksum or encoding
+    uint64_t frames_too_large;      // Frames dropped for exceeding max_message_size
+    uint64_t frames_cbor;           // Frames carrying CBOR rather than JSON text
+    uint64_t tx_transfers;          // DMA transfers started, fewer than frames when chained
+    uint64_t bytes_received;        // Raw bytes, framing included
+    uint64_t bytes_sent;
+} mcp_uart_transport_stats_t;
+
+typedef struct {
+    const mcp_uart_driver_t *driver;
+    mcp_connection_t *connection;
+
+    const mcp_platform_hal_t *hal;  // Threads and mutexes come from the platform HAL
+    void *io_thread;                // HAL thread handle
+    volatile bool running;
+
+    // RX ring, written by DMA; [rx_tail, driver position) is unprocessed and
+    // [rx_tail, rx_scan) is the start of a frame whose delimiter has not arrived
+    uint8_t *rx_ring;
+    size_t rx_size;
+    size_t rx_tail;
+    size_t rx_scan;
+
+    // Frame that wrapped around the end of the ring, copied out
+    uint8_t *frame;
+    size_t frame_length;
+    size_t frame_capacity;
+    size_t max_message_size;
+    bool discarding_frame;          // Inside an oversized frame, skipping to its delimiter
+    mcp_transport_encoding_t encoding;
+
+    // TX ring (protected by tx_mutex); [tx_tail, tx_head) is framed output, of
+    // which tx_in_flight bytes from tx_tail are handed to DMA. Frames are encoded
+    // past tx_head under send_mutex and published block by block, so a frame
+    // larger than the ring streams through it.
+    void *send_mutex;               // HAL mutexes
+    void *tx_mutex;
+    uint8_t *tx_ring;
+    size_t tx_size;
+    size_t tx_head;
+    size_t tx_tail;
+    size_t tx_in_flight;
+    int tx_done;                    // Set by the completion interrupt
+
+    mcp_uart_transport_stats_t stats;   // RX counters are kept by the transport task
+} mcp_uart_transport_data_t;
+
+// UART transport interface implementation
+extern const mcp_transport_interface_t mcp_uart_transport_interface;
+
+// Default ring sizes, small enough for MCU RAM
+#define MCP_UART_DEFAULT_RX_RING_SIZE 2048
+#define MCP_UART_DEFAULT_TX_RING_SIZE 4096
+// Smallest TX ring: a full COBS block, its code byte and the delimiter, twice
+#define MCP_UART_MIN_TX_RING_SIZE 512
+#define MCP_UART_DEFAULT_MAX_MESSAGE_SIZE (16 * 1024)
+// Idle wake-up of the transport task, bounds shutdown latency
+#define MCP_UART_POLL_INTERVAL_MS 100
+
+// Interrupt hooks for the board driver
+void mcp_uart_transport_rx_event(mcp_transport_t *transport);
+void mcp_uart_transport_tx_complete(mcp_transport_t *transport);
+
+// Frame helpers
+uint16_t mcp_uart_crc16(const uint8_t *data, size_t length);
+// Largest encoded frame for a payload, delimiter included
+#define MCP_UART_FRAME_SIZE(payload) ((payload) + 2 + ((payload) + 2) / 254 + 2)
+
+#endif // MCP_UART_TRANSPORT_H
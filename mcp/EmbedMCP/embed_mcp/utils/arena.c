@@ -0,0 +1,160 @@
+#include "utils/arena.h"
+#include "hal/platform_hal.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN 8
+#define ARENA_ALIGN_UP(n) (((n) + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1))
+#define ARENA_HEADER_SIZE ARENA_ALIGN_UP(sizeof(mcp_arena_chunk_t))
+
+static char *chunk_data(mcp_arena_chunk_t *chunk) {
+    return (char*)chunk + ARENA_HEADER_SIZE;
+}
+
+static void chunk_free(mcp_arena_chunk_t *chunk) {
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    if (hal) {
+        hal->memory.free(chunk);
+    }
+}
+
+// Arena lifecycle
+void mcp_arena_init(mcp_arena_t *arena, size_t chunk_size) {
+    if (!arena) return;
+    memset(arena, 0, sizeof(mcp_arena_t));
+    arena->chunk_size = chunk_size > 0 ? chunk_size : MCP_ARENA_DEFAULT_CHUNK_SIZE;
+}
+
+void mcp_arena_destroy(mcp_arena_t *arena) {
+    if (!arena) return;
+
+    mcp_arena_chunk_t *chunk = arena->current;
+    while (chunk) {
+        mcp_arena_chunk_t *prev = chunk->prev;
+        chunk_free(chunk);
+        chunk = prev;
+    }
+
+    arena->current = NULL;
+    arena->bytes_in_use = 0;
+}
+
+// Allocation
+void *mcp_arena_alloc(mcp_arena_t *arena, size_t size) {
+    if (!arena) return NULL;
+
+    size = ARENA_ALIGN_UP(size ? size : 1);
+
+    mcp_arena_chunk_t *chunk = arena->current;
+    if (!chunk || chunk->size - chunk->used < size) {
+        const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+        if (!hal) return NULL;
+
+        // Oversized requests get a chunk of their own
+        size_t data_size = size > arena->chunk_size ? size : arena->chunk_size;
+        chunk = hal->memory.alloc(ARENA_HEADER_SIZE + data_size);
+        if (!chunk) return NULL;
+
+        chunk->prev = arena->current;
+        chunk->size = data_size;
+        chunk->used = 0;
+        arena->current = chunk;
+    }
+
+    void *ptr = chunk_data(chunk) + chunk->used;
+    chunk->used += size;
+
+    arena->bytes_in_use += size;
+    if (arena->bytes_in_use > arena->peak_bytes) {
+        arena->peak_bytes = arena->bytes_in_use;
+    }
+
+    return ptr;
+}
+
+void *mcp_arena_calloc(mcp_arena_t *arena, size_t size) {
+    void *ptr = mcp_arena_alloc(arena, size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+char *mcp_arena_strdup(mcp_arena_t *arena, const char *str) {
+    if (!str) return NULL;
+
+    size_t length = strlen(str) + 1;
+    char *copy = mcp_arena_alloc(arena, length);
+    if (copy) {
+        memcpy(copy, str, length);
+    }
+    return copy;
+}
+
+// Scope management
+mcp_arena_mark_t mcp_arena_mark(const mcp_arena_t *arena) {
+    mcp_arena_mark_t mark = { NULL, 0, 0 };
+    if (arena) {
+        mark.chunk = arena->current;
+        mark.used = arena->current ? arena->current->used : 0;
+        mark.bytes_in_use = arena->bytes_in_use;
+    }
+    return mark;
+}
+
+void mcp_arena_rewind(mcp_arena_t *arena, mcp_arena_mark_t mark) {
+    if (!arena) return;
+
+    // Release chunks opened after the mark; when rewinding to an empty arena
+    // the oldest chunk is kept so the next request doesn't hit the allocator
+    while (arena->current && arena->current != mark.chunk) {
+        mcp_arena_chunk_t *chunk = arena->current;
+        if (!mark.chunk && !chunk->prev) {
+            break;
+        }
+        arena->current = chunk->prev;
+        chunk_free(chunk);
+    }
+
+    if (arena->current) {
+        arena->current->used = (arena->current == mark.chunk) ? mark.used : 0;
+    }
+    arena->bytes_in_use = mark.bytes_in_use;
+}
+
+void mcp_arena_reset(mcp_arena_t *arena) {
+    mcp_arena_mark_t start = { NULL, 0, 0 };
+    mcp_arena_rewind(arena, start);
+}
+
+// Per-thread arena
+static pthread_key_t g_thread_arena_key;
+static pthread_once_t g_thread_arena_once = PTHREAD_ONCE_INIT;
+
+static void thread_arena_destroy(void *arg) {
+    mcp_arena_t *arena = (mcp_arena_t*)arg;
+    mcp_arena_destroy(arena);
+    free(arena);
+}
+
+static void thread_arena_key_init(void) {
+    pthread_key_create(&g_thread_arena_key, thread_arena_destroy);
+}
+
+mcp_arena_t *mcp_arena_thread(void) {
+    pthread_once(&g_thread_arena_once, thread_arena_key_init);
+
+    mcp_arena_t *arena = pthread_getspecific(g_thread_arena_key);
+    if (!arena) {
+        arena = malloc(sizeof(mcp_arena_t));
+        if (!arena) return NULL;
+        mcp_arena_init(arena, MCP_ARENA_DEFAULT_CHUNK_SIZE);
+        if (pthread_setspecific(g_thread_arena_key, arena) != 0) {
+            free(arena);
+            return NULL;
+        }
+    }
+
+    return arena;
+}
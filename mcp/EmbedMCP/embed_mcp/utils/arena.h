@@ -0,0 +1,52 @@
+#ifndef MCP_ARENA_H
+#define MCP_ARENA_H
+
+#include <stddef.h>
+
+// Request-scoped bump allocator. Chunks come from the platform HAL
+// (mcp_platform_memory_t), individual allocations are never freed - the
+// whole arena is rewound in one step once the message has been handled.
+
+#define MCP_ARENA_DEFAULT_CHUNK_SIZE 4096
+
+typedef struct mcp_arena_chunk mcp_arena_chunk_t;
+
+struct mcp_arena_chunk {
+    mcp_arena_chunk_t *prev;        // Older chunk
+    size_t size;                    // Usable bytes in data
+    size_t used;
+    // Chunk data follows the header
+};
+
+typedef struct {
+    mcp_arena_chunk_t *current;     // Newest chunk, allocations come from here
+    size_t chunk_size;
+    size_t bytes_in_use;
+    size_t peak_bytes;
+} mcp_arena_t;
+
+// Position in an arena, used to rewind nested scopes
+typedef struct {
+    mcp_arena_chunk_t *chunk;
+    size_t used;
+    size_t bytes_in_use;
+} mcp_arena_mark_t;
+
+// Arena lifecycle
+void mcp_arena_init(mcp_arena_t *arena, size_t chunk_size);
+void mcp_arena_destroy(mcp_arena_t *arena);
+
+// Allocation (8-byte aligned, NULL on failure)
+void *mcp_arena_alloc(mcp_arena_t *arena, size_t size);
+void *mcp_arena_calloc(mcp_arena_t *arena, size_t size);
+char *mcp_arena_strdup(mcp_arena_t *arena, const char *str);
+
+// Scope management - reset keeps the first chunk for reuse
+mcp_arena_mark_t mcp_arena_mark(const mcp_arena_t *arena);
+void mcp_arena_rewind(mcp_arena_t *arena, mcp_arena_mark_t mark);
+void mcp_arena_reset(mcp_arena_t *arena);
+
+// Arena owned by the calling thread, released when the thread exits
+mcp_arena_t *mcp_arena_thread(void);
+
+#endif // MCP_ARENA_H
@@ -0,0 +1,88 @@
+#include "utils/array_convert.h"
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define CONVERT_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define CONVERT_HAVE_X86 0
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define CONVERT_HAVE_NEON 1
+#include <arm_neon.h>
+#else
+#define CONVERT_HAVE_NEON 0
+#endif
+
+#if CONVERT_HAVE_X86
+__attribute__((target("avx")))
+static size_t convert_f64_to_int_avx(const double *src, int *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), _mm256_cvttpd_epi32(_mm256_loadu_pd(src + i)));
+    }
+    return i;
+}
+
+static size_t convert_f64_to_int_sse2(const double *src, int *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i lo = _mm_cvttpd_epi32(_mm_loadu_pd(src + i));
+        __m128i hi = _mm_cvttpd_epi32(_mm_loadu_pd(src + i + 2));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi64(lo, hi));
+    }
+    return i;
+}
+#endif
+
+#if CONVERT_HAVE_NEON
+static size_t convert_f64_to_int_neon(const double *src, int *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        int32x2_t lo = vmovn_s64(vcvtq_s64_f64(vld1q_f64(src + i)));
+        int32x2_t hi = vmovn_s64(vcvtq_s64_f64(vld1q_f64(src + i + 2)));
+        vst1q_s32(dst + i, vcombine_s32(lo, hi));
+    }
+    return i;
+}
+#endif
+
+void mcp_convert_f64_to_int(const double *src, int *dst, size_t count) {
+    size_t i = 0;
+
+#if CONVERT_HAVE_X86
+    if (__builtin_cpu_supports("avx")) {
+        i = convert_f64_to_int_avx(src, dst, count);
+    } else {
+        i = convert_f64_to_int_sse2(src, dst, count);
+    }
+#elif CONVERT_HAVE_NEON
+    i = convert_f64_to_int_neon(src, dst, count);
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = (int)src[i];
+    }
+}
+
+void mcp_convert_f64_to_bool(const double *src, bool *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = src[i] != 0.0;
+    }
+}
+
+void mcp_convert_f64_from_le(double *values, size_t count) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = 0; i < count; i++) {
+        uint64_t bits;
+        memcpy(&bits, &values[i], sizeof(bits));
+        bits = __builtin_bswap64(bits);
+        memcpy(&values[i], &bits, sizeof(bits));
+    }
+#else
+    (void)values;
+    (void)count;
+#endif
+}
@@ -0,0 +1,17 @@
+#ifndef MCP_ARRAY_CONVERT_H
+#define MCP_ARRAY_CONVERT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Bulk conversions for numeric array parameters. Values are truncated toward
+// zero like a C cast; results for values outside the int range are unspecified.
+// Uses AVX (x86, picked at runtime), SSE2 or NEON where available.
+
+void mcp_convert_f64_to_int(const double *src, int *dst, size_t count);
+void mcp_convert_f64_to_bool(const double *src, bool *dst, size_t count);
+
+// Reinterpret little-endian float64 bytes in place (no-op on little-endian hosts)
+void mcp_convert_f64_from_le(double *values, size_t count);
+
+#endif // MCP_ARRAY_CONVERT_H
@@ -1,10 +1,26 @@
 /*
  * Base64 encoding/decoding Implementation
  * Based on RFC 4648 standard
- * Simple and reliable implementation
+ * Encoding uses SSSE3/AVX2 (x86, picked at runtime) or NEON (AArch64) when
+ * available, with a portable scalar path for everything else
  */
 
 #include "base64.h"
+#include <stdint.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BASE64_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define BASE64_HAVE_X86 0
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define BASE64_HAVE_NEON 1
+#include <arm_neon.h>
+#else
+#define BASE64_HAVE_NEON 0
+#endif
 
 static const char base64_chars[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -34,28 +50,179 @@ size_t base64_decoded_size(const char *src, size_t len) {
     return (len * 3) / 4 - padding;
 }
 
-size_t base64_encode(const unsigned char *src, size_t len, char *out, size_t out_len) {
-    size_t encoded_len = base64_encoded_size(len);
-    if (out_len < encoded_len + 1) return 0; // +1 for null terminator
+// Scalar encoder, also handles the tail left over by the vector paths
+static size_t base64_encode_scalar(const unsigned char *src, size_t len, char *out) {
+    size_t i = 0, j = 0;
 
-    size_t i, j;
-    for (i = 0, j = 0; i < len; i += 3, j += 4) {
+    for (; len - i >= 3; i += 3, j += 4) {
+        unsigned int triple = ((unsigned int)src[i] << 16) |
+                              ((unsigned int)src[i + 1] << 8) | src[i + 2];
+
+        out[j]     = base64_chars[(triple >> 18) & 63];
+        out[j + 1] = base64_chars[(triple >> 12) & 63];
+        out[j + 2] = base64_chars[(triple >> 6) & 63];
+        out[j + 3] = base64_chars[triple & 63];
+    }
+
+    if (i < len) {
         unsigned int a = src[i];
         unsigned int b = (i + 1 < len) ? src[i + 1] : 0;
-        unsigned int c = (i + 2 < len) ? src[i + 2] : 0;
-
-        unsigned int triple = (a << 16) + (b << 8) + c;
+        unsigned int triple = (a << 16) | (b << 8);
 
         out[j]     = base64_chars[(triple >> 18) & 63];
         out[j + 1] = base64_chars[(triple >> 12) & 63];
         out[j + 2] = (i + 1 < len) ? base64_chars[(triple >> 6) & 63] : '=';
-        out[j + 3] = (i + 2 < len) ? base64_chars[triple & 63] : '=';
+        out[j + 3] = '=';
+        j += 4;
     }
 
+    return j;
+}
+
+#if BASE64_HAVE_X86
+/*
+ * SSSE3/AVX2 encoders (Mula/Lemire): shuffle 3-byte groups into 32-bit lanes,
+ * split them into four 6-bit indices with multiplies, then map indices to ASCII
+ * with one pshufb lookup of per-range offsets. Built with target attributes
+ * and selected at runtime, so the baseline build flags are unchanged.
+ */
+#define BASE64_X86_TARGET(isa) __attribute__((target(isa)))
+
+BASE64_X86_TARGET("ssse3")
+static inline __m128i base64_x86_indices(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+BASE64_X86_TARGET("ssse3")
+static inline __m128i base64_x86_ascii(__m128i indices) {
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+// 12 input bytes per step; each load reads 16, so stop while 16 remain
+BASE64_X86_TARGET("ssse3")
+static size_t base64_encode_ssse3(const unsigned char *src, size_t len, char *out) {
+    size_t i = 0;
+    for (; len - i >= 16; i += 12) {
+        __m128i in = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(out + i / 3 * 4), base64_x86_ascii(base64_x86_indices(in)));
+    }
+    return i;
+}
+
+BASE64_X86_TARGET("avx2")
+static size_t base64_encode_avx2(const unsigned char *src, size_t len, char *out) {
+    const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                            10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                             'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+
+    // 24 input bytes per step as two 12-byte groups, one per 128-bit lane
+    for (; len - i >= 28; i += 24) {
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + i))),
+            _mm_loadu_si128((const __m128i*)(src + i + 12)), 1);
+
+        in = _mm256_shuffle_epi8(in, shuffle);
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+        const __m256i ascii = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+
+        _mm256_storeu_si256((__m256i*)(out + i / 3 * 4), ascii);
+    }
+
+    return i;
+}
+#endif /* BASE64_HAVE_X86 */
+
+#if BASE64_HAVE_NEON
+// 48 input bytes per step: de-interleave into byte planes and look indices up in a 64-byte table
+static size_t base64_encode_neon(const unsigned char *src, size_t len, char *out) {
+    uint8x16x4_t table;
+    table.val[0] = vld1q_u8((const uint8_t*)base64_chars);
+    table.val[1] = vld1q_u8((const uint8_t*)base64_chars + 16);
+    table.val[2] = vld1q_u8((const uint8_t*)base64_chars + 32);
+    table.val[3] = vld1q_u8((const uint8_t*)base64_chars + 48);
+
+    const uint8x16_t mask6 = vdupq_n_u8(0x3f);
+    size_t i = 0;
+
+    for (; len - i >= 48; i += 48) {
+        uint8x16x3_t in = vld3q_u8(src + i);
+        uint8x16x4_t result;
+
+        result.val[0] = vshrq_n_u8(in.val[0], 2);
+        result.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask6);
+        result.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask6);
+        result.val[3] = vandq_u8(in.val[2], mask6);
+
+        result.val[0] = vqtbl4q_u8(table, result.val[0]);
+        result.val[1] = vqtbl4q_u8(table, result.val[1]);
+        result.val[2] = vqtbl4q_u8(table, result.val[2]);
+        result.val[3] = vqtbl4q_u8(table, result.val[3]);
+
+        vst4q_u8((uint8_t*)out + i / 3 * 4, result);
+    }
+
+    return i;
+}
+#endif /* BASE64_HAVE_NEON */
+
+size_t base64_encode_raw(const unsigned char *src, size_t len, char *out) {
+    size_t done = 0;
+
+#if BASE64_HAVE_X86
+    if (__builtin_cpu_supports("avx2")) {
+        done = base64_encode_avx2(src, len, out);
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        done += base64_encode_ssse3(src + done, len - done, out + done / 3 * 4);
+    }
+#elif BASE64_HAVE_NEON
+    done = base64_encode_neon(src, len, out);
+#endif
+
+    return done / 3 * 4 + base64_encode_scalar(src + done, len - done, out + done / 3 * 4);
+}
+
+size_t base64_encode(const unsigned char *src, size_t len, char *out, size_t out_len) {
+    size_t encoded_len = base64_encoded_size(len);
+    if (out_len < encoded_len + 1) return 0; // +1 for null terminator
+
+    base64_encode_raw(src, len, out);
+
     out[encoded_len] = '\0';
     return encoded_len;
 }
 
+// Bytes outside ASCII are invalid rather than negative table indices
+static int base64_decode_char(char c) {
+    unsigned char byte = (unsigned char)c;
+    return byte < 128 ? base64_decode_table[byte] : -1;
+}
+
 size_t base64_decode(const char *src, size_t len, unsigned char *out, size_t out_len) {
     if (len % 4 != 0) return 0;
 
@@ -64,10 +231,10 @@ size_t base64_decode(const char *src, size_t len, unsigned char *out, size_t out
 
     size_t i, j;
     for (i = 0, j = 0; i < len; i += 4, j += 3) {
-        int a = base64_decode_table[(int)src[i]];
-        int b = base64_decode_table[(int)src[i + 1]];
-        int c = (src[i + 2] == '=') ? 0 : base64_decode_table[(int)src[i + 2]];
-        int d = (src[i + 3] == '=') ? 0 : base64_decode_table[(int)src[i + 3]];
+        int a = base64_decode_char(src[i]);
+        int b = base64_decode_char(src[i + 1]);
+        int c = (src[i + 2] == '=') ? 0 : base64_decode_char(src[i + 2]);
+        int d = (src[i + 3] == '=') ? 0 : base64_decode_char(src[i + 3]);
 
         if (a == -1 || b == -1 || c == -1 || d == -1) return 0;
 
@@ -16,6 +16,9 @@ extern "C" {
 /* Base64 encode */
 size_t base64_encode(const unsigned char *src, size_t len, char *out, size_t out_len);
 
+/* Base64 encode into a buffer of at least base64_encoded_size(len) bytes, no terminator */
+size_t base64_encode_raw(const unsigned char *src, size_t len, char *out);
+
 /* Base64 decode */
 size_t base64_decode(const char *src, size_t len, unsigned char *out, size_t out_len);
 
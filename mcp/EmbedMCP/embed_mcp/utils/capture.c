@@ -0,0 +1,298 @@
+#include "utils/capture.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CAPTURE_BUCKETS 256
+#define CAPTURE_FILE_BUFFER 65536
+#define CAPTURE_LABEL_MAX 48
+
+struct mcp_capture_stream {
+    const void *key;
+    uint64_t id;
+    FILE *file;
+    uint64_t start_us;              // Monotonic time of the header
+    mcp_capture_stream_t *next_key;
+    mcp_capture_stream_t *next_id;
+};
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+static uint64_t wall_clock_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+static void put_u64(unsigned char *out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+static void put_u32(unsigned char *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+static uint64_t get_u64(const unsigned char *in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) value = (value << 8) | in[i];
+    return value;
+}
+
+static uint32_t get_u32(const unsigned char *in) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) value = (value << 8) | in[i];
+    return value;
+}
+
+static size_t key_bucket(const mcp_capture_t *capture, const void *key) {
+    uint64_t hash = (uint64_t)(uintptr_t)key * 0x9E3779B97F4A7C15ull;
+    return (size_t)(hash >> 32) & (capture->bucket_count - 1);
+}
+
+static size_t id_bucket(const mcp_capture_t *capture, uint64_t id) {
+    return (size_t)id & (capture->bucket_count - 1);
+}
+
+// Internal table helpers - caller holds the mutex
+static mcp_capture_stream_t *find_by_key(mcp_capture_t *capture, const void *key) {
+    mcp_capture_stream_t *stream = capture->by_key[key_bucket(capture, key)];
+    while (stream && stream->key != key) stream = stream->next_key;
+    return stream;
+}
+
+static mcp_capture_stream_t *find_by_id(mcp_capture_t *capture, uint64_t id) {
+    mcp_capture_stream_t *stream = capture->by_id[id_bucket(capture, id)];
+    while (stream && stream->id != id) stream = stream->next_id;
+    return stream;
+}
+
+static void unlink_stream(mcp_capture_t *capture, mcp_capture_stream_t *stream) {
+    mcp_capture_stream_t **link = &capture->by_key[key_bucket(capture, stream->key)];
+    while (*link != stream) link = &(*link)->next_key;
+    *link = stream->next_key;
+
+    link = &capture->by_id[id_bucket(capture, stream->id)];
+    while (*link != stream) link = &(*link)->next_id;
+    *link = stream->next_id;
+
+    capture->stream_count--;
+}
+
+static void close_stream(mcp_capture_stream_t *stream) {
+    if (stream->file) fclose(stream->file);
+    free(stream);
+}
+
+// File names only keep characters that are safe in any file system
+static void sanitize_label(char *out, size_t size, const char *label) {
+    size_t n = 0;
+    for (; label && *label && n + 1 < size; label++) {
+        char c = *label;
+        bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                    c == '-' || c == '_';
+        out[n++] = safe ? c : '_';
+    }
+    out[n] = '\0';
+}
+
+mcp_capture_t *mcp_capture_create(const char *directory) {
+    if (!directory || !*directory) return NULL;
+
+    mcp_capture_t *capture = calloc(1, sizeof(mcp_capture_t));
+    if (!capture) return NULL;
+
+    capture->directory = strdup(directory);
+    capture->bucket_count = CAPTURE_BUCKETS;
+    capture->by_key = calloc(capture->bucket_count, sizeof(mcp_capture_stream_t*));
+    capture->by_id = calloc(capture->bucket_count, sizeof(mcp_capture_stream_t*));
+    if (!capture->directory || !capture->by_key || !capture->by_id ||
+        pthread_mutex_init(&capture->mutex, NULL) != 0) {
+        free(capture->directory);
+        free(capture->by_key);
+        free(capture->by_id);
+        free(capture);
+        return NULL;
+    }
+
+    capture->run_id = wall_clock_us() / 1000000ull;
+    capture->next_stream_id = 1;
+    return capture;
+}
+
+void mcp_capture_destroy(mcp_capture_t *capture) {
+    if (!capture) return;
+
+    for (size_t i = 0; i < capture->bucket_count; i++) {
+        mcp_capture_stream_t *stream = capture->by_key[i];
+        while (stream) {
+            mcp_capture_stream_t *next = stream->next_key;
+            close_stream(stream);
+            stream = next;
+        }
+    }
+
+    pthread_mutex_destroy(&capture->mutex);
+    free(capture->by_key);
+    free(capture->by_id);
+    free(capture->directory);
+    free(capture);
+}
+
+uint64_t mcp_capture_stream(mcp_capture_t *capture, const void *key, const char *label) {
+    if (!capture || !key) return 0;
+
+    pthread_mutex_lock(&capture->mutex);
+    mcp_capture_stream_t *stream = find_by_key(capture, key);
+    if (stream) {
+        uint64_t id = stream->id;
+        pthread_mutex_unlock(&capture->mutex);
+        return id;
+    }
+
+    stream = calloc(1, sizeof(mcp_capture_stream_t));
+    if (!stream) {
+        pthread_mutex_unlock(&capture->mutex);
+        return 0;
+    }
+    stream->key = key;
+    stream->id = capture->next_stream_id++;
+
+    char safe_label[CAPTURE_LABEL_MAX];
+    sanitize_label(safe_label, sizeof(safe_label), label);
+    size_t path_size = strlen(capture->directory) + sizeof(safe_label) + 64;
+    char *path = malloc(path_size);
+    if (path) {
+        snprintf(path, path_size, "%s/%llu-%llu%s%s" MCP_CAPTURE_FILE_SUFFIX, capture->directory,
+                 (unsigned long long)capture->run_id, (unsigned long long)stream->id,
+                 safe_label[0] ? "-" : "", safe_label);
+        stream->file = fopen(path, "ab");
+        free(path);
+    }
+
+    unsigned char header[MCP_CAPTURE_HEADER_SIZE];
+    memcpy(header, MCP_CAPTURE_MAGIC, MCP_CAPTURE_MAGIC_SIZE);
+    put_u64(header + MCP_CAPTURE_MAGIC_SIZE, wall_clock_us());
+    stream->start_us = monotonic_us();
+
+    if (!stream->file || setvbuf(stream->file, NULL, _IOFBF, CAPTURE_FILE_BUFFER) != 0 ||
+        fwrite(header, 1, sizeof(header), stream->file) != sizeof(header)) {
+        close_stream(stream);
+        pthread_mutex_unlock(&capture->mutex);
+        return 0;
+    }
+
+    size_t key_index = key_bucket(capture, key);
+    stream->next_key = capture->by_key[key_index];
+    capture->by_key[key_index] = stream;
+    size_t id_index = id_bucket(capture, stream->id);
+    stream->next_id = capture->by_id[id_index];
+    capture->by_id[id_index] = stream;
+    capture->stream_count++;
+
+    uint64_t id = stream->id;
+    pthread_mutex_unlock(&capture->mutex);
+    return id;
+}
+
+void mcp_capture_close(mcp_capture_t *capture, const void *key) {
+    if (!capture || !key) return;
+
+    pthread_mutex_lock(&capture->mutex);
+    mcp_capture_stream_t *stream = find_by_key(capture, key);
+    if (stream) {
+        unlink_stream(capture, stream);
+    }
+    pthread_mutex_unlock(&capture->mutex);
+
+    if (stream) {
+        close_stream(stream);
+    }
+}
+
+void mcp_capture_record(mcp_capture_t *capture, uint64_t stream_id, mcp_capture_direction_t direction,
+                        const char *data, size_t length) {
+    if (!capture || stream_id == 0 || !data || length > UINT32_MAX) return;
+
+    unsigned char header[MCP_CAPTURE_RECORD_HEADER_SIZE];
+    put_u32(header + 8, (uint32_t)length);
+    header[12] = (unsigned char)direction;
+
+    pthread_mutex_lock(&capture->mutex);
+    mcp_capture_stream_t *stream = find_by_id(capture, stream_id);
+    if (!stream) {
+        capture->dropped++;
+        pthread_mutex_unlock(&capture->mutex);
+        return;
+    }
+
+    // Stamped under the lock so records in a file are in time order
+    put_u64(header, monotonic_us() - stream->start_us);
+    if (fwrite(header, 1, sizeof(header), stream->file) == sizeof(header) &&
+        fwrite(data, 1, length, stream->file) == length) {
+        capture->records++;
+    } else {
+        capture->dropped++;
+    }
+    pthread_mutex_unlock(&capture->mutex);
+}
+
+// =============================================================================
+// Reading capture files
+// =============================================================================
+
+int mcp_capture_reader_open(mcp_capture_reader_t *reader, const char *path) {
+    if (!reader || !path) return -1;
+    memset(reader, 0, sizeof(*reader));
+
+    reader->file = fopen(path, "rb");
+    if (!reader->file) return -1;
+
+    unsigned char header[MCP_CAPTURE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), reader->file) != sizeof(header) ||
+        memcmp(header, MCP_CAPTURE_MAGIC, MCP_CAPTURE_MAGIC_SIZE) != 0) {
+        fclose(reader->file);
+        reader->file = NULL;
+        return -1;
+    }
+
+    reader->start_us = get_u64(header + MCP_CAPTURE_MAGIC_SIZE);
+    return 0;
+}
+
+int mcp_capture_reader_next(mcp_capture_reader_t *reader, mcp_capture_frame_t *frame) {
+    if (!reader || !reader->file || !frame) return -1;
+
+    unsigned char header[MCP_CAPTURE_RECORD_HEADER_SIZE];
+    size_t count = fread(header, 1, sizeof(header), reader->file);
+    if (count == 0 && feof(reader->file)) return 0;
+    if (count != sizeof(header) || header[12] > MCP_CAPTURE_OUTBOUND) return -1;
+
+    size_t length = get_u32(header + 8);
+    if (length + 1 > reader->capacity) {
+        size_t capacity = reader->capacity ? reader->capacity : 4096;
+        while (capacity < length + 1) capacity *= 2;
+        char *buffer = realloc(reader->buffer, capacity);
+        if (!buffer) return -1;
+        reader->buffer = buffer;
+        reader->capacity = capacity;
+    }
+    if (fread(reader->buffer, 1, length, reader->file) != length) return -1;
+    reader->buffer[length] = '\0';
+
+    frame->time_us = get_u64(header);
+    frame->direction = (mcp_capture_direction_t)header[12];
+    frame->data = reader->buffer;
+    frame->length = length;
+    return 1;
+}
+
+void mcp_capture_reader_close(mcp_capture_reader_t *reader) {
+    if (!reader) return;
+    if (reader->file) fclose(reader->file);
+    free(reader->buffer);
+    memset(reader, 0, sizeof(*reader));
+}
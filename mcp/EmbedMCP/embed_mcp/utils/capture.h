@@ -0,0 +1,96 @@
+#ifndef MCP_CAPTURE_H
+#define MCP_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+
+// Traffic capture: timestamped inbound and outbound JSON-RPC frames, appended to
+// one file per session (a transport connection, or its MCP session when it has one).
+//
+// File layout, all integers little-endian:
+//   header  "EMCPCAP1", u64 wall-clock time the file was opened (us since the epoch)
+//   record  u64 time since the header (us), u32 frame length, u8 direction, frame bytes
+//
+// Records are buffered and reach the file when the session closes or the capture
+// is destroyed.
+
+#define MCP_CAPTURE_MAGIC "EMCPCAP1"
+#define MCP_CAPTURE_MAGIC_SIZE 8
+#define MCP_CAPTURE_HEADER_SIZE 16
+#define MCP_CAPTURE_RECORD_HEADER_SIZE 13
+#define MCP_CAPTURE_FILE_SUFFIX ".mcap"
+
+typedef enum {
+    MCP_CAPTURE_INBOUND = 0,    // Client to server
+    MCP_CAPTURE_OUTBOUND = 1    // Server to client
+} mcp_capture_direction_t;
+
+typedef struct mcp_capture_stream mcp_capture_stream_t;
+
+typedef struct {
+    char *directory;
+    uint64_t run_id;                        // Start time (s), keeps file names unique across runs
+    uint64_t next_stream_id;
+    mcp_capture_stream_t **by_key;          // Open streams by session key
+    mcp_capture_stream_t **by_id;           // The same streams by id
+    size_t bucket_count;                    // Power of two
+    size_t stream_count;
+    uint64_t records;
+    uint64_t dropped;                       // Records for closed streams or failed writes
+    pthread_mutex_t mutex;
+} mcp_capture_t;
+
+/**
+ * Capture into files under directory (which must exist)
+ * @return Allocated capture, or NULL on error
+ */
+mcp_capture_t *mcp_capture_create(const char *directory);
+
+// Closes every open stream
+void mcp_capture_destroy(mcp_capture_t *capture);
+
+/**
+ * Stream of the session identified by key, opened on first use
+ * @param key Any pointer that stays unique while the session is open
+ * @param label Added to the file name (session id or transport name), may be NULL
+ * @return Stream id for mcp_capture_record(), or 0 if the file could not be opened
+ */
+uint64_t mcp_capture_stream(mcp_capture_t *capture, const void *key, const char *label);
+
+// Close the session's file; later records for its id are dropped
+void mcp_capture_close(mcp_capture_t *capture, const void *key);
+
+// Append one frame; stream ids that are 0 or closed are ignored
+void mcp_capture_record(mcp_capture_t *capture, uint64_t stream_id, mcp_capture_direction_t direction,
+                        const char *data, size_t length);
+
+// =============================================================================
+// Reading capture files
+// =============================================================================
+
+typedef struct {
+    uint64_t time_us;                   // Since the file header
+    mcp_capture_direction_t direction;
+    const char *data;                   // Valid until the next read
+    size_t length;
+} mcp_capture_frame_t;
+
+typedef struct {
+    FILE *file;
+    uint64_t start_us;                  // Wall-clock time from the header
+    char *buffer;
+    size_t capacity;
+} mcp_capture_reader_t;
+
+// @return 0 on success, -1 if the file cannot be read or is not a capture
+int mcp_capture_reader_open(mcp_capture_reader_t *reader, const char *path);
+
+// @return 1 with the next frame, 0 at the end of the file, -1 on a truncated or bad record
+int mcp_capture_reader_next(mcp_capture_reader_t *reader, mcp_capture_frame_t *frame);
+
+void mcp_capture_reader_close(mcp_capture_reader_t *reader);
+
+#endif // MCP_CAPTURE_H
@@ -0,0 +1,248 @@
+#include "utils/compress.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// Accept-Encoding parsing does not need zlib
+static double encoding_quality(const char *params, size_t length) {
+    // params is what follows the coding name, e.g. ";q=0.5"
+    const char *q = NULL;
+    for (size_t i = 0; i + 1 < length; i++) {
+        if ((params[i] == 'q' || params[i] == 'Q') && params[i + 1] == '=') {
+            q = params + i + 2;
+            break;
+        }
+    }
+    return q ? strtod(q, NULL) : 1.0;
+}
+
+mcp_compress_encoding_t mcp_compress_negotiate(const char *accept_encoding) {
+    if (!accept_encoding || !mcp_compress_available()) return MCP_COMPRESS_NONE;
+
+    double gzip = -1.0, deflate = -1.0, any = -1.0;
+    const char *p = accept_encoding;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        const char *name = p;
+        while (*p && *p != ',' && *p != ';' && *p != ' ' && *p != '\t') p++;
+        size_t name_len = (size_t)(p - name);
+        const char *params = p;
+        while (*p && *p != ',') p++;
+        if (name_len == 0) continue;
+
+        double quality = encoding_quality(params, (size_t)(p - params));
+        if ((name_len == 4 && strncasecmp(name, "gzip", 4) == 0) ||
+            (name_len == 6 && strncasecmp(name, "x-gzip", 6) == 0)) {
+            gzip = quality;
+        } else if (name_len == 7 && strncasecmp(name, "deflate", 7) == 0) {
+            deflate = quality;
+        } else if (name_len == 1 && name[0] == '*') {
+            any = quality;
+        }
+    }
+
+    if (gzip < 0) gzip = any;
+    if (deflate < 0) deflate = any;
+    if (gzip > 0 && gzip >= deflate) return MCP_COMPRESS_GZIP;
+    if (deflate > 0) return MCP_COMPRESS_DEFLATE;
+    return MCP_COMPRESS_NONE;
+}
+
+const char *mcp_compress_encoding_name(mcp_compress_encoding_t encoding) {
+    switch (encoding) {
+        case MCP_COMPRESS_GZIP: return "gzip";
+        case MCP_COMPRESS_DEFLATE: return "deflate";
+        default: return "identity";
+    }
+}
+
+void mcp_compress_segment_free(mcp_compress_segment_t *segment) {
+    if (!segment) return;
+    free(segment->data);
+    memset(segment, 0, sizeof(*segment));
+}
+
+#ifdef MCP_ENABLE_COMPRESSION
+
+#include <pthread.h>
+#include <zlib.h>
+
+// One raw deflate stream per thread, reset between segments; deflateInit allocates
+// a few hundred KB, far more than compressing a typical response costs
+typedef struct {
+    z_stream stream;
+    int level;
+} compress_thread_state_t;
+
+static pthread_key_t g_compress_key;
+static pthread_once_t g_compress_once = PTHREAD_ONCE_INIT;
+
+static void compress_state_destroy(void *arg) {
+    compress_thread_state_t *state = (compress_thread_state_t*)arg;
+    deflateEnd(&state->stream);
+    free(state);
+}
+
+static void compress_key_init(void) {
+    pthread_key_create(&g_compress_key, compress_state_destroy);
+}
+
+static z_stream *compress_thread_stream(int level) {
+    if (level < 1 || level > 9) level = Z_DEFAULT_COMPRESSION;
+
+    pthread_once(&g_compress_once, compress_key_init);
+    compress_thread_state_t *state = pthread_getspecific(g_compress_key);
+    if (state && state->level != level) {
+        deflateEnd(&state->stream);
+        if (deflateInit2(&state->stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            pthread_setspecific(g_compress_key, NULL);
+            free(state);
+            return NULL;
+        }
+        state->level = level;
+    }
+
+    if (!state) {
+        state = calloc(1, sizeof(compress_thread_state_t));
+        if (!state) return NULL;
+        if (deflateInit2(&state->stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            free(state);
+            return NULL;
+        }
+        state->level = level;
+        if (pthread_setspecific(g_compress_key, state) != 0) {
+            deflateEnd(&state->stream);
+            free(state);
+            return NULL;
+        }
+    }
+
+    if (deflateReset(&state->stream) != Z_OK) return NULL;
+    return &state->stream;
+}
+
+bool mcp_compress_available(void) {
+    return true;
+}
+
+int mcp_compress_segment(mcp_compress_segment_t *segment, const void *data, size_t length,
+                         int level, bool final) {
+    if (!segment || (!data && length > 0) || length > UINT32_MAX) return -1;
+
+    z_stream *stream = compress_thread_stream(level);
+    if (!stream) return -1;
+
+    // deflateBound covers Z_FINISH; a sync flush adds at most an empty stored block
+    size_t bound = deflateBound(stream, (uLong)length) + 16;
+    unsigned char *out = realloc(segment->data, bound);
+    if (!out) return -1;
+    segment->data = out;
+
+    stream->next_in = (Bytef*)data;
+    stream->avail_in = (uInt)length;
+    stream->next_out = out;
+    stream->avail_out = (uInt)bound;
+
+    int result = deflate(stream, final ? Z_FINISH : Z_SYNC_FLUSH);
+    if ((final && result != Z_STREAM_END) || (!final && result != Z_OK) ||
+        stream->avail_in != 0 || stream->avail_out == 0) {
+        return -1;
+    }
+
+    segment->length = bound - stream->avail_out;
+    segment->input_length = length;
+    segment->crc32 = (uint32_t)crc32(0L, (const Bytef*)data, (uInt)length);
+    segment->adler32 = (uint32_t)adler32(1L, (const Bytef*)data, (uInt)length);
+    return 0;
+}
+
+static int write_be32(mcp_json_buffer_t *out, uint32_t value) {
+    unsigned char bytes[4] = {
+        (unsigned char)(value >> 24), (unsigned char)(value >> 16),
+        (unsigned char)(value >> 8), (unsigned char)value
+    };
+    return mcp_json_write_raw(out, (const char*)bytes, sizeof(bytes));
+}
+
+static int write_le32(mcp_json_buffer_t *out, uint32_t value) {
+    unsigned char bytes[4] = {
+        (unsigned char)value, (unsigned char)(value >> 8),
+        (unsigned char)(value >> 16), (unsigned char)(value >> 24)
+    };
+    return mcp_json_write_raw(out, (const char*)bytes, sizeof(bytes));
+}
+
+int mcp_compress_assemble(mcp_json_buffer_t *out, mcp_compress_encoding_t encoding,
+                          const mcp_compress_segment_t *const *segments, size_t count) {
+    if (!out || !segments || count == 0 || encoding == MCP_COMPRESS_NONE) return -1;
+
+    size_t total = 18;
+    for (size_t i = 0; i < count; i++) total += segments[i]->length;
+    if (mcp_json_buffer_reserve(out, total) != 0) return -1;
+
+    // gzip: magic, deflate, no flags, no mtime, no extra flags, OS unknown
+    static const unsigned char gzip_header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+    // zlib: 32K window deflate, default level, no dictionary
+    static const unsigned char zlib_header[2] = { 0x78, 0x9c };
+    int result = encoding == MCP_COMPRESS_GZIP
+        ? mcp_json_write_raw(out, (const char*)gzip_header, sizeof(gzip_header))
+        : mcp_json_write_raw(out, (const char*)zlib_header, sizeof(zlib_header));
+
+    uLong crc = segments[0]->crc32;
+    uLong adler = segments[0]->adler32;
+    size_t input_length = 0;
+    for (size_t i = 0; result == 0 && i < count; i++) {
+        const mcp_compress_segment_t *segment = segments[i];
+        if (i > 0) {
+            crc = crc32_combine(crc, segment->crc32, (z_off_t)segment->input_length);
+            adler = adler32_combine(adler, segment->adler32, (z_off_t)segment->input_length);
+        }
+        input_length += segment->input_length;
+        result = mcp_json_write_raw(out, (const char*)segment->data, segment->length);
+    }
+
+    if (result == 0) {
+        result = encoding == MCP_COMPRESS_GZIP
+            ? (write_le32(out, (uint32_t)crc) != 0 || write_le32(out, (uint32_t)input_length) != 0 ? -1 : 0)
+            : write_be32(out, (uint32_t)adler);
+    }
+    return result;
+}
+
+int mcp_compress_buffer(mcp_json_buffer_t *out, mcp_compress_encoding_t encoding,
+                        const void *data, size_t length, int level) {
+    mcp_compress_segment_t segment = { 0 };
+    int result = mcp_compress_segment(&segment, data, length, level, true);
+    if (result == 0) {
+        const mcp_compress_segment_t *segments[1] = { &segment };
+        result = mcp_compress_assemble(out, encoding, segments, 1);
+    }
+    mcp_compress_segment_free(&segment);
+    return result;
+}
+
+#else // !MCP_ENABLE_COMPRESSION
+
+bool mcp_compress_available(void) {
+    return false;
+}
+
+int mcp_compress_segment(mcp_compress_segment_t *segment, const void *data, size_t length,
+                         int level, bool final) {
+    (void)segment; (void)data; (void)length; (void)level; (void)final;
+    return -1;
+}
+
+int mcp_compress_assemble(mcp_json_buffer_t *out, mcp_compress_encoding_t encoding,
+                          const mcp_compress_segment_t *const *segments, size_t count) {
+    (void)out; (void)encoding; (void)segments; (void)count;
+    return -1;
+}
+
+int mcp_compress_buffer(mcp_json_buffer_t *out, mcp_compress_encoding_t encoding,
+                        const void *data, size_t length, int level) {
+    (void)out; (void)encoding; (void)data; (void)length; (void)level;
+    return -1;
+}
+
+#endif // MCP_ENABLE_COMPRESSION
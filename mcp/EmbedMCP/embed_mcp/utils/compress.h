@@ -0,0 +1,52 @@
+#ifndef MCP_COMPRESS_H
+#define MCP_COMPRESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "protocol/json_writer.h"
+
+// HTTP response compression (gzip / zlib "deflate"), built with -DMCP_ENABLE_COMPRESSION
+// and linked against zlib (make COMPRESSION=1). Without it every call reports failure
+// and responses go out uncompressed.
+//
+// Bodies are compressed as independent raw deflate segments that are spliced into one
+// stream: only the last segment is final, the others end on a byte boundary
+// (Z_SYNC_FLUSH). A segment compressed once - e.g. the part of a cached response
+// after its id - can be reused behind a freshly compressed prefix.
+
+typedef enum {
+    MCP_COMPRESS_NONE = 0,
+    MCP_COMPRESS_GZIP,
+    MCP_COMPRESS_DEFLATE
+} mcp_compress_encoding_t;
+
+typedef struct {
+    unsigned char *data;        // Raw deflate bytes
+    size_t length;
+    size_t input_length;        // Uncompressed size
+    uint32_t crc32;             // Of the uncompressed bytes (gzip trailer)
+    uint32_t adler32;           // Of the uncompressed bytes (zlib trailer)
+} mcp_compress_segment_t;
+
+bool mcp_compress_available(void);
+
+// Pick an encoding from an Accept-Encoding header (gzip preferred, q=0 honoured)
+mcp_compress_encoding_t mcp_compress_negotiate(const char *accept_encoding);
+const char *mcp_compress_encoding_name(mcp_compress_encoding_t encoding);
+
+// Compress data into segment (level 1-9); returns 0 on success. The segment's buffer
+// is reused across calls and released with mcp_compress_segment_free().
+int mcp_compress_segment(mcp_compress_segment_t *segment, const void *data, size_t length,
+                         int level, bool final);
+void mcp_compress_segment_free(mcp_compress_segment_t *segment);
+
+// Append header, segments (the last one final) and trailer to out
+int mcp_compress_assemble(mcp_json_buffer_t *out, mcp_compress_encoding_t encoding,
+                          const mcp_compress_segment_t *const *segments, size_t count);
+
+// Compress a whole body into out; returns 0 on success
+int mcp_compress_buffer(mcp_json_buffer_t *out, mcp_compress_encoding_t encoding,
+                        const void *data, size_t length, int level);
+
+#endif // MCP_COMPRESS_H
@@ -0,0 +1,35 @@
+#include "utils/counter.h"
+
+#if defined(__GNUC__)
+static __thread unsigned t_shard = 0;      // Shard index + 1, 0 until assigned
+#else
+static unsigned t_shard = 0;
+#endif
+
+static unsigned g_next_shard = 0;
+
+unsigned mcp_counter_shard(void) {
+    if (t_shard == 0) {
+        unsigned shard = __atomic_fetch_add(&g_next_shard, 1, __ATOMIC_RELAXED);
+        t_shard = (shard & (MCP_COUNTER_SHARDS - 1)) + 1;
+    }
+    return t_shard - 1;
+}
+
+uint64_t mcp_counter_read(const mcp_counter_t *counter) {
+    if (!counter) return 0;
+
+    uint64_t total = 0;
+    for (unsigned i = 0; i < MCP_COUNTER_SHARDS; i++) {
+        total += __atomic_load_n(&counter->cells[i].value, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+void mcp_counter_reset(mcp_counter_t *counter) {
+    if (!counter) return;
+
+    for (unsigned i = 0; i < MCP_COUNTER_SHARDS; i++) {
+        __atomic_store_n(&counter->cells[i].value, 0, __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef MCP_COUNTER_H
+#define MCP_COUNTER_H
+
+#include <stdint.h>
+
+// Sharded statistics counters. Each thread adds to its own shard with a relaxed
+// atomic, so hot counters never bounce one cache line (or a lock) between cores;
+// readers sum the shards. Reads are not a consistent snapshot across counters.
+
+// Power of two; embedded builds can use -DMCP_COUNTER_SHARDS=1
+#ifndef MCP_COUNTER_SHARDS
+#define MCP_COUNTER_SHARDS 8
+#endif
+
+#define MCP_CACHE_LINE_SIZE 64
+
+#if defined(__GNUC__)
+#define MCP_CACHE_ALIGNED __attribute__((aligned(MCP_CACHE_LINE_SIZE)))
+#else
+#define MCP_CACHE_ALIGNED
+#endif
+
+typedef struct {
+    uint64_t value;
+} MCP_CACHE_ALIGNED mcp_counter_cell_t;
+
+typedef struct {
+    mcp_counter_cell_t cells[MCP_COUNTER_SHARDS];
+} mcp_counter_t;
+
+// Shard of the calling thread, assigned round-robin on first use
+unsigned mcp_counter_shard(void);
+
+static inline void mcp_counter_add(mcp_counter_t *counter, uint64_t amount) {
+    __atomic_add_fetch(&counter->cells[mcp_counter_shard()].value, amount, __ATOMIC_RELAXED);
+}
+
+static inline void mcp_counter_inc(mcp_counter_t *counter) {
+    mcp_counter_add(counter, 1);
+}
+
+uint64_t mcp_counter_read(const mcp_counter_t *counter);
+void mcp_counter_reset(mcp_counter_t *counter);
+
+#endif // MCP_COUNTER_H
@@ -0,0 +1,202 @@
+#include "utils/epoch.h"
+#include "utils/counter.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One thread's announcement. Records are never freed: the reclaimer may be reading
+// any of them; a thread that exits hands its record to the next thread that reads.
+typedef struct epoch_thread {
+    uint64_t epoch;             // Global epoch seen on entry, 0 while outside (atomic)
+    int in_use;                 // Owned by a live thread (atomic)
+    struct epoch_thread *next;
+} MCP_CACHE_ALIGNED epoch_thread_t;
+
+typedef struct epoch_retired {
+    struct epoch_retired *next;
+    uint64_t epoch;             // Global epoch when retired
+    void *ptr;
+    void (*free_fn)(void *ptr);
+} epoch_retired_t;
+
+static struct {
+    uint64_t global;            // Starts at 1; 0 marks a thread outside (atomic)
+    size_t anonymous;           // Readers without a record (out of memory), hold the epoch (atomic)
+    epoch_thread_t *threads;    // Prepended under mutex, walked without it (atomic head)
+    pthread_mutex_t mutex;      // Thread list additions and the retired list
+    epoch_retired_t *retired;   // Oldest last
+    size_t pending;             // Atomic
+} g_epoch = { .global = 1, .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+#if defined(__GNUC__)
+static __thread epoch_thread_t *t_self = NULL;
+static __thread unsigned t_depth = 0;
+static __thread bool t_anonymous = false;
+#else
+static epoch_thread_t *t_self = NULL;
+static unsigned t_depth = 0;
+static bool t_anonymous = false;
+#endif
+
+static pthread_key_t g_thread_key;
+static pthread_once_t g_thread_once = PTHREAD_ONCE_INIT;
+
+static void epoch_thread_exit(void *arg) {
+    epoch_thread_t *self = (epoch_thread_t*)arg;
+    __atomic_store_n(&self->epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&self->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void epoch_key_init(void) {
+    pthread_key_create(&g_thread_key, epoch_thread_exit);
+}
+
+// The calling thread's record, NULL if none can be registered
+static epoch_thread_t *epoch_thread(void) {
+    if (t_self) return t_self;
+
+    pthread_once(&g_thread_once, epoch_key_init);
+    pthread_mutex_lock(&g_epoch.mutex);
+
+    epoch_thread_t *self = __atomic_load_n(&g_epoch.threads, __ATOMIC_ACQUIRE);
+    while (self && __atomic_load_n(&self->in_use, __ATOMIC_ACQUIRE)) {
+        self = self->next;
+    }
+    if (self) {
+        __atomic_store_n(&self->in_use, 1, __ATOMIC_RELAXED);
+    } else {
+        void *memory = NULL;
+        if (posix_memalign(&memory, MCP_CACHE_LINE_SIZE, sizeof(epoch_thread_t)) != 0) {
+            pthread_mutex_unlock(&g_epoch.mutex);
+            return NULL;
+        }
+        self = (epoch_thread_t*)memory;
+        memset(self, 0, sizeof(*self));
+        self->in_use = 1;
+        self->next = g_epoch.threads;
+        __atomic_store_n(&g_epoch.threads, self, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&g_epoch.mutex);
+
+    pthread_setspecific(g_thread_key, self);
+    t_self = self;
+    return self;
+}
+
+void mcp_epoch_enter(void) {
+    if (t_depth++ > 0) return;
+
+    epoch_thread_t *self = epoch_thread();
+    if (self) {
+        __atomic_store_n(&self->epoch, __atomic_load_n(&g_epoch.global, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    } else {
+        __atomic_add_fetch(&g_epoch.anonymous, 1, __ATOMIC_SEQ_CST);
+        t_anonymous = true;
+    }
+    // Loads of published pointers must not move above the announcement
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void mcp_epoch_exit(void) {
+    if (t_depth == 0 || --t_depth > 0) return;
+
+    if (t_anonymous) {
+        __atomic_sub_fetch(&g_epoch.anonymous, 1, __ATOMIC_RELEASE);
+        t_anonymous = false;
+    } else {
+        __atomic_store_n(&t_self->epoch, 0, __ATOMIC_RELEASE);
+    }
+}
+
+// Move the global epoch on if every reader inside has seen the current one; the
+// caller holds the mutex so only one thread advances at a time
+static uint64_t epoch_try_advance(void) {
+    uint64_t global = __atomic_load_n(&g_epoch.global, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g_epoch.anonymous, __ATOMIC_SEQ_CST) > 0) return global;
+
+    for (epoch_thread_t *thread = __atomic_load_n(&g_epoch.threads, __ATOMIC_ACQUIRE); thread;
+         thread = thread->next) {
+        uint64_t epoch = __atomic_load_n(&thread->epoch, __ATOMIC_SEQ_CST);
+        if (epoch != 0 && epoch != global) return global;
+    }
+
+    __atomic_store_n(&g_epoch.global, global + 1, __ATOMIC_SEQ_CST);
+    return global + 1;
+}
+
+size_t mcp_epoch_reclaim(void) {
+    pthread_mutex_lock(&g_epoch.mutex);
+    if (!g_epoch.retired) {
+        pthread_mutex_unlock(&g_epoch.mutex);
+        return 0;
+    }
+
+    // Two steps cover the grace period when no reader is inside
+    epoch_try_advance();
+    uint64_t global = epoch_try_advance();
+
+    // Entries are newest first; everything from the first expired one on can go
+    epoch_retired_t **link = &g_epoch.retired;
+    while (*link && (*link)->epoch + 2 > global) {
+        link = &(*link)->next;
+    }
+    epoch_retired_t *expired = *link;
+    *link = NULL;
+
+    size_t freed = 0;
+    for (epoch_retired_t *node = expired; node; node = node->next) freed++;
+    size_t pending = __atomic_sub_fetch(&g_epoch.pending, freed, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_epoch.mutex);
+
+    // Outside the mutex: a free function may retire more
+    while (expired) {
+        epoch_retired_t *next = expired->next;
+        expired->free_fn(expired->ptr);
+        free(expired);
+        expired = next;
+    }
+    return pending;
+}
+
+void mcp_epoch_retire(void *ptr, void (*free_fn)(void *ptr)) {
+    if (!ptr || !free_fn) return;
+
+    epoch_retired_t *node = malloc(sizeof(epoch_retired_t));
+    if (!node) {
+        // Wait out a full grace period for this pointer alone
+        uint64_t target = __atomic_load_n(&g_epoch.global, __ATOMIC_SEQ_CST) + 2;
+        for (;;) {
+            pthread_mutex_lock(&g_epoch.mutex);
+            uint64_t global = epoch_try_advance();
+            pthread_mutex_unlock(&g_epoch.mutex);
+            if (global >= target) break;
+            sched_yield();
+        }
+        free_fn(ptr);
+        return;
+    }
+
+    node->ptr = ptr;
+    node->free_fn = free_fn;
+
+    pthread_mutex_lock(&g_epoch.mutex);
+    node->epoch = __atomic_load_n(&g_epoch.global, __ATOMIC_SEQ_CST);
+    node->next = g_epoch.retired;
+    g_epoch.retired = node;
+    __atomic_add_fetch(&g_epoch.pending, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_epoch.mutex);
+
+    mcp_epoch_reclaim();
+}
+
+void mcp_epoch_barrier(void) {
+    while (mcp_epoch_reclaim() > 0) {
+        sched_yield();
+    }
+}
+
+size_t mcp_epoch_pending(void) {
+    return __atomic_load_n(&g_epoch.pending, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,42 @@
+#ifndef MCP_EPOCH_H
+#define MCP_EPOCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Epoch-based reclamation for read-mostly structures published through an atomic
+// pointer. Readers bracket their accesses with mcp_epoch_enter()/mcp_epoch_exit(),
+// which take no lock and never wait. A writer swaps in a new version and hands the
+// old one to mcp_epoch_retire(); it is freed once every reader that could still see
+// it has left its critical section. Reclamation is process-wide, shared by every
+// registry.
+//
+// A global epoch advances when every thread inside a critical section has
+// announced the current one; memory retired in epoch e is freed once the global
+// epoch reaches e + 2. Critical sections nest, and should stay short: a thread that
+// stays inside holds back every retired allocation, not only the ones it reads.
+
+/**
+ * Enter a read-side critical section. Pointers loaded from published structures
+ * stay valid until the matching mcp_epoch_exit().
+ */
+void mcp_epoch_enter(void);
+void mcp_epoch_exit(void);
+
+/**
+ * Free ptr with free_fn once no reader can hold it any more. Call after ptr was
+ * unpublished. Never blocks readers; if the bookkeeping cannot be allocated, waits
+ * for the readers to leave and frees ptr right away.
+ */
+void mcp_epoch_retire(void *ptr, void (*free_fn)(void *ptr));
+
+// Free whatever retired memory is safe to free now; returns how much is left pending
+size_t mcp_epoch_reclaim(void);
+
+// Wait until everything retired so far is freed; must not be called inside a critical section
+void mcp_epoch_barrier(void);
+
+// Retired allocations not freed yet
+size_t mcp_epoch_pending(void);
+
+#endif // MCP_EPOCH_H
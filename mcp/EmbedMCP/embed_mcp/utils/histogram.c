@@ -0,0 +1,85 @@
+#include "utils/histogram.h"
+#include <string.h>
+
+#define SUB_COUNT (1u << MCP_HISTOGRAM_SUB_BITS)
+
+void mcp_histogram_reset(mcp_histogram_t *histogram) {
+    if (!histogram) return;
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+size_t mcp_histogram_bucket_index(uint64_t value_us) {
+    if (value_us < SUB_COUNT) return (size_t)value_us;
+
+    unsigned exponent = 63u - (unsigned)__builtin_clzll(value_us);
+    if (exponent > MCP_HISTOGRAM_MAX_EXPONENT) return MCP_HISTOGRAM_BUCKETS - 1;
+
+    unsigned sub = (unsigned)(value_us >> (exponent - MCP_HISTOGRAM_SUB_BITS)) & (SUB_COUNT - 1);
+    return ((size_t)(exponent - MCP_HISTOGRAM_SUB_BITS + 1) << MCP_HISTOGRAM_SUB_BITS) + sub;
+}
+
+uint64_t mcp_histogram_bucket_upper(size_t index) {
+    if (index < SUB_COUNT) return index;
+    if (index >= MCP_HISTOGRAM_BUCKETS - 1) return UINT64_MAX;
+
+    unsigned shift = (unsigned)(index >> MCP_HISTOGRAM_SUB_BITS) - 1;
+    uint64_t lower = (uint64_t)(SUB_COUNT + (index & (SUB_COUNT - 1))) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+void mcp_histogram_record(mcp_histogram_t *histogram, uint64_t value_us) {
+    if (!histogram) return;
+
+    histogram->buckets[mcp_histogram_bucket_index(value_us)]++;
+    histogram->count++;
+    histogram->sum_us += value_us;
+    if (value_us > histogram->max_us) histogram->max_us = value_us;
+}
+
+void mcp_histogram_record_atomic(mcp_histogram_t *histogram, uint64_t value_us) {
+    if (!histogram) return;
+
+    __atomic_add_fetch(&histogram->buckets[mcp_histogram_bucket_index(value_us)], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&histogram->count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&histogram->sum_us, value_us, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&histogram->max_us, __ATOMIC_RELAXED);
+    while (value_us > max &&
+           !__atomic_compare_exchange_n(&histogram->max_us, &max, value_us, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void mcp_histogram_merge(mcp_histogram_t *dst, const mcp_histogram_t *src) {
+    if (!dst || !src) return;
+
+    for (size_t i = 0; i < MCP_HISTOGRAM_BUCKETS; i++) {
+        dst->buckets[i] += __atomic_load_n(&src->buckets[i], __ATOMIC_RELAXED);
+    }
+    dst->count += __atomic_load_n(&src->count, __ATOMIC_RELAXED);
+    dst->sum_us += __atomic_load_n(&src->sum_us, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&src->max_us, __ATOMIC_RELAXED);
+    if (max > dst->max_us) dst->max_us = max;
+}
+
+uint64_t mcp_histogram_percentile(const mcp_histogram_t *histogram, double q) {
+    if (!histogram || histogram->count == 0) return 0;
+    if (q <= 0.0) q = 0.0;
+    if (q >= 1.0) return histogram->max_us;
+
+    // Nearest rank: the ceil(q * count)-th smallest sample
+    double position = q * (double)histogram->count;
+    uint64_t rank = (uint64_t)position;
+    if ((double)rank < position || rank == 0) rank++;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < MCP_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = mcp_histogram_bucket_upper(i);
+            return upper < histogram->max_us ? upper : histogram->max_us;
+        }
+    }
+    return histogram->max_us;
+}
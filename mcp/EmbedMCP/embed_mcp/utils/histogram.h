@@ -0,0 +1,39 @@
+#ifndef MCP_HISTOGRAM_H
+#define MCP_HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-size log-linear latency histogram. Values (microseconds) below 8 get a
+// bucket each; above that every power of two is split into 8 linear buckets, so a
+// reported percentile is within 12.5% of the recorded value. Covers up to 2^36 us
+// (about 19 hours), larger values land in the last bucket.
+
+#define MCP_HISTOGRAM_SUB_BITS 3
+#define MCP_HISTOGRAM_MAX_EXPONENT 35
+#define MCP_HISTOGRAM_BUCKETS \
+    ((MCP_HISTOGRAM_MAX_EXPONENT - MCP_HISTOGRAM_SUB_BITS + 2) << MCP_HISTOGRAM_SUB_BITS)
+
+typedef struct {
+    uint32_t buckets[MCP_HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t sum_us;
+    uint64_t max_us;
+} mcp_histogram_t;
+
+void mcp_histogram_reset(mcp_histogram_t *histogram);
+void mcp_histogram_record(mcp_histogram_t *histogram, uint64_t value_us);
+// Same with relaxed atomics, for histograms that several threads record into
+void mcp_histogram_record_atomic(mcp_histogram_t *histogram, uint64_t value_us);
+// Add src into dst; src may be recorded into concurrently
+void mcp_histogram_merge(mcp_histogram_t *dst, const mcp_histogram_t *src);
+
+// Upper bound of the bucket holding quantile q (0..1), capped at the maximum seen;
+// 0 when nothing was recorded
+uint64_t mcp_histogram_percentile(const mcp_histogram_t *histogram, double q);
+
+// Bucket layout, for exporting the raw distribution
+size_t mcp_histogram_bucket_index(uint64_t value_us);
+uint64_t mcp_histogram_bucket_upper(size_t index);   // Largest value in the bucket
+
+#endif // MCP_HISTOGRAM_H
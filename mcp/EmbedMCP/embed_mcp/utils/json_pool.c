@@ -0,0 +1,377 @@
+#include "utils/json_pool.h"
+#include "hal/platform_hal.h"
+#include "cjson/cJSON.h"
+#include <pthread.h>
+#include <string.h>
+
+#define POOL_ALIGN 16
+#define POOL_ALIGN_UP(n) (((n) + (POOL_ALIGN - 1)) & ~(uintptr_t)(POOL_ALIGN - 1))
+#define POOL_MAX_REGION_GROWTH 64       // A GROW region is at most this many first regions
+
+static const size_t k_class_size[MCP_JSON_POOL_CLASS_COUNT] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+
+// Class of a request by its size in 16-byte units
+static const uint8_t k_class_of_units[MCP_JSON_POOL_MAX_BLOCK / POOL_ALIGN + 1] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7
+};
+
+typedef struct {
+    uintptr_t pages;                // First page
+    size_t page_count;
+    size_t pages_used;              // Pages handed to a class, in address order
+    uint8_t *page_class;            // Class + 1 per page, 0 while unused
+} json_pool_region_t;
+
+typedef struct {
+    void *head[MCP_JSON_POOL_CLASS_COUNT];
+    size_t count[MCP_JSON_POOL_CLASS_COUNT];
+} json_pool_cache_t;
+
+static struct {
+    bool installed;
+    mcp_json_pool_config_t config;
+    pthread_mutex_t mutex;
+    json_pool_region_t regions[MCP_JSON_POOL_MAX_REGIONS];
+    size_t region_count;            // Published with release once a region is ready
+    size_t bytes_reserved;
+    size_t next_region_size;
+    void *free_list[MCP_JSON_POOL_CLASS_COUNT];
+    size_t class_pages[MCP_JSON_POOL_CLASS_COUNT];
+    uint64_t heap_allocs;
+    uint64_t failures;
+} g_pool = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static __thread json_pool_cache_t t_cache;
+static __thread bool t_cache_registered = false;
+
+static pthread_key_t g_cache_key;
+static pthread_once_t g_cache_once = PTHREAD_ONCE_INIT;
+
+static int class_of_size(size_t size) {
+    return k_class_of_units[(size + POOL_ALIGN - 1) / POOL_ALIGN];
+}
+
+// Class of a pool block, -1 for memory the pool does not own
+static int class_of_pointer(const void *ptr) {
+    uintptr_t address = (uintptr_t)ptr;
+    size_t count = __atomic_load_n(&g_pool.region_count, __ATOMIC_ACQUIRE);
+
+    for (size_t i = count; i-- > 0;) {
+        const json_pool_region_t *region = &g_pool.regions[i];
+        if (address >= region->pages &&
+            address - region->pages < region->page_count * MCP_JSON_POOL_PAGE_SIZE) {
+            return region->page_class[(address - region->pages) / MCP_JSON_POOL_PAGE_SIZE] - 1;
+        }
+    }
+    return -1;
+}
+
+// Lay out a page table and pages in memory - caller holds the mutex
+static int add_region(void *memory, size_t bytes) {
+    if (g_pool.region_count >= MCP_JSON_POOL_MAX_REGIONS) return -1;
+
+    uintptr_t start = (uintptr_t)memory;
+    size_t page_count = bytes / (MCP_JSON_POOL_PAGE_SIZE + 1);
+    while (page_count > 0 &&
+           POOL_ALIGN_UP(start + page_count) + page_count * MCP_JSON_POOL_PAGE_SIZE > start + bytes) {
+        page_count--;
+    }
+    if (page_count == 0) return -1;
+
+    json_pool_region_t *region = &g_pool.regions[g_pool.region_count];
+    region->page_class = (uint8_t*)memory;
+    memset(region->page_class, 0, page_count);
+    region->pages = POOL_ALIGN_UP(start + page_count);
+    region->page_count = page_count;
+    region->pages_used = 0;
+
+    g_pool.bytes_reserved += bytes;
+    __atomic_store_n(&g_pool.region_count, g_pool.region_count + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Take the next GROW region from the HAL - caller holds the mutex
+static int grow(void) {
+    if (g_pool.config.mode != MCP_JSON_POOL_GROW) return -1;
+
+    size_t size = g_pool.next_region_size;
+    if (g_pool.config.capacity > 0) {
+        if (g_pool.bytes_reserved >= g_pool.config.capacity) return -1;
+        if (size > g_pool.config.capacity - g_pool.bytes_reserved) {
+            size = g_pool.config.capacity - g_pool.bytes_reserved;
+        }
+    }
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    void *memory = hal ? hal->memory.alloc(size) : NULL;
+    if (!memory) return -1;
+    if (add_region(memory, size) != 0) {
+        hal->memory.free(memory);
+        return -1;
+    }
+
+    size_t limit = g_pool.config.region_size * POOL_MAX_REGION_GROWTH;
+    if (g_pool.next_region_size < limit) {
+        g_pool.next_region_size *= 2;
+    }
+    return 0;
+}
+
+// Give a fresh page to class and put its blocks on the shared free list - caller holds the mutex
+static bool carve_page(int class_index) {
+    json_pool_region_t *region = NULL;
+    if (g_pool.region_count > 0) {
+        region = &g_pool.regions[g_pool.region_count - 1];
+    }
+    if (!region || region->pages_used == region->page_count) {
+        if (grow() != 0) return false;
+        region = &g_pool.regions[g_pool.region_count - 1];
+    }
+
+    size_t page = region->pages_used++;
+    region->page_class[page] = (uint8_t)(class_index + 1);
+    g_pool.class_pages[class_index]++;
+
+    // Pushed from the end so blocks are handed out in address order
+    size_t block_size = k_class_size[class_index];
+    char *base = (char*)(region->pages + page * MCP_JSON_POOL_PAGE_SIZE);
+    for (size_t n = MCP_JSON_POOL_PAGE_SIZE / block_size; n-- > 0;) {
+        void *block = base + n * block_size;
+        *(void**)block = g_pool.free_list[class_index];
+        g_pool.free_list[class_index] = block;
+    }
+    return true;
+}
+
+// Caller holds the mutex
+static void *take_shared(int class_index) {
+    if (!g_pool.free_list[class_index] && !carve_page(class_index)) return NULL;
+
+    void *block = g_pool.free_list[class_index];
+    g_pool.free_list[class_index] = *(void**)block;
+    return block;
+}
+
+static void *heap_alloc(size_t size) {
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    void *ptr = hal ? hal->memory.alloc(size) : NULL;
+    if (ptr) {
+        __atomic_add_fetch(&g_pool.heap_allocs, 1, __ATOMIC_RELAXED);
+    }
+    return ptr;
+}
+
+static void *pool_full(size_t size) {
+    if (g_pool.config.heap_fallback) {
+        return heap_alloc(size);
+    }
+    __atomic_add_fetch(&g_pool.failures, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// Per-thread free lists
+
+// Move count blocks of a class from the cache to the shared list - caller holds the mutex
+static void cache_release(json_pool_cache_t *cache, int class_index, size_t count) {
+    while (count-- > 0 && cache->head[class_index]) {
+        void *block = cache->head[class_index];
+        cache->head[class_index] = *(void**)block;
+        cache->count[class_index]--;
+        *(void**)block = g_pool.free_list[class_index];
+        g_pool.free_list[class_index] = block;
+    }
+}
+
+static void cache_thread_exit(void *arg) {
+    json_pool_cache_t *cache = (json_pool_cache_t*)arg;
+
+    pthread_mutex_lock(&g_pool.mutex);
+    for (int i = 0; i < MCP_JSON_POOL_CLASS_COUNT; i++) {
+        cache_release(cache, i, cache->count[i]);
+    }
+    pthread_mutex_unlock(&g_pool.mutex);
+}
+
+static void cache_key_init(void) {
+    pthread_key_create(&g_cache_key, cache_thread_exit);
+}
+
+// The calling thread's cache, NULL when caches are off or the thread cannot register one
+static json_pool_cache_t *thread_cache(void) {
+    if (g_pool.config.thread_cache == 0) return NULL;
+
+    if (!t_cache_registered) {
+        // The key only runs cache_thread_exit, so blocks are not stranded in dead threads
+        pthread_once(&g_cache_once, cache_key_init);
+        if (pthread_setspecific(g_cache_key, &t_cache) != 0) return NULL;
+        t_cache_registered = true;
+    }
+    return &t_cache;
+}
+
+static void cache_refill(json_pool_cache_t *cache, int class_index) {
+    size_t batch = g_pool.config.thread_cache / 2 + 1;
+
+    pthread_mutex_lock(&g_pool.mutex);
+    while (cache->count[class_index] < batch) {
+        void *block = take_shared(class_index);
+        if (!block) break;
+        *(void**)block = cache->head[class_index];
+        cache->head[class_index] = block;
+        cache->count[class_index]++;
+    }
+    pthread_mutex_unlock(&g_pool.mutex);
+}
+
+// Hooks
+
+void *mcp_json_pool_alloc(size_t size) {
+    if (size > MCP_JSON_POOL_MAX_BLOCK) {
+        return heap_alloc(size);
+    }
+
+    int class_index = class_of_size(size);
+    json_pool_cache_t *cache = thread_cache();
+    void *block;
+
+    if (cache) {
+        if (!cache->head[class_index]) {
+            cache_refill(cache, class_index);
+        }
+        block = cache->head[class_index];
+        if (block) {
+            cache->head[class_index] = *(void**)block;
+            cache->count[class_index]--;
+        }
+    } else {
+        pthread_mutex_lock(&g_pool.mutex);
+        block = take_shared(class_index);
+        pthread_mutex_unlock(&g_pool.mutex);
+    }
+
+    return block ? block : pool_full(size);
+}
+
+void mcp_json_pool_free(void *ptr) {
+    if (!ptr) return;
+
+    int class_index = class_of_pointer(ptr);
+    if (class_index < 0) {
+        const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+        if (hal) {
+            hal->memory.free(ptr);
+        }
+        return;
+    }
+
+    json_pool_cache_t *cache = thread_cache();
+    if (cache) {
+        *(void**)ptr = cache->head[class_index];
+        cache->head[class_index] = ptr;
+        cache->count[class_index]++;
+
+        // Keep half so a thread that only frees doesn't bounce on the mutex
+        if (cache->count[class_index] > g_pool.config.thread_cache) {
+            pthread_mutex_lock(&g_pool.mutex);
+            cache_release(cache, class_index, cache->count[class_index] - g_pool.config.thread_cache / 2);
+            pthread_mutex_unlock(&g_pool.mutex);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&g_pool.mutex);
+    *(void**)ptr = g_pool.free_list[class_index];
+    g_pool.free_list[class_index] = ptr;
+    pthread_mutex_unlock(&g_pool.mutex);
+}
+
+// Installation
+
+void mcp_json_pool_default_config(mcp_json_pool_config_t *config) {
+    if (!config) return;
+    memset(config, 0, sizeof(mcp_json_pool_config_t));
+    config->mode = MCP_JSON_POOL_GROW;
+    config->region_size = MCP_JSON_POOL_DEFAULT_REGION_SIZE;
+    config->thread_cache = MCP_JSON_POOL_DEFAULT_THREAD_CACHE;
+}
+
+int mcp_json_pool_install(const mcp_json_pool_config_t *config) {
+    mcp_json_pool_config_t settings;
+    if (config) {
+        settings = *config;
+    } else {
+        mcp_json_pool_default_config(&settings);
+    }
+    if (settings.region_size == 0) {
+        settings.region_size = MCP_JSON_POOL_DEFAULT_REGION_SIZE;
+    }
+
+    // A region needs its page table and at least one page
+    size_t minimum = MCP_JSON_POOL_PAGE_SIZE + POOL_ALIGN + 1;
+    if ((settings.mode == MCP_JSON_POOL_STATIC && (!settings.buffer || settings.capacity < minimum)) ||
+        (settings.mode == MCP_JSON_POOL_FIXED && settings.capacity < minimum) ||
+        (settings.mode == MCP_JSON_POOL_GROW && settings.region_size < minimum)) {
+        return -1;
+    }
+
+    const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+    if (!hal) return -1;
+
+    pthread_mutex_lock(&g_pool.mutex);
+    if (g_pool.installed) {
+        pthread_mutex_unlock(&g_pool.mutex);
+        return -1;
+    }
+
+    g_pool.config = settings;
+    g_pool.next_region_size = settings.region_size;
+
+    int result = 0;
+    if (settings.mode == MCP_JSON_POOL_STATIC) {
+        result = add_region(settings.buffer, settings.capacity);
+    } else if (settings.mode == MCP_JSON_POOL_FIXED) {
+        void *memory = hal->memory.alloc(settings.capacity);
+        result = memory ? add_region(memory, settings.capacity) : -1;
+        if (result != 0 && memory) {
+            hal->memory.free(memory);
+        }
+    }
+
+    if (result == 0) {
+        cJSON_Hooks hooks = { mcp_json_pool_alloc, mcp_json_pool_free };
+        cJSON_InitHooks(&hooks);
+        g_pool.installed = true;
+    }
+    pthread_mutex_unlock(&g_pool.mutex);
+    return result;
+}
+
+bool mcp_json_pool_installed(void) {
+    pthread_mutex_lock(&g_pool.mutex);
+    bool installed = g_pool.installed;
+    pthread_mutex_unlock(&g_pool.mutex);
+    return installed;
+}
+
+void mcp_json_pool_get_stats(mcp_json_pool_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(mcp_json_pool_stats_t));
+
+    pthread_mutex_lock(&g_pool.mutex);
+    stats->installed = g_pool.installed;
+    stats->mode = g_pool.config.mode;
+    stats->region_count = g_pool.region_count;
+    stats->bytes_reserved = g_pool.bytes_reserved;
+    for (size_t i = 0; i < g_pool.region_count; i++) {
+        stats->pages_total += g_pool.regions[i].page_count;
+        stats->pages_used += g_pool.regions[i].pages_used;
+    }
+    for (int i = 0; i < MCP_JSON_POOL_CLASS_COUNT; i++) {
+        stats->class_size[i] = k_class_size[i];
+        stats->class_pages[i] = g_pool.class_pages[i];
+    }
+    pthread_mutex_unlock(&g_pool.mutex);
+
+    stats->heap_allocs = __atomic_load_n(&g_pool.heap_allocs, __ATOMIC_RELAXED);
+    stats->failures = __atomic_load_n(&g_pool.failures, __ATOMIC_RELAXED);
+}
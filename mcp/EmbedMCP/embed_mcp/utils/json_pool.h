@@ -0,0 +1,72 @@
+#ifndef MCP_JSON_POOL_H
+#define MCP_JSON_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Size-class slab allocator for cJSON nodes and short strings, installed as the
+// cJSON allocation hooks. Pool memory is split into pages of MCP_JSON_POOL_PAGE_SIZE
+// bytes; a page serves one size class for the life of the process. Blocks larger
+// than MCP_JSON_POOL_MAX_BLOCK (print buffers, long strings) go to the HAL heap.
+//
+// Each thread keeps a short free list per class, so most allocations and frees
+// take no lock. The pool is process-wide and cannot be removed once installed:
+// install it before any cJSON value is created.
+
+#define MCP_JSON_POOL_PAGE_SIZE 1024
+#define MCP_JSON_POOL_MAX_BLOCK 256
+#define MCP_JSON_POOL_CLASS_COUNT 8
+#define MCP_JSON_POOL_MAX_REGIONS 32
+#define MCP_JSON_POOL_DEFAULT_REGION_SIZE (64 * 1024)
+#define MCP_JSON_POOL_DEFAULT_THREAD_CACHE 64
+
+typedef enum {
+    MCP_JSON_POOL_GROW = 0,     // Regions are taken from the HAL as needed, each twice the last
+    MCP_JSON_POOL_FIXED,        // One region of capacity bytes is taken from the HAL up front
+    MCP_JSON_POOL_STATIC        // The caller's buffer, no HAL memory is used for small blocks
+} mcp_json_pool_mode_t;
+
+typedef struct {
+    mcp_json_pool_mode_t mode;
+    void *buffer;               // MCP_JSON_POOL_STATIC: storage for the pool
+    size_t capacity;            // FIXED and STATIC: bytes; GROW: most bytes to take (0: no limit)
+    size_t region_size;         // GROW: first region (0: MCP_JSON_POOL_DEFAULT_REGION_SIZE)
+    size_t thread_cache;        // Blocks per class held by each thread (0: every call locks)
+    bool heap_fallback;         // Serve small blocks from the HAL heap once the pool is full
+} mcp_json_pool_config_t;
+
+typedef struct {
+    bool installed;
+    mcp_json_pool_mode_t mode;
+    size_t region_count;
+    size_t bytes_reserved;      // Pool memory, page tables included
+    size_t pages_total;
+    size_t pages_used;
+    size_t class_size[MCP_JSON_POOL_CLASS_COUNT];
+    size_t class_pages[MCP_JSON_POOL_CLASS_COUNT];
+    uint64_t heap_allocs;       // Blocks served by the HAL heap: too large, or the pool was full
+    uint64_t failures;          // Small blocks refused because the pool was full
+} mcp_json_pool_stats_t;
+
+// Default configuration: GROW mode, per-thread caches, no heap fallback needed
+void mcp_json_pool_default_config(mcp_json_pool_config_t *config);
+
+/**
+ * Create the pool and install it with cJSON_InitHooks()
+ * @param config Pool configuration, NULL for the defaults
+ * @return 0 on success, -1 if already installed, the configuration is invalid
+ *         or the initial memory cannot be reserved
+ */
+int mcp_json_pool_install(const mcp_json_pool_config_t *config);
+
+bool mcp_json_pool_installed(void);
+
+// Counters read without stopping allocation, so they are approximate under load
+void mcp_json_pool_get_stats(mcp_json_pool_stats_t *stats);
+
+// The hooks themselves; usable directly once the pool is installed
+void *mcp_json_pool_alloc(size_t size);
+void mcp_json_pool_free(void *ptr);
+
+#endif // MCP_JSON_POOL_H
@@ -1,44 +1,307 @@
 #include "utils/logging.h"
+#include "utils/counter.h"
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Global logging configuration
+// Global logging configuration (static, so a reinit never frees it under a logging thread)
+static mcp_log_config_t g_log_storage;
 static mcp_log_config_t *g_log_config = NULL;
 
+// Nothing is written until the logging system is initialized
+#define LOG_THRESHOLD_OFF (MCP_LOG_LEVEL_ERROR + 1)
+int mcp_log_threshold = LOG_THRESHOLD_OFF;
+
+#if (MCP_LOG_RING_SIZE & (MCP_LOG_RING_SIZE - 1)) != 0
+#error "MCP_LOG_RING_SIZE must be a power of two"
+#endif
+
+#define LOG_RING_MASK ((size_t)MCP_LOG_RING_SIZE - 1)
+#define LOG_FLUSH_INTERVAL_MS 100
+
+// Bounded MPSC ring: a slot is free for position p when sequence == p, holds a line
+// when sequence == p + 1. Producers claim positions by CAS on tail.
+typedef struct {
+    size_t sequence;
+    int level;
+    size_t length;
+    char text[MCP_LOG_LINE_MAX];
+} log_slot_t;
+
+static struct {
+    log_slot_t slots[MCP_LOG_RING_SIZE];
+    size_t tail MCP_CACHE_ALIGNED;   // Next position to claim (producers)
+    size_t head MCP_CACHE_ALIGNED;   // Next position to write out (flusher)
+    uint64_t dropped;
+    uint64_t dropped_reported;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool running;
+    bool stop;
+    int sleeping;                   // Flusher waits on cond; producers signal it
+} g_ring = { .mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+static bool g_atexit_registered = false;
+
+// Timestamp prefix, rebuilt once per second per thread
+#if defined(__GNUC__)
+static __thread time_t t_stamp_second = 0;
+static __thread char t_stamp[32];
+static __thread size_t t_stamp_length = 0;
+#else
+static time_t t_stamp_second = 0;
+static char t_stamp[32];
+static size_t t_stamp_length = 0;
+#endif
+
+static size_t log_timestamp(char *out) {
+    time_t now = time(NULL);
+    if (now != t_stamp_second || t_stamp_length == 0) {
+        struct tm tm_info;
+        localtime_r(&now, &tm_info);
+        int written = snprintf(t_stamp, sizeof(t_stamp), "[%04d-%02d-%02d %02d:%02d:%02d] ",
+                               tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday,
+                               tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
+        t_stamp_length = written > 0 ? (size_t)written : 0;
+        t_stamp_second = now;
+    }
+    memcpy(out, t_stamp, t_stamp_length);
+    return t_stamp_length;
+}
+
+// One complete line into out (MCP_LOG_LINE_MAX bytes), truncated with "..." if needed
+static size_t log_format_line(char *out, mcp_log_level_t level, const char *format, va_list args) {
+    static const char reset[] = "\033[0m";
+    // Room kept for "...", the color reset and the newline
+    const size_t tail_room = 3 + (sizeof(reset) - 1) + 1;
+    const size_t limit = MCP_LOG_LINE_MAX - tail_room;
+    size_t length = 0;
+
+    if (g_log_config->enable_timestamps) {
+        length += log_timestamp(out);
+    }
+    if (g_log_config->enable_colors) {
+        const char *color = mcp_log_level_to_color(level);
+        size_t color_length = strlen(color);
+        memcpy(out + length, color, color_length);
+        length += color_length;
+    }
+    length += (size_t)snprintf(out + length, limit - length, "[%s] ", mcp_log_level_to_string(level));
+
+    int written = vsnprintf(out + length, limit - length, format, args);
+    if (written < 0) written = 0;
+    if ((size_t)written >= limit - length) {
+        length = limit - 1;
+        memcpy(out + length, "...", 3);
+        length += 3;
+    } else {
+        length += (size_t)written;
+    }
+
+    bool newline = length > 0 && out[length - 1] == '\n';
+    if (newline) length--;
+    if (g_log_config->enable_colors) {
+        memcpy(out + length, reset, sizeof(reset) - 1);
+        length += sizeof(reset) - 1;
+    }
+    out[length++] = '\n';
+    return length;
+}
+
+static FILE *log_stream(int level) {
+    return level >= MCP_LOG_LEVEL_ERROR ? g_log_config->error_stream : g_log_config->output_stream;
+}
+
+// Write out every line that is ready; returns how many
+static size_t ring_drain(void) {
+    size_t count = 0;
+    FILE *used[2] = { NULL, NULL };
+
+    for (;;) {
+        size_t head = g_ring.head;
+        log_slot_t *slot = &g_ring.slots[head & LOG_RING_MASK];
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != head + 1) break;
+
+        FILE *stream = log_stream(slot->level);
+        fwrite(slot->text, 1, slot->length, stream);
+        used[slot->level >= MCP_LOG_LEVEL_ERROR] = stream;
+
+        __atomic_store_n(&slot->sequence, head + MCP_LOG_RING_SIZE, __ATOMIC_RELEASE);
+        __atomic_store_n(&g_ring.head, head + 1, __ATOMIC_RELEASE);
+        count++;
+    }
+
+    uint64_t dropped = __atomic_load_n(&g_ring.dropped, __ATOMIC_RELAXED);
+    if (dropped != g_ring.dropped_reported) {
+        FILE *stream = log_stream(MCP_LOG_LEVEL_WARN);
+        fprintf(stream, "[%s] %llu log line(s) dropped, log buffer full\n",
+                mcp_log_level_to_string(MCP_LOG_LEVEL_WARN),
+                (unsigned long long)(dropped - g_ring.dropped_reported));
+        g_ring.dropped_reported = dropped;
+        used[0] = stream;
+    }
+
+    // One flush per batch instead of per line
+    if (used[0]) fflush(used[0]);
+    if (used[1] && used[1] != used[0]) fflush(used[1]);
+    return count;
+}
+
+static bool ring_ready(void) {
+    size_t head = g_ring.head;
+    return __atomic_load_n(&g_ring.slots[head & LOG_RING_MASK].sequence, __ATOMIC_ACQUIRE) == head + 1;
+}
+
+static void *log_flusher_thread(void *arg) {
+    (void)arg;
+
+    for (;;) {
+        size_t written = ring_drain();
+
+        pthread_mutex_lock(&g_ring.mutex);
+        if (g_ring.stop && written == 0 && !ring_ready()) {
+            pthread_mutex_unlock(&g_ring.mutex);
+            break;
+        }
+        if (written == 0 && !g_ring.stop) {
+            __atomic_store_n(&g_ring.sleeping, 1, __ATOMIC_SEQ_CST);
+            if (!ring_ready()) {
+                struct timespec deadline;
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                deadline.tv_nsec += LOG_FLUSH_INTERVAL_MS * 1000000L;
+                if (deadline.tv_nsec >= 1000000000L) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000L;
+                }
+                pthread_cond_timedwait(&g_ring.cond, &g_ring.mutex, &deadline);
+            }
+            __atomic_store_n(&g_ring.sleeping, 0, __ATOMIC_SEQ_CST);
+        }
+        pthread_mutex_unlock(&g_ring.mutex);
+    }
+
+    return NULL;
+}
+
+static void ring_wake(void) {
+    if (__atomic_load_n(&g_ring.sleeping, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&g_ring.mutex);
+        pthread_cond_signal(&g_ring.cond);
+        pthread_mutex_unlock(&g_ring.mutex);
+    }
+}
+
+// Returns -1 when the ring is full (the line is counted as dropped)
+static int ring_push(mcp_log_level_t level, const char *format, va_list args) {
+    size_t position = __atomic_load_n(&g_ring.tail, __ATOMIC_RELAXED);
+    log_slot_t *slot;
+
+    for (;;) {
+        slot = &g_ring.slots[position & LOG_RING_MASK];
+        size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0) {
+            if (__atomic_compare_exchange_n(&g_ring.tail, &position, position + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (difference < 0) {
+            __atomic_add_fetch(&g_ring.dropped, 1, __ATOMIC_RELAXED);
+            return -1;
+        } else {
+            position = __atomic_load_n(&g_ring.tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->level = level;
+    slot->length = log_format_line(slot->text, level, format, args);
+    __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+
+    ring_wake();
+    return 0;
+}
+
+static void log_stop_flusher(void) {
+    if (!g_ring.running) return;
+
+    pthread_mutex_lock(&g_ring.mutex);
+    g_ring.stop = true;
+    pthread_cond_signal(&g_ring.cond);
+    pthread_mutex_unlock(&g_ring.mutex);
+
+    pthread_join(g_ring.thread, NULL);
+    g_ring.running = false;
+    g_ring.stop = false;
+}
+
+static void log_atexit(void) {
+    log_stop_flusher();
+}
+
+static int log_start_flusher(void) {
+    if (g_ring.running) return 0;
+
+    // Mark every slot free for its first lap
+    for (size_t i = 0; i < MCP_LOG_RING_SIZE; i++) {
+        __atomic_store_n(&g_ring.slots[i].sequence, g_ring.head + i, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&g_ring.tail, g_ring.head, __ATOMIC_RELEASE);
+
+    if (pthread_create(&g_ring.thread, NULL, log_flusher_thread, NULL) != 0) {
+        return -1;
+    }
+    g_ring.running = true;
+
+    // Lines still queued when main() returns are written out
+    if (!g_atexit_registered) {
+        g_atexit_registered = atexit(log_atexit) == 0;
+    }
+    return 0;
+}
+
 // Initialize logging system
 int mcp_log_init(const mcp_log_config_t *config) {
-    if (g_log_config) {
-        mcp_log_cleanup();
-    }
-    
-    g_log_config = malloc(sizeof(mcp_log_config_t));
-    if (!g_log_config) return -1;
-    
     if (config) {
-        *g_log_config = *config;
+        g_log_storage = *config;
     } else {
         // Default configuration
-        g_log_config->min_level = MCP_LOG_LEVEL_INFO;
-        g_log_config->enable_timestamps = true;
-        g_log_config->enable_colors = true;
-        g_log_config->output_stream = stdout;
-        g_log_config->error_stream = stderr;
+        g_log_storage.min_level = MCP_LOG_LEVEL_INFO;
+        g_log_storage.enable_timestamps = true;
+        g_log_storage.enable_colors = true;
+        g_log_storage.async = true;
+        g_log_storage.output_stream = stdout;
+        g_log_storage.error_stream = stderr;
     }
-    
+    g_log_config = &g_log_storage;
+
+    // A reinit keeps a running flusher (other threads may be logging into the ring)
+    if (g_log_config->async) {
+        if (log_start_flusher() != 0) {
+            g_log_config->async = false;
+        }
+    } else {
+        log_stop_flusher();
+    }
+
+    mcp_log_threshold = g_log_config->min_level;
     return 0;
 }
 
 void mcp_log_cleanup(void) {
-    if (g_log_config) {
-        free(g_log_config);
-        g_log_config = NULL;
-    }
+    mcp_log_threshold = LOG_THRESHOLD_OFF;
+    log_stop_flusher();
+    g_log_config = NULL;
 }
 
 // Set log level
 void mcp_log_set_level(mcp_log_level_t level) {
     if (g_log_config) {
         g_log_config->min_level = level;
+        mcp_log_threshold = level;
     }
 }
 
@@ -46,44 +309,43 @@ mcp_log_level_t mcp_log_get_level(void) {
     return g_log_config ? g_log_config->min_level : MCP_LOG_LEVEL_INFO;
 }
 
+void mcp_log_flush(void) {
+    if (!g_ring.running) return;
+
+    size_t target = __atomic_load_n(&g_ring.tail, __ATOMIC_ACQUIRE);
+    pthread_mutex_lock(&g_ring.mutex);
+    pthread_cond_signal(&g_ring.cond);
+    pthread_mutex_unlock(&g_ring.mutex);
+
+    // Bounded: a producer that claimed a slot may still be formatting into it
+    struct timespec pause = { 0, 1000000L };
+    for (int i = 0; i < 1000; i++) {
+        if ((intptr_t)(__atomic_load_n(&g_ring.head, __ATOMIC_ACQUIRE) - target) >= 0) break;
+        nanosleep(&pause, NULL);
+    }
+}
+
+uint64_t mcp_log_get_dropped(void) {
+    return __atomic_load_n(&g_ring.dropped, __ATOMIC_RELAXED);
+}
+
 // Generic logging function
 void mcp_vlog(mcp_log_level_t level, const char *format, va_list args) {
-    if (!g_log_config || level < g_log_config->min_level) {
+    mcp_log_config_t *config = g_log_config;
+    if (!config || !mcp_log_enabled(level)) {
         return;
     }
-    
-    FILE *stream = (level >= MCP_LOG_LEVEL_ERROR) ? g_log_config->error_stream : g_log_config->output_stream;
-    
-    // Add timestamp if enabled
-    if (g_log_config->enable_timestamps) {
-        time_t now = time(NULL);
-        struct tm *tm_info = localtime(&now);
-        fprintf(stream, "[%04d-%02d-%02d %02d:%02d:%02d] ",
-                tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-                tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
-    }
-    
-    // Add color if enabled
-    if (g_log_config->enable_colors) {
-        fprintf(stream, "%s", mcp_log_level_to_color(level));
-    }
-    
-    // Add log level
-    fprintf(stream, "[%s] ", mcp_log_level_to_string(level));
-    
-    // Add the actual message
-    vfprintf(stream, format, args);
-    
-    // Reset color if enabled
-    if (g_log_config->enable_colors) {
-        fprintf(stream, "\033[0m");
-    }
-    
-    // Add newline if not present
-    if (format[strlen(format) - 1] != '\n') {
-        fprintf(stream, "\n");
+
+    if (config->async && g_ring.running) {
+        ring_push(level, format, args);
+        return;
     }
-    
+
+    // Synchronous: still one write per line, so concurrent lines do not interleave
+    char line[MCP_LOG_LINE_MAX];
+    size_t length = log_format_line(line, level, format, args);
+    FILE *stream = log_stream(level);
+    fwrite(line, 1, length, stream);
     fflush(stream);
 }
 
@@ -95,28 +357,28 @@ void mcp_log(mcp_log_level_t level, const char *format, ...) {
 }
 
 // Convenience logging functions
-void mcp_log_debug(const char *format, ...) {
+void (mcp_log_debug)(const char *format, ...) {
     va_list args;
     va_start(args, format);
     mcp_vlog(MCP_LOG_LEVEL_DEBUG, format, args);
     va_end(args);
 }
 
-void mcp_log_info(const char *format, ...) {
+void (mcp_log_info)(const char *format, ...) {
     va_list args;
     va_start(args, format);
     mcp_vlog(MCP_LOG_LEVEL_INFO, format, args);
     va_end(args);
 }
 
-void mcp_log_warn(const char *format, ...) {
+void (mcp_log_warn)(const char *format, ...) {
     va_list args;
     va_start(args, format);
     mcp_vlog(MCP_LOG_LEVEL_WARN, format, args);
     va_end(args);
 }
 
-void mcp_log_error(const char *format, ...) {
+void (mcp_log_error)(const char *format, ...) {
     va_list args;
     va_start(args, format);
     mcp_vlog(MCP_LOG_LEVEL_ERROR, format, args);
@@ -162,6 +424,7 @@ mcp_log_config_t *mcp_log_config_create_default(void) {
     config->min_level = MCP_LOG_LEVEL_INFO;
     config->enable_timestamps = true;
     config->enable_colors = true;
+    config->async = true;
     config->output_stream = stdout;
     config->error_stream = stderr;
     
@@ -5,6 +5,7 @@
 #include <stdarg.h>
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // Log levels
 typedef enum {
@@ -19,23 +20,68 @@ typedef struct {
     mcp_log_level_t min_level;
     bool enable_timestamps;
     bool enable_colors;
+    bool async;                 // Queue lines for a background flusher thread
     FILE *output_stream;
     FILE *error_stream;
 } mcp_log_config_t;
 
+// Async mode: lines are formatted by the calling thread into a lock-free ring of
+// MCP_LOG_RING_SIZE slots (a power of two) and written out by a flusher thread.
+// When the ring is full the line is dropped and counted, the caller never blocks.
+// Longer lines are truncated to MCP_LOG_LINE_MAX bytes.
+#ifndef MCP_LOG_RING_SIZE
+#define MCP_LOG_RING_SIZE 256
+#endif
+#ifndef MCP_LOG_LINE_MAX
+#define MCP_LOG_LINE_MAX 512
+#endif
+
 // Initialize logging system
 int mcp_log_init(const mcp_log_config_t *config);
-void mcp_log_cleanup(void);
+void mcp_log_cleanup(void);     // Writes out queued lines and stops the flusher
 
 // Set log level
 void mcp_log_set_level(mcp_log_level_t level);
 mcp_log_level_t mcp_log_get_level(void);
 
+// Wait (briefly) until the lines queued so far are written
+void mcp_log_flush(void);
+// Lines dropped because the ring was full
+uint64_t mcp_log_get_dropped(void);
+
+// Levels below MCP_LOG_COMPILE_LEVEL (0 debug .. 3 error, 4 none) are removed at
+// compile time: the call sites reduce to a constant-false branch the compiler drops,
+// arguments are never evaluated. NDEBUG builds default to info.
+#ifndef MCP_LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define MCP_LOG_COMPILE_LEVEL 1
+#else
+#define MCP_LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+// Lowest level currently written; kept in sync with the configuration so a
+// disabled level costs one comparison and its arguments are never evaluated
+extern int mcp_log_threshold;
+#define mcp_log_enabled(level) \
+    ((int)(level) >= MCP_LOG_COMPILE_LEVEL && (int)(level) >= mcp_log_threshold)
+
+#define MCP_LOG_CALL(level, function, ...) \
+    do { \
+        if (mcp_log_enabled(level)) { \
+            (function)(__VA_ARGS__); \
+        } \
+    } while (0)
+
 // Logging functions
 void mcp_log_debug(const char *format, ...);
 void mcp_log_info(const char *format, ...);
 void mcp_log_warn(const char *format, ...);
 void mcp_log_error(const char *format, ...);
+#define mcp_log_debug(...) MCP_LOG_CALL(MCP_LOG_LEVEL_DEBUG, mcp_log_debug, __VA_ARGS__)
+#define mcp_log_info(...) MCP_LOG_CALL(MCP_LOG_LEVEL_INFO, mcp_log_info, __VA_ARGS__)
+#define mcp_log_warn(...) MCP_LOG_CALL(MCP_LOG_LEVEL_WARN, mcp_log_warn, __VA_ARGS__)
+#define mcp_log_error(...) MCP_LOG_CALL(MCP_LOG_LEVEL_ERROR, mcp_log_error, __VA_ARGS__)
 
 // Generic logging function
 void mcp_log(mcp_log_level_t level, const char *format, ...);
@@ -0,0 +1,127 @@
+#include "utils/mem_budget.h"
+
+static size_t g_global_limit = 0;
+static size_t g_session_limit = 0;
+static size_t g_request_limit = 0;
+
+static size_t g_heap_in_use = 0;
+static size_t g_reserved = 0;
+static size_t g_high_water = 0;
+
+static uint64_t g_rejected_request = 0;
+static uint64_t g_rejected_session = 0;
+static uint64_t g_rejected_global = 0;
+
+void mcp_mem_budget_configure(const mcp_mem_budget_config_t *config) {
+    __atomic_store_n(&g_global_limit, config ? config->global_limit : 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_session_limit, config ? config->session_limit : 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_request_limit, config ? config->request_limit : 0, __ATOMIC_RELAXED);
+}
+
+void mcp_mem_budget_get_config(mcp_mem_budget_config_t *config) {
+    if (!config) return;
+
+    config->global_limit = __atomic_load_n(&g_global_limit, __ATOMIC_RELAXED);
+    config->session_limit = __atomic_load_n(&g_session_limit, __ATOMIC_RELAXED);
+    config->request_limit = __atomic_load_n(&g_request_limit, __ATOMIC_RELAXED);
+}
+
+static void note_high_water(size_t total) {
+    size_t seen = __atomic_load_n(&g_high_water, __ATOMIC_RELAXED);
+    while (total > seen &&
+           !__atomic_compare_exchange_n(&g_high_water, &seen, total, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void mcp_mem_budget_charge(size_t bytes) {
+    size_t heap = __atomic_add_fetch(&g_heap_in_use, bytes, __ATOMIC_RELAXED);
+    note_high_water(heap + __atomic_load_n(&g_reserved, __ATOMIC_RELAXED));
+}
+
+void mcp_mem_budget_uncharge(size_t bytes) {
+    __atomic_sub_fetch(&g_heap_in_use, bytes, __ATOMIC_RELAXED);
+}
+
+mcp_mem_budget_result_t mcp_mem_budget_reserve(mcp_mem_account_t *account, size_t bytes) {
+    size_t request_limit = __atomic_load_n(&g_request_limit, __ATOMIC_RELAXED);
+    if (request_limit > 0 && bytes > request_limit) {
+        __atomic_add_fetch(&g_rejected_request, 1, __ATOMIC_RELAXED);
+        return MCP_MEM_BUDGET_REQUEST_LIMIT;
+    }
+
+    // Session first: it is the cheaper one to undo
+    size_t session_limit = __atomic_load_n(&g_session_limit, __ATOMIC_RELAXED);
+    if (account) {
+        size_t held = __atomic_add_fetch(&account->reserved, bytes, __ATOMIC_RELAXED);
+        if (session_limit > 0 && held > session_limit) {
+            __atomic_sub_fetch(&account->reserved, bytes, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&g_rejected_session, 1, __ATOMIC_RELAXED);
+            return MCP_MEM_BUDGET_SESSION_LIMIT;
+        }
+    }
+
+    size_t global_limit = __atomic_load_n(&g_global_limit, __ATOMIC_RELAXED);
+    size_t reserved = __atomic_add_fetch(&g_reserved, bytes, __ATOMIC_RELAXED);
+    size_t total = reserved + __atomic_load_n(&g_heap_in_use, __ATOMIC_RELAXED);
+    if (global_limit > 0 && total > global_limit) {
+        __atomic_sub_fetch(&g_reserved, bytes, __ATOMIC_RELAXED);
+        if (account) {
+            __atomic_sub_fetch(&account->reserved, bytes, __ATOMIC_RELAXED);
+        }
+        __atomic_add_fetch(&g_rejected_global, 1, __ATOMIC_RELAXED);
+        return MCP_MEM_BUDGET_GLOBAL_LIMIT;
+    }
+
+    note_high_water(total);
+    return MCP_MEM_BUDGET_OK;
+}
+
+void mcp_mem_budget_release(mcp_mem_account_t *account, size_t bytes) {
+    if (bytes == 0) return;
+
+    __atomic_sub_fetch(&g_reserved, bytes, __ATOMIC_RELAXED);
+    if (account) {
+        __atomic_sub_fetch(&account->reserved, bytes, __ATOMIC_RELAXED);
+    }
+}
+
+size_t mcp_mem_budget_request_cost(size_t length) {
+    if (length > SIZE_MAX / MCP_MEM_BUDGET_REQUEST_FACTOR) return SIZE_MAX;
+    return length * MCP_MEM_BUDGET_REQUEST_FACTOR;
+}
+
+bool mcp_mem_budget_retryable(mcp_mem_budget_result_t result) {
+    return result == MCP_MEM_BUDGET_SESSION_LIMIT || result == MCP_MEM_BUDGET_GLOBAL_LIMIT;
+}
+
+const char *mcp_mem_budget_result_string(mcp_mem_budget_result_t result) {
+    switch (result) {
+        case MCP_MEM_BUDGET_OK: return "ok";
+        case MCP_MEM_BUDGET_REQUEST_LIMIT: return "request exceeds the per-request memory limit";
+        case MCP_MEM_BUDGET_SESSION_LIMIT: return "session memory budget exhausted";
+        case MCP_MEM_BUDGET_GLOBAL_LIMIT: return "server memory budget exhausted";
+    }
+    return "unknown";
+}
+
+size_t mcp_mem_budget_available(void) {
+    size_t limit = __atomic_load_n(&g_global_limit, __ATOMIC_RELAXED);
+    if (limit == 0) return SIZE_MAX;
+
+    size_t used = __atomic_load_n(&g_heap_in_use, __ATOMIC_RELAXED) +
+                  __atomic_load_n(&g_reserved, __ATOMIC_RELAXED);
+    return used < limit ? limit - used : 0;
+}
+
+void mcp_mem_budget_get_stats(mcp_mem_budget_stats_t *stats) {
+    if (!stats) return;
+
+    mcp_mem_budget_get_config(&stats->config);
+    stats->heap_in_use = __atomic_load_n(&g_heap_in_use, __ATOMIC_RELAXED);
+    stats->reserved = __atomic_load_n(&g_reserved, __ATOMIC_RELAXED);
+    stats->high_water = __atomic_load_n(&g_high_water, __ATOMIC_RELAXED);
+    stats->rejected_request = __atomic_load_n(&g_rejected_request, __ATOMIC_RELAXED);
+    stats->rejected_session = __atomic_load_n(&g_rejected_session, __ATOMIC_RELAXED);
+    stats->rejected_global = __atomic_load_n(&g_rejected_global, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,79 @@
+#ifndef MCP_MEM_BUDGET_H
+#define MCP_MEM_BUDGET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Process-wide memory accounting and admission budgets.
+//
+// The HAL allocator charges every block it hands out (mcp_mem_budget_charge), which
+// gives the heap figure and its high-water mark. Incoming messages reserve their
+// expected working set before they are parsed: the text, its parse tree and the
+// reply, MCP_MEM_BUDGET_REQUEST_FACTOR times the message length. A reservation is
+// refused, never allocated into, when it would take the request, its session or the
+// process past its limit, so the caller can answer with a retryable error instead of
+// running out of memory halfway through. Transport buffers reserve their growth the
+// same way. Reserved bytes are counted on top of the heap, so the budget errs on the
+// side of refusing.
+
+#define MCP_MEM_BUDGET_REQUEST_FACTOR 4
+
+typedef struct {
+    size_t global_limit;        // Heap plus reservations, bytes (0: no limit)
+    size_t session_limit;       // Reservations of one session, bytes (0: no limit)
+    size_t request_limit;       // Reservation of one message, bytes (0: no limit)
+} mcp_mem_budget_config_t;
+
+// Reservations held by one session; zero-initialize before use
+typedef struct {
+    size_t reserved;
+} mcp_mem_account_t;
+
+typedef enum {
+    MCP_MEM_BUDGET_OK = 0,
+    MCP_MEM_BUDGET_REQUEST_LIMIT,   // Too large whatever the load - retrying will not help
+    MCP_MEM_BUDGET_SESSION_LIMIT,   // The session has too much in flight
+    MCP_MEM_BUDGET_GLOBAL_LIMIT     // The process is at its budget
+} mcp_mem_budget_result_t;
+
+typedef struct {
+    mcp_mem_budget_config_t config;
+    size_t heap_in_use;         // Charged by the HAL allocator
+    size_t reserved;            // Held by messages and transport buffers
+    size_t high_water;          // Most heap plus reservations seen
+    uint64_t rejected_request;
+    uint64_t rejected_session;
+    uint64_t rejected_global;
+} mcp_mem_budget_stats_t;
+
+// Replace the limits; reservations already held are kept
+void mcp_mem_budget_configure(const mcp_mem_budget_config_t *config);
+void mcp_mem_budget_get_config(mcp_mem_budget_config_t *config);
+
+// Heap accounting, called by the HAL allocator; never refuses
+void mcp_mem_budget_charge(size_t bytes);
+void mcp_mem_budget_uncharge(size_t bytes);
+
+/**
+ * Reserve bytes against the request, session and global limits
+ * @param account Session to charge, NULL when the message has none
+ * @return MCP_MEM_BUDGET_OK with the bytes reserved, else the limit that refused them
+ */
+mcp_mem_budget_result_t mcp_mem_budget_reserve(mcp_mem_account_t *account, size_t bytes);
+void mcp_mem_budget_release(mcp_mem_account_t *account, size_t bytes);
+
+// Bytes a message of this length reserves
+size_t mcp_mem_budget_request_cost(size_t length);
+
+// Retrying later can succeed (the session or process limit refused it)
+bool mcp_mem_budget_retryable(mcp_mem_budget_result_t result);
+const char *mcp_mem_budget_result_string(mcp_mem_budget_result_t result);
+
+// Global limit minus heap and reservations; SIZE_MAX without a global limit
+size_t mcp_mem_budget_available(void);
+
+// Counters read without stopping allocation, so they are approximate under load
+void mcp_mem_budget_get_stats(mcp_mem_budget_stats_t *stats);
+
+#endif // MCP_MEM_BUDGET_H
@@ -0,0 +1,142 @@
+#include "utils/metrics.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *metrics_type_name(mcp_metrics_type_t type) {
+    switch (type) {
+        case MCP_METRICS_COUNTER: return "counter";
+        case MCP_METRICS_GAUGE: return "gauge";
+        case MCP_METRICS_HISTOGRAM: return "histogram";
+    }
+    return "unknown";
+}
+
+// Label values escape backslash, quote and newline
+static int write_label_value(mcp_json_buffer_t *buffer, const char *value) {
+    const char *run = value;
+    for (const char *p = value; *p; p++) {
+        const char *escape = NULL;
+        if (*p == '\\') escape = "\\\\";
+        else if (*p == '"') escape = "\\\"";
+        else if (*p == '\n') escape = "\\n";
+        if (!escape) continue;
+
+        if (mcp_json_write_raw(buffer, run, (size_t)(p - run)) != 0 ||
+            mcp_json_write_literal(buffer, escape) != 0) {
+            return -1;
+        }
+        run = p + 1;
+    }
+    return mcp_json_write_literal(buffer, run);
+}
+
+// name{label="value",extra} - extra is an already formatted label (le="...") or NULL
+static int write_sample_name(mcp_json_buffer_t *buffer, const char *name, const char *suffix,
+                             const char *label_name, const char *label_value, const char *extra) {
+    if (mcp_json_write_literal(buffer, name) != 0) return -1;
+    if (suffix && mcp_json_write_literal(buffer, suffix) != 0) return -1;
+    if (!label_name && !extra) return 0;
+
+    if (mcp_json_write_raw(buffer, "{", 1) != 0) return -1;
+    if (label_name) {
+        if (mcp_json_write_literal(buffer, label_name) != 0 ||
+            mcp_json_write_raw(buffer, "=\"", 2) != 0 ||
+            write_label_value(buffer, label_value ? label_value : "") != 0 ||
+            mcp_json_write_raw(buffer, "\"", 1) != 0) {
+            return -1;
+        }
+        if (extra && mcp_json_write_raw(buffer, ",", 1) != 0) return -1;
+    }
+    if (extra && mcp_json_write_literal(buffer, extra) != 0) return -1;
+    return mcp_json_write_raw(buffer, "}", 1);
+}
+
+static int write_sample_end_int(mcp_json_buffer_t *buffer, uint64_t value) {
+    if (mcp_json_write_raw(buffer, " ", 1) != 0) return -1;
+    if (mcp_json_write_int(buffer, (long long)value) != 0) return -1;
+    return mcp_json_write_raw(buffer, "\n", 1);
+}
+
+static int write_sample_end_double(mcp_json_buffer_t *buffer, double value) {
+    if (mcp_json_write_raw(buffer, " ", 1) != 0) return -1;
+    if (mcp_json_write_number(buffer, value) != 0) return -1;
+    return mcp_json_write_raw(buffer, "\n", 1);
+}
+
+int mcp_metrics_write_family(mcp_json_buffer_t *buffer, const char *name,
+                             mcp_metrics_type_t type, const char *help) {
+    if (!buffer || !name) return -1;
+
+    if (mcp_json_write_literal(buffer, "# TYPE ") != 0 ||
+        mcp_json_write_literal(buffer, name) != 0 ||
+        mcp_json_write_raw(buffer, " ", 1) != 0 ||
+        mcp_json_write_literal(buffer, metrics_type_name(type)) != 0 ||
+        mcp_json_write_raw(buffer, "\n", 1) != 0) {
+        return -1;
+    }
+    if (!help) return 0;
+
+    if (mcp_json_write_literal(buffer, "# HELP ") != 0 ||
+        mcp_json_write_literal(buffer, name) != 0 ||
+        mcp_json_write_raw(buffer, " ", 1) != 0 ||
+        mcp_json_write_literal(buffer, help) != 0) {
+        return -1;
+    }
+    return mcp_json_write_raw(buffer, "\n", 1);
+}
+
+int mcp_metrics_write_counter(mcp_json_buffer_t *buffer, const char *name,
+                              const char *label_name, const char *label_value, uint64_t value) {
+    if (!buffer || !name) return -1;
+    if (write_sample_name(buffer, name, "_total", label_name, label_value, NULL) != 0) return -1;
+    return write_sample_end_int(buffer, value);
+}
+
+int mcp_metrics_write_gauge(mcp_json_buffer_t *buffer, const char *name,
+                            const char *label_name, const char *label_value, double value) {
+    if (!buffer || !name) return -1;
+    if (write_sample_name(buffer, name, NULL, label_name, label_value, NULL) != 0) return -1;
+    return write_sample_end_double(buffer, value);
+}
+
+int mcp_metrics_write_histogram(mcp_json_buffer_t *buffer, const char *name,
+                                const char *label_name, const char *label_value,
+                                const mcp_histogram_t *histogram, mcp_metrics_unit_t unit) {
+    if (!buffer || !name || !histogram) return -1;
+
+    // Bucket bounds 2^k are histogram bucket edges, so the cumulative counts are exact.
+    // Seconds: 16us .. ~16.8s, bytes: 64B .. 16MiB
+    unsigned first = unit == MCP_METRICS_UNIT_SECONDS ? 4 : 6;
+    unsigned last = 24;
+    double divisor = unit == MCP_METRICS_UNIT_SECONDS ? 1000000.0 : 1.0;
+
+    uint64_t cumulative = 0;
+    size_t index = 0;
+    char le[48];
+
+    for (unsigned k = first; k <= last; k += 2) {
+        uint64_t bound = (uint64_t)1 << k;
+        while (index < MCP_HISTOGRAM_BUCKETS && mcp_histogram_bucket_upper(index) < bound) {
+            cumulative += histogram->buckets[index++];
+        }
+        snprintf(le, sizeof(le), "le=\"%.9g\"", (double)bound / divisor);
+        if (write_sample_name(buffer, name, "_bucket", label_name, label_value, le) != 0 ||
+            write_sample_end_int(buffer, cumulative) != 0) {
+            return -1;
+        }
+    }
+
+    if (write_sample_name(buffer, name, "_bucket", label_name, label_value, "le=\"+Inf\"") != 0 ||
+        write_sample_end_int(buffer, histogram->count) != 0 ||
+        write_sample_name(buffer, name, "_count", label_name, label_value, NULL) != 0 ||
+        write_sample_end_int(buffer, histogram->count) != 0 ||
+        write_sample_name(buffer, name, "_sum", label_name, label_value, NULL) != 0 ||
+        write_sample_end_double(buffer, (double)histogram->sum_us / divisor) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int mcp_metrics_write_eof(mcp_json_buffer_t *buffer) {
+    return mcp_json_write_literal(buffer, "# EOF\n");
+}
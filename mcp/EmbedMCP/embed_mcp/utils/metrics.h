@@ -0,0 +1,43 @@
+#ifndef MCP_METRICS_H
+#define MCP_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "protocol/json_writer.h"
+#include "utils/histogram.h"
+
+// OpenMetrics text exposition (application/openmetrics-text 1.0.0), written into a
+// growable buffer. Write each family header once, then its samples; finish with
+// mcp_metrics_write_eof(). Samples take at most one label; label_name NULL means none.
+
+#define MCP_METRICS_CONTENT_TYPE "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+typedef enum {
+    MCP_METRICS_COUNTER,
+    MCP_METRICS_GAUGE,
+    MCP_METRICS_HISTOGRAM
+} mcp_metrics_type_t;
+
+// How histogram values are exported: microseconds as seconds, or plain bytes
+typedef enum {
+    MCP_METRICS_UNIT_SECONDS,
+    MCP_METRICS_UNIT_BYTES
+} mcp_metrics_unit_t;
+
+int mcp_metrics_write_family(mcp_json_buffer_t *buffer, const char *name,
+                             mcp_metrics_type_t type, const char *help);
+
+// Counters get the "_total" suffix added to name
+int mcp_metrics_write_counter(mcp_json_buffer_t *buffer, const char *name,
+                              const char *label_name, const char *label_value, uint64_t value);
+int mcp_metrics_write_gauge(mcp_json_buffer_t *buffer, const char *name,
+                            const char *label_name, const char *label_value, double value);
+
+// Cumulative _bucket lines at every fourth power of two, then _count and _sum
+int mcp_metrics_write_histogram(mcp_json_buffer_t *buffer, const char *name,
+                                const char *label_name, const char *label_value,
+                                const mcp_histogram_t *histogram, mcp_metrics_unit_t unit);
+
+int mcp_metrics_write_eof(mcp_json_buffer_t *buffer);
+
+#endif // MCP_METRICS_H
@@ -0,0 +1,279 @@
+#include "utils/trace.h"
+#include "hal/platform_hal.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One thread's spans. The owning thread writes the slot, then publishes it by
+// advancing head; readers copy the ring and keep only slots that head shows were
+// not being rewritten meanwhile.
+typedef struct trace_ring {
+    struct trace_ring *next;
+    uint32_t thread;            // Thread number in the export
+    int in_use;                 // Owned by a live thread (atomic)
+    uint64_t head;              // Spans written (atomic, advanced by the owner only)
+    uint64_t cleared;           // Spans before this index were dropped (atomic)
+    size_t capacity;            // Power of two
+    mcp_trace_span_t spans[];
+} trace_ring_t;
+
+int g_mcp_trace_enabled = 0;
+
+static struct {
+    pthread_mutex_t mutex;      // Ring list and configuration
+    trace_ring_t *rings;        // Never freed: a thread may be recording into any of them
+    uint32_t next_thread;
+    size_t capacity;            // Ring size for threads registering next
+    uint64_t (*clock)(void);
+    uint64_t origin_us;         // Export timestamps count from here
+    mcp_histogram_t *phases;    // MCP_TRACE_PHASE_COUNT, allocated on first enable
+    uint32_t next_request;      // Atomic
+} g_trace = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+#if defined(__GNUC__)
+static __thread trace_ring_t *t_ring = NULL;
+static __thread uint32_t t_request = 0;
+#else
+static trace_ring_t *t_ring = NULL;
+static uint32_t t_request = 0;
+#endif
+
+static pthread_key_t g_ring_key;
+static pthread_once_t g_ring_once = PTHREAD_ONCE_INIT;
+
+static const char *const k_phase_names[MCP_TRACE_PHASE_COUNT] = {
+    "request", "parse", "dispatch", "handle", "execute", "serialize", "send"
+};
+
+// A ring whose thread exited is handed to the next thread that records
+static void ring_thread_exit(void *arg) {
+    __atomic_store_n(&((trace_ring_t*)arg)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void ring_key_init(void) {
+    pthread_key_create(&g_ring_key, ring_thread_exit);
+}
+
+// The calling thread's ring, NULL if none can be registered
+static trace_ring_t *thread_ring(void) {
+    if (t_ring) return t_ring;
+
+    pthread_once(&g_ring_once, ring_key_init);
+    pthread_mutex_lock(&g_trace.mutex);
+
+    trace_ring_t *ring = g_trace.rings;
+    while (ring && (__atomic_load_n(&ring->in_use, __ATOMIC_ACQUIRE) || ring->capacity != g_trace.capacity)) {
+        ring = ring->next;
+    }
+    if (ring) {
+        // The previous thread's spans would be shown under the new thread
+        __atomic_store_n(&ring->cleared, ring->head, __ATOMIC_RELAXED);
+    } else {
+        ring = calloc(1, sizeof(trace_ring_t) + g_trace.capacity * sizeof(mcp_trace_span_t));
+        if (!ring) {
+            pthread_mutex_unlock(&g_trace.mutex);
+            return NULL;
+        }
+        ring->capacity = g_trace.capacity;
+        ring->next = g_trace.rings;
+        g_trace.rings = ring;
+    }
+    ring->thread = ++g_trace.next_thread;
+    ring->in_use = 1;
+    pthread_mutex_unlock(&g_trace.mutex);
+
+    pthread_setspecific(g_ring_key, ring);
+    t_ring = ring;
+    return ring;
+}
+
+static size_t round_up_power_of_two(size_t value) {
+    size_t power = 16;
+    while (power < value) power <<= 1;
+    return power;
+}
+
+int mcp_trace_enable(size_t spans_per_thread) {
+    pthread_mutex_lock(&g_trace.mutex);
+
+    if (!g_trace.clock) {
+        const mcp_platform_hal_t *hal = mcp_platform_get_hal();
+        g_trace.clock = hal ? hal->time.get_time_us : NULL;
+    }
+    if (!g_trace.phases) {
+        g_trace.phases = calloc(MCP_TRACE_PHASE_COUNT, sizeof(mcp_histogram_t));
+    }
+    if (!g_trace.clock || !g_trace.phases) {
+        pthread_mutex_unlock(&g_trace.mutex);
+        return -1;
+    }
+
+    g_trace.capacity = round_up_power_of_two(spans_per_thread ? spans_per_thread : MCP_TRACE_DEFAULT_SPANS);
+    if (g_trace.origin_us == 0) {
+        g_trace.origin_us = g_trace.clock();
+    }
+    __atomic_store_n(&g_mcp_trace_enabled, 1, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&g_trace.mutex);
+    return 0;
+}
+
+void mcp_trace_disable(void) {
+    __atomic_store_n(&g_mcp_trace_enabled, 0, __ATOMIC_RELEASE);
+}
+
+void mcp_trace_clear(void) {
+    pthread_mutex_lock(&g_trace.mutex);
+    for (trace_ring_t *ring = g_trace.rings; ring; ring = ring->next) {
+        __atomic_store_n(&ring->cleared, __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+    }
+    // Spans recorded concurrently may be counted or not
+    for (int i = 0; g_trace.phases && i < MCP_TRACE_PHASE_COUNT; i++) {
+        mcp_histogram_reset(&g_trace.phases[i]);
+    }
+    if (g_trace.clock) {
+        g_trace.origin_us = g_trace.clock();
+    }
+    pthread_mutex_unlock(&g_trace.mutex);
+}
+
+uint64_t mcp_trace_now(void) {
+    uint64_t (*clock)(void) = g_trace.clock;
+    return clock ? clock() : 0;
+}
+
+void mcp_trace_record(mcp_trace_phase_t phase, uint64_t start, const char *detail) {
+    if (!start || (unsigned)phase >= MCP_TRACE_PHASE_COUNT) return;
+
+    uint64_t end = mcp_trace_now();
+    uint64_t duration = end > start ? end - start : 0;
+    if (duration > UINT32_MAX) duration = UINT32_MAX;
+
+    trace_ring_t *ring = thread_ring();
+    if (ring) {
+        uint64_t head = ring->head;
+        mcp_trace_span_t *span = &ring->spans[head & (ring->capacity - 1)];
+        span->start_us = start;
+        span->duration_us = (uint32_t)duration;
+        span->request = t_request;
+        span->phase = (uint8_t)phase;
+
+        size_t length = 0;
+        while (detail && detail[length] && length < MCP_TRACE_DETAIL_SIZE - 1) {
+            span->detail[length] = detail[length];
+            length++;
+        }
+        span->detail[length] = '\0';
+
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    }
+    mcp_histogram_record_atomic(&g_trace.phases[phase], duration);
+}
+
+uint32_t mcp_trace_begin_request(void) {
+    uint32_t previous = t_request;
+    if (__atomic_load_n(&g_mcp_trace_enabled, __ATOMIC_RELAXED)) {
+        t_request = __atomic_add_fetch(&g_trace.next_request, 1, __ATOMIC_RELAXED);
+    }
+    return previous;
+}
+
+void mcp_trace_end_request(uint32_t previous) {
+    t_request = previous;
+}
+
+const char *mcp_trace_phase_name(mcp_trace_phase_t phase) {
+    return (unsigned)phase < MCP_TRACE_PHASE_COUNT ? k_phase_names[phase] : "unknown";
+}
+
+void mcp_trace_get_stats(mcp_trace_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    stats->enabled = __atomic_load_n(&g_mcp_trace_enabled, __ATOMIC_RELAXED) != 0;
+
+    pthread_mutex_lock(&g_trace.mutex);
+    for (trace_ring_t *ring = g_trace.rings; ring; ring = ring->next) {
+        uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint64_t cleared = __atomic_load_n(&ring->cleared, __ATOMIC_RELAXED);
+        if (head <= cleared) continue;
+
+        stats->threads++;
+        stats->spans += head - cleared;
+        if (head - cleared > ring->capacity) {
+            stats->overwritten += head - cleared - ring->capacity;
+        }
+    }
+    pthread_mutex_unlock(&g_trace.mutex);
+}
+
+void mcp_trace_get_phase(mcp_trace_phase_t phase, mcp_histogram_t *histogram) {
+    if (!histogram) return;
+    mcp_histogram_reset(histogram);
+    if (g_trace.phases && (unsigned)phase < MCP_TRACE_PHASE_COUNT) {
+        mcp_histogram_merge(histogram, &g_trace.phases[phase]);
+    }
+}
+
+static int write_span(mcp_json_buffer_t *out, const trace_ring_t *ring, const mcp_trace_span_t *span,
+                      bool first) {
+    if (mcp_json_write_literal(out, first ? "{\"name\":" : ",{\"name\":") != 0 ||
+        mcp_json_write_string(out, mcp_trace_phase_name((mcp_trace_phase_t)span->phase)) != 0 ||
+        mcp_json_write_literal(out, ",\"cat\":\"embedmcp\",\"ph\":\"X\",\"pid\":1,\"tid\":") != 0 ||
+        mcp_json_write_int(out, ring->thread) != 0 ||
+        mcp_json_write_literal(out, ",\"ts\":") != 0 ||
+        mcp_json_write_int(out, (long long)(span->start_us - g_trace.origin_us)) != 0 ||
+        mcp_json_write_literal(out, ",\"dur\":") != 0 ||
+        mcp_json_write_int(out, span->duration_us) != 0 ||
+        mcp_json_write_literal(out, ",\"args\":{\"request\":") != 0 ||
+        mcp_json_write_int(out, span->request) != 0) {
+        return -1;
+    }
+    if (span->detail[0] &&
+        (mcp_json_write_literal(out, ",\"detail\":") != 0 ||
+         mcp_json_write_string(out, span->detail) != 0)) {
+        return -1;
+    }
+    return mcp_json_write_literal(out, "}}");
+}
+
+int mcp_trace_write_chrome(mcp_json_buffer_t *out) {
+    if (!out) return -1;
+
+    pthread_mutex_lock(&g_trace.mutex);
+
+    size_t capacity = 0;
+    for (trace_ring_t *ring = g_trace.rings; ring; ring = ring->next) {
+        if (ring->capacity > capacity) capacity = ring->capacity;
+    }
+    mcp_trace_span_t *copy = capacity ? malloc(capacity * sizeof(mcp_trace_span_t)) : NULL;
+    int result = (capacity && !copy) ? -1 : mcp_json_write_literal(out, "{\"traceEvents\":[");
+    bool first = true;
+
+    for (trace_ring_t *ring = g_trace.rings; ring && result == 0; ring = ring->next) {
+        uint64_t end = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint64_t begin = __atomic_load_n(&ring->cleared, __ATOMIC_RELAXED);
+        if (end - begin > ring->capacity) begin = end - ring->capacity;
+        for (uint64_t i = begin; i < end; i++) {
+            copy[i - begin] = ring->spans[i & (ring->capacity - 1)];
+        }
+
+        // The owner may have gone on writing while the ring was copied: slots it has
+        // reached since (and the one it is writing) no longer hold the spans read
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint64_t now = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        uint64_t valid = now + 1 > ring->capacity ? now + 1 - ring->capacity : 0;
+
+        for (uint64_t i = begin > valid ? begin : valid; i < end && result == 0; i++) {
+            const mcp_trace_span_t *span = &copy[i - begin];
+            if (span->start_us < g_trace.origin_us) continue;
+            result = write_span(out, ring, span, first);
+            first = false;
+        }
+    }
+
+    pthread_mutex_unlock(&g_trace.mutex);
+    free(copy);
+
+    if (result != 0) return -1;
+    return mcp_json_write_literal(out, "],\"displayTimeUnit\":\"ms\"}");
+}
@@ -0,0 +1,100 @@
+#ifndef MCP_TRACE_H
+#define MCP_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "protocol/json_writer.h"
+#include "utils/histogram.h"
+
+// Request trace spans: how long each phase of handling a message took, timed with
+// the HAL microsecond clock. Every thread records into its own fixed-size ring, so
+// recording takes no lock; once a ring is full the oldest spans are overwritten.
+// While tracing is off, mcp_trace_begin() is one relaxed load and a branch.
+//
+// Phases nest: a request contains its parse, dispatch, handle, serialize and send
+// spans, and tools/call's handle span contains the tool's dispatch and execute spans.
+// Recording is process-wide, shared by every server.
+
+#define MCP_TRACE_DEFAULT_SPANS 1024    // Spans per thread
+#define MCP_TRACE_DETAIL_SIZE 24        // Method or tool name kept with a span (truncated)
+
+typedef enum {
+    MCP_TRACE_REQUEST = 0,      // One message, from receipt until its reply was sent
+    MCP_TRACE_PARSE,            // JSON text to a JSON-RPC message
+    MCP_TRACE_DISPATCH,         // Method or tool lookup
+    MCP_TRACE_HANDLE,           // Method handler
+    MCP_TRACE_EXECUTE,          // Tool function, argument checks included
+    MCP_TRACE_SERIALIZE,        // Result and reply to JSON text
+    MCP_TRACE_SEND,             // Reply handed to the transport
+    MCP_TRACE_PHASE_COUNT
+} mcp_trace_phase_t;
+
+typedef struct {
+    uint64_t start_us;          // HAL clock
+    uint32_t duration_us;
+    uint32_t request;           // Request the span belongs to, 0: none on this thread
+    uint8_t phase;              // mcp_trace_phase_t
+    char detail[MCP_TRACE_DETAIL_SIZE];
+} mcp_trace_span_t;
+
+typedef struct {
+    bool enabled;
+    size_t threads;                     // Threads that recorded spans
+    uint64_t spans;                     // Spans recorded since the last clear
+    uint64_t overwritten;               // Spans lost to full rings
+} mcp_trace_stats_t;
+
+// Non-zero while spans are recorded (read with mcp_trace_begin())
+extern int g_mcp_trace_enabled;
+
+/**
+ * Start recording spans; threads that record their first span afterwards get rings
+ * of spans_per_thread entries (0: MCP_TRACE_DEFAULT_SPANS)
+ * @return 0 on success, -1 if the HAL has no microsecond clock or out of memory
+ */
+int mcp_trace_enable(size_t spans_per_thread);
+
+// Stop recording; spans recorded so far can still be exported
+void mcp_trace_disable(void);
+
+// Drop the spans recorded so far and reset the phase histograms
+void mcp_trace_clear(void);
+
+uint64_t mcp_trace_now(void);
+
+// Start of a span, 0 when tracing is off
+static inline uint64_t mcp_trace_begin(void) {
+    return __atomic_load_n(&g_mcp_trace_enabled, __ATOMIC_RELAXED) ? mcp_trace_now() : 0;
+}
+
+/**
+ * Record a span that started at start (from mcp_trace_begin(); 0 records nothing)
+ * @param detail Method or tool name, may be NULL
+ */
+void mcp_trace_record(mcp_trace_phase_t phase, uint64_t start, const char *detail);
+
+static inline void mcp_trace_end(mcp_trace_phase_t phase, uint64_t start, const char *detail) {
+    if (start) mcp_trace_record(phase, start, detail);
+}
+
+// Spans recorded on this thread from now on belong to a new request; returns the
+// previous request so a nested message can restore it
+uint32_t mcp_trace_begin_request(void);
+void mcp_trace_end_request(uint32_t previous);
+
+const char *mcp_trace_phase_name(mcp_trace_phase_t phase);
+
+void mcp_trace_get_stats(mcp_trace_stats_t *stats);
+
+// Durations recorded for phase since tracing was first enabled or last cleared
+void mcp_trace_get_phase(mcp_trace_phase_t phase, mcp_histogram_t *histogram);
+
+/**
+ * Write the recorded spans as Chrome trace-event JSON ({"traceEvents":[...]}), for
+ * chrome://tracing or Perfetto. Timestamps count from when tracing was enabled.
+ * @return 0 on success, -1 on allocation failure
+ */
+int mcp_trace_write_chrome(mcp_json_buffer_t *out);
+
+#endif // MCP_TRACE_H
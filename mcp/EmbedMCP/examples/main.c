@@ -1,8 +1,13 @@
 #include "embed_mcp.h"
+#include "platform/linux/linux_uart_driver.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
 
 // =============================================================================
 // Pure Business Function Examples - No JSON handling required!
@@ -57,6 +62,15 @@ char* get_weather(const char* city) {
     return strdup("Weather information is currently only available for Jinan (济南). Please try 'jinan', 'Jinan', or '济南'.");
 }
 
+// Example 5: Small functions registered from a compile-time table
+double multiply_numbers(double a, double b) {
+    return a * b;
+}
+
+int clamp_value(int value, int low, int high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
 // Example 4: Multi-parameter function with mixed types
 int calculate_score(int base_points, const char* grade, double multiplier) {
     char grade_char = grade[0];  // Take first character from string
@@ -85,7 +99,7 @@ int calculate_score(int base_points, const char* grade, double multiplier) {
 // =============================================================================
 
 // Array sum function - double[] -> double
-double sum_numbers(double* numbers, size_t count) {
+double sum_numbers(const double* numbers, size_t count) {
     if (!numbers || count == 0) return 0.0;
 
     double sum = 0.0;
@@ -102,25 +116,20 @@ double sum_numbers(double* numbers, size_t count) {
 void* sum_numbers_wrapper(mcp_param_accessor_t* params, void* user_data) {
     (void)user_data;
 
-    size_t count;
-    double* numbers = params->get_double_array(params, "numbers", &count);
+    // View into server-owned memory: no copy to free
+    DOUBLE_ARRAY_EXTRACT(numbers, params);
 
-    if (!numbers || count == 0) {
-        double* result = malloc(sizeof(double));
-        *result = 0.0;
-        return result;
+    if (!numbers || numbers_count == 0) {
+        DOUBLE_RETURN(0.0);
     }
 
-    double sum = sum_numbers(numbers, count);
-    free(numbers); // Clean up array memory
+    double sum = sum_numbers(numbers, numbers_count);
 
-    double* result = malloc(sizeof(double));
-    *result = sum;
-    return result;
+    DOUBLE_RETURN(sum);   // Written into the caller's result slot, no malloc
 }
 
 // String array join function - string[], string -> string
-char* join_strings(char** strings, size_t count, const char* separator) {
+char* join_strings(const char* const* strings, size_t count, const char* separator) {
     if (!strings || count == 0) return strdup("");
     if (!separator) separator = ",";
 
@@ -159,30 +168,14 @@ char* join_strings(char** strings, size_t count, const char* separator) {
 void* join_strings_wrapper(mcp_param_accessor_t* params, void* user_data) {
     (void)user_data;
 
-    size_t count;
-    char** strings = params->get_string_array(params, "strings", &count);
+    STRING_ARRAY_EXTRACT(strings, params);   // Borrowed element pointers, nothing to free
     const char* separator = params->get_string(params, "separator");
 
-    if (!strings || count == 0) {
-        if (strings) {
-            // Clean up string array memory
-            for (size_t i = 0; i < count; i++) {
-                if (strings[i]) free(strings[i]);
-            }
-            free(strings);
-        }
+    if (!strings || strings_count == 0) {
         return strdup("");
     }
 
-    char* result = join_strings(strings, count, separator);
-
-    // Clean up string array memory
-    for (size_t i = 0; i < count; i++) {
-        if (strings[i]) free(strings[i]);
-    }
-    free(strings);
-
-    return result;
+    return join_strings(strings, strings_count, separator);
 }
 
 // =============================================================================
@@ -194,9 +187,60 @@ EMBED_MCP_WRAPPER(add_numbers_wrapper, add_numbers, DOUBLE, DOUBLE, a, DOUBLE, b
 EMBED_MCP_WRAPPER(get_weather_wrapper, get_weather, STRING, STRING, city)
 EMBED_MCP_WRAPPER(calculate_score_wrapper, calculate_score, INT, INT, base_points, STRING, grade, DOUBLE, multiplier)
 
+EMBED_MCP_WRAPPER(multiply_numbers_wrapper, multiply_numbers, DOUBLE, DOUBLE, a, DOUBLE, b)
+EMBED_MCP_WRAPPER(clamp_value_wrapper, clamp_value, INT, INT, value, INT, low, INT, high)
+
+// Descriptors and schemas are constants - registering them copies nothing
+static const embed_mcp_tool_desc_t example_tool_table[] = {
+    EMBED_MCP_TOOL("multiply", "Multiply two numbers", multiply_numbers_wrapper, MCP_RETURN_DOUBLE,
+                   DOUBLE, a, DOUBLE, b),
+    EMBED_MCP_TOOL("clamp", "Clamp a value to [low, high]", clamp_value_wrapper, MCP_RETURN_INT,
+                   INT, value, INT, low, INT, high),
+};
+
 // Note: Array functions use traditional wrappers (sum_numbers_wrapper, join_strings_wrapper)
 // because array parameter handling is more complex and requires count management
 
+// =============================================================================
+// Async Tool Example - work finishes on another thread
+// =============================================================================
+
+// Counts down one step every 500ms, reporting progress; stops early when cancelled
+static void* countdown_thread(void* arg) {
+    mcp_tool_call_t* call = (mcp_tool_call_t*)arg;
+    const cJSON* steps_item = cJSON_GetObjectItem(mcp_tool_call_get_arguments(call), "steps");
+    int steps = cJSON_IsNumber(steps_item) ? steps_item->valueint : 0;
+    struct timespec delay = { 0, 500 * 1000000L };
+
+    for (int i = 0; i < steps; i++) {
+        if (mcp_tool_call_is_cancelled(call)) {
+            mcp_tool_call_complete(call, mcp_tool_create_execution_error("Countdown cancelled"));
+            return NULL;
+        }
+        char message[64];
+        snprintf(message, sizeof(message), "%d step(s) left", steps - i);
+        mcp_tool_call_report_progress(call, i, steps, message);
+        nanosleep(&delay, NULL);
+    }
+
+    char text[64];
+    snprintf(text, sizeof(text), "Countdown of %d step(s) finished", steps);
+    mcp_tool_call_complete(call, mcp_tool_create_success_result_take(cJSON_CreateString(text)));
+    return NULL;
+}
+
+int countdown_start(const cJSON* parameters, mcp_tool_call_t* call, void* user_data) {
+    (void)parameters;
+    (void)user_data;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, countdown_thread, call) != 0) {
+        return -1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
+
 // =============================================================================
 // Resource Examples - Demonstrate MCP Resource System
 // =============================================================================
@@ -247,13 +291,108 @@ char* get_server_config(void *user_data) {
     return config;
 }
 
+// Example 3: Session store on a directory - a stand-in for Redis or etcd that nodes on
+// one machine (or a shared mount) can use. One file per key: expiry line, then value.
+static void session_dir_path(const char *dir, const char *key, char *path, size_t size) {
+    snprintf(path, size, "%s/%s", dir, key);
+    for (char *c = path + strlen(dir) + 1; *c; c++) {
+        if (*c == ':' || *c == '/') *c = '_';
+    }
+}
+
+static int session_dir_get(void *ctx, const char *key, char **value, size_t *length) {
+    char path[512];
+    session_dir_path((const char *)ctx, key, path, sizeof(path));
+    FILE *file = fopen(path, "r");
+    if (!file) return 1;
+
+    long long expires_at = 0;
+    char *text = malloc(4096);
+    size_t read = 0;
+    if (text && fscanf(file, "%lld\n", &expires_at) == 1) {
+        read = fread(text, 1, 4095, file);
+    }
+    fclose(file);
+    if (!text || read == 0 || expires_at < (long long)time(NULL)) {
+        free(text);
+        return text ? 1 : -1;
+    }
+
+    text[read] = '\0';
+    *value = text;
+    *length = read;
+    return 0;
+}
+
+static int session_dir_set_many(void *ctx, const mcp_kv_entry_t *entries, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        char path[512], temp[544];
+        session_dir_path((const char *)ctx, entries[i].key, path, sizeof(path));
+        if (entries[i].if_exists && access(path, F_OK) != 0) continue;
+
+        // Write aside and rename, so readers never see half a value
+        snprintf(temp, sizeof(temp), "%s.%ld", path, (long)getpid());
+        FILE *file = fopen(temp, "w");
+        if (!file) return -1;
+        fprintf(file, "%lld\n", (long long)entries[i].expires_at);
+        fwrite(entries[i].value, 1, entries[i].length, file);
+        if (fclose(file) != 0 || rename(temp, path) != 0) return -1;
+    }
+    return 0;
+}
+
+static int session_dir_del(void *ctx, const char *key) {
+    char path[512];
+    session_dir_path((const char *)ctx, key, path, sizeof(path));
+    return unlink(path) == 0 || access(path, F_OK) != 0 ? 0 : -1;
+}
+
+static int session_dir_scan(void *ctx, const char *prefix, mcp_kv_scan_fn fn, void *user_data) {
+    DIR *dir = opendir((const char *)ctx);
+    if (!dir) return -1;
+
+    char file_prefix[256];
+    session_dir_path("", prefix, file_prefix, sizeof(file_prefix));
+    struct dirent *entry;
+    int result = 0;
+    while (result == 0 && (entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, file_prefix + 1, strlen(file_prefix + 1)) != 0 ||
+            strchr(entry->d_name, '.')) {
+            continue;
+        }
+
+        char *value = NULL;
+        size_t length = 0;
+        if (session_dir_get(ctx, entry->d_name, &value, &length) == 0) {
+            // Hand back the key as it was written
+            char key[256];
+            snprintf(key, sizeof(key), "%s%s", prefix, entry->d_name + strlen(file_prefix + 1));
+            result = fn(key, value, length, user_data);
+            free(value);
+        }
+    }
+    closedir(dir);
+    return 0;
+}
+
 void print_usage(const char *program_name) {
     printf("Usage: %s [OPTIONS]\n", program_name);
     printf("Options:\n");
-    printf("  -t, --transport TYPE    Transport type (stdio|http) [default: stdio]\n");
+    printf("  -t, --transport TYPE    Transport type (stdio|http|uart) [default: stdio]\n");
     printf("  -p, --port PORT         HTTP port [default: 9943]\n");
     printf("  -b, --bind HOST         HTTP bind address [default: 0.0.0.0]\n");
     printf("  -e, --endpoint PATH     HTTP endpoint path [default: /mcp]\n");
+    printf("  -l, --loops N           HTTP event loop threads sharing the port [default: 1]\n");
+    printf("  -c, --capture DIR       Capture traffic per session into DIR (replay with mcp_replay)\n");
+    printf("  -j, --json-pool         Allocate JSON values from a slab pool\n");
+    printf("  -T, --trace             Record request trace spans (export with the trace_export tool)\n");
+    printf("  -m, --memory KB         Memory budget; one request may use a quarter of it\n");
+    printf("  -s, --stateless SECRET  Signed session tokens instead of a session table (HTTP)\n");
+    printf("  -S, --session-dir DIR   Keep sessions in DIR, shared with other nodes (HTTP)\n");
+    printf("  -w, --queue-wait MS     Shed requests (503) once their class has queued this long\n");
+    printf("  -u, --uart DEVICE       Serial device for the UART transport [default: /dev/ttyUSB0]\n");
+    printf("  -B, --baud RATE         UART baud rate [default: 115200]\n");
+    printf("  -C, --cbor              Also accept CBOR on the UART, negotiated in initialize\n");
     printf("  -d, --debug             Enable debug logging\n");
     printf("  -h, --help              Show this help message\n");
     printf("\nExamples:\n");
@@ -261,6 +400,7 @@ void print_usage(const char *program_name) {
     printf("  %s -t http              # HTTP on default port 9943\n", program_name);
     printf("  %s -t http -p 8080      # HTTP on port 8080\n", program_name);
     printf("  %s -t http -b 192.168.1.100  # HTTP bind to specific IP\n", program_name);
+    printf("  %s -t uart -u /dev/ttyAMA0   # COBS framed JSON-RPC over a serial port\n", program_name);
     printf("\nRaspberry Pi Examples:\n");
     printf("  %s -t http -p 9943 -d   # HTTP with debug on Pi\n", program_name);
     printf("  %s -t http -b $(hostname -I | cut -d' ' -f1) # Bind to Pi's IP\n", program_name);
@@ -273,6 +413,18 @@ int main(int argc, char *argv[]) {
     const char *bind_address = "0.0.0.0";
     const char *endpoint_path = "/mcp";
     int debug = 0;
+    int event_loops = 1;
+    const char *capture_dir = NULL;
+    int json_pool = 0;
+    int trace = 0;
+    size_t memory_kb = 0;
+    const char *session_secret = NULL;
+    const char *session_dir = NULL;
+    int queue_wait_ms = 0;
+    const char *uart_device = "/dev/ttyUSB0";
+    int uart_baud = 115200;
+    int uart_cbor = 0;
+    mcp_uart_driver_t *uart_driver = NULL;
     int result;
          
     static struct option long_options[] = {
@@ -280,18 +432,40 @@ int main(int argc, char *argv[]) {
         {"port", required_argument, 0, 'p'},
         {"bind", required_argument, 0, 'b'},
         {"endpoint", required_argument, 0, 'e'},
+        {"loops", required_argument, 0, 'l'},
+        {"capture", required_argument, 0, 'c'},
+        {"json-pool", no_argument, 0, 'j'},
+        {"trace", no_argument, 0, 'T'},
+        {"memory", required_argument, 0, 'm'},
+        {"stateless", required_argument, 0, 's'},
+        {"session-dir", required_argument, 0, 'S'},
+        {"queue-wait", required_argument, 0, 'w'},
+        {"uart", required_argument, 0, 'u'},
+        {"baud", required_argument, 0, 'B'},
+        {"cbor", no_argument, 0, 'C'},
         {"debug", no_argument, 0, 'd'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
     
     int c;
-    while ((c = getopt_long(argc, argv, "t:p:b:e:dh", long_options, NULL)) != -1) {
+    while ((c = getopt_long(argc, argv, "t:p:b:e:l:c:jTm:s:S:w:u:B:Cdh", long_options, NULL)) != -1) {
         switch (c) {
             case 't': transport_type = optarg; break;
             case 'p': port = atoi(optarg); break;
             case 'b': bind_address = optarg; break;
             case 'e': endpoint_path = optarg; break;
+            case 'l': event_loops = atoi(optarg); break;
+            case 'c': capture_dir = optarg; break;
+            case 'j': json_pool = 1; break;
+            case 'T': trace = 1; break;
+            case 'm': memory_kb = (size_t)strtoul(optarg, NULL, 10); break;
+            case 's': session_secret = optarg; break;
+            case 'S': session_dir = optarg; break;
+            case 'w': queue_wait_ms = atoi(optarg); break;
+            case 'u': uart_device = optarg; break;
+            case 'B': uart_baud = atoi(optarg); break;
+            case 'C': uart_cbor = 1; break;
             case 'd': debug = 1; break;
             case 'h':
                 print_usage(argv[0]);
@@ -347,9 +521,39 @@ int main(int argc, char *argv[]) {
         .max_connections = 3,       // Limited resources on Pi, reduce concurrent connections
         .session_timeout = 1800,    // 30 minutes session timeout
         .enable_sessions = 1,       // Enable session management
-        .auto_cleanup = 1           // Auto cleanup expired sessions
+        .auto_cleanup = 1,          // Auto cleanup expired sessions
+        .stateless_sessions = session_secret != NULL,   // Any node with the secret serves the client
+        .session_secret = session_secret,
+
+        // Run HTTP tool calls off the event loop so a slow tool doesn't block other clients
+        .worker_threads = 2,
+        .event_loops = event_loops,
+
+        // Initialize and ping jump the tool call queue; floods get 503 instead of waiting
+        .queue_wait_ms = queue_wait_ms,
+
+        // Refuse requests early (retryable error) instead of running out of memory
+        .memory_budget = memory_kb * 1024,
+        .request_memory_limit = memory_kb * 1024 / 4
     };
 
+    // UART: the host stands in for a board, emulating its DMA with threads
+    if (strcmp(transport_type, "uart") == 0) {
+        uart_driver = linux_uart_driver_create(uart_device, uart_baud);
+        if (!uart_driver) {
+            fprintf(stderr, "Failed to open %s\n", uart_device);
+            return 1;
+        }
+        config.uart_driver = uart_driver;
+        config.uart_cbor = uart_cbor;
+        printf("Serial port: %s at %d baud\n", uart_device, uart_baud);
+    }
+
+    // The pool replaces the cJSON allocator, so it goes in before any JSON exists
+    if (json_pool && embed_mcp_use_json_pool(NULL) != 0) {
+        fprintf(stderr, "Failed to install JSON pool: %s\n", embed_mcp_get_error());
+    }
+
     // Create server instance
     embed_mcp_server_t *server = embed_mcp_create(&config);
     if (!server) {
@@ -357,6 +561,30 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    if (capture_dir && embed_mcp_enable_capture(server, capture_dir) != 0) {
+        fprintf(stderr, "Failed to enable capture: %s\n", embed_mcp_get_error());
+    }
+
+    if (trace && embed_mcp_enable_tracing(server, 0) != 0) {
+        fprintf(stderr, "Failed to enable tracing: %s\n", embed_mcp_get_error());
+    }
+
+    // Sessions outlive this process: another node on the same directory takes them over
+    if (session_dir) {
+        mcp_kv_client_t client = {
+            .get = session_dir_get,
+            .set_many = session_dir_set_many,
+            .del = session_dir_del,
+            .scan = session_dir_scan,
+            .ctx = (void *)session_dir
+        };
+        mcp_session_store_t *store = mcp_session_store_kv_create(&client, NULL);
+        if (!store || embed_mcp_set_session_store(server, store) != 0) {
+            fprintf(stderr, "Failed to set session store: %s\n", embed_mcp_get_error());
+            mcp_session_store_destroy(store);
+        }
+    }
+
     // Example 1: Simple math function - double add_numbers(double a, double b)
     const char* add_param_names[] = {"a", "b"};
     const char* add_param_descriptions[] = {"First number to add", "Second number to add"};
@@ -367,12 +595,14 @@ int main(int argc, char *argv[]) {
                                   MCP_RETURN_DOUBLE, add_numbers_wrapper, NULL) != 0) {
         printf("Failed to register 'add' function: %s\n", embed_mcp_get_error());
     } else {
-        printf("Registered add(double, double) -> double\n");
+        // Pure function: repeated calls are answered from the result cache
+        embed_mcp_set_tool_cache_ttl(server, "add", 60000);
+        printf("Registered add(double, double) -> double, results cached for 60s\n");
     }
 
     // Example 2: Array sum function - double sum_numbers(double[])
     mcp_param_desc_t sum_params[] = {
-        MCP_PARAM_ARRAY_DOUBLE_DEF("numbers", "Array of numbers to sum", "A number to add", 1)
+        MCP_PARAM_ARRAY_DOUBLE_PACKED_DEF("numbers", "Array of numbers to sum", "A number to add", 1)
     };
 
     if (embed_mcp_add_tool(server, "sum_numbers", "Sum an array of numbers",
@@ -407,7 +637,9 @@ int main(int argc, char *argv[]) {
                                   MCP_RETURN_STRING, get_weather_wrapper, NULL) != 0) {
         printf("Failed to register 'weather' function: %s\n", embed_mcp_get_error());
     } else {
-        printf("Registered get_weather(const char*) -> char*\n");
+        // Stands in for an external API: two calls at a time, two more may wait
+        embed_mcp_set_tool_concurrency(server, "weather", 2, 2);
+        printf("Registered get_weather(const char*) -> char*, 2 concurrent calls\n");
     }
 
     // Example 4: Multi-parameter function - int calculate_score(int, const char*, double)
@@ -427,6 +659,27 @@ int main(int argc, char *argv[]) {
         printf("Registered calculate_score(int, const char*, double) -> int\n");
     }
 
+    // Example 5: Async tool - runs on its own thread, reports progress, can be cancelled
+    mcp_param_desc_t countdown_params[] = {
+        MCP_PARAM_INT_DEF("steps", "Number of half-second steps to count down", 1)
+    };
+
+    if (embed_mcp_add_async_tool(server, "countdown", "Count down in the background with progress",
+                                 countdown_params, 1, countdown_start, NULL) != 0) {
+        printf("Failed to register 'countdown' tool: %s\n", embed_mcp_get_error());
+    } else {
+        embed_mcp_set_tool_timeout(server, "countdown", 10000);
+        printf("Registered countdown(int) -> async, 10s deadline\n");
+    }
+
+    // Example 6: Tool table - schemas are string literals, one allocation for the table
+    if (embed_mcp_add_tool_table(server, example_tool_table,
+                                 sizeof(example_tool_table) / sizeof(example_tool_table[0])) != 0) {
+        printf("Failed to register tool table: %s\n", embed_mcp_get_error());
+    } else {
+        printf("Registered multiply(double, double) -> double, clamp(int, int, int) -> int from a table\n");
+    }
+
     // =============================================================================
     // Register Resources - Demonstrate MCP Resource System
     // =============================================================================
@@ -489,6 +742,11 @@ int main(int argc, char *argv[]) {
 
     printf("📊 Total resources registered: %zu\n", embed_mcp_get_resource_count(server));
 
+    // Cache encoded reads; the status resource is polled often, so let it be 1 s stale
+    if (embed_mcp_enable_resource_cache(server, 256 * 1024) == 0) {
+        embed_mcp_set_resource_cache_ttl(server, "status://system", 1000);
+    }
+
     // =============================================================================
     // Register Resource Templates - Demonstrate Dynamic File Access
     // =============================================================================
@@ -582,11 +840,14 @@ int main(int argc, char *argv[]) {
 
     if (strcmp(transport_type, "http") == 0) {
         result = embed_mcp_run(server, EMBED_MCP_TRANSPORT_HTTP);
+    } else if (strcmp(transport_type, "uart") == 0) {
+        result = embed_mcp_run(server, EMBED_MCP_TRANSPORT_UART);
     } else {
         result = embed_mcp_run(server, EMBED_MCP_TRANSPORT_STDIO);
     }
     
     // Cleanup
     embed_mcp_destroy(server);
+    linux_uart_driver_destroy(uart_driver);
     return result;
 }